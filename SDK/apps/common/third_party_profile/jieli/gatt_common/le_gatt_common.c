@@ -63,6 +63,18 @@ static u8 gatt_server_conn_handle_state[SUPPORT_MAX_GATT_SERVER];//BLE_ST_CONNEC
 static u8 gatt_client_conn_handle_state[SUPPORT_MAX_GATT_CLIENT];//BLE_ST_CONNECT,BLE_ST_SEND_DISCONN,BLE_ST_SEARCH_COMPLETE
 
 extern const int config_btctler_coded_type;
+//----------------------------------------------------------------------------------------
+//att控制及发送缓存分配,应用可重定义(如从静态内存池分配)
+__attribute__((weak)) void *ble_comm_ram_malloc(u32 size)
+{
+    return malloc(size);
+}
+
+__attribute__((weak)) void ble_comm_ram_free(void *ptr)
+{
+    free(ptr);
+}
+
 //----------------------------------------------------------------------------------------
 u32 att_need_ctrl_ramsize(void);
 void ble_comm_server_profile_init(void);
@@ -819,7 +831,7 @@ void ble_profile_init(void)
         u32 need_ram = att_need_ctrl_ramsize();
         need_ram += (gatt_control_block->mtu_size + gatt_control_block->cbuffer_size);
         if (!gatt_ram_buffer) {
-            gatt_ram_buffer = malloc(need_ram);
+            gatt_ram_buffer = ble_comm_ram_malloc(need_ram);
             if (!gatt_ram_buffer) {
                 log_info("att malloc size=%d fail!!!\n", need_ram);
                 ASSERT(0);
@@ -989,7 +1001,7 @@ void ble_comm_exit(void)
 
     if (gatt_ram_buffer) {
         ble_op_multi_att_send_init(0, 0, 0);//set disable firstly
-        free(gatt_ram_buffer);
+        ble_comm_ram_free(gatt_ram_buffer);
         gatt_ram_buffer = 0;
     }
 }
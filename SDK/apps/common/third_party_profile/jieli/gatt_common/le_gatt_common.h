@@ -234,6 +234,8 @@ u16 ble_comm_dev_get_handle(u8 index, u8 role);
 void ble_comm_set_config_name(const char *name_p, u8 add_ext_name);
 void ble_comm_init(const gatt_ctrl_t *control_blk);
 void ble_comm_exit(void);
+void *ble_comm_ram_malloc(u32 size);
+void ble_comm_ram_free(void *ptr);
 void ble_comm_module_enable(u8 en);
 int ble_comm_set_connection_data_length(u16 conn_handle, u16 tx_octets, u16 tx_time);
 int ble_comm_set_connection_data_phy(u16 conn_handle, u8 tx_phy, u8 rx_phy, u16 phy_options);
@@ -252,6 +254,9 @@ u16 ble_gatt_server_characteristic_ccc_get(u16 conn_handle, u16 att_ccc_handle);
 void ble_gatt_server_set_update_send(u16 conn_handle, u16 att_handle, u8 att_handle_type);
 void ble_gatt_server_receive_update_data(void *priv, void *buf, u16 len);
 void ble_gatt_server_set_adv_config(adv_cfg_t *adv_cfg);
+#if EXT_ADV_MODE_EN
+void ble_gatt_server_set_ext_adv_config(const void *param, const void *data);
+#endif
 void ble_gatt_server_set_profile(const u8 *profile_table, u16 size);
 
 //client
@@ -634,6 +634,12 @@ const le_set_ext_adv_en_t ext_adv_disable = {
     .Max_Extended_Advertising_Events = 0,
 };
 
+#if EXT_ADV_MODE_EN
+/*应用可替换的扩展广播参数和数据, 默认使用上面的demo配置*/
+static const le_set_ext_adv_param_t *ext_adv_param_cur = &ext_adv_param;
+static const le_set_ext_adv_data_t *ext_adv_data_cur = &ext_adv_data;
+#endif
+
 #endif /* EXT_ADV_MODE_EN */
 
 #if PERIODIC_ADV_MODE_EN
@@ -775,8 +781,8 @@ int ble_gatt_server_adv_enable(u32 en)
 
 #if EXT_ADV_MODE_EN
     if (en) {
-        ble_op_set_ext_adv_param(&ext_adv_param, sizeof(ext_adv_param));
-        ble_op_set_ext_adv_data(&ext_adv_data, sizeof(ext_adv_data));
+        ble_op_set_ext_adv_param(ext_adv_param_cur, sizeof(le_set_ext_adv_param_t));
+        ble_op_set_ext_adv_data(ext_adv_data_cur, sizeof(le_set_ext_adv_data_t));
         ble_op_set_ext_adv_enable(&ext_adv_enable, sizeof(ext_adv_enable));
     } else {
         ble_op_set_ext_adv_enable(&ext_adv_disable, sizeof(ext_adv_disable));
@@ -990,6 +996,26 @@ void ble_gatt_server_set_adv_config(adv_cfg_t *adv_cfg)
     __this->adv_config = adv_cfg;
 }
 
+#if EXT_ADV_MODE_EN
+/*************************************************************************************************/
+/*!
+ *  \brief      配置扩展广播参数和数据
+ *
+ *  \param      [in] param  le_set_ext_adv_param_t, NULL使用默认配置
+ *  \param      [in] data   le_set_ext_adv_data_t, NULL使用默认配置
+ *
+ *  \return     开广播前调用, 只保存指针, 下次开广播时生效
+ *
+ *  \note
+ */
+/*************************************************************************************************/
+void ble_gatt_server_set_ext_adv_config(const void *param, const void *data)
+{
+    ext_adv_param_cur = param ? (const le_set_ext_adv_param_t *)param : &ext_adv_param;
+    ext_adv_data_cur = data ? (const le_set_ext_adv_data_t *)data : &ext_adv_data;
+}
+#endif /* EXT_ADV_MODE_EN */
+
 /*************************************************************************************************/
 /*!
  *  \brief      配置profile
@@ -40,6 +40,9 @@ const struct low_power_param power_param = {
 #if TCFG_RTC_ALARM_ENABLE
     .rtc_clk        = 1,
 #endif
+#if CONFIG_APP_MOTOR_CONTROL
+    .light_sleep_attribute = LOWPOWER_LIGHT_SLEEP_ATTRIBUTE_KEEP_CLOCK,  //light sleep保持时钟, 马达PWM继续输出
+#endif
 };
 
 /************************** KEY MSG****************************/
@@ -403,6 +406,12 @@ enum {
     PORTC_GROUP,
 };
 
+#if CONFIG_APP_MOTOR_CONTROL
+extern u32 vm_power_keep_io(void);
+extern void vm_power_sleep_enter(void);
+extern void vm_power_sleep_exit(u32 usec);
+#endif
+
 static void port_protect(u16 *port_group, u32 port_num)
 {
     if (port_num == NO_CONFIG_PORT) {
@@ -471,6 +480,12 @@ static void close_gpio(u8 is_softoff)
     }
 #endif
 
+#if CONFIG_APP_MOTOR_CONTROL
+    if (is_softoff == 0) {
+        port_protect(port_group, vm_power_keep_io());     //protect 马达PWM
+    }
+#endif
+
 #if CONFIG_APP_AT_CHAR_COM || CONFIG_APP_AT_COM
     port_protect(port_group, UART_DB_TX_PIN);
     port_protect(port_group, UART_DB_RX_PIN);
@@ -655,6 +670,9 @@ void sleep_exit_callback(u32 usec)
 {
 	putchar('>');
     APP_IO_DEBUG_0(A, 5);
+#if CONFIG_APP_MOTOR_CONTROL
+    vm_power_sleep_exit(usec);
+#endif
 }
 
 void sleep_enter_callback(u8  step)
@@ -664,6 +682,9 @@ void sleep_enter_callback(u8  step)
 		putchar('<');
 		APP_IO_DEBUG_1(A, 5);
 		/*dac_power_off();*/
+#if CONFIG_APP_MOTOR_CONTROL
+		vm_power_sleep_enter();
+#endif
 	} else {
 		close_gpio(0);
 	}
@@ -14,6 +14,7 @@
 #include "app_power_manage.h"
 #include "app_comm_bt.h"
 #include "ble_motor.h"
+#include "vibration_motor_ble/vm_adv_scheduler.h"
 #include "btstack/le/ble_api.h"
 
 #define LOG_TAG             "[MOTOR_APP]"
@@ -305,6 +306,11 @@ static void motor_key_event_handler(struct sys_event *event)
         event_type = event->u.key.event;
         key_value = event->u.key.value;
         log_info("app_key_evnet: %d,%d\n", event_type, key_value);
+
+#if TCFG_USER_BLE_ENABLE
+        /* Any button press makes the device quickly discoverable again */
+        vm_adv_sched_trigger(VM_ADV_TRIGGER_BUTTON);
+#endif
         /*Change Case To Idle Demo*/
 #if CONFIG_APP_SPP_LE_TO_IDLE
         if (event_type == KEY_EVENT_CLICK && key_value == TCFG_ADKEY_VALUE1) {
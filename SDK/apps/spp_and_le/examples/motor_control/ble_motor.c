@@ -24,6 +24,14 @@
 /* Include our motor control implementation */
 #include "vibration_motor_ble/vm_ble_service.h"
 #include "vibration_motor_ble/vm_motor_control.h"
+#include "vibration_motor_ble/vm_adv_scheduler.h"
+#include "vibration_motor_ble/vm_adv_status.h"
+#include "vibration_motor_ble/vm_long_range.h"
+#include "vibration_motor_ble/vm_settings.h"
+#include "vibration_motor_ble/vm_config.h"
+#include "vibration_motor_ble/custom_dual_bank_ota.h"
+#include "vibration_motor_ble/vm_trace.h"
+#include "vibration_motor_ble/vm_sync.h"
 
 /* Connection handle */
 static u16 motor_ble_con_handle = 0;
@@ -33,7 +41,13 @@ static u8 motor_adv_data[31];
 static u8 motor_scan_rsp_data[31];
 static adv_cfg_t motor_server_adv_config;
 
+/* Status currently carried in the scan response */
+static vm_adv_status_t motor_adv_status;
+static u16 motor_adv_status_timer = 0;
+static u16 motor_boot_confirm_timeout = 0;
+
 /* Forward declarations */
+static void motor_adv_status_refresh(void);
 static int motor_event_packet_handler(int event, u8 *packet, u16 size, u8 *ext_param);
 static uint16_t motor_att_read_callback(hci_con_handle_t connection_handle, uint16_t att_handle, uint16_t offset, uint8_t *buffer, uint16_t buffer_size);
 static int motor_att_write_callback(hci_con_handle_t connection_handle, uint16_t att_handle, uint16_t transaction_mode, uint16_t offset, uint8_t *buffer, uint16_t buffer_size);
@@ -48,7 +62,7 @@ static const gatt_server_cfg_t motor_server_init_cfg = {
 /* GATT control block */
 static gatt_ctrl_t motor_gatt_control_block = {
     .mtu_size = 512,  /* Large MTU for OTA data transfer (240 byte chunks) */
-    .cbuffer_size = 512,
+    .cbuffer_size = VM_BLE_TX_CBUF_SIZE,
     .multi_dev_flag = 0,
     .server_config = &motor_server_init_cfg,
     .client_config = NULL,
@@ -74,30 +88,55 @@ static uint8_t motor_connection_update_cnt = 0;
 static int motor_event_packet_handler(int event, u8 *packet, u16 size, u8 *ext_param)
 {
     (void)size;
-    (void)ext_param;
     
     switch (event) {
         case GATT_COMM_EVENT_CONNECTION_COMPLETE:
             motor_ble_con_handle = little_endian_read_16(packet, 0);
+            VM_TRACE(CONNECT, motor_ble_con_handle);
             log_info("Connected: handle=%04x\n", motor_ble_con_handle);
             motor_connection_update_cnt = 0;
+            vm_adv_sched_on_connect();
+            vm_lr_on_connect(motor_ble_con_handle);
+            break;
+
+        case GATT_COMM_EVENT_CONNECTION_COMPLETE_FAIL:
+            vm_adv_sched_on_connect_fail();
             break;
 
         case GATT_COMM_EVENT_DISCONNECT_COMPLETE:
+            VM_TRACE(DISCONNECT, motor_ble_con_handle);
             log_info("Disconnected: handle=%04x\n", motor_ble_con_handle);
             motor_ble_con_handle = 0;
             motor_connection_update_cnt = 0;
+            vm_lr_on_disconnect();
+            vm_sync_stop();
+            vm_ble_ota_on_disconnect();
+            vm_trace_dump_end();
+            motor_adv_status_refresh();
+            vm_adv_sched_trigger(VM_ADV_TRIGGER_DISCONNECT);
             break;
 
         case GATT_COMM_EVENT_ENCRYPTION_CHANGE:
+            VM_TRACE(ENCRYPTION, little_endian_read_16(packet, 0));
             log_info("Encryption enabled: handle=%04x\n", little_endian_read_16(packet, 0));
             break;
 
         case GATT_COMM_EVENT_CONNECTION_UPDATE_COMPLETE:
+            VM_TRACE(CONN_UPDATE, 0);
             log_info("Connection params updated\n");
             break;
 
+        case GATT_COMM_EVENT_CONNECTION_PHY_UPDATE_COMPLETE:
+            vm_lr_on_phy_update(ext_param);
+            break;
+
         case GATT_COMM_EVENT_CAN_SEND_NOW:
+            vm_ble_ota_on_can_send_now();
+            break;
+
+        case GATT_COMM_EVENT_MTU_EXCHANGE_COMPLETE:
+            log_info("ATT MTU = %d\n", little_endian_read_16(packet, 2));
+            vm_ble_ota_on_mtu(little_endian_read_16(packet, 2));
             break;
 
         default:
@@ -125,6 +164,8 @@ static uint16_t motor_att_read_callback(hci_con_handle_t connection_handle, uint
  */
 static int motor_att_write_callback(hci_con_handle_t connection_handle, uint16_t att_handle, uint16_t transaction_mode, uint16_t offset, uint8_t *buffer, uint16_t buffer_size)
 {
+    VM_TRACE(ATT_WRITE, att_handle);
+
     /* Get the vm_ble_service's server config and call its write callback */
     const gatt_server_cfg_t *vm_cfg = (const gatt_server_cfg_t *)vm_ble_get_server_config();
     if (vm_cfg && vm_cfg->att_write_cb) {
@@ -151,6 +192,11 @@ static int motor_make_set_adv_data(void)
     offset += make_eir_packet_data(&buf[offset], offset, HCI_EIR_DATATYPE_COMPLETE_LOCAL_NAME, 
                                     (void *)gap_name, name_len);
     
+#if VM_LONG_RANGE_ENABLE
+    /* Connectable extended advertising has no scan response, carry status here */
+    offset += vm_adv_status_encode(&buf[offset], sizeof(motor_adv_data) - offset, &motor_adv_status);
+#endif
+    
     if (offset > 31) {
         log_info("motor_adv_data overflow: %d\n", offset);
         return -1;
@@ -165,14 +211,17 @@ static int motor_make_set_adv_data(void)
 
 /*
  * Setup scan response data
+ * Carries the connectionless status (battery, firmware, bank, flags)
  */
 static int motor_make_set_rsp_data(void)
 {
     u8 offset = 0;
     u8 *buf = motor_scan_rsp_data;
     
-    /* For now, keep scan response empty or minimal */
     /* Service UUID is in GATT profile, not needed in scan response */
+#if !VM_LONG_RANGE_ENABLE
+    offset += vm_adv_status_encode(&buf[offset], sizeof(motor_scan_rsp_data) - offset, &motor_adv_status);
+#endif
     
     if (offset > 31) {
         log_info("motor_rsp_data overflow: %d\n", offset);
@@ -185,17 +234,66 @@ static int motor_make_set_rsp_data(void)
     return 0;
 }
 
+/*
+ * Re-sample status and update the scan response (adv data in long range mode) if it changed
+ * Advertising keeps running: the new data is pushed to the controller directly,
+ * the adv config is re-registered so the next (re)enable uses it as well.
+ */
+static void motor_adv_status_refresh(void)
+{
+    vm_adv_status_t st;
+
+    vm_adv_status_collect(&st);
+    if (!memcmp(&st, &motor_adv_status, sizeof(st))) {
+        return;
+    }
+
+    memcpy(&motor_adv_status, &st, sizeof(st));
+#if VM_LONG_RANGE_ENABLE
+    if (motor_make_set_adv_data()) {
+        return;
+    }
+
+    ble_gatt_server_set_adv_config(&motor_server_adv_config);
+    vm_lr_adv_sync();
+#else
+    if (motor_make_set_rsp_data()) {
+        return;
+    }
+
+    ble_gatt_server_set_adv_config(&motor_server_adv_config);
+    if (ble_gatt_server_get_work_state() == BLE_ST_ADV) {
+        ble_op_set_rsp_data(motor_server_adv_config.rsp_data_len, motor_server_adv_config.rsp_data);
+    }
+#endif
+
+    log_info("adv status: battery=%d fw=%d.%d flags=%02x\n",
+             st.battery, st.fw_high, st.fw_low, st.flags);
+}
+
+static void motor_adv_status_poll(void *priv)
+{
+    (void)priv;
+
+    /* Scan response is only visible while advertising */
+    if (!motor_ble_con_handle) {
+        motor_adv_status_refresh();
+    }
+}
+
 /*
  * Configure advertising
  */
 static void motor_adv_config_set(void)
 {
     int ret = 0;
+    vm_adv_status_collect(&motor_adv_status);
     ret |= motor_make_set_adv_data();
     ret |= motor_make_set_rsp_data();
     
-    motor_server_adv_config.adv_interval = 160;  /* 100ms (160 * 0.625ms) */
-    motor_server_adv_config.adv_auto_do = 1;     /* Auto start advertising */
+    /* Interval and start/stop are owned by the advertising scheduler */
+    motor_server_adv_config.adv_interval = VM_ADV_FAST_INTERVAL;
+    motor_server_adv_config.adv_auto_do = 0;
     motor_server_adv_config.adv_type = ADV_IND;  /* Connectable undirected */
     motor_server_adv_config.adv_channel = ADV_CHANNEL_ALL;
     memset(motor_server_adv_config.direct_address_info, 0, 7);
@@ -208,6 +306,8 @@ static void motor_adv_config_set(void)
     }
     
     ble_gatt_server_set_adv_config(&motor_server_adv_config);
+    vm_lr_init(&motor_server_adv_config);
+    vm_adv_sched_init(&motor_server_adv_config);
     log_info("motor_adv_config_set complete\n");
 }
 
@@ -307,6 +407,16 @@ void bt_ble_before_start_init(void)
     ble_comm_init(&motor_gatt_control_block);
 }
 
+/*
+ * BLE stayed up long enough: stop boot counting for a freshly updated image
+ */
+static void motor_boot_confirm(void *priv)
+{
+    (void)priv;
+    motor_boot_confirm_timeout = 0;
+    custom_dual_bank_mark_good();
+}
+
 /*
  * BLE initialization - called by SDK's app_comm_ble.c after stack starts
  */
@@ -314,8 +424,9 @@ void bt_ble_init(void)
 {
     log_info("bt_ble_init\n");
     
-    /* Set device name */
-    ble_comm_set_config_name("VibMotor", 1);
+    /* Set device name (user setting, loaded before the service starts) */
+    vm_settings_init();
+    ble_comm_set_config_name(vm_settings_get()->device_name, 1);
     
     /* Reset connection handle */
     motor_ble_con_handle = 0;
@@ -323,8 +434,19 @@ void bt_ble_init(void)
     /* Initialize server (profile + advertising) */
     motor_server_init();
     
-    /* Enable BLE module - starts advertising */
+    /* Enable BLE module, then start advertising in the fast tier */
     ble_module_enable(1);
+    vm_adv_sched_trigger(VM_ADV_TRIGGER_POWER_ON);
+
+    /* Keep the connectionless status in the scan response up to date */
+    if (!motor_adv_status_timer) {
+        motor_adv_status_timer = sys_timer_add(NULL, motor_adv_status_poll, VM_ADV_STATUS_POLL_MS);
+    }
+
+    /* Mark the running image good once BLE has been up for a while */
+    if (!motor_boot_confirm_timeout) {
+        motor_boot_confirm_timeout = sys_timeout_add(NULL, motor_boot_confirm, CUSTOM_BOOT_CONFIRM_MS);
+    }
 }
 
 /*
@@ -334,7 +456,17 @@ void bt_ble_exit(void)
 {
     log_info("bt_ble_exit\n");
     
-    /* Disable module */
+    /* Stop status refresh, advertising scheduler and disable module */
+    if (motor_adv_status_timer) {
+        sys_timer_del(motor_adv_status_timer);
+        motor_adv_status_timer = 0;
+    }
+    /* BLE did not stay up: the image is not confirmed by this boot */
+    if (motor_boot_confirm_timeout) {
+        sys_timeout_del(motor_boot_confirm_timeout);
+        motor_boot_confirm_timeout = 0;
+    }
+    vm_adv_sched_stop();
     motor_ble_module_enable(0);
     
     /* Note: ble_comm_exit() is called by SDK's btstack_ble_exit() 
@@ -0,0 +1,63 @@
+/**
+ * Pattern vectors - client encoder output for test_pattern
+ * Run with: node gen_pattern_vectors.mjs > pattern_vectors.h   (make vectors)
+ *
+ * Encodes every built-in pattern of the client library, a long ramp and a
+ * few seeded random patterns (long gaps, repeated times) with
+ * utils/pattern-codec.js, with and without the meta block, and prints
+ * them as C arrays next to the frames they were encoded from.
+ */
+
+import { MOTOR_PATTERN_LIBRARY } from '../../../../../../../dulaan_ota/backend/client/utils/motor-patterns.js';
+import { encodePattern } from '../../../../../../../dulaan_ota/backend/client/utils/pattern-codec.js';
+
+const patterns = Object.values(MOTOR_PATTERN_LIBRARY).map((p) => ({ ...p }));
+
+const ramp = [];
+for (let i = 0; i <= 100; i++) ramp.push({ time: i * 50, pwm: Math.min(255, i * 2) });
+patterns.push({ id: 'ramp', name: 'Ramp', duration: 5000, loop: false, frames: ramp });
+
+// Same generator and steps as the random round trip of test-pattern-codec.js
+let seed = 7;
+const random = () => (seed = (seed * 1103515245 + 12345) >>> 0) / 4294967296;
+const steps = [0, 20, 1000, 70000, 3000000];
+for (let k = 0; k < 6; k++) {
+    const frames = [];
+    let time = 0;
+    let pwm = Math.floor(random() * 256);
+    const count = 1 + Math.floor(random() * 80);
+    for (let i = 0; i < count; i++) {
+        if (random() < 0.5) pwm = Math.floor(random() * 256);
+        time += steps[Math.floor(random() * steps.length)];
+        frames.push({ time, pwm });
+    }
+    patterns.push({ id: `random_${k}`, name: `Random ${k}`, duration: time, loop: random() < 0.5, frames });
+}
+
+const cName = (id) => id.replace(/[^A-Za-z0-9_]/g, '_');
+
+function bytesArray(name, bytes) {
+    const lines = [];
+    for (let i = 0; i < bytes.length; i += 12) {
+        lines.push('    ' + Array.from(bytes.subarray(i, i + 12), (b) => `0x${b.toString(16).padStart(2, '0')},`).join(' '));
+    }
+    return `static const u8 ${name}[] = {\n${lines.join('\n')}\n};\n`;
+}
+
+const out = [];
+out.push('/* Generated by gen_pattern_vectors.mjs from utils/pattern-codec.js, do not edit (make vectors) */\n');
+for (const p of patterns) {
+    const name = cName(p.id);
+    const frames = p.frames.map((f) => `    {${Math.round(f.time)}, ${Math.round(f.pwm)}},`);
+    out.push(`static const vm_pattern_frame_t ${name}_frames[] = {\n${frames.join('\n')}\n};\n`);
+    out.push(bytesArray(`${name}_bare`, encodePattern(p, { meta: false })));
+    out.push(bytesArray(`${name}_meta`, encodePattern(p)));
+}
+out.push('static const pattern_vector_t g_vectors[] = {');
+for (const p of patterns) {
+    const name = cName(p.id);
+    out.push(`    {"${p.id}", ${Math.round(p.duration)}, ${p.loop ? 1 : 0}, ${p.frames.length}, ${name}_frames,\n` +
+             `     ${name}_bare, sizeof(${name}_bare), ${name}_meta, sizeof(${name}_meta)},`);
+}
+out.push('};');
+console.log(out.join('\n'));
@@ -0,0 +1,704 @@
+/**
+ * Host Test Runtime - SDK services for firmware modules built on the PC
+ */
+
+#include "host_sdk.h"
+#include "system/includes.h"
+#include "asm/crc16.h"
+#include "circular_buf.h"
+#include "uart.h"
+#include "app_power_manage.h"
+#include "gatt_common/le_gatt_common.h"
+
+#include <stdarg.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+/* ========== Time and timers ========== */
+
+#define HOST_TIMERS_MAX     32
+
+typedef struct {
+    void (*func)(void *priv);
+    void *priv;
+    u64 due_us;
+    u32 period_ms;          /* 0: timeout, removed before it fires */
+    u8 used;
+} host_timer_t;
+
+static u64 g_now_us = 0;
+static host_timer_t g_timers[HOST_TIMERS_MAX];
+static u64 g_timer_longest_us = 0;
+
+u64 host_now_us(void)
+{
+    return g_now_us;
+}
+
+void host_advance_us(u64 us)
+{
+    g_now_us += us;
+}
+
+static u16 timer_add(void *priv, void (*func)(void *priv), u32 msec, u32 period_ms)
+{
+    u16 i;
+
+    for (i = 0; i < HOST_TIMERS_MAX; i++) {
+        if (!g_timers[i].used) {
+            g_timers[i].func = func;
+            g_timers[i].priv = priv;
+            g_timers[i].due_us = g_now_us + (u64)msec * 1000;
+            g_timers[i].period_ms = period_ms;
+            g_timers[i].used = 1;
+            return i + 1;
+        }
+    }
+    fprintf(stderr, "host: out of timers\n");
+    abort();
+}
+
+static void timer_del(u16 id)
+{
+    if (id >= 1 && id <= HOST_TIMERS_MAX) {
+        g_timers[id - 1].used = 0;
+    }
+}
+
+u16 sys_timer_add(void *priv, void (*func)(void *priv), u32 msec)
+{
+    return timer_add(priv, func, msec, msec ? msec : 1);
+}
+
+void sys_timer_del(u16 id)
+{
+    timer_del(id);
+}
+
+u16 sys_timeout_add(void *priv, void (*func)(void *priv), u32 msec)
+{
+    return timer_add(priv, func, msec, 0);
+}
+
+void sys_timeout_del(u16 id)
+{
+    timer_del(id);
+}
+
+void host_run_ms(u32 ms)
+{
+    u64 end = g_now_us + (u64)ms * 1000;
+    host_timer_t *next;
+    u64 start;
+    void (*func)(void *priv);
+    void *priv;
+    u16 i;
+
+    for (;;) {
+        next = NULL;
+        for (i = 0; i < HOST_TIMERS_MAX; i++) {
+            if (g_timers[i].used && g_timers[i].due_us <= end &&
+                (!next || g_timers[i].due_us < next->due_us)) {
+                next = &g_timers[i];
+            }
+        }
+        if (!next) {
+            break;
+        }
+        if (next->due_us > g_now_us) {
+            g_now_us = next->due_us;
+        }
+        func = next->func;
+        priv = next->priv;
+        if (next->period_ms) {
+            next->due_us += (u64)next->period_ms * 1000;
+        } else {
+            next->used = 0;
+        }
+        start = g_now_us;
+        func(priv);
+        if (g_now_us - start > g_timer_longest_us) {
+            g_timer_longest_us = g_now_us - start;
+        }
+    }
+    if (end > g_now_us) {
+        g_now_us = end;
+    }
+}
+
+u64 host_timer_longest_us(void)
+{
+    u64 longest = g_timer_longest_us;
+
+    g_timer_longest_us = 0;
+    return longest;
+}
+
+u32 host_timers_active(void)
+{
+    u32 n = 0;
+    u16 i;
+
+    for (i = 0; i < HOST_TIMERS_MAX; i++) {
+        n += g_timers[i].used;
+    }
+    return n;
+}
+
+unsigned long jiffies_msec(void)
+{
+    return (unsigned long)(g_now_us / 1000);
+}
+
+void os_time_dly(int ticks)
+{
+    g_now_us += (u64)ticks * 10000;    /* 10 ms OS tick */
+}
+
+void local_irq_disable(void)
+{
+}
+
+void local_irq_enable(void)
+{
+}
+
+/* ========== Shared memory and power cycles ========== */
+
+static u8 g_in_boot = 0;
+static u8 g_reset_continue = 0;
+static u32 g_resets = 0;
+static u64 g_last_reset_us = 0;
+
+void *host_shared(size_t size)
+{
+    void *p = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+
+    if (p == MAP_FAILED) {
+        perror("host: mmap");
+        abort();
+    }
+    return p;
+}
+
+int host_boot(void (*fn)(void *arg), void *arg)
+{
+    pid_t pid;
+    int status;
+
+    fflush(stdout);
+    pid = fork();
+    if (pid < 0) {
+        perror("host: fork");
+        abort();
+    }
+    if (pid == 0) {
+        g_in_boot = 1;
+        fn(arg);
+        fflush(stdout);
+        _exit(HOST_BOOT_DONE);
+    }
+    fflush(stdout);
+    if (waitpid(pid, &status, 0) < 0 || !WIFEXITED(status)) {
+        return HOST_BOOT_CRASH;
+    }
+    switch (WEXITSTATUS(status)) {
+        case HOST_BOOT_DONE:
+        case HOST_BOOT_RESET:
+        case HOST_BOOT_CUT:
+            return WEXITSTATUS(status);
+        default:
+            return HOST_BOOT_CRASH;
+    }
+}
+
+void host_reset_continue(u8 on)
+{
+    g_reset_continue = on;
+}
+
+void cpu_reset(void)
+{
+    if (g_in_boot && !g_reset_continue) {
+        fflush(stdout);
+        _exit(HOST_BOOT_RESET);
+    }
+    g_resets++;
+    g_last_reset_us = g_now_us;
+}
+
+u32 host_resets(void)
+{
+    return g_resets;
+}
+
+u64 host_last_reset_us(void)
+{
+    return g_last_reset_us;
+}
+
+/* ========== Flash ========== */
+
+static u8 *g_flash = NULL;
+static host_flash_stats_t *g_flash_stats = NULL;
+
+static void flash_map(void)
+{
+    if (!g_flash) {
+        g_flash = host_shared(HOST_FLASH_SIZE);
+        g_flash_stats = host_shared(sizeof(*g_flash_stats));
+        memset(g_flash, 0xFF, HOST_FLASH_SIZE);
+    }
+}
+
+u8 *host_flash(void)
+{
+    flash_map();
+    return g_flash;
+}
+
+host_flash_stats_t *host_flash_stats(void)
+{
+    flash_map();
+    return g_flash_stats;
+}
+
+void host_flash_reset(void)
+{
+    flash_map();
+    memset(g_flash, 0xFF, HOST_FLASH_SIZE);
+    memset(g_flash_stats, 0, sizeof(*g_flash_stats));
+}
+
+void host_flash_cut_at(u32 n)
+{
+    flash_map();
+    g_flash_stats->cut_at = n ? g_flash_stats->ops + n : 0;
+}
+
+/* Counts the operation; 1 if power goes during this one */
+static int flash_op_cut(void)
+{
+    g_flash_stats->ops++;
+    return g_flash_stats->cut_at && g_flash_stats->ops == g_flash_stats->cut_at;
+}
+
+static void flash_power_cut(void)
+{
+    g_flash_stats->cut_at = 0;
+    fflush(stdout);
+    if (g_in_boot) {
+        _exit(HOST_BOOT_CUT);
+    }
+    fprintf(stderr, "host: power cut outside host_boot()\n");
+    abort();
+}
+
+int norflash_erase(u8 eraser, u32 addr)
+{
+    u32 size = HOST_FLASH_SECTOR;
+
+    flash_map();
+    if (eraser != 1 || (addr & (HOST_FLASH_SECTOR - 1)) || addr + size > HOST_FLASH_SIZE) {
+        return -1;      /* Only aligned sector erase is used */
+    }
+    g_flash_stats->erases[addr / HOST_FLASH_SECTOR]++;
+    g_now_us += HOST_FLASH_ERASE_US;
+    if (flash_op_cut()) {
+        memset(&g_flash[addr], 0xFF, size / 2);
+        flash_power_cut();
+    }
+    memset(&g_flash[addr], 0xFF, size);
+    return 0;
+}
+
+int norflash_write(u32 addr, u8 *buf, u32 len)
+{
+    u32 n = len;
+    u32 i;
+
+    flash_map();
+    if (addr + len > HOST_FLASH_SIZE) {
+        return -1;
+    }
+    g_flash_stats->programs++;
+    g_flash_stats->program_bytes += len;
+    g_now_us += ((u64)HOST_FLASH_PROGRAM_US * len + 255) / 256;
+    if (flash_op_cut()) {
+        n = len / 2;
+    }
+    for (i = 0; i < n; i++) {
+        g_flash[addr + i] &= buf[i];   /* NOR program only clears bits */
+    }
+    if (n != len) {
+        flash_power_cut();
+    }
+    return 0;
+}
+
+int norflash_read(u32 addr, u8 *buf, u32 len)
+{
+    flash_map();
+    if (addr + len > HOST_FLASH_SIZE) {
+        return -1;
+    }
+    g_flash_stats->reads++;
+    g_flash_stats->read_bytes += len;
+    g_now_us += ((u64)HOST_FLASH_READ_US * len + 255) / 256;
+    memcpy(buf, &g_flash[addr], len);
+    return 0;
+}
+
+/* ========== CRC16 (CCITT polynomial, init 0, as the SDK) ========== */
+
+u16 CRC16_with_initval(const void *ptr, u32 len, u16 i_val)
+{
+    const u8 *p = ptr;
+    u16 crc = i_val;
+    u8 bit;
+
+    while (len--) {
+        crc ^= (u16)(*p++) << 8;
+        for (bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (u16)((crc << 1) ^ 0x1021) : (u16)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+u16 CRC16(const void *ptr, u32 len)
+{
+    return CRC16_with_initval(ptr, len, 0);
+}
+
+/* ========== cbuffer ========== */
+
+void cbuf_init(cbuffer_t *cbuffer, void *buf, u32 size)
+{
+    memset(cbuffer, 0, sizeof(*cbuffer));
+    cbuffer->begin = buf;
+    cbuffer->end = (u8 *)buf + size;
+    cbuffer->read_ptr = buf;
+    cbuffer->write_ptr = buf;
+    cbuffer->total_len = size;
+}
+
+void *cbuf_write_alloc(cbuffer_t *cbuffer, u32 *len)
+{
+    if (cbuffer->data_len == cbuffer->total_len) {
+        *len = 0;
+    } else if (cbuffer->write_ptr >= cbuffer->read_ptr) {
+        *len = cbuffer->end - cbuffer->write_ptr;
+    } else {
+        *len = cbuffer->read_ptr - cbuffer->write_ptr;
+    }
+    return cbuffer->write_ptr;
+}
+
+void cbuf_write_updata(cbuffer_t *cbuffer, u32 len)
+{
+    cbuffer->write_ptr += len;
+    if (cbuffer->write_ptr >= cbuffer->end) {
+        cbuffer->write_ptr -= cbuffer->total_len;
+    }
+    cbuffer->data_len += len;
+}
+
+void *cbuf_read_alloc(cbuffer_t *cbuffer, u32 *len)
+{
+    if (cbuffer->data_len == 0) {
+        *len = 0;
+    } else if (cbuffer->read_ptr < cbuffer->write_ptr) {
+        *len = cbuffer->write_ptr - cbuffer->read_ptr;
+    } else {
+        *len = cbuffer->end - cbuffer->read_ptr;
+    }
+    return cbuffer->read_ptr;
+}
+
+void cbuf_read_updata(cbuffer_t *cbuffer, u32 len)
+{
+    cbuffer->read_ptr += len;
+    if (cbuffer->read_ptr >= cbuffer->end) {
+        cbuffer->read_ptr -= cbuffer->total_len;
+    }
+    cbuffer->data_len -= len;
+}
+
+u32 cbuf_get_data_size(cbuffer_t *cbuffer)
+{
+    return cbuffer->data_len;
+}
+
+/* ========== BLE ========== */
+
+#define HOST_BLE_QUEUE_MAX  64
+#define HOST_BLE_PDU_MAX    256
+
+typedef struct {
+    u16 att_handle;
+    u16 len;
+    u8 data[HOST_BLE_PDU_MAX];
+} host_pdu_t;
+
+static host_pdu_t g_ble_queue[HOST_BLE_QUEUE_MAX];
+static u16 g_ble_head = 0;
+static u16 g_ble_count = 0;
+static u16 g_ble_bytes = 0;
+static u16 g_ble_capacity = 512;
+static u8 g_ble_notify = 1;
+
+void host_ble_reset(u16 capacity)
+{
+    g_ble_head = 0;
+    g_ble_count = 0;
+    g_ble_bytes = 0;
+    g_ble_capacity = capacity;
+}
+
+void host_ble_set_notify(u8 enabled)
+{
+    g_ble_notify = enabled;
+}
+
+u16 host_ble_pop(u16 *att_handle, u8 *buf, u16 size)
+{
+    host_pdu_t *pdu;
+    u16 len;
+
+    if (!g_ble_count) {
+        return 0;
+    }
+    pdu = &g_ble_queue[g_ble_head];
+    len = pdu->len;
+    if (att_handle) {
+        *att_handle = pdu->att_handle;
+    }
+    if (buf) {
+        memcpy(buf, pdu->data, len < size ? len : size);
+    }
+    g_ble_head = (g_ble_head + 1) % HOST_BLE_QUEUE_MAX;
+    g_ble_count--;
+    g_ble_bytes -= len;
+    return len;
+}
+
+u16 host_ble_queued(void)
+{
+    return g_ble_bytes;
+}
+
+u32 ble_comm_cbuffer_vaild_len(u16 conn_handle)
+{
+    return conn_handle ? g_ble_capacity - g_ble_bytes : 0;
+}
+
+int ble_comm_att_send_data(u16 conn_handle, u16 att_handle, u8 *data, u16 len, att_op_type_e op_type)
+{
+    host_pdu_t *pdu;
+
+    (void)op_type;
+
+    if (!conn_handle || len > HOST_BLE_PDU_MAX) {
+        return GATT_CMD_PARAM_ERROR;
+    }
+    if (!g_ble_notify) {
+        return GATT_CMD_USE_CCC_FAIL;
+    }
+    if (g_ble_bytes + len > g_ble_capacity || g_ble_count == HOST_BLE_QUEUE_MAX) {
+        return GATT_BUFFER_FULL;
+    }
+    pdu = &g_ble_queue[(g_ble_head + g_ble_count) % HOST_BLE_QUEUE_MAX];
+    pdu->att_handle = att_handle;
+    pdu->len = len;
+    memcpy(pdu->data, data, len);
+    g_ble_count++;
+    g_ble_bytes += len;
+    return 0;
+}
+
+/* Weak like in le_gatt_common.c, vm_mem_pool.c overrides them */
+__attribute__((weak))
+void *ble_comm_ram_malloc(u32 size)
+{
+    return calloc(1, size);
+}
+
+__attribute__((weak))
+void ble_comm_ram_free(void *ptr)
+{
+    free(ptr);
+}
+
+static u8 g_ble_adv = 0;
+
+ble_state_e ble_gatt_server_get_work_state(void)
+{
+    return g_ble_adv ? BLE_ST_ADV : BLE_ST_IDLE;
+}
+
+int ble_gatt_server_adv_enable(u32 en)
+{
+    g_ble_adv = en ? 1 : 0;
+    return 0;
+}
+
+int ble_gatt_server_characteristic_ccc_set(u16 conn_handle, u16 att_ccc_handle, u16 ccc_config)
+{
+    return 0;
+}
+
+void ble_gatt_server_set_profile(const u8 *profile_table, u16 size)
+{
+}
+
+/* ========== syscfg ========== */
+
+#define HOST_SYSCFG_ITEMS       256
+#define HOST_SYSCFG_ITEM_MAX    512
+
+typedef struct {
+    u16 len;
+    u8 valid;
+    u8 data[HOST_SYSCFG_ITEM_MAX];
+} host_syscfg_item_t;
+
+static host_syscfg_item_t g_syscfg[HOST_SYSCFG_ITEMS];
+static u32 g_syscfg_writes[HOST_SYSCFG_ITEMS];
+
+void host_syscfg_reset(void)
+{
+    memset(g_syscfg, 0, sizeof(g_syscfg));
+    memset(g_syscfg_writes, 0, sizeof(g_syscfg_writes));
+}
+
+u32 host_syscfg_writes(u16 item_id)
+{
+    return item_id < HOST_SYSCFG_ITEMS ? g_syscfg_writes[item_id] : 0;
+}
+
+int syscfg_read(u16 item_id, void *buf, u16 len)
+{
+    host_syscfg_item_t *item;
+
+    if (item_id >= HOST_SYSCFG_ITEMS || !g_syscfg[item_id].valid) {
+        return -1;
+    }
+    item = &g_syscfg[item_id];
+    if (len > item->len) {
+        len = item->len;
+    }
+    memcpy(buf, item->data, len);
+    return len;
+}
+
+int syscfg_write(u16 item_id, void *buf, u16 len)
+{
+    host_syscfg_item_t *item;
+
+    if (item_id >= HOST_SYSCFG_ITEMS || len > HOST_SYSCFG_ITEM_MAX) {
+        return -1;
+    }
+    item = &g_syscfg[item_id];
+    memcpy(item->data, buf, len);
+    item->len = len;
+    item->valid = 1;
+    g_syscfg_writes[item_id]++;
+    return len;
+}
+
+/* ========== UART ========== */
+
+#define HOST_UART_CAPTURE   (64 * 1024)
+
+static u8 g_uart[HOST_UART_CAPTURE];
+static u32 g_uart_len = 0;
+
+void putbyte(char c)
+{
+    if (g_uart_len < sizeof(g_uart)) {
+        g_uart[g_uart_len++] = (u8)c;
+    }
+}
+
+u32 host_uart_take(u8 *buf, u32 size)
+{
+    u32 n = (g_uart_len < size) ? g_uart_len : size;
+
+    memcpy(buf, g_uart, n);
+    memmove(g_uart, g_uart + n, g_uart_len - n);
+    g_uart_len -= n;
+    return n;
+}
+
+/* ========== Misc ========== */
+
+u8 get_vbat_percent(void)
+{
+    return 100;
+}
+
+int host_printf(const char *fmt, ...)
+{
+    static int verbose = -1;
+    va_list ap;
+    int n;
+
+    if (verbose < 0) {
+        verbose = getenv("HOST_VERBOSE") != NULL;
+    }
+    if (!verbose) {
+        return 0;
+    }
+    va_start(ap, fmt);
+    n = vprintf(fmt, ap);
+    va_end(ap);
+    return n;
+}
+
+/* ========== Checks ========== */
+
+/* Shared, so checks made in host_boot() children count */
+static struct {
+    u32 checks;
+    u32 failed;
+} *g_tally;
+
+__attribute__((constructor))
+static void host_init(void)
+{
+    g_tally = host_shared(sizeof(*g_tally));
+    flash_map();
+}
+
+void host_check(int ok, const char *name, const char *fmt, ...)
+{
+    va_list ap;
+
+    g_tally->checks++;
+    g_tally->failed += !ok;
+    printf("%s %s", ok ? "PASS" : "FAIL", name);
+    if (fmt && fmt[0]) {
+        printf(": ");
+        va_start(ap, fmt);
+        vprintf(fmt, ap);
+        va_end(ap);
+    }
+    printf("\n");
+}
+
+void host_note(const char *fmt, ...)
+{
+    va_list ap;
+
+    va_start(ap, fmt);
+    vprintf(fmt, ap);
+    va_end(ap);
+}
+
+int host_report(const char *suite)
+{
+    printf("%s: %u/%u passed\n", suite, g_tally->checks - g_tally->failed, g_tally->checks);
+    return g_tally->failed ? 1 : 0;
+}
@@ -0,0 +1,171 @@
+/**
+ * Host Test Runtime
+ *
+ * Runs firmware modules on the PC against the stub headers in sdk/:
+ *
+ *   time      virtual clock in microseconds; sys_timer / sys_timeout
+ *             callbacks fire from host_run_ms(), flash operations advance
+ *             the clock by their typical duration
+ *   flash     1 MB NOR model (erase to 0xFF per 4 KB sector, program only
+ *             clears bits) with per-sector erase counts and power-cut
+ *             injection on the n-th erase or program
+ *   boots     host_boot() runs one power cycle in a child process, so the
+ *             module statics start from scratch while flash (and
+ *             host_shared() memory) carries over
+ *   BLE       notifications go into a TX buffer of configurable size,
+ *             drained by the test as the link would
+ *   syscfg    in-RAM items with write counters
+ *   UART      putbyte() output captured for the test
+ *
+ * Firmware printf output is dropped unless HOST_VERBOSE is set in the
+ * environment. Checks print one line each; host_report() prints the
+ * total and returns the exit code.
+ */
+
+#ifndef HOST_SDK_H
+#define HOST_SDK_H
+
+#include "typedef.h"
+
+/* ========== Time ========== */
+
+u64 host_now_us(void);
+void host_advance_us(u64 us);
+
+/**
+ * Advance the clock by ms, firing due timers in order
+ */
+void host_run_ms(u32 ms);
+
+/**
+ * Timers and timeouts armed
+ */
+u32 host_timers_active(void);
+
+/**
+ * Longest single timer callback (virtual time) since the last call
+ */
+u64 host_timer_longest_us(void);
+
+/* ========== Flash ========== */
+
+#define HOST_FLASH_SIZE             (1024 * 1024)
+#define HOST_FLASH_SECTOR           4096
+#define HOST_FLASH_SECTORS          (HOST_FLASH_SIZE / HOST_FLASH_SECTOR)
+
+/* Typical SPI NOR timings (4 KB sector erase, 256 B page program, 256 B read) */
+#define HOST_FLASH_ERASE_US         45000
+#define HOST_FLASH_PROGRAM_US       700
+#define HOST_FLASH_READ_US          25
+
+typedef struct {
+    u32 erases[HOST_FLASH_SECTORS];
+    u32 programs;           /* norflash_write calls */
+    u32 program_bytes;
+    u32 reads;
+    u32 read_bytes;
+    u32 ops;                /* Erases and programs, counted for power cuts */
+    u32 cut_at;             /* Cut power during this op (0: never) */
+} host_flash_stats_t;
+
+u8 *host_flash(void);
+host_flash_stats_t *host_flash_stats(void);
+
+/**
+ * Erase the whole model to 0xFF and clear the counters
+ */
+void host_flash_reset(void);
+
+/**
+ * Cut power during the n-th erase or program from now (0: never).
+ * An erase leaves the first half of its sector erased, a program writes
+ * the first half of its bytes; then the boot ends with HOST_BOOT_CUT
+ */
+void host_flash_cut_at(u32 n);
+
+/* ========== Power cycles ========== */
+
+#define HOST_BOOT_DONE      0   /* fn returned */
+#define HOST_BOOT_RESET     1   /* cpu_reset() */
+#define HOST_BOOT_CUT       2   /* Power cut by host_flash_cut_at() */
+#define HOST_BOOT_CRASH     3   /* Anything else */
+
+/**
+ * Run fn(arg) as one power cycle in a child process
+ * @return HOST_BOOT_*
+ */
+int host_boot(void (*fn)(void *arg), void *arg);
+
+/**
+ * Memory shared with boot children (zeroed, never freed)
+ */
+void *host_shared(size_t size);
+
+/**
+ * Make cpu_reset() inside host_boot() count like outside instead of
+ * ending the boot
+ */
+void host_reset_continue(u8 on);
+
+/**
+ * cpu_reset() calls that did not end a boot, and the time of the last one
+ */
+u32 host_resets(void);
+u64 host_last_reset_us(void);
+
+/* ========== BLE ========== */
+
+/**
+ * Empty the TX buffer and set its size (gatt_ctrl_t cbuffer_size)
+ */
+void host_ble_reset(u16 capacity);
+
+/**
+ * CCC state of the peer; sends fail with GATT_CMD_USE_CCC_FAIL while off
+ */
+void host_ble_set_notify(u8 enabled);
+
+/**
+ * Take the oldest notification out of the TX buffer
+ * @return Its length, 0 if the buffer is empty
+ */
+u16 host_ble_pop(u16 *att_handle, u8 *buf, u16 size);
+
+/**
+ * Bytes waiting in the TX buffer
+ */
+u16 host_ble_queued(void);
+
+/* ========== syscfg ========== */
+
+void host_syscfg_reset(void);
+u32 host_syscfg_writes(u16 item_id);
+
+/* ========== UART ========== */
+
+/**
+ * Take the bytes sent with putbyte() since the last call (the oldest
+ * ones if there are more than size)
+ * @return Bytes copied
+ */
+u32 host_uart_take(u8 *buf, u32 size);
+
+/* ========== Checks ========== */
+
+#define HOST_CHECK(cond, name, ...)     host_check(!!(cond), name, __VA_ARGS__)
+
+void host_check(int ok, const char *name, const char *fmt, ...)
+    __attribute__((format(__printf__, 3, 4)));
+
+/**
+ * Report output (not dropped like firmware printf)
+ */
+void host_note(const char *fmt, ...) __attribute__((format(__printf__, 1, 2)));
+
+/**
+ * Print the totals
+ * @return Process exit code, 0 if every check passed
+ */
+int host_report(const char *suite);
+
+#endif /* HOST_SDK_H */
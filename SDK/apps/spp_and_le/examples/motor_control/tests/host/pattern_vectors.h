@@ -0,0 +1,1076 @@
+/* Generated by gen_pattern_vectors.mjs from utils/pattern-codec.js, do not edit (make vectors) */
+
+static const vm_pattern_frame_t gentle_waves_frames[] = {
+    {0, 51},
+    {1000, 102},
+    {2000, 153},
+    {3000, 204},
+    {4000, 153},
+    {5000, 102},
+    {6000, 51},
+    {7000, 102},
+    {8000, 153},
+    {9000, 102},
+    {10000, 102},
+};
+
+static const u8 gentle_waves_bare[] = {
+    0x44, 0x50, 0x01, 0x01, 0x90, 0x4e, 0x0b, 0x00, 0x66, 0xd1, 0x0f, 0x66,
+    0x01, 0xd1, 0x0f, 0x65, 0x01, 0xd1, 0x0f, 0x66, 0x00, 0xd0, 0x0f, 0x65,
+    0xd0, 0x0f, 0x00, 0x59, 0xf7,
+};
+
+static const u8 gentle_waves_meta[] = {
+    0x44, 0x50, 0x01, 0x03, 0x90, 0x4e, 0x0b, 0xad, 0x01, 0x7b, 0x22, 0x69,
+    0x64, 0x22, 0x3a, 0x22, 0x67, 0x65, 0x6e, 0x74, 0x6c, 0x65, 0x5f, 0x77,
+    0x61, 0x76, 0x65, 0x73, 0x22, 0x2c, 0x22, 0x6e, 0x61, 0x6d, 0x65, 0x22,
+    0x3a, 0x22, 0x47, 0x65, 0x6e, 0x74, 0x6c, 0x65, 0x20, 0x57, 0x61, 0x76,
+    0x65, 0x73, 0x22, 0x2c, 0x22, 0x6e, 0x61, 0x6d, 0x65, 0x5f, 0x73, 0x70,
+    0x22, 0x3a, 0x22, 0x4f, 0x6e, 0x64, 0x61, 0x73, 0x20, 0x53, 0x75, 0x61,
+    0x76, 0x65, 0x73, 0x22, 0x2c, 0x22, 0x64, 0x65, 0x73, 0x63, 0x72, 0x69,
+    0x70, 0x74, 0x69, 0x6f, 0x6e, 0x22, 0x3a, 0x22, 0x47, 0x65, 0x6e, 0x74,
+    0x6c, 0x65, 0x20, 0x77, 0x61, 0x76, 0x65, 0x73, 0x2c, 0x20, 0x72, 0x65,
+    0x6c, 0x61, 0x78, 0x69, 0x6e, 0x67, 0x22, 0x2c, 0x22, 0x64, 0x65, 0x73,
+    0x63, 0x72, 0x69, 0x70, 0x74, 0x69, 0x6f, 0x6e, 0x5f, 0x73, 0x70, 0x22,
+    0x3a, 0x22, 0x4f, 0x6e, 0x64, 0x61, 0x73, 0x20, 0x73, 0x75, 0x61, 0x76,
+    0x65, 0x73, 0x2c, 0x20, 0x72, 0x65, 0x6c, 0x61, 0x6a, 0x61, 0x6e, 0x74,
+    0x65, 0x73, 0x22, 0x2c, 0x22, 0x63, 0x61, 0x74, 0x65, 0x67, 0x6f, 0x72,
+    0x79, 0x22, 0x3a, 0x22, 0x72, 0x65, 0x6c, 0x61, 0x78, 0x69, 0x6e, 0x67,
+    0x22, 0x7d, 0x00, 0x66, 0xd1, 0x0f, 0x66, 0x01, 0xd1, 0x0f, 0x65, 0x01,
+    0xd1, 0x0f, 0x66, 0x00, 0xd0, 0x0f, 0x65, 0xd0, 0x0f, 0x00, 0x97, 0xe9,
+};
+
+static const vm_pattern_frame_t meditation_flow_frames[] = {
+    {0, 102},
+    {1000, 102},
+    {2000, 102},
+    {3000, 102},
+    {4000, 102},
+    {5000, 102},
+    {6000, 102},
+    {7000, 102},
+    {8000, 102},
+    {9000, 102},
+    {10000, 102},
+};
+
+static const u8 meditation_flow_bare[] = {
+    0x44, 0x50, 0x01, 0x01, 0x90, 0x4e, 0x0b, 0x00, 0xcc, 0x01, 0xd1, 0x0f,
+    0x00, 0x08, 0xed, 0xa7,
+};
+
+static const u8 meditation_flow_meta[] = {
+    0x44, 0x50, 0x01, 0x03, 0x90, 0x4e, 0x0b, 0xda, 0x01, 0x7b, 0x22, 0x69,
+    0x64, 0x22, 0x3a, 0x22, 0x6d, 0x65, 0x64, 0x69, 0x74, 0x61, 0x74, 0x69,
+    0x6f, 0x6e, 0x5f, 0x66, 0x6c, 0x6f, 0x77, 0x22, 0x2c, 0x22, 0x6e, 0x61,
+    0x6d, 0x65, 0x22, 0x3a, 0x22, 0x4d, 0x65, 0x64, 0x69, 0x74, 0x61, 0x74,
+    0x69, 0x6f, 0x6e, 0x20, 0x46, 0x6c, 0x6f, 0x77, 0x22, 0x2c, 0x22, 0x6e,
+    0x61, 0x6d, 0x65, 0x5f, 0x73, 0x70, 0x22, 0x3a, 0x22, 0x46, 0x6c, 0x75,
+    0x6a, 0x6f, 0x20, 0x64, 0x65, 0x20, 0x4d, 0x65, 0x64, 0x69, 0x74, 0x61,
+    0x63, 0x69, 0xc3, 0xb3, 0x6e, 0x22, 0x2c, 0x22, 0x64, 0x65, 0x73, 0x63,
+    0x72, 0x69, 0x70, 0x74, 0x69, 0x6f, 0x6e, 0x22, 0x3a, 0x22, 0x4d, 0x65,
+    0x64, 0x69, 0x74, 0x61, 0x74, 0x69, 0x6f, 0x6e, 0x20, 0x66, 0x6c, 0x6f,
+    0x77, 0x2c, 0x20, 0x73, 0x74, 0x61, 0x62, 0x6c, 0x65, 0x20, 0x61, 0x6e,
+    0x64, 0x20, 0x70, 0x65, 0x61, 0x63, 0x65, 0x66, 0x75, 0x6c, 0x22, 0x2c,
+    0x22, 0x64, 0x65, 0x73, 0x63, 0x72, 0x69, 0x70, 0x74, 0x69, 0x6f, 0x6e,
+    0x5f, 0x73, 0x70, 0x22, 0x3a, 0x22, 0x46, 0x6c, 0x75, 0x6a, 0x6f, 0x20,
+    0x64, 0x65, 0x20, 0x6d, 0x65, 0x64, 0x69, 0x74, 0x61, 0x63, 0x69, 0xc3,
+    0xb3, 0x6e, 0x2c, 0x20, 0x65, 0x73, 0x74, 0x61, 0x62, 0x6c, 0x65, 0x20,
+    0x79, 0x20, 0x70, 0x61, 0x63, 0xc3, 0xad, 0x66, 0x69, 0x63, 0x6f, 0x22,
+    0x2c, 0x22, 0x63, 0x61, 0x74, 0x65, 0x67, 0x6f, 0x72, 0x79, 0x22, 0x3a,
+    0x22, 0x72, 0x65, 0x6c, 0x61, 0x78, 0x69, 0x6e, 0x67, 0x22, 0x7d, 0x00,
+    0xcc, 0x01, 0xd1, 0x0f, 0x00, 0x08, 0xf1, 0x7c,
+};
+
+static const vm_pattern_frame_t twilight_drift_frames[] = {
+    {0, 153},
+    {1000, 127},
+    {2000, 102},
+    {3000, 77},
+    {4000, 51},
+    {5000, 26},
+    {6000, 0},
+    {7000, 26},
+    {8000, 0},
+    {9000, 0},
+    {10000, 0},
+};
+
+static const u8 twilight_drift_bare[] = {
+    0x44, 0x50, 0x01, 0x01, 0x90, 0x4e, 0x0b, 0x00, 0xb2, 0x02, 0xd0, 0x0f,
+    0x33, 0xd1, 0x0f, 0x31, 0x00, 0xd0, 0x0f, 0x33, 0xd0, 0x0f, 0x31, 0xd0,
+    0x0f, 0x33, 0xd0, 0x0f, 0x34, 0xd0, 0x0f, 0x33, 0xd1, 0x0f, 0x00, 0x00,
+    0x54, 0xf3,
+};
+
+static const u8 twilight_drift_meta[] = {
+    0x44, 0x50, 0x01, 0x03, 0x90, 0x4e, 0x0b, 0xda, 0x01, 0x7b, 0x22, 0x69,
+    0x64, 0x22, 0x3a, 0x22, 0x74, 0x77, 0x69, 0x6c, 0x69, 0x67, 0x68, 0x74,
+    0x5f, 0x64, 0x72, 0x69, 0x66, 0x74, 0x22, 0x2c, 0x22, 0x6e, 0x61, 0x6d,
+    0x65, 0x22, 0x3a, 0x22, 0x54, 0x77, 0x69, 0x6c, 0x69, 0x67, 0x68, 0x74,
+    0x20, 0x44, 0x72, 0x69, 0x66, 0x74, 0x22, 0x2c, 0x22, 0x6e, 0x61, 0x6d,
+    0x65, 0x5f, 0x73, 0x70, 0x22, 0x3a, 0x22, 0x44, 0x65, 0x72, 0x69, 0x76,
+    0x61, 0x20, 0x64, 0x65, 0x6c, 0x20, 0x43, 0x72, 0x65, 0x70, 0xc3, 0xba,
+    0x73, 0x63, 0x75, 0x6c, 0x6f, 0x22, 0x2c, 0x22, 0x64, 0x65, 0x73, 0x63,
+    0x72, 0x69, 0x70, 0x74, 0x69, 0x6f, 0x6e, 0x22, 0x3a, 0x22, 0x54, 0x77,
+    0x69, 0x6c, 0x69, 0x67, 0x68, 0x74, 0x20, 0x64, 0x72, 0x69, 0x66, 0x74,
+    0x2c, 0x20, 0x72, 0x65, 0x6c, 0x61, 0x78, 0x69, 0x6e, 0x67, 0x20, 0x77,
+    0x69, 0x6e, 0x64, 0x2d, 0x64, 0x6f, 0x77, 0x6e, 0x22, 0x2c, 0x22, 0x64,
+    0x65, 0x73, 0x63, 0x72, 0x69, 0x70, 0x74, 0x69, 0x6f, 0x6e, 0x5f, 0x73,
+    0x70, 0x22, 0x3a, 0x22, 0x44, 0x65, 0x72, 0x69, 0x76, 0x61, 0x20, 0x64,
+    0x65, 0x6c, 0x20, 0x63, 0x72, 0x65, 0x70, 0xc3, 0xba, 0x73, 0x63, 0x75,
+    0x6c, 0x6f, 0x2c, 0x20, 0x72, 0x65, 0x6c, 0x61, 0x6a, 0x61, 0x63, 0x69,
+    0xc3, 0xb3, 0x6e, 0x20, 0x67, 0x72, 0x61, 0x64, 0x75, 0x61, 0x6c, 0x22,
+    0x2c, 0x22, 0x63, 0x61, 0x74, 0x65, 0x67, 0x6f, 0x72, 0x79, 0x22, 0x3a,
+    0x22, 0x72, 0x65, 0x6c, 0x61, 0x78, 0x69, 0x6e, 0x67, 0x22, 0x7d, 0x00,
+    0xb2, 0x02, 0xd0, 0x0f, 0x33, 0xd1, 0x0f, 0x31, 0x00, 0xd0, 0x0f, 0x33,
+    0xd0, 0x0f, 0x31, 0xd0, 0x0f, 0x33, 0xd0, 0x0f, 0x34, 0xd0, 0x0f, 0x33,
+    0xd1, 0x0f, 0x00, 0x00, 0x8d, 0xb6,
+};
+
+static const vm_pattern_frame_t ocean_breeze_frames[] = {
+    {0, 77},
+    {1000, 127},
+    {2000, 51},
+    {3000, 102},
+    {4000, 77},
+    {5000, 127},
+    {6000, 51},
+    {7000, 102},
+    {8000, 77},
+    {9000, 51},
+    {10000, 51},
+};
+
+static const u8 ocean_breeze_bare[] = {
+    0x44, 0x50, 0x01, 0x01, 0x90, 0x4e, 0x0b, 0x00, 0x9a, 0x01, 0xd0, 0x0f,
+    0x64, 0xd0, 0x0f, 0x97, 0x01, 0xd0, 0x0f, 0x66, 0xd0, 0x0f, 0x31, 0xd0,
+    0x0f, 0x64, 0xd0, 0x0f, 0x97, 0x01, 0xd0, 0x0f, 0x66, 0xd0, 0x0f, 0x31,
+    0xd0, 0x0f, 0x33, 0xd0, 0x0f, 0x00, 0x45, 0xd3,
+};
+
+static const u8 ocean_breeze_meta[] = {
+    0x44, 0x50, 0x01, 0x03, 0x90, 0x4e, 0x0b, 0xd8, 0x01, 0x7b, 0x22, 0x69,
+    0x64, 0x22, 0x3a, 0x22, 0x6f, 0x63, 0x65, 0x61, 0x6e, 0x5f, 0x62, 0x72,
+    0x65, 0x65, 0x7a, 0x65, 0x22, 0x2c, 0x22, 0x6e, 0x61, 0x6d, 0x65, 0x22,
+    0x3a, 0x22, 0x4f, 0x63, 0x65, 0x61, 0x6e, 0x20, 0x42, 0x72, 0x65, 0x65,
+    0x7a, 0x65, 0x22, 0x2c, 0x22, 0x6e, 0x61, 0x6d, 0x65, 0x5f, 0x73, 0x70,
+    0x22, 0x3a, 0x22, 0x42, 0x72, 0x69, 0x73, 0x61, 0x20, 0x64, 0x65, 0x6c,
+    0x20, 0x4f, 0x63, 0xc3, 0xa9, 0x61, 0x6e, 0x6f, 0x22, 0x2c, 0x22, 0x64,
+    0x65, 0x73, 0x63, 0x72, 0x69, 0x70, 0x74, 0x69, 0x6f, 0x6e, 0x22, 0x3a,
+    0x22, 0x4f, 0x63, 0x65, 0x61, 0x6e, 0x20, 0x62, 0x72, 0x65, 0x65, 0x7a,
+    0x65, 0x20, 0x6f, 0x6e, 0x20, 0x66, 0x61, 0x63, 0x65, 0x2c, 0x20, 0x6c,
+    0x69, 0x67, 0x68, 0x74, 0x20, 0x61, 0x6e, 0x64, 0x20, 0x61, 0x69, 0x72,
+    0x79, 0x22, 0x2c, 0x22, 0x64, 0x65, 0x73, 0x63, 0x72, 0x69, 0x70, 0x74,
+    0x69, 0x6f, 0x6e, 0x5f, 0x73, 0x70, 0x22, 0x3a, 0x22, 0x42, 0x72, 0x69,
+    0x73, 0x61, 0x20, 0x64, 0x65, 0x6c, 0x20, 0x6f, 0x63, 0xc3, 0xa9, 0x61,
+    0x6e, 0x6f, 0x20, 0x65, 0x6e, 0x20, 0x65, 0x6c, 0x20, 0x72, 0x6f, 0x73,
+    0x74, 0x72, 0x6f, 0x2c, 0x20, 0x6c, 0x69, 0x67, 0x65, 0x72, 0x61, 0x20,
+    0x79, 0x20, 0x61, 0x69, 0x72, 0x65, 0x61, 0x64, 0x61, 0x22, 0x2c, 0x22,
+    0x63, 0x61, 0x74, 0x65, 0x67, 0x6f, 0x72, 0x79, 0x22, 0x3a, 0x22, 0x72,
+    0x65, 0x6c, 0x61, 0x78, 0x69, 0x6e, 0x67, 0x22, 0x7d, 0x00, 0x9a, 0x01,
+    0xd0, 0x0f, 0x64, 0xd0, 0x0f, 0x97, 0x01, 0xd0, 0x0f, 0x66, 0xd0, 0x0f,
+    0x31, 0xd0, 0x0f, 0x64, 0xd0, 0x0f, 0x97, 0x01, 0xd0, 0x0f, 0x66, 0xd0,
+    0x0f, 0x31, 0xd0, 0x0f, 0x33, 0xd0, 0x0f, 0x00, 0x12, 0x02,
+};
+
+static const vm_pattern_frame_t power_pulse_frames[] = {
+    {0, 229},
+    {1000, 229},
+    {2000, 229},
+    {3000, 229},
+    {4000, 229},
+    {5000, 229},
+    {6000, 229},
+    {7000, 229},
+    {8000, 229},
+    {9000, 229},
+    {10000, 229},
+};
+
+static const u8 power_pulse_bare[] = {
+    0x44, 0x50, 0x01, 0x01, 0x90, 0x4e, 0x0b, 0x00, 0xca, 0x03, 0xd1, 0x0f,
+    0x00, 0x08, 0x8f, 0x6e,
+};
+
+static const u8 power_pulse_meta[] = {
+    0x44, 0x50, 0x01, 0x03, 0x90, 0x4e, 0x0b, 0xc0, 0x01, 0x7b, 0x22, 0x69,
+    0x64, 0x22, 0x3a, 0x22, 0x70, 0x6f, 0x77, 0x65, 0x72, 0x5f, 0x70, 0x75,
+    0x6c, 0x73, 0x65, 0x22, 0x2c, 0x22, 0x6e, 0x61, 0x6d, 0x65, 0x22, 0x3a,
+    0x22, 0x50, 0x6f, 0x77, 0x65, 0x72, 0x20, 0x50, 0x75, 0x6c, 0x73, 0x65,
+    0x22, 0x2c, 0x22, 0x6e, 0x61, 0x6d, 0x65, 0x5f, 0x73, 0x70, 0x22, 0x3a,
+    0x22, 0x50, 0x75, 0x6c, 0x73, 0x6f, 0x20, 0x64, 0x65, 0x20, 0x50, 0x6f,
+    0x64, 0x65, 0x72, 0x22, 0x2c, 0x22, 0x64, 0x65, 0x73, 0x63, 0x72, 0x69,
+    0x70, 0x74, 0x69, 0x6f, 0x6e, 0x22, 0x3a, 0x22, 0x50, 0x6f, 0x77, 0x65,
+    0x72, 0x66, 0x75, 0x6c, 0x20, 0x70, 0x75, 0x6c, 0x73, 0x65, 0x2c, 0x20,
+    0x65, 0x6e, 0x65, 0x72, 0x67, 0x79, 0x20, 0x62, 0x6f, 0x6f, 0x73, 0x74,
+    0x22, 0x2c, 0x22, 0x64, 0x65, 0x73, 0x63, 0x72, 0x69, 0x70, 0x74, 0x69,
+    0x6f, 0x6e, 0x5f, 0x73, 0x70, 0x22, 0x3a, 0x22, 0x50, 0x75, 0x6c, 0x73,
+    0x6f, 0x20, 0x70, 0x6f, 0x64, 0x65, 0x72, 0x6f, 0x73, 0x6f, 0x2c, 0x20,
+    0x69, 0x6d, 0x70, 0x75, 0x6c, 0x73, 0x6f, 0x20, 0x64, 0x65, 0x20, 0x65,
+    0x6e, 0x65, 0x72, 0x67, 0xc3, 0xad, 0x61, 0x22, 0x2c, 0x22, 0x63, 0x61,
+    0x74, 0x65, 0x67, 0x6f, 0x72, 0x79, 0x22, 0x3a, 0x22, 0x65, 0x6e, 0x65,
+    0x72, 0x67, 0x69, 0x7a, 0x69, 0x6e, 0x67, 0x22, 0x7d, 0x00, 0xca, 0x03,
+    0xd1, 0x0f, 0x00, 0x08, 0x6e, 0x0f,
+};
+
+static const vm_pattern_frame_t sunrise_awakening_frames[] = {
+    {0, 26},
+    {1000, 51},
+    {2000, 77},
+    {3000, 102},
+    {4000, 127},
+    {5000, 153},
+    {6000, 179},
+    {7000, 204},
+    {8000, 229},
+    {9000, 255},
+    {10000, 255},
+};
+
+static const u8 sunrise_awakening_bare[] = {
+    0x44, 0x50, 0x01, 0x01, 0x90, 0x4e, 0x0b, 0x00, 0x34, 0xd0, 0x0f, 0x32,
+    0xd0, 0x0f, 0x34, 0xd1, 0x0f, 0x32, 0x00, 0xd1, 0x0f, 0x34, 0x00, 0xd1,
+    0x0f, 0x32, 0x00, 0xd0, 0x0f, 0x34, 0xd0, 0x0f, 0x00, 0x41, 0xb4,
+};
+
+static const u8 sunrise_awakening_meta[] = {
+    0x44, 0x50, 0x01, 0x03, 0x90, 0x4e, 0x0b, 0xee, 0x01, 0x7b, 0x22, 0x69,
+    0x64, 0x22, 0x3a, 0x22, 0x73, 0x75, 0x6e, 0x72, 0x69, 0x73, 0x65, 0x5f,
+    0x61, 0x77, 0x61, 0x6b, 0x65, 0x6e, 0x69, 0x6e, 0x67, 0x22, 0x2c, 0x22,
+    0x6e, 0x61, 0x6d, 0x65, 0x22, 0x3a, 0x22, 0x53, 0x75, 0x6e, 0x72, 0x69,
+    0x73, 0x65, 0x20, 0x41, 0x77, 0x61, 0x6b, 0x65, 0x6e, 0x69, 0x6e, 0x67,
+    0x22, 0x2c, 0x22, 0x6e, 0x61, 0x6d, 0x65, 0x5f, 0x73, 0x70, 0x22, 0x3a,
+    0x22, 0x44, 0x65, 0x73, 0x70, 0x65, 0x72, 0x74, 0x61, 0x72, 0x20, 0x64,
+    0x65, 0x6c, 0x20, 0x41, 0x6d, 0x61, 0x6e, 0x65, 0x63, 0x65, 0x72, 0x22,
+    0x2c, 0x22, 0x64, 0x65, 0x73, 0x63, 0x72, 0x69, 0x70, 0x74, 0x69, 0x6f,
+    0x6e, 0x22, 0x3a, 0x22, 0x53, 0x75, 0x6e, 0x72, 0x69, 0x73, 0x65, 0x20,
+    0x61, 0x77, 0x61, 0x6b, 0x65, 0x6e, 0x69, 0x6e, 0x67, 0x2c, 0x20, 0x67,
+    0x72, 0x61, 0x64, 0x75, 0x61, 0x6c, 0x6c, 0x79, 0x20, 0x73, 0x74, 0x72,
+    0x65, 0x6e, 0x67, 0x74, 0x68, 0x65, 0x6e, 0x69, 0x6e, 0x67, 0x22, 0x2c,
+    0x22, 0x64, 0x65, 0x73, 0x63, 0x72, 0x69, 0x70, 0x74, 0x69, 0x6f, 0x6e,
+    0x5f, 0x73, 0x70, 0x22, 0x3a, 0x22, 0x44, 0x65, 0x73, 0x70, 0x65, 0x72,
+    0x74, 0x61, 0x72, 0x20, 0x64, 0x65, 0x6c, 0x20, 0x61, 0x6d, 0x61, 0x6e,
+    0x65, 0x63, 0x65, 0x72, 0x2c, 0x20, 0x66, 0x6f, 0x72, 0x74, 0x61, 0x6c,
+    0x65, 0x63, 0x69, 0x6d, 0x69, 0x65, 0x6e, 0x74, 0x6f, 0x20, 0x67, 0x72,
+    0x61, 0x64, 0x75, 0x61, 0x6c, 0x22, 0x2c, 0x22, 0x63, 0x61, 0x74, 0x65,
+    0x67, 0x6f, 0x72, 0x79, 0x22, 0x3a, 0x22, 0x65, 0x6e, 0x65, 0x72, 0x67,
+    0x69, 0x7a, 0x69, 0x6e, 0x67, 0x22, 0x7d, 0x00, 0x34, 0xd0, 0x0f, 0x32,
+    0xd0, 0x0f, 0x34, 0xd1, 0x0f, 0x32, 0x00, 0xd1, 0x0f, 0x34, 0x00, 0xd1,
+    0x0f, 0x32, 0x00, 0xd0, 0x0f, 0x34, 0xd0, 0x0f, 0x00, 0xe5, 0x93,
+};
+
+static const vm_pattern_frame_t focus_booster_frames[] = {
+    {0, 179},
+    {1000, 179},
+    {2000, 179},
+    {3000, 179},
+    {4000, 179},
+    {5000, 179},
+    {6000, 179},
+    {7000, 179},
+    {8000, 179},
+    {9000, 179},
+    {10000, 179},
+};
+
+static const u8 focus_booster_bare[] = {
+    0x44, 0x50, 0x01, 0x01, 0x90, 0x4e, 0x0b, 0x00, 0xe6, 0x02, 0xd1, 0x0f,
+    0x00, 0x08, 0x35, 0xfa,
+};
+
+static const u8 focus_booster_meta[] = {
+    0x44, 0x50, 0x01, 0x03, 0x90, 0x4e, 0x0b, 0xe4, 0x01, 0x7b, 0x22, 0x69,
+    0x64, 0x22, 0x3a, 0x22, 0x66, 0x6f, 0x63, 0x75, 0x73, 0x5f, 0x62, 0x6f,
+    0x6f, 0x73, 0x74, 0x65, 0x72, 0x22, 0x2c, 0x22, 0x6e, 0x61, 0x6d, 0x65,
+    0x22, 0x3a, 0x22, 0x46, 0x6f, 0x63, 0x75, 0x73, 0x20, 0x42, 0x6f, 0x6f,
+    0x73, 0x74, 0x65, 0x72, 0x22, 0x2c, 0x22, 0x6e, 0x61, 0x6d, 0x65, 0x5f,
+    0x73, 0x70, 0x22, 0x3a, 0x22, 0x50, 0x6f, 0x74, 0x65, 0x6e, 0x63, 0x69,
+    0x61, 0x64, 0x6f, 0x72, 0x20, 0x64, 0x65, 0x20, 0x43, 0x6f, 0x6e, 0x63,
+    0x65, 0x6e, 0x74, 0x72, 0x61, 0x63, 0x69, 0xc3, 0xb3, 0x6e, 0x22, 0x2c,
+    0x22, 0x64, 0x65, 0x73, 0x63, 0x72, 0x69, 0x70, 0x74, 0x69, 0x6f, 0x6e,
+    0x22, 0x3a, 0x22, 0x46, 0x6f, 0x63, 0x75, 0x73, 0x20, 0x65, 0x6e, 0x68,
+    0x61, 0x6e, 0x63, 0x65, 0x6d, 0x65, 0x6e, 0x74, 0x2c, 0x20, 0x73, 0x74,
+    0x61, 0x62, 0x6c, 0x65, 0x20, 0x63, 0x6f, 0x6e, 0x63, 0x65, 0x6e, 0x74,
+    0x72, 0x61, 0x74, 0x69, 0x6f, 0x6e, 0x22, 0x2c, 0x22, 0x64, 0x65, 0x73,
+    0x63, 0x72, 0x69, 0x70, 0x74, 0x69, 0x6f, 0x6e, 0x5f, 0x73, 0x70, 0x22,
+    0x3a, 0x22, 0x4d, 0x65, 0x6a, 0x6f, 0x72, 0x61, 0x20, 0x64, 0x65, 0x20,
+    0x63, 0x6f, 0x6e, 0x63, 0x65, 0x6e, 0x74, 0x72, 0x61, 0x63, 0x69, 0xc3,
+    0xb3, 0x6e, 0x2c, 0x20, 0x65, 0x6e, 0x66, 0x6f, 0x71, 0x75, 0x65, 0x20,
+    0x65, 0x73, 0x74, 0x61, 0x62, 0x6c, 0x65, 0x22, 0x2c, 0x22, 0x63, 0x61,
+    0x74, 0x65, 0x67, 0x6f, 0x72, 0x79, 0x22, 0x3a, 0x22, 0x65, 0x6e, 0x65,
+    0x72, 0x67, 0x69, 0x7a, 0x69, 0x6e, 0x67, 0x22, 0x7d, 0x00, 0xe6, 0x02,
+    0xd1, 0x0f, 0x00, 0x08, 0x26, 0xb6,
+};
+
+static const vm_pattern_frame_t rhythmic_dance_frames[] = {
+    {0, 204},
+    {1000, 51},
+    {2000, 204},
+    {3000, 51},
+    {4000, 153},
+    {5000, 102},
+    {6000, 153},
+    {7000, 102},
+    {8000, 204},
+    {9000, 51},
+    {10000, 51},
+};
+
+static const u8 rhythmic_dance_bare[] = {
+    0x44, 0x50, 0x01, 0x01, 0x90, 0x4e, 0x0b, 0x00, 0x98, 0x03, 0xd0, 0x0f,
+    0xb1, 0x02, 0xd0, 0x0f, 0xb2, 0x02, 0xd0, 0x0f, 0xb1, 0x02, 0xd0, 0x0f,
+    0xcc, 0x01, 0xd0, 0x0f, 0x65, 0xd0, 0x0f, 0x66, 0xd0, 0x0f, 0x65, 0xd0,
+    0x0f, 0xcc, 0x01, 0xd0, 0x0f, 0xb1, 0x02, 0xd0, 0x0f, 0x00, 0xbe, 0x4d,
+};
+
+static const u8 rhythmic_dance_meta[] = {
+    0x44, 0x50, 0x01, 0x03, 0x90, 0x4e, 0x0b, 0xb1, 0x01, 0x7b, 0x22, 0x69,
+    0x64, 0x22, 0x3a, 0x22, 0x72, 0x68, 0x79, 0x74, 0x68, 0x6d, 0x69, 0x63,
+    0x5f, 0x64, 0x61, 0x6e, 0x63, 0x65, 0x22, 0x2c, 0x22, 0x6e, 0x61, 0x6d,
+    0x65, 0x22, 0x3a, 0x22, 0x52, 0x68, 0x79, 0x74, 0x68, 0x6d, 0x69, 0x63,
+    0x20, 0x44, 0x61, 0x6e, 0x63, 0x65, 0x22, 0x2c, 0x22, 0x6e, 0x61, 0x6d,
+    0x65, 0x5f, 0x73, 0x70, 0x22, 0x3a, 0x22, 0x44, 0x61, 0x6e, 0x7a, 0x61,
+    0x20, 0x52, 0xc3, 0xad, 0x74, 0x6d, 0x69, 0x63, 0x61, 0x22, 0x2c, 0x22,
+    0x64, 0x65, 0x73, 0x63, 0x72, 0x69, 0x70, 0x74, 0x69, 0x6f, 0x6e, 0x22,
+    0x3a, 0x22, 0x52, 0x68, 0x79, 0x74, 0x68, 0x6d, 0x69, 0x63, 0x20, 0x64,
+    0x61, 0x6e, 0x63, 0x65, 0x2c, 0x20, 0x6c, 0x69, 0x76, 0x65, 0x6c, 0x79,
+    0x22, 0x2c, 0x22, 0x64, 0x65, 0x73, 0x63, 0x72, 0x69, 0x70, 0x74, 0x69,
+    0x6f, 0x6e, 0x5f, 0x73, 0x70, 0x22, 0x3a, 0x22, 0x44, 0x61, 0x6e, 0x7a,
+    0x61, 0x20, 0x72, 0xc3, 0xad, 0x74, 0x6d, 0x69, 0x63, 0x61, 0x2c, 0x20,
+    0x61, 0x6e, 0x69, 0x6d, 0x61, 0x64, 0x61, 0x22, 0x2c, 0x22, 0x63, 0x61,
+    0x74, 0x65, 0x67, 0x6f, 0x72, 0x79, 0x22, 0x3a, 0x22, 0x64, 0x79, 0x6e,
+    0x61, 0x6d, 0x69, 0x63, 0x22, 0x7d, 0x00, 0x98, 0x03, 0xd0, 0x0f, 0xb1,
+    0x02, 0xd0, 0x0f, 0xb2, 0x02, 0xd0, 0x0f, 0xb1, 0x02, 0xd0, 0x0f, 0xcc,
+    0x01, 0xd0, 0x0f, 0x65, 0xd0, 0x0f, 0x66, 0xd0, 0x0f, 0x65, 0xd0, 0x0f,
+    0xcc, 0x01, 0xd0, 0x0f, 0xb1, 0x02, 0xd0, 0x0f, 0x00, 0xf0, 0xec,
+};
+
+static const vm_pattern_frame_t storm_rush_frames[] = {
+    {0, 255},
+    {1000, 0},
+    {2000, 255},
+    {3000, 0},
+    {4000, 204},
+    {5000, 0},
+    {6000, 255},
+    {7000, 0},
+    {8000, 255},
+    {9000, 0},
+    {10000, 0},
+};
+
+static const u8 storm_rush_bare[] = {
+    0x44, 0x50, 0x01, 0x01, 0x90, 0x4e, 0x0b, 0x00, 0xfe, 0x03, 0xd0, 0x0f,
+    0xfd, 0x03, 0xd0, 0x0f, 0xfe, 0x03, 0xd0, 0x0f, 0xfd, 0x03, 0xd0, 0x0f,
+    0x98, 0x03, 0xd0, 0x0f, 0x97, 0x03, 0xd0, 0x0f, 0xfe, 0x03, 0xd0, 0x0f,
+    0xfd, 0x03, 0xd0, 0x0f, 0xfe, 0x03, 0xd0, 0x0f, 0xfd, 0x03, 0xd0, 0x0f,
+    0x00, 0xc1, 0x87,
+};
+
+static const u8 storm_rush_meta[] = {
+    0x44, 0x50, 0x01, 0x03, 0x90, 0x4e, 0x0b, 0xbd, 0x01, 0x7b, 0x22, 0x69,
+    0x64, 0x22, 0x3a, 0x22, 0x73, 0x74, 0x6f, 0x72, 0x6d, 0x5f, 0x72, 0x75,
+    0x73, 0x68, 0x22, 0x2c, 0x22, 0x6e, 0x61, 0x6d, 0x65, 0x22, 0x3a, 0x22,
+    0x53, 0x74, 0x6f, 0x72, 0x6d, 0x20, 0x52, 0x75, 0x73, 0x68, 0x22, 0x2c,
+    0x22, 0x6e, 0x61, 0x6d, 0x65, 0x5f, 0x73, 0x70, 0x22, 0x3a, 0x22, 0x54,
+    0x6f, 0x72, 0x6d, 0x65, 0x6e, 0x74, 0x61, 0x20, 0x49, 0x6e, 0x74, 0x65,
+    0x6e, 0x73, 0x61, 0x22, 0x2c, 0x22, 0x64, 0x65, 0x73, 0x63, 0x72, 0x69,
+    0x70, 0x74, 0x69, 0x6f, 0x6e, 0x22, 0x3a, 0x22, 0x53, 0x74, 0x6f, 0x72,
+    0x6d, 0x20, 0x61, 0x6e, 0x64, 0x20, 0x72, 0x61, 0x69, 0x6e, 0x2c, 0x20,
+    0x69, 0x6e, 0x74, 0x65, 0x6e, 0x73, 0x65, 0x20, 0x62, 0x75, 0x72, 0x73,
+    0x74, 0x22, 0x2c, 0x22, 0x64, 0x65, 0x73, 0x63, 0x72, 0x69, 0x70, 0x74,
+    0x69, 0x6f, 0x6e, 0x5f, 0x73, 0x70, 0x22, 0x3a, 0x22, 0x54, 0x6f, 0x72,
+    0x6d, 0x65, 0x6e, 0x74, 0x61, 0x20, 0x79, 0x20, 0x6c, 0x6c, 0x75, 0x76,
+    0x69, 0x61, 0x2c, 0x20, 0x72, 0xc3, 0xa1, 0x66, 0x61, 0x67, 0x61, 0x20,
+    0x69, 0x6e, 0x74, 0x65, 0x6e, 0x73, 0x61, 0x22, 0x2c, 0x22, 0x63, 0x61,
+    0x74, 0x65, 0x67, 0x6f, 0x72, 0x79, 0x22, 0x3a, 0x22, 0x64, 0x79, 0x6e,
+    0x61, 0x6d, 0x69, 0x63, 0x22, 0x7d, 0x00, 0xfe, 0x03, 0xd0, 0x0f, 0xfd,
+    0x03, 0xd0, 0x0f, 0xfe, 0x03, 0xd0, 0x0f, 0xfd, 0x03, 0xd0, 0x0f, 0x98,
+    0x03, 0xd0, 0x0f, 0x97, 0x03, 0xd0, 0x0f, 0xfe, 0x03, 0xd0, 0x0f, 0xfd,
+    0x03, 0xd0, 0x0f, 0xfe, 0x03, 0xd0, 0x0f, 0xfd, 0x03, 0xd0, 0x0f, 0x00,
+    0x93, 0x39,
+};
+
+static const vm_pattern_frame_t tech_pulse_frames[] = {
+    {0, 229},
+    {1000, 0},
+    {2000, 229},
+    {3000, 0},
+    {4000, 179},
+    {5000, 0},
+    {6000, 229},
+    {7000, 0},
+    {8000, 229},
+    {9000, 0},
+    {10000, 0},
+};
+
+static const u8 tech_pulse_bare[] = {
+    0x44, 0x50, 0x01, 0x01, 0x90, 0x4e, 0x0b, 0x00, 0xca, 0x03, 0xd0, 0x0f,
+    0xc9, 0x03, 0xd0, 0x0f, 0xca, 0x03, 0xd0, 0x0f, 0xc9, 0x03, 0xd0, 0x0f,
+    0xe6, 0x02, 0xd0, 0x0f, 0xe5, 0x02, 0xd0, 0x0f, 0xca, 0x03, 0xd0, 0x0f,
+    0xc9, 0x03, 0xd0, 0x0f, 0xca, 0x03, 0xd0, 0x0f, 0xc9, 0x03, 0xd0, 0x0f,
+    0x00, 0xb5, 0x6a,
+};
+
+static const u8 tech_pulse_meta[] = {
+    0x44, 0x50, 0x01, 0x03, 0x90, 0x4e, 0x0b, 0xbe, 0x01, 0x7b, 0x22, 0x69,
+    0x64, 0x22, 0x3a, 0x22, 0x74, 0x65, 0x63, 0x68, 0x5f, 0x70, 0x75, 0x6c,
+    0x73, 0x65, 0x22, 0x2c, 0x22, 0x6e, 0x61, 0x6d, 0x65, 0x22, 0x3a, 0x22,
+    0x54, 0x65, 0x63, 0x68, 0x20, 0x50, 0x75, 0x6c, 0x73, 0x65, 0x22, 0x2c,
+    0x22, 0x6e, 0x61, 0x6d, 0x65, 0x5f, 0x73, 0x70, 0x22, 0x3a, 0x22, 0x50,
+    0x75, 0x6c, 0x73, 0x6f, 0x20, 0x54, 0x65, 0x63, 0x6e, 0x6f, 0x6c, 0xc3,
+    0xb3, 0x67, 0x69, 0x63, 0x6f, 0x22, 0x2c, 0x22, 0x64, 0x65, 0x73, 0x63,
+    0x72, 0x69, 0x70, 0x74, 0x69, 0x6f, 0x6e, 0x22, 0x3a, 0x22, 0x54, 0x65,
+    0x63, 0x68, 0x20, 0x72, 0x68, 0x79, 0x74, 0x68, 0x6d, 0x2c, 0x20, 0x6d,
+    0x6f, 0x64, 0x65, 0x72, 0x6e, 0x20, 0x66, 0x65, 0x65, 0x6c, 0x22, 0x2c,
+    0x22, 0x64, 0x65, 0x73, 0x63, 0x72, 0x69, 0x70, 0x74, 0x69, 0x6f, 0x6e,
+    0x5f, 0x73, 0x70, 0x22, 0x3a, 0x22, 0x52, 0x69, 0x74, 0x6d, 0x6f, 0x20,
+    0x74, 0x65, 0x63, 0x6e, 0x6f, 0x6c, 0xc3, 0xb3, 0x67, 0x69, 0x63, 0x6f,
+    0x2c, 0x20, 0x73, 0x65, 0x6e, 0x73, 0x61, 0x63, 0x69, 0xc3, 0xb3, 0x6e,
+    0x20, 0x6d, 0x6f, 0x64, 0x65, 0x72, 0x6e, 0x61, 0x22, 0x2c, 0x22, 0x63,
+    0x61, 0x74, 0x65, 0x67, 0x6f, 0x72, 0x79, 0x22, 0x3a, 0x22, 0x64, 0x79,
+    0x6e, 0x61, 0x6d, 0x69, 0x63, 0x22, 0x7d, 0x00, 0xca, 0x03, 0xd0, 0x0f,
+    0xc9, 0x03, 0xd0, 0x0f, 0xca, 0x03, 0xd0, 0x0f, 0xc9, 0x03, 0xd0, 0x0f,
+    0xe6, 0x02, 0xd0, 0x0f, 0xe5, 0x02, 0xd0, 0x0f, 0xca, 0x03, 0xd0, 0x0f,
+    0xc9, 0x03, 0xd0, 0x0f, 0xca, 0x03, 0xd0, 0x0f, 0xc9, 0x03, 0xd0, 0x0f,
+    0x00, 0xaf, 0xf7,
+};
+
+static const vm_pattern_frame_t ramp_frames[] = {
+    {0, 0},
+    {50, 2},
+    {100, 4},
+    {150, 6},
+    {200, 8},
+    {250, 10},
+    {300, 12},
+    {350, 14},
+    {400, 16},
+    {450, 18},
+    {500, 20},
+    {550, 22},
+    {600, 24},
+    {650, 26},
+    {700, 28},
+    {750, 30},
+    {800, 32},
+    {850, 34},
+    {900, 36},
+    {950, 38},
+    {1000, 40},
+    {1050, 42},
+    {1100, 44},
+    {1150, 46},
+    {1200, 48},
+    {1250, 50},
+    {1300, 52},
+    {1350, 54},
+    {1400, 56},
+    {1450, 58},
+    {1500, 60},
+    {1550, 62},
+    {1600, 64},
+    {1650, 66},
+    {1700, 68},
+    {1750, 70},
+    {1800, 72},
+    {1850, 74},
+    {1900, 76},
+    {1950, 78},
+    {2000, 80},
+    {2050, 82},
+    {2100, 84},
+    {2150, 86},
+    {2200, 88},
+    {2250, 90},
+    {2300, 92},
+    {2350, 94},
+    {2400, 96},
+    {2450, 98},
+    {2500, 100},
+    {2550, 102},
+    {2600, 104},
+    {2650, 106},
+    {2700, 108},
+    {2750, 110},
+    {2800, 112},
+    {2850, 114},
+    {2900, 116},
+    {2950, 118},
+    {3000, 120},
+    {3050, 122},
+    {3100, 124},
+    {3150, 126},
+    {3200, 128},
+    {3250, 130},
+    {3300, 132},
+    {3350, 134},
+    {3400, 136},
+    {3450, 138},
+    {3500, 140},
+    {3550, 142},
+    {3600, 144},
+    {3650, 146},
+    {3700, 148},
+    {3750, 150},
+    {3800, 152},
+    {3850, 154},
+    {3900, 156},
+    {3950, 158},
+    {4000, 160},
+    {4050, 162},
+    {4100, 164},
+    {4150, 166},
+    {4200, 168},
+    {4250, 170},
+    {4300, 172},
+    {4350, 174},
+    {4400, 176},
+    {4450, 178},
+    {4500, 180},
+    {4550, 182},
+    {4600, 184},
+    {4650, 186},
+    {4700, 188},
+    {4750, 190},
+    {4800, 192},
+    {4850, 194},
+    {4900, 196},
+    {4950, 198},
+    {5000, 200},
+};
+
+static const u8 ramp_bare[] = {
+    0x44, 0x50, 0x01, 0x00, 0x88, 0x27, 0x65, 0x00, 0x00, 0x65, 0x04, 0x62,
+    0x72, 0xd6,
+};
+
+static const u8 ramp_meta[] = {
+    0x44, 0x50, 0x01, 0x02, 0x88, 0x27, 0x65, 0x1b, 0x7b, 0x22, 0x69, 0x64,
+    0x22, 0x3a, 0x22, 0x72, 0x61, 0x6d, 0x70, 0x22, 0x2c, 0x22, 0x6e, 0x61,
+    0x6d, 0x65, 0x22, 0x3a, 0x22, 0x52, 0x61, 0x6d, 0x70, 0x22, 0x7d, 0x00,
+    0x00, 0x65, 0x04, 0x62, 0x90, 0x63,
+};
+
+static const vm_pattern_frame_t random_0_frames[] = {
+    {70000, 160},
+    {70000, 160},
+    {70000, 151},
+    {70020, 230},
+    {140020, 95},
+    {140020, 249},
+    {210020, 135},
+    {3210020, 135},
+    {3210020, 225},
+    {6210020, 225},
+    {6210020, 225},
+    {6280020, 148},
+};
+
+static const u8 random_0_bare[] = {
+    0x44, 0x50, 0x01, 0x00, 0xd4, 0xa6, 0xff, 0x02, 0x0c, 0xe0, 0xc5, 0x08,
+    0xc0, 0x02, 0x00, 0x00, 0x00, 0x11, 0x28, 0x9e, 0x01, 0xe0, 0xc5, 0x08,
+    0x8d, 0x02, 0x00, 0xb4, 0x02, 0xe0, 0xc5, 0x08, 0xe3, 0x01, 0x80, 0x9b,
+    0xee, 0x02, 0x00, 0x00, 0xb4, 0x01, 0x80, 0x9b, 0xee, 0x02, 0x00, 0x00,
+    0x00, 0xe0, 0xc5, 0x08, 0x99, 0x01, 0x69, 0x4f,
+};
+
+static const u8 random_0_meta[] = {
+    0x44, 0x50, 0x01, 0x02, 0xd4, 0xa6, 0xff, 0x02, 0x0c, 0x23, 0x7b, 0x22,
+    0x69, 0x64, 0x22, 0x3a, 0x22, 0x72, 0x61, 0x6e, 0x64, 0x6f, 0x6d, 0x5f,
+    0x30, 0x22, 0x2c, 0x22, 0x6e, 0x61, 0x6d, 0x65, 0x22, 0x3a, 0x22, 0x52,
+    0x61, 0x6e, 0x64, 0x6f, 0x6d, 0x20, 0x30, 0x22, 0x7d, 0xe0, 0xc5, 0x08,
+    0xc0, 0x02, 0x00, 0x00, 0x00, 0x11, 0x28, 0x9e, 0x01, 0xe0, 0xc5, 0x08,
+    0x8d, 0x02, 0x00, 0xb4, 0x02, 0xe0, 0xc5, 0x08, 0xe3, 0x01, 0x80, 0x9b,
+    0xee, 0x02, 0x00, 0x00, 0xb4, 0x01, 0x80, 0x9b, 0xee, 0x02, 0x00, 0x00,
+    0x00, 0xe0, 0xc5, 0x08, 0x99, 0x01, 0x40, 0x49,
+};
+
+static const vm_pattern_frame_t random_1_frames[] = {
+    {0, 39},
+    {0, 39},
+    {0, 208},
+    {3000000, 94},
+    {3000000, 94},
+    {3000000, 231},
+    {6000000, 199},
+    {6000000, 28},
+    {6070000, 204},
+    {6140000, 154},
+    {6210000, 141},
+    {6280000, 134},
+    {6350000, 134},
+    {6350000, 128},
+    {6351000, 113},
+    {6351000, 113},
+    {6352000, 214},
+    {9352000, 240},
+    {12352000, 173},
+    {12352000, 234},
+    {12352020, 34},
+    {12352040, 169},
+    {12422040, 249},
+    {12422040, 174},
+    {15422040, 174},
+    {18422040, 174},
+    {18422040, 93},
+    {18423040, 93},
+    {18423040, 17},
+};
+
+static const u8 random_1_bare[] = {
+    0x44, 0x50, 0x01, 0x01, 0x80, 0xba, 0xe4, 0x08, 0x1d, 0x00, 0x4e, 0x00,
+    0x00, 0x00, 0xd2, 0x02, 0x80, 0x9b, 0xee, 0x02, 0xe3, 0x01, 0x00, 0x00,
+    0x00, 0x92, 0x02, 0x80, 0x9b, 0xee, 0x02, 0x3f, 0x00, 0xd5, 0x02, 0xe0,
+    0xc5, 0x08, 0xe0, 0x02, 0xe0, 0xc5, 0x08, 0x63, 0xe0, 0xc5, 0x08, 0x19,
+    0xe0, 0xc5, 0x08, 0x0d, 0xe0, 0xc5, 0x08, 0x00, 0x00, 0x0b, 0xd0, 0x0f,
+    0x1d, 0x00, 0x00, 0xd0, 0x0f, 0xca, 0x01, 0x80, 0x9b, 0xee, 0x02, 0x34,
+    0x80, 0x9b, 0xee, 0x02, 0x85, 0x01, 0x00, 0x7a, 0x28, 0x8f, 0x03, 0x28,
+    0x8e, 0x02, 0xe0, 0xc5, 0x08, 0xa0, 0x01, 0x00, 0x95, 0x01, 0x81, 0x9b,
+    0xee, 0x02, 0x00, 0x00, 0x00, 0xa1, 0x01, 0xd0, 0x0f, 0x00, 0x00, 0x97,
+    0x01, 0x68, 0xdb,
+};
+
+static const u8 random_1_meta[] = {
+    0x44, 0x50, 0x01, 0x03, 0x80, 0xba, 0xe4, 0x08, 0x1d, 0x23, 0x7b, 0x22,
+    0x69, 0x64, 0x22, 0x3a, 0x22, 0x72, 0x61, 0x6e, 0x64, 0x6f, 0x6d, 0x5f,
+    0x31, 0x22, 0x2c, 0x22, 0x6e, 0x61, 0x6d, 0x65, 0x22, 0x3a, 0x22, 0x52,
+    0x61, 0x6e, 0x64, 0x6f, 0x6d, 0x20, 0x31, 0x22, 0x7d, 0x00, 0x4e, 0x00,
+    0x00, 0x00, 0xd2, 0x02, 0x80, 0x9b, 0xee, 0x02, 0xe3, 0x01, 0x00, 0x00,
+    0x00, 0x92, 0x02, 0x80, 0x9b, 0xee, 0x02, 0x3f, 0x00, 0xd5, 0x02, 0xe0,
+    0xc5, 0x08, 0xe0, 0x02, 0xe0, 0xc5, 0x08, 0x63, 0xe0, 0xc5, 0x08, 0x19,
+    0xe0, 0xc5, 0x08, 0x0d, 0xe0, 0xc5, 0x08, 0x00, 0x00, 0x0b, 0xd0, 0x0f,
+    0x1d, 0x00, 0x00, 0xd0, 0x0f, 0xca, 0x01, 0x80, 0x9b, 0xee, 0x02, 0x34,
+    0x80, 0x9b, 0xee, 0x02, 0x85, 0x01, 0x00, 0x7a, 0x28, 0x8f, 0x03, 0x28,
+    0x8e, 0x02, 0xe0, 0xc5, 0x08, 0xa0, 0x01, 0x00, 0x95, 0x01, 0x81, 0x9b,
+    0xee, 0x02, 0x00, 0x00, 0x00, 0xa1, 0x01, 0xd0, 0x0f, 0x00, 0x00, 0x97,
+    0x01, 0x25, 0x0d,
+};
+
+static const vm_pattern_frame_t random_2_frames[] = {
+    {0, 97},
+    {3000000, 172},
+    {3000000, 160},
+    {3070000, 57},
+    {3140000, 57},
+    {3141000, 57},
+    {3141000, 57},
+    {3142000, 94},
+    {3143000, 84},
+    {3143000, 127},
+    {3143020, 78},
+    {3143040, 100},
+    {3143040, 114},
+    {3143060, 114},
+    {6143060, 195},
+    {6144060, 195},
+    {6145060, 9},
+    {6145080, 228},
+    {6215080, 171},
+    {6216080, 9},
+    {6216080, 9},
+    {6286080, 35},
+    {9286080, 35},
+    {9287080, 35},
+    {9287100, 68},
+    {12287100, 142},
+    {12288100, 142},
+    {15288100, 142},
+    {15358100, 200},
+    {15358100, 95},
+    {15359100, 236},
+    {15429100, 236},
+    {15430100, 236},
+    {15430120, 236},
+    {15431120, 236},
+    {15431140, 236},
+    {15431160, 30},
+    {15432160, 49},
+    {18432160, 49},
+    {21432160, 49},
+    {21433160, 49},
+    {21433180, 49},
+    {21433200, 49},
+    {21433220, 21},
+    {24433220, 227},
+    {24503220, 227},
+    {24573220, 227},
+    {24574220, 165},
+    {27574220, 165},
+    {30574220, 165},
+    {30644220, 147},
+    {30644240, 93},
+    {30644260, 93},
+    {30644280, 93},
+    {30644300, 147},
+    {30714300, 147},
+    {30784300, 147},
+    {30784320, 147},
+    {30785320, 87},
+    {33785320, 87},
+    {33785340, 213},
+    {36785340, 207},
+    {36786340, 207},
+    {36786360, 207},
+    {36787360, 207},
+};
+
+static const u8 random_2_bare[] = {
+    0x44, 0x50, 0x01, 0x01, 0xa0, 0xa9, 0xc5, 0x11, 0x41, 0x00, 0xc2, 0x01,
+    0x80, 0x9b, 0xee, 0x02, 0x96, 0x01, 0x00, 0x17, 0xe0, 0xc5, 0x08, 0xcd,
+    0x01, 0xe0, 0xc5, 0x08, 0x00, 0xd0, 0x0f, 0x00, 0x00, 0x00, 0xd0, 0x0f,
+    0x4a, 0xd0, 0x0f, 0x13, 0x00, 0x56, 0x28, 0x61, 0x28, 0x2c, 0x00, 0x1c,
+    0x28, 0x00, 0x80, 0x9b, 0xee, 0x02, 0xa2, 0x01, 0xd0, 0x0f, 0x00, 0xd0,
+    0x0f, 0xf3, 0x02, 0x28, 0xb6, 0x03, 0xe0, 0xc5, 0x08, 0x71, 0xd0, 0x0f,
+    0xc3, 0x02, 0x00, 0x00, 0xe0, 0xc5, 0x08, 0x34, 0x80, 0x9b, 0xee, 0x02,
+    0x00, 0xd0, 0x0f, 0x00, 0x28, 0x42, 0x80, 0x9b, 0xee, 0x02, 0x94, 0x01,
+    0xd0, 0x0f, 0x00, 0x80, 0x9b, 0xee, 0x02, 0x00, 0xe0, 0xc5, 0x08, 0x74,
+    0x00, 0xd1, 0x01, 0xd0, 0x0f, 0x9a, 0x02, 0xe0, 0xc5, 0x08, 0x00, 0xd0,
+    0x0f, 0x00, 0x28, 0x00, 0xd0, 0x0f, 0x00, 0x28, 0x00, 0x28, 0x9b, 0x03,
+    0xd0, 0x0f, 0x26, 0x81, 0x9b, 0xee, 0x02, 0x00, 0x00, 0xd0, 0x0f, 0x00,
+    0x29, 0x00, 0x00, 0x28, 0x37, 0x80, 0x9b, 0xee, 0x02, 0x9c, 0x03, 0xe1,
+    0xc5, 0x08, 0x00, 0x00, 0xd0, 0x0f, 0x7b, 0x81, 0x9b, 0xee, 0x02, 0x00,
+    0x00, 0xe0, 0xc5, 0x08, 0x23, 0x28, 0x6b, 0x29, 0x00, 0x00, 0x28, 0x6c,
+    0xe1, 0xc5, 0x08, 0x00, 0x00, 0x28, 0x00, 0xd0, 0x0f, 0x77, 0x80, 0x9b,
+    0xee, 0x02, 0x00, 0x28, 0xfc, 0x01, 0x80, 0x9b, 0xee, 0x02, 0x0b, 0xd0,
+    0x0f, 0x00, 0x28, 0x00, 0xd0, 0x0f, 0x00, 0xee, 0x47,
+};
+
+static const u8 random_2_meta[] = {
+    0x44, 0x50, 0x01, 0x03, 0xa0, 0xa9, 0xc5, 0x11, 0x41, 0x23, 0x7b, 0x22,
+    0x69, 0x64, 0x22, 0x3a, 0x22, 0x72, 0x61, 0x6e, 0x64, 0x6f, 0x6d, 0x5f,
+    0x32, 0x22, 0x2c, 0x22, 0x6e, 0x61, 0x6d, 0x65, 0x22, 0x3a, 0x22, 0x52,
+    0x61, 0x6e, 0x64, 0x6f, 0x6d, 0x20, 0x32, 0x22, 0x7d, 0x00, 0xc2, 0x01,
+    0x80, 0x9b, 0xee, 0x02, 0x96, 0x01, 0x00, 0x17, 0xe0, 0xc5, 0x08, 0xcd,
+    0x01, 0xe0, 0xc5, 0x08, 0x00, 0xd0, 0x0f, 0x00, 0x00, 0x00, 0xd0, 0x0f,
+    0x4a, 0xd0, 0x0f, 0x13, 0x00, 0x56, 0x28, 0x61, 0x28, 0x2c, 0x00, 0x1c,
+    0x28, 0x00, 0x80, 0x9b, 0xee, 0x02, 0xa2, 0x01, 0xd0, 0x0f, 0x00, 0xd0,
+    0x0f, 0xf3, 0x02, 0x28, 0xb6, 0x03, 0xe0, 0xc5, 0x08, 0x71, 0xd0, 0x0f,
+    0xc3, 0x02, 0x00, 0x00, 0xe0, 0xc5, 0x08, 0x34, 0x80, 0x9b, 0xee, 0x02,
+    0x00, 0xd0, 0x0f, 0x00, 0x28, 0x42, 0x80, 0x9b, 0xee, 0x02, 0x94, 0x01,
+    0xd0, 0x0f, 0x00, 0x80, 0x9b, 0xee, 0x02, 0x00, 0xe0, 0xc5, 0x08, 0x74,
+    0x00, 0xd1, 0x01, 0xd0, 0x0f, 0x9a, 0x02, 0xe0, 0xc5, 0x08, 0x00, 0xd0,
+    0x0f, 0x00, 0x28, 0x00, 0xd0, 0x0f, 0x00, 0x28, 0x00, 0x28, 0x9b, 0x03,
+    0xd0, 0x0f, 0x26, 0x81, 0x9b, 0xee, 0x02, 0x00, 0x00, 0xd0, 0x0f, 0x00,
+    0x29, 0x00, 0x00, 0x28, 0x37, 0x80, 0x9b, 0xee, 0x02, 0x9c, 0x03, 0xe1,
+    0xc5, 0x08, 0x00, 0x00, 0xd0, 0x0f, 0x7b, 0x81, 0x9b, 0xee, 0x02, 0x00,
+    0x00, 0xe0, 0xc5, 0x08, 0x23, 0x28, 0x6b, 0x29, 0x00, 0x00, 0x28, 0x6c,
+    0xe1, 0xc5, 0x08, 0x00, 0x00, 0x28, 0x00, 0xd0, 0x0f, 0x77, 0x80, 0x9b,
+    0xee, 0x02, 0x00, 0x28, 0xfc, 0x01, 0x80, 0x9b, 0xee, 0x02, 0x0b, 0xd0,
+    0x0f, 0x00, 0x28, 0x00, 0xd0, 0x0f, 0x00, 0x70, 0x90,
+};
+
+static const vm_pattern_frame_t random_3_frames[] = {
+    {70000, 97},
+    {70020, 85},
+    {140020, 85},
+    {210020, 180},
+    {210040, 180},
+    {211040, 180},
+    {3211040, 180},
+    {3211060, 33},
+    {3211060, 33},
+    {6211060, 214},
+    {6211060, 214},
+    {9211060, 126},
+    {9211080, 251},
+    {9281080, 99},
+    {9282080, 99},
+    {12282080, 208},
+    {12282080, 208},
+    {12282100, 59},
+    {12282100, 56},
+    {12352100, 225},
+    {15352100, 225},
+    {15352120, 225},
+    {15352140, 209},
+    {15352140, 209},
+    {15422140, 209},
+    {15492140, 209},
+    {15493140, 109},
+    {15493140, 109},
+    {15493160, 133},
+    {15493160, 133},
+    {15493160, 133},
+    {15493160, 88},
+    {15494160, 88},
+    {15564160, 88},
+    {15564160, 234},
+    {15564180, 234},
+    {15564180, 148},
+    {15564180, 29},
+    {15564200, 29},
+    {15564220, 14},
+    {15634220, 14},
+    {15635220, 57},
+    {15635240, 57},
+    {18635240, 57},
+    {18635240, 108},
+    {18705240, 209},
+    {18775240, 209},
+    {18776240, 112},
+    {18776240, 90},
+    {18776240, 103},
+    {18777240, 103},
+    {18777240, 103},
+    {21777240, 34},
+    {21777240, 34},
+    {21847240, 149},
+    {24847240, 71},
+    {27847240, 148},
+    {27848240, 56},
+    {27848260, 163},
+    {27848280, 158},
+    {27918280, 158},
+    {27988280, 213},
+    {30988280, 213},
+    {30988280, 182},
+    {30988280, 131},
+    {33988280, 150},
+    {36988280, 150},
+    {37058280, 197},
+    {40058280, 200},
+    {40059280, 253},
+    {40059300, 253},
+    {43059300, 253},
+    {43059300, 3},
+    {46059300, 214},
+    {46129300, 214},
+    {46129320, 176},
+    {46199320, 23},
+};
+
+static const u8 random_3_bare[] = {
+    0x44, 0x50, 0x01, 0x01, 0x98, 0xe4, 0x83, 0x16, 0x4d, 0xe0, 0xc5, 0x08,
+    0xc2, 0x01, 0x28, 0x17, 0xe0, 0xc5, 0x08, 0x00, 0xe0, 0xc5, 0x08, 0xbe,
+    0x01, 0x28, 0x00, 0xd0, 0x0f, 0x00, 0x80, 0x9b, 0xee, 0x02, 0x00, 0x28,
+    0xa5, 0x02, 0x00, 0x00, 0x80, 0x9b, 0xee, 0x02, 0xea, 0x02, 0x00, 0x00,
+    0x80, 0x9b, 0xee, 0x02, 0xaf, 0x01, 0x28, 0xfa, 0x01, 0xe0, 0xc5, 0x08,
+    0xaf, 0x02, 0xd0, 0x0f, 0x00, 0x80, 0x9b, 0xee, 0x02, 0xda, 0x01, 0x00,
+    0x00, 0x28, 0xa9, 0x02, 0x00, 0x05, 0xe0, 0xc5, 0x08, 0xd2, 0x02, 0x80,
+    0x9b, 0xee, 0x02, 0x00, 0x28, 0x00, 0x28, 0x1f, 0x00, 0x00, 0xe1, 0xc5,
+    0x08, 0x00, 0x00, 0xd0, 0x0f, 0xc7, 0x01, 0x00, 0x00, 0x28, 0x30, 0x01,
+    0x00, 0x00, 0x00, 0x59, 0xd0, 0x0f, 0x00, 0xe0, 0xc5, 0x08, 0x00, 0x00,
+    0xa4, 0x02, 0x28, 0x00, 0x00, 0xab, 0x01, 0x00, 0xed, 0x01, 0x28, 0x00,
+    0x28, 0x1d, 0xe0, 0xc5, 0x08, 0x00, 0xd0, 0x0f, 0x56, 0x28, 0x00, 0x80,
+    0x9b, 0xee, 0x02, 0x00, 0x00, 0x66, 0xe0, 0xc5, 0x08, 0xca, 0x01, 0xe0,
+    0xc5, 0x08, 0x00, 0xd0, 0x0f, 0xc1, 0x01, 0x00, 0x2b, 0x00, 0x1a, 0xd0,
+    0x0f, 0x00, 0x00, 0x00, 0x80, 0x9b, 0xee, 0x02, 0x89, 0x01, 0x00, 0x00,
+    0xe0, 0xc5, 0x08, 0xe6, 0x01, 0x80, 0x9b, 0xee, 0x02, 0x9b, 0x01, 0x80,
+    0x9b, 0xee, 0x02, 0x9a, 0x01, 0xd0, 0x0f, 0xb7, 0x01, 0x28, 0xd6, 0x01,
+    0x28, 0x09, 0xe0, 0xc5, 0x08, 0x00, 0xe0, 0xc5, 0x08, 0x6e, 0x80, 0x9b,
+    0xee, 0x02, 0x00, 0x00, 0x3d, 0x00, 0x65, 0x80, 0x9b, 0xee, 0x02, 0x26,
+    0x80, 0x9b, 0xee, 0x02, 0x00, 0xe0, 0xc5, 0x08, 0x5e, 0x80, 0x9b, 0xee,
+    0x02, 0x06, 0xd0, 0x0f, 0x6a, 0x28, 0x00, 0x80, 0x9b, 0xee, 0x02, 0x00,
+    0x00, 0xf3, 0x03, 0x80, 0x9b, 0xee, 0x02, 0xa6, 0x03, 0xe0, 0xc5, 0x08,
+    0x00, 0x28, 0x4b, 0xe0, 0xc5, 0x08, 0xb1, 0x02, 0x6c, 0x15,
+};
+
+static const u8 random_3_meta[] = {
+    0x44, 0x50, 0x01, 0x03, 0x98, 0xe4, 0x83, 0x16, 0x4d, 0x23, 0x7b, 0x22,
+    0x69, 0x64, 0x22, 0x3a, 0x22, 0x72, 0x61, 0x6e, 0x64, 0x6f, 0x6d, 0x5f,
+    0x33, 0x22, 0x2c, 0x22, 0x6e, 0x61, 0x6d, 0x65, 0x22, 0x3a, 0x22, 0x52,
+    0x61, 0x6e, 0x64, 0x6f, 0x6d, 0x20, 0x33, 0x22, 0x7d, 0xe0, 0xc5, 0x08,
+    0xc2, 0x01, 0x28, 0x17, 0xe0, 0xc5, 0x08, 0x00, 0xe0, 0xc5, 0x08, 0xbe,
+    0x01, 0x28, 0x00, 0xd0, 0x0f, 0x00, 0x80, 0x9b, 0xee, 0x02, 0x00, 0x28,
+    0xa5, 0x02, 0x00, 0x00, 0x80, 0x9b, 0xee, 0x02, 0xea, 0x02, 0x00, 0x00,
+    0x80, 0x9b, 0xee, 0x02, 0xaf, 0x01, 0x28, 0xfa, 0x01, 0xe0, 0xc5, 0x08,
+    0xaf, 0x02, 0xd0, 0x0f, 0x00, 0x80, 0x9b, 0xee, 0x02, 0xda, 0x01, 0x00,
+    0x00, 0x28, 0xa9, 0x02, 0x00, 0x05, 0xe0, 0xc5, 0x08, 0xd2, 0x02, 0x80,
+    0x9b, 0xee, 0x02, 0x00, 0x28, 0x00, 0x28, 0x1f, 0x00, 0x00, 0xe1, 0xc5,
+    0x08, 0x00, 0x00, 0xd0, 0x0f, 0xc7, 0x01, 0x00, 0x00, 0x28, 0x30, 0x01,
+    0x00, 0x00, 0x00, 0x59, 0xd0, 0x0f, 0x00, 0xe0, 0xc5, 0x08, 0x00, 0x00,
+    0xa4, 0x02, 0x28, 0x00, 0x00, 0xab, 0x01, 0x00, 0xed, 0x01, 0x28, 0x00,
+    0x28, 0x1d, 0xe0, 0xc5, 0x08, 0x00, 0xd0, 0x0f, 0x56, 0x28, 0x00, 0x80,
+    0x9b, 0xee, 0x02, 0x00, 0x00, 0x66, 0xe0, 0xc5, 0x08, 0xca, 0x01, 0xe0,
+    0xc5, 0x08, 0x00, 0xd0, 0x0f, 0xc1, 0x01, 0x00, 0x2b, 0x00, 0x1a, 0xd0,
+    0x0f, 0x00, 0x00, 0x00, 0x80, 0x9b, 0xee, 0x02, 0x89, 0x01, 0x00, 0x00,
+    0xe0, 0xc5, 0x08, 0xe6, 0x01, 0x80, 0x9b, 0xee, 0x02, 0x9b, 0x01, 0x80,
+    0x9b, 0xee, 0x02, 0x9a, 0x01, 0xd0, 0x0f, 0xb7, 0x01, 0x28, 0xd6, 0x01,
+    0x28, 0x09, 0xe0, 0xc5, 0x08, 0x00, 0xe0, 0xc5, 0x08, 0x6e, 0x80, 0x9b,
+    0xee, 0x02, 0x00, 0x00, 0x3d, 0x00, 0x65, 0x80, 0x9b, 0xee, 0x02, 0x26,
+    0x80, 0x9b, 0xee, 0x02, 0x00, 0xe0, 0xc5, 0x08, 0x5e, 0x80, 0x9b, 0xee,
+    0x02, 0x06, 0xd0, 0x0f, 0x6a, 0x28, 0x00, 0x80, 0x9b, 0xee, 0x02, 0x00,
+    0x00, 0xf3, 0x03, 0x80, 0x9b, 0xee, 0x02, 0xa6, 0x03, 0xe0, 0xc5, 0x08,
+    0x00, 0x28, 0x4b, 0xe0, 0xc5, 0x08, 0xb1, 0x02, 0x9b, 0x91,
+};
+
+static const vm_pattern_frame_t random_4_frames[] = {
+    {1000, 63},
+    {3001000, 56},
+    {6001000, 116},
+    {9001000, 116},
+    {9001000, 173},
+    {9002000, 14},
+    {9002020, 14},
+    {12002020, 22},
+    {12002040, 22},
+    {12002040, 58},
+    {15002040, 58},
+    {15003040, 58},
+    {15004040, 35},
+    {15004060, 35},
+    {18004060, 37},
+    {18005060, 37},
+    {18005060, 37},
+    {18005080, 19},
+    {18005080, 40},
+    {21005080, 89},
+    {21006080, 193},
+    {24006080, 193},
+    {24006100, 193},
+    {24076100, 148},
+    {24076120, 18},
+    {24076140, 18},
+    {27076140, 58},
+    {27076140, 43},
+    {30076140, 222},
+    {30076140, 166},
+    {33076140, 166},
+    {33146140, 166},
+    {36146140, 166},
+    {36146160, 166},
+    {36146180, 166},
+    {39146180, 239},
+    {39216180, 239},
+    {39217180, 182},
+    {39287180, 182},
+    {39287180, 255},
+    {42287180, 255},
+    {42357180, 255},
+    {42358180, 255},
+    {42359180, 192},
+    {42359200, 169},
+    {45359200, 169},
+    {45359220, 169},
+    {45360220, 76},
+    {48360220, 82},
+    {51360220, 213},
+    {51361220, 209},
+    {51362220, 209},
+    {51363220, 209},
+    {51433220, 100},
+    {51434220, 196},
+    {54434220, 132},
+    {54504220, 119},
+    {54574220, 119},
+};
+
+static const u8 random_4_bare[] = {
+    0x44, 0x50, 0x01, 0x00, 0x8c, 0xf9, 0x82, 0x1a, 0x3a, 0xd0, 0x0f, 0x7e,
+    0x80, 0x9b, 0xee, 0x02, 0x0d, 0x80, 0x9b, 0xee, 0x02, 0x78, 0x80, 0x9b,
+    0xee, 0x02, 0x00, 0x00, 0x72, 0xd0, 0x0f, 0xbd, 0x02, 0x28, 0x00, 0x80,
+    0x9b, 0xee, 0x02, 0x10, 0x28, 0x00, 0x00, 0x48, 0x80, 0x9b, 0xee, 0x02,
+    0x00, 0xd0, 0x0f, 0x00, 0xd0, 0x0f, 0x2d, 0x28, 0x00, 0x80, 0x9b, 0xee,
+    0x02, 0x04, 0xd0, 0x0f, 0x00, 0x00, 0x00, 0x28, 0x23, 0x00, 0x2a, 0x80,
+    0x9b, 0xee, 0x02, 0x62, 0xd0, 0x0f, 0xd0, 0x01, 0x80, 0x9b, 0xee, 0x02,
+    0x00, 0x28, 0x00, 0xe0, 0xc5, 0x08, 0x59, 0x28, 0x83, 0x02, 0x28, 0x00,
+    0x80, 0x9b, 0xee, 0x02, 0x50, 0x00, 0x1d, 0x80, 0x9b, 0xee, 0x02, 0xe6,
+    0x02, 0x00, 0x6f, 0x80, 0x9b, 0xee, 0x02, 0x00, 0xe0, 0xc5, 0x08, 0x00,
+    0x80, 0x9b, 0xee, 0x02, 0x00, 0x29, 0x00, 0x00, 0x80, 0x9b, 0xee, 0x02,
+    0x92, 0x01, 0xe0, 0xc5, 0x08, 0x00, 0xd0, 0x0f, 0x71, 0xe0, 0xc5, 0x08,
+    0x00, 0x00, 0x92, 0x01, 0x80, 0x9b, 0xee, 0x02, 0x00, 0xe0, 0xc5, 0x08,
+    0x00, 0xd0, 0x0f, 0x00, 0xd0, 0x0f, 0x7d, 0x28, 0x2d, 0x80, 0x9b, 0xee,
+    0x02, 0x00, 0x28, 0x00, 0xd0, 0x0f, 0xb9, 0x01, 0x80, 0x9b, 0xee, 0x02,
+    0x0c, 0x80, 0x9b, 0xee, 0x02, 0x86, 0x02, 0xd0, 0x0f, 0x07, 0xd1, 0x0f,
+    0x00, 0x00, 0xe0, 0xc5, 0x08, 0xd9, 0x01, 0xd0, 0x0f, 0xc0, 0x01, 0x80,
+    0x9b, 0xee, 0x02, 0x7f, 0xe0, 0xc5, 0x08, 0x19, 0xe0, 0xc5, 0x08, 0x00,
+    0x60, 0x5d,
+};
+
+static const u8 random_4_meta[] = {
+    0x44, 0x50, 0x01, 0x02, 0x8c, 0xf9, 0x82, 0x1a, 0x3a, 0x23, 0x7b, 0x22,
+    0x69, 0x64, 0x22, 0x3a, 0x22, 0x72, 0x61, 0x6e, 0x64, 0x6f, 0x6d, 0x5f,
+    0x34, 0x22, 0x2c, 0x22, 0x6e, 0x61, 0x6d, 0x65, 0x22, 0x3a, 0x22, 0x52,
+    0x61, 0x6e, 0x64, 0x6f, 0x6d, 0x20, 0x34, 0x22, 0x7d, 0xd0, 0x0f, 0x7e,
+    0x80, 0x9b, 0xee, 0x02, 0x0d, 0x80, 0x9b, 0xee, 0x02, 0x78, 0x80, 0x9b,
+    0xee, 0x02, 0x00, 0x00, 0x72, 0xd0, 0x0f, 0xbd, 0x02, 0x28, 0x00, 0x80,
+    0x9b, 0xee, 0x02, 0x10, 0x28, 0x00, 0x00, 0x48, 0x80, 0x9b, 0xee, 0x02,
+    0x00, 0xd0, 0x0f, 0x00, 0xd0, 0x0f, 0x2d, 0x28, 0x00, 0x80, 0x9b, 0xee,
+    0x02, 0x04, 0xd0, 0x0f, 0x00, 0x00, 0x00, 0x28, 0x23, 0x00, 0x2a, 0x80,
+    0x9b, 0xee, 0x02, 0x62, 0xd0, 0x0f, 0xd0, 0x01, 0x80, 0x9b, 0xee, 0x02,
+    0x00, 0x28, 0x00, 0xe0, 0xc5, 0x08, 0x59, 0x28, 0x83, 0x02, 0x28, 0x00,
+    0x80, 0x9b, 0xee, 0x02, 0x50, 0x00, 0x1d, 0x80, 0x9b, 0xee, 0x02, 0xe6,
+    0x02, 0x00, 0x6f, 0x80, 0x9b, 0xee, 0x02, 0x00, 0xe0, 0xc5, 0x08, 0x00,
+    0x80, 0x9b, 0xee, 0x02, 0x00, 0x29, 0x00, 0x00, 0x80, 0x9b, 0xee, 0x02,
+    0x92, 0x01, 0xe0, 0xc5, 0x08, 0x00, 0xd0, 0x0f, 0x71, 0xe0, 0xc5, 0x08,
+    0x00, 0x00, 0x92, 0x01, 0x80, 0x9b, 0xee, 0x02, 0x00, 0xe0, 0xc5, 0x08,
+    0x00, 0xd0, 0x0f, 0x00, 0xd0, 0x0f, 0x7d, 0x28, 0x2d, 0x80, 0x9b, 0xee,
+    0x02, 0x00, 0x28, 0x00, 0xd0, 0x0f, 0xb9, 0x01, 0x80, 0x9b, 0xee, 0x02,
+    0x0c, 0x80, 0x9b, 0xee, 0x02, 0x86, 0x02, 0xd0, 0x0f, 0x07, 0xd1, 0x0f,
+    0x00, 0x00, 0xe0, 0xc5, 0x08, 0xd9, 0x01, 0xd0, 0x0f, 0xc0, 0x01, 0x80,
+    0x9b, 0xee, 0x02, 0x7f, 0xe0, 0xc5, 0x08, 0x19, 0xe0, 0xc5, 0x08, 0x00,
+    0x46, 0x6b,
+};
+
+static const vm_pattern_frame_t random_5_frames[] = {
+    {1000, 9},
+    {3001000, 127},
+    {3001020, 169},
+    {3001040, 169},
+    {6001040, 169},
+    {6071040, 90},
+    {6141040, 223},
+    {6141060, 34},
+    {6142060, 34},
+    {9142060, 54},
+    {12142060, 186},
+};
+
+static const u8 random_5_bare[] = {
+    0x44, 0x50, 0x01, 0x01, 0xec, 0x8b, 0xe5, 0x05, 0x0b, 0xd0, 0x0f, 0x12,
+    0x80, 0x9b, 0xee, 0x02, 0xec, 0x01, 0x28, 0x54, 0x28, 0x00, 0x80, 0x9b,
+    0xee, 0x02, 0x00, 0xe0, 0xc5, 0x08, 0x9d, 0x01, 0xe0, 0xc5, 0x08, 0x8a,
+    0x02, 0x28, 0xf9, 0x02, 0xd0, 0x0f, 0x00, 0x80, 0x9b, 0xee, 0x02, 0x28,
+    0x80, 0x9b, 0xee, 0x02, 0x88, 0x02, 0xaa, 0x78,
+};
+
+static const u8 random_5_meta[] = {
+    0x44, 0x50, 0x01, 0x03, 0xec, 0x8b, 0xe5, 0x05, 0x0b, 0x23, 0x7b, 0x22,
+    0x69, 0x64, 0x22, 0x3a, 0x22, 0x72, 0x61, 0x6e, 0x64, 0x6f, 0x6d, 0x5f,
+    0x35, 0x22, 0x2c, 0x22, 0x6e, 0x61, 0x6d, 0x65, 0x22, 0x3a, 0x22, 0x52,
+    0x61, 0x6e, 0x64, 0x6f, 0x6d, 0x20, 0x35, 0x22, 0x7d, 0xd0, 0x0f, 0x12,
+    0x80, 0x9b, 0xee, 0x02, 0xec, 0x01, 0x28, 0x54, 0x28, 0x00, 0x80, 0x9b,
+    0xee, 0x02, 0x00, 0xe0, 0xc5, 0x08, 0x9d, 0x01, 0xe0, 0xc5, 0x08, 0x8a,
+    0x02, 0x28, 0xf9, 0x02, 0xd0, 0x0f, 0x00, 0x80, 0x9b, 0xee, 0x02, 0x28,
+    0x80, 0x9b, 0xee, 0x02, 0x88, 0x02, 0x53, 0xa8,
+};
+
+static const pattern_vector_t g_vectors[] = {
+    {"gentle_waves", 10000, 1, 11, gentle_waves_frames,
+     gentle_waves_bare, sizeof(gentle_waves_bare), gentle_waves_meta, sizeof(gentle_waves_meta)},
+    {"meditation_flow", 10000, 1, 11, meditation_flow_frames,
+     meditation_flow_bare, sizeof(meditation_flow_bare), meditation_flow_meta, sizeof(meditation_flow_meta)},
+    {"twilight_drift", 10000, 1, 11, twilight_drift_frames,
+     twilight_drift_bare, sizeof(twilight_drift_bare), twilight_drift_meta, sizeof(twilight_drift_meta)},
+    {"ocean_breeze", 10000, 1, 11, ocean_breeze_frames,
+     ocean_breeze_bare, sizeof(ocean_breeze_bare), ocean_breeze_meta, sizeof(ocean_breeze_meta)},
+    {"power_pulse", 10000, 1, 11, power_pulse_frames,
+     power_pulse_bare, sizeof(power_pulse_bare), power_pulse_meta, sizeof(power_pulse_meta)},
+    {"sunrise_awakening", 10000, 1, 11, sunrise_awakening_frames,
+     sunrise_awakening_bare, sizeof(sunrise_awakening_bare), sunrise_awakening_meta, sizeof(sunrise_awakening_meta)},
+    {"focus_booster", 10000, 1, 11, focus_booster_frames,
+     focus_booster_bare, sizeof(focus_booster_bare), focus_booster_meta, sizeof(focus_booster_meta)},
+    {"rhythmic_dance", 10000, 1, 11, rhythmic_dance_frames,
+     rhythmic_dance_bare, sizeof(rhythmic_dance_bare), rhythmic_dance_meta, sizeof(rhythmic_dance_meta)},
+    {"storm_rush", 10000, 1, 11, storm_rush_frames,
+     storm_rush_bare, sizeof(storm_rush_bare), storm_rush_meta, sizeof(storm_rush_meta)},
+    {"tech_pulse", 10000, 1, 11, tech_pulse_frames,
+     tech_pulse_bare, sizeof(tech_pulse_bare), tech_pulse_meta, sizeof(tech_pulse_meta)},
+    {"ramp", 5000, 0, 101, ramp_frames,
+     ramp_bare, sizeof(ramp_bare), ramp_meta, sizeof(ramp_meta)},
+    {"random_0", 6280020, 0, 12, random_0_frames,
+     random_0_bare, sizeof(random_0_bare), random_0_meta, sizeof(random_0_meta)},
+    {"random_1", 18423040, 1, 29, random_1_frames,
+     random_1_bare, sizeof(random_1_bare), random_1_meta, sizeof(random_1_meta)},
+    {"random_2", 36787360, 1, 65, random_2_frames,
+     random_2_bare, sizeof(random_2_bare), random_2_meta, sizeof(random_2_meta)},
+    {"random_3", 46199320, 1, 77, random_3_frames,
+     random_3_bare, sizeof(random_3_bare), random_3_meta, sizeof(random_3_meta)},
+    {"random_4", 54574220, 0, 58, random_4_frames,
+     random_4_bare, sizeof(random_4_bare), random_4_meta, sizeof(random_4_meta)},
+    {"random_5", 12142060, 1, 11, random_5_frames,
+     random_5_bare, sizeof(random_5_bare), random_5_meta, sizeof(random_5_meta)},
+};
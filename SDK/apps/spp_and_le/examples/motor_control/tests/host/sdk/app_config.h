@@ -0,0 +1,10 @@
+/**
+ * Host stub: board configuration
+ */
+
+#ifndef HOST_APP_CONFIG_H
+#define HOST_APP_CONFIG_H
+
+#define CONFIG_APP_MOTOR_CONTROL    1
+
+#endif /* HOST_APP_CONFIG_H */
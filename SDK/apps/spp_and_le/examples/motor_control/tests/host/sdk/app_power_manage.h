@@ -0,0 +1,12 @@
+/**
+ * Host stub: power management
+ */
+
+#ifndef HOST_APP_POWER_MANAGE_H
+#define HOST_APP_POWER_MANAGE_H
+
+#include "typedef.h"
+
+u8 get_vbat_percent(void);
+
+#endif /* HOST_APP_POWER_MANAGE_H */
@@ -0,0 +1,11 @@
+#ifndef HOST_ASM_ADC_API_H
+#define HOST_ASM_ADC_API_H
+
+#include "typedef.h"
+
+/* Channel id only; the tests provide adc_get_voltage() */
+#define AD_CH_VBAT      0x5
+
+u32 adc_get_voltage(u32 ch);
+
+#endif
@@ -0,0 +1,13 @@
+/**
+ * Host stub: CRC16-CCITT (XMODEM), as the SDK CRC16()
+ */
+
+#ifndef HOST_ASM_CRC16_H
+#define HOST_ASM_CRC16_H
+
+#include "typedef.h"
+
+u16 CRC16(const void *ptr, u32 len);
+u16 CRC16_with_initval(const void *ptr, u32 len, u16 i_val);
+
+#endif /* HOST_ASM_CRC16_H */
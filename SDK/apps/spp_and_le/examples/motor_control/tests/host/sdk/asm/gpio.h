@@ -0,0 +1,8 @@
+#ifndef HOST_ASM_GPIO_H
+#define HOST_ASM_GPIO_H
+
+/* Pin numbers only; nothing on the host drives them */
+#define IO_PORTA_00     0
+#define IO_PORTB_05     21
+
+#endif
@@ -0,0 +1,15 @@
+/**
+ * Host stub: btstack helpers
+ */
+
+#ifndef HOST_BTSTACK_BLUETOOTH_H
+#define HOST_BTSTACK_BLUETOOTH_H
+
+#include "btstack/btstack_typedef.h"
+
+static inline u16 little_endian_read_16(const u8 *buffer, int pos)
+{
+    return (u16)(buffer[pos] | (buffer[pos + 1] << 8));
+}
+
+#endif /* HOST_BTSTACK_BLUETOOTH_H */
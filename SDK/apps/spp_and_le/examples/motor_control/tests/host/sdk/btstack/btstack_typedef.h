@@ -0,0 +1,12 @@
+/**
+ * Host stub: btstack base types
+ */
+
+#ifndef HOST_BTSTACK_TYPEDEF_H
+#define HOST_BTSTACK_TYPEDEF_H
+
+#include "typedef.h"
+
+typedef uint16_t hci_con_handle_t;
+
+#endif /* HOST_BTSTACK_TYPEDEF_H */
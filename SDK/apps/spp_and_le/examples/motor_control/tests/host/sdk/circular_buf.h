@@ -0,0 +1,29 @@
+/**
+ * Host stub: cbuffer (include_lib/system/generic/circular_buf.h)
+ */
+
+#ifndef HOST_CIRCULAR_BUF_H
+#define HOST_CIRCULAR_BUF_H
+
+#include "typedef.h"
+
+typedef struct _cbuffer {
+    u8  *begin;
+    u8  *end;
+    u8  *read_ptr;
+    u8  *write_ptr;
+    u8  *tmp_ptr ;
+    u32 tmp_len;
+    u32 data_len;
+    u32 total_len;
+    spinlock_t lock;
+} cbuffer_t;
+
+void cbuf_init(cbuffer_t *cbuffer, void *buf, u32 size);
+void *cbuf_write_alloc(cbuffer_t *cbuffer, u32 *len);
+void cbuf_write_updata(cbuffer_t *cbuffer, u32 len);
+void *cbuf_read_alloc(cbuffer_t *cbuffer, u32 *len);
+void cbuf_read_updata(cbuffer_t *cbuffer, u32 len);
+u32 cbuf_get_data_size(cbuffer_t *cbuffer);
+
+#endif /* HOST_CIRCULAR_BUF_H */
@@ -0,0 +1,103 @@
+/**
+ * Host stub: GATT common layer (apps/common/third_party_profile/jieli/
+ * gatt_common/le_gatt_common.h). Notifications go into a bounded TX
+ * buffer drained by the test (host_sdk.h)
+ */
+
+#ifndef HOST_LE_GATT_COMMON_H
+#define HOST_LE_GATT_COMMON_H
+
+#include "typedef.h"
+#include "btstack/btstack_typedef.h"
+
+typedef enum {
+    GATT_COMM_EVENT_NULL = 0,
+    GATT_COMM_EVENT_CONNECTION_COMPLETE,
+    GATT_COMM_EVENT_DISCONNECT_COMPLETE,
+    GATT_COMM_EVENT_CONNECTION_COMPLETE_FAIL,
+    GATT_COMM_EVENT_ENCRYPTION_REQUEST,
+    GATT_COMM_EVENT_ENCRYPTION_CHANGE,
+    GATT_COMM_EVENT_CAN_SEND_NOW,
+    GATT_COMM_EVENT_CONNECTION_UPDATE_COMPLETE,
+    GATT_COMM_EVENT_CONNECTION_PHY_UPDATE_COMPLETE,
+    GATT_COMM_EVENT_CONNECTION_DATA_LENGTH_CHANGE,
+    GATT_COMM_EVENT_MTU_EXCHANGE_COMPLETE = 0x20,
+} gatt_comm_event_e;
+
+typedef enum {
+    GATT_OP_RET_SUCESS = 0,
+    GATT_CMD_RET_BUSY = -100,
+    GATT_CMD_PARAM_OVERFLOW,
+    GATT_CMD_OPT_FAIL,
+    GATT_BUFFER_FULL,
+    GATT_BUFFER_ERROR,
+    GATT_CMD_PARAM_ERROR,
+    GATT_CMD_STACK_NOT_RUN,
+    GATT_CMD_USE_CCC_FAIL,
+} gatt_op_ret_e;
+
+typedef enum {
+    ATT_OP_AUTO_READ_CCC = 0,
+    ATT_OP_NOTIFY = 1,
+    ATT_OP_INDICATE = 2,
+} att_op_type_e;
+
+typedef enum {
+    BLE_ST_NULL = 0,
+    BLE_ST_INIT_OK,
+    BLE_ST_IDLE,
+    BLE_ST_CONNECT,
+    BLE_ST_SEND_DISCONN,
+    BLE_ST_DISCONN,
+    BLE_ST_CONNECT_FAIL,
+    BLE_ST_CONNECTION_UPDATE_OK,
+    BLE_ST_ADV = 0x20,
+    BLE_ST_NOTIFY_IDICATE,
+} ble_state_e;
+
+typedef struct {
+    const u8 *adv_data;
+    const u8 *rsp_data;
+    u8  adv_data_len;
+    u8  rsp_data_len;
+    u16 adv_interval;
+    u8  adv_auto_do: 4;
+    u8  adv_type: 4;
+    u8  adv_channel;
+    u8  direct_address_info[7];
+    u8  set_local_addr_tag;
+    u8  local_address_info[7];
+} adv_cfg_t;
+
+typedef struct {
+    u16(*att_read_cb)(hci_con_handle_t connection_handle, uint16_t att_handle, uint16_t offset, uint8_t *buffer, uint16_t buffer_size);
+    int (*att_write_cb)(hci_con_handle_t connection_handle, uint16_t att_handle, uint16_t transaction_mode, uint16_t offset, uint8_t *buffer, uint16_t buffer_size);
+    int (*event_packet_handler)(int event, u8 *packet, u16 size, u8 *ext_param);
+} gatt_server_cfg_t;
+
+typedef struct {
+    u8 master_security_auto_req: 1;
+    u8 master_set_wait_security: 1;
+    u8 slave_security_auto_req: 1;
+    u8 slave_set_wait_security: 1;
+    u8 io_capabilities: 4;
+    u8 authentication_req_flags;
+    u8 min_key_size;
+    u8 max_key_size;
+    int (*sm_cb_packet_handler)(uint8_t packet_type, uint16_t channel, uint8_t *packet, uint16_t size);
+} sm_cfg_t;
+
+u32 ble_comm_cbuffer_vaild_len(u16 conn_handle);
+int ble_comm_att_send_data(u16 conn_handle, u16 att_handle, u8 *data, u16 len, att_op_type_e op_type);
+void *ble_comm_ram_malloc(u32 size);
+void ble_comm_ram_free(void *ptr);
+int ble_comm_set_connection_data_phy(u16 conn_handle, u8 tx_phy, u8 rx_phy, u16 phy_options);
+
+ble_state_e ble_gatt_server_get_work_state(void);
+int ble_gatt_server_adv_enable(u32 en);
+int ble_gatt_server_characteristic_ccc_set(u16 conn_handle, u16 att_ccc_handle, u16 ccc_config);
+void ble_gatt_server_set_adv_config(adv_cfg_t *adv_cfg);
+void ble_gatt_server_set_ext_adv_config(const void *param, const void *data);
+void ble_gatt_server_set_profile(const u8 *profile_table, u16 size);
+
+#endif /* HOST_LE_GATT_COMMON_H */
@@ -0,0 +1,11 @@
+/**
+ * Host stub: LE user constants
+ */
+
+#ifndef HOST_LE_USER_H
+#define HOST_LE_USER_H
+
+#define SM_AUTHREQ_BONDING              0x01
+#define SM_AUTHREQ_SECURE_CONNECTION    0x08
+
+#endif /* HOST_LE_USER_H */
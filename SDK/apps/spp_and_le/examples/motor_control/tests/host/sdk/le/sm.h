@@ -0,0 +1,16 @@
+/**
+ * Host stub: security manager constants
+ */
+
+#ifndef HOST_LE_SM_H
+#define HOST_LE_SM_H
+
+typedef enum {
+    IO_CAPABILITY_DISPLAY_ONLY = 0,
+    IO_CAPABILITY_DISPLAY_YES_NO,
+    IO_CAPABILITY_KEYBOARD_ONLY,
+    IO_CAPABILITY_NO_INPUT_NO_OUTPUT,
+    IO_CAPABILITY_KEYBOARD_DISPLAY,
+} io_capability_t;
+
+#endif /* HOST_LE_SM_H */
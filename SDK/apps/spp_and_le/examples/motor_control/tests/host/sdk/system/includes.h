@@ -0,0 +1,26 @@
+/**
+ * Host stub: the parts of system/includes.h the firmware modules use
+ */
+
+#ifndef HOST_SYSTEM_INCLUDES_H
+#define HOST_SYSTEM_INCLUDES_H
+
+#include "typedef.h"
+#include "timer.h"
+
+/* Initcalls are run by the test instead */
+#define __initcall(fn)  \
+    static int (*const host_initcall_##fn)(void) __attribute__((unused)) = fn
+
+unsigned long jiffies_msec(void);
+
+void local_irq_disable(void);
+void local_irq_enable(void);
+
+void cpu_reset(void);
+void os_time_dly(int ticks);
+
+int syscfg_read(u16 item_id, void *buf, u16 len);
+int syscfg_write(u16 item_id, void *buf, u16 len);
+
+#endif /* HOST_SYSTEM_INCLUDES_H */
@@ -0,0 +1,16 @@
+/**
+ * Host stub: system timers (include_lib/system/timer.h), run in virtual
+ * time by host_run_ms()
+ */
+
+#ifndef HOST_TIMER_H
+#define HOST_TIMER_H
+
+#include "typedef.h"
+
+u16 sys_timer_add(void *priv, void (*func)(void *priv), u32 msec);
+void sys_timer_del(u16 id);
+u16 sys_timeout_add(void *priv, void (*func)(void *priv), u32 msec);
+void sys_timeout_del(u16 id);
+
+#endif /* HOST_TIMER_H */
@@ -0,0 +1,32 @@
+/**
+ * Host stub: SDK base types (include_lib/system/generic/typedef.h)
+ */
+
+#ifndef HOST_TYPEDEF_H
+#define HOST_TYPEDEF_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+typedef uint8_t     u8;
+typedef uint16_t    u16;
+typedef uint32_t    u32;
+typedef uint64_t    u64;
+typedef int8_t      s8;
+typedef int16_t     s16;
+typedef int32_t     s32;
+typedef int64_t     s64;
+
+typedef u8          spinlock_t;
+
+/* Firmware printf goes here (-Dprintf=host_printf), dropped unless HOST_VERBOSE */
+int host_printf(const char *fmt, ...) __attribute__((format(__printf__, 1, 2)));
+
+#ifndef BIT
+#define BIT(n)      (1UL << (n))
+#endif
+
+#endif /* HOST_TYPEDEF_H */
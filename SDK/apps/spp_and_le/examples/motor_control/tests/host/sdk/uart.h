@@ -0,0 +1,10 @@
+/**
+ * Host stub: debug UART
+ */
+
+#ifndef HOST_UART_H
+#define HOST_UART_H
+
+void putbyte(char c);
+
+#endif /* HOST_UART_H */
@@ -0,0 +1,8 @@
+/**
+ * Host stub: SDK dual-bank update API (unused by the custom OTA)
+ */
+
+#ifndef HOST_DUAL_BANK_UPDATA_API_H
+#define HOST_DUAL_BANK_UPDATA_API_H
+
+#endif /* HOST_DUAL_BANK_UPDATA_API_H */
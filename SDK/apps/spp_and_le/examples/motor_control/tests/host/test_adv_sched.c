@@ -0,0 +1,157 @@
+/**
+ * Advertising scheduler - energy model against the running schedule
+ *
+ * Starts the real scheduler on the virtual clock and samples the
+ * advertising state and interval every 100 ms. The charge of each sample
+ * (baseline plus VM_ENERGY_ADV_EVENT_NC per advertising event) is summed
+ * in floating point, and the average over the first minute, hour and day
+ * after a trigger must match vm_adv_sched_estimate_avg_ua() for several
+ * schedules. Also checks the per-tier currents, the tier timing and that
+ * a connection stops the schedule.
+ */
+
+#include "host_sdk.h"
+#include "vm_config.h"
+#include "vm_adv_scheduler.h"
+#include "vm_settings.h"
+
+#include "gatt_common/le_gatt_common.h"
+
+#define SAMPLE_MS       100
+
+/* Module hooks the settings groups call */
+void vm_motor_set_pwm_freq(u32 freq_hz) { }
+void vm_motor_set_curve(u16 duty_min, u16 duty_max) { }
+void vm_lr_adv_sync(void) { }
+
+static adv_cfg_t g_adv;
+
+typedef struct {
+    const char *name;
+    vm_adv_sched_cfg_t cfg;
+} schedule_t;
+
+static const schedule_t g_schedules[] = {
+    {"defaults", {VM_ADV_FAST_INTERVAL, VM_ADV_SLOW_INTERVAL, VM_ADV_FAST_DURATION_S,
+                  VM_ADV_SLOW_DURATION_S, VM_ADV_SLEEP_PERIOD_S, VM_ADV_WAKE_WINDOW_S,
+                  VM_ADV_SLEEP_ENABLE, 0}},
+    {"no sleep", {VM_ADV_FAST_INTERVAL, VM_ADV_SLOW_INTERVAL, VM_ADV_FAST_DURATION_S,
+                  VM_ADV_SLOW_DURATION_S, 0, 0, 0, 0}},
+    {"always fast", {0x00A0, 0x00A0, 0xFFFF, 0, 0, 0, 0, 0}},
+    {"deep sleep", {0x0030, 0x0C80, 10, 60, 295, 5, 1, 0}},
+    {"sleep at once", {0x0040, 0x0320, 5, 0, 17, 3, 1, 0}},
+};
+
+/* Current of the sample, in nA, from what the gatt server was told */
+static double sample_na(void)
+{
+    double na = VM_ENERGY_SLEEP_UA * 1000.0;
+
+    if (ble_gatt_server_get_work_state() == BLE_ST_ADV) {
+        na += VM_ENERGY_ADV_EVENT_NC * 1600.0 / g_adv.adv_interval;
+    }
+    return na;
+}
+
+static void test_tier_currents(void)
+{
+    u32 fast = vm_adv_sched_tier_current_ua(VM_ADV_FAST_INTERVAL);
+    u32 slow = vm_adv_sched_tier_current_ua(VM_ADV_SLOW_INTERVAL);
+    u32 off = vm_adv_sched_tier_current_ua(0);
+    double fast_ref = VM_ENERGY_SLEEP_UA + VM_ENERGY_ADV_EVENT_NC * 1.6 / VM_ADV_FAST_INTERVAL;
+    double slow_ref = VM_ENERGY_SLEEP_UA + VM_ENERGY_ADV_EVENT_NC * 1.6 / VM_ADV_SLOW_INTERVAL;
+
+    HOST_CHECK(fast == (u32)fast_ref && slow == (u32)slow_ref && off == VM_ENERGY_SLEEP_UA,
+               "Tier currents", "fast %u uA, slow %u uA, sleep %u uA", fast, slow, off);
+    HOST_CHECK(vm_adv_sched_estimate_avg_ua(&g_schedules[0].cfg, 0) == fast &&
+               vm_adv_sched_estimate_avg_ua(NULL, 3600) == 0, "Empty horizon and no schedule",
+               "%u uA", vm_adv_sched_estimate_avg_ua(&g_schedules[0].cfg, 0));
+}
+
+static void test_timing(void)
+{
+    const vm_adv_sched_cfg_t *cfg = &g_schedules[0].cfg;
+    u8 tiers[4];
+
+    vm_adv_sched_stop();
+    vm_adv_sched_set_config(cfg);
+    vm_adv_sched_trigger(VM_ADV_TRIGGER_POWER_ON);
+    tiers[0] = vm_adv_sched_get_tier();
+    host_run_ms(cfg->fast_duration_s * 1000);
+    tiers[1] = vm_adv_sched_get_tier();
+    host_run_ms(cfg->slow_duration_s * 1000);
+    tiers[2] = vm_adv_sched_get_tier();
+    host_run_ms(cfg->sleep_period_s * 1000);
+    tiers[3] = vm_adv_sched_get_tier();
+    HOST_CHECK(tiers[0] == VM_ADV_TIER_FAST && tiers[1] == VM_ADV_TIER_SLOW &&
+               tiers[2] == VM_ADV_TIER_SLEEP && tiers[3] == VM_ADV_TIER_WAKE &&
+               ble_gatt_server_get_work_state() == BLE_ST_ADV && g_adv.adv_interval == cfg->slow_interval,
+               "Tiers change on time", "%u %u %u %u", tiers[0], tiers[1], tiers[2], tiers[3]);
+
+    vm_adv_sched_on_connect();
+    ble_gatt_server_adv_enable(0);      /* The stack stops advertising on connection */
+    host_run_ms(24 * 3600 * 1000);
+    tiers[0] = vm_adv_sched_get_tier();
+    vm_adv_sched_trigger(VM_ADV_TRIGGER_BUTTON);
+    tiers[1] = vm_adv_sched_get_tier();
+    vm_adv_sched_trigger(VM_ADV_TRIGGER_DISCONNECT);
+    tiers[2] = vm_adv_sched_get_tier();
+    HOST_CHECK(tiers[0] == VM_ADV_TIER_CONNECTED && tiers[1] == VM_ADV_TIER_CONNECTED &&
+               tiers[2] == VM_ADV_TIER_FAST && g_adv.adv_interval == cfg->fast_interval,
+               "Connection holds the schedule, disconnect restarts FAST", "%u %u %u", tiers[0],
+               tiers[1], tiers[2]);
+}
+
+static void test_estimates(void)
+{
+    static const u32 horizons[] = {60, 3600, 24 * 3600};
+    u32 mismatch = 0;
+    u32 rejected = 0;
+    u8 s;
+    u8 h;
+
+    host_note("Average current after a trigger, estimate / running schedule (uA):\n");
+    host_note("  schedule           first minute     first hour       first day\n");
+    for (s = 0; s < sizeof(g_schedules) / sizeof(g_schedules[0]); s++) {
+        const vm_adv_sched_cfg_t *cfg = &g_schedules[s].cfg;
+        double charge = 0;
+        u32 t_ms = 0;
+        char line[96];
+        int n = 0;
+
+        vm_adv_sched_stop();
+        rejected += vm_adv_sched_set_config(cfg) != 0;
+        vm_adv_sched_trigger(VM_ADV_TRIGGER_POWER_ON);
+
+        for (h = 0; h < sizeof(horizons) / sizeof(horizons[0]); h++) {
+            u32 est = vm_adv_sched_estimate_avg_ua(cfg, horizons[h]);
+            double sim;
+
+            for (; t_ms < horizons[h] * 1000; t_ms += SAMPLE_MS) {
+                charge += sample_na() * SAMPLE_MS;
+                host_run_ms(SAMPLE_MS);
+            }
+            sim = charge / t_ms / 1000.0;
+            /* The estimate truncates to whole uA */
+            if (sim < est || sim >= est + 1.0) {
+                mismatch++;
+            }
+            n += snprintf(line + n, sizeof(line) - n, "  %5u / %8.2f", est, sim);
+        }
+        host_note("  %-15s%s\n", g_schedules[s].name, line);
+    }
+    HOST_CHECK(mismatch == 0 && rejected == 0, "Estimate matches the running schedule",
+               "%u of %u horizons off, %u schedules rejected", mismatch,
+               (u32)(sizeof(g_schedules) / sizeof(g_schedules[0]) * 3), rejected);
+}
+
+int main(void)
+{
+    vm_settings_init();
+    vm_adv_sched_init(&g_adv);
+
+    test_tier_currents();
+    test_timing();
+    test_estimates();
+    return host_report("adv_sched");
+}
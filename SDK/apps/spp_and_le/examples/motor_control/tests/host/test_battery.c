@@ -0,0 +1,238 @@
+/**
+ * Battery estimator - voltage / duty traces
+ *
+ * Feeds vm_bat_est_step() one sample per VM_BAT_POLL_MS from a simulated
+ * pack: open-circuit voltage from the state of charge, a load drop that
+ * follows the motor duty with a short recovery time constant, and ADC
+ * noise. The trace is idle, vibration patterns, continuous full power,
+ * patterns again and then charging. The estimate is compared with the
+ * true state of charge, next to the linear map of the raw loaded reading
+ * the device reported before (3.3 V = 0 %, 4.2 V = 100 %).
+ */
+
+#include "host_sdk.h"
+#include "vm_config.h"
+#include "vm_battery.h"
+
+/* Pack model */
+#define PACK_DROP_MV        165     /* Real drop at full duty, VM_BAT_LOAD_DROP_MV is the estimate */
+#define PACK_RECOVERY_MS    1200    /* Time constant of the drop after a duty change */
+#define PACK_NOISE_MV       12      /* ADC noise, +/- */
+
+#define WARMUP_MS           60000   /* Estimate not judged before this */
+
+/* Open-circuit voltage per cell of the simulated pack at 0, 10, ... 100 % (mV) */
+static const u16 g_ocv[] = {
+    3300, 3600, 3680, 3730, 3770, 3800, 3850, 3920, 4000, 4080, 4180,
+};
+
+typedef struct {
+    const char *name;
+    u32 duration_ms;
+    u16 duty_max;       /* Patterns pick duties up to this; 0: motor off */
+    u8 steady;          /* Duty fixed at duty_max for the whole phase */
+    s16 soc_per_min;    /* Charge change in 0.01 %/min, at full duty when discharging */
+} phase_t;
+
+static const phase_t g_phases[] = {
+    {"idle", 10 * 60000, 0, 0, -2},
+    {"patterns", 120 * 60000, 10000, 0, -80},
+    {"full power", 15 * 60000, 10000, 1, -80},
+    {"patterns", 60 * 60000, 10000, 0, -80},
+    {"charging", 90 * 60000, 0, 0, 80},
+};
+
+typedef struct {
+    u32 samples;
+    u32 used;
+    u32 max_err;            /* Estimate vs true, percent */
+    u32 max_err_before;     /* Linear map of the loaded reading vs true */
+    u32 wrong_way;          /* Reported steps against the true direction */
+    u32 wrong_way_before;
+    u32 smallest_rise;      /* Smallest upward step of the estimate */
+} phase_stat_t;
+
+static u32 g_rand = 2024;
+
+/* vm_battery_init() / poll timer inputs, not used by the estimator */
+u32 adc_get_voltage(u32 ch)
+{
+    return 0;
+}
+
+u16 vm_motor_get_duty(void)
+{
+    return 0;
+}
+
+static u32 rnd(u32 n)
+{
+    g_rand = g_rand * 1103515245u + 12345u;
+    return (g_rand >> 8) % n;
+}
+
+/* soc in parts per million */
+static u32 pack_ocv_mv(s32 soc)
+{
+    u32 i = soc / 100000;
+
+    if (soc <= 0) {
+        return g_ocv[0];
+    }
+    if (i >= 10) {
+        return g_ocv[10];
+    }
+    return g_ocv[i] + (u32)(g_ocv[i + 1] - g_ocv[i]) * (soc % 100000) / 100000;
+}
+
+static u8 linear_before(u32 mv)
+{
+    if (mv <= 3300) {
+        return 0;
+    }
+    return (mv >= 4200) ? 100 : (mv - 3300) * 100 / 900;
+}
+
+static u32 diff(s32 a, s32 b)
+{
+    return (a > b) ? a - b : b - a;
+}
+
+static void test_unit(void)
+{
+    vm_bat_est_t est;
+    u16 mv;
+    u8 prev = 0;
+    u8 monotonic = 1;
+    u8 a;
+    u8 b;
+    u8 c;
+
+    HOST_CHECK(vm_bat_cell_mv_to_percent(3000) == 0 && vm_bat_cell_mv_to_percent(3300) == 0 &&
+               vm_bat_cell_mv_to_percent(3800) == 50 && vm_bat_cell_mv_to_percent(4180) == 100 &&
+               vm_bat_cell_mv_to_percent(4300) == 100, "OCV table end and mid points",
+               "3800 mV -> %u %%", vm_bat_cell_mv_to_percent(3800));
+    for (mv = 3000; mv <= 4300; mv++) {
+        monotonic &= vm_bat_cell_mv_to_percent(mv) >= prev;
+        prev = vm_bat_cell_mv_to_percent(mv);
+    }
+    HOST_CHECK(monotonic, "OCV map monotonic", "3000 .. 4300 mV");
+    HOST_CHECK(vm_bat_compensate_mv(3700, 0) == 3700 &&
+               vm_bat_compensate_mv(3700, 10000) == 3700 + VM_BAT_LOAD_DROP_MV &&
+               vm_bat_compensate_mv(3700, 20000) == 3700 + VM_BAT_LOAD_DROP_MV,
+               "Drop proportional to duty", "full duty +%u mV", VM_BAT_LOAD_DROP_MV);
+
+    vm_bat_est_reset(&est);
+    HOST_CHECK(est.percent == VM_BAT_PERCENT_UNKNOWN, "Unknown before the first sample", "%u",
+               est.percent);
+    a = vm_bat_est_step(&est, 3700, 9000, 0);
+    b = vm_bat_est_step(&est, 3700, 3000, VM_BAT_POLL_MS);
+    for (c = 0; !vm_bat_est_step(&est, 3700, 3000, VM_BAT_POLL_MS) && c < 100; c++) {
+    }
+    HOST_CHECK(a && !b && (c + 1) * VM_BAT_POLL_MS == VM_BAT_SETTLE_MS,
+               "First sample taken, settling skipped", "next sample %u ms after the duty change", (c + 1) * VM_BAT_POLL_MS);
+}
+
+static void test_trace(void)
+{
+    static phase_stat_t stats[sizeof(g_phases) / sizeof(g_phases[0])];
+    vm_bat_est_t est;
+    s32 soc = 950000;               /* ppm */
+    s32 drop = 0;                   /* Load drop now, mV */
+    u16 duty = 0;
+    u32 hold_ms = 0;
+    u32 t_ms = 0;
+    u8 last_est = VM_BAT_PERCENT_UNKNOWN;
+    u8 last_before = 0;
+    u8 worst = 0;
+    u8 worst_before = 0;
+    u32 wrong_way = 0;
+    u8 before;
+    u32 p;
+    u32 ms;
+
+    vm_bat_est_reset(&est);
+    for (p = 0; p < sizeof(g_phases) / sizeof(g_phases[0]); p++) {
+        const phase_t *ph = &g_phases[p];
+        phase_stat_t *st = &stats[p];
+        s32 dir = (ph->soc_per_min > 0) ? 1 : -1;
+
+        memset(st, 0, sizeof(*st));
+        st->smallest_rise = 100;
+        for (ms = 0; ms < ph->duration_ms; ms += VM_BAT_POLL_MS, t_ms += VM_BAT_POLL_MS) {
+            u16 vbat;
+            s32 truth;
+
+            /* Patterns: hold one of four duties for 1-20 s, off half the time */
+            if (ph->steady) {
+                duty = ph->duty_max;
+            } else if (hold_ms == 0) {
+                duty = rnd(2) ? 0 : (u16)(ph->duty_max / 4 * (1 + rnd(4)));
+                hold_ms = (1 + rnd(20)) * 1000;
+            }
+            hold_ms = (hold_ms > VM_BAT_POLL_MS) ? hold_ms - VM_BAT_POLL_MS : 0;
+
+            /* Discharge follows the load (a tenth of it when idle), the drop relaxes to the load line */
+            soc += (s32)ph->soc_per_min * 100 * (dir < 0 ? 1000 + 9 * (s32)duty / 10 : 10000) / 10000 *
+                   (s32)VM_BAT_POLL_MS / 60000;
+            soc = (soc < 0) ? 0 : (soc > 1000000) ? 1000000 : soc;
+            drop += ((s32)PACK_DROP_MV * duty / 10000 - drop) * (s32)VM_BAT_POLL_MS /
+                    (PACK_RECOVERY_MS + VM_BAT_POLL_MS);
+            vbat = (u16)(pack_ocv_mv(soc) * VM_BAT_CELLS - drop +
+                         (s32)rnd(2 * PACK_NOISE_MV + 1) - PACK_NOISE_MV);
+
+            st->samples++;
+            st->used += vm_bat_est_step(&est, vbat, duty, VM_BAT_POLL_MS);
+            before = linear_before(vbat / VM_BAT_CELLS);
+            truth = (soc + 5000) / 10000;
+
+            if (t_ms >= WARMUP_MS) {
+                if (diff(est.percent, truth) > st->max_err) {
+                    st->max_err = diff(est.percent, truth);
+                }
+                if (diff(before, truth) > st->max_err_before) {
+                    st->max_err_before = diff(before, truth);
+                }
+                st->wrong_way += (s32)(est.percent - last_est) * dir < 0;
+                st->wrong_way_before += (s32)(before - last_before) * dir < 0;
+                if (est.percent > last_est && (u32)(est.percent - last_est) < st->smallest_rise) {
+                    st->smallest_rise = est.percent - last_est;
+                }
+            }
+            last_est = est.percent;
+            last_before = before;
+        }
+    }
+
+    host_note("Trace, one sample per %u ms (pack drop %u mV at full duty, estimator %u mV):\n",
+              VM_BAT_POLL_MS, PACK_DROP_MV, VM_BAT_LOAD_DROP_MV);
+    host_note("  phase        samples  used   max error before/after   wrong-way steps before/after\n");
+    for (p = 0; p < sizeof(g_phases) / sizeof(g_phases[0]); p++) {
+        host_note("  %-11s  %7u  %5u  %9u %% %5u %%      %14u %5u\n", g_phases[p].name,
+                  stats[p].samples, stats[p].used, stats[p].max_err_before, stats[p].max_err,
+                  stats[p].wrong_way_before, stats[p].wrong_way);
+        worst = (stats[p].max_err > worst) ? stats[p].max_err : worst;
+        worst_before = (stats[p].max_err_before > worst_before) ? stats[p].max_err_before : worst_before;
+        if (p != 3) {
+            wrong_way += stats[p].wrong_way;
+        }
+    }
+
+    HOST_CHECK(worst <= 6, "Estimate within 6 % of the true charge", "worst %u %% (before %u %%)",
+               worst, worst_before);
+    /* Full-load samples are rare and carry the load line error; one catch-up step after is expected */
+    HOST_CHECK(wrong_way == 0 && stats[3].wrong_way <= 1, "Estimate does not jitter against the charge",
+               "%u steps, %u after full power", wrong_way, stats[3].wrong_way);
+    HOST_CHECK(stats[2].used >= g_phases[2].duration_ms / VM_BAT_MAX_STALE_MS,
+               "Full power still sampled", "%u samples in %u min", stats[2].used,
+               g_phases[2].duration_ms / 60000);
+    HOST_CHECK(stats[4].smallest_rise >= VM_BAT_RISE_HYST_PCT, "Charging reported in real steps",
+               "smallest rise %u %%", stats[4].smallest_rise);
+}
+
+int main(void)
+{
+    test_unit();
+    test_trace();
+    return host_report("battery");
+}
@@ -0,0 +1,292 @@
+/**
+ * Dual-bank OTA - power cuts during the update and boot counting
+ *
+ * Cuts power during every flash erase / program of an update in turn and
+ * boots again: boot info must always be readable and point at a bank that
+ * holds a good image, and the update must go through when it is retried.
+ * Then checks that a trial image that is never marked good rolls back after
+ * MAX_BOOT_TRIES boots, and that one marked good stays. A bank that cannot
+ * be checked (no buffer) is neither cached as checked nor rolled back to.
+ */
+
+#include "host_sdk.h"
+#include "custom_dual_bank_ota.h"
+#include "custom_journal.h"
+#include "vm_mem_pool.h"
+#include "asm/crc16.h"
+
+
+#define IMAGE_SIZE      (40 * 1024 + 123)
+#define CHUNK           241
+#define NEW_VERSION     2
+
+/* boot_check() arguments */
+#define BOOT_MARK_GOOD  ((void *)1)     /* The application comes up and marks itself good */
+#define BOOT_NO_BUFFER  ((void *)2)     /* The OTA pool is taken when the boot checks the bank */
+
+/* Boot info as a boot found it, written by boot_check() */
+typedef struct {
+    int status;                 /* HOST_BOOT_* */
+    u8 found;
+    custom_boot_info_t info;
+} boot_view_t;
+
+static u8 g_image[IMAGE_SIZE];
+static boot_view_t *g_view;     /* Shared with the boots */
+
+/* Full update: START, DATA in CHUNK pieces, commit */
+static void boot_update(void *arg)
+{
+    u32 off;
+    u16 n;
+    int ret;
+
+    custom_dual_bank_ota_init();
+    if (custom_dual_bank_ota_start(IMAGE_SIZE, CRC16(g_image, IMAGE_SIZE), NEW_VERSION) != 0) {
+        exit(HOST_BOOT_CRASH);
+    }
+    for (off = 0; off < IMAGE_SIZE; off += n) {
+        n = (IMAGE_SIZE - off > CHUNK) ? CHUNK : IMAGE_SIZE - off;
+        if (custom_dual_bank_ota_data(&g_image[off], n) != 0) {
+            exit(HOST_BOOT_CRASH);
+        }
+    }
+    ret = custom_dual_bank_ota_commit_begin();
+    if (ret == 0) {
+        do {
+            ret = custom_dual_bank_ota_commit_step();
+        } while (ret == CUSTOM_OTA_COMMIT_PENDING);
+    }
+    if (ret != 0) {
+        exit(HOST_BOOT_CRASH);
+    }
+}
+
+/* Plain boot, or with BOOT_MARK_GOOD / BOOT_NO_BUFFER */
+static void boot_check(void *arg)
+{
+    if (arg == BOOT_NO_BUFFER) {
+        vm_mem_alloc(VM_POOL_OTA, CUSTOM_FLASH_PAGE);
+    }
+    custom_dual_bank_ota_init();
+    if (arg == BOOT_MARK_GOOD) {
+        custom_dual_bank_mark_good();
+    }
+    g_view->found = custom_jnl_read(CUSTOM_JNL_TYPE_BOOT_INFO, &g_view->info,
+                                    sizeof(g_view->info)) == sizeof(g_view->info);
+}
+
+/* Drops the cached CHECKED flags, as boot info written before the cache existed */
+static void boot_uncache(void *arg)
+{
+    custom_boot_info_t info;
+
+    custom_jnl_init();
+    if (custom_jnl_read(CUSTOM_JNL_TYPE_BOOT_INFO, &info, sizeof(info)) != sizeof(info)) {
+        exit(HOST_BOOT_CRASH);
+    }
+    info.flags &= ~(CUSTOM_BOOT_FLAG_A_CHECKED | CUSTOM_BOOT_FLAG_B_CHECKED);
+    info.boot_info_crc = CRC16(&info, sizeof(info) - 2 * sizeof(u16));
+    if (custom_jnl_append(CUSTOM_JNL_TYPE_BOOT_INFO, &info, sizeof(info)) != 0) {
+        exit(HOST_BOOT_CRASH);
+    }
+}
+
+static int boot_view(void *arg)
+{
+    memset(g_view, 0, sizeof(*g_view));
+    g_view->status = host_boot(boot_check, arg);
+    return g_view->status;
+}
+
+/* Active bank of the last view is usable: the factory image or a checked copy of g_image */
+static int view_bootable(void)
+{
+    const custom_boot_info_t *info = &g_view->info;
+    const custom_bank_info_t *b = info->active_bank ? &info->bank_b : &info->bank_a;
+
+    if (!g_view->found || info->magic != CUSTOM_BOOT_MAGIC || info->active_bank > 1 || !b->valid) {
+        return 0;
+    }
+    if (b->size == 0) {
+        return info->active_bank == 0;      /* Factory image */
+    }
+    return b->size == IMAGE_SIZE && b->version == NEW_VERSION &&
+           CRC16(host_flash() + b->addr, b->size) == CRC16(g_image, IMAGE_SIZE) &&
+           b->crc == CRC16(g_image, IMAGE_SIZE);
+}
+
+static void test_power_cuts(void)
+{
+    u32 cut;
+    u32 cuts = 0;
+    u32 bad = 0;
+    u32 retry_failed = 0;
+    u32 old_bank = 0;
+    u32 new_bank = 0;
+    u8 before;
+    int ret;
+
+    for (cut = 1; cut < 1000; cut++) {
+        host_flash_reset();
+        boot_view(NULL);                    /* Factory boot info */
+        before = g_view->info.active_bank;
+
+        host_flash_cut_at(cut);
+        ret = host_boot(boot_update, NULL);
+        host_flash_cut_at(0);
+        if (ret == HOST_BOOT_DONE) {
+            break;                          /* Update finished before op #cut */
+        }
+        cuts++;
+
+        if (ret != HOST_BOOT_CUT || boot_view(NULL) != HOST_BOOT_DONE || !view_bootable()) {
+            if (bad++ < 5) {
+                host_note("  cut at op %u: update %d, boot %d, bank %u\n", cut, ret,
+                          g_view->status, g_view->info.active_bank);
+            }
+            continue;
+        }
+        if (g_view->info.active_bank == before) {
+            old_bank++;
+        } else {
+            new_bank++;
+        }
+
+        /* Retry from whatever the cut left */
+        before = g_view->info.active_bank;
+        if (host_boot(boot_update, NULL) != HOST_BOOT_DONE || boot_view(NULL) != HOST_BOOT_DONE ||
+            !view_bootable() || g_view->info.active_bank == before) {
+            retry_failed++;
+        }
+    }
+
+    HOST_CHECK(cuts > 100, "Every flash op of the update cut once", "%u cuts", cuts);
+    HOST_CHECK(bad == 0, "Bootable after every cut", "%u of %u cuts left no good bank", bad, cuts);
+    HOST_CHECK(new_bank == 0, "Cut update keeps the old bank",
+               "%u cuts booted the old bank, %u the new one", old_bank, new_bank);
+    HOST_CHECK(retry_failed == 0, "Retried update goes through", "%u retries failed", retry_failed);
+}
+
+static void test_boot_counting(void)
+{
+    u8 i;
+    int ret = HOST_BOOT_DONE;
+
+    /* Never marked good: MAX_BOOT_TRIES trial boots, then rollback */
+    host_flash_reset();
+    boot_view(NULL);
+    host_boot(boot_update, NULL);
+    for (i = 1; i <= MAX_BOOT_TRIES; i++) {
+        ret = boot_view(NULL);
+        if (ret != HOST_BOOT_DONE || g_view->info.active_bank != 1 || g_view->info.boot_count != i) {
+            break;
+        }
+    }
+    HOST_CHECK(i == MAX_BOOT_TRIES + 1, "Trial boots counted", "%u of %u, bank %u, count %u", i - 1,
+               MAX_BOOT_TRIES, g_view->info.active_bank, g_view->info.boot_count);
+    ret = boot_view(NULL);
+    HOST_CHECK(ret == HOST_BOOT_RESET, "Rollback resets at once", "boot %d", ret);
+    ret = boot_view(NULL);
+    HOST_CHECK(ret == HOST_BOOT_DONE && g_view->info.active_bank == 0 && !g_view->info.bank_b.valid &&
+               (g_view->info.flags & CUSTOM_BOOT_FLAG_CONFIRMED), "Rolled back to the old bank",
+               "bank %u, b valid %u", g_view->info.active_bank, g_view->info.bank_b.valid);
+
+    /* Marked good on the first boot: stays */
+    host_flash_reset();
+    boot_view(NULL);
+    host_boot(boot_update, NULL);
+    boot_view(BOOT_MARK_GOOD);
+    for (i = 0; i < MAX_BOOT_TRIES * 2; i++) {
+        ret = boot_view(NULL);
+    }
+    HOST_CHECK(ret == HOST_BOOT_DONE && g_view->info.active_bank == 1 && g_view->info.boot_count == 0,
+               "Image marked good stays", "bank %u, count %u", g_view->info.active_bank,
+               g_view->info.boot_count);
+
+    /* Every other trial boot loses power writing its count: counting goes on */
+    host_flash_reset();
+    boot_view(NULL);
+    host_boot(boot_update, NULL);
+    for (i = 1; i <= MAX_BOOT_TRIES + 1; i++) {
+        host_flash_cut_at(1);
+        ret = host_boot(boot_check, NULL);
+        host_flash_cut_at(0);
+        if (ret != HOST_BOOT_CUT || boot_view(NULL) != HOST_BOOT_DONE) {
+            break;
+        }
+    }
+    HOST_CHECK(i == MAX_BOOT_TRIES + 1 && ret == HOST_BOOT_CUT && g_view->status == HOST_BOOT_RESET,
+               "Rollback despite cut count writes", "after %u boots, boot %d", i * 2, g_view->status);
+    ret = boot_view(NULL);
+    HOST_CHECK(ret == HOST_BOOT_DONE && g_view->found && g_view->info.active_bank == 0,
+               "Boot info intact after cut count writes", "boot %d, bank %u", ret,
+               g_view->info.active_bank);
+}
+
+static u8 g_bank_result[2];
+
+static u8 fixed_check(custom_boot_info_t *info, u8 bank)
+{
+    return g_bank_result[bank];
+}
+
+static void test_unchecked(void)
+{
+    custom_boot_info_t info;
+    custom_boot_info_t before;
+    custom_boot_info_t first;
+    int status;
+    u8 ret;
+
+    /* Trial boot that must check the bank but has no buffer: counted, not marked checked */
+    host_flash_reset();
+    boot_view(NULL);
+    host_boot(boot_update, NULL);
+    host_boot(boot_uncache, NULL);
+    status = boot_view(BOOT_NO_BUFFER);
+    first = g_view->info;
+    boot_view(NULL);
+    HOST_CHECK(status == HOST_BOOT_DONE && first.active_bank == 1 && first.boot_count == 1 &&
+               !(first.flags & CUSTOM_BOOT_FLAG_B_CHECKED) && g_view->info.boot_count == 2 &&
+               (g_view->info.flags & CUSTOM_BOOT_FLAG_B_CHECKED), "Bank not checked for lack of a buffer not cached",
+               "boot %d, count %u then %u, flags 0x%x then 0x%x", status, first.boot_count,
+               g_view->info.boot_count, first.flags, g_view->info.flags);
+
+    /* Trial used up, the old bank cannot be checked: no switch, nothing confirmed */
+    memset(&info, 0, sizeof(info));
+    info.active_bank = 1;
+    info.boot_count = MAX_BOOT_TRIES;
+    info.bank_a.valid = 1;
+    info.bank_b.valid = 1;
+    before = info;
+    g_bank_result[0] = CUSTOM_BANK_UNCHECKED;
+    g_bank_result[1] = CUSTOM_BANK_OK;
+    ret = custom_boot_select(&info, fixed_check);
+    HOST_CHECK(ret == CUSTOM_BOOT_UNCHECKED && memcmp(&info, &before, sizeof(info)) == 0,
+               "Unchecked bank is no rollback target", "result %u, bank %u, flags 0x%x", ret,
+               info.active_bank, info.flags);
+
+    /* Running bank that cannot be checked keeps running, trial keeps counting */
+    info.boot_count = 0;
+    g_bank_result[1] = CUSTOM_BANK_UNCHECKED;
+    ret = custom_boot_select(&info, fixed_check);
+    HOST_CHECK(ret == CUSTOM_BOOT_CONTINUE && info.active_bank == 1 && info.boot_count == 1 &&
+               !(info.flags & CUSTOM_BOOT_FLAG_CONFIRMED), "Unchecked running bank stays on trial",
+               "result %u, count %u", ret, info.boot_count);
+}
+
+int main(void)
+{
+    u32 i;
+
+    g_view = host_shared(sizeof(*g_view));
+    for (i = 0; i < IMAGE_SIZE; i++) {
+        g_image[i] = (u8)(i * 13 + (i >> 9));
+    }
+
+    test_power_cuts();
+    test_boot_counting();
+    test_unchecked();
+    return host_report("boot_powercut");
+}
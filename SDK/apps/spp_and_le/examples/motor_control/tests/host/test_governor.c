@@ -0,0 +1,224 @@
+/**
+ * Governor - closed loop against a thermal RC model of the driver
+ *
+ * The driver is simulated in floating point as a first-order RC: losses
+ * proportional to the applied duty heat it towards rise_full above
+ * ambient with time constant tau. Each VM_GOV_POLL_MS the fixed-point
+ * vm_gov_step() gets the average applied duty (and, in the sensor runs,
+ * the simulated temperature), and its ceiling caps what the user asked
+ * for over the next period, as vm_motor_set_limit() does.
+ *
+ * Runs: the plant the governor was tuned for, a hotter and faster one
+ * the model underestimates (with and without a sensor), an on/off
+ * pattern whose average stays under the derating start, and a battery
+ * drained towards the cutoff under full load.
+ */
+
+#include "host_sdk.h"
+#include "vm_config.h"
+#include "vm_governor.h"
+#include "vm_motor_control.h"
+
+#include <time.h>
+
+#define AMBIENT_C           25.0
+#define SUB_STEPS           10      /* Plant steps per governor poll */
+
+/* vm_governor_init() / poll timer inputs, not used by vm_gov_step() */
+u16 vm_motor_take_avg_duty(void) { return 0; }
+u16 vm_motor_get_duty(void) { return 0; }
+void vm_motor_set_limit(u16 ceiling) { }
+u16 vm_battery_get_mv(void) { return 0; }
+u32 adc_get_voltage(u32 ch) { return 0; }
+
+typedef struct {
+    double rise_full_c;     /* Steady-state rise at full duty */
+    double tau_s;
+    u8 sensor;              /* Feed the simulated temperature to the governor */
+} plant_t;
+
+typedef struct {
+    double peak_c;          /* Highest driver temperature */
+    double end_c;
+    double model_err_c;     /* Largest |model - plant| rise, matched plant only meaningful */
+    u32 max_down;           /* Largest ceiling step down / up */
+    u32 max_up;
+    u16 min_ceiling;
+    u32 avg_duty;           /* Applied duty averaged over the run */
+    u8 flags;               /* Limiters seen */
+} run_t;
+
+/* User request over time: full power, or on for on_ms of every 2 s */
+static u16 request(u32 t_ms, u32 on_ms)
+{
+    if (!on_ms) {
+        return VM_MOTOR_DUTY_MAX;
+    }
+    return (t_ms % 2000 < on_ms) ? VM_MOTOR_DUTY_MAX : 0;
+}
+
+static run_t run(const plant_t *plant, u32 duration_s, u32 on_ms, u8 governed)
+{
+    vm_gov_t gov;
+    run_t r;
+    double rise = 0;
+    double a = (double)VM_GOV_POLL_MS / SUB_STEPS / 1000.0 / plant->tau_s;
+    u64 duty_sum = 0;
+    u16 ceiling = VM_MOTOR_DUTY_MAX;
+    u16 prev;
+    u32 t_ms = 0;
+    u32 step;
+    u8 i;
+
+    memset(&r, 0, sizeof(r));
+    r.min_ceiling = VM_MOTOR_DUTY_MAX;
+    vm_gov_reset(&gov);
+
+    for (step = 0; step < duration_s * 1000 / VM_GOV_POLL_MS; step++) {
+        u32 applied_sum = 0;
+        double err;
+
+        for (i = 0; i < SUB_STEPS; i++, t_ms += VM_GOV_POLL_MS / SUB_STEPS) {
+            u16 duty = request(t_ms, on_ms);
+
+            if (governed && duty > ceiling) {
+                duty = ceiling;
+            }
+            applied_sum += duty;
+            rise += (plant->rise_full_c * duty / VM_MOTOR_DUTY_MAX - rise) * a;
+        }
+        duty_sum += applied_sum / SUB_STEPS;
+
+        prev = ceiling;
+        ceiling = vm_gov_step(&gov, applied_sum / SUB_STEPS, 0,
+                              plant->sensor ? (s8)(AMBIENT_C + rise) : VM_GOV_TEMP_NONE, VM_GOV_POLL_MS);
+        if (prev > ceiling && (u32)(prev - ceiling) > r.max_down) {
+            r.max_down = prev - ceiling;
+        }
+        if (ceiling > prev && (u32)(ceiling - prev) > r.max_up) {
+            r.max_up = ceiling - prev;
+        }
+        r.min_ceiling = (ceiling < r.min_ceiling) ? ceiling : r.min_ceiling;
+        r.flags |= gov.flags;
+        r.peak_c = (AMBIENT_C + rise > r.peak_c) ? AMBIENT_C + rise : r.peak_c;
+        err = gov.rise_q8 / 256.0 - rise;
+        err = (err < 0) ? -err : err;
+        r.model_err_c = (err > r.model_err_c) ? err : r.model_err_c;
+    }
+    r.end_c = AMBIENT_C + rise;
+    r.avg_duty = (u32)(duty_sum / step);
+    return r;
+}
+
+static void note_run(const char *name, const run_t *r)
+{
+    host_note("  %-26s  %5.1f  %5.1f  %5u  %5u  %3u/%-3u  0x%02x\n", name, r->peak_c, r->end_c,
+              r->avg_duty, r->min_ceiling, r->max_down, r->max_up, r->flags);
+}
+
+static void test_thermal(void)
+{
+    static const plant_t tuned = {VM_GOV_RISE_FULL_C, VM_GOV_TAU_S, 0};
+    static const plant_t hot = {VM_GOV_RISE_FULL_C * 1.6, VM_GOV_TAU_S * 0.5, 0};
+    static const plant_t hot_sensed = {VM_GOV_RISE_FULL_C * 1.6, VM_GOV_TAU_S * 0.5, 1};
+    run_t free_run = run(&tuned, 1800, 0, 0);
+    run_t gov_run = run(&tuned, 1800, 0, 1);
+    run_t hot_run = run(&hot, 1800, 0, 1);
+    run_t sensed_run = run(&hot_sensed, 1800, 0, 1);
+    run_t pattern_run = run(&tuned, 1800, 800, 1);
+    double limit_c = AMBIENT_C + VM_GOV_RISE_LIMIT_C;
+
+    host_note("30 min at full request, ambient %.0f C (driver rise %u C at full duty, tau %u s):\n",
+              AMBIENT_C, VM_GOV_RISE_FULL_C, VM_GOV_TAU_S);
+    host_note("  run                         peak    end   duty  floor  down/up  flags\n");
+    note_run("ceiling not applied", &free_run);
+    note_run("governed", &gov_run);
+    note_run("hotter plant, model only", &hot_run);
+    note_run("hotter plant, with sensor", &sensed_run);
+    note_run("0.8 s on / 1.2 s off", &pattern_run);
+
+    HOST_CHECK(free_run.peak_c > limit_c + 10, "Ungoverned driver overheats", "%.1f C",
+               free_run.peak_c);
+    HOST_CHECK(gov_run.peak_c <= limit_c && gov_run.min_ceiling >= VM_GOV_MIN_CEILING &&
+               gov_run.flags == VM_GOV_FLAG_THERMAL, "Governed driver held below the model limit",
+               "peak %.1f C, limit %.1f C", gov_run.peak_c, limit_c);
+    HOST_CHECK(gov_run.avg_duty > VM_MOTOR_DUTY_MAX * VM_GOV_RISE_START_C / VM_GOV_RISE_FULL_C,
+               "Derating keeps the duty the limit allows", "average duty %u", gov_run.avg_duty);
+    HOST_CHECK(gov_run.model_err_c < 0.5, "Fixed-point model tracks the plant", "%.2f C",
+               gov_run.model_err_c);
+    HOST_CHECK(gov_run.max_down <= VM_GOV_SLEW_DOWN + 1 && gov_run.max_up <= VM_GOV_SLEW_UP + 1 &&
+               sensed_run.max_down <= VM_GOV_SLEW_DOWN + 1 && sensed_run.max_up <= VM_GOV_SLEW_UP + 1,
+               "Ceiling moves within the slew limits", "down %u, up %u per step", sensed_run.max_down,
+               sensed_run.max_up);
+    HOST_CHECK(sensed_run.peak_c < hot_run.peak_c && sensed_run.peak_c <= VM_GOV_TEMP_LIMIT_C &&
+               (sensed_run.flags & VM_GOV_FLAG_TEMP), "Sensor catches a plant the model underestimates",
+               "peak %.1f C, %.1f C model only", sensed_run.peak_c, hot_run.peak_c);
+    HOST_CHECK(pattern_run.flags == 0 && pattern_run.min_ceiling == VM_MOTOR_DUTY_MAX,
+               "Pattern under the derating start left alone", "floor %u", pattern_run.min_ceiling);
+}
+
+static void test_cool_down(void)
+{
+    vm_gov_t gov;
+    u32 s;
+
+    vm_gov_reset(&gov);
+    for (s = 0; s < 1800; s++) {
+        vm_gov_step(&gov, gov.ceiling, 0, VM_GOV_TEMP_NONE, 1000);
+    }
+    for (s = 0; gov.ceiling < VM_MOTOR_DUTY_MAX && s < 3600; s++) {
+        vm_gov_step(&gov, 0, 0, VM_GOV_TEMP_NONE, 1000);
+    }
+    HOST_CHECK(gov.ceiling == VM_MOTOR_DUTY_MAX && gov.flags == 0, "Limit lifted after a rest",
+               "%u s idle", s);
+}
+
+static void test_battery(void)
+{
+    vm_gov_t gov;
+    u32 ocv;
+    u32 below = 0;
+    u16 ceiling = VM_MOTOR_DUTY_MAX;
+    u8 flags = 0;
+
+    /* Pack drained 10 mV per minute under full request, thermal model held cold */
+    vm_gov_reset(&gov);
+    for (ocv = 3600 * 60; ocv >= VM_GOV_CUTOFF_MV * 60; ocv -= 10) {
+        gov.rise_q8 = 0;
+        ceiling = vm_gov_step(&gov, ceiling, (u16)(ocv / 60 * VM_BAT_CELLS), VM_GOV_TEMP_NONE, 1000);
+        flags |= gov.flags;
+        /* Loaded voltage with the configured load line */
+        if ((ocv / 60) * 10000 < (u32)VM_GOV_CUTOFF_MV * 10000 + (u32)ceiling * VM_BAT_LOAD_DROP_MV) {
+            below++;
+        }
+    }
+    HOST_CHECK(flags == VM_GOV_FLAG_BATTERY && below == 0 && ceiling == 0,
+               "Loaded voltage kept above the cutoff", "%u s below, ceiling %u at cutoff", below, ceiling);
+}
+
+static void test_cost(void)
+{
+    vm_gov_t gov;
+    struct timespec t0;
+    struct timespec t1;
+    u32 i;
+    u32 sink = 0;
+
+    vm_gov_reset(&gov);
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (i = 0; i < 1000000; i++) {
+        sink += vm_gov_step(&gov, (u16)(i * 7919 % 10001), 3700, VM_GOV_TEMP_NONE, VM_GOV_POLL_MS);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    host_note("info: vm_gov_step %.1f ns on the host (%u), integer math only\n",
+              ((t1.tv_sec - t0.tv_sec) * 1e9 + (t1.tv_nsec - t0.tv_nsec)) / 1e6, sink & 1);
+}
+
+int main(void)
+{
+    test_thermal();
+    test_cool_down();
+    test_battery();
+    test_cost();
+    return host_report("governor");
+}
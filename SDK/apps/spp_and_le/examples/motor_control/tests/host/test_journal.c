@@ -0,0 +1,192 @@
+/**
+ * Boot info journal - power loss at every flash operation and erase counts
+ *
+ * Appends boot-info sized records across several sector moves and cuts
+ * power during each erase / program in turn. The next boot must read the
+ * last record that was acknowledged or the one being written, keep the
+ * records of other types, and be able to append again. A long run then
+ * reports the erases per ring sector against the old scheme, which erased
+ * two sectors per boot info write.
+ */
+
+#include "host_sdk.h"
+#include "custom_journal.h"
+#include "custom_dual_bank_ota.h"
+
+#define RECORDS         200         /* Two sector moves with 40 B payloads */
+#define WEAR_RECORDS    10000
+
+typedef struct {
+    u32 value;
+    u8 fill[sizeof(custom_boot_info_t) - sizeof(u32)];
+} rec_t;
+
+/* Shared with the boots */
+typedef struct {
+    u32 acked;                      /* Last value custom_jnl_append() returned 0 for */
+    u32 read;                       /* Value the checking boot found */
+    int read_len;
+    int meta_len;
+    int append_ret;
+    int reread_ok;
+} jnl_view_t;
+
+static jnl_view_t *g_view;
+
+static const u8 g_meta[12] = {'o', 't', 'a', '-', 'm', 'e', 't', 'a', 1, 2, 3, 4};
+
+static int append_value(u32 value)
+{
+    rec_t rec;
+
+    memset(&rec, (u8)value, sizeof(rec));
+    rec.value = value;
+    return custom_jnl_append(CUSTOM_JNL_TYPE_BOOT_INFO, &rec, sizeof(rec));
+}
+
+static void boot_append(void *arg)
+{
+    u32 n = *(u32 *)arg;
+    u32 v;
+
+    custom_jnl_init();
+    if (custom_jnl_append(CUSTOM_JNL_TYPE_OTA_META, g_meta, sizeof(g_meta)) != 0) {
+        return;
+    }
+    for (v = 1; v <= n; v++) {
+        if (append_value(v) != 0) {
+            return;
+        }
+        g_view->acked = v;
+    }
+}
+
+static void boot_check(void *arg)
+{
+    rec_t rec;
+    u8 meta[sizeof(g_meta)];
+
+    custom_jnl_init();
+    g_view->read_len = custom_jnl_read(CUSTOM_JNL_TYPE_BOOT_INFO, &rec, sizeof(rec));
+    g_view->read = rec.value;
+    g_view->meta_len = custom_jnl_read(CUSTOM_JNL_TYPE_OTA_META, meta, sizeof(meta));
+    if (g_view->meta_len == sizeof(meta) && memcmp(meta, g_meta, sizeof(meta)) != 0) {
+        g_view->meta_len = -2;
+    }
+
+    g_view->append_ret = append_value(0xA5A5A5A5);
+    custom_jnl_init();
+    g_view->reread_ok = custom_jnl_read(CUSTOM_JNL_TYPE_BOOT_INFO, &rec, sizeof(rec)) == sizeof(rec) &&
+                        rec.value == 0xA5A5A5A5;
+}
+
+static void test_power_loss(void)
+{
+    u32 records = RECORDS;
+    u32 cut;
+    u32 cuts = 0;
+    u32 lost = 0;
+    u32 meta_lost = 0;
+    u32 stuck = 0;
+    u32 in_flight = 0;
+    u32 ops;
+    int ret;
+
+    /* Flash operations of the whole run */
+    host_flash_reset();
+    host_boot(boot_append, &records);
+    ops = host_flash_stats()->ops;
+
+    for (cut = 1; cut <= ops; cut++) {
+        host_flash_reset();
+        memset(g_view, 0, sizeof(*g_view));
+        host_flash_cut_at(cut);
+        ret = host_boot(boot_append, &records);
+        host_flash_cut_at(0);
+        if (ret != HOST_BOOT_CUT) {
+            continue;
+        }
+        cuts++;
+
+        host_boot(boot_check, NULL);
+        if (g_view->acked == 0 && g_view->read_len < 0) {
+            /* Nothing acknowledged yet: an empty journal is right */
+        } else if (g_view->read_len != sizeof(rec_t) ||
+                   (g_view->read != g_view->acked && g_view->read != g_view->acked + 1)) {
+            if (lost++ < 5) {
+                host_note("  cut at op %u: acked %u, read %u (len %d)\n", cut, g_view->acked,
+                          g_view->read, g_view->read_len);
+            }
+        } else if (g_view->read == g_view->acked + 1) {
+            in_flight++;
+        }
+        if (g_view->acked && g_view->meta_len != sizeof(g_meta)) {
+            meta_lost++;
+        }
+        if (g_view->append_ret != 0 || !g_view->reread_ok) {
+            stuck++;
+        }
+    }
+
+    HOST_CHECK(cuts == ops, "Power cut at every flash op", "%u of %u ops", cuts, ops);
+    HOST_CHECK(lost == 0, "Latest acknowledged record survives", "%u cuts lost it", lost);
+    HOST_CHECK(meta_lost == 0, "Other record types survive sector moves", "%u cuts lost it", meta_lost);
+    HOST_CHECK(stuck == 0, "Journal writable after the cut", "%u cuts left it stuck", stuck);
+    host_note("info: %u cuts completed the record in flight\n", in_flight);
+}
+
+static void boot_wear(void *arg)
+{
+    u32 *counts = arg;
+    u32 records = WEAR_RECORDS;
+
+    boot_append(&records);
+    custom_jnl_get_erase_counts(counts);
+}
+
+static void test_erase_counts(void)
+{
+    static const u32 sectors[CUSTOM_JNL_SECTORS] = {
+        CUSTOM_JNL_SECTOR_0, CUSTOM_JNL_SECTOR_1, CUSTOM_JNL_SECTOR_2
+    };
+    u32 *counts = host_shared(sizeof(u32) * CUSTOM_JNL_SECTORS);
+    host_flash_stats_t *st = host_flash_stats();
+    u32 per_sector = (CUSTOM_FLASH_SECTOR - sizeof(custom_jnl_sector_t)) /
+                     (sizeof(custom_jnl_rec_t) + ((sizeof(rec_t) + 3) & ~3u));
+    u32 total = 0;
+    u32 min = ~0u;
+    u32 max = 0;
+    u32 header_ok = 1;
+    u8 i;
+
+    host_flash_reset();
+    host_boot(boot_wear, counts);
+
+    host_note("Erases after %u boot info writes (%u records per sector):\n", WEAR_RECORDS, per_sector);
+    host_note("  sector      journal  flash\n");
+    for (i = 0; i < CUSTOM_JNL_SECTORS; i++) {
+        u32 flash = st->erases[sectors[i] / HOST_FLASH_SECTOR];
+
+        host_note("  0x%06x  %7u  %5u\n", sectors[i], counts[i], flash);
+        header_ok &= counts[i] == flash;
+        total += flash;
+        min = counts[i] < min ? counts[i] : min;
+        max = counts[i] > max ? counts[i] : max;
+    }
+    host_note("  total     %7u        (old scheme: %u)\n", total, WEAR_RECORDS * 2);
+
+    /* A move carries the latest OTA_META and boot info over, the rest of a sector is new records */
+    HOST_CHECK(header_ok, "Sector headers count every erase", "%u erases", total);
+    HOST_CHECK(total <= WEAR_RECORDS / (per_sector - 2) + 1, "Erase only full sectors",
+               "%u erases", total);
+    HOST_CHECK(max - min <= 1, "Wear spread over the ring", "min %u, max %u", min, max);
+}
+
+int main(void)
+{
+    g_view = host_shared(sizeof(*g_view));
+
+    test_power_loss();
+    test_erase_counts();
+    return host_report("journal");
+}
@@ -0,0 +1,302 @@
+/**
+ * Logging - tokenized records through the ring, the drains and the decoder
+ *
+ * Stores records on the virtual clock and drains them both ways the
+ * firmware does: vm_log_read() into log query responses, and the UART
+ * drain timer framing them between text lines. Both captures are decoded
+ * with tools/log_decode.py (run from tests/host, as make check does) and
+ * must give exactly the lines vm_log_msgs.h formats for the stored
+ * arguments: time stamps, negative arguments, arguments cut at
+ * VM_LOG_RECORD_MAX and the DROPPED record a full ring leaves.
+ *
+ * Then times one motor write log three ways: the two printf lines it used
+ * to print (to /dev/null), log_tok_* into the ring with the ring drained
+ * as it fills, and a call stripped by the module level.
+ */
+
+#include "host_sdk.h"
+#include "vm_config.h"
+
+#include "system/includes.h"
+#include "uart.h"
+
+#include <stdio.h>
+#include <time.h>
+
+/* Errors are kept and info stripped: log_tok_error is the live call below */
+#define VM_LOG_TAG      "TEST"
+#define VM_LOG_LEVEL    VM_LOG_LEVEL_ERROR
+#include "vm_log.h"
+
+#define LOG_DECODE      "python3 ../../tools/log_decode.py"
+#define UART_CAPTURE    "build/test_log.uart"
+#define BLE_CAPTURE     "build/test_log.ble"
+#define CALLS           1000000
+
+static const struct {
+    const char *tag;
+    const char *fmt;
+} g_msgs[] = {
+#define VM_LOG_MSG(id, tag, fmt)    {tag, fmt},
+#include "vm_log_msgs.h"
+#undef VM_LOG_MSG
+};
+
+static char g_expect[64 * 1024];
+static u32 g_expect_len;
+static u32 g_base_ms;           /* Time of the last record before the capture */
+
+/* ========== Expected decoder output ========== */
+
+static void expect_text(const char *line)
+{
+    g_expect_len += snprintf(g_expect + g_expect_len, sizeof(g_expect) - g_expect_len, "%s\n", line);
+}
+
+static void expect_stamp(u32 ms, u8 id)
+{
+    ms -= g_base_ms;
+    g_expect_len += snprintf(g_expect + g_expect_len, sizeof(g_expect) - g_expect_len,
+                             "[%4u.%03u] [%s] ", ms / 1000, ms % 1000, g_msgs[id].tag);
+}
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wformat-nonliteral"
+static void expect_record(u32 ms, u8 id, s32 a0, s32 a1, s32 a2)
+{
+    expect_stamp(ms, id);
+    g_expect_len += snprintf(g_expect + g_expect_len, sizeof(g_expect) - g_expect_len,
+                             g_msgs[id].fmt, a0, a1, a2);
+    expect_text("");
+}
+#pragma GCC diagnostic pop
+
+/* Runs the decoder on a capture and compares its output */
+static void check_decode(const char *name, const char *args, const char *path, const u8 *data, u32 len)
+{
+    static char out[64 * 1024];
+    char cmd[256];
+    FILE *fp;
+    u32 n = 0;
+    u32 line = 1;
+    u32 i;
+    int status;
+
+    fp = fopen(path, "wb");
+    if (fp) {
+        fwrite(data, 1, len, fp);
+        fclose(fp);
+    }
+    snprintf(cmd, sizeof(cmd), LOG_DECODE " %s %s", args, path);
+    fp = popen(cmd, "r");
+    if (fp) {
+        n = fread(out, 1, sizeof(out) - 1, fp);
+        status = pclose(fp);
+    } else {
+        status = -1;
+    }
+    out[n] = 0;
+
+    for (i = 0; i < n && i < g_expect_len && out[i] == g_expect[i]; i++) {
+        line += out[i] == '\n';
+    }
+    HOST_CHECK(status == 0 && n == g_expect_len && i == n, name, "%u lines, decoder status %d",
+               line - 1, status);
+    if (status != 0 || i != n || n != g_expect_len) {
+        host_note("  first difference on line %u\n  expected:\n%.*s  decoded:\n%s", line,
+                  (int)g_expect_len, g_expect, out);
+    }
+    g_expect_len = 0;
+}
+
+/* ========== Log query (BLE) ========== */
+
+static void test_ble(void)
+{
+    static char dump[4096];
+    u8 rec[VM_LOG_RECORD_MAX];
+    u32 len = 0;
+    u16 n;
+    u16 i;
+
+    g_base_ms = 0;
+    host_run_ms(1200);
+    log_tok_error(MOTOR_DUTY, 5000);
+    expect_record(1200, VM_LOG_ID_MOTOR_DUTY, 5000, 0, 0);
+    host_run_ms(7);
+    log_tok_error(OTA_ACK, -3);
+    expect_record(1207, VM_LOG_ID_OTA_ACK, -3, 0, 0);
+    log_tok_error(OTA_PROGRESS, 65536, 230523, 28);
+    expect_record(1207, VM_LOG_ID_OTA_PROGRESS, 65536, 230523, 28);
+    host_run_ms(70000);
+    log_tok_error(MOTOR_DUTY, 0);
+    expect_record(71207, VM_LOG_ID_MOTOR_DUTY, 0, 0, 0);
+
+    /* One record per default-MTU response at most, as the log query sends them */
+    while ((n = vm_log_read(rec, sizeof(rec))) != 0) {
+        len += snprintf(dump + len, sizeof(dump) - len, "B0 04 %02X", vm_log_pending() & 0xFF);
+        for (i = 0; i < n; i++) {
+            len += snprintf(dump + len, sizeof(dump) - len, " %02x", rec[i]);
+        }
+        len += snprintf(dump + len, sizeof(dump) - len, "\n");
+    }
+    check_decode("Log query records decode", "--ble", BLE_CAPTURE, (const u8 *)dump, len);
+}
+
+/* ========== UART drain ========== */
+
+static u8 g_capture[32 * 1024];
+static u32 g_capture_len;
+
+static void uart_text(const char *line)
+{
+    u32 i;
+
+    for (i = 0; line[i]; i++) {
+        putbyte(line[i]);
+    }
+    putbyte('\n');
+    expect_text(line);
+}
+
+static void uart_drain(void)
+{
+    u32 ticks;
+
+    for (ticks = 0; ticks < 100 && vm_log_pending(); ticks++) {
+        host_run_ms(VM_LOG_DRAIN_MS);
+    }
+    g_capture_len += host_uart_take(g_capture + g_capture_len, sizeof(g_capture) - g_capture_len);
+}
+
+static void test_uart(void)
+{
+    u32 stored = 0;
+    u32 dropped = 0;
+    u32 t0;
+    u16 before;
+    u16 i;
+
+    g_base_ms = jiffies_msec();
+    g_capture_len = 0;
+    vm_log_init();
+
+    uart_text("[VM_BLE] text line before the records");
+    host_run_ms(3);
+    log_tok_error(MOTOR_DUTY, 10000);
+    expect_record(jiffies_msec(), VM_LOG_ID_MOTOR_DUTY, 10000, 0, 0);
+    /* The third argument does not fit in VM_LOG_RECORD_MAX and prints as '?' */
+    log_tok_error(OTA_PROGRESS, 0x7FFFFFFF, 0x7FFFFFFF, 0x7FFFFFFF);
+    expect_stamp(jiffies_msec(), VM_LOG_ID_OTA_PROGRESS);
+    expect_text("Custom OTA: Written 2147483647/2147483647 bytes (?%)");
+    log_tok_error(OTA_ACK, -1000000);
+    expect_record(jiffies_msec(), VM_LOG_ID_OTA_ACK, -1000000, 0, 0);
+    uart_drain();
+    uart_text("[VM_BLE] text line between records");
+
+    /* Fill the ring between two drains */
+    host_run_ms(1);
+    t0 = jiffies_msec();
+    for (i = 0; i < 200; i++) {
+        before = vm_log_pending();
+        log_tok_error(MOTOR_DUTY, i * 50);
+        if (vm_log_pending() > before) {
+            expect_record(t0, VM_LOG_ID_MOTOR_DUTY, i * 50, 0, 0);
+            stored++;
+        } else {
+            dropped++;
+        }
+    }
+    HOST_CHECK(stored && dropped && vm_log_pending() > VM_LOG_RING_SIZE - VM_LOG_RECORD_MAX,
+               "Full ring drops new records", "%u stored, %u dropped, %u B used", stored, dropped,
+               vm_log_pending());
+    uart_drain();
+    host_run_ms(250);
+    log_tok_error(MOTOR_DUTY, 1234);
+    expect_record(jiffies_msec(), VM_LOG_ID_DROPPED, dropped, 0, 0);
+    expect_record(jiffies_msec(), VM_LOG_ID_MOTOR_DUTY, 1234, 0, 0);
+    uart_drain();
+    uart_text("[VM_BLE] text line after the records");
+    g_capture_len += host_uart_take(g_capture + g_capture_len, sizeof(g_capture) - g_capture_len);
+
+    vm_log_deinit();
+    check_decode("UART capture decodes, drops counted", "", UART_CAPTURE, g_capture, g_capture_len);
+}
+
+/* ========== Cost per call ========== */
+
+static double ns_since(const struct timespec *t0)
+{
+    struct timespec t1;
+
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    return ((t1.tv_sec - t0->tv_sec) * 1e9 + (t1.tv_nsec - t0->tv_nsec)) / CALLS;
+}
+
+/* Motor write log before the tokenized records */
+static __attribute__((noinline)) void printf_motor_write(FILE *out, u16 duty, const u8 *data)
+{
+    fprintf(out, "[INFO] Motor write: duty=%d (0x%02X 0x%02X)\n", duty, data[0], data[1]);
+    fprintf(out, "[INFO] Motor duty set to %d (%.2f%%)\n", duty, duty / 100.0);
+}
+
+static void test_cost(void)
+{
+    static u8 sink[VM_LOG_RING_SIZE];
+    FILE *null = fopen("/dev/null", "w");
+    struct timespec t0;
+    volatile u32 loop = 0;
+    u32 evaluated = 0;
+    double printf_ns;
+    double tok_ns;
+    double stripped_ns;
+    u8 data[2];
+    u32 i;
+
+    if (!null) {
+        HOST_CHECK(0, "Cost per call", "no /dev/null");
+        return;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (i = 0; i < CALLS; i++) {
+        data[0] = (u8)i;
+        data[1] = (u8)(i >> 8) & 0x1F;
+        printf_motor_write(null, data[0] | data[1] << 8, data);
+    }
+    printf_ns = ns_since(&t0);
+    fclose(null);
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (i = 0; i < CALLS; i++) {
+        log_tok_error(MOTOR_DUTY, i % 10001);
+        if ((i & 63) == 63) {
+            vm_log_read(sink, sizeof(sink));
+        }
+    }
+    tok_ns = ns_since(&t0);
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (i = 0; i < CALLS; i++) {
+        log_tok_info(MOTOR_DUTY, evaluated++);
+        loop = i;
+    }
+    stripped_ns = ns_since(&t0);
+    (void)loop;
+
+    host_note("Motor write log, per call on the host:\n");
+    host_note("  printf, both lines before     %7.1f ns\n", printf_ns);
+    host_note("  log_tok_*, ring drained       %7.1f ns\n", tok_ns);
+    host_note("  stripped by the module level  %7.1f ns (the loop itself)\n", stripped_ns);
+    HOST_CHECK(tok_ns * 4 < printf_ns, "Tokenized record under a quarter of printf", "%.1f ns vs %.1f ns",
+               tok_ns, printf_ns);
+    HOST_CHECK(evaluated == 0 && stripped_ns < tok_ns, "Stripped call evaluates nothing",
+               "%u arguments evaluated, %.1f ns", evaluated, stripped_ns);
+}
+
+int main(void)
+{
+    test_ble();
+    test_uart();
+    test_cost();
+    return host_report("log");
+}
@@ -0,0 +1,199 @@
+/**
+ * Fixed-block pools - randomized stress against a reference model
+ *
+ * A million random allocations and frees (some oversized, some bad frees)
+ * on pools of several shapes. Every block is filled with its owner's tag
+ * and checked when it is freed, so overlapping or reused-while-live blocks
+ * show up; used / high-water / fail / max_request must match the model
+ * after every step. Then the subsystem pools, the diagnostics encoding and
+ * the GATT buffer hooks.
+ */
+
+#include "host_sdk.h"
+#include "vm_config.h"
+#include "vm_mem_pool.h"
+#include "gatt_common/le_gatt_common.h"
+
+#define STEPS           1000000
+#define MAX_BLOCKS      64
+
+typedef struct {
+    u16 block_size;
+    u8 block_count;
+} shape_t;
+
+/* Reference model of one pool */
+typedef struct {
+    u8 *live[MAX_BLOCKS];
+    u8 tag[MAX_BLOCKS];
+    u8 used;
+    u8 high_water;
+    u16 fail;
+    u16 max_request;
+} model_t;
+
+static u32 g_rand = 12345;
+
+static u32 rnd(u32 n)
+{
+    g_rand = g_rand * 1103515245u + 12345u;
+    return (g_rand >> 8) % n;
+}
+
+static const char *stress(const shape_t *shape)
+{
+    static u32 storage[MAX_BLOCKS * 512 / 4];
+    static u8 links[MAX_BLOCKS];
+    static model_t m;
+    vm_pool_t pool;
+    u32 step;
+    u32 size;
+    u8 *p;
+    u8 i;
+    u32 k;
+    u8 tag = 0;
+
+    memset(&m, 0, sizeof(m));
+    vm_pool_init(&pool, storage, links, shape->block_size, shape->block_count);
+
+    for (step = 0; step < STEPS / 4; step++) {
+        switch (rnd(8)) {
+            case 0: case 1: case 2: case 3:
+                /* Mostly fitting requests, one in sixteen too large */
+                size = rnd(16) ? rnd(shape->block_size) + 1 : shape->block_size + 1 + rnd(64);
+                p = vm_pool_alloc(&pool, size);
+                if (size > m.max_request) {
+                    m.max_request = size;
+                }
+                if (size > shape->block_size || m.used == shape->block_count) {
+                    if (p) {
+                        return "alloc should have failed";
+                    }
+                    if (m.fail < 0xFFFF) {
+                        m.fail++;       /* Saturates, single-block pools get there */
+                    }
+                    break;
+                }
+                if (!p) {
+                    return "alloc failed with blocks free";
+                }
+                if (((uintptr_t)p & 3) || !vm_pool_owns(&pool, p)) {
+                    return "block misaligned or outside the pool";
+                }
+                for (i = 0; i < shape->block_count && m.live[i]; i++) {
+                }
+                m.live[i] = p;
+                m.tag[i] = ++tag;
+                memset(p, tag, shape->block_size);
+                if (++m.used > m.high_water) {
+                    m.high_water = m.used;
+                }
+                break;
+
+            case 4: case 5: case 6:
+                if (!m.used) {
+                    break;
+                }
+                do {
+                    i = rnd(shape->block_count);
+                } while (!m.live[i]);
+                for (k = 0; k < shape->block_size; k++) {
+                    if (m.live[i][k] != m.tag[i]) {
+                        return "block overwritten while allocated";
+                    }
+                }
+                if (vm_pool_free(&pool, m.live[i]) != 0) {
+                    return "free of a live block refused";
+                }
+                m.live[i] = NULL;
+                m.used--;
+                break;
+
+            default:
+                /* Bad frees: inside a block, outside the pool, twice */
+                p = (u8 *)storage + rnd(shape->block_count) * shape->block_size;
+                for (i = 0; i < shape->block_count && m.live[i] != p; i++) {
+                }
+                if (vm_pool_free(&pool, p + 1 + rnd(shape->block_size - 1)) != -1 ||
+                    vm_pool_free(&pool, (u8 *)&pool) != -1 ||
+                    vm_pool_free(&pool, NULL) != -1) {
+                    return "bad pointer accepted";
+                }
+                if (i == shape->block_count && vm_pool_free(&pool, p) != -1) {
+                    return "double free accepted";
+                }
+                break;
+        }
+
+        if (pool.used != m.used || pool.high_water != m.high_water ||
+            pool.fail_count != m.fail || pool.max_request != m.max_request) {
+            return "counters differ from the model";
+        }
+    }
+    return NULL;
+}
+
+static void test_stress(void)
+{
+    static const shape_t shapes[] = {{4, 1}, {16, 7}, {256, 1}, {128, 32}, {512, MAX_BLOCKS}};
+    const char *err;
+    u8 i;
+
+    for (i = 0; i < sizeof(shapes) / sizeof(shapes[0]); i++) {
+        err = stress(&shapes[i]);
+        HOST_CHECK(!err, "Stress", "%u x %u B: %s", shapes[i].block_count, shapes[i].block_size,
+                   err ? err : "ok");
+    }
+}
+
+static void test_subsystem_pools(void)
+{
+    const vm_pool_t *ota = vm_mem_get_pool(VM_POOL_OTA);
+    const vm_pool_t *ble = vm_mem_get_pool(VM_POOL_BLE);
+    u8 diag[VM_MEM_DIAG_SIZE + 4];
+    u8 *a;
+    u8 *b;
+    u8 *heap;
+    u8 n;
+
+    HOST_CHECK(ota->block_size == VM_POOL_OTA_BLOCK_SIZE && ota->block_count == VM_POOL_OTA_BLOCKS,
+               "OTA pool sized from vm_config.h", "%u x %u B", ota->block_count, ota->block_size);
+    HOST_CHECK(vm_mem_get_pool(VM_POOL_COUNT) == NULL && vm_mem_alloc(VM_POOL_COUNT, 4) == NULL,
+               "Unknown pool id rejected", "id %u", VM_POOL_COUNT);
+
+    a = vm_mem_alloc(VM_POOL_OTA, 256);
+    b = vm_mem_alloc(VM_POOL_OTA, 256);
+    HOST_CHECK(a && !b && ota->used == 1 && ota->fail_count == 1, "OTA slot taken once",
+               "used %u, fail %u", ota->used, ota->fail_count);
+    vm_mem_free(VM_POOL_OTA, a);
+    vm_mem_free(VM_POOL_OTA, a);
+    HOST_CHECK(ota->used == 0 && ota->high_water == 1, "OTA slot back, double free ignored",
+               "used %u, hwm %u", ota->used, ota->high_water);
+
+    /* GATT buffer hooks: pool first, heap when the request does not fit */
+    a = ble_comm_ram_malloc(VM_POOL_BLE_BLOCK_SIZE);
+    heap = ble_comm_ram_malloc(VM_POOL_BLE_BLOCK_SIZE + 1);
+    HOST_CHECK(a && vm_pool_owns(ble, a) && heap && !vm_pool_owns(ble, heap) && ble->fail_count == 1,
+               "GATT buffer from the pool, heap fallback counted", "fail %u", ble->fail_count);
+    ble_comm_ram_free(heap);
+    ble_comm_ram_free(a);
+    HOST_CHECK(ble->used == 0, "GATT buffers returned", "used %u", ble->used);
+
+    n = vm_mem_encode_diag(diag, sizeof(diag));
+    HOST_CHECK(n == 2 + 10 * 2 && diag[0] == VM_MEM_DIAG_VERSION && diag[1] == VM_POOL_COUNT,
+               "Diagnostics header", "%u B, %u pools", n, diag[1]);
+    HOST_CHECK(diag[2 + 10 + 0] == VM_POOL_OTA &&
+               (diag[2 + 10 + 1] | diag[2 + 10 + 2] << 8) == VM_POOL_OTA_BLOCK_SIZE &&
+               diag[2 + 10 + 5] == 1 && (diag[2 + 10 + 6] | diag[2 + 10 + 7] << 8) == 1 &&
+               (diag[2 + 10 + 8] | diag[2 + 10 + 9] << 8) == 256,
+               "Diagnostics OTA entry", "hwm %u, fail %u", diag[2 + 10 + 5], diag[2 + 10 + 6]);
+    HOST_CHECK(vm_mem_encode_diag(diag, VM_MEM_DIAG_SIZE - 1) == 0, "Diagnostics buffer too small",
+               "%u B", VM_MEM_DIAG_SIZE - 1);
+}
+
+int main(void)
+{
+    test_stress();
+    test_subsystem_pools();
+    return host_report("mem_pool");
+}
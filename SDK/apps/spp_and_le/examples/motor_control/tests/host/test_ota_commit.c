@@ -0,0 +1,274 @@
+/**
+ * OTA commit - time spent in the BLE write callback and the reset after SUCCESS
+ *
+ * Runs the real vm_ble_service / custom_dual_bank_ota / custom_journal on the
+ * flash model: each DATA and FINISH write must return within a page program
+ * or two, the commit steps run from a timer, and the reset comes exactly once,
+ * after the SUCCESS notification left the TX buffer (or on the fallback).
+ */
+
+#include "host_sdk.h"
+#include "vm_config.h"
+#include "vm_ble_service.h"
+#include "vm_ble_profile.h"
+#include "custom_dual_bank_ota.h"
+#include "asm/crc16.h"
+
+#define CONN            0x0050
+#define MTU             247
+#define CHUNK           (MTU - 6)
+#define IMAGE_SIZE      (40 * 1024 + 123)
+
+/* A DATA write programs at most the pages its chunk completes */
+#define DATA_MAX_US     (2 * HOST_FLASH_PROGRAM_US + 100)
+/* FINISH programs the staged tail only */
+#define FINISH_MAX_US   (HOST_FLASH_PROGRAM_US + 100)
+/* One commit step: CUSTOM_OTA_VERIFY_STEP_PAGES page reads, or the boot info write */
+#define STEP_MAX_US     5000
+
+/* ========== Modules vm_ble_service.c calls outside OTA ========== */
+
+int vm_motor_init(void) { return 0; }
+int vm_motor_set_duty(u16 duty_cycle) { return 0; }
+void vm_motor_deinit(void) { }
+void vm_battery_init(void) { }
+void vm_battery_deinit(void) { }
+u8 vm_battery_get_percent(void) { return 100; }
+void vm_governor_init(void) { }
+void vm_governor_deinit(void) { }
+void vm_governor_encode(u8 *buf) { }
+u8 vm_lr_is_enabled(void) { return 0; }
+u8 vm_lr_get_phy(void) { return 1; }
+s8 vm_lr_get_rssi(void) { return -60; }
+s8 vm_lr_get_rssi_avg(void) { return -60; }
+void vm_power_init(void) { }
+u8 vm_power_encode_stats(u8 *buf, u8 buf_size) { return 0; }
+void vm_power_dump(void) { }
+void vm_settings_init(void) { }
+u8 vm_settings_flush(void) { return 0; }
+u8 vm_settings_handle_cmd(const u8 *req, u16 len, u8 *rsp) { return 0; }
+u8 vm_sync_handle_cmd(const u8 *cmd, u16 len, u8 *rsp) { return 0; }
+void vm_sync_stop(void) { }
+void vm_trace_init(void) { }
+void vm_trace_deinit(void) { }
+u16 vm_trace_dump_start(void) { return 0; }
+u16 vm_trace_dump_next(u8 *buf, u16 max) { return 0; }
+u16 vm_trace_dump_left(void) { return 0; }
+void vm_trace_dump_uart(void) { }
+
+/* ========== Helpers ========== */
+
+static u8 g_image[IMAGE_SIZE];
+
+/* Write from the central; returns the time spent in the callback */
+static u64 ota_write(const u8 *data, u16 len)
+{
+    u64 start = host_now_us();
+
+    vm_ble_handle_ota_write(CONN, data, len);
+    return host_now_us() - start;
+}
+
+/* Link sends everything queued, returns the status of the last notification */
+static u8 ble_drain(void)
+{
+    u8 buf[8];
+    u8 last = 0;
+
+    while (host_ble_pop(NULL, buf, sizeof(buf))) {
+        last = buf[0];
+    }
+    return last;
+}
+
+static void ota_boot_init(void)
+{
+    u32 i;
+
+    host_reset_continue(1);
+    host_flash_reset();
+    host_ble_reset(VM_BLE_TX_CBUF_SIZE);
+    host_ble_set_notify(1);
+    for (i = 0; i < IMAGE_SIZE; i++) {
+        g_image[i] = (u8)(i * 7 + (i >> 8));
+    }
+    custom_dual_bank_ota_init();
+    vm_ble_ota_on_mtu(MTU);
+}
+
+/* START and every DATA chunk; returns the longest DATA callback */
+static u64 ota_transfer(u64 *start_us)
+{
+    u8 pkt[MTU];
+    u16 crc = CRC16(g_image, IMAGE_SIZE);
+    u32 off;
+    u16 seq = 0;
+    u16 n;
+    u64 t;
+    u64 longest = 0;
+
+    pkt[0] = VM_OTA_CMD_START;
+    pkt[1] = IMAGE_SIZE & 0xFF;
+    pkt[2] = (IMAGE_SIZE >> 8) & 0xFF;
+    pkt[3] = (IMAGE_SIZE >> 16) & 0xFF;
+    pkt[4] = (IMAGE_SIZE >> 24) & 0xFF;
+    pkt[5] = crc & 0xFF;
+    pkt[6] = crc >> 8;
+    pkt[7] = 2;
+    *start_us = ota_write(pkt, 8);
+    ble_drain();
+
+    for (off = 0; off < IMAGE_SIZE; off += n, seq++) {
+        n = (IMAGE_SIZE - off > CHUNK) ? CHUNK : IMAGE_SIZE - off;
+        pkt[0] = VM_OTA_CMD_DATA;
+        pkt[1] = seq & 0xFF;
+        pkt[2] = seq >> 8;
+        memcpy(&pkt[3], &g_image[off], n);
+        t = ota_write(pkt, n + 3);
+        if (t > longest) {
+            longest = t;
+        }
+        ble_drain();
+    }
+    return longest;
+}
+
+/* FINISH, then let the commit timer run until the boot info is written */
+static u64 ota_finish(u64 *finish_us)
+{
+    u8 cmd = VM_OTA_CMD_FINISH;
+    u32 waited = 0;
+
+    *finish_us = ota_write(&cmd, 1);
+    host_timer_longest_us();
+    while (custom_dual_bank_ota_get_state() != CUSTOM_OTA_STATE_COMMITTED && waited < 10000) {
+        host_run_ms(VM_OTA_COMMIT_STEP_MS);
+        waited += VM_OTA_COMMIT_STEP_MS;
+    }
+    return host_timer_longest_us();
+}
+
+/* ========== Scenarios (one boot each) ========== */
+
+static void boot_blocking(void *arg)
+{
+    u64 start_us;
+    u64 data_us;
+    u64 finish_us;
+    u64 step_us;
+    u64 again_us;
+    u8 cmd = VM_OTA_CMD_FINISH;
+    u8 status;
+
+    ota_boot_init();
+    data_us = ota_transfer(&start_us);
+    host_note("info: START erases the bank in the callback: %llu us\n",
+              (unsigned long long)start_us);
+    HOST_CHECK(data_us <= DATA_MAX_US, "DATA callback bounded",
+               "longest %llu us (max %u)", (unsigned long long)data_us, DATA_MAX_US);
+
+    finish_us = ota_write(&cmd, 1);
+    HOST_CHECK(finish_us <= FINISH_MAX_US, "FINISH callback bounded",
+               "%llu us (max %u)", (unsigned long long)finish_us, FINISH_MAX_US);
+    status = ble_drain();
+    HOST_CHECK(status == VM_OTA_STATUS_VERIFYING, "FINISH answers VERIFYING", "0x%02x", status);
+
+    host_run_ms(VM_OTA_COMMIT_STEP_MS);
+    again_us = ota_write(&cmd, 1);
+    status = ble_drain();
+    HOST_CHECK(again_us == 0 && status == VM_OTA_STATUS_VERIFYING, "Repeated FINISH answers at once",
+               "%llu us, 0x%02x", (unsigned long long)again_us, status);
+
+    host_timer_longest_us();
+    while (custom_dual_bank_ota_get_state() != CUSTOM_OTA_STATE_COMMITTED) {
+        host_run_ms(VM_OTA_COMMIT_STEP_MS);
+    }
+    step_us = host_timer_longest_us();
+    HOST_CHECK(step_us <= STEP_MAX_US, "Commit step bounded",
+               "longest %llu us (max %u)", (unsigned long long)step_us, STEP_MAX_US);
+}
+
+static void boot_confirm(void *arg)
+{
+    u64 start_us;
+    u64 finish_us;
+    u64 t;
+    u8 last = 0;
+
+    ota_boot_init();
+    ota_transfer(&start_us);
+    ota_finish(&finish_us);
+    HOST_CHECK(host_ble_queued() > 2, "SUCCESS queued behind VERIFYING", "%u bytes queued",
+               host_ble_queued());
+
+    /* Wakeup for a notification sent before the SUCCESS */
+    host_ble_pop(NULL, NULL, 0);
+    vm_ble_ota_on_can_send_now();
+    host_run_ms(VM_OTA_RESET_DELAY_MS * 2);
+    HOST_CHECK(host_resets() == 0, "Early CAN_SEND_NOW does not reset", "%u resets", host_resets());
+
+    last = ble_drain();
+    HOST_CHECK(last == VM_OTA_STATUS_SUCCESS, "SUCCESS is the last notification", "0x%02x", last);
+    t = host_now_us();
+    vm_ble_ota_on_can_send_now();
+    vm_ble_ota_on_can_send_now();
+    host_run_ms(VM_OTA_RESET_DELAY_MS);
+    HOST_CHECK(host_resets() == 1 && host_last_reset_us() - t == VM_OTA_RESET_DELAY_MS * 1000,
+               "Reset after the drained buffer", "%u resets, +%llu us", host_resets(),
+               (unsigned long long)(host_last_reset_us() - t));
+
+    host_run_ms(VM_OTA_RESET_TIMEOUT_MS + 1000);
+    HOST_CHECK(host_resets() == 1, "Fallback cancelled", "%u resets", host_resets());
+}
+
+static void boot_no_notify(void *arg)
+{
+    u64 start_us;
+    u64 finish_us;
+    u64 t;
+
+    ota_boot_init();
+    ota_transfer(&start_us);
+    host_ble_set_notify(0);
+    ota_finish(&finish_us);
+    t = host_now_us();
+
+    vm_ble_ota_on_can_send_now();
+    host_run_ms(VM_OTA_RESET_TIMEOUT_MS - 100);
+    HOST_CHECK(host_resets() == 0, "No reset before the fallback", "%u resets", host_resets());
+    host_run_ms(1000);
+    HOST_CHECK(host_resets() == 1, "Fallback reset with notifications off", "%u resets, +%llu ms",
+               host_resets(), (unsigned long long)((host_last_reset_us() - t) / 1000));
+}
+
+static void boot_disconnect(void *arg)
+{
+    u64 start_us;
+    u64 finish_us;
+    u64 t;
+
+    ota_boot_init();
+    ota_transfer(&start_us);
+    ota_finish(&finish_us);
+
+    t = host_now_us();
+    vm_ble_ota_on_disconnect();
+    vm_ble_ota_on_disconnect();
+    host_run_ms(VM_OTA_RESET_TIMEOUT_MS + 1000);
+    HOST_CHECK(host_resets() == 1 && host_last_reset_us() - t == VM_OTA_RESET_DELAY_MS * 1000,
+               "Disconnect with SUCCESS queued resets once", "%u resets, +%llu us", host_resets(),
+               (unsigned long long)(host_last_reset_us() - t));
+}
+
+int main(void)
+{
+    void (*boots[])(void *arg) = {boot_blocking, boot_confirm, boot_no_notify, boot_disconnect};
+    u8 i;
+    int ret;
+
+    for (i = 0; i < sizeof(boots) / sizeof(boots[0]); i++) {
+        ret = host_boot(boots[i], NULL);
+        HOST_CHECK(ret == HOST_BOOT_DONE, "Boot ran to the end", "scenario %u, ret %d", i, ret);
+    }
+    return host_report("ota_commit");
+}
@@ -0,0 +1,199 @@
+/**
+ * Binary patterns - firmware codec against the client encoder
+ *
+ * pattern_vectors.h holds what utils/pattern-codec.js encodes for every
+ * built-in library pattern, a 101-frame ramp and seeded random patterns
+ * with long gaps and repeated times, with and without the meta block
+ * (make vectors regenerates it, make check fails if it is out of date).
+ * vm_pattern_encode() must give the client's bytes for the same frames,
+ * and vm_pattern_open() / vm_pattern_next() must read both client forms
+ * back to those frames, loop flag and duration included.
+ *
+ * Also checks that damaged and unsupported input is refused: every
+ * single-bit error, truncation, an unknown version, the reserved 16-bit
+ * flag, a pwm step out of range, and encoder buffers that are too small.
+ */
+
+#include "host_sdk.h"
+#include "vm_pattern.h"
+
+#include "asm/crc16.h"
+
+typedef struct {
+    const char *id;
+    u32 duration_ms;
+    u8 loop;
+    u16 frame_count;
+    const vm_pattern_frame_t *frames;
+    const u8 *bare;             /* encodePattern(p, { meta: false }) */
+    u16 bare_len;
+    const u8 *meta;             /* encodePattern(p) */
+    u16 meta_len;
+} pattern_vector_t;
+
+#include "pattern_vectors.h"
+
+#define VECTOR_COUNT    (sizeof(g_vectors) / sizeof(g_vectors[0]))
+
+/* Reads every frame; returns the index of the first wrong one, frame_count if all match */
+static u16 read_frames(vm_pattern_reader_t *r, const pattern_vector_t *v)
+{
+    vm_pattern_frame_t f;
+    u16 i;
+
+    for (i = 0; i < v->frame_count; i++) {
+        if (vm_pattern_next(r, &f) != VM_PATTERN_OK || f.time_ms != v->frames[i].time_ms ||
+            f.pwm != v->frames[i].pwm) {
+            return i;
+        }
+    }
+    return (vm_pattern_next(r, &f) == VM_PATTERN_END) ? i : i + 1;
+}
+
+/* Open and read to the end; VM_PATTERN_OK only if the whole pattern reads */
+static int read_all(const u8 *buf, u16 len)
+{
+    vm_pattern_reader_t r;
+    vm_pattern_frame_t f;
+    int ret = vm_pattern_open(&r, buf, len);
+
+    while (ret == VM_PATTERN_OK) {
+        ret = vm_pattern_next(&r, &f);
+    }
+    return (ret == VM_PATTERN_END) ? VM_PATTERN_OK : ret;
+}
+
+static void set_crc(u8 *buf, u16 len)
+{
+    u16 crc = CRC16(buf, len - VM_PATTERN_CRC_SIZE);
+
+    buf[len - 2] = crc & 0xFF;
+    buf[len - 1] = crc >> 8;
+}
+
+static void test_encode(void)
+{
+    u8 buf[1024];
+    u32 mismatch = 0;
+    u32 bare = 0;
+    u16 len;
+    u16 i;
+
+    for (i = 0; i < VECTOR_COUNT; i++) {
+        const pattern_vector_t *v = &g_vectors[i];
+
+        len = vm_pattern_encode(buf, sizeof(buf), v->frames, v->frame_count, v->duration_ms,
+                                v->loop ? VM_PATTERN_FLAG_LOOP : 0);
+        if (len != v->bare_len || memcmp(buf, v->bare, len) != 0) {
+            host_note("  %s: %u bytes, client %u\n", v->id, len, v->bare_len);
+            mismatch++;
+        }
+        bare += v->bare_len;
+    }
+    HOST_CHECK(mismatch == 0, "Encoder matches the client byte for byte", "%u of %u patterns differ, %u bytes",
+               mismatch, (u32)VECTOR_COUNT, bare);
+}
+
+static void test_read(void)
+{
+    vm_pattern_reader_t r;
+    vm_pattern_frame_t first;
+    u32 bad_bare = 0;
+    u32 bad_meta = 0;
+    u32 bad_rewind = 0;
+    u32 frames = 0;
+    u16 i;
+
+    for (i = 0; i < VECTOR_COUNT; i++) {
+        const pattern_vector_t *v = &g_vectors[i];
+
+        if (vm_pattern_open(&r, v->bare, v->bare_len) != VM_PATTERN_OK ||
+            r.duration_ms != v->duration_ms || !(r.flags & VM_PATTERN_FLAG_LOOP) != !v->loop ||
+            read_frames(&r, v) != v->frame_count) {
+            bad_bare++;
+        }
+        vm_pattern_rewind(&r);
+        if (vm_pattern_next(&r, &first) != VM_PATTERN_OK || first.time_ms != v->frames[0].time_ms ||
+            first.pwm != v->frames[0].pwm) {
+            bad_rewind++;
+        }
+        if (vm_pattern_open(&r, v->meta, v->meta_len) != VM_PATTERN_OK ||
+            !(r.flags & VM_PATTERN_FLAG_META) || r.duration_ms != v->duration_ms ||
+            read_frames(&r, v) != v->frame_count) {
+            bad_meta++;
+        }
+        frames += v->frame_count;
+    }
+    HOST_CHECK(bad_bare == 0 && bad_meta == 0, "Reader yields the client frames",
+               "%u frames; %u patterns wrong without meta, %u with meta", frames, bad_bare, bad_meta);
+    HOST_CHECK(bad_rewind == 0, "Rewind restarts at the first frame", "%u wrong", bad_rewind);
+}
+
+/* A run of two frames, 2 ms and +200 pwm apart: the second would be 400 (CRC set by the test) */
+static const u8 g_over[] = {
+    VM_PATTERN_MAGIC_0, VM_PATTERN_MAGIC_1, VM_PATTERN_VERSION, 0,
+    100, 2, 2 << 1 | 1, 0x90, 0x03, 0, 0, 0,
+};
+
+static void test_rejects(void)
+{
+    const pattern_vector_t *v = &g_vectors[0];
+    vm_pattern_frame_t back[2] = {{500, 10}, {400, 10}};
+    vm_pattern_frame_t f;
+    vm_pattern_reader_t r;
+    u8 buf[1024];
+    u32 caught = 0;
+    u32 short_ok = 0;
+    u16 len;
+    u16 i;
+    u8 bit;
+    int version;
+    int pwm16;
+    int range;
+
+    /* Meta form: a flip in the meta block must be caught too */
+    for (i = 0; i < v->meta_len; i++) {
+        for (bit = 0; bit < 8; bit++) {
+            memcpy(buf, v->meta, v->meta_len);
+            buf[i] ^= 1 << bit;
+            caught += read_all(buf, v->meta_len) != VM_PATTERN_OK;
+        }
+    }
+    HOST_CHECK(caught == v->meta_len * 8u, "Every single-bit error detected", "%u/%u", caught,
+               v->meta_len * 8u);
+    HOST_CHECK(read_all(v->bare, v->bare_len - 3) != VM_PATTERN_OK && read_all(v->bare, 5) != VM_PATTERN_OK,
+               "Truncated pattern rejected", "%u of %u bytes", v->bare_len - 3, v->bare_len);
+
+    memcpy(buf, v->bare, v->bare_len);
+    buf[2] = VM_PATTERN_VERSION + 1;
+    set_crc(buf, v->bare_len);
+    version = vm_pattern_open(&r, buf, v->bare_len);
+    memcpy(buf, v->bare, v->bare_len);
+    buf[3] |= VM_PATTERN_FLAG_PWM16;
+    set_crc(buf, v->bare_len);
+    pwm16 = vm_pattern_open(&r, buf, v->bare_len);
+    HOST_CHECK(version == VM_PATTERN_ERR_FORMAT && pwm16 == VM_PATTERN_ERR_FORMAT,
+               "Unknown version and reserved 16-bit flag rejected", "%d, %d", version, pwm16);
+
+    memcpy(buf, g_over, sizeof(g_over));
+    set_crc(buf, sizeof(g_over));
+    vm_pattern_open(&r, buf, sizeof(g_over));
+    vm_pattern_next(&r, &f);
+    range = vm_pattern_next(&r, &f);
+    HOST_CHECK(range == VM_PATTERN_ERR_RANGE, "pwm step out of range rejected", "%d", range);
+
+    for (len = 0; len < v->bare_len; len++) {
+        short_ok += vm_pattern_encode(buf, len, v->frames, v->frame_count, v->duration_ms,
+                                      VM_PATTERN_FLAG_LOOP) != 0;
+    }
+    HOST_CHECK(short_ok == 0 && vm_pattern_encode(buf, sizeof(buf), back, 2, 1000, 0) == 0,
+               "Encoder refuses short buffers and backwards time", "%u short buffers accepted", short_ok);
+}
+
+int main(void)
+{
+    test_encode();
+    test_read();
+    test_rejects();
+    return host_report("pattern");
+}
@@ -0,0 +1,158 @@
+/**
+ * Settings store - write-back coalescing
+ *
+ * Drives the settings characteristic with bursts of SET commands on the
+ * virtual clock and counts the syscfg writes of VM_CFG_ID_SETTINGS: a
+ * burst within VM_SETTINGS_FLUSH_MS must cost one flash write, a steady
+ * stream one write per VM_SETTINGS_FLUSH_MS, and rewrites of the stored
+ * value, rejected values and GET nothing. SAVE writes at once and takes
+ * the pending timeout with it. The stored blob must hold the last value
+ * of every key.
+ */
+
+#include "host_sdk.h"
+#include "vm_config.h"
+#include "vm_settings.h"
+
+#include "system/includes.h"
+
+/* Module hooks the settings groups call */
+void vm_motor_set_pwm_freq(u32 freq_hz) { }
+void vm_motor_set_curve(u16 duty_min, u16 duty_max) { }
+void vm_lr_adv_sync(void) { }
+
+static u32 writes(void)
+{
+    return host_syscfg_writes(VM_CFG_ID_SETTINGS);
+}
+
+static u8 cmd_set_u16(u8 key, u16 value)
+{
+    u8 req[4] = {VM_SET_CMD_SET, key, value & 0xFF, value >> 8};
+    u8 rsp[VM_SET_RSP_MAX_SIZE];
+
+    vm_settings_handle_cmd(req, sizeof(req), rsp);
+    return rsp[2];
+}
+
+static u8 cmd(const u8 *req, u16 len)
+{
+    u8 rsp[VM_SET_RSP_MAX_SIZE];
+
+    vm_settings_handle_cmd(req, len, rsp);
+    return rsp[2];
+}
+
+static vm_settings_t stored(void)
+{
+    vm_settings_t s;
+
+    memset(&s, 0, sizeof(s));
+    syscfg_read(VM_CFG_ID_SETTINGS, &s, sizeof(s));
+    return s;
+}
+
+static void test_first_boot(void)
+{
+    u32 at_boot;
+
+    host_syscfg_reset();
+    vm_settings_init();
+    at_boot = writes();
+    host_run_ms(VM_SETTINGS_FLUSH_MS);
+    HOST_CHECK(at_boot == 0 && writes() == 1 && !vm_settings_is_dirty(),
+               "Defaults written once, deferred", "%u at init, %u after %u ms", at_boot, writes(),
+               VM_SETTINGS_FLUSH_MS);
+}
+
+static void test_burst(void)
+{
+    static const u8 name[] = {VM_SET_CMD_SET, VM_SET_KEY_DEVICE_NAME, 'B', 'u', 'z', 'z'};
+    u32 base = writes();
+    u32 changes = 0;
+    u16 i;
+    vm_settings_t s;
+
+    /* A slider dragged for two seconds, plus the name */
+    for (i = 0; i < 50; i++) {
+        changes += cmd_set_u16(VM_SET_KEY_PWM_FREQ_HZ, 1000 + i * 100) == VM_SET_OK;
+        host_run_ms(40);
+    }
+    changes += cmd(name, sizeof(name)) == VM_SET_OK;
+    HOST_CHECK(writes() == base && vm_settings_is_dirty(), "Burst held in RAM", "%u writes",
+               writes() - base);
+    host_run_ms(VM_SETTINGS_FLUSH_MS);
+    s = stored();
+    HOST_CHECK(writes() == base + 1, "Burst coalesced into one write", "%u changes, %u writes",
+               changes, writes() - base);
+    HOST_CHECK(s.pwm_freq_hz == 1000 + 49 * 100 && strcmp(s.device_name, "Buzz") == 0 &&
+               s.version == VM_SETTINGS_VERSION, "Stored blob holds the last values",
+               "pwm %u Hz, name %s", s.pwm_freq_hz, s.device_name);
+}
+
+static void test_stream(void)
+{
+    u32 base = writes();
+    u32 changes = 0;
+    u32 duration_ms = 60000;
+    u32 t;
+
+    /* One change every 500 ms for a minute */
+    for (t = 0; t < duration_ms; t += 500) {
+        changes += cmd_set_u16(VM_SET_KEY_DUTY_MIN, (u16)(t / 500 % 2 ? 100 : 200)) == VM_SET_OK;
+        host_run_ms(500);
+    }
+    host_run_ms(VM_SETTINGS_FLUSH_MS);
+    host_note("Stream of %u changes in %u s: %u flash writes (one per change before)\n", changes,
+              duration_ms / 1000, writes() - base);
+    HOST_CHECK(writes() - base <= duration_ms / VM_SETTINGS_FLUSH_MS + 1,
+               "Stream written once per flush period", "%u writes", writes() - base);
+    HOST_CHECK(stored().duty_min == vm_settings_get()->duty_min, "Stream ends stored",
+               "duty_min %u", stored().duty_min);
+}
+
+static void test_no_change(void)
+{
+    static const u8 get[] = {VM_SET_CMD_GET, VM_SET_KEY_PWM_FREQ_HZ};
+    u32 base = writes();
+    u16 pwm = vm_settings_get()->pwm_freq_hz;
+    u8 same = cmd_set_u16(VM_SET_KEY_PWM_FREQ_HZ, pwm);
+    u8 bad = cmd_set_u16(VM_SET_KEY_PWM_FREQ_HZ, 50);
+    u8 ok = cmd(get, sizeof(get));
+    u32 timers = host_timers_active();
+
+    host_run_ms(VM_SETTINGS_FLUSH_MS * 2);
+    HOST_CHECK(same == VM_SET_OK && bad == VM_SET_ERR_VALUE && ok == VM_SET_OK && timers == 0 &&
+               writes() == base && !vm_settings_is_dirty(), "Same value, rejected value and GET cost nothing",
+               "%u writes, %u timers", writes() - base, timers);
+}
+
+static void test_save(void)
+{
+    static const u8 save[] = {VM_SET_CMD_SAVE};
+    u32 base = writes();
+    u8 status;
+
+    cmd_set_u16(VM_SET_KEY_DUTY_MAX, 9000);
+    cmd_set_u16(VM_SET_KEY_ADV_SLOW_INTERVAL, 1600);
+    status = cmd(save, sizeof(save));
+    HOST_CHECK(status == VM_SET_OK && writes() == base + 1 && host_timers_active() == 0,
+               "SAVE writes at once, timeout cancelled", "%u writes, %u timers", writes() - base,
+               host_timers_active());
+    status = cmd(save, sizeof(save));
+    host_run_ms(VM_SETTINGS_FLUSH_MS * 2);
+    HOST_CHECK(status == VM_SET_OK && writes() == base + 1, "SAVE with nothing pending skipped",
+               "%u writes", writes() - base);
+    HOST_CHECK(stored().duty_max == 9000 && stored().adv.slow_interval == 1600, "SAVE stored the batch",
+               "duty_max %u, slow interval %u", stored().duty_max, stored().adv.slow_interval);
+}
+
+int main(void)
+{
+    test_first_boot();
+    test_burst();
+    test_stream();
+    test_no_change();
+    test_save();
+    return host_report("settings");
+}
@@ -0,0 +1,230 @@
+#!/usr/bin/env python3
+"""
+Decoder for tokenized firmware logs (vibration_motor_ble/vm_log.h)
+
+Hot-path log calls (log_tok_*) store a message index and integer arguments
+instead of text. This tool formats them again from vm_log_msgs.h, which must
+be the one the firmware was built with.
+
+Inputs:
+- UART capture (default): raw bytes from the debug UART. Text lines pass
+  through, framed records ([0x1E][record][~sum]) are decoded in place. Reads
+  stdin incrementally, so it also works on a live serial port.
+- BLE log query dumps (--ble): one notification per line as hex, e.g.
+  "B0 04 00 05 01 e8 07 10"; the 3-byte header is skipped.
+
+Record: [len][id][dt varint][arg zigzag varint]..., dt in milliseconds since
+the previous record. Times are printed as the running sum, which is time
+since boot when the capture starts at boot.
+
+Usage:
+    log_decode.py [--msgs vm_log_msgs.h] [--ble] [capture]
+
+Exit status: 0 ok, 2 usage or input error.
+"""
+
+import argparse
+import os
+import re
+import sys
+
+UART_SYNC = 0x1E
+RECORD_MIN = 3
+RECORD_MAX = 17
+
+DEFAULT_MSGS = os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                            os.pardir, "vibration_motor_ble", "vm_log_msgs.h")
+
+MSG_RE = re.compile(r'VM_LOG_MSG\(\s*(\w+)\s*,\s*"((?:[^"\\]|\\.)*)"\s*,\s*"((?:[^"\\]|\\.)*)"\s*\)')
+COMMENT_RE = re.compile(r"/\*.*?\*/|//[^\n]*", re.S)
+CONV_RE = re.compile(r"%([-+ #0]*)(\d*)(?:\.(\d+))?(?:hh|h|ll|l|z)?([diuxXoc%])")
+ESCAPES = {"n": "\n", "t": "\t", "\\": "\\", '"': '"'}
+
+
+def c_unescape(s):
+    return re.sub(r"\\(.)", lambda m: ESCAPES.get(m.group(1), m.group(1)), s)
+
+
+def load_messages(path):
+    """Message table [(name, tag, format)] in index order"""
+    with open(path) as fp:
+        text = COMMENT_RE.sub("", fp.read())
+    msgs = [(m.group(1), c_unescape(m.group(2)), c_unescape(m.group(3))) for m in MSG_RE.finditer(text)]
+    if not msgs:
+        raise ValueError("no VM_LOG_MSG entries in %s" % path)
+    return msgs
+
+
+def read_varint(data, pos):
+    value = 0
+    shift = 0
+    while True:
+        if pos >= len(data) or shift > 28:
+            raise ValueError("truncated varint")
+        b = data[pos]
+        pos += 1
+        value |= (b & 0x7F) << shift
+        shift += 7
+        if not b & 0x80:
+            return value, pos
+
+
+def decode_record(rec):
+    """(id, dt_ms, args) of one record, len byte included"""
+    if len(rec) < RECORD_MIN or rec[0] != len(rec):
+        raise ValueError("bad record length")
+    dt, pos = read_varint(rec, 2)
+    args = []
+    while pos < len(rec):
+        z, pos = read_varint(rec, pos)
+        args.append((z >> 1) ^ -(z & 1))
+    return rec[1], dt, args
+
+
+def format_message(fmt, args):
+    """printf-style integer formatting; arguments cut from the record print as '?'"""
+    it = iter(args)
+
+    def conv(m):
+        flags, width, prec, kind = m.groups()
+        if kind == "%":
+            return "%"
+        value = next(it, None)
+        if value is None:
+            return "?"
+        if kind in "uxXo":
+            value &= 0xFFFFFFFF
+        elif kind == "c":
+            return chr(value & 0xFF)
+        spec = "%" + flags + width + ("." + prec if prec else "") + ("d" if kind in "iu" else kind)
+        return spec % value
+
+    return CONV_RE.sub(conv, fmt)
+
+
+class Decoder:
+    def __init__(self, msgs):
+        self.msgs = msgs
+        self.time_ms = 0
+
+    def record(self, rec):
+        msg_id, dt, args = decode_record(rec)
+        self.time_ms += dt
+        stamp = "[%4d.%03d]" % (self.time_ms // 1000, self.time_ms % 1000)
+        if msg_id >= len(self.msgs):
+            return "%s [?] unknown message %d %s" % (stamp, msg_id, args)
+        _, tag, fmt = self.msgs[msg_id]
+        return "%s [%s] %s" % (stamp, tag, format_message(fmt, args))
+
+    def records(self, data):
+        """Lines for a run of back-to-back records"""
+        pos = 0
+        while pos < len(data):
+            n = data[pos]
+            if n < RECORD_MIN or pos + n > len(data):
+                raise ValueError("bad record at offset %d" % pos)
+            yield self.record(data[pos:pos + n])
+            pos += n
+
+
+class UartStream:
+    """Splits a UART byte stream into text lines and framed records"""
+
+    def __init__(self, decoder):
+        self.decoder = decoder
+        self.buf = bytearray()
+        self.text = bytearray()
+
+    def feed(self, data):
+        self.buf += data
+        out = []
+        pos = 0
+        buf = self.buf
+        while pos < len(buf):
+            b = buf[pos]
+            if b == UART_SYNC:
+                if pos + 1 >= len(buf):
+                    break
+                n = buf[pos + 1]
+                if RECORD_MIN <= n <= RECORD_MAX:
+                    if pos + n + 2 > len(buf):
+                        break
+                    rec = bytes(buf[pos + 1:pos + 1 + n])
+                    if (~sum(rec)) & 0xFF == buf[pos + 1 + n]:
+                        try:
+                            out.append(self.decoder.record(rec))
+                            pos += n + 2
+                            continue
+                        except ValueError:
+                            pass
+            if b == 0x0A:
+                out.append(self.text.decode("utf-8", "replace").rstrip("\r"))
+                self.text.clear()
+            else:
+                self.text.append(b)
+            pos += 1
+        del buf[:pos]
+        return out
+
+    def flush(self):
+        out = []
+        rest = self.text + self.buf
+        if rest:
+            out.append(rest.decode("utf-8", "replace").rstrip("\r\n"))
+        self.text = bytearray()
+        self.buf = bytearray()
+        return out
+
+
+def decode_ble(decoder, lines):
+    for n, line in enumerate(lines, 1):
+        hexstr = re.sub(r"0x|[\s,:]", "", line.strip(), flags=re.I)
+        if not hexstr:
+            continue
+        try:
+            data = bytes.fromhex(hexstr)
+        except ValueError:
+            raise ValueError("line %d: not hex" % n)
+        if len(data) < 3 or data[0] != 0xB0 or data[1] != 0x04:
+            raise ValueError("line %d: not a log query response" % n)
+        try:
+            for out in decoder.records(data[3:]):
+                yield out
+        except ValueError as e:
+            raise ValueError("line %d: %s" % (n, e))
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(description="Decode tokenized firmware logs")
+    parser.add_argument("capture", nargs="?", help="UART capture or BLE dump (default stdin)")
+    parser.add_argument("--msgs", default=DEFAULT_MSGS, help="message table (vm_log_msgs.h)")
+    parser.add_argument("--ble", action="store_true", help="input is hex dumps of log query notifications")
+    args = parser.parse_args(argv)
+
+    try:
+        decoder = Decoder(load_messages(args.msgs))
+        if args.ble:
+            fp = open(args.capture) if args.capture else sys.stdin
+            with fp:
+                for line in decode_ble(decoder, fp):
+                    print(line)
+        else:
+            stream = UartStream(decoder)
+            fp = open(args.capture, "rb") if args.capture else sys.stdin.buffer
+            with fp:
+                while True:
+                    chunk = fp.read1(4096) if hasattr(fp, "read1") else fp.read(4096)
+                    if not chunk:
+                        break
+                    for line in stream.feed(chunk):
+                        print(line, flush=True)
+            for line in stream.flush():
+                print(line)
+    except (OSError, ValueError) as e:
+        print("log_decode: %s" % e, file=sys.stderr)
+        return 2
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,959 @@
+#!/usr/bin/env python3
+"""
+Fleet OTA: update many toys in parallel (vibration_motor_ble/vm_ble_service.h)
+
+Scans on every adapter, then keeps up to --per-adapter transfers running on
+each one. The strongest devices go first, and each is updated through the
+adapter that hears it best. A failed device is tried again (on the adapter
+it hears it best, the one it just failed on counts 10 dB weaker) after a
+backoff, up to --retries times; device errors that will not go away
+(invalid size, erase failed) are not retried. The run ends with a
+per-device report.
+
+Each transfer is the protocol of vm_ble_handle_ota_write():
+- START [0x01][size u32][crc16 u16][version]. The device erases the bank and
+  answers READY [0x01][0x00][att_mtu u16].
+- DATA [0x02][seq u16][data], up to --window chunks in flight. The device
+  writes chunks in order only and ACKs [0x04][seq_low] of the last chunk
+  written. On timeout, or when the device repeats an ACK, sending goes back
+  to the first unacknowledged chunk.
+- FINISH [0x03], sent again on timeout. It is answered by VERIFYING
+  [0x05][pct] and then SUCCESS [0x03][0].
+
+Transports:
+- ble: bleak (pip install bleak), one transport per --adapter (hciN, BlueZ).
+- sim: an in-process fleet of simulated devices following the firmware
+  state machine. It runs in simulated time, so a run takes seconds and its
+  timings are simulated seconds. Each adapter has a fixed airtime shared by
+  its connections, and each device has its own RSSI per adapter. With
+  --sim-faults the RSSI spread reaches weak devices that lose packets and
+  links, some devices drop the link once in the middle of a transfer, and
+  one in 20 has a flash that will not erase.
+
+Usage:
+    ota_fleet.py app.bin [--transport ble|sim] [--adapter hci0]... [--per-adapter 4]
+                 [--name VibMotor] [--address ADDR]... [--count N] [--min-rssi -90]
+                 [--retries 2] [--window 16] [--report report.json]
+    ota_fleet.py app.bin --transport sim [--sim-devices 24] [--sim-faults]
+    ota_fleet.py --benchmark [--sim-devices 24] [--adapters 1,2] [--concurrency 1,2,3,4,6,8]
+
+Exit status: 0 all devices updated, 1 some failed or skipped, 2 usage or input error.
+"""
+
+import argparse
+import asyncio
+import collections
+import json
+import os
+import random
+import selectors
+import sys
+import time
+
+SERVICE_UUID = "9a501a2d-594f-4e2b-b123-5f739a2d594f"
+OTA_CHAR_UUID = "9a531a2d-594f-4e2b-b123-5f739a2d594f"
+DEVICE_NAME = "VibMotor"
+
+# vm_ble_service.h
+CMD_START = 0x01
+CMD_DATA = 0x02
+CMD_FINISH = 0x03
+STATUS_READY = 0x01
+STATUS_PROGRESS = 0x02
+STATUS_SUCCESS = 0x03
+STATUS_ACK = 0x04
+STATUS_VERIFYING = 0x05
+STATUS_NONE = 0x06
+STATUS_ERROR = 0xFF
+
+DATA_HEADER = 3
+ATT_HEADER = 3
+DEFAULT_MTU = 247       # READY without the MTU (older firmware)
+MAX_CHUNK = 241         # One 251-byte link layer packet: L2CAP 4 + ATT 3 + header 3 + 241
+SECTOR_SIZE = 4096
+MAX_SIZE = 300 * 1024   # CUSTOM_BANK_SIZE
+
+# Device error values per phase
+ERRORS = {
+    "start": {
+        0x01: "invalid START (length or firmware size)",
+        0x02: "flash erase failed",
+        0x05: "boot info write failed",
+        0x06: "OTA not initialized",
+        0x07: "update already in progress",
+        0x08: "no memory for the page buffer",
+    },
+    "data": {
+        0x01: "more data than the firmware size",
+        0x03: "not receiving (flash write failed or device restarted)",
+        0x04: "invalid DATA packet",
+    },
+    "finish": {
+        0x03: "flash write failed",
+        0x04: "size or CRC mismatch",
+        0x05: "boot info write failed",
+        0x06: "not in receiving state",
+    },
+}
+
+# Errors a retry will not fix
+PERMANENT = {("start", 0x01), ("start", 0x02), ("start", 0x05), ("start", 0x06), ("finish", 0x05)}
+
+
+def _crc16_table():
+    table = []
+    for i in range(256):
+        crc = i << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+        table.append(crc & 0xFFFF)
+    return table
+
+
+CRC16_TABLE = _crc16_table()
+
+
+def crc16(data):
+    """SDK CRC16() (CCITT, init 0), checked by the firmware after FINISH"""
+    crc = 0
+    for b in data:
+        crc = ((crc << 8) & 0xFFFF) ^ CRC16_TABLE[(crc >> 8) ^ b]
+    return crc
+
+
+def chunk_size(mtu):
+    """Largest DATA payload that fits one write and one link layer packet"""
+    return max(1, min(mtu - ATT_HEADER - DATA_HEADER, MAX_CHUNK))
+
+
+class OtaError(Exception):
+    """Transfer failed; retryable unless the device reported a permanent error"""
+
+    def __init__(self, message, phase=None, code=None, retryable=True):
+        super().__init__(message)
+        self.phase = phase
+        self.code = code
+        self.retryable = retryable
+
+    @classmethod
+    def from_device(cls, code, phase):
+        if code == 0xFF:
+            message = "unknown command"
+        else:
+            message = ERRORS.get(phase, {}).get(code, "error 0x%02x" % code)
+        return cls("%s (device error 0x%02x)" % (message, code), phase, code,
+                   (phase, code) not in PERMANENT and code != 0xFF)
+
+
+# ========== Transfer ==========
+
+class OtaSender:
+    """
+    One transfer over a link. The link has write(bytes) (write without
+    response, waits while the stack queue is full) and a notifications
+    queue; an empty notification means the link is gone.
+    """
+
+    def __init__(self, link, window=16, chunk=0, ack_timeout=1.5, max_retries=5,
+                 finish_timeout=3.0, version=1, log=None):
+        self.link = link
+        self.window = max(1, min(128, window))    # ACKs carry seq & 0xFF
+        self.chunk = chunk
+        self.ack_timeout = ack_timeout
+        self.max_retries = max_retries
+        self.finish_timeout = finish_timeout
+        self.version = version
+        self.log = log or (lambda message: None)
+        self.phase = "idle"
+        self.stats = {"size": 0, "mtu": 0, "chunk": 0, "retransmits": 0, "timeouts": 0,
+                      "write_errors": 0, "erase_s": 0.0, "data_s": 0.0, "verify_s": 0.0}
+
+    @staticmethod
+    def now():
+        return asyncio.get_running_loop().time()
+
+    async def event(self, timeout):
+        """Next notification, None after timeout"""
+        try:
+            data = await asyncio.wait_for(self.link.notifications.get(), max(0.0, timeout))
+        except asyncio.TimeoutError:
+            return None
+        if not data:
+            raise OtaError("link lost", self.phase)
+        if data[0] == STATUS_ERROR:
+            raise OtaError.from_device(data[1] if len(data) > 1 else 0, self.phase)
+        return data
+
+    async def send(self, data):
+        """Write, retried with backoff when the stack refuses it"""
+        for attempt in range(self.max_retries + 1):
+            try:
+                await self.link.write(data)
+                return
+            except ConnectionError:
+                raise OtaError("link lost", self.phase)
+            except Exception as e:  # Stack specific write errors
+                self.stats["write_errors"] += 1
+                if attempt == self.max_retries:
+                    raise OtaError("write failed: %s" % e, self.phase)
+                await asyncio.sleep(0.02 * (attempt + 1))
+
+    async def run(self, firmware):
+        if not 0 < len(firmware) <= MAX_SIZE:
+            raise OtaError("firmware size %d outside 1-%d bytes" % (len(firmware), MAX_SIZE), retryable=False)
+        self.stats["size"] = len(firmware)
+        t = self.now()
+        await self.start(firmware)
+        self.stats["erase_s"] = self.now() - t
+        t = self.now()
+        await self.send_data(firmware)
+        self.stats["data_s"] = self.now() - t
+        t = self.now()
+        await self.finish()
+        self.stats["verify_s"] = self.now() - t
+        self.phase = "done"
+        return self.stats
+
+    async def start(self, firmware):
+        self.phase = "start"
+        size = len(firmware)
+        crc = crc16(firmware)
+        await self.send(bytes([CMD_START]) + size.to_bytes(4, "little") + crc.to_bytes(2, "little") +
+                        bytes([self.version & 0xFF]))
+
+        # The device erases the bank before READY
+        timeout = 3.0 + 0.15 * ((size + SECTOR_SIZE - 1) // SECTOR_SIZE)
+        deadline = self.now() + timeout
+        while True:
+            data = await self.event(deadline - self.now())
+            if data is None:
+                raise OtaError("no READY within %.1f s" % timeout, self.phase)
+            if data[0] == STATUS_READY:
+                break
+        self.stats["mtu"] = data[2] | (data[3] << 8) if len(data) >= 4 else DEFAULT_MTU
+        self.stats["chunk"] = self.chunk or chunk_size(self.stats["mtu"])
+
+    def packet(self, firmware, seq):
+        offset = seq * self.stats["chunk"]
+        return bytes([CMD_DATA, seq & 0xFF, (seq >> 8) & 0xFF]) + firmware[offset:offset + self.stats["chunk"]]
+
+    async def send_data(self, firmware):
+        self.phase = "data"
+        count = (len(firmware) + self.stats["chunk"] - 1) // self.stats["chunk"]
+        queue = self.link.notifications
+        base = 0            # First chunk not acknowledged
+        nxt = 0             # Next chunk to send
+        high = 0            # Chunks sent at least once
+        retries = 0
+        resent_from = -1    # Chunk already sent again on a repeated ACK
+        deadline = self.now() + self.ack_timeout
+
+        while base < count:
+            while nxt < count and nxt - base < self.window and queue.empty():
+                await self.send(self.packet(firmware, nxt))
+                if nxt < high:
+                    self.stats["retransmits"] += 1
+                nxt += 1
+                high = max(high, nxt)
+
+            data = await self.event(deadline - self.now())
+            if data is None:
+                self.stats["timeouts"] += 1
+                retries += 1
+                if retries > self.max_retries:
+                    raise OtaError("no ACK for chunk %d after %d retries" % (base, self.max_retries), self.phase)
+                nxt = base
+                deadline = self.now() + self.ack_timeout
+                continue
+            # The first chunk was lost: the device has nothing to ACK yet
+            if data[0] == STATUS_NONE:
+                if base == 0 and resent_from != 0 and nxt > 0:
+                    resent_from = 0
+                    nxt = 0
+                continue
+            if data[0] != STATUS_ACK:
+                continue
+
+            # The device skipped a chunk after a gap and repeats its last ACK
+            if base > 0 and data[1] == (base - 1) & 0xFF:
+                if resent_from != base and nxt > base:
+                    resent_from = base
+                    nxt = base
+                continue
+
+            # ACK carries the low byte of the last chunk written: find it among those sent
+            for seq in range(high - 1, base - 1, -1):
+                if seq & 0xFF == data[1]:
+                    base = seq + 1
+                    nxt = max(nxt, base)
+                    retries = 0
+                    deadline = self.now() + self.ack_timeout
+                    break
+
+    async def finish(self):
+        self.phase = "finish"
+        packet = bytes([CMD_FINISH])
+        await self.send(packet)
+        retries = 0
+        deadline = self.now() + self.finish_timeout
+        while True:
+            data = await self.event(deadline - self.now())
+            if data is None:
+                retries += 1
+                if retries > self.max_retries:
+                    raise OtaError("no SUCCESS after FINISH", self.phase)
+                await self.send(packet)     # Idempotent: answered with the commit state
+                deadline = self.now() + self.finish_timeout
+            elif data[0] == STATUS_SUCCESS:
+                return
+            elif data[0] == STATUS_VERIFYING:
+                deadline = self.now() + self.finish_timeout
+
+
+# ========== Transports ==========
+#
+# A transport is one adapter:
+#   name, max_links
+#   async scan(duration, name) -> [Advert]
+#   async connect(address) -> link (write(), notifications, close())
+
+Advert = collections.namedtuple("Advert", "address name rssi")
+
+
+class BleTransport:
+    """bleak on one adapter"""
+
+    def __init__(self, adapter, max_links):
+        try:
+            import bleak
+        except ImportError:
+            raise ValueError("the ble transport needs bleak (pip install bleak)")
+        self.bleak = bleak
+        self.adapter = adapter
+        self.name = adapter or "default"
+        self.max_links = max_links
+
+    def _kwargs(self):
+        return {"adapter": self.adapter} if self.adapter else {}
+
+    async def scan(self, duration, name):
+        found = await self.bleak.BleakScanner.discover(timeout=duration, return_adv=True, **self._kwargs())
+        adverts = []
+        for device, adv in found.values():
+            if (adv.local_name or device.name) == name or SERVICE_UUID in (adv.service_uuids or []):
+                adverts.append(Advert(device.address, adv.local_name or device.name, adv.rssi))
+        return adverts
+
+    async def connect(self, address):
+        link = BleLink()
+        client = self.bleak.BleakClient(address, disconnected_callback=lambda c: link.notifications.put_nowait(b""),
+                                        **self._kwargs())
+        await client.connect(timeout=10.0)
+        try:
+            # Writes need LESC Just-Works encryption; BlueZ pairs on demand where pair() is not supported
+            try:
+                await client.pair()
+            except (NotImplementedError, self.bleak.exc.BleakError):
+                pass
+            await client.start_notify(OTA_CHAR_UUID, lambda c, data: link.notifications.put_nowait(bytes(data)))
+        except Exception:
+            await client.disconnect()
+            raise
+        link.client = client
+        return link
+
+
+class BleLink:
+    def __init__(self):
+        self.client = None
+        self.notifications = asyncio.Queue()
+
+    async def write(self, data):
+        if not self.client.is_connected:
+            raise ConnectionError("disconnected")
+        await self.client.write_gatt_char(OTA_CHAR_UUID, data, response=False)
+
+    async def close(self):
+        try:
+            await self.client.disconnect()
+        except Exception:
+            pass
+
+
+# ========== Simulated fleet ==========
+
+SIM_INTERVAL = 0.030            # Connection interval
+SIM_EVENT_PDUS = 6              # Most data packets one connection moves per event
+SIM_ADAPTER_PDUS = 12           # Packets per interval one adapter can move over all its connections (1M PHY)
+SIM_PHONE_QUEUE = 8             # Host writes queued in the stack
+SIM_RX_QUEUE = 8                # Device ACL buffers
+SIM_NOTIFY_QUEUE = 8            # Device notification buffers
+SIM_CONNECT_S = 0.8             # Connect, encryption and MTU exchange
+SIM_ERASE_S = 0.025             # Per 4 KB sector
+SIM_PROGRAM_S = 0.0008          # Per 256-byte page
+SIM_COMMIT_STEPS = 10
+SIM_COMMIT_STEP_S = 0.020
+SIM_RESET_S = 1.5               # Reset to advertising again
+
+
+class SimDevice:
+    """Firmware side of one toy: vm_ble_handle_ota_write() and the commit"""
+
+    def __init__(self, index, rng, rssi, erase_error=0, drop_at=None, mtu=247):
+        self.address = "D0:5E:00:00:%02X:%02X" % (index >> 8, index & 0xFF)
+        self.rssi = rssi            # {adapter: dBm}
+        self.rng = rng
+        self.erase_error = erase_error
+        self.drop_at = drop_at      # Bytes received when the link drops once
+        self.mtu = mtu
+        self.link = None
+        self.advertising = True
+        self.version = 0
+        self.state = "idle"
+        self.commit_phase = "idle"
+        self.commit_reported = 0
+        self.next_seq = 0
+        self.image = None
+        self.size = 0
+        self.crc = 0
+        self.received = 0
+
+    def loss(self, adapter):
+        """Packet loss probability at this RSSI"""
+        return min(0.2, max(0.0, (-75 - self.rssi[adapter]) * 0.004))
+
+    def link_loss_per_s(self, adapter):
+        return max(0.0, (-82 - self.rssi[adapter]) * 0.01)
+
+    def cost(self, data):
+        if data[0] == CMD_START and len(data) == 8 and self.state == "idle":
+            size = int.from_bytes(data[1:5], "little")
+            if 0 < size <= MAX_SIZE:
+                return SIM_ERASE_S * ((size + SECTOR_SIZE - 1) // SECTOR_SIZE)
+        if data[0] == CMD_DATA:
+            return 0.0002 + SIM_PROGRAM_S * (len(data) - DATA_HEADER) / 256
+        return 0.0002
+
+    def notify(self, data):
+        return self.link.notify(bytes(data)) if self.link else False
+
+    def handle(self, data):
+        cmd = data[0]
+        if cmd == CMD_START:
+            if len(data) != 8:
+                self.notify([STATUS_ERROR, 0x01])
+            elif self.state != "idle":
+                self.notify([STATUS_ERROR, 0x07])
+            elif self.erase_error:
+                self.notify([STATUS_ERROR, self.erase_error])
+            else:
+                size = int.from_bytes(data[1:5], "little")
+                if size == 0 or size > MAX_SIZE:
+                    self.notify([STATUS_ERROR, 0x01])
+                    return
+                self.size = size
+                self.crc = int.from_bytes(data[5:7], "little")
+                self.image = bytearray(size)
+                self.received = 0
+                self.next_seq = 0
+                self.state = "receiving"
+                self.notify([STATUS_READY, 0x00, self.mtu & 0xFF, self.mtu >> 8])
+        elif cmd == CMD_DATA:
+            if self.state != "receiving":
+                self.notify([STATUS_ERROR, 0x03])
+                return
+            seq = data[1] | (data[2] << 8)
+            if seq != self.next_seq:
+                self.notify([STATUS_NONE, 0x00] if self.next_seq == 0
+                            else [STATUS_ACK, (self.next_seq - 1) & 0xFF])
+                return
+            chunk = data[DATA_HEADER:]
+            if self.received + len(chunk) > self.size:
+                self.state = "idle"
+                self.notify([STATUS_ERROR, 0x01])
+                return
+            self.image[self.received:self.received + len(chunk)] = chunk
+            self.received += len(chunk)
+            self.next_seq = (self.next_seq + 1) & 0xFFFF
+            self.notify([STATUS_ACK, seq & 0xFF])
+            if seq % 10 == 0:
+                self.notify([STATUS_PROGRESS, self.received * 100 // self.size])
+        elif cmd == CMD_FINISH:
+            if self.commit_phase != "idle":
+                self.notify([STATUS_VERIFYING, self.commit_reported] if self.commit_phase == "running"
+                            else [STATUS_SUCCESS, 0x00])
+            elif self.state != "receiving":
+                self.notify([STATUS_ERROR, 0x06])
+            elif self.received != self.size or crc16(self.image) != self.crc:
+                self.state = "idle"
+                self.notify([STATUS_ERROR, 0x04])
+            else:
+                self.commit_phase = "running"
+                self.commit_reported = 0
+                self.notify([STATUS_VERIFYING, 0])
+                asyncio.get_running_loop().create_task(self.commit())
+        else:
+            self.notify([STATUS_ERROR, 0xFF])
+
+    async def commit(self):
+        """ota_commit_poll(): VERIFYING every 10 %, SUCCESS retried until queued, then the reset"""
+        for step in range(1, SIM_COMMIT_STEPS):
+            await asyncio.sleep(SIM_COMMIT_STEP_S)
+            progress = step * 100 // SIM_COMMIT_STEPS
+            if progress >= self.commit_reported + 10:
+                self.commit_reported = progress
+                self.notify([STATUS_VERIFYING, progress])
+        await asyncio.sleep(SIM_COMMIT_STEP_S)
+        self.version += 1
+        self.commit_phase = "success"
+        for _ in range(100):
+            if not self.link or self.notify([STATUS_SUCCESS, 0x00]):
+                break
+            await asyncio.sleep(SIM_INTERVAL)
+        await asyncio.sleep(0.1 if self.link else 0)
+        if self.link:
+            self.link.drop("device reset")
+        self.advertising = False
+        await asyncio.sleep(SIM_RESET_S)
+        self.state = "idle"
+        self.commit_phase = "idle"
+        self.advertising = True
+
+    def on_disconnect(self):
+        """vm_ble_ota_on_disconnect(): a transfer cut short is dropped"""
+        self.link = None
+        if self.state == "receiving" and self.commit_phase == "idle":
+            self.state = "idle"
+
+
+class SimLink:
+    """One connection: connection events move queued writes and notifications"""
+
+    def __init__(self, transport, device):
+        self.transport = transport
+        self.device = device
+        self.rng = device.rng
+        self.notifications = asyncio.Queue()
+        self.connected = True
+        self.phone = collections.deque()
+        self.room = asyncio.Event()
+        self.rx = collections.deque()
+        self.tx = collections.deque()
+        self.busy = False
+        self.credit = 0.0           # Packets this connection may send, its share of the adapter's airtime
+        self.llp = 251 if device.mtu > 23 else 27
+        device.link = self
+        transport.links.add(self)
+        self.task = asyncio.get_running_loop().create_task(self.events())
+
+    def pdus(self, length):
+        return -(-(length + ATT_HEADER + 4) // self.llp)
+
+    def notify(self, data):
+        if len(self.tx) >= SIM_NOTIFY_QUEUE:
+            return False
+        self.tx.append(data)
+        return True
+
+    async def write(self, data):
+        while self.connected and len(self.phone) >= SIM_PHONE_QUEUE:
+            self.room.clear()
+            await self.room.wait()
+        if not self.connected:
+            raise ConnectionError("disconnected")
+        self.phone.append(bytes(data))
+
+    async def events(self):
+        adapter = self.transport.name
+        loop = asyncio.get_running_loop()
+        while self.connected:
+            await asyncio.sleep(SIM_INTERVAL)
+            if not self.connected:
+                break
+            if (self.device.drop_at is not None and self.device.received >= self.device.drop_at) or \
+                    self.rng.random() < self.device.link_loss_per_s(adapter) * SIM_INTERVAL:
+                self.device.drop_at = None
+                self.drop("supervision timeout")
+                break
+
+            loss = self.device.loss(adapter)
+            self.credit = min(SIM_EVENT_PDUS, self.credit + self.transport.share())
+            while self.phone and len(self.rx) < SIM_RX_QUEUE:
+                pdus = self.pdus(len(self.phone[0]))
+                if pdus > self.credit:
+                    break
+                self.credit -= pdus
+                data = self.phone.popleft()
+                if self.rng.random() >= loss:
+                    self.rx.append(data)
+            self.room.set()
+            if self.rx and not self.busy:
+                self.busy = True
+                loop.create_task(self.process())
+
+            budget = SIM_EVENT_PDUS
+            while self.tx and budget > 0:
+                data = self.tx.popleft()
+                budget -= self.pdus(len(data))
+                if self.rng.random() >= loss:
+                    loop.call_later(0.001, self.notifications.put_nowait, data)
+
+    async def process(self):
+        """Write callbacks one at a time; the erase and page programs block them"""
+        while self.rx and self.connected:
+            data = self.rx.popleft()
+            await asyncio.sleep(self.device.cost(data))
+            if self.connected:
+                self.device.handle(data)
+        self.busy = False
+
+    def drop(self, reason):
+        if not self.connected:
+            return
+        self.connected = False
+        self.transport.links.discard(self)
+        self.room.set()
+        self.notifications.put_nowait(b"")
+        self.device.on_disconnect()
+
+    async def close(self):
+        self.drop("closed")
+
+
+class SimFleet:
+    """Simulated toys; RSSI per adapter, faults from the seed"""
+
+    def __init__(self, count, adapters, seed=1, faults=True):
+        rng = random.Random(seed)
+        self.devices = {}
+        for i in range(count):
+            base = rng.uniform(-92, -50) if faults else rng.uniform(-75, -45)
+            rssi = {adapter: round(base + rng.uniform(-8, 8)) for adapter in adapters}
+            erase_error = 0x02 if faults and i % 20 == 7 else 0
+            drop_at = rng.randrange(20000, 200000) if faults and i % 8 == 3 else None
+            device = SimDevice(i, random.Random(rng.random()), rssi, erase_error, drop_at)
+            self.devices[device.address] = device
+
+
+class SimTransport:
+    def __init__(self, name, fleet, max_links):
+        self.name = name
+        self.fleet = fleet
+        self.max_links = max_links
+        self.links = set()
+        self.rng = random.Random(name)
+
+    def share(self):
+        """Packets per connection event while the adapter's airtime is shared"""
+        return min(SIM_EVENT_PDUS, SIM_ADAPTER_PDUS / max(1, len(self.links)))
+
+    async def scan(self, duration, name):
+        await asyncio.sleep(duration)
+        return [Advert(d.address, DEVICE_NAME, d.rssi[self.name]) for d in self.fleet.devices.values()
+                if d.advertising and name == DEVICE_NAME]
+
+    async def connect(self, address):
+        device = self.fleet.devices.get(address)
+        await asyncio.sleep(SIM_CONNECT_S * self.rng.uniform(0.8, 1.5))
+        if device is None or not device.advertising or device.link:
+            raise ConnectionError("device not advertising")
+        if self.rng.random() < device.loss(self.name) * 2:
+            raise ConnectionError("connection failed")
+        return SimLink(self, device)
+
+
+class VirtualTimeLoop(asyncio.SelectorEventLoop):
+    """Event loop whose clock jumps to the next timer instead of waiting for it"""
+
+    class Selector(selectors.DefaultSelector):
+        clock = 0.0
+
+        def select(self, timeout=None):
+            events = super().select(0)
+            if not events:
+                if timeout is None:
+                    return super().select(None)
+                self.clock += timeout
+            return events
+
+    def __init__(self):
+        self.selector = self.Selector()
+        super().__init__(self.selector)
+
+    def time(self):
+        return self.selector.clock
+
+
+def run_loop(loop, coro):
+    """Run to completion, then cancel what is left (simulated device resets, links) and close"""
+    try:
+        return loop.run_until_complete(coro)
+    finally:
+        loop.run_until_complete(_cancel_rest())
+        loop.close()
+
+
+async def _cancel_rest():
+    """Cancel every other task on the running loop and wait for them"""
+    tasks = asyncio.all_tasks() - {asyncio.current_task()}
+    for task in tasks:
+        task.cancel()
+    if tasks:
+        await asyncio.gather(*tasks, return_exceptions=True)
+
+
+# ========== Orchestrator ==========
+
+class Job:
+    def __init__(self, address, name):
+        self.address = address
+        self.name = name
+        self.rssi = {}          # adapter -> dBm
+        self.result = "pending"
+        self.attempts = 0
+        self.running = False
+        self.not_before = 0.0
+        self.last_failed_on = None
+        self.adapter = None
+        self.seconds = 0.0
+        self.stats = None
+        self.errors = []
+
+    def best_rssi(self):
+        return max(self.rssi.values()) if self.rssi else -127
+
+    def rssi_on(self, adapter):
+        rssi = self.rssi.get(adapter, self.best_rssi() - 20)
+        return rssi - 10 if adapter == self.last_failed_on else rssi
+
+
+class Fleet:
+    def __init__(self, transports, firmware, args, log):
+        self.transports = transports
+        self.firmware = firmware
+        self.args = args
+        self.log = log
+        self.jobs = []
+        self.started = 0.0
+
+    async def scan(self):
+        found = await asyncio.gather(*(t.scan(self.args.scan_time, self.args.name) for t in self.transports),
+                                     return_exceptions=True)
+        jobs = {}
+        for transport, adverts in zip(self.transports, found):
+            if isinstance(adverts, Exception):
+                self.log("[%s] scan failed: %s" % (transport.name, adverts))
+                continue
+            for advert in adverts:
+                job = jobs.setdefault(advert.address, Job(advert.address, advert.name))
+                job.rssi[transport.name] = max(advert.rssi, job.rssi.get(transport.name, -127))
+        if self.args.address:
+            wanted = {a.upper() for a in self.args.address}
+            for address in wanted - {a.upper() for a in jobs}:
+                self.log("%s not found" % address)
+            jobs = {a: j for a, j in jobs.items() if a.upper() in wanted}
+
+        self.jobs = sorted(jobs.values(), key=lambda j: -j.best_rssi())
+        if self.args.count:
+            self.jobs = self.jobs[:self.args.count]
+        for job in self.jobs:
+            if job.best_rssi() < self.args.min_rssi:
+                job.result = "skipped"
+                job.errors.append("RSSI %d dBm below %d" % (job.best_rssi(), self.args.min_rssi))
+        return self.jobs
+
+    def pick(self, transport, now):
+        """Ready job this adapter hears best; strongest first"""
+        ready = [j for j in self.jobs if j.result == "pending" and not j.running and j.not_before <= now]
+        if not ready:
+            return None
+        return max(ready, key=lambda j: j.rssi_on(transport.name))
+
+    def remaining(self):
+        return any(j.result == "pending" for j in self.jobs)
+
+    async def worker(self, transport):
+        loop = asyncio.get_running_loop()
+        while self.remaining():
+            job = self.pick(transport, loop.time())
+            if job is None:
+                await asyncio.sleep(0.1)
+                continue
+            job.running = True
+            try:
+                await self.attempt(transport, job)
+            finally:
+                job.running = False
+
+    async def attempt(self, transport, job):
+        loop = asyncio.get_running_loop()
+        job.attempts += 1
+        job.adapter = transport.name
+        start = loop.time()
+        link = None
+        try:
+            link = await asyncio.wait_for(transport.connect(job.address), 15.0)
+            sender = OtaSender(link, window=self.args.window, ack_timeout=self.args.ack_timeout)
+            job.stats = await sender.run(self.firmware)
+            job.seconds = loop.time() - start
+            job.result = "updated"
+            self.log("[%s] %s updated in %.1f s (%.1f KB/s, %d resent), attempt %d" % (
+                transport.name, job.address, job.seconds, len(self.firmware) / 1024 / max(job.stats["data_s"], 1e-6),
+                job.stats["retransmits"], job.attempts))
+        except (OtaError, ConnectionError, OSError, asyncio.TimeoutError) as e:
+            message = str(e) or e.__class__.__name__
+            retryable = getattr(e, "retryable", True)
+            job.errors.append("%s: %s" % (transport.name, message))
+            job.last_failed_on = transport.name
+            if retryable and job.attempts <= self.args.retries:
+                job.not_before = loop.time() + self.args.backoff * job.attempts
+                self.log("[%s] %s attempt %d failed: %s, retrying" % (transport.name, job.address, job.attempts, message))
+            else:
+                job.result = "failed"
+                job.seconds = loop.time() - start
+                self.log("[%s] %s failed: %s" % (transport.name, job.address, message))
+        finally:
+            if link:
+                await link.close()
+
+    async def run(self):
+        loop = asyncio.get_running_loop()
+        self.started = loop.time()
+        await self.scan()
+        self.log("%d device(s), %d adapter(s), up to %s at a time" % (
+            len(self.jobs), len(self.transports), "+".join(str(t.max_links) for t in self.transports)))
+        workers = [self.worker(t) for t in self.transports for _ in range(t.max_links)]
+        await asyncio.gather(*workers)
+        return loop.time() - self.started
+
+
+def report(jobs, elapsed, size, out=sys.stdout):
+    print("\n%-18s %5s %-8s %-8s %5s %7s %7s %6s  %s" % (
+        "address", "rssi", "adapter", "result", "tries", "time s", "KB/s", "resent", "error"), file=out)
+    for job in jobs:
+        stats = job.stats if job.result == "updated" else None
+        print("%-18s %5d %-8s %-8s %5d %7.1f %7s %6s  %s" % (
+            job.address, job.best_rssi(), job.adapter or "-", job.result, job.attempts, job.seconds,
+            "%.1f" % (size / 1024 / stats["data_s"]) if stats else "-",
+            stats["retransmits"] if stats else "-",
+            job.errors[-1] if job.errors and job.result != "updated" else ""), file=out)
+    updated = sum(j.result == "updated" for j in jobs)
+    print("\n%d/%d updated in %.1f s, %.1f KB/s aggregate" % (
+        updated, len(jobs), elapsed, updated * size / 1024 / max(elapsed, 1e-6)), file=out)
+
+
+def json_report(jobs, elapsed, firmware, path):
+    doc = {
+        "firmware": {"size": len(firmware), "crc16": "0x%04x" % crc16(firmware)},
+        "elapsed_s": round(elapsed, 2),
+        "devices": [{
+            "address": j.address, "name": j.name, "rssi": j.rssi, "adapter": j.adapter,
+            "result": j.result, "attempts": j.attempts, "seconds": round(j.seconds, 2),
+            "stats": j.stats and {k: round(v, 3) if isinstance(v, float) else v for k, v in j.stats.items()},
+            "errors": j.errors,
+        } for j in jobs],
+    }
+    with open(path, "w") as fp:
+        json.dump(doc, fp, indent=2)
+        fp.write("\n")
+
+
+# ========== Benchmark ==========
+
+def benchmark(args):
+    firmware = bytes(random.Random(7).getrandbits(8) for _ in range(args.bench_size * 1024))
+    adapters_list = [int(x) for x in args.adapters.split(",")]
+    concurrency = [int(x) for x in args.concurrency.split(",")]
+    print("Simulated fleet: %d toys, %d KB image, %d ms interval, %d packets per interval per adapter" % (
+        args.sim_devices, args.bench_size, SIM_INTERVAL * 1000, SIM_ADAPTER_PDUS))
+    print("\n%8s %11s %10s %12s %10s %8s" % ("adapters", "per adapter", "fleet s", "aggregate", "per toy s", "updated"))
+    for adapters in adapters_list:
+        for per in concurrency:
+            names = ["sim%d" % i for i in range(adapters)]
+            fleet = SimFleet(args.sim_devices, names, args.sim_seed, faults=args.sim_faults)
+            transports = [SimTransport(n, fleet, per) for n in names]
+            bench_args = argparse.Namespace(**vars(args))
+            bench_args.scan_time = 0.0
+            runner = Fleet(transports, firmware, bench_args, lambda message: None)
+            elapsed = run_loop(VirtualTimeLoop(), runner.run())
+            done = [j for j in runner.jobs if j.result == "updated"]
+            per_toy = sum(j.seconds for j in done) / max(1, len(done))
+            print("%8d %11d %10.1f %7.1f KB/s %10.1f %5d/%d" % (
+                adapters, per, elapsed, len(done) * len(firmware) / 1024 / elapsed, per_toy,
+                len(done), len(runner.jobs)))
+    return 0
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(description="Update many toys in parallel over one or more adapters")
+    parser.add_argument("firmware", nargs="?", help="firmware image (app.bin)")
+    parser.add_argument("--transport", choices=("ble", "sim"), default="ble", help="BLE adapters or simulated fleet")
+    parser.add_argument("--adapter", action="append", help="adapter (hci0, ...), repeat for several")
+    parser.add_argument("--per-adapter", type=int, default=4, help="transfers at a time per adapter")
+    parser.add_argument("--name", default=DEVICE_NAME, help="advertised name to update")
+    parser.add_argument("--address", action="append", help="only this device, repeat for several")
+    parser.add_argument("--count", type=int, help="update at most N devices, strongest first")
+    parser.add_argument("--min-rssi", type=int, default=-90, help="skip devices weaker than this (dBm)")
+    parser.add_argument("--scan-time", type=float, default=5.0, help="scan duration (s)")
+    parser.add_argument("--retries", type=int, default=2, help="attempts after the first for a failed device")
+    parser.add_argument("--backoff", type=float, default=3.0, help="wait before a retry, times the attempt (s)")
+    parser.add_argument("--window", type=int, default=16, help="DATA chunks in flight")
+    parser.add_argument("--ack-timeout", type=float, default=1.5, help="no ACK progress for this long: resend (s)")
+    parser.add_argument("--report", help="write the per-device report as JSON")
+    parser.add_argument("--quiet", action="store_true", help="only print the report")
+    sim = parser.add_argument_group("simulation")
+    sim.add_argument("--sim-devices", type=int, default=24, help="simulated toys")
+    sim.add_argument("--sim-seed", type=int, default=1, help="seed for RSSI and faults")
+    sim.add_argument("--sim-faults", action="store_true", help="weak, flaky and broken toys in the fleet")
+    sim.add_argument("--benchmark", action="store_true", help="aggregate throughput versus concurrency")
+    sim.add_argument("--adapters", default="1,2", help="benchmark adapter counts")
+    sim.add_argument("--concurrency", default="1,2,3,4,6,8", help="benchmark transfers per adapter")
+    sim.add_argument("--bench-size", type=int, default=220, help="benchmark image size (KB)")
+    args = parser.parse_args(argv)
+
+    if args.benchmark:
+        return benchmark(args)
+    if not args.firmware:
+        parser.error("firmware image required")
+
+    try:
+        with open(args.firmware, "rb") as fp:
+            firmware = fp.read()
+        if not 0 < len(firmware) <= MAX_SIZE:
+            raise ValueError("%s is %d bytes, the bank holds %d" % (args.firmware, len(firmware), MAX_SIZE))
+        if args.transport == "sim":
+            names = args.adapter or ["sim0"]
+            fleet = SimFleet(args.sim_devices, names, args.sim_seed, faults=args.sim_faults)
+            transports = [SimTransport(n, fleet, args.per_adapter) for n in names]
+            loop = VirtualTimeLoop()
+        else:
+            transports = [BleTransport(a, args.per_adapter) for a in (args.adapter or [None])]
+            loop = asyncio.new_event_loop()
+    except (OSError, ValueError) as e:
+        print("ota_fleet: %s" % e, file=sys.stderr)
+        return 2
+
+    if args.quiet:
+        log = lambda message: None
+    elif args.transport == "sim":
+        log = lambda message: print("%7.1f %s" % (loop.time(), message))
+    else:
+        wall = time.monotonic()
+        log = lambda message: print("%7.1f %s" % (time.monotonic() - wall, message))
+
+    runner = Fleet(transports, firmware, args, log)
+    try:
+        elapsed = run_loop(loop, runner.run())
+    except KeyboardInterrupt:
+        elapsed = loop.time() - runner.started
+
+    print("%s: %d bytes, CRC16 0x%04x%s" % (os.path.basename(args.firmware), len(firmware), crc16(firmware),
+                                           " (simulated time)" if args.transport == "sim" else ""))
+    report(runner.jobs, elapsed, len(firmware))
+    if args.report:
+        json_report(runner.jobs, elapsed, firmware, args.report)
+    return 0 if runner.jobs and all(j.result == "updated" for j in runner.jobs) else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,676 @@
+#!/usr/bin/env python3
+"""
+Firmware size report and budget check for sdk.elf
+
+Splits the linked image into per-source-file text / rodata / data / bss,
+checks it against size_budget.json and writes a diffable JSON report.
+
+The build links with -flto, so the map file attributes every input section
+to sdk.elf.o and most functions are inlined into their callers. Sizes are
+therefore taken from the ELF itself:
+
+- code bytes: DWARF line table, so inlined code counts for the file it was
+  written in rather than the function it ended up in
+- objects (rodata / data / bss): symbol table, file from debug info (nm -l)
+- code without line info: the enclosing function symbol
+- merged string literals / constants (.rodata.str*, .rodata.cst*): no
+  symbols, taken from the map as "<string literals>" / "<merged constants>"
+- whatever is left (alignment, linker fill): "<unattributed>"
+
+The map file also gives the memory regions (code0 / ram0) and their lengths.
+
+Only binutils (readelf, nm) and the Python standard library are needed.
+Set READELF / NM to use the toolchain's own copies.
+
+Usage:
+    size_report.py --elf sdk.elf [--map sdk.map] [--budget size_budget.json]
+                   [--json report.json] [--baseline old_report.json]
+                   [--update-budget] [--top N]
+
+Exit status: 0 within budget, 1 budget exceeded, 2 usage or tool error.
+"""
+
+import argparse
+import array
+import bisect
+import collections
+import fnmatch
+import json
+import os
+import posixpath
+import re
+import struct
+import subprocess
+import sys
+
+CATEGORIES = ("text", "rodata", "data", "bss")
+UNATTRIBUTED = "<unattributed>"
+NO_DEBUG_INFO = "<no debug info>"
+STRINGS = "<string literals>"
+CONSTANTS = "<merged constants>"
+
+# Paths are reported relative to these: the SDK tree and the build tree of the prebuilt libraries
+DEFAULT_ROOTS = ["SDK", "data_trans_sdk"]
+
+SHF_WRITE = 0x1
+SHF_ALLOC = 0x2
+SHF_EXECINSTR = 0x4
+
+
+class ToolError(Exception):
+    pass
+
+
+def run_tool(args):
+    try:
+        proc = subprocess.run(args, stdout=subprocess.PIPE, stderr=subprocess.PIPE,
+                              universal_newlines=True, errors="replace")
+    except OSError as e:
+        raise ToolError("cannot run %s: %s" % (args[0], e))
+    if proc.returncode != 0:
+        raise ToolError("%s failed: %s" % (" ".join(args), proc.stderr.strip()))
+    return proc.stdout
+
+
+# ========== Paths ==========
+
+_ABS_RE = re.compile(r"[A-Za-z]:/|//")
+
+
+def normalize_path(path, roots):
+    """
+    Debug info paths are a mix of Windows and build-server paths, sometimes
+    with the directory prepended to an already absolute name. Keep the last
+    absolute path and strip everything up to the last root directory.
+    """
+    path = path.replace("\\", "/")
+    last = None
+    for m in _ABS_RE.finditer(path):
+        last = m
+    if last and last.start() > 0:
+        path = path[last.start() + (1 if last.group() == "//" else 0):]
+    drive = ""
+    if re.match(r"[A-Za-z]:/", path):
+        drive, path = path[:2], path[2:]
+    path = posixpath.normpath(path)
+    for root in roots:
+        marker = "/" + root + "/"
+        i = path.rfind(marker)
+        if i >= 0:
+            return path[i + len(marker):]
+    return drive + path
+
+
+def join_path(base, name):
+    name = name.replace("\\", "/")
+    if name.startswith("/") or re.match(r"[A-Za-z]:/", name) or not base:
+        return name
+    return base.replace("\\", "/").rstrip("/") + "/" + name
+
+
+# ========== ELF ==========
+
+class Section(object):
+    def __init__(self, index, name, stype, addr, offset, size, flags):
+        self.index = index
+        self.name = name
+        self.type = stype
+        self.addr = addr
+        self.offset = offset
+        self.size = size
+        self.flags = flags
+
+    @property
+    def alloc(self):
+        return bool(self.flags & SHF_ALLOC)
+
+    @property
+    def executable(self):
+        return bool(self.flags & SHF_EXECINSTR)
+
+    def category(self):
+        """Category of bytes in this section not covered by a more specific rule"""
+        if self.type == "NOBITS" or "bss" in self.name:
+            return "bss"
+        if self.executable:
+            return "text"
+        if self.flags & SHF_WRITE:
+            return "data"
+        return "rodata"
+
+
+def read_sections(readelf, elf):
+    flag_bits = {"W": SHF_WRITE, "A": SHF_ALLOC, "X": SHF_EXECINSTR}
+    sections = []
+    row = re.compile(r"^\s*\[\s*(\d+)\]\s+(\S+)\s+(\S+)\s+([0-9a-f]+)\s+([0-9a-f]+)\s+"
+                     r"([0-9a-f]+)\s+[0-9a-f]+\s+([A-Za-z]*)\s+\d+\s+\d+\s+\d+$")
+    for line in run_tool([readelf, "-S", "-W", elf]).splitlines():
+        m = row.match(line)
+        if not m:
+            continue
+        flags = 0
+        for c in m.group(7):
+            flags |= flag_bits.get(c, 0)
+        sections.append(Section(int(m.group(1)), m.group(2), m.group(3), int(m.group(4), 16),
+                                int(m.group(5), 16), int(m.group(6), 16), flags))
+    if not sections:
+        raise ToolError("no section headers in %s" % elf)
+    return sections
+
+
+def read_symbols(readelf, elf):
+    """Sized FUNC / OBJECT / NOTYPE symbols: (addr, size, type, section index, name)"""
+    symbols = []
+    for line in run_tool([readelf, "-s", "-W", elf]).splitlines():
+        p = line.split()
+        if len(p) < 8 or not p[0].endswith(":") or not p[6].isdigit():
+            continue
+        size = int(p[2], 16) if p[2].startswith("0x") else int(p[2])
+        if size == 0 or p[3] not in ("FUNC", "OBJECT", "NOTYPE"):
+            continue
+        symbols.append((int(p[1], 16), size, p[3], int(p[6]), p[7]))
+    return symbols
+
+
+def read_symbol_files(nm, elf, roots):
+    """Source file of each symbol with debug info: {(addr, name): path}"""
+    files = {}
+    # --size-sort skips the unsized labels, looking those up is slow
+    for line in run_tool([nm, "-l", "-S", "--size-sort", "--defined-only", elf]).splitlines():
+        if "\t" not in line:
+            continue
+        sym, loc = line.split("\t", 1)
+        p = sym.split()
+        if len(p) < 4:
+            continue
+        loc = re.sub(r":\d+$", "", loc.strip())
+        files[(int(p[0], 16), p[3])] = normalize_path(loc, roots)
+    return files
+
+
+# ========== DWARF line tables ==========
+
+def read_comp_dirs(readelf, elf):
+    """DW_AT_stmt_list offset -> compilation directory, from the CU DIEs only"""
+    comp_dirs = {}
+    stmt = None
+    comp_dir = None
+    text = run_tool([readelf, "--debug-dump=info", "--dwarf-depth=1", elf])
+    for line in text.splitlines():
+        if "Compilation Unit @" in line:
+            if stmt is not None:
+                comp_dirs[stmt] = comp_dir
+            stmt, comp_dir = None, None
+        elif "DW_AT_stmt_list" in line:
+            stmt = int(line.rsplit(":", 1)[1].strip(), 0)
+        elif "DW_AT_comp_dir" in line:
+            comp_dir = line.split("):", 1)[1].strip() if "):" in line else line.rsplit(": ", 1)[1].strip()
+    if stmt is not None:
+        comp_dirs[stmt] = comp_dir
+    return comp_dirs
+
+
+def _uleb(buf, pos):
+    result = shift = 0
+    while True:
+        b = buf[pos]
+        pos += 1
+        result |= (b & 0x7F) << shift
+        shift += 7
+        if b < 0x80:
+            return result, pos
+
+
+def _sleb(buf, pos):
+    result = shift = 0
+    while True:
+        b = buf[pos]
+        pos += 1
+        result |= (b & 0x7F) << shift
+        shift += 7
+        if b < 0x80:
+            if b & 0x40:
+                result -= 1 << shift
+            return result, pos
+
+
+def _cstr(buf, pos):
+    end = buf.index(b"\0", pos)
+    return buf[pos:end].decode("utf-8", "replace"), end + 1
+
+
+def line_sequences(data, comp_dirs):
+    """
+    Decode every DWARF 2-4 line program in .debug_line.
+    Yields one list of (address, path) rows per sequence, closed by an
+    (end address, None) row.
+    """
+    pos = 0
+    while pos + 4 <= len(data):
+        unit = pos
+        unit_length = struct.unpack_from("<I", data, pos)[0]
+        if unit_length >= 0xFFFFFFF0:
+            raise ToolError("64-bit DWARF line tables are not supported")
+        end = pos + 4 + unit_length
+        version = struct.unpack_from("<H", data, pos + 4)[0]
+        if version > 4:
+            raise ToolError("DWARF %d line tables are not supported" % version)
+        header_length = struct.unpack_from("<I", data, pos + 6)[0]
+        program = pos + 10 + header_length
+        p = pos + 10
+        min_inst = data[p]
+        p += 2 if version >= 4 else 1   # max_ops_per_instruction (VLIW only)
+        p += 2                          # default_is_stmt, line_base
+        line_range = data[p]
+        opcode_base = data[p + 1]
+        lengths = data[p + 2:p + 1 + opcode_base]
+        p += 1 + opcode_base
+
+        comp_dir = comp_dirs.get(unit) or ""
+        dirs = [comp_dir]
+        while data[p]:
+            d, p = _cstr(data, p)
+            dirs.append(join_path(comp_dir, d))
+        p += 1
+        files = []
+        while data[p]:
+            name, p = _cstr(data, p)
+            d, p = _uleb(data, p)
+            _, p = _uleb(data, p)
+            _, p = _uleb(data, p)
+            files.append(join_path(dirs[d] if d < len(dirs) else comp_dir, name))
+
+        p = program
+        addr, fidx, rows = 0, 1, []
+        while p < end:
+            op = data[p]
+            p += 1
+            row = False
+            if op >= opcode_base:
+                addr += ((op - opcode_base) // line_range) * min_inst
+                row = True
+            elif op == 0:
+                n, p = _uleb(data, p)
+                sub = data[p]
+                if sub == 1:            # DW_LNE_end_sequence
+                    rows.append((addr, None))
+                    yield rows
+                    addr, fidx, rows = 0, 1, []
+                elif sub == 2:          # DW_LNE_set_address
+                    addr = int.from_bytes(data[p + 1:p + n], "little")
+                elif sub == 3:          # DW_LNE_define_file
+                    name, q = _cstr(data, p + 1)
+                    d, q = _uleb(data, q)
+                    files.append(join_path(dirs[d] if d < len(dirs) else comp_dir, name))
+                p += n
+            elif op == 1:               # DW_LNS_copy
+                row = True
+            elif op == 2:               # DW_LNS_advance_pc
+                n, p = _uleb(data, p)
+                addr += n * min_inst
+            elif op == 3:               # DW_LNS_advance_line
+                _, p = _sleb(data, p)
+            elif op == 4:               # DW_LNS_set_file
+                fidx, p = _uleb(data, p)
+            elif op == 8:               # DW_LNS_const_add_pc
+                addr += ((255 - opcode_base) // line_range) * min_inst
+            elif op == 9:               # DW_LNS_fixed_advance_pc
+                addr += struct.unpack_from("<H", data, p)[0]
+                p += 2
+            else:                       # Other standard opcodes: skip their operands
+                for _ in range(lengths[op - 1]):
+                    _, p = _uleb(data, p)
+            if row:
+                rows.append((addr, files[fidx - 1] if 0 < fidx <= len(files) else ""))
+        pos = end
+
+
+# ========== Attribution ==========
+
+class Report(object):
+    def __init__(self):
+        self.modules = {}
+        self.sections = []
+        self.regions = []
+
+    def add(self, module, category, size):
+        if size <= 0:
+            return
+        sizes = self.modules.setdefault(module, dict.fromkeys(CATEGORIES, 0))
+        sizes[category] += size
+
+
+def analyze(elf, map_file, roots, readelf, nm):
+    report = Report()
+    sections = read_sections(readelf, elf)
+    report.sections = sections
+    by_index = dict((s.index, s) for s in sections)
+    alloc = [s for s in sections if s.alloc and s.size]
+
+    # Owner of every allocated byte: 0 = free, else module id * 8 + category
+    names = [None]
+    name_ids = {}
+    owners = dict((s.index, array.array("I", bytes(4 * s.size))) for s in alloc)
+
+    def claim(sec, start, end, module, category):
+        lo = max(start, sec.addr) - sec.addr
+        hi = min(end, sec.addr + sec.size) - sec.addr
+        if hi <= lo:
+            return
+        mid = name_ids.get(module)
+        if mid is None:
+            mid = name_ids[module] = len(names)
+            names.append(module)
+        tag = mid * 8 + CATEGORIES.index(category) + 1
+        own = owners[sec.index]
+        if own[lo:hi].count(0) == hi - lo:
+            own[lo:hi] = array.array("I", [tag]) * (hi - lo)
+            return
+        for i in range(lo, hi):
+            if not own[i]:
+                own[i] = tag
+
+    symbols = read_symbols(readelf, elf)
+    sym_files = read_symbol_files(nm, elf, roots)
+    func_files = {}
+    for addr, size, stype, idx, name in symbols:
+        f = sym_files.get((addr, name))
+        if f and stype == "FUNC":
+            func_files[name] = f
+
+    def symbol_file(addr, name):
+        f = sym_files.get((addr, name))
+        if f:
+            return f
+        # Function-local statics are named "<function>.<var>"
+        return func_files.get(name.split(".", 1)[0], NO_DEBUG_INFO)
+
+    # 1. Objects: rodata in code sections, otherwise by section
+    for addr, size, stype, idx, name in symbols:
+        sec = by_index.get(idx)
+        if stype != "OBJECT" or sec is None or sec.index not in owners:
+            continue
+        category = "rodata" if sec.executable else sec.category()
+        claim(sec, addr, addr + size, symbol_file(addr, name), category)
+
+    # 2. Code: line table rows, each clipped to the function it starts in.
+    #    After LTO one sequence can hop between functions placed far apart.
+    funcs = sorted((addr, addr + size, by_index[idx]) for addr, size, stype, idx, name in symbols
+                   if stype == "FUNC" and idx in owners and by_index[idx].executable)
+    starts = [f[0] for f in funcs]
+    line_sec = next((s for s in sections if s.name == ".debug_line"), None)
+    if line_sec is not None and funcs:
+        with open(elf, "rb") as fp:
+            fp.seek(line_sec.offset)
+            data = fp.read(line_sec.size)
+        cache = {}
+        for rows in line_sequences(data, read_comp_dirs(readelf, elf)):
+            for (start, path), (nxt, _) in zip(rows, rows[1:]):
+                i = bisect.bisect_right(starts, start) - 1
+                if i < 0 or start >= funcs[i][1]:
+                    continue
+                end = funcs[i][1] if nxt <= start else min(nxt, funcs[i][1])
+                module = cache.get(path)
+                if module is None:
+                    module = cache[path] = normalize_path(path, roots) if path else NO_DEBUG_INFO
+                claim(funcs[i][2], start, end, module, "text")
+
+    # 3. Remaining sized symbols (code without line info, untyped labels)
+    for addr, size, stype, idx, name in symbols:
+        sec = by_index.get(idx)
+        if sec is None or sec.index not in owners:
+            continue
+        claim(sec, addr, addr + size, symbol_file(addr, name), sec.category())
+
+    # 4. Merged string literals and constants have no symbols, only the map
+    #    knows where they are
+    if map_file:
+        report.regions, inputs = read_map(map_file, sections)
+        for addr, size, name in inputs:
+            if not name.startswith(".rodata"):
+                continue
+            for sec in alloc:
+                if sec.addr <= addr < sec.addr + sec.size:
+                    claim(sec, addr, addr + size, STRINGS if ".str" in name else CONSTANTS, "rodata")
+                    break
+
+    # 5. Sum up, leftovers are padding / fill
+    for s in alloc:
+        for tag, n in collections.Counter(owners[s.index]).items():
+            if tag:
+                report.add(names[tag >> 3], CATEGORIES[(tag & 7) - 1], n)
+            else:
+                report.add(UNATTRIBUTED, s.category(), n)
+
+    return report
+
+
+# ========== Map file ==========
+
+def read_map(map_file, sections):
+    """
+    Memory regions (Memory Configuration, with the bytes used in each) and
+    output-side input sections [(addr, size, name)] of the linker map
+    """
+    regions = []
+    inputs = []
+    part = None
+    pending = None
+    row = re.compile(r"^\s+0x([0-9a-f]+)\s+0x([0-9a-f]+)\s+\S")
+    with open(map_file, "r", errors="replace") as fp:
+        for line in fp:
+            if line.startswith("Memory Configuration"):
+                part = "config"
+                continue
+            if line.startswith("Linker script and memory map"):
+                part = "map"
+                continue
+            p = line.split()
+            if part == "config":
+                if len(p) >= 3 and p[1].startswith("0x") and p[0] != "*default*":
+                    regions.append({"name": p[0], "origin": int(p[1], 16), "length": int(p[2], 16), "used": 0})
+            elif part == "map":
+                # " .name 0xaddr 0xsize file", long names wrap onto the next line
+                if line.startswith(" .") and len(p) == 1:
+                    pending = p[0]
+                    continue
+                if line.startswith(" .") and len(p) >= 4 and p[1].startswith("0x"):
+                    inputs.append((int(p[1], 16), int(p[2], 16), p[0]))
+                elif pending:
+                    m = row.match(line)
+                    if m:
+                        inputs.append((int(m.group(1), 16), int(m.group(2), 16), pending))
+                pending = None
+    for s in sections:
+        if not s.alloc or not s.size:
+            continue
+        for r in regions:
+            if r["origin"] <= s.addr < r["origin"] + r["length"]:
+                r["used"] += s.size
+                break
+    return regions, inputs
+
+
+# ========== Budget ==========
+
+def load_json(path):
+    with open(path, "r") as fp:
+        return json.load(fp)
+
+
+def image_size(report, patterns):
+    return sum(s.size for s in report.sections
+               if s.alloc and s.type != "NOBITS" and any(fnmatch.fnmatchcase(s.name, p) for p in patterns))
+
+
+def module_total(sizes):
+    return sum(sizes[c] for c in CATEGORIES)
+
+
+def usage(report, pattern):
+    """Sizes summed over every module matching the pattern"""
+    used = dict.fromkeys(CATEGORIES, 0)
+    for module, sizes in report.modules.items():
+        if fnmatch.fnmatchcase(module, pattern):
+            for c in CATEGORIES:
+                used[c] += sizes[c]
+    used["total"] = module_total(used)
+    return used
+
+
+def check_budget(report, budget):
+    """List of (what, used, limit) for every budget limit"""
+    checks = []
+    image = budget.get("image")
+    if image:
+        checks.append(("image", image_size(report, image["sections"]), image["limit"]))
+    for name, limit in sorted(budget.get("regions", {}).items()):
+        used = next((r["used"] for r in report.regions if r["name"] == name), None)
+        if used is not None:
+            checks.append(("region " + name, used, limit))
+    for pattern, limits in sorted(budget.get("modules", {}).items()):
+        used = usage(report, pattern)
+        for key in CATEGORIES + ("total",):
+            if key in limits:
+                checks.append(("%s %s" % (pattern, key), used[key], limits[key]))
+    return checks
+
+
+def round_up(n, step):
+    return (n + step - 1) // step * step
+
+
+def update_budget(report, budget, headroom_pct, step):
+    """Reset every existing limit to the current size plus headroom"""
+    def grow(n):
+        return round_up(n + n * headroom_pct // 100, step)
+
+    if "image" in budget:
+        budget["image"]["limit"] = max(budget["image"]["limit"],
+                                       grow(image_size(report, budget["image"]["sections"])))
+    for name in budget.get("regions", {}):
+        used = next((r["used"] for r in report.regions if r["name"] == name), None)
+        if used is not None:
+            budget["regions"][name] = grow(used)
+    for pattern, limits in budget.get("modules", {}).items():
+        used = usage(report, pattern)
+        for key in list(limits):
+            if key in used:
+                limits[key] = grow(used[key])
+
+
+# ========== Output ==========
+
+def to_json(report, budget, checks, elf):
+    out = {
+        "elf": os.path.basename(elf),
+        "sections": dict((s.name, {"addr": s.addr, "size": s.size, "type": s.type})
+                         for s in report.sections if s.alloc and s.size),
+        "regions": dict((r["name"], {"length": r["length"], "used": r["used"]}) for r in report.regions),
+        "totals": usage(report, "*"),
+        "modules": dict((m, dict(s, total=module_total(s))) for m, s in report.modules.items()),
+    }
+    if budget is not None:
+        if "image" in budget:
+            out["image"] = {"size": image_size(report, budget["image"]["sections"]),
+                            "limit": budget["image"]["limit"]}
+        out["budget"] = [{"what": w, "used": u, "limit": l, "ok": u <= l} for w, u, l in checks]
+    return out
+
+
+def print_report(report, checks, top):
+    print("Sections:")
+    for s in report.sections:
+        if s.alloc and s.size:
+            print("  %-16s 0x%08x %8d" % (s.name, s.addr, s.size))
+    for r in report.regions:
+        print("Region %-8s %8d / %8d bytes (%d%%)" % (r["name"], r["used"], r["length"],
+                                                    100 * r["used"] // max(r["length"], 1)))
+
+    rows = sorted(report.modules.items(), key=lambda kv: (-module_total(kv[1]), kv[0]))
+    print("\n%8s %8s %8s %8s %8s  %s" % ("text", "rodata", "data", "bss", "total", "module"))
+    for module, s in rows[:top]:
+        print("%8d %8d %8d %8d %8d  %s" % (s["text"], s["rodata"], s["data"], s["bss"], module_total(s), module))
+    if len(rows) > top:
+        print("%8s %8s %8s %8s %8s  ... %d more" % ("", "", "", "", "", len(rows) - top))
+    t = usage(report, "*")
+    print("%8d %8d %8d %8d %8d  (all)" % (t["text"], t["rodata"], t["data"], t["bss"], t["total"]))
+
+    if checks:
+        width = max(len(c[0]) for c in checks)
+        print("\nBudget:")
+        for what, used, limit in checks:
+            print("  %-4s %-*s %8d / %8d" % ("OK" if used <= limit else "OVER", width, what, used, limit))
+
+
+def print_diff(report, baseline):
+    old = baseline.get("modules", {})
+    new = dict((m, dict(s, total=module_total(s))) for m, s in report.modules.items())
+    changed = []
+    for module in sorted(set(old) | set(new)):
+        a = old.get(module, {})
+        b = new.get(module, {})
+        delta = sum(b.get(c, 0) - a.get(c, 0) for c in CATEGORIES)
+        if any(a.get(c, 0) != b.get(c, 0) for c in CATEGORIES):
+            changed.append((delta, module, a, b))
+    print("\nChanges against baseline (%d modules):" % len(changed))
+    for delta, module, a, b in sorted(changed, key=lambda x: (-abs(x[0]), x[1])):
+        parts = ["%s %+d" % (c, b.get(c, 0) - a.get(c, 0)) for c in CATEGORIES if a.get(c, 0) != b.get(c, 0)]
+        print("  %+7d  %-60s %s" % (delta, module, ", ".join(parts)))
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(description="Per-module firmware size report and budget check")
+    parser.add_argument("--elf", required=True, help="linked image (sdk.elf)")
+    parser.add_argument("--map", help="linker map (sdk.map), adds memory region usage")
+    parser.add_argument("--budget", help="budget file (size_budget.json)")
+    parser.add_argument("--json", help="write the report as JSON")
+    parser.add_argument("--baseline", help="previous JSON report to diff against")
+    parser.add_argument("--update-budget", action="store_true",
+                        help="rewrite the budget limits from this image plus headroom")
+    parser.add_argument("--headroom", type=int, default=10, help="headroom for --update-budget, percent")
+    parser.add_argument("--top", type=int, default=40, help="modules listed on stdout")
+    parser.add_argument("--quiet", action="store_true", help="only print budget violations")
+    args = parser.parse_args(argv)
+
+    readelf = os.environ.get("READELF", "readelf")
+    nm = os.environ.get("NM", "nm")
+
+    try:
+        budget = load_json(args.budget) if args.budget else None
+        roots = (budget or {}).get("roots", DEFAULT_ROOTS)
+        report = analyze(args.elf, args.map, roots, readelf, nm)
+    except (ToolError, OSError, ValueError) as e:
+        print("size_report: %s" % e, file=sys.stderr)
+        return 2
+
+    if args.update_budget:
+        if budget is None:
+            print("size_report: --update-budget needs --budget", file=sys.stderr)
+            return 2
+        update_budget(report, budget, args.headroom, budget.get("round", 64))
+        with open(args.budget, "w") as fp:
+            json.dump(budget, fp, indent=2, sort_keys=True)
+            fp.write("\n")
+
+    checks = check_budget(report, budget) if budget is not None else []
+
+    if args.json:
+        with open(args.json, "w") as fp:
+            json.dump(to_json(report, budget, checks, args.elf), fp, indent=2, sort_keys=True)
+            fp.write("\n")
+
+    if not args.quiet:
+        print_report(report, checks, args.top)
+        if args.baseline:
+            print_diff(report, load_json(args.baseline))
+
+    over = [c for c in checks if c[1] > c[2]]
+    for what, used, limit in over:
+        print("size_report: %s is %d bytes, budget %d (+%d)" % (what, used, limit, used - limit),
+              file=sys.stderr)
+    return 1 if over else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,255 @@
+#!/usr/bin/env python3
+"""
+Latency report for tracepoint dumps (vibration_motor_ble/vm_trace.h)
+
+Reads a dump, pairs tracepoints into spans and prints a latency histogram
+per span. Optionally writes the records and spans as a Chrome trace-event
+file for chrome://tracing or https://ui.perfetto.dev.
+
+Inputs:
+- UART (default): debug UART text containing the lines printed by the
+  0xB0 0x05 0x01 query ("[VM_TRACE] <timestamp> <word 1>"); other text is
+  ignored.
+- BLE (--ble): hex dumps of the 0xB0 0x05 query notifications, one per line.
+
+Several dumps may be concatenated; each one is oldest record first.
+
+Spans: a start event is paired with the first end event after it, unless
+another start comes first (e.g. a motor write with an unchanged duty does
+not touch the PWM register and has no end).
+
+Usage:
+    trace_report.py [--ble] [--trace-h vm_trace.h] [--chrome out.json] [dump]
+
+Exit status: 0 ok, 2 usage or input error.
+"""
+
+import argparse
+import json
+import os
+import re
+import sys
+
+DEFAULT_TRACE_H = os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                               os.pardir, "vibration_motor_ble", "vm_trace.h")
+DEFAULT_TICKS_PER_US = 3
+RECORD_SIZE = 8
+
+EVENT_RE = re.compile(r"#define\s+VM_TRACE_EV_(\w+)\s+(0x[0-9A-Fa-f]+|\d+)")
+UART_HEADER_RE = re.compile(r"\[VM_TRACE\] dump: (\d+) records, (\d+) ticks/us")
+UART_RECORD_RE = re.compile(r"\[VM_TRACE\] ([0-9A-Fa-f]{8}) ([0-9A-Fa-f]{8})")
+
+# (span name, start event, end event)
+SPANS = [
+    ("gatt_write_to_pwm", "ATT_WRITE", "PWM_SET"),
+    ("gatt_write_to_service", "ATT_WRITE", "MOTOR_WRITE"),
+    ("service_to_pwm", "MOTOR_WRITE", "PWM_SET"),
+    ("ota_chunk_to_ack", "OTA_WRITE", "OTA_ACK"),
+    ("ota_flash_program", "FLASH_BEGIN", "FLASH_END"),
+]
+
+# Chrome trace rows
+THREADS = {
+    "ATT_WRITE": (1, "ble"),
+    "CONNECT": (1, "ble"),
+    "DISCONNECT": (1, "ble"),
+    "ENCRYPTION": (1, "ble"),
+    "CONN_UPDATE": (1, "ble"),
+    "MOTOR_WRITE": (2, "motor"),
+    "PWM_SET": (2, "motor"),
+    "OTA_WRITE": (3, "ota"),
+    "OTA_ACK": (3, "ota"),
+    "FLASH_BEGIN": (4, "flash"),
+    "FLASH_END": (4, "flash"),
+}
+SPAN_TID = 10
+
+
+def load_events(path):
+    """{id: name} from the VM_TRACE_EV_* defines"""
+    with open(path) as fp:
+        events = {int(m.group(2), 0): m.group(1) for m in EVENT_RE.finditer(fp.read())}
+    if not events:
+        raise ValueError("no VM_TRACE_EV_* defines in %s" % path)
+    return events
+
+
+class Dump:
+    """Records of one dump: [(ticks, event, arg)] plus the tick rate"""
+
+    def __init__(self, ticks_per_us):
+        self.ticks_per_us = ticks_per_us
+        self.records = []
+
+    def add(self, ts, info):
+        self.records.append((ts, info >> 24, info & 0xFFFFFF))
+
+
+def parse_uart(lines, ticks_per_us):
+    dumps = []
+    for line in lines:
+        m = UART_HEADER_RE.search(line)
+        if m:
+            dumps.append(Dump(ticks_per_us or int(m.group(2))))
+            continue
+        m = UART_RECORD_RE.search(line)
+        if m:
+            if not dumps:
+                dumps.append(Dump(ticks_per_us or DEFAULT_TICKS_PER_US))
+            dumps[-1].add(int(m.group(1), 16), int(m.group(2), 16))
+    return dumps
+
+
+def parse_ble(lines, ticks_per_us):
+    dumps = []
+    current = None
+    for n, line in enumerate(lines, 1):
+        hexstr = re.sub(r"0x|[\s,:]", "", line.strip(), flags=re.I)
+        if not hexstr:
+            continue
+        try:
+            data = bytes.fromhex(hexstr)
+        except ValueError:
+            raise ValueError("line %d: not hex" % n)
+        if len(data) < 4 or data[0] != 0xB0 or data[1] != 0x05 or (len(data) - 4) % RECORD_SIZE:
+            raise ValueError("line %d: not a trace query response" % n)
+        if current is None:
+            current = Dump(ticks_per_us or data[3] or DEFAULT_TICKS_PER_US)
+            dumps.append(current)
+        for pos in range(4, len(data), RECORD_SIZE):
+            ts = int.from_bytes(data[pos:pos + 4], "little")
+            info = int.from_bytes(data[pos + 4:pos + 8], "little")
+            current.add(ts, info)
+        if data[2] == 0:
+            current = None      # Last page of this dump
+    return dumps
+
+
+def timeline(dumps):
+    """[(t_us, event, arg, dump index)] with the 32-bit timestamps unwrapped per dump"""
+    out = []
+    offset_us = 0.0
+    for index, dump in enumerate(dumps):
+        ticks = 0
+        prev = None
+        for ts, event, arg in dump.records:
+            if prev is not None:
+                ticks += (ts - prev) & 0xFFFFFFFF
+            prev = ts
+            out.append((offset_us + ticks / dump.ticks_per_us, event, arg, index))
+        if dump.records:
+            offset_us = out[-1][0] + 1000.0     # Dumps are not related in time, keep them apart
+    return out
+
+
+def match_spans(events, names):
+    """{span name: [(start_us, duration_us, start arg)]}"""
+    by_name = {name: event for event, name in names.items()}
+    spans = {}
+    for span, start_name, end_name in SPANS:
+        start_id = by_name.get(start_name)
+        end_id = by_name.get(end_name)
+        found = []
+        pending = None
+        for t, event, arg, dump in events:
+            if event == start_id:
+                pending = (t, arg, dump)
+            elif event == end_id and pending is not None and pending[2] == dump:
+                found.append((pending[0], t - pending[0], pending[1]))
+                pending = None
+        spans[span] = found
+    return spans
+
+
+def percentile(sorted_values, p):
+    if not sorted_values:
+        return 0.0
+    k = (len(sorted_values) - 1) * p / 100.0
+    lo = int(k)
+    hi = min(lo + 1, len(sorted_values) - 1)
+    return sorted_values[lo] + (sorted_values[hi] - sorted_values[lo]) * (k - lo)
+
+
+def histogram(durations, width=40):
+    """Lines of a log2 histogram in microseconds"""
+    buckets = {}
+    for d in durations:
+        edge = 1
+        while edge < d:
+            edge *= 2
+        buckets[edge] = buckets.get(edge, 0) + 1
+    most = max(buckets.values())
+    lines = []
+    for edge in sorted(buckets):
+        count = buckets[edge]
+        bar = "#" * max(1, count * width // most)
+        lines.append("  <= %7d us %6d %s" % (edge, count, bar))
+    return lines
+
+
+def report(spans, out=sys.stdout):
+    for span, _, _ in SPANS:
+        found = spans.get(span, [])
+        print("%s: %d" % (span, len(found)), file=out)
+        if not found:
+            continue
+        durations = sorted(d for _, d, _ in found)
+        print("  min %.1f  p50 %.1f  p90 %.1f  p99 %.1f  max %.1f us" % (
+            durations[0], percentile(durations, 50), percentile(durations, 90),
+            percentile(durations, 99), durations[-1]), file=out)
+        for line in histogram(durations):
+            print(line, file=out)
+
+
+def chrome_trace(events, names, spans):
+    trace = [{"ph": "M", "pid": 1, "name": "process_name", "args": {"name": "motor firmware"}}]
+    tids = {SPAN_TID: "spans"}
+    for tid, label in THREADS.values():
+        tids[tid] = label
+    for tid, label in sorted(tids.items()):
+        trace.append({"ph": "M", "pid": 1, "tid": tid, "name": "thread_name", "args": {"name": label}})
+    for t, event, arg, dump in events:
+        name = names.get(event, "EV_%02X" % event)
+        tid = THREADS.get(name, (0, "other"))[0]
+        trace.append({"ph": "i", "s": "t", "pid": 1, "tid": tid, "ts": round(t, 3), "name": name,
+                      "args": {"arg": arg, "dump": dump}})
+    for span, found in sorted(spans.items()):
+        for start, duration, arg in found:
+            trace.append({"ph": "X", "pid": 1, "tid": SPAN_TID, "ts": round(start, 3),
+                          "dur": round(duration, 3), "name": span, "args": {"arg": arg}})
+    return {"traceEvents": trace, "displayTimeUnit": "ms"}
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(description="Latency histograms and Chrome trace from tracepoint dumps")
+    parser.add_argument("dump", nargs="?", help="UART log or BLE dump (default stdin)")
+    parser.add_argument("--ble", action="store_true", help="input is hex dumps of trace query notifications")
+    parser.add_argument("--trace-h", default=DEFAULT_TRACE_H, help="event definitions (vm_trace.h)")
+    parser.add_argument("--ticks-per-us", type=int, help="override the timestamp rate of the dump")
+    parser.add_argument("--chrome", help="write a Chrome trace-event JSON file")
+    args = parser.parse_args(argv)
+
+    try:
+        names = load_events(args.trace_h)
+        fp = open(args.dump, errors="replace") if args.dump else sys.stdin
+        with fp:
+            lines = fp.readlines()
+        dumps = (parse_ble if args.ble else parse_uart)(lines, args.ticks_per_us)
+    except (OSError, ValueError) as e:
+        print("trace_report: %s" % e, file=sys.stderr)
+        return 2
+
+    events = timeline(dumps)
+    spans = match_spans(events, names)
+    print("%d records in %d dump(s)" % (len(events), len(dumps)))
+    report(spans)
+
+    if args.chrome:
+        with open(args.chrome, "w") as fp:
+            json.dump(chrome_trace(events, names, spans), fp)
+            fp.write("\n")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
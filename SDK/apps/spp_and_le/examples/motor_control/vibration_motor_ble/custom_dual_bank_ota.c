@@ -3,12 +3,26 @@
  */
 
 #include "custom_dual_bank_ota.h"
+#include "custom_journal.h"
 #include "system/includes.h"
 #include "asm/crc16.h"
+#include "vm_config.h"
+#include "vm_mem_pool.h"
+#include "vm_trace.h"
 
-/* Logging macros */
-#define log_info(fmt, ...)   printf("[CUSTOM_OTA] " fmt, ##__VA_ARGS__)
-#define log_error(fmt, ...)  printf("[CUSTOM_OTA_ERROR] " fmt, ##__VA_ARGS__)
+#if VM_POOL_OTA_BLOCK_SIZE < CUSTOM_FLASH_PAGE
+#error "VM_POOL_OTA_BLOCK_SIZE must hold one flash page"
+#endif
+
+#if (CUSTOM_JNL_SECTOR_0 < CUSTOM_BANK_A_ADDR + CUSTOM_BANK_SIZE) || \
+    (CUSTOM_JNL_SECTOR_1 < CUSTOM_BANK_B_ADDR + CUSTOM_BANK_SIZE)
+#error "Journal sectors overlap the banks"
+#endif
+
+/* Logging */
+#define VM_LOG_TAG      "CUSTOM_OTA"
+#define VM_LOG_LEVEL    VM_LOG_LEVEL_OTA
+#include "vm_log.h"
 
 /* Global boot info and OTA context */
 static custom_boot_info_t g_boot_info;
@@ -23,6 +37,18 @@ static u8 g_initialized = 0;
 #define ERR_BOOT_INFO_FAILED    0x05
 #define ERR_NOT_INITIALIZED     0x06
 #define ERR_INVALID_STATE       0x07
+#define ERR_NO_MEMORY           0x08
+
+/**
+ * Return the page slot to the OTA pool
+ */
+static void ota_release_slot(void)
+{
+    if (g_ota_ctx.rx_slot) {
+        vm_mem_free(VM_POOL_OTA, g_ota_ctx.rx_slot);
+        g_ota_ctx.rx_slot = NULL;
+    }
+}
 
 /**
  * Calculate CRC16 of boot info structure
@@ -35,67 +61,76 @@ static u16 calculate_boot_info_crc(const custom_boot_info_t *info)
 }
 
 /**
- * Read boot info from flash with fallback to backup
+ * CRC16 of size bytes of flash, read one page at a time into buf
+ * @return 0 on success, -1 on read error
  */
-static int read_boot_info(void)
+static int ota_bank_crc(u32 addr, u32 size, u8 *buf, u16 *crc)
 {
-    int ret;
-    u16 calc_crc;
-    
-    /* Try reading from primary location first */
-    ret = norflash_read(CUSTOM_BOOT_INFO_ADDR, (u8*)&g_boot_info, sizeof(g_boot_info));
-    if (ret == 0) {
-        /* Verify magic number */
-        if (g_boot_info.magic == CUSTOM_BOOT_MAGIC) {
-            /* Verify CRC */
-            calc_crc = calculate_boot_info_crc(&g_boot_info);
-            if (calc_crc == g_boot_info.boot_info_crc) {
-                log_info("Custom OTA: Boot info loaded from primary location\n");
-                goto boot_info_valid;
-            } else {
-                log_error("Custom OTA: Primary boot info CRC mismatch (expected 0x%04x, got 0x%04x)\n",
-                         g_boot_info.boot_info_crc, calc_crc);
-            }
-        } else {
-            log_info("Custom OTA: Primary boot info has invalid magic\n");
+    u32 done = 0;
+
+    *crc = 0;  /* Initial CRC value */
+    while (done < size) {
+        u32 remaining = size - done;
+        u16 chunk_size = (remaining > CUSTOM_FLASH_PAGE) ? CUSTOM_FLASH_PAGE : remaining;
+
+        if (norflash_read(addr + done, buf, chunk_size) != 0) {
+            log_error("Custom OTA: Failed to read firmware at offset %d\n", done);
+            return -1;
+        }
+        *crc = CRC16_with_initval(buf, chunk_size, *crc);
+        done += chunk_size;
+
+        /* Log progress every 64KB */
+        if (done % (64 * 1024) == 0) {
+            log_info("Custom OTA: Verified %d/%d bytes (%d%%)\n", done, size, (done * 100) / size);
         }
-    } else {
-        log_error("Custom OTA: Failed to read primary boot info\n");
     }
-    
-    /* Primary failed, try backup */
-    log_info("Custom OTA: Trying backup boot info at 0x%08x\n", CUSTOM_BOOT_INFO_BACKUP);
-    ret = norflash_read(CUSTOM_BOOT_INFO_BACKUP, (u8*)&g_boot_info, sizeof(g_boot_info));
-    if (ret != 0) {
-        log_error("Custom OTA: Failed to read backup boot info\n");
-        return -1;
+    return 0;
+}
+
+/**
+ * Check magic and CRC of a boot info copy
+ */
+static u8 boot_info_ok(const custom_boot_info_t *info)
+{
+    return info->magic == CUSTOM_BOOT_MAGIC &&
+           info->boot_info_crc == calculate_boot_info_crc(info);
+}
+
+/**
+ * Read boot info written by older firmware (fixed primary/backup slots)
+ */
+static int read_legacy_boot_info(void)
+{
+    if (norflash_read(CUSTOM_BOOT_INFO_ADDR, (u8*)&g_boot_info, sizeof(g_boot_info)) == 0 &&
+        boot_info_ok(&g_boot_info)) {
+        return 0;
     }
-    
-    /* Verify magic number */
-    if (g_boot_info.magic != CUSTOM_BOOT_MAGIC) {
-        log_info("Custom OTA: Backup boot info has invalid magic, initializing\n");
-        return -1;
+    if (norflash_read(CUSTOM_BOOT_INFO_BACKUP, (u8*)&g_boot_info, sizeof(g_boot_info)) == 0 &&
+        boot_info_ok(&g_boot_info)) {
+        return 0;
     }
-    
-    /* Verify CRC */
-    calc_crc = calculate_boot_info_crc(&g_boot_info);
-    if (calc_crc != g_boot_info.boot_info_crc) {
-        log_error("Custom OTA: Backup boot info CRC mismatch (expected 0x%04x, got 0x%04x)\n",
-                 g_boot_info.boot_info_crc, calc_crc);
+    return -1;
+}
+
+/**
+ * Read boot info: latest journal record, else the legacy location
+ */
+static int read_boot_info(void)
+{
+    custom_jnl_init();
+
+    if (custom_jnl_read(CUSTOM_JNL_TYPE_BOOT_INFO, &g_boot_info, sizeof(g_boot_info)) == sizeof(g_boot_info) &&
+        boot_info_ok(&g_boot_info)) {
+        log_info("Custom OTA: Boot info loaded from journal\n");
+    } else if (read_legacy_boot_info() == 0) {
+        /* Moves into the journal with the next write */
+        log_info("Custom OTA: Boot info loaded from legacy location\n");
+    } else {
+        log_info("Custom OTA: No valid boot info\n");
         return -1;
     }
-    
-    log_info("Custom OTA: Boot info loaded from backup location\n");
-    log_info("Custom OTA: Restoring primary boot info from backup\n");
-    
-    /* Restore primary from backup */
-    ret = norflash_erase(FLASH_SECTOR_ERASER, CUSTOM_BOOT_INFO_ADDR);
-    if (ret == 0) {
-        norflash_write(CUSTOM_BOOT_INFO_ADDR, (u8*)&g_boot_info, sizeof(g_boot_info));
-    }
-    
-boot_info_valid:
-    log_info("Custom OTA: Boot info loaded successfully\n");
+
     log_info("  Active bank: %d\n", g_boot_info.active_bank);
     log_info("  Bank A: addr=0x%08x, size=%d, valid=%d, version=%d\n",
              g_boot_info.bank_a.addr, g_boot_info.bank_a.size,
@@ -108,67 +143,22 @@ boot_info_valid:
 }
 
 /**
- * Write boot info to flash with power-loss protection
- * Uses double-buffering: write to backup first, then primary
+ * Append boot info to the journal
+ * The previous record stays valid until the new one is complete, so a
+ * power cut leaves either the old or the new boot info
  */
 static int write_boot_info(void)
 {
-    int ret;
-    u8 verify_buf[sizeof(custom_boot_info_t)];
-    
-    /* Calculate CRC */
     g_boot_info.boot_info_crc = calculate_boot_info_crc(&g_boot_info);
     
-    log_info("Custom OTA: Writing boot info with power-loss protection (CRC=0x%04x)\n", 
-             g_boot_info.boot_info_crc);
-    
-    /* Step 1: Write to backup location first */
-    log_info("Custom OTA: Writing to backup location (0x%08x)\n", CUSTOM_BOOT_INFO_BACKUP);
-    ret = norflash_erase(FLASH_SECTOR_ERASER, CUSTOM_BOOT_INFO_BACKUP);
-    if (ret != 0) {
-        log_error("Custom OTA: Failed to erase backup boot info sector\n");
-        return ERR_BOOT_INFO_FAILED;
-    }
-    
-    ret = norflash_write(CUSTOM_BOOT_INFO_BACKUP, (u8*)&g_boot_info, sizeof(g_boot_info));
-    if (ret != 0) {
-        log_error("Custom OTA: Failed to write backup boot info\n");
-        return ERR_BOOT_INFO_FAILED;
-    }
-    
-    /* Step 2: Verify backup write */
-    ret = norflash_read(CUSTOM_BOOT_INFO_BACKUP, verify_buf, sizeof(g_boot_info));
-    if (ret != 0 || memcmp(verify_buf, &g_boot_info, sizeof(g_boot_info)) != 0) {
-        log_error("Custom OTA: Backup boot info verification failed\n");
+    if (custom_jnl_append(CUSTOM_JNL_TYPE_BOOT_INFO, &g_boot_info, sizeof(g_boot_info)) != 0 &&
+        /* A failed record spoils the rest of its sector, the retry moves on */
+        custom_jnl_append(CUSTOM_JNL_TYPE_BOOT_INFO, &g_boot_info, sizeof(g_boot_info)) != 0) {
+        log_error("Custom OTA: Failed to write boot info\n");
         return ERR_BOOT_INFO_FAILED;
     }
-    log_info("Custom OTA: Backup boot info verified\n");
     
-    /* Step 3: Write to primary location */
-    log_info("Custom OTA: Writing to primary location (0x%08x)\n", CUSTOM_BOOT_INFO_ADDR);
-    ret = norflash_erase(FLASH_SECTOR_ERASER, CUSTOM_BOOT_INFO_ADDR);
-    if (ret != 0) {
-        log_error("Custom OTA: Failed to erase primary boot info sector\n");
-        /* Backup still valid, not critical */
-        return ERR_BOOT_INFO_FAILED;
-    }
-    
-    ret = norflash_write(CUSTOM_BOOT_INFO_ADDR, (u8*)&g_boot_info, sizeof(g_boot_info));
-    if (ret != 0) {
-        log_error("Custom OTA: Failed to write primary boot info\n");
-        log_info("Custom OTA: Backup boot info still valid at 0x%08x\n", CUSTOM_BOOT_INFO_BACKUP);
-        return ERR_BOOT_INFO_FAILED;
-    }
-    
-    /* Step 4: Verify primary write */
-    ret = norflash_read(CUSTOM_BOOT_INFO_ADDR, verify_buf, sizeof(g_boot_info));
-    if (ret != 0 || memcmp(verify_buf, &g_boot_info, sizeof(g_boot_info)) != 0) {
-        log_error("Custom OTA: Primary boot info verification failed\n");
-        log_info("Custom OTA: Backup boot info still valid at 0x%08x\n", CUSTOM_BOOT_INFO_BACKUP);
-        return ERR_BOOT_INFO_FAILED;
-    }
-    
-    log_info("Custom OTA: Boot info written and verified successfully\n");
+    log_info("Custom OTA: Boot info written (CRC=0x%04x)\n", g_boot_info.boot_info_crc);
     return 0;
 }
 
@@ -203,11 +193,150 @@ static void init_default_boot_info(void)
     g_boot_info.active_bank = 0;  /* Bank A */
     g_boot_info.boot_count = 0;
     g_boot_info.max_boot_tries = MAX_BOOT_TRIES;
+    g_boot_info.flags = CUSTOM_BOOT_FLAG_CONFIRMED;  /* Factory image */
     
     /* Write to flash */
     write_boot_info();
 }
 
+/* ========== Boot state machine ========== */
+
+static custom_bank_info_t *boot_bank(custom_boot_info_t *info, u8 bank)
+{
+    return bank ? &info->bank_b : &info->bank_a;
+}
+
+static u16 boot_checked_flag(u8 bank)
+{
+    return bank ? CUSTOM_BOOT_FLAG_B_CHECKED : CUSTOM_BOOT_FLAG_A_CHECKED;
+}
+
+u8 custom_boot_select(custom_boot_info_t *info, custom_bank_check_t check)
+{
+    u8 active = (info->active_bank > 1) ? 0 : info->active_bank;
+    u8 other = !active;
+    u8 tries = info->max_boot_tries ? info->max_boot_tries : MAX_BOOT_TRIES;
+    u8 failed;
+    u8 fallback;
+
+    info->active_bank = active;
+
+    /* Unchecked is no verdict: the active bank keeps running and a trial keeps counting */
+    if (info->flags & CUSTOM_BOOT_FLAG_CONFIRMED) {
+        failed = check(info, active) == CUSTOM_BANK_BAD;
+    } else {
+        failed = info->boot_count >= tries || check(info, active) == CUSTOM_BANK_BAD;
+    }
+
+    if (failed) {
+        fallback = check(info, other);
+        if (fallback == CUSTOM_BANK_UNCHECKED) {
+            /* Do not switch to an image nobody verified, and do not confirm this one */
+            return CUSTOM_BOOT_UNCHECKED;
+        }
+        if (fallback != CUSTOM_BANK_OK) {
+            /* Nothing to fall back to: keep running what we have, stop counting */
+            info->boot_count = 0;
+            info->flags |= CUSTOM_BOOT_FLAG_CONFIRMED;
+            return CUSTOM_BOOT_NO_IMAGE;
+        }
+
+        /* The other bank is the last image that was running, treat it as good */
+        boot_bank(info, active)->valid = 0;
+        info->flags &= ~boot_checked_flag(active);
+        info->active_bank = other;
+        info->boot_count = 0;
+        info->flags |= CUSTOM_BOOT_FLAG_CONFIRMED;
+        return CUSTOM_BOOT_ROLLBACK;
+    }
+
+    if (!(info->flags & CUSTOM_BOOT_FLAG_CONFIRMED) && info->boot_count < 0xFF) {
+        info->boot_count++;
+    }
+    return CUSTOM_BOOT_CONTINUE;
+}
+
+/**
+ * Bank check for the boot state machine: the full CRC is only computed
+ * once per image, the result is cached in the CHECKED flag
+ */
+static u8 boot_check_bank(custom_boot_info_t *info, u8 bank)
+{
+    custom_bank_info_t *b = boot_bank(info, bank);
+    u16 flag = boot_checked_flag(bank);
+    u8 *buf;
+    u16 crc;
+    int ret;
+
+    if (!b->valid || b->size > CUSTOM_BANK_SIZE) {
+        return CUSTOM_BANK_BAD;
+    }
+    if (b->size == 0 || (info->flags & flag)) {
+        return CUSTOM_BANK_OK;  /* Factory image (size unknown) or already verified */
+    }
+
+    buf = vm_mem_alloc(VM_POOL_OTA, CUSTOM_FLASH_PAGE);
+    if (!buf) {
+        log_error("Custom OTA: No buffer to check bank %d\n", bank);
+        return CUSTOM_BANK_UNCHECKED;
+    }
+    log_info("Custom OTA: Checking bank %d (%d bytes)\n", bank, b->size);
+    ret = ota_bank_crc(b->addr, b->size, buf, &crc);
+    vm_mem_free(VM_POOL_OTA, buf);
+
+    if (ret != 0 || crc != b->crc) {
+        log_error("Custom OTA: Bank %d CRC mismatch (0x%04x != 0x%04x)\n", bank, crc, b->crc);
+        return CUSTOM_BANK_BAD;
+    }
+    info->flags |= flag;
+    return CUSTOM_BANK_OK;
+}
+
+/**
+ * Run the boot state machine on the loaded boot info
+ */
+static void boot_select(void)
+{
+    custom_boot_info_t before = g_boot_info;
+    u8 result = custom_boot_select(&g_boot_info, boot_check_bank);
+
+    log_info("Custom OTA: Boot bank %d, count %d/%d, %s\n", g_boot_info.active_bank,
+             g_boot_info.boot_count, g_boot_info.max_boot_tries,
+             (g_boot_info.flags & CUSTOM_BOOT_FLAG_CONFIRMED) ? "confirmed" : "trial");
+
+    if (memcmp(&before, &g_boot_info, sizeof(g_boot_info)) != 0) {
+        write_boot_info();
+    }
+
+    if (result == CUSTOM_BOOT_ROLLBACK) {
+        log_error("Custom OTA: Bank %d failed, rolled back to bank %d\n",
+                  !g_boot_info.active_bank, g_boot_info.active_bank);
+        cpu_reset();
+    } else if (result == CUSTOM_BOOT_NO_IMAGE) {
+        log_error("Custom OTA: No valid bank to fall back to\n");
+    } else if (result == CUSTOM_BOOT_UNCHECKED) {
+        log_error("Custom OTA: Bank %d failed, bank %d not checked, deciding next boot\n",
+                  g_boot_info.active_bank, !g_boot_info.active_bank);
+    }
+}
+
+int custom_dual_bank_mark_good(void)
+{
+    int ret;
+
+    if (!g_initialized || (g_boot_info.flags & CUSTOM_BOOT_FLAG_CONFIRMED)) {
+        return 0;
+    }
+
+    g_boot_info.flags |= CUSTOM_BOOT_FLAG_CONFIRMED;
+    g_boot_info.boot_count = 0;
+    ret = write_boot_info();
+    if (ret == 0) {
+        log_info("Custom OTA: Bank %d marked good\n", g_boot_info.active_bank);
+    }
+    return ret;
+}
+
 /**
  * Initialize custom dual-bank OTA system
  */
@@ -230,6 +359,7 @@ int custom_dual_bank_ota_init(void)
     }
     
     g_initialized = 1;
+    boot_select();
     log_info("Custom OTA: Initialization complete\n");
     
     return 0;
@@ -284,13 +414,32 @@ int custom_dual_bank_ota_start(u32 size, u16 crc, u8 version)
     
     log_info("Custom OTA: Target bank %d at 0x%08x\n", target_bank, g_ota_ctx.target_bank_addr);
     
+    /* The target bank is about to be erased: never roll back to it from here on */
+    if (boot_bank(&g_boot_info, target_bank)->valid) {
+        boot_bank(&g_boot_info, target_bank)->valid = 0;
+        g_boot_info.flags &= ~boot_checked_flag(target_bank);
+        if (write_boot_info() != 0) {
+            return ERR_BOOT_INFO_FAILED;
+        }
+    }
+    
+    /* Page slot from the OTA pool (kept if a previous session leaked it) */
+    if (!g_ota_ctx.rx_slot) {
+        g_ota_ctx.rx_slot = vm_mem_alloc(VM_POOL_OTA, CUSTOM_FLASH_PAGE);
+        if (!g_ota_ctx.rx_slot) {
+            log_error("Custom OTA: No page slot\n");
+            return ERR_NO_MEMORY;
+        }
+    }
+    
     /* Initialize OTA context */
     g_ota_ctx.state = CUSTOM_OTA_STATE_RECEIVING;
     g_ota_ctx.total_size = size;
     g_ota_ctx.received_size = 0;
+    g_ota_ctx.written_size = 0;
     g_ota_ctx.expected_crc = crc;
     g_ota_ctx.target_version = version;
-    g_ota_ctx.buffer_offset = 0;
+    g_ota_ctx.rx_fill = 0;
     
     /* Erase target bank */
     /* CRITICAL: Only erase the actual firmware size, not entire bank */
@@ -312,6 +461,7 @@ int custom_dual_bank_ota_start(u32 size, u16 crc, u8 version)
         log_error("Custom OTA: Flash may be write-protected or address invalid\n");
         log_error("Custom OTA: Check flash layout and SDK configuration\n");
         g_ota_ctx.state = CUSTOM_OTA_STATE_IDLE;
+        ota_release_slot();
         return ERR_ERASE_FAILED;
     }
     log_info("Custom OTA: First sector erase SUCCESS\n");
@@ -325,6 +475,7 @@ int custom_dual_bank_ota_start(u32 size, u16 crc, u8 version)
             log_error("Custom OTA: Erase failed at 0x%08x, ret=%d, sector %d/%d\n", 
                      addr, ret, i + 1, sectors);
             g_ota_ctx.state = CUSTOM_OTA_STATE_IDLE;
+            ota_release_slot();
             return ERR_ERASE_FAILED;
         }
         
@@ -338,14 +489,60 @@ int custom_dual_bank_ota_start(u32 size, u16 crc, u8 version)
     return 0;
 }
 
+/**
+ * Program len bytes at the current write position
+ */
+static int ota_program(u8 *buf, u32 len)
+{
+    u32 write_addr = g_ota_ctx.target_bank_addr + g_ota_ctx.written_size;
+    
+    VM_TRACE(FLASH_BEGIN, g_ota_ctx.written_size >> 8);
+    if (norflash_write(write_addr, buf, len) != 0) {
+        VM_TRACE(FLASH_END, 1);
+        log_error("Custom OTA: Write failed at 0x%08x\n", write_addr);
+        g_ota_ctx.state = CUSTOM_OTA_STATE_IDLE;
+        return ERR_WRITE_FAILED;
+    }
+    
+    VM_TRACE(FLASH_END, 0);
+    g_ota_ctx.written_size += len;
+    
+    /* Log progress every 64KB */
+    if ((g_ota_ctx.written_size - len) / (64 * 1024) != g_ota_ctx.written_size / (64 * 1024)) {
+        log_tok_info(OTA_PROGRESS, g_ota_ctx.written_size, g_ota_ctx.total_size,
+                     (g_ota_ctx.written_size * 100) / g_ota_ctx.total_size);
+    }
+    return 0;
+}
+
+/**
+ * Program whatever is staged in the page slot
+ */
+static int ota_flush_slot(void)
+{
+    int ret;
+    
+    if (g_ota_ctx.rx_fill == 0) {
+        return 0;
+    }
+    
+    ret = ota_program(g_ota_ctx.rx_slot, g_ota_ctx.rx_fill);
+    g_ota_ctx.rx_fill = 0;
+    return ret;
+}
+
 /**
  * Write firmware data
+ *
+ * Payloads are copied into the page slot, which is programmed each time it
+ * fills, so the flash write position stays page aligned. A payload of a
+ * page or more that finds the slot empty has its whole pages programmed
+ * from the caller's buffer instead.
  */
 int custom_dual_bank_ota_data(u8 *data, u16 len)
 {
     int ret;
-    u16 remaining;
-    u16 offset;
+    u32 n;
     
     if (g_ota_ctx.state != CUSTOM_OTA_STATE_RECEIVING) {
         log_error("Custom OTA: Not in receiving state\n");
@@ -353,149 +550,129 @@ int custom_dual_bank_ota_data(u8 *data, u16 len)
     }
     
     /* Check for overflow - prevent receiving more data than expected */
-    u32 bytes_remaining = g_ota_ctx.total_size - (g_ota_ctx.received_size + g_ota_ctx.buffer_offset);
+    u32 bytes_remaining = g_ota_ctx.total_size - g_ota_ctx.received_size;
     if (len > bytes_remaining) {
         log_error("Custom OTA: Data overflow! Received %d bytes, but only %d bytes remaining\n", 
                  len, bytes_remaining);
-        log_error("Custom OTA: Total=%d, Received=%d, Buffered=%d\n",
-                 g_ota_ctx.total_size, g_ota_ctx.received_size, g_ota_ctx.buffer_offset);
+        log_error("Custom OTA: Total=%d, Received=%d, Written=%d\n",
+                 g_ota_ctx.total_size, g_ota_ctx.received_size, g_ota_ctx.written_size);
         g_ota_ctx.state = CUSTOM_OTA_STATE_IDLE;
         return ERR_INVALID_SIZE;
     }
     
-    /* Buffer data and write in 4KB chunks */
-    remaining = len;
-    offset = 0;
+    g_ota_ctx.received_size += len;
     
-    while (remaining > 0) {
-        u16 to_copy = CUSTOM_FLASH_SECTOR - g_ota_ctx.buffer_offset;
-        if (to_copy > remaining) {
-            to_copy = remaining;
-        }
-        
-        /* Prevent buffer overflow */
-        if (g_ota_ctx.buffer_offset + to_copy > CUSTOM_FLASH_SECTOR) {
-            log_error("Custom OTA: Buffer overflow prevented! offset=%d, to_copy=%d, max=%d\n",
-                     g_ota_ctx.buffer_offset, to_copy, CUSTOM_FLASH_SECTOR);
-            g_ota_ctx.state = CUSTOM_OTA_STATE_IDLE;
-            return ERR_WRITE_FAILED;
+    while (g_ota_ctx.rx_fill + len >= CUSTOM_FLASH_PAGE) {
+        if (g_ota_ctx.rx_fill == 0) {
+            n = len & ~(CUSTOM_FLASH_PAGE - 1);
+            ret = ota_program(data, n);
+        } else {
+            n = CUSTOM_FLASH_PAGE - g_ota_ctx.rx_fill;
+            memcpy(g_ota_ctx.rx_slot + g_ota_ctx.rx_fill, data, n);
+            g_ota_ctx.rx_fill = CUSTOM_FLASH_PAGE;
+            ret = ota_flush_slot();
         }
-        
-        /* Copy to buffer */
-        memcpy(g_ota_ctx.buffer + g_ota_ctx.buffer_offset, data + offset, to_copy);
-        g_ota_ctx.buffer_offset += to_copy;
-        offset += to_copy;
-        remaining -= to_copy;
-        
-        /* Write full sector to flash */
-        if (g_ota_ctx.buffer_offset >= CUSTOM_FLASH_SECTOR) {
-            u32 write_addr = g_ota_ctx.target_bank_addr + g_ota_ctx.received_size;
-            
-            ret = norflash_write(write_addr, g_ota_ctx.buffer, CUSTOM_FLASH_SECTOR);
-            if (ret != 0) {
-                log_error("Custom OTA: Write failed at 0x%08x\n", write_addr);
-                g_ota_ctx.state = CUSTOM_OTA_STATE_IDLE;
-                return ERR_WRITE_FAILED;
-            }
-            
-            g_ota_ctx.received_size += CUSTOM_FLASH_SECTOR;
-            g_ota_ctx.buffer_offset = 0;
-            
-            /* Log progress every 64KB */
-            if (g_ota_ctx.received_size % (64 * 1024) == 0) {
-                log_info("Custom OTA: Written %d/%d bytes (%d%%)\n",
-                        g_ota_ctx.received_size, g_ota_ctx.total_size,
-                        (g_ota_ctx.received_size * 100) / g_ota_ctx.total_size);
-            }
+        if (ret != 0) {
+            return ret;
         }
+        data += n;
+        len -= n;
     }
     
+    memcpy(g_ota_ctx.rx_slot + g_ota_ctx.rx_fill, data, len);
+    g_ota_ctx.rx_fill += len;
     return 0;
 }
 
 /**
- * Finalize OTA update
+ * Begin the commit: program the staged tail and check the size
  */
-int custom_dual_bank_ota_end(void)
+int custom_dual_bank_ota_commit_begin(void)
 {
     int ret;
-    u32 addr;
-    u32 remaining;
-    u8 verify_buf[256];
-    u16 calculated_crc;
-    u8 target_bank;
-    custom_bank_info_t *target_info;
     
-    log_info("Custom OTA: END - Verifying firmware...\n");
+    if (g_ota_ctx.state == CUSTOM_OTA_STATE_VERIFYING ||
+        g_ota_ctx.state == CUSTOM_OTA_STATE_UPDATING ||
+        g_ota_ctx.state == CUSTOM_OTA_STATE_COMMITTED) {
+        return 0;   /* Retransmitted FINISH */
+    }
     
     if (g_ota_ctx.state != CUSTOM_OTA_STATE_RECEIVING) {
         log_error("Custom OTA: Not in receiving state\n");
         return ERR_INVALID_STATE;
     }
     
+    log_info("Custom OTA: END - Verifying firmware...\n");
     g_ota_ctx.state = CUSTOM_OTA_STATE_VERIFYING;
     
-    /* Write remaining buffered data */
-    if (g_ota_ctx.buffer_offset > 0) {
-        u32 write_addr = g_ota_ctx.target_bank_addr + g_ota_ctx.received_size;
-        
-        ret = norflash_write(write_addr, g_ota_ctx.buffer, g_ota_ctx.buffer_offset);
-        if (ret != 0) {
-            log_error("Custom OTA: Final write failed\n");
-            g_ota_ctx.state = CUSTOM_OTA_STATE_IDLE;
-            return ERR_WRITE_FAILED;
-        }
-        
-        g_ota_ctx.received_size += g_ota_ctx.buffer_offset;
+    /* Write the staged tail */
+    ret = ota_flush_slot();
+    if (ret != 0) {
+        log_error("Custom OTA: Final write failed\n");
+        return ret;
     }
     
     /* Verify size */
-    if (g_ota_ctx.received_size != g_ota_ctx.total_size) {
+    if (g_ota_ctx.written_size != g_ota_ctx.total_size) {
         log_error("Custom OTA: Size mismatch: %d != %d\n",
-                 g_ota_ctx.received_size, g_ota_ctx.total_size);
+                 g_ota_ctx.written_size, g_ota_ctx.total_size);
         g_ota_ctx.state = CUSTOM_OTA_STATE_IDLE;
         return ERR_VERIFY_FAILED;
     }
     
-    /* Calculate CRC of written firmware using incremental method */
-    /* This avoids allocating entire firmware in RAM (would fail on 64KB RAM device) */
-    log_info("Custom OTA: Calculating CRC incrementally (256 bytes at a time)...\n");
+    g_ota_ctx.verified_size = 0;
+    g_ota_ctx.verify_crc = 0;  /* Initial CRC value */
+    return 0;
+}
+
+/**
+ * CRC-check the next part of the image and write boot info once it is done
+ *
+ * The CRC is computed incrementally from flash, one page at a time, so the
+ * image never has to fit in RAM; the page slot is free now and
+ * doubles as the read buffer.
+ */
+int custom_dual_bank_ota_commit_step(void)
+{
+    int ret;
+    u32 pages;
+    u8 target_bank;
+    custom_bank_info_t *target_info;
+    custom_boot_info_t before;
+    
+    if (g_ota_ctx.state == CUSTOM_OTA_STATE_COMMITTED) {
+        return 0;
+    }
     
-    u8 read_buf[256];
-    calculated_crc = 0;  /* Initial CRC value */
-    u32 bytes_verified = 0;
+    if (g_ota_ctx.state != CUSTOM_OTA_STATE_VERIFYING) {
+        log_error("Custom OTA: No commit in progress (state=%d)\n", g_ota_ctx.state);
+        return ERR_INVALID_STATE;
+    }
     
-    while (bytes_verified < g_ota_ctx.total_size) {
-        u32 remaining = g_ota_ctx.total_size - bytes_verified;
-        u16 chunk_size = (remaining > 256) ? 256 : remaining;
+    for (pages = 0; pages < CUSTOM_OTA_VERIFY_STEP_PAGES &&
+         g_ota_ctx.verified_size < g_ota_ctx.total_size; pages++) {
+        u32 remaining = g_ota_ctx.total_size - g_ota_ctx.verified_size;
+        u16 chunk_size = (remaining > CUSTOM_FLASH_PAGE) ? CUSTOM_FLASH_PAGE : remaining;
         
-        /* Read chunk from flash */
-        ret = norflash_read(g_ota_ctx.target_bank_addr + bytes_verified, read_buf, chunk_size);
-        if (ret != 0) {
-            log_error("Custom OTA: Failed to read firmware at offset %d\n", bytes_verified);
+        if (norflash_read(g_ota_ctx.target_bank_addr + g_ota_ctx.verified_size,
+                          g_ota_ctx.rx_slot, chunk_size) != 0) {
+            log_error("Custom OTA: Failed to read firmware at offset %d\n", g_ota_ctx.verified_size);
             g_ota_ctx.state = CUSTOM_OTA_STATE_IDLE;
             return ERR_VERIFY_FAILED;
         }
-        
-        /* Calculate CRC incrementally */
-        calculated_crc = CRC16_with_initval(read_buf, chunk_size, calculated_crc);
-        bytes_verified += chunk_size;
-        
-        /* Log progress every 64KB */
-        if (bytes_verified % (64 * 1024) == 0) {
-            log_info("Custom OTA: Verified %d/%d bytes (%d%%)\n",
-                    bytes_verified, g_ota_ctx.total_size,
-                    (bytes_verified * 100) / g_ota_ctx.total_size);
-        }
+        g_ota_ctx.verify_crc = CRC16_with_initval(g_ota_ctx.rx_slot, chunk_size, g_ota_ctx.verify_crc);
+        g_ota_ctx.verified_size += chunk_size;
     }
     
-    log_info("Custom OTA: CRC calculation complete\n");
+    if (g_ota_ctx.verified_size < g_ota_ctx.total_size) {
+        return CUSTOM_OTA_COMMIT_PENDING;
+    }
     
     log_info("Custom OTA: CRC calculated: 0x%04x (expected: 0x%04x)\n",
-             calculated_crc, g_ota_ctx.expected_crc);
+             g_ota_ctx.verify_crc, g_ota_ctx.expected_crc);
     
     /* Verify CRC */
-    if (calculated_crc != g_ota_ctx.expected_crc) {
+    if (g_ota_ctx.verify_crc != g_ota_ctx.expected_crc) {
         log_error("Custom OTA: CRC mismatch!\n");
         g_ota_ctx.state = CUSTOM_OTA_STATE_IDLE;
         return ERR_VERIFY_FAILED;
@@ -503,41 +680,57 @@ int custom_dual_bank_ota_end(void)
     
     log_info("Custom OTA: Firmware verified successfully\n");
     
-    /* Update boot info */
+    /* Update boot info - the only write of the commit, and the last one */
     g_ota_ctx.state = CUSTOM_OTA_STATE_UPDATING;
+    before = g_boot_info;
     
     target_bank = (g_boot_info.active_bank == 0) ? 1 : 0;
     target_info = (target_bank == 0) ? &g_boot_info.bank_a : &g_boot_info.bank_b;
     
     target_info->addr = g_ota_ctx.target_bank_addr;
     target_info->size = g_ota_ctx.total_size;
-    target_info->crc = calculated_crc;
+    target_info->crc = g_ota_ctx.verify_crc;
     target_info->valid = 1;
     target_info->version = g_ota_ctx.target_version;
     
-    /* Switch active bank */
+    /* Switch active bank; the new image boots on trial until marked good */
     g_boot_info.active_bank = target_bank;
     g_boot_info.boot_count = 0;
     g_boot_info.max_boot_tries = MAX_BOOT_TRIES;
+    g_boot_info.flags &= ~CUSTOM_BOOT_FLAG_CONFIRMED;
+    g_boot_info.flags |= boot_checked_flag(target_bank);  /* CRC verified just now */
     
     /* Write boot info */
     ret = write_boot_info();
     if (ret != 0) {
         log_error("Custom OTA: Failed to update boot info\n");
+        g_boot_info = before;  /* Not switched, keep RAM in line with flash */
         g_ota_ctx.state = CUSTOM_OTA_STATE_IDLE;
         return ret;
     }
     
-    log_info("Custom OTA: Boot info updated, resetting device...\n");
-    g_ota_ctx.state = CUSTOM_OTA_STATE_IDLE;
-    
-    /* Reset device to boot into new firmware */
-    os_time_dly(100);  /* Give time for logs to flush */
-    cpu_reset();
+    log_info("Custom OTA: Boot info updated, bank %d active after reset\n", target_bank);
+    g_ota_ctx.state = CUSTOM_OTA_STATE_COMMITTED;
+    ota_release_slot();
     
     return 0;
 }
 
+/**
+ * Get commit progress (0-100)
+ */
+u8 custom_dual_bank_ota_get_commit_progress(void)
+{
+    if (g_ota_ctx.state == CUSTOM_OTA_STATE_COMMITTED) {
+        return 100;
+    }
+    if (g_ota_ctx.total_size == 0) {
+        return 0;
+    }
+    
+    return (g_ota_ctx.verified_size * 100) / g_ota_ctx.total_size;
+}
+
 /**
  * Get current OTA progress (0-100)
  */
@@ -586,10 +779,13 @@ void custom_dual_bank_ota_abort(void)
 {
     log_info("Custom OTA: Aborting OTA operation\n");
     
-    /* Note: buffer is a static array in g_ota_ctx, not dynamically allocated */
-    /* No need to free - it will be cleared by memset */
+    /* Page slot goes back to the OTA pool before the context is cleared */
+    ota_release_slot();
     
     /* Reset context to idle state */
     memset(&g_ota_ctx, 0, sizeof(g_ota_ctx));
     g_ota_ctx.state = CUSTOM_OTA_STATE_IDLE;
 }
+
+/* Run the boot check before the BT stack starts */
+__initcall(custom_dual_bank_ota_init);
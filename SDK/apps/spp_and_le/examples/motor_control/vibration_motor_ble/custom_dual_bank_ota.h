@@ -6,16 +6,21 @@
  * 
  * Flash Layout (1MB total) - 4KB ALIGNED for flash operations:
  * 0x000000 - 0x001000 (4 KB):    Bootloader (SDK managed)
- * 0x001000 - 0x002000 (4 KB):    Custom Boot Info (4KB aligned)
- * 0x002000 - 0x04E000 (304 KB):  Bank A (app.bin) - 4KB aligned
- * 0x04E000 - 0x09A000 (304 KB):  Bank B (app.bin) - 4KB aligned
+ * 0x001000 - 0x002000 (4 KB):    Boot journal sector 2 (legacy boot info)
+ * 0x002000 - 0x04D000 (300 KB):  Bank A (app.bin) - 4KB aligned
+ * 0x04D000 - 0x04E000 (4 KB):    Boot journal sector 0
+ * 0x04E000 - 0x099000 (300 KB):  Bank B (app.bin) - 4KB aligned
+ * 0x099000 - 0x09A000 (4 KB):    Boot journal sector 1
  * 0x09A000 - 0x100000 (408 KB):  VM/Data partition
  * 
- * Bank size: 304 KB (311,296 bytes)
+ * Bank size: 300 KB (307,200 bytes)
  * - Current firmware: ~220 KB
- * - Headroom: 84 KB (38% growth potential)
+ * - Headroom: 80 KB (36% growth potential)
  * - VM/Data: 408 KB (ample space for settings, logs, bonding)
  * 
+ * Boot info is appended to a record journal over the three journal
+ * sectors (custom_journal.h) instead of being rewritten in place.
+ * 
  * CRITICAL: All addresses MUST be 4KB aligned for flash erase operations!
  * Flash erase operates on 4KB sectors and requires aligned addresses.
  */
@@ -26,23 +31,54 @@
 #include "typedef.h"
 
 /* Flash addresses and sizes - ALL 4KB ALIGNED */
-#define CUSTOM_BOOT_INFO_ADDR       0x001000    /* Primary boot info location (4KB aligned) */
-#define CUSTOM_BOOT_INFO_BACKUP     0x001400    /* Backup boot info location (4KB aligned) */
+#define CUSTOM_BOOT_INFO_ADDR       0x001000    /* Legacy primary boot info, read once for migration */
+#define CUSTOM_BOOT_INFO_BACKUP     0x001400    /* Legacy backup boot info (same sector as the primary) */
 #define CUSTOM_BANK_A_ADDR          0x002000    /* Bank A start (4KB aligned) */
 #define CUSTOM_BANK_B_ADDR          0x04E000    /* Bank B start (4KB aligned) */
-#define CUSTOM_BANK_SIZE            (304 * 1024) /* 304 KB per bank (4KB aligned) */
+#define CUSTOM_BANK_SIZE            (300 * 1024) /* 300 KB per bank, last sector of each range is journal */
 #define CUSTOM_FLASH_SECTOR         4096        /* 4KB sector size */
+#define CUSTOM_FLASH_PAGE           256         /* Program page size */
 
 /* Boot info magic and version */
 #define CUSTOM_BOOT_MAGIC       0x4A4C4F54  /* 'JLOT' */
 #define CUSTOM_BOOT_VERSION     0x0001
 #define MAX_BOOT_TRIES          3           /* Max boot attempts before rollback */
 
+/* Flash pages CRC-checked per commit step (custom_dual_bank_ota_commit_step) */
+#ifndef CUSTOM_OTA_VERIFY_STEP_PAGES
+#define CUSTOM_OTA_VERIFY_STEP_PAGES    16  /* 4 KB */
+#endif
+
+/* Time BLE must stay up before a new image is marked good */
+#ifndef CUSTOM_BOOT_CONFIRM_MS
+#define CUSTOM_BOOT_CONFIRM_MS  10000
+#endif
+
+/* Boot info flags */
+#define CUSTOM_BOOT_FLAG_CONFIRMED  0x0001  /* Active bank marked good, boot_count not used */
+#define CUSTOM_BOOT_FLAG_A_CHECKED  0x0002  /* bank_a CRC verified for its size/crc */
+#define CUSTOM_BOOT_FLAG_B_CHECKED  0x0004  /* bank_b CRC verified for its size/crc */
+
+/* Boot decision (custom_boot_select) */
+#define CUSTOM_BOOT_CONTINUE    0   /* Boot the active bank */
+#define CUSTOM_BOOT_ROLLBACK    1   /* Active bank failed, switched to the other bank */
+#define CUSTOM_BOOT_NO_IMAGE    2   /* No usable bank, stay on the running image */
+#define CUSTOM_BOOT_UNCHECKED   3   /* Active bank failed, the other one could not be checked: stay, decide next boot */
+
+/* Bank check result (custom_bank_check_t) */
+#define CUSTOM_BANK_BAD         0
+#define CUSTOM_BANK_OK          1
+#define CUSTOM_BANK_UNCHECKED   2   /* No buffer to check it now: no verdict, nothing cached */
+
 /* OTA states */
 #define CUSTOM_OTA_STATE_IDLE       0
 #define CUSTOM_OTA_STATE_RECEIVING  1
 #define CUSTOM_OTA_STATE_VERIFYING  2
 #define CUSTOM_OTA_STATE_UPDATING   3
+#define CUSTOM_OTA_STATE_COMMITTED  4   /* Boot info written, waiting for the reset */
+
+/* custom_dual_bank_ota_commit_step(): more steps needed */
+#define CUSTOM_OTA_COMMIT_PENDING   (-1)
 
 /* Bank information structure */
 typedef struct {
@@ -53,12 +89,12 @@ typedef struct {
     u8  version;        /* Firmware version number */
 } custom_bank_info_t;
 
-/* Boot info structure (stored at CUSTOM_BOOT_INFO_ADDR) */
+/* Boot info structure (journal record CUSTOM_JNL_TYPE_BOOT_INFO) */
 typedef struct {
     /* Header */
     u32 magic;          /* CUSTOM_BOOT_MAGIC */
     u16 version;        /* CUSTOM_BOOT_VERSION */
-    u16 reserved1;
+    u16 flags;          /* CUSTOM_BOOT_FLAG_* (reserved, 0 in older boot info) */
     
     /* Bank information */
     custom_bank_info_t bank_a;
@@ -66,7 +102,7 @@ typedef struct {
     
     /* Active bank tracking */
     u8 active_bank;     /* 0 = Bank A, 1 = Bank B */
-    u8 boot_count;      /* Incremented on each boot attempt */
+    u8 boot_count;      /* Incremented on each boot attempt until confirmed */
     u8 max_boot_tries;  /* Max attempts before rollback */
     u8 reserved2;
     
@@ -75,16 +111,28 @@ typedef struct {
     u16 reserved3;
 } custom_boot_info_t;
 
+/**
+ * Bank check used by custom_boot_select()
+ * @param info Boot info (may set CUSTOM_BOOT_FLAG_*_CHECKED, only for CUSTOM_BANK_OK)
+ * @param bank Bank number (0 or 1)
+ * @return CUSTOM_BANK_OK if the bank holds a valid image, CUSTOM_BANK_BAD,
+ *         or CUSTOM_BANK_UNCHECKED if it could not be checked now
+ */
+typedef u8 (*custom_bank_check_t)(custom_boot_info_t *info, u8 bank);
+
 /* OTA context */
 typedef struct {
     u8 state;                   /* Current OTA state */
     u32 total_size;             /* Total firmware size */
     u32 received_size;          /* Bytes received so far */
+    u32 written_size;           /* Bytes programmed to flash (page aligned until the commit) */
+    u32 verified_size;          /* Bytes CRC-checked by the commit so far */
+    u16 verify_crc;             /* Running CRC of the verified bytes */
     u32 target_bank_addr;       /* Target bank flash address */
     u16 expected_crc;           /* Expected CRC from START command */
     u8 target_version;          /* Target firmware version */
-    u8 buffer[CUSTOM_FLASH_SECTOR]; /* 4KB sector buffer */
-    u16 buffer_offset;          /* Current offset in buffer */
+    u8 *rx_slot;                /* Page slot (VM_POOL_OTA), held START..FINISH/abort */
+    u16 rx_fill;                /* Bytes staged in rx_slot */
 } custom_ota_ctx_t;
 
 /* Flash eraser types (from SDK norflash.h) */
@@ -108,7 +156,9 @@ extern u16 CRC16(const void *ptr, u32 len);
 
 /**
  * Initialize custom dual-bank OTA system
- * Reads and validates boot info from flash
+ * Reads and validates boot info from flash and runs the boot check
+ * (boot counting, rollback). Registered as an initcall so this happens
+ * before the BT stack starts; later calls are no-ops
  * @return 0 on success, negative on error
  */
 int custom_dual_bank_ota_init(void);
@@ -124,18 +174,41 @@ int custom_dual_bank_ota_start(u32 size, u16 crc, u8 version);
 
 /**
  * Write firmware data
- * @param data Pointer to firmware data
+ * Staged in a 256 B page slot that is programmed whenever it fills; a
+ * payload of a page or more finding the slot empty has its whole pages
+ * programmed from data
+ * @param data Pointer to firmware data (e.g. the ATT write buffer)
  * @param len Length of data
  * @return 0 on success, error code on failure
  */
 int custom_dual_bank_ota_data(u8 *data, u16 len);
 
 /**
- * Finalize OTA update
- * Verifies CRC, updates boot info, and resets device
- * @return 0 on success, error code on failure
+ * Begin the commit after the last DATA packet
+ * Programs the staged tail and checks the size; the CRC pass and the boot
+ * info write are left to custom_dual_bank_ota_commit_step(). Calling it
+ * again while a commit runs or after it finished is a no-op
+ * @return 0 on success, error code on failure (state back to idle)
  */
-int custom_dual_bank_ota_end(void);
+int custom_dual_bank_ota_commit_begin(void);
+
+/**
+ * Run one bounded commit step
+ * CRC-checks up to CUSTOM_OTA_VERIFY_STEP_PAGES pages of the new image;
+ * the step that completes the check writes boot info, which switches the
+ * active bank. Nothing is written after it, so a power cut before that
+ * write keeps the old image and one after it boots the new one. Does not
+ * reset: the caller does once it has reported success
+ * @return CUSTOM_OTA_COMMIT_PENDING while verifying, 0 once committed,
+ *         error code on failure (state back to idle)
+ */
+int custom_dual_bank_ota_commit_step(void);
+
+/**
+ * Get commit progress (0-100, CRC pass)
+ * @return Progress percentage
+ */
+u8 custom_dual_bank_ota_get_commit_progress(void);
 
 /**
  * Abort OTA operation and reset to idle state
@@ -161,6 +234,31 @@ u8 custom_dual_bank_ota_get_state(void);
  */
 u8 custom_dual_bank_get_active_bank(void);
 
+/**
+ * Boot state machine (pure, usable on host builds)
+ * Counts unconfirmed boots and falls back to the other bank when the
+ * active bank fails its check or used up max_boot_tries. An active bank
+ * that could not be checked keeps running (and counting); an unchecked
+ * other bank is never the rollback target
+ * @param info Boot info, updated in place (caller persists changes)
+ * @param check Bank check, only called for banks that need it
+ * @return CUSTOM_BOOT_*
+ */
+u8 custom_boot_select(custom_boot_info_t *info, custom_bank_check_t check);
+
+/**
+ * Mark the active bank good: stops boot counting and rollback
+ * Call once the application is up (BLE running); no-op if already confirmed
+ *
+ * Limitation: the SDK bootloader does not read boot info and starts the
+ * app from its fixed location, so the image that is running is not known
+ * here. This confirms boot_info.active_bank, the bank last committed or
+ * rolled back to, on the assumption that it is the one that booted. If a
+ * loader does not follow active_bank, the wrong bank can be confirmed
+ * @return 0 on success, error code if boot info could not be written
+ */
+int custom_dual_bank_mark_good(void);
+
 /**
  * Get firmware version of specified bank
  * @param bank Bank number (0 or 1)
@@ -0,0 +1,340 @@
+/**
+ * Boot Info / OTA Metadata Journal
+ */
+
+#include "custom_journal.h"
+#include "custom_dual_bank_ota.h"
+#include "system/includes.h"
+#include "asm/crc16.h"
+
+/* Logging */
+#define VM_LOG_TAG      "CUSTOM_JNL"
+#define VM_LOG_LEVEL    VM_LOG_LEVEL_JNL
+#include "vm_log.h"
+
+#define JNL_ALIGN(n)        (((n) + 3) & ~3)
+#define JNL_REC_SIZE(len)   JNL_ALIGN(sizeof(custom_jnl_rec_t) + (len))
+#define JNL_NO_HEAD         0xFF
+
+static const u32 g_sectors[CUSTOM_JNL_SECTORS] = {
+    CUSTOM_JNL_SECTOR_0,
+    CUSTOM_JNL_SECTOR_1,
+    CUSTOM_JNL_SECTOR_2,
+};
+
+static u8 g_head = JNL_NO_HEAD;                 /* Ring index of the head sector */
+static u8 g_tail_dirty = 0;                     /* Head has unusable bytes after the last record */
+static u32 g_head_seq = 0;                      /* Generation of the head sector */
+static u32 g_write_off = 0;                     /* Next record offset in the head sector */
+static u32 g_next_seq = 1;                      /* Next record sequence number */
+static u32 g_latest[CUSTOM_JNL_MAX_TYPES];      /* Latest record address per type, 0 = none */
+static u32 g_latest_seq[CUSTOM_JNL_MAX_TYPES];
+static u32 g_erase_count[CUSTOM_JNL_SECTORS];
+
+/* ========== Encoding ========== */
+
+static u16 jnl_sector_crc(const custom_jnl_sector_t *hdr)
+{
+    return CRC16(hdr, offsetof(custom_jnl_sector_t, crc));
+}
+
+static u16 jnl_rec_crc(const custom_jnl_rec_t *rec, const u8 *payload)
+{
+    u16 crc = CRC16(rec, 2);    /* type, len */
+
+    crc = CRC16_with_initval((const u8 *)&rec->seq, sizeof(rec->seq), crc);
+    return CRC16_with_initval(payload, rec->len, crc);
+}
+
+static u8 jnl_type_ok(u8 type)
+{
+    return type >= 1 && type <= CUSTOM_JNL_MAX_TYPES;
+}
+
+/* ========== Scan ========== */
+
+static int jnl_read_sector_hdr(u32 addr, custom_jnl_sector_t *hdr)
+{
+    if (norflash_read(addr, (u8 *)hdr, sizeof(*hdr)) != 0) {
+        return -1;
+    }
+    if (hdr->magic != CUSTOM_JNL_SECTOR_MAGIC || hdr->crc != jnl_sector_crc(hdr)) {
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Read and check the record at addr
+ * @param buf Header followed by payload, sizeof(custom_jnl_rec_t) + CUSTOM_JNL_MAX_PAYLOAD
+ * @return 1 valid, 0 free space, -1 broken
+ */
+static int jnl_read_rec(u32 addr, u32 end, u8 *buf)
+{
+    custom_jnl_rec_t *rec = (custom_jnl_rec_t *)buf;
+
+    if (addr + sizeof(*rec) > end || norflash_read(addr, buf, sizeof(*rec)) != 0) {
+        return -1;
+    }
+    if (rec->type == CUSTOM_JNL_TYPE_FREE && rec->len == 0xFF &&
+        rec->crc == 0xFFFF && rec->seq == 0xFFFFFFFF) {
+        return 0;
+    }
+    if (!jnl_type_ok(rec->type) || rec->len > CUSTOM_JNL_MAX_PAYLOAD ||
+        addr + JNL_REC_SIZE(rec->len) > end) {
+        return -1;
+    }
+    if (norflash_read(addr + sizeof(*rec), buf + sizeof(*rec), rec->len) != 0) {
+        return -1;
+    }
+    return (rec->crc == jnl_rec_crc(rec, buf + sizeof(*rec))) ? 1 : -1;
+}
+
+/**
+ * Check that a sector is erased from off to its end
+ */
+static u8 jnl_is_erased(u32 addr, u32 off)
+{
+    u8 buf[64];
+    u32 i;
+
+    while (off < CUSTOM_FLASH_SECTOR) {
+        u32 n = CUSTOM_FLASH_SECTOR - off;
+
+        if (n > sizeof(buf)) {
+            n = sizeof(buf);
+        }
+        if (norflash_read(addr + off, buf, n) != 0) {
+            return 0;
+        }
+        for (i = 0; i < n; i++) {
+            if (buf[i] != 0xFF) {
+                return 0;
+            }
+        }
+        off += n;
+    }
+    return 1;
+}
+
+/**
+ * Walk the records of one sector
+ * @return Offset after the last valid record, bit 31 set if a broken record ended the walk
+ */
+static u32 jnl_scan_sector(u32 addr)
+{
+    u8 buf[sizeof(custom_jnl_rec_t) + CUSTOM_JNL_MAX_PAYLOAD];
+    custom_jnl_rec_t *rec = (custom_jnl_rec_t *)buf;
+    u32 end = addr + CUSTOM_FLASH_SECTOR;
+    u32 off = sizeof(custom_jnl_sector_t);
+    int ret;
+
+    while ((ret = jnl_read_rec(addr + off, end, buf)) > 0) {
+        u8 t = rec->type - 1;
+
+        if (!g_latest[t] || rec->seq > g_latest_seq[t]) {
+            g_latest[t] = addr + off;
+            g_latest_seq[t] = rec->seq;
+        }
+        if (rec->seq >= g_next_seq) {
+            g_next_seq = rec->seq + 1;
+        }
+        off += JNL_REC_SIZE(rec->len);
+    }
+
+    return (ret < 0 && off < CUSTOM_FLASH_SECTOR) ? (off | 0x80000000) : off;
+}
+
+int custom_jnl_init(void)
+{
+    custom_jnl_sector_t hdr;
+    u8 valid[CUSTOM_JNL_SECTORS];
+    u32 off;
+    u8 i;
+
+    g_head = JNL_NO_HEAD;
+    g_tail_dirty = 0;
+    g_head_seq = 0;
+    g_write_off = 0;
+    g_next_seq = 1;
+    memset(g_latest, 0, sizeof(g_latest));
+    memset(g_latest_seq, 0, sizeof(g_latest_seq));
+
+    for (i = 0; i < CUSTOM_JNL_SECTORS; i++) {
+        valid[i] = (jnl_read_sector_hdr(g_sectors[i], &hdr) == 0);
+        g_erase_count[i] = valid[i] ? hdr.erase_count : 0;
+        if (valid[i] && (g_head == JNL_NO_HEAD || hdr.seq > g_head_seq)) {
+            g_head = i;
+            g_head_seq = hdr.seq;
+        }
+    }
+
+    for (i = 0; i < CUSTOM_JNL_SECTORS; i++) {
+        if (!valid[i]) {
+            /* Header lost with a cut erase: the ring wears evenly, assume the head's count */
+            if (g_head != JNL_NO_HEAD) {
+                g_erase_count[i] = g_erase_count[g_head];
+            }
+            continue;
+        }
+        off = jnl_scan_sector(g_sectors[i]);
+        if (i == g_head) {
+            g_write_off = off & ~0x80000000;
+            g_tail_dirty = (off & 0x80000000) || !jnl_is_erased(g_sectors[i], g_write_off);
+        }
+    }
+
+    if (g_head == JNL_NO_HEAD) {
+        log_info("Empty journal\n");
+    } else {
+        log_info("Head sector 0x%06x, %d/%d bytes used%s\n", g_sectors[g_head],
+                 g_write_off, CUSTOM_FLASH_SECTOR, g_tail_dirty ? ", tail dirty" : "");
+    }
+    return 0;
+}
+
+int custom_jnl_read(u8 type, void *buf, u8 len)
+{
+    u8 rec_buf[sizeof(custom_jnl_rec_t) + CUSTOM_JNL_MAX_PAYLOAD];
+    custom_jnl_rec_t *rec = (custom_jnl_rec_t *)rec_buf;
+    u32 addr;
+
+    if (!jnl_type_ok(type) || !g_latest[type - 1]) {
+        return -1;
+    }
+    addr = g_latest[type - 1];
+    if (jnl_read_rec(addr, (addr & ~(CUSTOM_FLASH_SECTOR - 1)) + CUSTOM_FLASH_SECTOR, rec_buf) <= 0) {
+        return -1;
+    }
+    if (len > rec->len) {
+        len = rec->len;
+    }
+    memcpy(buf, rec_buf + sizeof(*rec), len);
+    return len;
+}
+
+/* ========== Append ========== */
+
+static int jnl_program(u32 addr, u8 *buf, u32 len)
+{
+    u8 verify[sizeof(custom_jnl_rec_t) + CUSTOM_JNL_MAX_PAYLOAD];
+
+    if (norflash_write(addr, buf, len) != 0) {
+        return -1;
+    }
+    if (norflash_read(addr, verify, len) != 0 || memcmp(verify, buf, len) != 0) {
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Move the head to the next ring sector, carrying the latest record of every type
+ */
+static int jnl_rotate(void)
+{
+    u8 buf[sizeof(custom_jnl_rec_t) + CUSTOM_JNL_MAX_PAYLOAD];
+    custom_jnl_rec_t *rec = (custom_jnl_rec_t *)buf;
+    custom_jnl_sector_t hdr;
+    u32 latest[CUSTOM_JNL_MAX_TYPES];
+    u8 next = (g_head == JNL_NO_HEAD) ? 0 : (g_head + 1) % CUSTOM_JNL_SECTORS;
+    u32 addr = g_sectors[next];
+    u32 off = sizeof(custom_jnl_sector_t);
+    u8 t;
+
+    if (norflash_erase(FLASH_SECTOR_ERASER, addr) != 0) {
+        log_error("Erase 0x%06x failed\n", addr);
+        return -1;
+    }
+    g_erase_count[next]++;
+
+    /* The head holds the latest of every type (it was compacted the same way) */
+    for (t = 0; t < CUSTOM_JNL_MAX_TYPES; t++) {
+        latest[t] = 0;
+        if (!g_latest[t]) {
+            continue;
+        }
+        if (jnl_read_rec(g_latest[t], (g_latest[t] & ~(CUSTOM_FLASH_SECTOR - 1)) + CUSTOM_FLASH_SECTOR, buf) <= 0 ||
+            jnl_program(addr + off, buf, sizeof(*rec) + rec->len) != 0) {
+            log_error("Carry of type %d failed\n", t + 1);
+            return -1;
+        }
+        latest[t] = addr + off;
+        off += JNL_REC_SIZE(rec->len);
+    }
+
+    /* Commit: from here on this sector is the head */
+    hdr.magic = CUSTOM_JNL_SECTOR_MAGIC;
+    hdr.seq = g_head_seq + 1;
+    hdr.erase_count = g_erase_count[next];
+    hdr.crc = jnl_sector_crc(&hdr);
+    hdr.reserved = 0xFFFF;
+    if (jnl_program(addr, (u8 *)&hdr, sizeof(hdr)) != 0) {
+        log_error("Sector header 0x%06x failed\n", addr);
+        return -1;
+    }
+
+    g_head = next;
+    g_head_seq = hdr.seq;
+    g_write_off = off;
+    g_tail_dirty = 0;
+    memcpy(g_latest, latest, sizeof(g_latest));
+    log_info("Head moved to 0x%06x (erase #%d)\n", addr, g_erase_count[next]);
+    return 0;
+}
+
+int custom_jnl_append(u8 type, const void *data, u8 len)
+{
+    u8 buf[sizeof(custom_jnl_rec_t) + CUSTOM_JNL_MAX_PAYLOAD];
+    custom_jnl_rec_t *rec = (custom_jnl_rec_t *)buf;
+    u32 addr;
+
+    if (!jnl_type_ok(type) || len > CUSTOM_JNL_MAX_PAYLOAD) {
+        return -1;
+    }
+
+    if (g_head == JNL_NO_HEAD || g_tail_dirty ||
+        g_write_off + JNL_REC_SIZE(len) > CUSTOM_FLASH_SECTOR) {
+        if (jnl_rotate() != 0) {
+            return -1;
+        }
+    }
+
+    rec->type = type;
+    rec->len = len;
+    rec->seq = g_next_seq;
+    memcpy(buf + sizeof(*rec), data, len);
+    rec->crc = jnl_rec_crc(rec, buf + sizeof(*rec));
+
+    addr = g_sectors[g_head] + g_write_off;
+    g_write_off += JNL_REC_SIZE(len);
+    if (jnl_program(addr, buf, sizeof(*rec) + len) != 0) {
+        log_error("Record write at 0x%06x failed\n", addr);
+        g_tail_dirty = 1;
+        return -1;
+    }
+
+    g_latest[type - 1] = addr;
+    g_latest_seq[type - 1] = g_next_seq++;
+    return 0;
+}
+
+/* ========== Statistics ========== */
+
+void custom_jnl_get_erase_counts(u32 *counts)
+{
+    memcpy(counts, g_erase_count, sizeof(g_erase_count));
+}
+
+void custom_jnl_dump(void)
+{
+    u8 i;
+
+    if (g_head != JNL_NO_HEAD) {
+        log_info("head=0x%06x used=%d/%d next_seq=%d\n", g_sectors[g_head],
+                 g_write_off, CUSTOM_FLASH_SECTOR, g_next_seq);
+    }
+    for (i = 0; i < CUSTOM_JNL_SECTORS; i++) {
+        log_info("sector 0x%06x erased %d times\n", g_sectors[i], g_erase_count[i]);
+    }
+}
@@ -0,0 +1,97 @@
+/**
+ * Boot Info / OTA Metadata Journal
+ *
+ * Append-only record log over a ring of flash sectors
+ * (CUSTOM_JNL_SECTOR_0..2). Every update appends one record instead of
+ * rewriting a sector, so a sector is only erased once it is full:
+ *
+ *   sector: [custom_jnl_sector_t][record][record]...[0xFF free space]
+ *   record: [custom_jnl_rec_t][payload, padded to 4 bytes]
+ *
+ * Records carry a journal-wide sequence number and a CRC16. On scan the
+ * valid record with the highest sequence number wins per type. A record
+ * that was cut by a power loss fails its CRC and ends the scan of its
+ * sector; the tail is then not trusted and the next append moves on.
+ *
+ * When the head sector is full, the next sector in the ring is erased, the
+ * latest record of every type is copied over and only then is the sector
+ * header written. Until that header is valid the old head stays in charge,
+ * so a power cut during the move loses nothing. The header counts the
+ * erases of its sector (custom_jnl_get_erase_counts()).
+ */
+
+#ifndef CUSTOM_JOURNAL_H
+#define CUSTOM_JOURNAL_H
+
+#include "typedef.h"
+
+/* Sector ring, in use order. 0x001000 is last so boot info from older
+ * firmware stays readable there until the journal is established. */
+#define CUSTOM_JNL_SECTOR_0     0x04D000    /* Tail of the Bank A range */
+#define CUSTOM_JNL_SECTOR_1     0x099000    /* Tail of the Bank B range */
+#define CUSTOM_JNL_SECTOR_2     0x001000    /* Former boot info sector */
+#define CUSTOM_JNL_SECTORS      3
+
+#define CUSTOM_JNL_SECTOR_MAGIC 0x4C4E4A43  /* 'CJNL' */
+
+/* Record types */
+#define CUSTOM_JNL_TYPE_BOOT_INFO   0x01    /* custom_boot_info_t */
+#define CUSTOM_JNL_TYPE_OTA_META    0x02    /* Reserved for OTA progress metadata */
+#define CUSTOM_JNL_MAX_TYPES        4
+#define CUSTOM_JNL_TYPE_FREE        0xFF    /* Erased flash, end of records */
+
+#define CUSTOM_JNL_MAX_PAYLOAD      64
+
+/* Sector header */
+typedef struct {
+    u32 magic;          /* CUSTOM_JNL_SECTOR_MAGIC */
+    u32 seq;            /* Sector generation, the highest valid one is the head */
+    u32 erase_count;    /* Erases of this sector */
+    u16 crc;            /* CRC16 of the fields above */
+    u16 reserved;
+} custom_jnl_sector_t;
+
+/* Record header */
+typedef struct {
+    u8  type;           /* CUSTOM_JNL_TYPE_* */
+    u8  len;            /* Payload bytes */
+    u16 crc;            /* CRC16 of type, len, seq and payload */
+    u32 seq;            /* Journal-wide record sequence number */
+} custom_jnl_rec_t;
+
+/**
+ * Scan the sector ring and find the latest record of every type
+ * @return 0 on success, negative on read error
+ */
+int custom_jnl_init(void);
+
+/**
+ * Read the latest record of a type
+ * @param type CUSTOM_JNL_TYPE_*
+ * @param buf Output buffer
+ * @param len Buffer size
+ * @return Payload length copied, -1 if there is no record of this type
+ */
+int custom_jnl_read(u8 type, void *buf, u8 len);
+
+/**
+ * Append a record, moving to the next sector when the head is full
+ * @param type CUSTOM_JNL_TYPE_*
+ * @param data Payload
+ * @param len Payload length (up to CUSTOM_JNL_MAX_PAYLOAD)
+ * @return 0 on success, negative on error
+ */
+int custom_jnl_append(u8 type, const void *data, u8 len);
+
+/**
+ * Get the erase count of every ring sector
+ * @param counts Output, CUSTOM_JNL_SECTORS entries
+ */
+void custom_jnl_get_erase_counts(u32 *counts);
+
+/**
+ * Log head sector, fill level and erase counts
+ */
+void custom_jnl_dump(void);
+
+#endif /* CUSTOM_JOURNAL_H */
@@ -0,0 +1,296 @@
+/**
+ * Tiered Advertising Scheduler
+ */
+
+#include "app_config.h"  /* Must be first for SDK configuration */
+#include "vm_adv_scheduler.h"
+#include "vm_config.h"
+#include "vm_long_range.h"
+#include "vm_settings.h"
+
+#include "system/includes.h"
+#include "gatt_common/le_gatt_common.h"
+
+/* Logging */
+#define VM_LOG_TAG      "VM_ADV"
+#define VM_LOG_LEVEL    VM_LOG_LEVEL_ADV
+#include "vm_log.h"
+
+/* Largest interval allowed by the Core spec for legacy advertising */
+#define ADV_INTERVAL_SPEC_MAX   0x4000
+
+static vm_adv_sched_cfg_t g_sched_cfg;
+static adv_cfg_t *g_adv_cfg = NULL;
+static u8 g_tier = VM_ADV_TIER_OFF;
+static u16 g_tier_timeout_id = 0;
+
+static void sched_enter_tier(u8 tier);
+
+int vm_adv_sched_config_is_valid(const vm_adv_sched_cfg_t *cfg)
+{
+    if (cfg->fast_interval < VM_ADV_INTERVAL_MIN || cfg->fast_interval > ADV_INTERVAL_SPEC_MAX) {
+        return 0;
+    }
+    if (cfg->slow_interval < cfg->fast_interval || cfg->slow_interval > ADV_INTERVAL_SPEC_MAX) {
+        return 0;
+    }
+    if (cfg->fast_duration_s == 0) {
+        return 0;
+    }
+    if (cfg->sleep_enable && (cfg->sleep_period_s == 0 || cfg->wake_window_s == 0)) {
+        return 0;
+    }
+    return 1;
+}
+
+static void sched_timeout_cancel(void)
+{
+    if (g_tier_timeout_id) {
+        sys_timeout_del(g_tier_timeout_id);
+        g_tier_timeout_id = 0;
+    }
+}
+
+static void sched_timeout_handler(void *priv)
+{
+    (void)priv;
+
+    g_tier_timeout_id = 0;
+
+    switch (g_tier) {
+    case VM_ADV_TIER_FAST:
+        sched_enter_tier(VM_ADV_TIER_SLOW);
+        break;
+    case VM_ADV_TIER_SLOW:
+    case VM_ADV_TIER_WAKE:
+        sched_enter_tier(VM_ADV_TIER_SLEEP);
+        break;
+    case VM_ADV_TIER_SLEEP:
+        sched_enter_tier(VM_ADV_TIER_WAKE);
+        break;
+    default:
+        break;
+    }
+}
+
+static void sched_timeout_arm(u16 seconds)
+{
+    sched_timeout_cancel();
+    if (seconds) {
+        g_tier_timeout_id = sys_timeout_add(NULL, sched_timeout_handler, (u32)seconds * 1000);
+    }
+}
+
+/*
+ * Apply an interval to the advertising set
+ * The gatt server only reads adv_interval when advertising is (re)enabled,
+ * so an active advertising set is stopped first.
+ */
+static void sched_adv_apply(u16 adv_interval)
+{
+    if (!g_adv_cfg) {
+        return;
+    }
+
+    if (ble_gatt_server_get_work_state() == BLE_ST_ADV) {
+        ble_gatt_server_adv_enable(0);
+    }
+
+    if (adv_interval) {
+        g_adv_cfg->adv_interval = adv_interval;
+        vm_lr_adv_sync();
+        ble_gatt_server_adv_enable(1);
+    }
+}
+
+static void sched_enter_tier(u8 tier)
+{
+    g_tier = tier;
+
+    switch (tier) {
+    case VM_ADV_TIER_FAST:
+        sched_adv_apply(g_sched_cfg.fast_interval);
+        sched_timeout_arm(g_sched_cfg.fast_duration_s);
+        break;
+
+    case VM_ADV_TIER_SLOW:
+        sched_adv_apply(g_sched_cfg.slow_interval);
+        /* Without sleep, SLOW runs until the next trigger or connection */
+        sched_timeout_arm(g_sched_cfg.sleep_enable ? g_sched_cfg.slow_duration_s : 0);
+        if (g_sched_cfg.sleep_enable && g_sched_cfg.slow_duration_s == 0) {
+            sched_enter_tier(VM_ADV_TIER_SLEEP);
+        }
+        break;
+
+    case VM_ADV_TIER_SLEEP:
+        sched_adv_apply(0);
+        sched_timeout_arm(g_sched_cfg.sleep_period_s);
+        break;
+
+    case VM_ADV_TIER_WAKE:
+        sched_adv_apply(g_sched_cfg.slow_interval);
+        sched_timeout_arm(g_sched_cfg.wake_window_s);
+        break;
+
+    default:
+        sched_timeout_cancel();
+        break;
+    }
+
+    log_info("tier=%d\n", g_tier);
+}
+
+int vm_adv_sched_init(void *adv_cfg)
+{
+    g_adv_cfg = (adv_cfg_t *)adv_cfg;
+    g_tier = VM_ADV_TIER_OFF;
+    g_tier_timeout_id = 0;
+
+    /* Validated when the settings were loaded */
+    memcpy(&g_sched_cfg, &vm_settings_get()->adv, sizeof(g_sched_cfg));
+
+    /* The scheduler owns advertising enable/disable from here on */
+    if (g_adv_cfg) {
+        g_adv_cfg->adv_auto_do = 0;
+        g_adv_cfg->adv_interval = g_sched_cfg.fast_interval;
+    }
+
+    log_info("fast=%d/%ds slow=%d/%ds sleep=%d (%ds off, %ds on)\n",
+             g_sched_cfg.fast_interval, g_sched_cfg.fast_duration_s,
+             g_sched_cfg.slow_interval, g_sched_cfg.slow_duration_s,
+             g_sched_cfg.sleep_enable, g_sched_cfg.sleep_period_s, g_sched_cfg.wake_window_s);
+    log_info("estimated avg current: fast=%duA slow=%duA first hour=%duA\n",
+             vm_adv_sched_tier_current_ua(g_sched_cfg.fast_interval),
+             vm_adv_sched_tier_current_ua(g_sched_cfg.slow_interval),
+             vm_adv_sched_estimate_avg_ua(&g_sched_cfg, 3600));
+
+    return 0;
+}
+
+void vm_adv_sched_trigger(u8 reason)
+{
+    if (g_tier == VM_ADV_TIER_CONNECTED && reason != VM_ADV_TRIGGER_DISCONNECT) {
+        return;
+    }
+
+    log_info("trigger reason=%d\n", reason);
+    sched_enter_tier(VM_ADV_TIER_FAST);
+}
+
+void vm_adv_sched_stop(void)
+{
+    sched_timeout_cancel();
+    sched_adv_apply(0);
+    g_tier = VM_ADV_TIER_OFF;
+}
+
+void vm_adv_sched_on_connect(void)
+{
+    sched_timeout_cancel();
+    g_tier = VM_ADV_TIER_CONNECTED;
+}
+
+void vm_adv_sched_on_connect_fail(void)
+{
+    if (g_tier == VM_ADV_TIER_CONNECTED) {
+        sched_enter_tier(VM_ADV_TIER_FAST);
+        return;
+    }
+
+    /* Re-enable advertising for the current tier without resetting its timer */
+    switch (g_tier) {
+    case VM_ADV_TIER_FAST:
+        sched_adv_apply(g_sched_cfg.fast_interval);
+        break;
+    case VM_ADV_TIER_SLOW:
+    case VM_ADV_TIER_WAKE:
+        sched_adv_apply(g_sched_cfg.slow_interval);
+        break;
+    default:
+        break;
+    }
+}
+
+int vm_adv_sched_set_config(const vm_adv_sched_cfg_t *cfg)
+{
+    if (!cfg || !vm_adv_sched_config_is_valid(cfg)) {
+        log_error("Rejected invalid schedule\n");
+        return -1;
+    }
+
+    memcpy(&g_sched_cfg, cfg, sizeof(g_sched_cfg));
+    g_sched_cfg.reserved = 0;
+
+    /* Restart the schedule with the new timing unless connected */
+    if (g_tier != VM_ADV_TIER_CONNECTED && g_tier != VM_ADV_TIER_OFF) {
+        sched_enter_tier(VM_ADV_TIER_FAST);
+    }
+
+    return 0;
+}
+
+const vm_adv_sched_cfg_t *vm_adv_sched_get_config(void)
+{
+    return &g_sched_cfg;
+}
+
+u8 vm_adv_sched_get_tier(void)
+{
+    return g_tier;
+}
+
+/*
+ * Energy model
+ *
+ * avg_current = baseline + charge_per_event / adv_period
+ * adv_period[s] = interval * 0.625ms  =>  events/s = 1600 / interval
+ * Everything is computed in nA to keep integer precision.
+ */
+static u32 sched_tier_current_na(u16 adv_interval)
+{
+    u32 na = (u32)VM_ENERGY_SLEEP_UA * 1000;
+
+    if (adv_interval) {
+        na += (u32)(((u64)VM_ENERGY_ADV_EVENT_NC * 1600) / adv_interval);
+    }
+    return na;
+}
+
+u32 vm_adv_sched_tier_current_ua(u16 adv_interval)
+{
+    return sched_tier_current_na(adv_interval) / 1000;
+}
+
+/* Accumulate charge (nA*s) of one phase, clipped to the remaining horizon */
+static u32 sched_phase(u64 *charge, u32 remaining_s, u32 phase_s, u16 adv_interval)
+{
+    if (phase_s > remaining_s) {
+        phase_s = remaining_s;
+    }
+    *charge += (u64)phase_s * sched_tier_current_na(adv_interval);
+    return remaining_s - phase_s;
+}
+
+u32 vm_adv_sched_estimate_avg_ua(const vm_adv_sched_cfg_t *cfg, u32 horizon_s)
+{
+    u64 charge = 0;
+    u32 remaining = horizon_s;
+
+    if (!cfg || horizon_s == 0) {
+        return cfg ? vm_adv_sched_tier_current_ua(cfg->fast_interval) : 0;
+    }
+
+    remaining = sched_phase(&charge, remaining, cfg->fast_duration_s, cfg->fast_interval);
+
+    if (!cfg->sleep_enable) {
+        sched_phase(&charge, remaining, remaining, cfg->slow_interval);
+    } else {
+        remaining = sched_phase(&charge, remaining, cfg->slow_duration_s, cfg->slow_interval);
+        while (remaining) {
+            remaining = sched_phase(&charge, remaining, cfg->sleep_period_s, 0);
+            remaining = sched_phase(&charge, remaining, cfg->wake_window_s, cfg->slow_interval);
+        }
+    }
+
+    return (u32)(charge / horizon_s / 1000);
+}
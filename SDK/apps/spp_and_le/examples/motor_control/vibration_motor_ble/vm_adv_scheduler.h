@@ -0,0 +1,120 @@
+/**
+ * Tiered Advertising Scheduler
+ *
+ * Trades discoverability against battery life while no central is connected:
+ *
+ *   trigger (power-on / disconnect / button)
+ *      |
+ *      v
+ *   FAST  -- fast_duration_s -->  SLOW  -- slow_duration_s -->  SLEEP <--> WAKE
+ *   (fast_interval)               (slow_interval)               (adv off) (slow_interval
+ *                                                                           for wake_window_s)
+ *
+ * SLEEP/WAKE cycling is only used when sleep_enable is set, otherwise SLOW
+ * runs until the next trigger or connection. Any trigger restarts FAST.
+ *
+ * The schedule is part of the user settings (vm_settings.h), which persist
+ * it and hand changes to vm_adv_sched_set_config().
+ */
+
+#ifndef VM_ADV_SCHEDULER_H
+#define VM_ADV_SCHEDULER_H
+
+#include "typedef.h"
+
+/* Scheduler tiers */
+#define VM_ADV_TIER_OFF         0   /* Scheduler not started */
+#define VM_ADV_TIER_FAST        1
+#define VM_ADV_TIER_SLOW        2
+#define VM_ADV_TIER_SLEEP       3   /* Advertising disabled until next wake window */
+#define VM_ADV_TIER_WAKE        4   /* Periodic wake window while sleeping */
+#define VM_ADV_TIER_CONNECTED   5
+
+/* Trigger reasons (restart the FAST tier) */
+#define VM_ADV_TRIGGER_POWER_ON     0
+#define VM_ADV_TRIGGER_DISCONNECT   1
+#define VM_ADV_TRIGGER_BUTTON       2
+
+/* Schedule (stored as-is in vm_settings_t, keep packed size stable) */
+typedef struct {
+    u16 fast_interval;      /* Fast tier interval (units of 0.625ms) */
+    u16 slow_interval;      /* Slow/wake tier interval (units of 0.625ms) */
+    u16 fast_duration_s;    /* Time spent in FAST after a trigger */
+    u16 slow_duration_s;    /* Time spent in SLOW before SLEEP (if enabled) */
+    u16 sleep_period_s;     /* Advertising-off time between wake windows */
+    u16 wake_window_s;      /* Advertising-on time of each wake window */
+    u8  sleep_enable;       /* 1 = enter SLEEP/WAKE cycling after SLOW */
+    u8  reserved;
+} vm_adv_sched_cfg_t;
+
+/**
+ * Initialize scheduler with the schedule from the user settings
+ * Advertising is not started until the first trigger
+ * @param adv_cfg Advertising config registered with ble_gatt_server_set_adv_config()
+ * @return 0 on success
+ */
+int vm_adv_sched_init(void *adv_cfg);
+
+/**
+ * Restart the FAST tier (power-on, disconnect, button press)
+ * Ignored while a central is connected
+ * @param reason VM_ADV_TRIGGER_*
+ */
+void vm_adv_sched_trigger(u8 reason);
+
+/**
+ * Stop scheduler timers and advertising (BLE shutdown)
+ */
+void vm_adv_sched_stop(void);
+
+/**
+ * Notify scheduler that a central connected (stops tier timers)
+ */
+void vm_adv_sched_on_connect(void);
+
+/**
+ * Notify scheduler that a connection attempt failed
+ * Re-applies the current tier since the stack does not restart advertising
+ */
+void vm_adv_sched_on_connect_fail(void);
+
+/**
+ * Check a schedule (intervals, durations, sleep timing)
+ * @return 1 if usable
+ */
+int vm_adv_sched_config_is_valid(const vm_adv_sched_cfg_t *cfg);
+
+/**
+ * Validate and apply a new schedule (persisting is up to vm_settings)
+ * @param cfg New schedule
+ * @return 0 on success, -1 if invalid
+ */
+int vm_adv_sched_set_config(const vm_adv_sched_cfg_t *cfg);
+
+/**
+ * Get active schedule
+ */
+const vm_adv_sched_cfg_t *vm_adv_sched_get_config(void);
+
+/**
+ * Get current tier (VM_ADV_TIER_*)
+ */
+u8 vm_adv_sched_get_tier(void);
+
+/**
+ * Energy model: average current of one advertising tier
+ * @param adv_interval Interval in units of 0.625ms, 0 = advertising off
+ * @return Average current in uA (baseline sleep current included)
+ */
+u32 vm_adv_sched_tier_current_ua(u16 adv_interval);
+
+/**
+ * Energy model: average current over the first horizon_s seconds after a trigger
+ * Pure function of the schedule and VM_ENERGY_* constants, usable on host builds
+ * @param cfg Schedule to evaluate
+ * @param horizon_s Evaluation window in seconds (e.g. 3600 for the first hour)
+ * @return Average current in uA
+ */
+u32 vm_adv_sched_estimate_avg_ua(const vm_adv_sched_cfg_t *cfg, u32 horizon_s);
+
+#endif /* VM_ADV_SCHEDULER_H */
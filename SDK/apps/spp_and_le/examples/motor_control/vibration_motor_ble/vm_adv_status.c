@@ -0,0 +1,56 @@
+/**
+ * Connectionless Status (Manufacturer Specific AD)
+ */
+
+#include "app_config.h"  /* Must be first for SDK configuration */
+#include "vm_adv_status.h"
+#include "vm_config.h"
+#include "vm_ble_service.h"
+#include "vm_motor_control.h"
+#include "custom_dual_bank_ota.h"
+#include "vm_governor.h"
+
+void vm_adv_status_collect(vm_adv_status_t *st)
+{
+    u8 battery = vm_ble_get_battery_level();
+
+    st->battery = battery;
+    st->fw_low = VM_FIRMWARE_VERSION_LOW;
+    st->fw_high = VM_FIRMWARE_VERSION_HIGH;
+    st->flags = 0;
+
+    if (custom_dual_bank_get_active_bank() == 1) {
+        st->flags |= VM_ADV_STATUS_FLAG_BANK_B;
+    }
+    if (vm_motor_get_duty() > 0) {
+        st->flags |= VM_ADV_STATUS_FLAG_MOTOR_ON;
+    }
+    if (custom_dual_bank_ota_get_state() != CUSTOM_OTA_STATE_IDLE) {
+        st->flags |= VM_ADV_STATUS_FLAG_OTA_ACTIVE;
+    }
+    if (battery != VM_ADV_STATUS_BATTERY_UNKNOWN && battery <= VM_ADV_STATUS_BATTERY_LOW_PCT) {
+        st->flags |= VM_ADV_STATUS_FLAG_BATTERY_LOW;
+    }
+    if (vm_governor_get()->ceiling < VM_MOTOR_DUTY_MAX) {
+        st->flags |= VM_ADV_STATUS_FLAG_LIMITED;
+    }
+}
+
+u8 vm_adv_status_encode(u8 *buf, u8 buf_size, const vm_adv_status_t *st)
+{
+    if (!buf || !st || buf_size < VM_ADV_STATUS_AD_SIZE) {
+        return 0;
+    }
+
+    buf[0] = VM_ADV_STATUS_PAYLOAD_SIZE + 1;   /* AD length covers type + payload */
+    buf[1] = VM_ADV_STATUS_AD_TYPE;
+    buf[2] = VM_ADV_STATUS_COMPANY_ID & 0xFF;
+    buf[3] = (VM_ADV_STATUS_COMPANY_ID >> 8) & 0xFF;
+    buf[4] = VM_ADV_STATUS_TAG;
+    buf[5] = st->battery;
+    buf[6] = st->fw_low;
+    buf[7] = st->fw_high;
+    buf[8] = st->flags;
+
+    return VM_ADV_STATUS_AD_SIZE;
+}
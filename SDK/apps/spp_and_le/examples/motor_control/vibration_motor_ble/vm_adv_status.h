@@ -0,0 +1,62 @@
+/**
+ * Connectionless Status (Manufacturer Specific AD)
+ *
+ * Lets a scanner show battery, firmware and state without connecting.
+ * Carried in the scan response as one manufacturer specific AD structure:
+ *
+ *   [len=0x08][type=0xFF][company_lo][company_hi][tag][battery][fw_low][fw_high][flags]
+ *
+ *   company  VM_ADV_STATUS_COMPANY_ID (little-endian)
+ *   tag      VM_ADV_STATUS_TAG, payload format version
+ *   battery  0-100 %, VM_ADV_STATUS_BATTERY_UNKNOWN if not available
+ *   fw       VM_FIRMWARE_VERSION_LOW / VM_FIRMWARE_VERSION_HIGH
+ *   flags    VM_ADV_STATUS_FLAG_*
+ *
+ * The host-side decoder lives in the client (utils/adv-status.js) and must
+ * be kept in sync with this layout.
+ */
+
+#ifndef VM_ADV_STATUS_H
+#define VM_ADV_STATUS_H
+
+#include "typedef.h"
+
+/* AD structure layout */
+#define VM_ADV_STATUS_AD_TYPE           0xFF    /* Manufacturer Specific Data */
+#define VM_ADV_STATUS_TAG               0xB1    /* Status payload v1 */
+#define VM_ADV_STATUS_PAYLOAD_SIZE      7       /* Company ID + tag + battery + fw + flags */
+#define VM_ADV_STATUS_AD_SIZE           (2 + VM_ADV_STATUS_PAYLOAD_SIZE)
+
+#define VM_ADV_STATUS_BATTERY_UNKNOWN   0xFF
+
+/* Flags byte */
+#define VM_ADV_STATUS_FLAG_BANK_B       0x01    /* Running from bank B */
+#define VM_ADV_STATUS_FLAG_MOTOR_ON     0x02    /* Motor duty > 0 */
+#define VM_ADV_STATUS_FLAG_OTA_ACTIVE   0x04    /* OTA transfer/commit in progress */
+#define VM_ADV_STATUS_FLAG_BATTERY_LOW  0x08    /* Battery <= VM_ADV_STATUS_BATTERY_LOW_PCT */
+#define VM_ADV_STATUS_FLAG_LIMITED      0x10    /* Governor holds the duty ceiling below 100 % */
+
+typedef struct {
+    u8 battery;         /* 0-100 %, VM_ADV_STATUS_BATTERY_UNKNOWN if not available */
+    u8 fw_low;
+    u8 fw_high;
+    u8 flags;           /* VM_ADV_STATUS_FLAG_* */
+} vm_adv_status_t;
+
+/**
+ * Snapshot current device status
+ * @param st Output status
+ */
+void vm_adv_status_collect(vm_adv_status_t *st);
+
+/**
+ * Encode status as a manufacturer specific AD structure
+ * Pure function, usable on host builds
+ * @param buf Output buffer (AD structure is appended at buf[0])
+ * @param buf_size Space left in the advertising/scan response buffer
+ * @param st Status to encode
+ * @return Bytes written (VM_ADV_STATUS_AD_SIZE), 0 if it does not fit
+ */
+u8 vm_adv_status_encode(u8 *buf, u8 buf_size, const vm_adv_status_t *st);
+
+#endif /* VM_ADV_STATUS_H */
@@ -0,0 +1,173 @@
+/**
+ * Battery Monitor
+ */
+
+#include "app_config.h"  /* Must be first for SDK configuration */
+#include "vm_battery.h"
+#include "vm_config.h"
+#include "vm_motor_control.h"
+
+#include "system/includes.h"
+#include "asm/adc_api.h"
+
+/* Logging */
+#define VM_LOG_TAG      "VM_BAT"
+#define VM_LOG_LEVEL    VM_LOG_LEVEL_BAT
+#include "vm_log.h"
+
+#if (VM_BAT_CELLS < 1)
+#error "VM_BAT_CELLS must be at least 1"
+#endif
+
+/* Li-ion / LiPo open-circuit voltage per cell at 0, 10, ... 100 % (mV) */
+static const u16 g_ocv_table[] = {
+    3300, 3600, 3680, 3730, 3770, 3800, 3850, 3920, 4000, 4080, 4180,
+};
+
+#define OCV_POINTS  (sizeof(g_ocv_table) / sizeof(g_ocv_table[0]))
+#define OCV_STEP    (100 / (OCV_POINTS - 1))
+
+static vm_bat_est_t g_est = {
+    .percent = VM_BAT_PERCENT_UNKNOWN,
+};
+static u16 g_poll_timer = 0;
+
+/* ========== Estimator ========== */
+
+void vm_bat_est_reset(vm_bat_est_t *est)
+{
+    memset(est, 0, sizeof(*est));
+    est->since_change_ms = VM_BAT_SETTLE_MS;
+    est->percent = VM_BAT_PERCENT_UNKNOWN;
+}
+
+u16 vm_bat_compensate_mv(u16 vbat_mv, u16 duty)
+{
+    u32 mv;
+
+    if (duty > 10000) {
+        duty = 10000;
+    }
+    mv = vbat_mv + (u32)VM_BAT_LOAD_DROP_MV * duty / 10000;
+    return (mv > 0xFFFF) ? 0xFFFF : (u16)mv;
+}
+
+u8 vm_bat_cell_mv_to_percent(u16 cell_mv)
+{
+    u8 i;
+
+    if (cell_mv <= g_ocv_table[0]) {
+        return 0;
+    }
+    if (cell_mv >= g_ocv_table[OCV_POINTS - 1]) {
+        return 100;
+    }
+
+    for (i = 1; i < OCV_POINTS; i++) {
+        if (cell_mv < g_ocv_table[i]) {
+            u16 lo = g_ocv_table[i - 1];
+            u16 span = g_ocv_table[i] - lo;
+            /* Linear between points, rounded to the nearest percent */
+            return (i - 1) * OCV_STEP + ((u32)(cell_mv - lo) * OCV_STEP + span / 2) / span;
+        }
+    }
+    return 100;
+}
+
+u8 vm_bat_est_step(vm_bat_est_t *est, u16 vbat_mv, u16 duty, u32 elapsed_ms)
+{
+    s32 sample;
+    u8 percent;
+
+    if (duty != est->last_duty) {
+        est->last_duty = duty;
+        est->since_change_ms = 0;
+    } else if (est->since_change_ms < VM_BAT_SETTLE_MS) {
+        est->since_change_ms += elapsed_ms;
+    }
+    est->stale_ms += elapsed_ms;
+
+    /* The first sample is always taken so there is a value to report */
+    if (est->has_value) {
+        if (est->since_change_ms < VM_BAT_SETTLE_MS) {
+            return 0;
+        }
+        if (duty > VM_BAT_GATE_DUTY && est->stale_ms < VM_BAT_MAX_STALE_MS) {
+            return 0;
+        }
+    }
+
+    sample = (s32)vm_bat_compensate_mv(vbat_mv, duty) * 16;
+
+    /* Exponential moving average, alpha = 1/VM_BAT_EMA_DIV */
+    if (!est->has_value) {
+        est->ocv_q4 = sample;
+        est->has_value = 1;
+    } else {
+        est->ocv_q4 += (sample - est->ocv_q4) / VM_BAT_EMA_DIV;
+    }
+    est->stale_ms = 0;
+
+    est->ocv_mv = (u16)(est->ocv_q4 / 16);
+    percent = vm_bat_cell_mv_to_percent(est->ocv_mv / VM_BAT_CELLS);
+
+    /*
+     * Follow drops at once, but only rise by a real step (charging, not noise).
+     * Right after a rise the filter sits on a rounding edge, a 1 % dip there
+     * is noise too
+     */
+    if (est->percent == VM_BAT_PERCENT_UNKNOWN || percent >= est->percent + VM_BAT_RISE_HYST_PCT) {
+        est->percent = percent;
+        est->rising = 1;
+    } else if (percent + est->rising < est->percent) {
+        est->percent = percent;
+        est->rising = 0;
+    }
+    return 1;
+}
+
+/* ========== Sampling ========== */
+
+static u16 battery_read_mv(void)
+{
+    /* Averaged by the adc_scan timer; VBAT is measured through a 1/4 divider */
+    return adc_get_voltage(AD_CH_VBAT) * 4;
+}
+
+static void battery_poll(void *priv)
+{
+    (void)priv;
+
+    vm_bat_est_step(&g_est, battery_read_mv(), vm_motor_get_duty(), VM_BAT_POLL_MS);
+}
+
+void vm_battery_init(void)
+{
+    u16 mv = battery_read_mv();
+
+    vm_bat_est_reset(&g_est);
+    vm_bat_est_step(&g_est, mv, vm_motor_get_duty(), 0);
+    log_info("vbat=%dmV, soc=%d%%\n", g_est.ocv_mv, g_est.percent);
+
+    if (!g_poll_timer) {
+        g_poll_timer = sys_timer_add(NULL, battery_poll, VM_BAT_POLL_MS);
+    }
+}
+
+void vm_battery_deinit(void)
+{
+    if (g_poll_timer) {
+        sys_timer_del(g_poll_timer);
+        g_poll_timer = 0;
+    }
+}
+
+u8 vm_battery_get_percent(void)
+{
+    return g_est.percent;
+}
+
+u16 vm_battery_get_mv(void)
+{
+    return g_est.ocv_mv;
+}
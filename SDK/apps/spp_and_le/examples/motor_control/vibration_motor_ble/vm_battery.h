@@ -0,0 +1,96 @@
+/**
+ * Battery Monitor
+ *
+ * Background state-of-charge estimate for the device info query and the
+ * connectionless status. The SDK adc_scan timer already samples AD_CH_VBAT
+ * into an averaging buffer, so the poll timer here only reads that average
+ * every VM_BAT_POLL_MS and never starts a conversion itself.
+ *
+ * The motor pulls the pack down by its internal resistance, and the ADC
+ * average spans many PWM periods, so a reading under load is lower by
+ * roughly duty * VM_BAT_LOAD_DROP_MV. Each sample is:
+ * - corrected by that duty-proportional drop
+ * - skipped for VM_BAT_SETTLE_MS after a duty change (voltage recovery)
+ * - skipped above VM_BAT_GATE_DUTY, unless no sample was accepted for
+ *   VM_BAT_MAX_STALE_MS (continuous full-power use)
+ * - low-pass filtered (EMA, alpha 1/VM_BAT_EMA_DIV)
+ * - mapped per cell through a Li-ion open-circuit voltage table
+ * - reported downward at once, upward only by VM_BAT_RISE_HYST_PCT or more
+ *   (and not back down by 1 % right after a rise)
+ *
+ * The result is cached, vm_battery_get_percent() is a plain load.
+ */
+
+#ifndef VM_BATTERY_H
+#define VM_BATTERY_H
+
+#include "typedef.h"
+
+/* Reported before the first sample */
+#define VM_BAT_PERCENT_UNKNOWN  0xFF
+
+/* Estimator (pure state, usable on host builds) */
+typedef struct {
+    s32 ocv_q4;             /* Filtered open-circuit pack voltage in 1/16 mV */
+    u32 since_change_ms;    /* Time since the motor duty last changed */
+    u32 stale_ms;           /* Time since the last accepted sample */
+    u16 last_duty;          /* Duty seen with the previous sample */
+    u16 ocv_mv;             /* Filtered open-circuit pack voltage in mV */
+    u8  percent;            /* 0-100, VM_BAT_PERCENT_UNKNOWN before the first sample */
+    u8  has_value;          /* ocv_q4 holds at least one sample */
+    u8  rising;             /* Last reported change was a rise */
+} vm_bat_est_t;
+
+/**
+ * Reset estimator (no value until the next accepted sample)
+ */
+void vm_bat_est_reset(vm_bat_est_t *est);
+
+/**
+ * Feed one pack voltage sample
+ * @param est Estimator
+ * @param vbat_mv Measured pack voltage in mV
+ * @param duty Motor duty at the time of the sample (0-10000)
+ * @param elapsed_ms Time since the previous sample
+ * @return 1 if the sample was used, 0 if it was skipped
+ */
+u8 vm_bat_est_step(vm_bat_est_t *est, u16 vbat_mv, u16 duty, u32 elapsed_ms);
+
+/**
+ * Correct a loaded pack voltage for the motor drop
+ * @param vbat_mv Measured pack voltage in mV
+ * @param duty Motor duty (0-10000)
+ * @return Estimated open-circuit pack voltage in mV
+ */
+u16 vm_bat_compensate_mv(u16 vbat_mv, u16 duty);
+
+/**
+ * Map one cell's open-circuit voltage to state of charge
+ * @param cell_mv Cell voltage in mV
+ * @return 0-100 %
+ */
+u8 vm_bat_cell_mv_to_percent(u16 cell_mv);
+
+/**
+ * Take a first sample and start the background poll timer
+ */
+void vm_battery_init(void);
+
+/**
+ * Stop the poll timer (the last estimate stays cached)
+ */
+void vm_battery_deinit(void);
+
+/**
+ * Get cached state of charge
+ * @return 0-100 %, VM_BAT_PERCENT_UNKNOWN before vm_battery_init()
+ */
+u8 vm_battery_get_percent(void);
+
+/**
+ * Get cached filtered open-circuit pack voltage
+ * @return mV, 0 before vm_battery_init()
+ */
+u16 vm_battery_get_mv(void);
+
+#endif /* VM_BATTERY_H */
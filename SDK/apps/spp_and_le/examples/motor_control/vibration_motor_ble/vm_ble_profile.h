@@ -16,6 +16,18 @@
  *   Property: Read
  *   Response: 6 bytes (header, cmd, motor_count, fw_low, fw_high, battery)
  * 
+ * Diagnostics Characteristic UUID: 9A541A2D-594F-4E2B-B123-5F739A2D594F
+ *   Property: Read
+ *   Response: memory pool counters (see vm_mem_pool.h)
+ * 
+ * Settings Characteristic UUID: 9A551A2D-594F-4E2B-B123-5F739A2D594F
+ *   Property: Write, Notify
+ *   Get/set user settings by key (see vm_settings.h)
+ * 
+ * Sync Characteristic UUID: 9A561A2D-594F-4E2B-B123-5F739A2D594F
+ *   Property: Write Without Response, Notify
+ *   Clock exchange and timed duty changes (see vm_sync.h)
+ * 
  * Security: LESC + Just-Works (enforced by stack)
  * 
  * Profile format based on SDK/apps/spp_and_le/examples/trans_data/ble_trans_profile.h
@@ -84,6 +96,57 @@ static const uint8_t vm_motor_profile_data[] = {
     // 0x0009 CLIENT_CHARACTERISTIC_CONFIGURATION (for OTA notifications)
     0x08, 0x00, 0x0a, 0x01, 0x09, 0x00, 0x02, 0x29,
 
+    /* CHARACTERISTIC, 9A541A2D-594F-4E2B-B123-5F739A2D594F, READ | DYNAMIC */
+    // 0x000A CHARACTERISTIC 9A541A2D... READ | DYNAMIC (Diagnostics)
+    0x1b, 0x00, 0x02, 0x00, 0x0a, 0x00, 0x03, 0x28,
+    0x02,  // Property: READ (0x02)
+    0x0b, 0x00,  // Value handle
+    // UUID bytes (little-endian): 9A541A2D-594F-4E2B-B123-5F739A2D594F
+    0x4F, 0x59, 0x2D, 0x9A, 0x73, 0x5F, 0x23, 0xB1,
+    0x2B, 0x4E, 0x4F, 0x59, 0x2D, 0x1A, 0x54, 0x9A,
+
+    // 0x000B VALUE 9A541A2D... READ | DYNAMIC
+    0x16, 0x00, 0x02, 0x03, 0x0b, 0x00,
+    // UUID bytes (little-endian): 9A541A2D-594F-4E2B-B123-5F739A2D594F
+    0x4F, 0x59, 0x2D, 0x9A, 0x73, 0x5F, 0x23, 0xB1,
+    0x2B, 0x4E, 0x4F, 0x59, 0x2D, 0x1A, 0x54, 0x9A,
+
+    /* CHARACTERISTIC, 9A551A2D-594F-4E2B-B123-5F739A2D594F, WRITE | NOTIFY | DYNAMIC */
+    // 0x000C CHARACTERISTIC 9A551A2D... WRITE | NOTIFY | DYNAMIC (Settings)
+    0x1b, 0x00, 0x02, 0x00, 0x0c, 0x00, 0x03, 0x28,
+    0x18,  // Property: WRITE (0x08) | NOTIFY (0x10) = 0x18
+    0x0d, 0x00,  // Value handle
+    // UUID bytes (little-endian): 9A551A2D-594F-4E2B-B123-5F739A2D594F
+    0x4F, 0x59, 0x2D, 0x9A, 0x73, 0x5F, 0x23, 0xB1,
+    0x2B, 0x4E, 0x4F, 0x59, 0x2D, 0x1A, 0x55, 0x9A,
+
+    // 0x000D VALUE 9A551A2D... WRITE | NOTIFY | DYNAMIC
+    0x16, 0x00, 0x08, 0x01, 0x0d, 0x00,
+    // UUID bytes (little-endian): 9A551A2D-594F-4E2B-B123-5F739A2D594F
+    0x4F, 0x59, 0x2D, 0x9A, 0x73, 0x5F, 0x23, 0xB1,
+    0x2B, 0x4E, 0x4F, 0x59, 0x2D, 0x1A, 0x55, 0x9A,
+
+    // 0x000E CLIENT_CHARACTERISTIC_CONFIGURATION (for settings responses)
+    0x08, 0x00, 0x0a, 0x01, 0x0e, 0x00, 0x02, 0x29,
+
+    /* CHARACTERISTIC, 9A561A2D-594F-4E2B-B123-5F739A2D594F, WRITE_WITHOUT_RESPONSE | NOTIFY | DYNAMIC */
+    // 0x000F CHARACTERISTIC 9A561A2D... WRITE_WITHOUT_RESPONSE | NOTIFY | DYNAMIC (Sync)
+    0x1b, 0x00, 0x02, 0x00, 0x0f, 0x00, 0x03, 0x28,
+    0x14,  // Property: WRITE_WITHOUT_RESPONSE (0x04) | NOTIFY (0x10) = 0x14
+    0x10, 0x00,  // Value handle
+    // UUID bytes (little-endian): 9A561A2D-594F-4E2B-B123-5F739A2D594F
+    0x4F, 0x59, 0x2D, 0x9A, 0x73, 0x5F, 0x23, 0xB1,
+    0x2B, 0x4E, 0x4F, 0x59, 0x2D, 0x1A, 0x56, 0x9A,
+
+    // 0x0010 VALUE 9A561A2D... WRITE_WITHOUT_RESPONSE | NOTIFY | DYNAMIC
+    0x16, 0x00, 0x04, 0x01, 0x10, 0x00,
+    // UUID bytes (little-endian): 9A561A2D-594F-4E2B-B123-5F739A2D594F
+    0x4F, 0x59, 0x2D, 0x9A, 0x73, 0x5F, 0x23, 0xB1,
+    0x2B, 0x4E, 0x4F, 0x59, 0x2D, 0x1A, 0x56, 0x9A,
+
+    // 0x0011 CLIENT_CHARACTERISTIC_CONFIGURATION (for sync responses)
+    0x08, 0x00, 0x0a, 0x01, 0x11, 0x00, 0x02, 0x29,
+
     // END
     0x00, 0x00,
 };
@@ -94,5 +157,10 @@ static const uint8_t vm_motor_profile_data[] = {
 #define ATT_CHARACTERISTIC_VM_DEVICE_INFO_CLIENT_CONFIGURATION_HANDLE 0x0006
 #define ATT_CHARACTERISTIC_VM_OTA_VALUE_HANDLE           0x0008
 #define ATT_CHARACTERISTIC_VM_OTA_CLIENT_CONFIGURATION_HANDLE 0x0009
+#define ATT_CHARACTERISTIC_VM_DIAG_VALUE_HANDLE          0x000b
+#define ATT_CHARACTERISTIC_VM_SETTINGS_VALUE_HANDLE      0x000d
+#define ATT_CHARACTERISTIC_VM_SETTINGS_CLIENT_CONFIGURATION_HANDLE 0x000e
+#define ATT_CHARACTERISTIC_VM_SYNC_VALUE_HANDLE          0x0010
+#define ATT_CHARACTERISTIC_VM_SYNC_CLIENT_CONFIGURATION_HANDLE 0x0011
 
 #endif /* VM_BLE_PROFILE_H */
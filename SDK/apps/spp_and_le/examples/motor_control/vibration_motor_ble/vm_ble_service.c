@@ -13,10 +13,23 @@
 #include "update/dual_bank_updata_api.h"  /* For OTA update */
 #include "system/includes.h"  /* For cpu_reset() */
 #include "custom_dual_bank_ota.h"  /* Custom dual-bank OTA implementation */
-
-/* Logging - RE-ENABLED for custom OTA debugging */
-#define log_info(fmt, ...)   printf("[INFO] " fmt, ##__VA_ARGS__)
-#define log_error(fmt, ...)  printf("[ERROR] " fmt, ##__VA_ARGS__)
+#include "vm_long_range.h"  /* PHY / RSSI for link query */
+#include "vm_mem_pool.h"  /* Pool counters for diagnostics read */
+#include "vm_battery.h"  /* Cached battery estimate */
+#include "vm_power.h"  /* Power state statistics */
+#include "vm_settings.h"  /* User settings get/set */
+#include "vm_governor.h"  /* Thermal / current limit */
+#include "vm_trace.h"  /* Latency tracepoints */
+#include "vm_sync.h"  /* Synchronized playback */
+
+/* Logging */
+#define VM_LOG_TAG      "VM_BLE"
+#define VM_LOG_LEVEL    VM_LOG_LEVEL_BLE
+#include "vm_log.h"
+
+#if (VM_DEVICE_INFO_LOG_RESPONSE_MAX - 3) < VM_LOG_RECORD_MAX
+#error "Log query response must hold one record"
+#endif
 
 /* Connection handle for notifications */
 static uint16_t vm_connection_handle = 0;
@@ -25,6 +38,23 @@ static uint16_t vm_connection_handle = 0;
 /* State is now managed by custom_dual_bank_ota.c */
 /* Use custom_dual_bank_ota_get_state() to check state */
 static uint16_t ota_current_sequence = 0;  /* Track current packet sequence for ACK */
+static uint16_t ota_next_seq = 0;          /* Next DATA chunk to write */
+static uint16_t ota_att_mtu = 23;          /* ATT MTU of the link, for READY */
+
+/* OTA commit, stepped by a timer after FINISH instead of inside the write callback:
+ * RUNNING (CRC pass, boot info) -> SUCCESS_PENDING (notification not queued yet)
+ * -> SUCCESS_QUEUED (waiting for CAN_SEND_NOW) -> RESET */
+#define OTA_COMMIT_IDLE             0
+#define OTA_COMMIT_RUNNING          1
+#define OTA_COMMIT_SUCCESS_PENDING  2
+#define OTA_COMMIT_SUCCESS_QUEUED   3
+#define OTA_COMMIT_RESET            4
+
+static uint8_t ota_commit_phase = OTA_COMMIT_IDLE;
+static uint8_t ota_commit_reported = 0;   /* Last verify progress notified */
+static uint16_t ota_commit_conn = 0;      /* Connection that sent FINISH, 0 after disconnect */
+static uint16_t ota_commit_timer = 0;
+static uint16_t ota_commit_fallback = 0;  /* Reset armed in case the SUCCESS is never confirmed */
 
 /* Forward declarations */
 static void ota_send_notification(uint16_t conn_handle, uint8_t status, uint8_t value);
@@ -49,8 +79,7 @@ int vm_ble_handle_motor_write(uint16_t conn_handle, const uint8_t *data, uint16_
 
     /* Parse duty_cycle (little-endian uint16) */
     duty_cycle = ((uint16_t)data[0]) | ((uint16_t)data[1] << 8);
-
-    log_info("Motor write: duty=%d (0x%02X 0x%02X)\n", duty_cycle, data[0], data[1]);
+    VM_TRACE(MOTOR_WRITE, duty_cycle);
 
     /* Validate range */
     if (duty_cycle > 10000) {
@@ -65,19 +94,18 @@ int vm_ble_handle_motor_write(uint16_t conn_handle, const uint8_t *data, uint16_
         return VM_ERR_INVALID_DUTY;
     }
 
-    log_info("Motor duty set to %d (%.2f%%)\n", duty_cycle, duty_cycle / 100.0);
+    /* Every write from a pattern stream lands here: tokenized, no formatting */
+    log_tok_info(MOTOR_DUTY, duty_cycle);
 
     return VM_ERR_OK;
 }
 
 /**
- * Get battery level - returns fake value for testing
- * TODO: Replace with real battery monitoring when hardware is connected
+ * Get battery level - cached by the background battery monitor (vm_battery.c)
  */
 uint8_t vm_ble_get_battery_level(void)
 {
-    /* Return fake battery level for testing */
-    return 85;  /* 85% */
+    return vm_battery_get_percent();
 }
 
 /*
@@ -113,7 +141,7 @@ static int vm_att_write_callback(hci_con_handle_t connection_handle, uint16_t at
     if (att_handle == ATT_CHARACTERISTIC_VM_DEVICE_INFO_VALUE_HANDLE) {
         /* Check for 2 bytes: 0xB0 0x00 command */
         if (buffer_size == 2 && buffer[0] == 0xB0 && buffer[1] == 0x00) {
-            log_info("Device info request received (0xB0 0x00)\\n");
+            log_info("Device info request received (0xB0 0x00)\n");
 
             /* Build device info response */
             uint8_t response[VM_DEVICE_INFO_RESPONSE_SIZE];
@@ -124,7 +152,7 @@ static int vm_att_write_callback(hci_con_handle_t connection_handle, uint16_t at
             response[4] = VM_FIRMWARE_VERSION_HIGH;        /* Firmware version high byte */
             response[5] = vm_ble_get_battery_level();      /* Battery level: 0-100% */
 
-            log_info("Sending device info: FW=%d.%d Battery=%d%%\\n",
+            log_info("Sending device info: FW=%d.%d Battery=%d%%\n",
                      response[4], response[3], response[5]);
 
             /* Send notification */
@@ -133,9 +161,102 @@ static int vm_att_write_callback(hci_con_handle_t connection_handle, uint16_t at
                                    response, VM_DEVICE_INFO_RESPONSE_SIZE,
                                    ATT_OP_AUTO_READ_CCC);
 
+            return 0;
+        } else if (buffer_size == 2 && buffer[0] == VM_DEVICE_INFO_HEADER && buffer[1] == VM_DEVICE_INFO_CMD_LINK) {
+            /* Link query: current PHY and RSSI (raw + filtered, signed dBm) */
+            uint8_t response[VM_DEVICE_INFO_LINK_RESPONSE_SIZE];
+            response[0] = VM_DEVICE_INFO_HEADER;
+            response[1] = VM_DEVICE_INFO_CMD_LINK;
+            response[2] = vm_lr_get_phy();
+            response[3] = (uint8_t)vm_lr_get_rssi();
+            response[4] = (uint8_t)vm_lr_get_rssi_avg();
+            response[5] = vm_lr_is_enabled() ? VM_DEVICE_INFO_LINK_FLAG_LONG_RANGE : 0;
+
+            log_info("Sending link info: phy=%d rssi=%d avg=%d\n",
+                     response[2], (s8)response[3], (s8)response[4]);
+
+            ble_comm_att_send_data(connection_handle,
+                                   ATT_CHARACTERISTIC_VM_DEVICE_INFO_VALUE_HANDLE,
+                                   response, VM_DEVICE_INFO_LINK_RESPONSE_SIZE,
+                                   ATT_OP_AUTO_READ_CCC);
+
+            return 0;
+        } else if (buffer_size == 2 && buffer[0] == VM_DEVICE_INFO_HEADER && buffer[1] == VM_DEVICE_INFO_CMD_POWER) {
+            /* Power query: current state and seconds spent in each state */
+            uint8_t response[VM_DEVICE_INFO_POWER_RESPONSE_SIZE];
+            response[0] = VM_DEVICE_INFO_HEADER;
+            response[1] = VM_DEVICE_INFO_CMD_POWER;
+            vm_power_encode_stats(&response[2], sizeof(response) - 2);
+
+            vm_power_dump();
+
+            ble_comm_att_send_data(connection_handle,
+                                   ATT_CHARACTERISTIC_VM_DEVICE_INFO_VALUE_HANDLE,
+                                   response, VM_DEVICE_INFO_POWER_RESPONSE_SIZE,
+                                   ATT_OP_AUTO_READ_CCC);
+
+            return 0;
+        } else if (buffer_size == 2 && buffer[0] == VM_DEVICE_INFO_HEADER && buffer[1] == VM_DEVICE_INFO_CMD_GOVERNOR) {
+            /* Governor query: active duty ceiling and what holds it */
+            uint8_t response[VM_DEVICE_INFO_GOVERNOR_RESPONSE_SIZE];
+            response[0] = VM_DEVICE_INFO_HEADER;
+            response[1] = VM_DEVICE_INFO_CMD_GOVERNOR;
+            vm_governor_encode(&response[2]);
+
+            log_info("Sending governor info: ceiling=%d flags=0x%02x\n",
+                     response[2] | (response[3] << 8), response[4]);
+
+            ble_comm_att_send_data(connection_handle,
+                                   ATT_CHARACTERISTIC_VM_DEVICE_INFO_VALUE_HANDLE,
+                                   response, VM_DEVICE_INFO_GOVERNOR_RESPONSE_SIZE,
+                                   ATT_OP_AUTO_READ_CCC);
+
+            return 0;
+        } else if (buffer_size == 2 && buffer[0] == VM_DEVICE_INFO_HEADER && buffer[1] == VM_DEVICE_INFO_CMD_LOG) {
+            /* Log query: next whole tokenized records from the ring */
+            uint8_t response[VM_DEVICE_INFO_LOG_RESPONSE_MAX];
+            uint16_t n;
+            uint16_t pending;
+
+            response[0] = VM_DEVICE_INFO_HEADER;
+            response[1] = VM_DEVICE_INFO_CMD_LOG;
+            n = vm_log_read(&response[3], sizeof(response) - 3);
+            pending = vm_log_pending();
+            response[2] = (pending > 0xFF) ? 0xFF : (uint8_t)pending;
+
+            ble_comm_att_send_data(connection_handle,
+                                   ATT_CHARACTERISTIC_VM_DEVICE_INFO_VALUE_HANDLE,
+                                   response, 3 + n,
+                                   ATT_OP_AUTO_READ_CCC);
+
+            return 0;
+        } else if (buffer_size == 2 && buffer[0] == VM_DEVICE_INFO_HEADER && buffer[1] == VM_DEVICE_INFO_CMD_TRACE) {
+            /* Trace query: next records of the dump (recording pauses until the last one) */
+            uint8_t response[VM_DEVICE_INFO_TRACE_RESPONSE_MAX];
+            uint16_t n;
+            uint16_t left;
+
+            vm_trace_dump_start();
+            response[0] = VM_DEVICE_INFO_HEADER;
+            response[1] = VM_DEVICE_INFO_CMD_TRACE;
+            response[3] = VM_TRACE_TICKS_PER_US;
+            n = vm_trace_dump_next(&response[4], (sizeof(response) - 4) / VM_TRACE_RECORD_SIZE);
+            left = vm_trace_dump_left();
+            response[2] = (left > 0xFF) ? 0xFF : (uint8_t)left;
+
+            ble_comm_att_send_data(connection_handle,
+                                   ATT_CHARACTERISTIC_VM_DEVICE_INFO_VALUE_HANDLE,
+                                   response, 4 + n * VM_TRACE_RECORD_SIZE,
+                                   ATT_OP_AUTO_READ_CCC);
+
+            return 0;
+        } else if (buffer_size == 3 && buffer[0] == VM_DEVICE_INFO_HEADER && buffer[1] == VM_DEVICE_INFO_CMD_TRACE &&
+                   buffer[2] == VM_DEVICE_INFO_TRACE_UART) {
+            /* Trace dump on the debug UART, no notification */
+            vm_trace_dump_uart();
             return 0;
         } else {
-            log_info("Invalid device info request: size=%d, data=0x%02x 0x%02x\\n",
+            log_info("Invalid device info request: size=%d, data=0x%02x 0x%02x\n",
                      buffer_size,
                      buffer_size > 0 ? buffer[0] : 0,
                      buffer_size > 1 ? buffer[1] : 0);
@@ -150,6 +271,48 @@ static int vm_att_write_callback(hci_con_handle_t connection_handle, uint16_t at
         return 0;
     }
 
+    /* Handle settings characteristic write - every command is answered by notification */
+    if (att_handle == ATT_CHARACTERISTIC_VM_SETTINGS_VALUE_HANDLE) {
+        uint8_t response[VM_SET_RSP_MAX_SIZE];
+        uint8_t rsp_len = vm_settings_handle_cmd(buffer, buffer_size, response);
+
+        log_info("Settings cmd=0x%02x key=0x%02x status=%d\n", response[0], response[1], response[2]);
+
+        ble_comm_att_send_data(connection_handle,
+                               ATT_CHARACTERISTIC_VM_SETTINGS_VALUE_HANDLE,
+                               response, rsp_len,
+                               ATT_OP_AUTO_READ_CCC);
+        return 0;
+    }
+
+    /* Handle settings CCC write */
+    if (att_handle == ATT_CHARACTERISTIC_VM_SETTINGS_CLIENT_CONFIGURATION_HANDLE) {
+        log_info("Settings CCC write: 0x%02x\n", buffer[0]);
+        ble_gatt_server_characteristic_ccc_set(connection_handle, att_handle, buffer[0]);
+        return 0;
+    }
+
+    /* Handle sync characteristic write - PING and STATUS answer by notification */
+    if (att_handle == ATT_CHARACTERISTIC_VM_SYNC_VALUE_HANDLE) {
+        uint8_t response[VM_SYNC_RSP_MAX_SIZE];
+        uint8_t rsp_len = vm_sync_handle_cmd(buffer, buffer_size, response);
+
+        if (rsp_len) {
+            ble_comm_att_send_data(connection_handle,
+                                   ATT_CHARACTERISTIC_VM_SYNC_VALUE_HANDLE,
+                                   response, rsp_len,
+                                   ATT_OP_AUTO_READ_CCC);
+        }
+        return 0;
+    }
+
+    /* Handle sync CCC write */
+    if (att_handle == ATT_CHARACTERISTIC_VM_SYNC_CLIENT_CONFIGURATION_HANDLE) {
+        log_info("Sync CCC write: 0x%02x\n", buffer[0]);
+        ble_gatt_server_characteristic_ccc_set(connection_handle, att_handle, buffer[0]);
+        return 0;
+    }
+
     /* Handle custom OTA characteristic write */
     if (att_handle == ATT_CHARACTERISTIC_VM_OTA_VALUE_HANDLE) {
         return vm_ble_handle_ota_write(connection_handle, buffer, buffer_size);
@@ -167,19 +330,35 @@ static int vm_att_write_callback(hci_con_handle_t connection_handle, uint16_t at
 }
 
 /*
- * GATT read callback - no longer needed (device info is WRITE+NOTIFY now)
+ * GATT read callback - diagnostics characteristic only
+ * (device info is WRITE+NOTIFY)
  */
 static uint16_t vm_att_read_callback(hci_con_handle_t connection_handle, uint16_t att_handle,
                                       uint16_t offset, uint8_t *buffer, uint16_t buffer_size)
 {
+    /* Snapshot taken on the first read so long reads see consistent counters */
+    static uint8_t diag[VM_MEM_DIAG_SIZE];
+    static uint16_t diag_len = 0;
+
     (void)connection_handle;
-    (void)att_handle;
-    (void)offset;
-    (void)buffer;
-    (void)buffer_size;
 
-    /* No characteristics to read */
-    return 0;
+    if (att_handle != ATT_CHARACTERISTIC_VM_DIAG_VALUE_HANDLE) {
+        return 0;
+    }
+
+    if (offset == 0 && !buffer) {
+        diag_len = vm_mem_encode_diag(diag, sizeof(diag));
+    }
+
+    if (offset >= diag_len || (offset + buffer_size) > diag_len) {
+        return diag_len;
+    }
+
+    if (buffer) {
+        memcpy(buffer, &diag[offset], buffer_size);
+        return buffer_size;
+    }
+    return diag_len;
 }
 
 /*
@@ -238,6 +417,15 @@ int vm_ble_service_init(void)
 {
     int ret;
 
+    /* Start draining tokenized log records */
+    vm_log_init();
+
+    /* Start the tracepoint timestamp timer */
+    vm_trace_init();
+
+    /* Load user settings (motor and advertising read them at init) */
+    vm_settings_init();
+
     /* Initialize motor control */
     ret = vm_motor_init();
     if (ret != 0) {
@@ -251,6 +439,15 @@ int vm_ble_service_init(void)
         return ret;
     }
 
+    /* Start background battery estimate (after motor init, it reads the duty) */
+    vm_battery_init();
+
+    /* Start power state statistics */
+    vm_power_init();
+
+    /* Start the thermal / current governor (after the battery estimate it reads) */
+    vm_governor_init();
+
     /* Register GATT profile with BLE stack */
     ble_gatt_server_set_profile(vm_motor_profile_data, sizeof(vm_motor_profile_data));
 
@@ -291,9 +488,18 @@ const void *vm_ble_get_sm_config(void)
 /* Cleanup function for application shutdown */
 void vm_ble_service_deinit(void)
 {
-    /* Deinitialize motor control */
+    /* Stop timed playback, governor and battery polling, then deinitialize motor control */
+    vm_sync_stop();
+    vm_governor_deinit();
+    vm_battery_deinit();
     vm_motor_deinit();
 
+    /* Write pending settings now instead of after the batch delay */
+    vm_settings_flush();
+
+    vm_log_deinit();
+    vm_trace_deinit();
+
     /* Note: BLE stack cleanup (ble_comm_exit) should be called
      * by the main application during shutdown, not by individual services.
      */
@@ -332,11 +538,132 @@ static int ota_write_complete_callback(void *priv)
                            notify_data, 3,
                            ATT_OP_AUTO_READ_CCC);
     
-    log_info("OTA: ACK sent for seq=%d\n", ota_current_sequence);
+    log_tok_info(OTA_ACK, ota_current_sequence);
     
     return 0;  /* Success */
 }
 
+/* Reset into the new image (boot info is already written) */
+static void ota_commit_reset(void *priv)
+{
+    (void)priv;
+
+    ota_commit_fallback = 0;
+    log_info("Custom OTA: Resetting into the new image\n");
+    cpu_reset();
+}
+
+/* Schedule the reset once; later calls are ignored */
+static void ota_commit_schedule_reset(u32 delay_ms)
+{
+    if (ota_commit_phase == OTA_COMMIT_RESET) {
+        return;
+    }
+    ota_commit_phase = OTA_COMMIT_RESET;
+    if (ota_commit_fallback) {
+        sys_timeout_del(ota_commit_fallback);
+        ota_commit_fallback = 0;
+    }
+    sys_timeout_add(NULL, ota_commit_reset, delay_ms);
+}
+
+/* Queue the SUCCESS notification, retried from CAN_SEND_NOW while the stack buffer is full */
+static void ota_commit_send_success(void)
+{
+    uint8_t notify_data[2] = {VM_OTA_STATUS_SUCCESS, 0x00};
+
+    if (ble_comm_att_send_data(ota_commit_conn,
+                               ATT_CHARACTERISTIC_VM_OTA_VALUE_HANDLE,
+                               notify_data, 2,
+                               ATT_OP_AUTO_READ_CCC) == 0) {
+        ota_commit_phase = OTA_COMMIT_SUCCESS_QUEUED;
+    }
+}
+
+/* Commit step, runs from a system timer (not in the BLE callback) */
+static void ota_commit_poll(void *priv)
+{
+    int ret;
+    uint8_t progress;
+
+    (void)priv;
+
+    ret = custom_dual_bank_ota_commit_step();
+    if (ret == CUSTOM_OTA_COMMIT_PENDING) {
+        progress = custom_dual_bank_ota_get_commit_progress();
+        if (ota_commit_conn && progress >= ota_commit_reported + 10) {
+            ota_commit_reported = progress;
+            ota_send_notification(ota_commit_conn, VM_OTA_STATUS_VERIFYING, progress);
+        }
+        return;
+    }
+
+    sys_timer_del(ota_commit_timer);
+    ota_commit_timer = 0;
+
+    if (ret != 0) {
+        log_error("Custom OTA: Commit failed with error %d\n", ret);
+        custom_dual_bank_ota_abort();  /* Reset state machine */
+        ota_commit_phase = OTA_COMMIT_IDLE;
+        if (ota_commit_conn) {
+            ota_send_notification(ota_commit_conn, VM_OTA_STATUS_ERROR, ret);
+        }
+        return;
+    }
+
+    /* Pending settings would be lost with the reset */
+    vm_settings_flush();
+
+    if (!ota_commit_conn) {
+        ota_commit_schedule_reset(VM_OTA_RESET_DELAY_MS);  /* Nobody to tell */
+        return;
+    }
+
+    ota_commit_phase = OTA_COMMIT_SUCCESS_PENDING;
+    ota_commit_send_success();
+
+    /* Reset anyway if CAN_SEND_NOW never comes (notifications disabled, link stalled) */
+    ota_commit_fallback = sys_timeout_add(NULL, ota_commit_reset, VM_OTA_RESET_TIMEOUT_MS);
+}
+
+/* Stack is ready for more data: the queued SUCCESS went out once nothing is left in
+ * the buffer. A wakeup for an earlier notification still finds the SUCCESS queued */
+void vm_ble_ota_on_can_send_now(void)
+{
+    if (ota_commit_phase == OTA_COMMIT_SUCCESS_PENDING) {
+        ota_commit_send_success();
+    } else if (ota_commit_phase == OTA_COMMIT_SUCCESS_QUEUED &&
+               ble_comm_cbuffer_vaild_len(ota_commit_conn) >= VM_BLE_TX_CBUF_SIZE) {
+        log_info("Custom OTA: SUCCESS sent, reset in %d ms\n", VM_OTA_RESET_DELAY_MS);
+        ota_commit_schedule_reset(VM_OTA_RESET_DELAY_MS);
+    }
+}
+
+void vm_ble_ota_on_mtu(uint16_t mtu)
+{
+    ota_att_mtu = mtu;
+}
+
+/* Link gone: finish the commit without notifications, reset right away if it is done */
+void vm_ble_ota_on_disconnect(void)
+{
+    ota_commit_conn = 0;
+    ota_att_mtu = 23;
+
+    /* Transfer cut short: drop it so the host can START again after reconnecting */
+    if (ota_commit_phase == OTA_COMMIT_IDLE &&
+        custom_dual_bank_ota_get_state() == CUSTOM_OTA_STATE_RECEIVING) {
+        log_info("Custom OTA: transfer aborted by disconnect\n");
+        custom_dual_bank_ota_abort();
+        return;
+    }
+
+    if (ota_commit_phase == OTA_COMMIT_SUCCESS_PENDING ||
+        ota_commit_phase == OTA_COMMIT_SUCCESS_QUEUED) {
+        ota_commit_schedule_reset(VM_OTA_RESET_DELAY_MS);
+    }
+}
+
 /* Note: Using custom dual-bank implementation with low-level flash functions */
 
 /*
@@ -376,9 +703,14 @@ int vm_ble_handle_ota_write(uint16_t conn_handle, const uint8_t *data, uint16_t
             }
             
             /* State is now CUSTOM_OTA_STATE_RECEIVING (managed by custom_dual_bank_ota.c) */
+            ota_next_seq = 0;
             
-            /* Send ready notification */
-            ota_send_notification(conn_handle, VM_OTA_STATUS_READY, 0x00);
+            /* Send ready notification with the ATT MTU: DATA chunks up to MTU - 6 bytes */
+            uint8_t ready[4] = {VM_OTA_STATUS_READY, 0x00, ota_att_mtu & 0xFF, ota_att_mtu >> 8};
+            ble_comm_att_send_data(conn_handle,
+                                   ATT_CHARACTERISTIC_VM_OTA_VALUE_HANDLE,
+                                   ready, sizeof(ready),
+                                   ATT_OP_AUTO_READ_CCC);
             break;
         }
         
@@ -398,6 +730,22 @@ int vm_ble_handle_ota_write(uint16_t conn_handle, const uint8_t *data, uint16_t
             }
             
             u16 seq = data[1] | (data[2] << 8);
+            VM_TRACE(OTA_WRITE, seq);
+            
+            /* Chunks are written in order only. A repeat (its ACK was lost and
+             * the host went back) or a chunk after a gap is not written; the
+             * ACK of the last chunk written tells the host where to resume. */
+            if (seq != ota_next_seq) {
+                log_info("Custom OTA: DATA %d skipped, expecting %d\n", seq, ota_next_seq);
+                if (ota_next_seq == 0) {
+                    /* Nothing written since START: there is no chunk to ACK */
+                    ota_send_notification(conn_handle, VM_OTA_STATUS_NONE, 0x00);
+                } else {
+                    ota_send_notification(conn_handle, VM_OTA_STATUS_ACK, (ota_next_seq - 1) & 0xFF);
+                }
+                break;
+            }
+            
             u16 data_len = len - 3;
             u8 *firmware_data = (u8 *)&data[3];
             
@@ -410,8 +758,11 @@ int vm_ble_handle_ota_write(uint16_t conn_handle, const uint8_t *data, uint16_t
                 return 0x0E;
             }
             
+            ota_next_seq++;
+            
             /* Send ACK with sequence number */
             ota_send_notification(conn_handle, VM_OTA_STATUS_ACK, seq & 0xFF);
+            VM_TRACE(OTA_ACK, seq);
             
             /* Send progress update every 10 packets */
             if (seq % 10 == 0) {
@@ -424,6 +775,17 @@ int vm_ble_handle_ota_write(uint16_t conn_handle, const uint8_t *data, uint16_t
         
         case VM_OTA_CMD_FINISH: {
             /* Finish OTA: [0x03] */
+            if (ota_commit_phase != OTA_COMMIT_IDLE) {
+                /* Retransmitted FINISH: report where the commit is, do not start it again */
+                log_info("Custom OTA: FINISH again (commit phase=%d)\n", ota_commit_phase);
+                if (ota_commit_phase == OTA_COMMIT_RUNNING) {
+                    ota_send_notification(conn_handle, VM_OTA_STATUS_VERIFYING, ota_commit_reported);
+                } else {
+                    ota_send_notification(conn_handle, VM_OTA_STATUS_SUCCESS, 0x00);
+                }
+                break;
+            }
+            
             u8 current_state = custom_dual_bank_ota_get_state();
             if (current_state != CUSTOM_OTA_STATE_RECEIVING) {
                 log_error("Custom OTA: Not in receiving state (state=%d)\n", current_state);
@@ -433,8 +795,9 @@ int vm_ble_handle_ota_write(uint16_t conn_handle, const uint8_t *data, uint16_t
             
             log_info("Custom OTA: FINISH - Verifying and switching banks...\n");
             
-            /* Finalize OTA update (verifies CRC, updates boot info, resets) */
-            ret = custom_dual_bank_ota_end();
+            /* Program the tail and check the size; the CRC pass and the
+             * boot info write run from ota_commit_poll() */
+            ret = custom_dual_bank_ota_commit_begin();
             if (ret != 0) {
                 log_error("Custom OTA: Finish failed with error %d\n", ret);
                 custom_dual_bank_ota_abort();  /* Reset state machine */
@@ -442,14 +805,12 @@ int vm_ble_handle_ota_write(uint16_t conn_handle, const uint8_t *data, uint16_t
                 return 0x0E;
             }
             
-            /* Send success notification */
-            ota_send_notification(conn_handle, VM_OTA_STATUS_SUCCESS, 0x00);
-            
-            /* Wait for notification to be sent, then device will reset */
-            os_time_dly(10);  /* 100ms delay */
-            
-            /* Note: custom_dual_bank_ota_end() calls cpu_reset() */
+            ota_commit_conn = conn_handle;
+            ota_commit_reported = 0;
+            ota_commit_phase = OTA_COMMIT_RUNNING;
+            ota_commit_timer = sys_timer_add(NULL, ota_commit_poll, VM_OTA_COMMIT_STEP_MS);
             
+            ota_send_notification(conn_handle, VM_OTA_STATUS_VERIFYING, 0);
             break;
         }
         
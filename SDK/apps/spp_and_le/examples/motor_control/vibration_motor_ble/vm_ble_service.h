@@ -18,6 +18,21 @@
     0x4F, 0x59, 0x2D, 0x9A, 0x73, 0x5F, 0x23, 0xB1, \
     0x2B, 0x4E, 0x4F, 0x59, 0x2D, 0x1A, 0x52, 0x9A
 
+/* Diagnostics Characteristic UUID: 9A541A2D-594F-4E2B-B123-5F739A2D594F */
+#define VM_DIAG_CHAR_UUID_128 \
+    0x4F, 0x59, 0x2D, 0x9A, 0x73, 0x5F, 0x23, 0xB1, \
+    0x2B, 0x4E, 0x4F, 0x59, 0x2D, 0x1A, 0x54, 0x9A
+
+/* Settings Characteristic UUID: 9A551A2D-594F-4E2B-B123-5F739A2D594F */
+#define VM_SETTINGS_CHAR_UUID_128 \
+    0x4F, 0x59, 0x2D, 0x9A, 0x73, 0x5F, 0x23, 0xB1, \
+    0x2B, 0x4E, 0x4F, 0x59, 0x2D, 0x1A, 0x55, 0x9A
+
+/* Sync Characteristic UUID: 9A561A2D-594F-4E2B-B123-5F739A2D594F */
+#define VM_SYNC_CHAR_UUID_128 \
+    0x4F, 0x59, 0x2D, 0x9A, 0x73, 0x5F, 0x23, 0xB1, \
+    0x2B, 0x4E, 0x4F, 0x59, 0x2D, 0x1A, 0x56, 0x9A
+
 /* Packet format constants */
 #define VM_MOTOR_PACKET_SIZE    2
 #define VM_DEVICE_INFO_REQUEST_SIZE  2  /* Two bytes: 0xB0 0x00 */
@@ -26,20 +41,34 @@
 /* Device info protocol */
 #define VM_DEVICE_INFO_HEADER   0xB0
 #define VM_DEVICE_INFO_CMD      0x00
+#define VM_DEVICE_INFO_CMD_LINK 0x01  /* Link query: [0xB0][0x01][phy][rssi][rssi_avg][flags] */
+#define VM_DEVICE_INFO_LINK_RESPONSE_SIZE 6
+#define VM_DEVICE_INFO_LINK_FLAG_LONG_RANGE 0x01  /* Long range profile enabled */
+#define VM_DEVICE_INFO_CMD_POWER 0x02  /* Power query: [0xB0][0x02][state][active s][light s][sleep s][deep s] */
+#define VM_DEVICE_INFO_POWER_RESPONSE_SIZE 19
+#define VM_DEVICE_INFO_CMD_GOVERNOR 0x03  /* Governor query: [0xB0][0x03][ceiling lo][hi][flags][rise C][sensor C][duty lo][hi] */
+#define VM_DEVICE_INFO_GOVERNOR_RESPONSE_SIZE 9
+#define VM_DEVICE_INFO_CMD_LOG 0x04  /* Log query: [0xB0][0x04][bytes still pending][records...] (vm_log.h) */
+#define VM_DEVICE_INFO_LOG_RESPONSE_MAX 20
+#define VM_DEVICE_INFO_CMD_TRACE 0x05  /* Trace query: [0xB0][0x05][records left][ticks/us][0-2 records] (vm_trace.h) */
+#define VM_DEVICE_INFO_TRACE_RESPONSE_MAX 20
+#define VM_DEVICE_INFO_TRACE_UART 0x01  /* [0xB0][0x05][0x01]: print the trace on the debug UART instead */
 
 /* Firmware version - update these for your firmware */
 #define VM_FIRMWARE_VERSION_HIGH  1
 #define VM_FIRMWARE_VERSION_LOW   0
 
 /* OTA constants */
-#define VM_OTA_CMD_START    0x01  /* Start OTA: [0x01][size_low][size_high][size_mid][size_top] */
-#define VM_OTA_CMD_DATA     0x02  /* Data chunk: [0x02][seq_low][seq_high][data...] */
-#define VM_OTA_CMD_FINISH   0x03  /* Finish OTA: [0x03][crc_low][crc_high][crc_mid][crc_top] */
+#define VM_OTA_CMD_START    0x01  /* Start OTA: [0x01][size u32][crc16 u16][version] */
+#define VM_OTA_CMD_DATA     0x02  /* Data chunk: [0x02][seq_low][seq_high][data...], seq from 0 */
+#define VM_OTA_CMD_FINISH   0x03  /* Finish OTA: [0x03] */
 
-#define VM_OTA_STATUS_READY    0x01  /* Ready for OTA */
+#define VM_OTA_STATUS_READY    0x01  /* Ready for OTA: [0x01][0x00][att_mtu u16], erase done */
 #define VM_OTA_STATUS_PROGRESS 0x02  /* Progress update */
 #define VM_OTA_STATUS_SUCCESS  0x03  /* OTA success */
-#define VM_OTA_STATUS_ACK      0x04  /* ACK for DATA packet (flow control) */
+#define VM_OTA_STATUS_ACK      0x04  /* [0x04][seq_low] of the last chunk written in order (flow control) */
+#define VM_OTA_STATUS_VERIFYING 0x05 /* Commit running after FINISH, value = CRC pass percent */
+#define VM_OTA_STATUS_NONE     0x06  /* [0x06][0x00] chunk out of order, none written since START: resend from 0 */
 #define VM_OTA_STATUS_ERROR    0xFF  /* OTA error */
 
 #define VM_OTA_START_ADDR   0x0      /* VM flash start address */
@@ -108,11 +137,25 @@ int vm_ble_handle_device_info_write(uint16_t conn_handle, const uint8_t *data, u
  */
 int vm_ble_handle_ota_write(uint16_t conn_handle, const uint8_t *data, uint16_t len);
 
+/**
+ * OTA commit hooks for the application's GATT event handler
+ * CAN_SEND_NOW confirms the SUCCESS notification before the reset;
+ * a disconnect during the commit resets without waiting for it, a
+ * disconnect before FINISH drops the transfer (the next START erases again)
+ */
+void vm_ble_ota_on_can_send_now(void);
+void vm_ble_ota_on_disconnect(void);
+
+/**
+ * ATT MTU from the exchange, reported in READY so the host can size DATA chunks
+ * @param mtu Negotiated ATT MTU
+ */
+void vm_ble_ota_on_mtu(uint16_t mtu);
+
 /**
  * Get battery level (0-100%)
- * Uses JieLi SDK's power management system (get_vbat_percent)
- * Battery monitoring is initialized by board_power_init() at startup
- * @return Battery level percentage (0-100)
+ * Returns the estimate cached by vm_battery.c, no ADC access
+ * @return Battery level percentage (0-100), 0xFF before vm_ble_service_init()
  */
 uint8_t vm_ble_get_battery_level(void);
 
@@ -23,19 +23,21 @@
 #define VM_MOTOR_TIMER          JL_TIMER3
 #endif
 
-/* PWM frequency in Hz - manufacturer recommendation */
+/* Default PWM frequency in Hz - manufacturer recommendation (user setting) */
 #ifndef VM_MOTOR_PWM_FREQ_HZ
 #define VM_MOTOR_PWM_FREQ_HZ    1000  /* 1kHz */
 #endif
 
 /* ========== BLE Configuration ========== */
 
-/* Device name for advertising */
+/* Default device name for advertising (user setting) */
 #ifndef VM_DEVICE_NAME
 #define VM_DEVICE_NAME          "VibMotor"
 #endif
 
-/* Advertising interval (units of 0.625ms) */
+/* Advertising interval (units of 0.625ms)
+ * MIN is the lower bound accepted for any scheduler tier,
+ * MAX is the default fast-tier interval */
 #ifndef VM_ADV_INTERVAL_MIN
 #define VM_ADV_INTERVAL_MIN     0x0020  /* 20ms */
 #endif
@@ -44,6 +46,126 @@
 #define VM_ADV_INTERVAL_MAX     0x0040  /* 40ms */
 #endif
 
+/* GATT notification buffer (gatt_ctrl_t cbuffer_size in ble_motor.c).
+ * Fully free again once everything queued has been sent */
+#ifndef VM_BLE_TX_CBUF_SIZE
+#define VM_BLE_TX_CBUF_SIZE     512
+#endif
+
+/* ========== Advertising Scheduler ========== */
+
+/* Defaults, the schedule is a user setting (vm_settings.h) */
+
+/* Fast tier: right after power-on, disconnect or button press */
+#ifndef VM_ADV_FAST_INTERVAL
+#define VM_ADV_FAST_INTERVAL    VM_ADV_INTERVAL_MAX
+#endif
+
+#ifndef VM_ADV_FAST_DURATION_S
+#define VM_ADV_FAST_DURATION_S  30
+#endif
+
+/* Slow tier (also used during wake windows) */
+#ifndef VM_ADV_SLOW_INTERVAL
+#define VM_ADV_SLOW_INTERVAL    0x0664  /* 1022.5ms */
+#endif
+
+#ifndef VM_ADV_SLOW_DURATION_S
+#define VM_ADV_SLOW_DURATION_S  600     /* 10 minutes */
+#endif
+
+/* Timed sleep with periodic wake windows */
+#ifndef VM_ADV_SLEEP_ENABLE
+#define VM_ADV_SLEEP_ENABLE     1
+#endif
+
+#ifndef VM_ADV_SLEEP_PERIOD_S
+#define VM_ADV_SLEEP_PERIOD_S   55
+#endif
+
+#ifndef VM_ADV_WAKE_WINDOW_S
+#define VM_ADV_WAKE_WINDOW_S    5
+#endif
+
+/* Energy model constants (used by vm_adv_sched_estimate_avg_ua) */
+#ifndef VM_ENERGY_ADV_EVENT_NC
+#define VM_ENERGY_ADV_EVENT_NC  8000    /* Charge per 3-channel legacy adv event (nC) */
+#endif
+
+#ifndef VM_ENERGY_SLEEP_UA
+#define VM_ENERGY_SLEEP_UA      4       /* Baseline current between events (uA) */
+#endif
+
+/* ========== Connectionless Status (scan response) ========== */
+
+/* Company ID of the manufacturer specific AD (0xFFFF = SIG reserved for testing) */
+#ifndef VM_ADV_STATUS_COMPANY_ID
+#define VM_ADV_STATUS_COMPANY_ID        0xFFFF
+#endif
+
+/* How often the status is re-sampled; the scan response is only rewritten on change */
+#ifndef VM_ADV_STATUS_POLL_MS
+#define VM_ADV_STATUS_POLL_MS           5000
+#endif
+
+#ifndef VM_ADV_STATUS_BATTERY_LOW_PCT
+#define VM_ADV_STATUS_BATTERY_LOW_PCT   15
+#endif
+
+/* ========== Long Range (Extended Advertising + Coded PHY) ========== */
+
+/* Opt-in from app_config.h (CONFIG_MOTOR_LONG_RANGE), which also enables
+ * CONFIG_BT_EXT_ADV_MODE and a Coded PHY in the controller feature set */
+#ifndef VM_LONG_RANGE_ENABLE
+#if defined(CONFIG_MOTOR_LONG_RANGE) && CONFIG_MOTOR_LONG_RANGE
+#define VM_LONG_RANGE_ENABLE    1
+#else
+#define VM_LONG_RANGE_ENABLE    0
+#endif
+#endif
+
+/* Coded PHY coding used for advertising and weak links (S2: ~2x range, S8: ~4x range) */
+#ifndef VM_LR_CODED_OPTION
+#if defined(CONFIG_BLE_PHY_SET) && (CONFIG_BLE_PHY_SET == CONFIG_SET_CODED_S2_PHY)
+#define VM_LR_CODED_OPTION      CONN_SET_PHY_OPTIONS_S2
+#else
+#define VM_LR_CODED_OPTION      CONN_SET_PHY_OPTIONS_S8
+#endif
+#endif
+
+/* PHY used when the link is strong (2M needs CONFIG_BLE_HIGH_SPEED) */
+#ifndef VM_LR_FAST_PHY
+#if defined(CONFIG_BLE_HIGH_SPEED) && CONFIG_BLE_HIGH_SPEED
+#define VM_LR_FAST_PHY          CONN_SET_2M_PHY
+#else
+#define VM_LR_FAST_PHY          CONN_SET_1M_PHY
+#endif
+#endif
+
+/* RSSI sampling period while connected */
+#ifndef VM_LR_RSSI_POLL_MS
+#define VM_LR_RSSI_POLL_MS      1000
+#endif
+
+/* Hysteresis: switch to Coded below WEAK, back to the fast PHY above STRONG */
+#ifndef VM_LR_RSSI_WEAK_DBM
+#define VM_LR_RSSI_WEAK_DBM     (-82)
+#endif
+
+#ifndef VM_LR_RSSI_STRONG_DBM
+#define VM_LR_RSSI_STRONG_DBM   (-65)
+#endif
+
+/* Consecutive filtered samples beyond a threshold before switching */
+#ifndef VM_LR_SWITCH_SAMPLES
+#define VM_LR_SWITCH_SAMPLES    3
+#endif
+
+/* Minimum time on a PHY before the next switch */
+#ifndef VM_LR_MIN_DWELL_MS
+#define VM_LR_MIN_DWELL_MS      10000
+#endif
+
 /* Connection parameters */
 #ifndef VM_CONN_INTERVAL_MIN
 #define VM_CONN_INTERVAL_MIN    0x0006  /* 7.5ms */
@@ -61,18 +183,319 @@
 #define VM_CONN_TIMEOUT         0x0064  /* 1000ms */
 #endif
 
-/* ========== Debug Configuration ========== */
+/* ========== Battery Monitor ========== */
+
+/* Series cells in the pack (the OCV table in vm_battery.c is per cell) */
+#ifndef VM_BAT_CELLS
+#define VM_BAT_CELLS            1
+#endif
+
+/* How often the adc_scan VBAT average is fed to the estimator */
+#ifndef VM_BAT_POLL_MS
+#define VM_BAT_POLL_MS          1000
+#endif
+
+/* Pack voltage drop with the motor at 100 % duty (internal + wiring resistance) */
+#ifndef VM_BAT_LOAD_DROP_MV
+#define VM_BAT_LOAD_DROP_MV     150
+#endif
+
+/* Samples are skipped for this long after a duty change */
+#ifndef VM_BAT_SETTLE_MS
+#define VM_BAT_SETTLE_MS        3000
+#endif
+
+/* Samples above this duty are skipped unless none was taken for VM_BAT_MAX_STALE_MS */
+#ifndef VM_BAT_GATE_DUTY
+#define VM_BAT_GATE_DUTY        7000
+#endif
+
+#ifndef VM_BAT_MAX_STALE_MS
+#define VM_BAT_MAX_STALE_MS     60000
+#endif
+
+/* EMA divisor: 16 at 1 s polling settles in about a minute */
+#ifndef VM_BAT_EMA_DIV
+#define VM_BAT_EMA_DIV          16
+#endif
+
+/* The reported percentage only goes up once the estimate is this many points higher */
+#ifndef VM_BAT_RISE_HYST_PCT
+#define VM_BAT_RISE_HYST_PCT    3
+#endif
+
+/* ========== Thermal / Current Governor ========== */
+
+/* Governor step period (vm_governor.h) */
+#ifndef VM_GOV_POLL_MS
+#define VM_GOV_POLL_MS          1000
+#endif
+
+/* Thermal model of the MOS driver: steady-state rise above ambient at 100 % duty
+ * and time constant. Fit these to a thermocouple run on the real board */
+#ifndef VM_GOV_RISE_FULL_C
+#define VM_GOV_RISE_FULL_C      60
+#endif
+
+#ifndef VM_GOV_TAU_S
+#define VM_GOV_TAU_S            120
+#endif
+
+/* Modelled rise where derating starts, and where the ceiling reaches VM_GOV_MIN_CEILING */
+#ifndef VM_GOV_RISE_START_C
+#define VM_GOV_RISE_START_C     30
+#endif
+
+#ifndef VM_GOV_RISE_LIMIT_C
+#define VM_GOV_RISE_LIMIT_C     40
+#endif
+
+/* Lowest ceiling the temperature limiters apply */
+#ifndef VM_GOV_MIN_CEILING
+#define VM_GOV_MIN_CEILING      3000
+#endif
+
+/* Loaded cell voltage kept above this (uses VM_BAT_LOAD_DROP_MV as the load line) */
+#ifndef VM_GOV_CUTOFF_MV
+#define VM_GOV_CUTOFF_MV        3300
+#endif
+
+/* Ceiling change per second: derating is fast, recovery slow */
+#ifndef VM_GOV_SLEW_DOWN
+#define VM_GOV_SLEW_DOWN        500
+#endif
+
+#ifndef VM_GOV_SLEW_UP
+#define VM_GOV_SLEW_UP          100
+#endif
+
+/* Optional temperature sensor on an ADC channel (NTC divider near the MOS),
+ * read as linear around 25 degC. Not defined: the thermal model alone is used
+ * #define VM_GOV_TEMP_ADC_CH      AD_CH_PB1
+ * #define VM_GOV_TEMP_MV_25C      1650
+ * #define VM_GOV_TEMP_UV_PER_C    (-25000)
+ */
+#ifndef VM_GOV_TEMP_START_C
+#define VM_GOV_TEMP_START_C     60
+#endif
 
-/* Enable debug logging */
+#ifndef VM_GOV_TEMP_LIMIT_C
+#define VM_GOV_TEMP_LIMIT_C     80
+#endif
+
+/* ========== Low Power ========== */
+
+/* Light sleep between BLE events while the motor runs (clocks kept for the PWM timer).
+ * Set to 0 if the PWM does not survive light sleep on a board: the CPU then stays awake */
+#ifndef VM_PWR_LIGHT_SLEEP_ENABLE
+#define VM_PWR_LIGHT_SLEEP_ENABLE   1
+#endif
+
+/* Deep sleep once the motor has been off this long */
+#ifndef VM_PWR_DEEP_SLEEP_ENABLE
+#define VM_PWR_DEEP_SLEEP_ENABLE    1
+#endif
+
+#ifndef VM_PWR_DEEP_IDLE_MS
+#define VM_PWR_DEEP_IDLE_MS         30000
+#endif
+
+/* ========== Memory Pools ========== */
+
+/* Fixed-block pools (vm_mem_pool.h), block sizes are rounded up to 4 bytes.
+ * Check high-water and fail counts over the diagnostics characteristic
+ * before shrinking any of these. */
+
+/* GATT control + send buffer: ATT_CTRL_BLOCK_SIZE + mtu_size + cbuffer_size */
+#ifndef VM_POOL_BLE_BLOCK_SIZE
+#define VM_POOL_BLE_BLOCK_SIZE      1280
+#endif
+
+#ifndef VM_POOL_BLE_BLOCKS
+#define VM_POOL_BLE_BLOCKS          1
+#endif
+
+/* OTA page write slot, must hold CUSTOM_FLASH_PAGE */
+#ifndef VM_POOL_OTA_BLOCK_SIZE
+#define VM_POOL_OTA_BLOCK_SIZE      256
+#endif
+
+#ifndef VM_POOL_OTA_BLOCKS
+#define VM_POOL_OTA_BLOCKS          1
+#endif
+
+/* ========== OTA Commit ========== */
+
+/* The commit after FINISH runs one CRC step (CUSTOM_OTA_VERIFY_STEP_PAGES) per tick */
+#ifndef VM_OTA_COMMIT_STEP_MS
+#define VM_OTA_COMMIT_STEP_MS   10
+#endif
+
+/* Reset this long after CAN_SEND_NOW confirmed the SUCCESS notification
+ * (queued and the notification buffer drained since) */
+#ifndef VM_OTA_RESET_DELAY_MS
+#define VM_OTA_RESET_DELAY_MS   100
+#endif
+
+/* Reset anyway if the confirmation does not come (notifications off, link stalled) */
+#ifndef VM_OTA_RESET_TIMEOUT_MS
+#define VM_OTA_RESET_TIMEOUT_MS 3000
+#endif
+
+/* ========== Persistent Storage (syscfg VM item IDs) ========== */
+
+/* User-defined IDs must stay within CFG_USER_DEFINE_BEGIN..END (1-49)
+ * and must not collide with apps/spp_and_le/include/user_cfg_id.h */
+/* Advertising schedule of older firmware, only read to migrate it into the settings */
+#ifndef VM_CFG_ID_ADV_SCHED
+#define VM_CFG_ID_ADV_SCHED     40
+#endif
+
+/* User settings (vm_settings.h) */
+#ifndef VM_CFG_ID_SETTINGS
+#define VM_CFG_ID_SETTINGS      41
+#endif
+
+/* Settings write-back delay: changes made within this window share one flash write */
+#ifndef VM_SETTINGS_FLUSH_MS
+#define VM_SETTINGS_FLUSH_MS    3000
+#endif
+
+/* ========== Logging ========== */
+
+/* Enable info logging (0: errors only). Sets the default of the levels below */
 #ifndef VM_DEBUG_ENABLE
 #define VM_DEBUG_ENABLE         1
 #endif
 
-/* Debug log macro - uses SDK's log_info instead of printf */
-#if VM_DEBUG_ENABLE
-#define VM_LOG(fmt, ...) log_info("[VM_BLE] " fmt "\n", ##__VA_ARGS__)
-#else
-#define VM_LOG(fmt, ...)
+/* Compile-time log levels (vm_log.h): 0 none, 1 error, 2 info, 3 debug.
+ * Calls above a module's level are removed together with their strings */
+#ifndef VM_LOG_LEVEL_DEFAULT
+#define VM_LOG_LEVEL_DEFAULT    (VM_DEBUG_ENABLE ? 2 : 1)
+#endif
+
+#ifndef VM_LOG_LEVEL_BLE
+#define VM_LOG_LEVEL_BLE        VM_LOG_LEVEL_DEFAULT
+#endif
+
+#ifndef VM_LOG_LEVEL_OTA
+#define VM_LOG_LEVEL_OTA        VM_LOG_LEVEL_DEFAULT
+#endif
+
+#ifndef VM_LOG_LEVEL_JNL
+#define VM_LOG_LEVEL_JNL        VM_LOG_LEVEL_DEFAULT
+#endif
+
+#ifndef VM_LOG_LEVEL_ADV
+#define VM_LOG_LEVEL_ADV        VM_LOG_LEVEL_DEFAULT
+#endif
+
+#ifndef VM_LOG_LEVEL_LR
+#define VM_LOG_LEVEL_LR         VM_LOG_LEVEL_DEFAULT
+#endif
+
+#ifndef VM_LOG_LEVEL_BAT
+#define VM_LOG_LEVEL_BAT        VM_LOG_LEVEL_DEFAULT
+#endif
+
+#ifndef VM_LOG_LEVEL_GOV
+#define VM_LOG_LEVEL_GOV        VM_LOG_LEVEL_DEFAULT
+#endif
+
+#ifndef VM_LOG_LEVEL_PWR
+#define VM_LOG_LEVEL_PWR        VM_LOG_LEVEL_DEFAULT
+#endif
+
+#ifndef VM_LOG_LEVEL_MEM
+#define VM_LOG_LEVEL_MEM        VM_LOG_LEVEL_DEFAULT
+#endif
+
+#ifndef VM_LOG_LEVEL_SET
+#define VM_LOG_LEVEL_SET        VM_LOG_LEVEL_DEFAULT
+#endif
+
+#ifndef VM_LOG_LEVEL_SYNC
+#define VM_LOG_LEVEL_SYNC       VM_LOG_LEVEL_DEFAULT
+#endif
+
+/* Tokenized records (log_tok_*): 1 stores them in the ring, 0 prints them as
+ * text immediately (costs the format strings in flash) */
+#ifndef VM_LOG_TOKENIZED
+#define VM_LOG_TOKENIZED        1
+#endif
+
+/* Record ring size in bytes, power of two. A motor write record is 5-7 bytes */
+#ifndef VM_LOG_RING_SIZE
+#define VM_LOG_RING_SIZE        512
+#endif
+
+/* Drain the ring to the debug UART; 0 keeps records for the BLE log query */
+#ifndef VM_LOG_UART_DRAIN
+#define VM_LOG_UART_DRAIN       VM_DEBUG_ENABLE
+#endif
+
+/* UART drain: at most VM_LOG_DRAIN_BYTES of records every VM_LOG_DRAIN_MS */
+#ifndef VM_LOG_DRAIN_MS
+#define VM_LOG_DRAIN_MS         50
+#endif
+
+#ifndef VM_LOG_DRAIN_BYTES
+#define VM_LOG_DRAIN_BYTES      64
+#endif
+
+/* ========== Tracing ========== */
+
+/* Latency tracepoints (vm_trace.h); 0 compiles them out and leaves the timer free */
+#ifndef VM_TRACE_ENABLE
+#define VM_TRACE_ENABLE         VM_DEBUG_ENABLE
+#endif
+
+/* Records kept, 8 bytes each, power of two up to 256 */
+#ifndef VM_TRACE_RING_SIZE
+#define VM_TRACE_RING_SIZE      128
+#endif
+
+/* Free-running timestamp timer. Must be unused otherwise (not VM_MOTOR_TIMER,
+ * TIMER0 is used for short busy waits by SDK drivers) */
+#ifndef VM_TRACE_TIMER
+#define VM_TRACE_TIMER          JL_TIMER2
+#endif
+
+/* ========== Synchronized Playback ========== */
+
+/* Clock and playout timer (vm_sync.h). Must be unused otherwise, like VM_TRACE_TIMER */
+#ifndef VM_SYNC_TIMER
+#define VM_SYNC_TIMER           JL_TIMER1
+#define VM_SYNC_TIMER_IRQ       IRQ_TIME1_IDX
+#endif
+
+/* Duty changes waiting for their time, 6 bytes each */
+#ifndef VM_SYNC_QUEUE_SIZE
+#define VM_SYNC_QUEUE_SIZE      16
+#endif
+
+/* Longest timer period with nothing queued */
+#ifndef VM_SYNC_TICK_US
+#define VM_SYNC_TICK_US         100000
+#endif
+
+/* Changes further ahead are refused */
+#ifndef VM_SYNC_HORIZON_US
+#define VM_SYNC_HORIZON_US      10000000
+#endif
+
+/* A change applied more than this after its time counts as late */
+#ifndef VM_SYNC_LATE_US
+#define VM_SYNC_LATE_US         1000
+#endif
+
+/* Session ends after this long without sync commands (and nothing queued) */
+#ifndef VM_SYNC_IDLE_MS
+#define VM_SYNC_IDLE_MS         30000
+#endif
+
+#ifndef VM_SYNC_IDLE_POLL_MS
+#define VM_SYNC_IDLE_POLL_MS    1000
 #endif
 
 #endif /* VM_CONFIG_H */
@@ -0,0 +1,214 @@
+/**
+ * Thermal / Current Governor
+ */
+
+#include "app_config.h"  /* Must be first for SDK configuration */
+#include "vm_governor.h"
+#include "vm_config.h"
+#include "vm_motor_control.h"
+#include "vm_battery.h"
+
+#include "system/includes.h"
+#include "asm/adc_api.h"
+
+/* Logging */
+#define VM_LOG_TAG      "VM_GOV"
+#define VM_LOG_LEVEL    VM_LOG_LEVEL_GOV
+#include "vm_log.h"
+
+#if (VM_GOV_RISE_START_C >= VM_GOV_RISE_LIMIT_C) || (VM_GOV_TEMP_START_C >= VM_GOV_TEMP_LIMIT_C)
+#error "Governor derating must start below its limit"
+#endif
+
+/* (target - rise) * alpha must fit in s32 */
+#if (VM_GOV_RISE_FULL_C > 100)
+#error "VM_GOV_RISE_FULL_C too large for the Q8 thermal model"
+#endif
+
+static vm_gov_t g_gov = {
+    .target = VM_MOTOR_DUTY_MAX,
+    .ceiling = VM_MOTOR_DUTY_MAX,
+    .temp_c = VM_GOV_TEMP_NONE,
+};
+static u16 g_poll_timer = 0;
+
+/* ========== Governor ========== */
+
+void vm_gov_reset(vm_gov_t *gov)
+{
+    memset(gov, 0, sizeof(*gov));
+    gov->target = VM_MOTOR_DUTY_MAX;
+    gov->ceiling = VM_MOTOR_DUTY_MAX;
+    gov->temp_c = VM_GOV_TEMP_NONE;
+}
+
+/**
+ * Linear derating: full duty up to start, VM_GOV_MIN_CEILING from limit on
+ */
+static u16 gov_ramp(s32 x_q8, s32 start_q8, s32 limit_q8)
+{
+    if (x_q8 <= start_q8) {
+        return VM_MOTOR_DUTY_MAX;
+    }
+    if (x_q8 >= limit_q8) {
+        return VM_GOV_MIN_CEILING;
+    }
+    return VM_MOTOR_DUTY_MAX -
+           (u32)(VM_MOTOR_DUTY_MAX - VM_GOV_MIN_CEILING) * (x_q8 - start_q8) / (limit_q8 - start_q8);
+}
+
+/**
+ * Highest duty that keeps the loaded pack voltage above the cutoff
+ */
+static u16 gov_battery_ceiling(u16 ocv_mv)
+{
+    u32 cutoff = (u32)VM_GOV_CUTOFF_MV * VM_BAT_CELLS;
+    u32 c;
+
+    if (ocv_mv == 0) {
+        return VM_MOTOR_DUTY_MAX;   /* No estimate yet */
+    }
+    if (ocv_mv <= cutoff) {
+        return 0;
+    }
+    c = (ocv_mv - cutoff) * VM_MOTOR_DUTY_MAX / VM_BAT_LOAD_DROP_MV;
+    return (c > VM_MOTOR_DUTY_MAX) ? VM_MOTOR_DUTY_MAX : (u16)c;
+}
+
+u16 vm_gov_step(vm_gov_t *gov, u16 duty, u16 ocv_mv, s8 temp_c, u32 elapsed_ms)
+{
+    s32 alpha_q16;
+    s32 target_q8;
+    s32 d;
+    u16 c;
+    u32 slew;
+
+    if (duty > VM_MOTOR_DUTY_MAX) {
+        duty = VM_MOTOR_DUTY_MAX;
+    }
+    if (elapsed_ms > 60000) {
+        elapsed_ms = 60000;     /* Keeps elapsed_ms << 16 in range */
+    }
+
+    /* Thermal RC model: rise += (duty * full rise - rise) * dt / tau */
+    alpha_q16 = (elapsed_ms >= VM_GOV_TAU_S * 1000UL) ? 65536 :
+                (s32)((elapsed_ms << 16) / (VM_GOV_TAU_S * 1000UL));
+    target_q8 = (s32)VM_GOV_RISE_FULL_C * 256 * duty / VM_MOTOR_DUTY_MAX;
+    d = (target_q8 - gov->rise_q8) * alpha_q16;
+    gov->rise_q8 += (d >= 0) ? (d + 32768) >> 16 : -((-d + 32768) >> 16);
+
+    gov->flags = 0;
+    gov->target = VM_MOTOR_DUTY_MAX;
+
+    c = gov_ramp(gov->rise_q8, VM_GOV_RISE_START_C * 256, VM_GOV_RISE_LIMIT_C * 256);
+    if (c < VM_MOTOR_DUTY_MAX) {
+        gov->flags |= VM_GOV_FLAG_THERMAL;
+        gov->target = c;
+    }
+
+    c = gov_battery_ceiling(ocv_mv);
+    if (c < VM_MOTOR_DUTY_MAX) {
+        gov->flags |= VM_GOV_FLAG_BATTERY;
+        if (c < gov->target) {
+            gov->target = c;
+        }
+    }
+
+    gov->temp_c = temp_c;
+    if (temp_c != VM_GOV_TEMP_NONE) {
+        c = gov_ramp((s32)temp_c * 256, VM_GOV_TEMP_START_C * 256, VM_GOV_TEMP_LIMIT_C * 256);
+        if (c < VM_MOTOR_DUTY_MAX) {
+            gov->flags |= VM_GOV_FLAG_TEMP;
+            if (c < gov->target) {
+                gov->target = c;
+            }
+        }
+    }
+
+    /* Follow the target smoothly, faster down than up */
+    if (gov->target < gov->ceiling) {
+        slew = (u32)VM_GOV_SLEW_DOWN * elapsed_ms / 1000 + 1;
+        gov->ceiling = ((u32)(gov->ceiling - gov->target) > slew) ? gov->ceiling - slew : gov->target;
+    } else if (gov->target > gov->ceiling) {
+        slew = (u32)VM_GOV_SLEW_UP * elapsed_ms / 1000 + 1;
+        gov->ceiling = ((u32)(gov->target - gov->ceiling) > slew) ? gov->ceiling + slew : gov->target;
+    }
+    return gov->ceiling;
+}
+
+/* ========== Sampling ========== */
+
+static s8 governor_read_temp(void)
+{
+#ifdef VM_GOV_TEMP_ADC_CH
+    /* Linear sensor: VM_GOV_TEMP_MV_25C at 25 degC, VM_GOV_TEMP_UV_PER_C slope */
+    s32 t = 25 + ((s32)adc_get_voltage(VM_GOV_TEMP_ADC_CH) - VM_GOV_TEMP_MV_25C) * 1000 / VM_GOV_TEMP_UV_PER_C;
+
+    if (t < -127) {
+        t = -127;
+    } else if (t > 127) {
+        t = 127;
+    }
+    return (s8)t;
+#else
+    return VM_GOV_TEMP_NONE;
+#endif
+}
+
+static void governor_poll(void *priv)
+{
+    u8 flags = g_gov.flags;
+    u16 ceiling;
+
+    (void)priv;
+
+    ceiling = vm_gov_step(&g_gov, vm_motor_take_avg_duty(), vm_battery_get_mv(),
+                          governor_read_temp(), VM_GOV_POLL_MS);
+    vm_motor_set_limit(ceiling);
+
+    if (g_gov.flags != flags) {
+        log_info("limit %d, flags 0x%02x, rise %d C\n", ceiling, g_gov.flags, g_gov.rise_q8 / 256);
+    }
+}
+
+void vm_governor_init(void)
+{
+    vm_gov_reset(&g_gov);
+    vm_motor_take_avg_duty();   /* Start a fresh averaging window */
+
+#ifdef VM_GOV_TEMP_ADC_CH
+    adc_add_sample_ch(VM_GOV_TEMP_ADC_CH);
+#endif
+
+    if (!g_poll_timer) {
+        g_poll_timer = sys_timer_add(NULL, governor_poll, VM_GOV_POLL_MS);
+    }
+}
+
+void vm_governor_deinit(void)
+{
+    if (g_poll_timer) {
+        sys_timer_del(g_poll_timer);
+        g_poll_timer = 0;
+    }
+    vm_motor_set_limit(VM_MOTOR_DUTY_MAX);
+}
+
+const vm_gov_t *vm_governor_get(void)
+{
+    return &g_gov;
+}
+
+void vm_governor_encode(u8 *buf)
+{
+    s32 rise = g_gov.rise_q8 / 256;
+    u16 duty = vm_motor_get_duty();
+
+    buf[0] = g_gov.ceiling & 0xFF;
+    buf[1] = g_gov.ceiling >> 8;
+    buf[2] = g_gov.flags;
+    buf[3] = (rise > 0xFF) ? 0xFF : (u8)rise;
+    buf[4] = (u8)g_gov.temp_c;
+    buf[5] = duty & 0xFF;
+    buf[6] = duty >> 8;
+}
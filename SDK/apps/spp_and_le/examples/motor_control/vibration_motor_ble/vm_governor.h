@@ -0,0 +1,90 @@
+/**
+ * Thermal / Current Governor
+ *
+ * Puts a duty ceiling on the motor output (vm_motor_set_limit()) so that
+ * long sessions at full intensity neither overheat the MOS driver nor pull
+ * the cell below its cutoff. Every VM_GOV_POLL_MS the poll timer feeds one
+ * step of the estimator below; all of it is integer math on a few words of
+ * state.
+ *
+ * Limiters, each giving a ceiling (0-10000):
+ * - Thermal model: first-order RC estimate of the driver temperature rise,
+ *   integrating the output duty. Steady-state rise at 100 % duty is
+ *   VM_GOV_RISE_FULL_C, time constant VM_GOV_TAU_S. The ceiling ramps from
+ *   10000 at VM_GOV_RISE_START_C down to VM_GOV_MIN_CEILING at
+ *   VM_GOV_RISE_LIMIT_C.
+ * - Battery: keeps the loaded pack voltage (filtered open-circuit voltage
+ *   minus duty * VM_BAT_LOAD_DROP_MV) above VM_GOV_CUTOFF_MV per cell. The
+ *   drop is proportional to the current, so this is the current limit.
+ * - Temperature sensor (only with VM_GOV_TEMP_ADC_CH): same ramp as the
+ *   model between VM_GOV_TEMP_START_C and VM_GOV_TEMP_LIMIT_C.
+ *
+ * The lowest ceiling wins. The applied ceiling follows it smoothly: down
+ * by at most VM_GOV_SLEW_DOWN, up by at most VM_GOV_SLEW_UP per step.
+ *
+ * Reported with the device info governor query (0xB0 0x03).
+ */
+
+#ifndef VM_GOVERNOR_H
+#define VM_GOVERNOR_H
+
+#include "typedef.h"
+
+/* Limiters holding the ceiling below 10000 (vm_gov_t.flags) */
+#define VM_GOV_FLAG_THERMAL     0x01    /* Thermal model */
+#define VM_GOV_FLAG_BATTERY     0x02    /* Battery voltage / current */
+#define VM_GOV_FLAG_TEMP        0x04    /* Temperature sensor */
+
+/* No sensor reading */
+#define VM_GOV_TEMP_NONE        (-128)
+
+/* Governor state (pure, usable on host builds) */
+typedef struct {
+    s32 rise_q8;        /* Estimated temperature rise above ambient, 1/256 degC */
+    u16 target;         /* Lowest limiter ceiling of the last step */
+    u16 ceiling;        /* Applied ceiling (slew limited) */
+    u8  flags;          /* VM_GOV_FLAG_* */
+    s8  temp_c;         /* Last sensor reading, VM_GOV_TEMP_NONE without sensor */
+} vm_gov_t;
+
+/**
+ * Reset governor (cold driver, no limit)
+ */
+void vm_gov_reset(vm_gov_t *gov);
+
+/**
+ * Run one governor step
+ * @param gov Governor
+ * @param duty Output duty over the elapsed time (0-10000)
+ * @param ocv_mv Filtered open-circuit pack voltage, 0 if unknown
+ * @param temp_c Sensor temperature, VM_GOV_TEMP_NONE without sensor
+ * @param elapsed_ms Time since the previous step
+ * @return Ceiling to apply (0-10000)
+ */
+u16 vm_gov_step(vm_gov_t *gov, u16 duty, u16 ocv_mv, s8 temp_c, u32 elapsed_ms);
+
+/**
+ * Start the poll timer
+ */
+void vm_governor_init(void);
+
+/**
+ * Stop the poll timer and lift the limit
+ */
+void vm_governor_deinit(void);
+
+/**
+ * Get the governor state (ceiling, flags, estimated rise)
+ */
+const vm_gov_t *vm_governor_get(void);
+
+/**
+ * Encode the governor query response payload
+ * [ceiling lo][ceiling hi][flags][rise degC][sensor degC][duty lo][duty hi]
+ * @param buf Output buffer (VM_GOV_REPORT_SIZE bytes)
+ */
+void vm_governor_encode(u8 *buf);
+
+#define VM_GOV_REPORT_SIZE      7
+
+#endif /* VM_GOVERNOR_H */
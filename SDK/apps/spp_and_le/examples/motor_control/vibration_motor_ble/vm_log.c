@@ -0,0 +1,243 @@
+/**
+ * Logging - tokenized record ring
+ */
+
+#include "app_config.h"  /* Must be first for SDK configuration */
+#include "vm_config.h"
+
+#include "system/includes.h"
+#include "uart.h"  /* putbyte() */
+#include <stdarg.h>
+
+#include "vm_log.h"
+
+#if (VM_LOG_RING_SIZE & (VM_LOG_RING_SIZE - 1)) || (VM_LOG_RING_SIZE > 0x8000)
+#error "VM_LOG_RING_SIZE must be a power of two up to 32768"
+#endif
+
+#if VM_LOG_RING_SIZE < 2 * VM_LOG_RECORD_MAX
+#error "VM_LOG_RING_SIZE too small"
+#endif
+
+#if VM_LOG_DRAIN_BYTES < VM_LOG_RECORD_MAX
+#error "VM_LOG_DRAIN_BYTES must hold one record"
+#endif
+
+#define RING_MASK       (VM_LOG_RING_SIZE - 1)
+
+static u8 g_ring[VM_LOG_RING_SIZE];
+static u16 g_head = 0;          /* Write position (free running) */
+static u16 g_tail = 0;          /* Read position (free running) */
+static u16 g_drain_timer = 0;
+
+#if VM_LOG_TOKENIZED
+
+static u32 g_last_ms = 0;       /* Time of the last stored record */
+static u16 g_dropped = 0;       /* Records lost to a full ring (saturating) */
+
+/* ========== Encoding ========== */
+
+static u8 log_varint(u8 *p, u32 v)
+{
+    u8 n = 0;
+
+    while (v >= 0x80) {
+        p[n++] = (u8)v | 0x80;
+        v >>= 7;
+    }
+    p[n++] = (u8)v;
+    return n;
+}
+
+/**
+ * Encode one record into rec (VM_LOG_RECORD_MAX bytes)
+ * @return Record length
+ */
+static u8 log_encode(u8 *rec, u8 id, u32 dt, const s32 *args, u8 nargs)
+{
+    u8 tmp[5];
+    u8 len = 2;
+    u8 n;
+    u8 i;
+
+    rec[1] = id;
+    len += log_varint(&rec[len], dt);
+
+    for (i = 0; i < nargs; i++) {
+        /* Zigzag: small negative numbers stay short */
+        n = log_varint(tmp, ((u32)args[i] << 1) ^ (u32)(args[i] >> 31));
+        if (len + n > VM_LOG_RECORD_MAX) {
+            break;
+        }
+        memcpy(&rec[len], tmp, n);
+        len += n;
+    }
+    rec[0] = len;
+    return len;
+}
+
+/* Caller holds the irq lock and checked the room */
+static void log_store(const u8 *rec, u8 len)
+{
+    u8 i;
+
+    for (i = 0; i < len; i++) {
+        g_ring[(g_head + i) & RING_MASK] = rec[i];
+    }
+    g_head += len;
+}
+
+void vm_log_put(u8 id, u8 nargs, ...)
+{
+    s32 args[VM_LOG_MAX_ARGS];
+    u8 rec[VM_LOG_RECORD_MAX];
+    u8 drop_rec[VM_LOG_RECORD_MAX];
+    va_list ap;
+    u32 now;
+    s32 dropped;
+    u8 drop_len = 0;
+    u8 len;
+    u8 i;
+
+    if (nargs > VM_LOG_MAX_ARGS) {
+        nargs = VM_LOG_MAX_ARGS;
+    }
+    va_start(ap, nargs);
+    for (i = 0; i < nargs; i++) {
+        args[i] = va_arg(ap, int);
+    }
+    va_end(ap);
+
+    now = jiffies_msec();
+
+    local_irq_disable();
+    if (g_dropped) {
+        dropped = g_dropped;
+        drop_len = log_encode(drop_rec, VM_LOG_ID_DROPPED, now - g_last_ms, &dropped, 1);
+    }
+    len = log_encode(rec, id, drop_len ? 0 : now - g_last_ms, args, nargs);
+
+    /* The count goes in with the next record that fits, so a run of drops is one DROPPED record */
+    if (VM_LOG_RING_SIZE - (u16)(g_head - g_tail) < drop_len + len) {
+        g_dropped += (g_dropped < 0xFFFF);
+    } else {
+        log_store(drop_rec, drop_len);
+        log_store(rec, len);
+        g_dropped = 0;
+        g_last_ms = now;
+    }
+    local_irq_enable();
+}
+
+#else /* !VM_LOG_TOKENIZED */
+
+void vm_log_put(u8 id, u8 nargs, ...)
+{
+    s32 args[VM_LOG_MAX_ARGS] = {0};
+    va_list ap;
+    u8 i;
+
+    if (nargs > VM_LOG_MAX_ARGS) {
+        nargs = VM_LOG_MAX_ARGS;
+    }
+    va_start(ap, nargs);
+    for (i = 0; i < nargs; i++) {
+        args[i] = va_arg(ap, int);
+    }
+    va_end(ap);
+
+    /*
+     * One printf per message with its format as a literal, so the compiler
+     * checks every vm_log_msgs.h entry against VM_LOG_MAX_ARGS integers
+     * (%s or a fifth conversion is a -Wformat warning). Formats with fewer
+     * conversions ignore the surplus arguments.
+     */
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wformat-extra-args"
+    switch (id) {
+#define VM_LOG_MSG(id, tag, fmt)    \
+    case VM_LOG_ID_##id:            \
+        printf("[" tag "] " fmt "\n", args[0], args[1], args[2], args[3]); \
+        break;
+#include "vm_log_msgs.h"
+#undef VM_LOG_MSG
+    default:
+        break;
+    }
+#pragma GCC diagnostic pop
+}
+
+#endif /* VM_LOG_TOKENIZED */
+
+/* ========== Drain ========== */
+
+u16 vm_log_read(u8 *buf, u16 size)
+{
+    u16 copied = 0;
+    u8 len;
+    u8 i;
+
+    local_irq_disable();
+    while (g_tail != g_head) {
+        len = g_ring[g_tail & RING_MASK];
+        if (copied + len > size) {
+            break;
+        }
+        for (i = 0; i < len; i++) {
+            buf[copied++] = g_ring[(g_tail + i) & RING_MASK];
+        }
+        g_tail += len;
+    }
+    local_irq_enable();
+
+    return copied;
+}
+
+u16 vm_log_pending(void)
+{
+    return g_head - g_tail;
+}
+
+#if VM_LOG_TOKENIZED && VM_LOG_UART_DRAIN
+static void log_drain_poll(void *priv)
+{
+    u8 buf[VM_LOG_DRAIN_BYTES];
+    u16 n;
+    u16 pos = 0;
+    u8 len;
+    u8 sum;
+    u8 i;
+
+    (void)priv;
+
+    n = vm_log_read(buf, sizeof(buf));
+    while (pos < n) {
+        len = buf[pos];
+        sum = 0;
+        putbyte(VM_LOG_UART_SYNC);
+        for (i = 0; i < len; i++) {
+            putbyte(buf[pos + i]);
+            sum += buf[pos + i];
+        }
+        putbyte(~sum);
+        pos += len;
+    }
+}
+#endif
+
+void vm_log_init(void)
+{
+#if VM_LOG_TOKENIZED && VM_LOG_UART_DRAIN
+    if (!g_drain_timer) {
+        g_drain_timer = sys_timer_add(NULL, log_drain_poll, VM_LOG_DRAIN_MS);
+    }
+#endif
+}
+
+void vm_log_deinit(void)
+{
+    if (g_drain_timer) {
+        sys_timer_del(g_drain_timer);
+        g_drain_timer = 0;
+    }
+}
@@ -0,0 +1,136 @@
+/**
+ * Logging
+ *
+ * Compile-time levels: every module sets its tag and level, then includes
+ * this header last:
+ *
+ *   #define VM_LOG_TAG      "VM_GOV"
+ *   #define VM_LOG_LEVEL    VM_LOG_LEVEL_GOV
+ *   #include "vm_log.h"
+ *
+ * Calls above the module level expand to nothing: arguments are not
+ * evaluated and the format strings are not linked in. Levels default to
+ * VM_LOG_LEVEL_DEFAULT (vm_config.h).
+ *
+ *   log_error / log_info / log_debug         printf("[TAG] ...") as before
+ *   log_tok_error / log_tok_info / log_tok_debug(ID, args...)
+ *                                            tokenized record, for hot paths
+ *
+ * A tokenized record holds the index of an entry in vm_log_msgs.h and up to
+ * VM_LOG_MAX_ARGS integer arguments; formatting happens on the host
+ * (tools/log_decode.py). Records go into a RAM ring and are drained later:
+ * over the debug UART by a timer (VM_LOG_UART_DRAIN), or over BLE with the
+ * device info log query (0xB0 0x04). With VM_LOG_TOKENIZED set to 0 they
+ * are printed as text right away instead.
+ *
+ * Record: [len][id][dt varint][arg zigzag varint]...
+ *   len   whole record in bytes, at most VM_LOG_RECORD_MAX
+ *   dt    milliseconds since the previous stored record (since boot for the
+ *         first one)
+ *   args  in order; the ones that do not fit in VM_LOG_RECORD_MAX are cut
+ * A full ring drops new records; the count is stored as a DROPPED record
+ * ahead of the next record, once there is room for both.
+ *
+ * UART framing: [VM_LOG_UART_SYNC][record][~sum of record bytes], between
+ * text lines.
+ */
+
+#ifndef VM_LOG_H
+#define VM_LOG_H
+
+#include "typedef.h"
+#include "vm_config.h"
+
+/* Levels */
+#define VM_LOG_LEVEL_NONE       0
+#define VM_LOG_LEVEL_ERROR      1
+#define VM_LOG_LEVEL_INFO       2
+#define VM_LOG_LEVEL_DEBUG      3
+
+/* Record limits: a record always fits one default-MTU log query response */
+#define VM_LOG_MAX_ARGS         4
+#define VM_LOG_RECORD_MAX       17
+
+/* UART record marker (ASCII record separator, never in text logs) */
+#define VM_LOG_UART_SYNC        0x1E
+
+/* Message IDs (vm_log_msgs.h) */
+enum {
+#define VM_LOG_MSG(id, tag, fmt)    VM_LOG_ID_##id,
+#include "vm_log_msgs.h"
+#undef VM_LOG_MSG
+    VM_LOG_ID_COUNT
+};
+
+/**
+ * Store a tokenized record (use the log_tok_* macros)
+ * @param id VM_LOG_ID_*
+ * @param nargs Number of int arguments that follow
+ */
+void vm_log_put(u8 id, u8 nargs, ...);
+
+/**
+ * Take whole records out of the ring
+ * @param buf Output buffer
+ * @param size Buffer size
+ * @return Bytes copied (0 if empty or the next record does not fit)
+ */
+u16 vm_log_read(u8 *buf, u16 size);
+
+/**
+ * Bytes waiting in the ring
+ */
+u16 vm_log_pending(void);
+
+/**
+ * Start the UART drain timer (VM_LOG_UART_DRAIN)
+ */
+void vm_log_init(void);
+
+/**
+ * Stop the UART drain timer
+ */
+void vm_log_deinit(void);
+
+/* ========== Per-module macros ========== */
+
+#ifndef VM_LOG_TAG
+#define VM_LOG_TAG              "VM"
+#endif
+
+#ifndef VM_LOG_LEVEL
+#define VM_LOG_LEVEL            VM_LOG_LEVEL_DEFAULT
+#endif
+
+/* Argument count 0..VM_LOG_MAX_ARGS (GNU ## swallows the comma when empty),
+ * more arguments fail to compile on the undeclared vm_log_too_many_args */
+#define VM_LOG_NARGS(...)       VM_LOG_NARGS_(0, ##__VA_ARGS__, vm_log_too_many_args, 4, 3, 2, 1, 0)
+#define VM_LOG_NARGS_(_0, _1, _2, _3, _4, _5, n, ...)   n
+
+#define VM_LOG_TOK(id, ...)     vm_log_put(VM_LOG_ID_##id, VM_LOG_NARGS(__VA_ARGS__), ##__VA_ARGS__)
+
+#if VM_LOG_LEVEL >= VM_LOG_LEVEL_ERROR
+#define log_error(fmt, ...)     printf("[" VM_LOG_TAG "_ERROR] " fmt, ##__VA_ARGS__)
+#define log_tok_error(id, ...)  VM_LOG_TOK(id, ##__VA_ARGS__)
+#else
+#define log_error(fmt, ...)     ((void)0)
+#define log_tok_error(id, ...)  ((void)0)
+#endif
+
+#if VM_LOG_LEVEL >= VM_LOG_LEVEL_INFO
+#define log_info(fmt, ...)      printf("[" VM_LOG_TAG "] " fmt, ##__VA_ARGS__)
+#define log_tok_info(id, ...)   VM_LOG_TOK(id, ##__VA_ARGS__)
+#else
+#define log_info(fmt, ...)      ((void)0)
+#define log_tok_info(id, ...)   ((void)0)
+#endif
+
+#if VM_LOG_LEVEL >= VM_LOG_LEVEL_DEBUG
+#define log_debug(fmt, ...)     printf("[" VM_LOG_TAG "] " fmt, ##__VA_ARGS__)
+#define log_tok_debug(id, ...)  VM_LOG_TOK(id, ##__VA_ARGS__)
+#else
+#define log_debug(fmt, ...)     ((void)0)
+#define log_tok_debug(id, ...)  ((void)0)
+#endif
+
+#endif /* VM_LOG_H */
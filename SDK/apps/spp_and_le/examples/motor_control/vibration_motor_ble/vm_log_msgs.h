@@ -0,0 +1,24 @@
+/**
+ * Tokenized Log Messages
+ *
+ * One VM_LOG_MSG(id, tag, format) per message logged with log_tok_*().
+ * The firmware only stores the index of the entry; the format string is
+ * read back from this file by tools/log_decode.py. Append new entries at
+ * the end and never reorder or delete one, so captures from older builds
+ * still decode.
+ *
+ * Formats take at most VM_LOG_MAX_ARGS integer conversions (%d %u %x %X %c,
+ * with flags and width), no %s, no trailing newline. The text build
+ * (VM_LOG_TOKENIZED 0) passes each one to printf as a literal, so -Wformat
+ * reports entries that break this.
+ */
+
+/* Index 0: records dropped because the ring was full */
+VM_LOG_MSG(DROPPED,         "VM_LOG",       "%u records dropped")
+
+/* vm_ble_service.c */
+VM_LOG_MSG(MOTOR_DUTY,      "VM_BLE",       "Motor duty set to %d/10000")
+VM_LOG_MSG(OTA_ACK,         "VM_BLE",       "OTA: ACK sent for seq=%d")
+
+/* custom_dual_bank_ota.c */
+VM_LOG_MSG(OTA_PROGRESS,    "CUSTOM_OTA",   "Custom OTA: Written %u/%u bytes (%u%%)")
@@ -0,0 +1,264 @@
+/**
+ * Long Range Profile
+ */
+
+#include "app_config.h"  /* Must be first for SDK configuration */
+#include "vm_long_range.h"
+#include "vm_config.h"
+
+#include "system/includes.h"
+#include "gatt_common/le_gatt_common.h"
+#include "btstack/btstack_event.h"
+#include "le/ble_api.h"
+#include "le/le_common_define.h"
+#if VM_LONG_RANGE_ENABLE
+#include "btcontroller_modules.h"  /* le_set_ext_adv_param_t / le_set_ext_adv_data_t */
+#endif
+
+/* Logging */
+#define VM_LOG_TAG      "VM_LR"
+#define VM_LOG_LEVEL    VM_LOG_LEVEL_LR
+#include "vm_log.h"
+
+/* HCI value of the fast PHY */
+#define LR_FAST_PHY         (((VM_LR_FAST_PHY) == CONN_SET_2M_PHY) ? VM_LR_PHY_2M : VM_LR_PHY_1M)
+
+/* Samples to wait for a PHY update event before allowing another request */
+#define LR_PENDING_SAMPLES  5
+
+static u16 g_conn_handle = 0;
+static vm_lr_link_t g_link;
+static u16 g_rssi_timer = 0;
+
+#if VM_LONG_RANGE_ENABLE
+static adv_cfg_t *g_adv_cfg = NULL;
+
+/* Connectable, non-scannable extended advertising on Coded PHY */
+static le_set_ext_adv_param_t g_ext_adv_param = {
+    .Advertising_Handle = 0,
+    .Advertising_Event_Properties = 1,
+    .Primary_Advertising_Interval_Min = {VM_ADV_FAST_INTERVAL & 0xFF, VM_ADV_FAST_INTERVAL >> 8, 0},
+    .Primary_Advertising_Interval_Max = {VM_ADV_FAST_INTERVAL & 0xFF, VM_ADV_FAST_INTERVAL >> 8, 0},
+    .Primary_Advertising_Channel_Map = 7,
+    .Primary_Advertising_PHY = ADV_SET_CODED_PHY,
+    .Secondary_Advertising_PHY = ADV_SET_CODED_PHY,
+    .Advertising_SID = CUR_ADVERTISING_SID,
+};
+
+static le_set_ext_adv_data_t g_ext_adv_data = {
+    .Advertising_Handle = 0,
+    .Operation = 3,             /* Complete data */
+    .Fragment_Preference = 0,
+    .Advertising_Data_Length = 0,
+};
+#endif
+
+/* ========== Link quality tracker ========== */
+
+void vm_lr_link_reset(vm_lr_link_t *link, u8 phy)
+{
+    memset(link, 0, sizeof(*link));
+    link->phy = phy;
+}
+
+void vm_lr_link_set_phy(vm_lr_link_t *link, u8 phy)
+{
+    link->pending = 0;
+    link->weak_cnt = 0;
+    link->strong_cnt = 0;
+    link->dwell_ms = 0;
+    if (phy) {
+        link->phy = phy;
+    }
+}
+
+static u8 lr_count(u8 cnt, u8 hit)
+{
+    if (!hit) {
+        return 0;
+    }
+    return (cnt < 0xFF) ? cnt + 1 : cnt;
+}
+
+u8 vm_lr_link_step(vm_lr_link_t *link, s8 rssi, u32 elapsed_ms)
+{
+    s16 sample = (s16)rssi * 16;
+    s16 avg_dbm;
+    u8 target = 0;
+
+    /* Exponential moving average, alpha = 1/4 */
+    if (!link->has_avg) {
+        link->rssi_avg_q4 = sample;
+        link->has_avg = 1;
+    } else {
+        link->rssi_avg_q4 += (sample - link->rssi_avg_q4) / 4;
+    }
+    link->dwell_ms += elapsed_ms;
+
+    if (link->pending) {
+        /* No update event in time: give up and restart the dwell period */
+        if (--link->pending == 0) {
+            link->dwell_ms = 0;
+        }
+        return 0;
+    }
+
+    avg_dbm = link->rssi_avg_q4 / 16;
+
+    if (link->phy == VM_LR_PHY_CODED) {
+        link->weak_cnt = 0;
+        link->strong_cnt = lr_count(link->strong_cnt, avg_dbm > VM_LR_RSSI_STRONG_DBM);
+        if (link->strong_cnt >= VM_LR_SWITCH_SAMPLES && link->dwell_ms >= VM_LR_MIN_DWELL_MS) {
+            target = LR_FAST_PHY;
+        }
+    } else {
+        link->strong_cnt = 0;
+        link->weak_cnt = lr_count(link->weak_cnt, avg_dbm < VM_LR_RSSI_WEAK_DBM);
+        if (link->weak_cnt >= VM_LR_SWITCH_SAMPLES && link->dwell_ms >= VM_LR_MIN_DWELL_MS) {
+            target = VM_LR_PHY_CODED;
+        }
+    }
+
+    if (target) {
+        link->pending = LR_PENDING_SAMPLES;
+        link->weak_cnt = 0;
+        link->strong_cnt = 0;
+    }
+    return target;
+}
+
+/* ========== Connection side ========== */
+
+static void lr_request_phy(u8 phy)
+{
+    u8 mask = (phy == VM_LR_PHY_CODED) ? CONN_SET_CODED_PHY : VM_LR_FAST_PHY;
+    u16 options = (phy == VM_LR_PHY_CODED) ? VM_LR_CODED_OPTION : CONN_SET_PHY_OPTIONS_NONE;
+
+    log_info("rssi_avg=%d, request phy %d\n", vm_lr_get_rssi_avg(), phy);
+    ble_comm_set_connection_data_phy(g_conn_handle, mask, mask, options);
+}
+
+static void lr_rssi_poll(void *priv)
+{
+    s8 rssi;
+    u8 target;
+
+    (void)priv;
+
+    rssi = vm_lr_get_rssi();
+    if (rssi == VM_LR_RSSI_INVALID || rssi == 0) {
+        return;
+    }
+
+    target = vm_lr_link_step(&g_link, rssi, VM_LR_RSSI_POLL_MS);
+    if (target) {
+        lr_request_phy(target);
+    }
+}
+
+int vm_lr_init(void *adv_cfg)
+{
+#if VM_LONG_RANGE_ENABLE
+    g_adv_cfg = (adv_cfg_t *)adv_cfg;
+    vm_lr_adv_sync();
+    log_info("long range: coded adv, weak<%d strong>%d dBm\n",
+             VM_LR_RSSI_WEAK_DBM, VM_LR_RSSI_STRONG_DBM);
+#else
+    (void)adv_cfg;
+#endif
+    vm_lr_link_reset(&g_link, 0);
+    return 0;
+}
+
+void vm_lr_adv_sync(void)
+{
+#if VM_LONG_RANGE_ENABLE
+    u8 len;
+
+    if (!g_adv_cfg) {
+        return;
+    }
+
+    g_ext_adv_param.Primary_Advertising_Interval_Min[0] = g_adv_cfg->adv_interval & 0xFF;
+    g_ext_adv_param.Primary_Advertising_Interval_Min[1] = g_adv_cfg->adv_interval >> 8;
+    g_ext_adv_param.Primary_Advertising_Interval_Max[0] = g_adv_cfg->adv_interval & 0xFF;
+    g_ext_adv_param.Primary_Advertising_Interval_Max[1] = g_adv_cfg->adv_interval >> 8;
+
+    len = g_adv_cfg->adv_data_len;
+    if (len > sizeof(g_ext_adv_data.Advertising_Data)) {
+        len = sizeof(g_ext_adv_data.Advertising_Data);
+    }
+    memcpy(g_ext_adv_data.Advertising_Data, g_adv_cfg->adv_data, len);
+    g_ext_adv_data.Advertising_Data_Length = len;
+
+    ble_gatt_server_set_ext_adv_config(&g_ext_adv_param, &g_ext_adv_data);
+    if (ble_gatt_server_get_work_state() == BLE_ST_ADV) {
+        ble_op_set_ext_adv_data(&g_ext_adv_data, sizeof(g_ext_adv_data));
+    }
+#endif
+}
+
+void vm_lr_on_connect(u16 conn_handle)
+{
+    g_conn_handle = conn_handle;
+
+    /* A central connecting through Coded PHY extended advertising lands on Coded PHY */
+    vm_lr_link_reset(&g_link, VM_LONG_RANGE_ENABLE ? VM_LR_PHY_CODED : VM_LR_PHY_1M);
+
+#if VM_LONG_RANGE_ENABLE
+    if (!g_rssi_timer) {
+        g_rssi_timer = sys_timer_add(NULL, lr_rssi_poll, VM_LR_RSSI_POLL_MS);
+    }
+#endif
+}
+
+void vm_lr_on_disconnect(void)
+{
+    if (g_rssi_timer) {
+        sys_timer_del(g_rssi_timer);
+        g_rssi_timer = 0;
+    }
+    g_conn_handle = 0;
+    vm_lr_link_reset(&g_link, 0);
+}
+
+void vm_lr_on_phy_update(const u8 *hci_event)
+{
+    u8 phy = 0;
+
+    if (!hci_event) {
+        return;
+    }
+
+    if (hci_event_le_meta_get_phy_update_complete_status(hci_event) == 0) {
+        phy = hci_event_le_meta_get_phy_update_complete_tx_phy(hci_event);
+    }
+    vm_lr_link_set_phy(&g_link, phy);
+    log_info("phy update: %s, phy=%d\n", phy ? "ok" : "fail", g_link.phy);
+}
+
+u8 vm_lr_is_enabled(void)
+{
+    return VM_LONG_RANGE_ENABLE;
+}
+
+u8 vm_lr_get_phy(void)
+{
+    return g_conn_handle ? g_link.phy : 0;
+}
+
+s8 vm_lr_get_rssi(void)
+{
+    if (!g_conn_handle) {
+        return VM_LR_RSSI_INVALID;
+    }
+    return ble_vendor_get_peer_rssi(g_conn_handle);
+}
+
+s8 vm_lr_get_rssi_avg(void)
+{
+    if (!g_conn_handle || !g_link.has_avg) {
+        return VM_LR_RSSI_INVALID;
+    }
+    return (s8)(g_link.rssi_avg_q4 / 16);
+}
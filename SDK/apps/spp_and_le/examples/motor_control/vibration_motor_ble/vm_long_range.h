@@ -0,0 +1,112 @@
+/**
+ * Long Range Profile
+ *
+ * Opt-in (VM_LONG_RANGE_ENABLE):
+ * - Connectable extended advertising on Coded PHY (primary + secondary),
+ *   carrying the same AD structures as the legacy advertising data
+ * - After connect, RSSI is sampled every VM_LR_RSSI_POLL_MS and low-pass
+ *   filtered. The link moves to Coded PHY when it stays below
+ *   VM_LR_RSSI_WEAK_DBM and back to VM_LR_FAST_PHY when it stays above
+ *   VM_LR_RSSI_STRONG_DBM, with VM_LR_SWITCH_SAMPLES / VM_LR_MIN_DWELL_MS
+ *   as hysteresis
+ *
+ * PHY tracking and RSSI reads also work with long range disabled, so the
+ * device info link query (0xB0 0x01) is always available.
+ */
+
+#ifndef VM_LONG_RANGE_H
+#define VM_LONG_RANGE_H
+
+#include "typedef.h"
+
+/* PHY values as reported by HCI LE PHY Update Complete */
+#define VM_LR_PHY_1M        1
+#define VM_LR_PHY_2M        2
+#define VM_LR_PHY_CODED     3
+
+/* RSSI value reported when no sample is available */
+#define VM_LR_RSSI_INVALID  127
+
+/* Link quality tracker (pure state, usable on host builds) */
+typedef struct {
+    s16 rssi_avg_q4;    /* Filtered RSSI in 1/16 dBm */
+    u32 dwell_ms;       /* Time spent on current PHY */
+    u8  phy;            /* Current VM_LR_PHY_* */
+    u8  has_avg;        /* rssi_avg_q4 holds at least one sample */
+    u8  weak_cnt;       /* Consecutive samples below VM_LR_RSSI_WEAK_DBM */
+    u8  strong_cnt;     /* Consecutive samples above VM_LR_RSSI_STRONG_DBM */
+    u8  pending;        /* Samples left to wait for a requested PHY update */
+} vm_lr_link_t;
+
+/**
+ * Reset tracker for a new connection
+ * @param link Tracker
+ * @param phy PHY the connection was established on (VM_LR_PHY_*)
+ */
+void vm_lr_link_reset(vm_lr_link_t *link, u8 phy);
+
+/**
+ * Feed one RSSI sample and run the hysteresis
+ * @param link Tracker
+ * @param rssi Raw RSSI sample in dBm
+ * @param elapsed_ms Time since the previous sample
+ * @return PHY to request (VM_LR_PHY_*), 0 to stay
+ */
+u8 vm_lr_link_step(vm_lr_link_t *link, s8 rssi, u32 elapsed_ms);
+
+/**
+ * Record a completed PHY update
+ * @param link Tracker
+ * @param phy New PHY (VM_LR_PHY_*), 0 if the update failed
+ */
+void vm_lr_link_set_phy(vm_lr_link_t *link, u8 phy);
+
+/**
+ * Initialize long range profile
+ * @param adv_cfg Advertising config registered with ble_gatt_server_set_adv_config()
+ * @return 0 on success
+ */
+int vm_lr_init(void *adv_cfg);
+
+/**
+ * Copy interval and advertising data from the legacy adv config into the
+ * extended advertising set, updating live data if advertising
+ * No-op when long range is disabled
+ */
+void vm_lr_adv_sync(void);
+
+/**
+ * Connection lifecycle hooks
+ */
+void vm_lr_on_connect(u16 conn_handle);
+void vm_lr_on_disconnect(void);
+
+/**
+ * Handle GATT_COMM_EVENT_CONNECTION_PHY_UPDATE_COMPLETE
+ * @param hci_event Raw HCI LE meta event (ext_param of the GATT event)
+ */
+void vm_lr_on_phy_update(const u8 *hci_event);
+
+/**
+ * Long range profile compiled in
+ */
+u8 vm_lr_is_enabled(void);
+
+/**
+ * Current connection PHY (VM_LR_PHY_*), 0 if not connected
+ */
+u8 vm_lr_get_phy(void);
+
+/**
+ * Sample peer RSSI now
+ * @return RSSI in dBm, VM_LR_RSSI_INVALID if not connected
+ */
+s8 vm_lr_get_rssi(void);
+
+/**
+ * Filtered RSSI used for PHY selection
+ * @return RSSI in dBm, VM_LR_RSSI_INVALID if no sample yet
+ */
+s8 vm_lr_get_rssi_avg(void);
+
+#endif /* VM_LONG_RANGE_H */
@@ -0,0 +1,249 @@
+/**
+ * Fixed-Block Memory Pools
+ */
+
+#include "app_config.h"  /* Must be first for SDK configuration */
+#include "vm_mem_pool.h"
+#include "vm_config.h"
+
+#include "system/includes.h"
+#include "gatt_common/le_gatt_common.h"  /* ble_comm_ram_malloc / ble_comm_ram_free */
+
+/* Logging */
+#define VM_LOG_TAG      "VM_MEM"
+#define VM_LOG_LEVEL    VM_LOG_LEVEL_MEM
+#include "vm_log.h"
+
+/* Round up to whole words so every block stays 4-byte aligned */
+#define POOL_ALIGN(size)    (((size) + 3) & ~3)
+
+#define BLE_BLOCK_SIZE      POOL_ALIGN(VM_POOL_BLE_BLOCK_SIZE)
+#define OTA_BLOCK_SIZE      POOL_ALIGN(VM_POOL_OTA_BLOCK_SIZE)
+
+#if (VM_POOL_BLE_BLOCKS < 1) || (VM_POOL_BLE_BLOCKS > VM_POOL_MAX_BLOCKS) || \
+    (VM_POOL_OTA_BLOCKS < 1) || (VM_POOL_OTA_BLOCKS > VM_POOL_MAX_BLOCKS)
+#error "VM_POOL_*_BLOCKS must be within 1..VM_POOL_MAX_BLOCKS"
+#endif
+
+static u32 g_ble_storage[VM_POOL_BLE_BLOCKS * BLE_BLOCK_SIZE / 4];
+static u32 g_ota_storage[VM_POOL_OTA_BLOCKS * OTA_BLOCK_SIZE / 4];
+
+static u8 g_ble_links[VM_POOL_BLE_BLOCKS];
+static u8 g_ota_links[VM_POOL_OTA_BLOCKS];
+
+static vm_pool_t g_pools[VM_POOL_COUNT];
+static u8 g_initialized = 0;
+
+/* ========== Pool ========== */
+
+void vm_pool_init(vm_pool_t *pool, void *storage, u8 *links, u16 block_size, u8 block_count)
+{
+    u8 i;
+
+    memset(pool, 0, sizeof(*pool));
+    pool->storage = (u8 *)storage;
+    pool->links = links;
+    pool->block_size = block_size;
+    pool->block_count = block_count;
+
+    for (i = 0; i < block_count; i++) {
+        links[i] = (i + 1 < block_count) ? i + 1 : VM_POOL_LINK_END;
+    }
+    pool->free_head = block_count ? 0 : VM_POOL_LINK_END;
+}
+
+void *vm_pool_alloc(vm_pool_t *pool, u32 size)
+{
+    u8 index;
+
+    if (size > pool->max_request) {
+        pool->max_request = (size > 0xFFFF) ? 0xFFFF : (u16)size;
+    }
+
+    if (size > pool->block_size || pool->free_head == VM_POOL_LINK_END) {
+        if (pool->fail_count < 0xFFFF) {
+            pool->fail_count++;
+        }
+        return NULL;
+    }
+
+    index = pool->free_head;
+    pool->free_head = pool->links[index];
+    pool->links[index] = VM_POOL_LINK_USED;
+
+    pool->used++;
+    if (pool->used > pool->high_water) {
+        pool->high_water = pool->used;
+    }
+
+    return pool->storage + (u32)index * pool->block_size;
+}
+
+u8 vm_pool_owns(const vm_pool_t *pool, const void *ptr)
+{
+    const u8 *p = (const u8 *)ptr;
+
+    return p >= pool->storage &&
+           p < pool->storage + (u32)pool->block_count * pool->block_size;
+}
+
+int vm_pool_free(vm_pool_t *pool, void *ptr)
+{
+    u32 offset;
+    u8 index;
+
+    if (!ptr || !vm_pool_owns(pool, ptr)) {
+        return -1;
+    }
+
+    offset = (u32)((u8 *)ptr - pool->storage);
+    if (offset % pool->block_size) {
+        return -1;
+    }
+
+    index = offset / pool->block_size;
+    if (pool->links[index] != VM_POOL_LINK_USED) {
+        return -1;      /* Double free */
+    }
+
+    pool->links[index] = pool->free_head;
+    pool->free_head = index;
+    pool->used--;
+    return 0;
+}
+
+/* ========== Subsystem pools ========== */
+
+static void mem_init(void)
+{
+    vm_pool_init(&g_pools[VM_POOL_BLE], g_ble_storage, g_ble_links,
+                 BLE_BLOCK_SIZE, VM_POOL_BLE_BLOCKS);
+    vm_pool_init(&g_pools[VM_POOL_OTA], g_ota_storage, g_ota_links,
+                 OTA_BLOCK_SIZE, VM_POOL_OTA_BLOCKS);
+    g_initialized = 1;
+}
+
+void *vm_mem_alloc(u8 pool_id, u32 size)
+{
+    void *ptr;
+
+    if (pool_id >= VM_POOL_COUNT) {
+        return NULL;
+    }
+
+    local_irq_disable();
+    /* Lazy init: the BLE pool is needed by ble_comm_init() before any app init runs */
+    if (!g_initialized) {
+        mem_init();
+    }
+    ptr = vm_pool_alloc(&g_pools[pool_id], size);
+    local_irq_enable();
+
+    if (!ptr) {
+        log_error("pool %d: alloc %d failed (block=%d, used=%d/%d)\n", pool_id, size,
+                  g_pools[pool_id].block_size, g_pools[pool_id].used, g_pools[pool_id].block_count);
+    }
+    return ptr;
+}
+
+void vm_mem_free(u8 pool_id, void *ptr)
+{
+    int ret;
+
+    if (!ptr || pool_id >= VM_POOL_COUNT) {
+        return;
+    }
+
+    local_irq_disable();
+    ret = vm_pool_free(&g_pools[pool_id], ptr);
+    local_irq_enable();
+
+    if (ret != 0) {
+        log_error("pool %d: bad free %x\n", pool_id, (u32)ptr);
+    }
+}
+
+const vm_pool_t *vm_mem_get_pool(u8 pool_id)
+{
+    if (pool_id >= VM_POOL_COUNT) {
+        return NULL;
+    }
+    if (!g_initialized) {
+        local_irq_disable();
+        if (!g_initialized) {
+            mem_init();
+        }
+        local_irq_enable();
+    }
+    return &g_pools[pool_id];
+}
+
+u8 vm_mem_encode_diag(u8 *buf, u8 buf_size)
+{
+    u8 id;
+    u8 *p;
+
+    if (!buf || buf_size < VM_MEM_DIAG_SIZE) {
+        return 0;
+    }
+
+    buf[0] = VM_MEM_DIAG_VERSION;
+    buf[1] = VM_POOL_COUNT;
+    p = buf + VM_MEM_DIAG_HEADER_SIZE;
+
+    for (id = 0; id < VM_POOL_COUNT; id++) {
+        const vm_pool_t *pool = vm_mem_get_pool(id);
+
+        p[0] = id;
+        p[1] = pool->block_size & 0xFF;
+        p[2] = pool->block_size >> 8;
+        p[3] = pool->block_count;
+        p[4] = pool->used;
+        p[5] = pool->high_water;
+        p[6] = pool->fail_count & 0xFF;
+        p[7] = pool->fail_count >> 8;
+        p[8] = pool->max_request & 0xFF;
+        p[9] = pool->max_request >> 8;
+        p += VM_MEM_DIAG_POOL_SIZE;
+    }
+
+    return VM_MEM_DIAG_SIZE;
+}
+
+void vm_mem_dump(void)
+{
+#if VM_LOG_LEVEL >= VM_LOG_LEVEL_INFO
+    static const char *const names[VM_POOL_COUNT] = {"ble", "ota"};
+    u8 id;
+
+    for (id = 0; id < VM_POOL_COUNT; id++) {
+        const vm_pool_t *pool = vm_mem_get_pool(id);
+        log_info("%s: %dx%d, used=%d, hwm=%d, fail=%d, max_req=%d\n", names[id],
+                 pool->block_count, pool->block_size, pool->used,
+                 pool->high_water, pool->fail_count, pool->max_request);
+    }
+#endif
+}
+
+/* ========== GATT buffer hooks (override weak defaults in le_gatt_common.c) ========== */
+
+void *ble_comm_ram_malloc(u32 size)
+{
+    void *ptr = vm_mem_alloc(VM_POOL_BLE, size);
+
+    if (!ptr) {
+        /* Keep BLE working on a misconfigured pool; fail_count shows it in diagnostics */
+        log_error("BLE pool too small for %d bytes, using heap\n", size);
+        ptr = malloc(size);
+    }
+    return ptr;
+}
+
+void ble_comm_ram_free(void *ptr)
+{
+    if (vm_pool_owns(vm_mem_get_pool(VM_POOL_BLE), ptr)) {
+        vm_mem_free(VM_POOL_BLE, ptr);
+    } else {
+        free(ptr);
+    }
+}
@@ -0,0 +1,119 @@
+/**
+ * Fixed-Block Memory Pools
+ *
+ * Static pools sized at build time (VM_POOL_* in vm_config.h), one per
+ * subsystem, so long-lived buffers never go through the system heap:
+ *
+ *   VM_POOL_BLE      GATT control/send buffer (ble_comm_init / ble_comm_exit)
+ *   VM_POOL_OTA      OTA page slot (START .. FINISH/abort)
+ *
+ * Every pool counts blocks in use, high-water mark, failed allocations and
+ * the largest request seen. The counters are readable over the diagnostics
+ * characteristic (vm_mem_encode_diag()):
+ *
+ *   [version=0x01][pool_count] then per pool:
+ *   [id][block_size lo][block_size hi][blocks][used][high_water]
+ *   [fail lo][fail hi][max_request lo][max_request hi]
+ */
+
+#ifndef VM_MEM_POOL_H
+#define VM_MEM_POOL_H
+
+#include "typedef.h"
+
+/* Pool IDs */
+#define VM_POOL_BLE             0
+#define VM_POOL_OTA             1
+#define VM_POOL_COUNT           2
+
+/* Diagnostics layout */
+#define VM_MEM_DIAG_VERSION     0x01
+#define VM_MEM_DIAG_HEADER_SIZE 2
+#define VM_MEM_DIAG_POOL_SIZE   10
+#define VM_MEM_DIAG_SIZE        (VM_MEM_DIAG_HEADER_SIZE + VM_POOL_COUNT * VM_MEM_DIAG_POOL_SIZE)
+
+/* Block link values */
+#define VM_POOL_LINK_END        0xFF    /* End of free list */
+#define VM_POOL_LINK_USED       0xFE    /* Block is allocated */
+#define VM_POOL_MAX_BLOCKS      0xFE
+
+/* One fixed-block pool (pure state, usable on host builds) */
+typedef struct {
+    u8  *storage;       /* block_count * block_size bytes, 4-byte aligned */
+    u8  *links;         /* Per block: next free index, or VM_POOL_LINK_USED */
+    u16 block_size;
+    u8  block_count;
+    u8  free_head;      /* First free block, VM_POOL_LINK_END if exhausted */
+    u8  used;           /* Blocks allocated now */
+    u8  high_water;     /* Most blocks ever allocated at once */
+    u16 fail_count;     /* Requests that could not be served (saturating) */
+    u16 max_request;    /* Largest request size seen */
+} vm_pool_t;
+
+/**
+ * Set up a pool over caller-provided storage
+ * @param pool Pool
+ * @param storage Block storage, block_count * block_size bytes
+ * @param links Link array, block_count bytes
+ * @param block_size Block size in bytes (multiple of 4)
+ * @param block_count Number of blocks (1..VM_POOL_MAX_BLOCKS)
+ */
+void vm_pool_init(vm_pool_t *pool, void *storage, u8 *links, u16 block_size, u8 block_count);
+
+/**
+ * Take one block
+ * @param pool Pool
+ * @param size Bytes needed (must fit one block)
+ * @return Block, NULL if too large or the pool is exhausted (counted as a failure)
+ */
+void *vm_pool_alloc(vm_pool_t *pool, u32 size);
+
+/**
+ * Return a block
+ * @param pool Pool
+ * @param ptr Block from vm_pool_alloc() on the same pool
+ * @return 0 on success, -1 if ptr is not an allocated block of this pool
+ */
+int vm_pool_free(vm_pool_t *pool, void *ptr);
+
+/**
+ * Check whether ptr points into the pool storage
+ */
+u8 vm_pool_owns(const vm_pool_t *pool, const void *ptr);
+
+/**
+ * Allocate from a subsystem pool
+ * @param pool_id VM_POOL_*
+ * @param size Bytes needed
+ * @return Block, NULL on failure
+ */
+void *vm_mem_alloc(u8 pool_id, u32 size);
+
+/**
+ * Free a block from vm_mem_alloc()
+ * @param pool_id VM_POOL_* the block was allocated from
+ * @param ptr Block (NULL is ignored)
+ */
+void vm_mem_free(u8 pool_id, void *ptr);
+
+/**
+ * Get subsystem pool counters
+ * @param pool_id VM_POOL_*
+ * @return Pool, NULL if pool_id is invalid
+ */
+const vm_pool_t *vm_mem_get_pool(u8 pool_id);
+
+/**
+ * Encode all pool counters for the diagnostics characteristic
+ * @param buf Output buffer
+ * @param buf_size Buffer size
+ * @return Bytes written (VM_MEM_DIAG_SIZE), 0 if it does not fit
+ */
+u8 vm_mem_encode_diag(u8 *buf, u8 buf_size);
+
+/**
+ * Log all pool counters
+ */
+void vm_mem_dump(void);
+
+#endif /* VM_MEM_POOL_H */
@@ -1,9 +1,31 @@
 #include "vm_motor_control.h"
+#include "vm_settings.h"
+#include "vm_trace.h"
 #include "asm/gpio.h"
 #include "typedef.h"
 #include "timer.h"
+#include "system/includes.h"
 
-static u16 g_current_duty = 0;
+static u16 g_current_duty = 0;     /* Output duty */
+static u16 g_intensity = 0;        /* Requested duty before the curve */
+static u16 g_curve_min = 0;
+static u16 g_curve_max = VM_MOTOR_DUTY_MAX;
+static u16 g_limit = VM_MOTOR_DUTY_MAX;    /* Governor ceiling on the output duty */
+static u32 g_pwm_freq = VM_MOTOR_PWM_FREQ_HZ;
+static u64 g_duty_acc = 0;         /* Output duty x ms since the last vm_motor_take_avg_duty() */
+static u32 g_duty_since = 0;       /* Accounted up to here (jiffies_msec) */
+static u32 g_avg_start = 0;        /* Start of the averaging window */
+
+/*
+ * Add the output duty since the last change to the average
+ */
+static void duty_account(void)
+{
+    u32 now = jiffies_msec();
+
+    g_duty_acc += (u64)g_current_duty * (now - g_duty_since);
+    g_duty_since = now;
+}
 
 /*
  * Timer PWM initialization - based on manufacturer's implementation
@@ -63,16 +85,26 @@ static void set_timer_pwm_duty(JL_TIMER_TypeDef *JL_TIMERx, u32 duty)
 {
     /* Update PWM duty cycle: 0-10000 = 0%-100% */
     JL_TIMERx->PWM = (JL_TIMERx->PRD * duty) / 10000;
+    VM_TRACE(PWM_SET, duty);
 }
 
 int vm_motor_init(void)
 {
-    /* Initialize TIMER3 PWM: 1kHz, 0% duty (motor off) */
+    /* Initialize TIMER3 PWM: configured frequency, 0% duty (motor off) */
     // printf disabled to reduce firmware size
     
-    timer_pwm_init(VM_MOTOR_TIMER, VM_MOTOR_PWM_PIN, VM_MOTOR_PWM_FREQ_HZ, 0);
+    const vm_settings_t *set = vm_settings_get();
+
+    g_pwm_freq = set->pwm_freq_hz;
+    g_curve_min = set->duty_min;
+    g_curve_max = set->duty_max;
+    timer_pwm_init(VM_MOTOR_TIMER, VM_MOTOR_PWM_PIN, g_pwm_freq, 0);
     
     g_current_duty = 0;
+    g_intensity = 0;
+    g_duty_acc = 0;
+    g_duty_since = jiffies_msec();
+    g_avg_start = g_duty_since;
     
     // printf disabled to reduce firmware size
     
@@ -88,16 +120,96 @@ int vm_motor_set_duty(u16 duty_cycle)
     
     // printf disabled to reduce firmware size
     
-    /* Set PWM duty cycle (0-10000 = 0.00%-100.00%) */
-    set_timer_pwm_duty(VM_MOTOR_TIMER, duty_cycle);
+    /* Also called from the synchronized playback timer interrupt (vm_sync.c) */
+    local_irq_disable();
+
+    g_intensity = duty_cycle;
+
+    /* Intensity curve: 1..10000 onto duty_min..duty_max, 0 stays off */
+    if (duty_cycle) {
+        duty_cycle = g_curve_min + (u32)(g_curve_max - g_curve_min) * duty_cycle / VM_MOTOR_DUTY_MAX;
+    }
+
+    /* Thermal / current ceiling (vm_governor.c) */
+    if (duty_cycle > g_limit) {
+        duty_cycle = g_limit;
+    }
     
-    g_current_duty = duty_cycle;
+    if (duty_cycle != g_current_duty) {
+        /* Set PWM duty cycle (0-10000 = 0.00%-100.00%) */
+        duty_account();
+        set_timer_pwm_duty(VM_MOTOR_TIMER, duty_cycle);
+        
+        g_current_duty = duty_cycle;
+    }
+
+    local_irq_enable();
     
     // printf disabled to reduce firmware size
     
     return 0;
 }
 
+void vm_motor_set_pwm_freq(u32 freq_hz)
+{
+    u32 prd;
+
+    if (freq_hz == 0 || freq_hz == g_pwm_freq) {
+        return;
+    }
+    /* 24MHz / 4 timer clock, same as timer_pwm_init() */
+    prd = (24000000 / 4) / freq_hz;
+
+    /* The sync playback interrupt may set the duty between PRD and PWM */
+    local_irq_disable();
+    g_pwm_freq = freq_hz;
+    VM_MOTOR_TIMER->PRD = prd;
+    set_timer_pwm_duty(VM_MOTOR_TIMER, g_current_duty);
+    local_irq_enable();
+}
+
+void vm_motor_set_curve(u16 duty_min, u16 duty_max)
+{
+    local_irq_disable();
+    g_curve_min = duty_min;
+    g_curve_max = duty_max;
+    local_irq_enable();
+
+    /* Re-map the running intensity */
+    vm_motor_set_duty(g_intensity);
+}
+
+void vm_motor_set_limit(u16 ceiling)
+{
+    if (ceiling > VM_MOTOR_DUTY_MAX) {
+        ceiling = VM_MOTOR_DUTY_MAX;
+    }
+    if (ceiling == g_limit) {
+        return;
+    }
+    g_limit = ceiling;
+
+    /* Re-apply the running intensity under the new ceiling */
+    vm_motor_set_duty(g_intensity);
+}
+
+u16 vm_motor_take_avg_duty(void)
+{
+    u32 span;
+    u16 avg;
+
+    /* 64-bit accumulator also updated by set_duty from the sync playback interrupt */
+    local_irq_disable();
+    duty_account();
+    span = g_duty_since - g_avg_start;
+    avg = span ? (u16)(g_duty_acc / span) : g_current_duty;
+
+    g_duty_acc = 0;
+    g_avg_start = g_duty_since;
+    local_irq_enable();
+    return avg;
+}
+
 void vm_motor_stop(void)
 {
     /* Set duty to 0 = motor off (IO low) */
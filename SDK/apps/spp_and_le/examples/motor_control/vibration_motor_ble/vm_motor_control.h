@@ -16,12 +16,41 @@
 int vm_motor_init(void);
 
 /**
- * Set motor duty cycle
- * @param duty_cycle Duty cycle 0-10000 (0.00% to 100.00%)
+ * Set motor intensity
+ * Mapped onto the duty_min..duty_max curve of the user settings,
+ * then capped by the governor ceiling (vm_motor_set_limit())
+ * @param duty_cycle Intensity 0-10000 (0.00% to 100.00%)
  * @return 0 on success, negative on error
  */
 int vm_motor_set_duty(u16 duty_cycle);
 
+/**
+ * Change the PWM frequency, the output duty is kept
+ * @param freq_hz Frequency in Hz
+ */
+void vm_motor_set_pwm_freq(u32 freq_hz);
+
+/**
+ * Change the intensity curve and re-apply the current intensity
+ * @param duty_min Output duty at the lowest non-zero intensity
+ * @param duty_max Output duty at full intensity
+ */
+void vm_motor_set_curve(u16 duty_min, u16 duty_max);
+
+/**
+ * Set the output duty ceiling and re-apply the current intensity
+ * Used by the thermal / current governor (vm_governor.h)
+ * @param ceiling Highest output duty 0-10000
+ */
+void vm_motor_set_limit(u16 ceiling);
+
+/**
+ * Average output duty since the previous call
+ * Integrates every duty change, so fast patterns are averaged exactly
+ * @return Time-weighted output duty 0-10000
+ */
+u16 vm_motor_take_avg_duty(void);
+
 /**
  * Stop motor
  * Sets duty cycle to 0
@@ -35,7 +64,7 @@ void vm_motor_stop(void);
 void vm_motor_deinit(void);
 
 /**
- * Get current duty cycle
+ * Get current output duty cycle (after the intensity curve and ceiling)
  * @return Current duty cycle 0-10000
  */
 u16 vm_motor_get_duty(void);
@@ -0,0 +1,240 @@
+/**
+ * Binary Motor Pattern Format
+ */
+
+#include "vm_pattern.h"
+#include "asm/crc16.h"
+
+#define VARINT_MAX_BYTES    5
+
+/* Unsigned LEB128; returns bytes read, 0 if truncated or longer than 32 bits */
+static u8 varint_read(const u8 *buf, u16 len, u16 pos, u32 *value)
+{
+    u32 v = 0;
+    u8 i;
+
+    for (i = 0; i < VARINT_MAX_BYTES && pos + i < len; i++) {
+        u8 b = buf[pos + i];
+        if (i == VARINT_MAX_BYTES - 1 && (b & 0xF0)) {
+            return 0;
+        }
+        v |= (u32)(b & 0x7F) << (7 * i);
+        if (!(b & 0x80)) {
+            *value = v;
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+/* Returns bytes written, 0 if it does not fit */
+static u8 varint_write(u8 *buf, u16 size, u16 pos, u32 value)
+{
+    u8 n = 0;
+
+    do {
+        u8 b = value & 0x7F;
+        value >>= 7;
+        if (pos + n >= size) {
+            return 0;
+        }
+        buf[pos + n++] = value ? (b | 0x80) : b;
+    } while (value);
+    return n;
+}
+
+static u32 zigzag(s32 v)
+{
+    return ((u32)v << 1) ^ (u32)(v >> 31);
+}
+
+static s32 unzigzag(u32 v)
+{
+    return (s32)(v >> 1) ^ -(s32)(v & 1);
+}
+
+int vm_pattern_open(vm_pattern_reader_t *r, const u8 *buf, u16 len)
+{
+    u16 pos = VM_PATTERN_HEADER_SIZE;
+    u32 duration, count, meta_len;
+    u8 n;
+
+    if (!r || !buf || len < VM_PATTERN_HEADER_SIZE + VM_PATTERN_CRC_SIZE) {
+        return VM_PATTERN_ERR_FORMAT;
+    }
+    if (buf[0] != VM_PATTERN_MAGIC_0 || buf[1] != VM_PATTERN_MAGIC_1 ||
+        buf[2] != VM_PATTERN_VERSION || (buf[3] & VM_PATTERN_FLAG_PWM16)) {
+        return VM_PATTERN_ERR_FORMAT;
+    }
+
+    len -= VM_PATTERN_CRC_SIZE;
+    if (CRC16(buf, len) != (u16)(buf[len] | (buf[len + 1] << 8))) {
+        return VM_PATTERN_ERR_CRC;
+    }
+
+    n = varint_read(buf, len, pos, &duration);
+    if (!n) {
+        return VM_PATTERN_ERR_FORMAT;
+    }
+    pos += n;
+    n = varint_read(buf, len, pos, &count);
+    if (!n || count > 0xFFFF) {
+        return VM_PATTERN_ERR_FORMAT;
+    }
+    pos += n;
+
+    if (buf[3] & VM_PATTERN_FLAG_META) {
+        n = varint_read(buf, len, pos, &meta_len);
+        if (!n || meta_len > (u32)(len - pos - n)) {
+            return VM_PATTERN_ERR_FORMAT;
+        }
+        pos += n + meta_len;
+    }
+
+    r->buf = buf;
+    r->len = len;
+    r->body = pos;
+    r->flags = buf[3];
+    r->duration_ms = duration;
+    r->frame_count = count;
+    vm_pattern_rewind(r);
+    return VM_PATTERN_OK;
+}
+
+void vm_pattern_rewind(vm_pattern_reader_t *r)
+{
+    r->pos = r->body;
+    r->frame_index = 0;
+    r->run_left = 0;
+    r->time_ms = 0;
+    r->pwm = 0;
+}
+
+int vm_pattern_next(vm_pattern_reader_t *r, vm_pattern_frame_t *frame)
+{
+    s32 pwm;
+
+    if (r->frame_index >= r->frame_count) {
+        return VM_PATTERN_END;
+    }
+
+    if (r->run_left == 0) {
+        u32 head, dp, repeat = 0;
+        u8 n;
+
+        n = varint_read(r->buf, r->len, r->pos, &head);
+        if (!n) {
+            return VM_PATTERN_ERR_FORMAT;
+        }
+        r->pos += n;
+        n = varint_read(r->buf, r->len, r->pos, &dp);
+        if (!n || unzigzag(dp) < -VM_PATTERN_PWM_MAX || unzigzag(dp) > VM_PATTERN_PWM_MAX) {
+            return VM_PATTERN_ERR_FORMAT;
+        }
+        r->pos += n;
+        if (head & 1) {
+            n = varint_read(r->buf, r->len, r->pos, &repeat);
+            if (!n || repeat > 0xFFFF - 2) {
+                return VM_PATTERN_ERR_FORMAT;
+            }
+            r->pos += n;
+            repeat += 2;    /* Runs are sent as count - 2 */
+        } else {
+            repeat = 1;
+        }
+        r->step_dt = head >> 1;
+        r->step_dp = (s16)unzigzag(dp);
+        r->run_left = repeat;
+    }
+
+    if (r->time_ms + r->step_dt < r->time_ms) {
+        return VM_PATTERN_ERR_RANGE;
+    }
+    pwm = r->pwm + r->step_dp;
+    if (pwm < 0 || pwm > VM_PATTERN_PWM_MAX) {
+        return VM_PATTERN_ERR_RANGE;
+    }
+
+    r->run_left--;
+    r->time_ms += r->step_dt;
+    r->pwm = (s16)pwm;
+    r->frame_index++;
+
+    frame->time_ms = r->time_ms;
+    frame->pwm = (u8)pwm;
+    return VM_PATTERN_OK;
+}
+
+u16 vm_pattern_encode(u8 *buf, u16 buf_size, const vm_pattern_frame_t *frames,
+                      u16 count, u32 duration_ms, u8 flags)
+{
+    u32 prev_time = 0;
+    s32 prev_pwm = 0;
+    u16 pos = VM_PATTERN_HEADER_SIZE;
+    u16 i = 0;
+    u16 crc;
+    u8 n;
+
+    if (!buf || (count && !frames) || buf_size < VM_PATTERN_HEADER_SIZE + VM_PATTERN_CRC_SIZE) {
+        return 0;
+    }
+
+    buf[0] = VM_PATTERN_MAGIC_0;
+    buf[1] = VM_PATTERN_MAGIC_1;
+    buf[2] = VM_PATTERN_VERSION;
+    buf[3] = flags & VM_PATTERN_FLAG_LOOP;
+
+    n = varint_write(buf, buf_size, pos, duration_ms);
+    if (!n) return 0;
+    pos += n;
+    n = varint_write(buf, buf_size, pos, count);
+    if (!n) return 0;
+    pos += n;
+
+    while (i < count) {
+        u32 dt;
+        s32 dp;
+        u16 run = 1;
+
+        if (frames[i].time_ms < prev_time) {
+            return 0;
+        }
+        dt = frames[i].time_ms - prev_time;
+        dp = (s32)frames[i].pwm - prev_pwm;
+
+        /* Following frames with the same step join the run */
+        while (i + run < count &&
+               frames[i + run].time_ms >= frames[i + run - 1].time_ms &&
+               frames[i + run].time_ms - frames[i + run - 1].time_ms == dt &&
+               (s32)frames[i + run].pwm - (s32)frames[i + run - 1].pwm == dp) {
+            run++;
+        }
+
+        if (dt > 0x7FFFFFFF) {
+            return 0;
+        }
+        n = varint_write(buf, buf_size, pos, (dt << 1) | (run > 1));
+        if (!n) return 0;
+        pos += n;
+        n = varint_write(buf, buf_size, pos, zigzag(dp));
+        if (!n) return 0;
+        pos += n;
+        if (run > 1) {
+            n = varint_write(buf, buf_size, pos, run - 2);
+            if (!n) return 0;
+            pos += n;
+        }
+
+        i += run;
+        prev_time = frames[i - 1].time_ms;
+        prev_pwm = frames[i - 1].pwm;
+    }
+
+    if (pos + VM_PATTERN_CRC_SIZE > buf_size) {
+        return 0;
+    }
+    crc = CRC16(buf, pos);
+    buf[pos++] = crc & 0xFF;
+    buf[pos++] = crc >> 8;
+    return pos;
+}
@@ -0,0 +1,119 @@
+/**
+ * Binary Motor Pattern Format
+ *
+ * Compact form of a pattern from the client library (utils/motor-patterns.js)
+ * for uploading to the device and for syncing libraries between users.
+ * Frames are (time_ms, pwm 0-255) pairs stored as deltas:
+ *
+ *   [magic 'D' 'P'][version][flags]
+ *   varint  duration_ms
+ *   varint  frame_count
+ *   [varint meta_len][meta bytes]          only with VM_PATTERN_FLAG_META
+ *   records, until frame_count frames are produced:
+ *     varint  (dt << 1) | run              dt: ms since the previous frame
+ *     varint  zigzag(dp)                   dp: pwm change from the previous frame
+ *     [varint count - 2]                   only with run: the step repeats count times
+ *   u16     CRC16 of all bytes above, little-endian (SDK CRC16(), CCITT init 0)
+ *
+ * Varints are unsigned LEB128. The first frame is a delta from (0 ms, 0).
+ * A run covers holds (dp = 0) as well as linear ramps. The meta block is
+ * UTF-8 JSON with the names and category; the device skips it.
+ *
+ * pwm stays 8-bit while the motor link takes duty 0-10000: the library
+ * patterns are authored on 0-255 and the player interpolates between
+ * frames on the duty scale, so wider key frames would add nothing they
+ * hold. VM_PATTERN_FLAG_PWM16 is reserved for frames on the duty scale;
+ * this version rejects it, so such a pattern is never played as 8-bit.
+ *
+ * The client codec lives in utils/pattern-codec.js and must be kept in
+ * sync with this layout. Apart from CRC16() this module has no SDK
+ * dependencies and builds on a host.
+ */
+
+#ifndef VM_PATTERN_H
+#define VM_PATTERN_H
+
+#include "typedef.h"
+
+#define VM_PATTERN_MAGIC_0          0x44    /* 'D' */
+#define VM_PATTERN_MAGIC_1          0x50    /* 'P' */
+#define VM_PATTERN_VERSION          1
+#define VM_PATTERN_HEADER_SIZE      4       /* Magic, version, flags */
+#define VM_PATTERN_CRC_SIZE         2
+
+/* Flags byte */
+#define VM_PATTERN_FLAG_LOOP        0x01    /* Restart after duration_ms */
+#define VM_PATTERN_FLAG_META        0x02    /* Meta block present */
+#define VM_PATTERN_FLAG_PWM16       0x04    /* Reserved: pwm on the 0-10000 duty scale */
+
+#define VM_PATTERN_PWM_MAX          255
+
+/* Return codes */
+#define VM_PATTERN_OK               0
+#define VM_PATTERN_END              1       /* vm_pattern_next(): no more frames */
+#define VM_PATTERN_ERR_FORMAT       -1      /* Bad magic/version or malformed record */
+#define VM_PATTERN_ERR_CRC          -2
+#define VM_PATTERN_ERR_RANGE        -3      /* pwm outside 0-255 or time overflow */
+
+typedef struct {
+    u32 time_ms;
+    u8  pwm;
+} vm_pattern_frame_t;
+
+/* Frame cursor over an encoded pattern; no allocation, the buffer must
+ * stay valid while the reader is in use */
+typedef struct {
+    const u8 *buf;
+    u16 len;            /* Bytes before the CRC */
+    u16 body;           /* Offset of the first record */
+    u16 pos;            /* Offset of the next record */
+    u8  flags;          /* VM_PATTERN_FLAG_* */
+    u32 duration_ms;
+    u16 frame_count;
+    u16 frame_index;    /* Frames produced so far */
+    u16 run_left;       /* Steps left in the current run */
+    u32 step_dt;
+    s16 step_dp;
+    u32 time_ms;        /* Last frame produced */
+    s16 pwm;
+} vm_pattern_reader_t;
+
+/**
+ * Check an encoded pattern and open a reader on its first frame
+ * @param r Reader
+ * @param buf Encoded pattern
+ * @param len Encoded length including the CRC
+ * @return VM_PATTERN_OK, VM_PATTERN_ERR_FORMAT (also for VM_PATTERN_FLAG_PWM16)
+ *         or VM_PATTERN_ERR_CRC
+ */
+int vm_pattern_open(vm_pattern_reader_t *r, const u8 *buf, u16 len);
+
+/**
+ * Produce the next frame
+ * @param r Reader from vm_pattern_open()
+ * @param frame Output frame
+ * @return VM_PATTERN_OK, VM_PATTERN_END after the last frame, or an error
+ */
+int vm_pattern_next(vm_pattern_reader_t *r, vm_pattern_frame_t *frame);
+
+/**
+ * Restart the reader at the first frame (looping playback)
+ * @param r Reader from vm_pattern_open()
+ */
+void vm_pattern_rewind(vm_pattern_reader_t *r);
+
+/**
+ * Encode frames without a meta block, byte for byte what the client
+ * encoder produces with { meta: false }
+ * @param buf Output buffer
+ * @param buf_size Output buffer size
+ * @param frames Frames in time order
+ * @param count Number of frames
+ * @param duration_ms Pattern duration
+ * @param flags VM_PATTERN_FLAG_LOOP or 0
+ * @return Encoded length, 0 if it does not fit or the frames are out of order
+ */
+u16 vm_pattern_encode(u8 *buf, u16 buf_size, const vm_pattern_frame_t *frames,
+                      u16 count, u32 duration_ms, u8 flags);
+
+#endif /* VM_PATTERN_H */
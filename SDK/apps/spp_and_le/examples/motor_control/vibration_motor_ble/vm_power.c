@@ -0,0 +1,184 @@
+/**
+ * Duty-Aware Low Power Manager
+ */
+
+#include "app_config.h"  /* Must be first for SDK configuration */
+#include "vm_power.h"
+#include "vm_config.h"
+#include "vm_motor_control.h"
+#include "custom_dual_bank_ota.h"
+
+#include "system/includes.h"
+
+/* Logging */
+#define VM_LOG_TAG      "VM_PWR"
+#define VM_LOG_LEVEL    VM_LOG_LEVEL_PWR
+#include "vm_log.h"
+
+static volatile u8 g_hold_count = 0;
+static u8 g_selected = VM_PWR_STATE_ACTIVE;    /* Last state handed to the low power core */
+static u8 g_sleeping = VM_PWR_STATE_ACTIVE;    /* State of the sleep in progress */
+static u32 g_motor_seen_ms = 0;                /* Last time the motor was seen running */
+static u32 g_start_ms = 0;
+static u32 g_sleep_ms[VM_PWR_STATE_COUNT];
+static u32 g_sleep_us[VM_PWR_STATE_COUNT];     /* Sub-millisecond remainder */
+
+/* ========== Policy ========== */
+
+u8 vm_power_select(u8 busy, u16 duty, u32 motor_off_ms)
+{
+    if (busy) {
+        return VM_PWR_STATE_ACTIVE;
+    }
+    if (duty > 0) {
+        return VM_PWR_LIGHT_SLEEP_ENABLE ? VM_PWR_STATE_LIGHT : VM_PWR_STATE_ACTIVE;
+    }
+    if (VM_PWR_DEEP_SLEEP_ENABLE && motor_off_ms >= VM_PWR_DEEP_IDLE_MS) {
+        return VM_PWR_STATE_DEEP;
+    }
+    return VM_PWR_STATE_SLEEP;
+}
+
+void vm_power_hold(void)
+{
+    local_irq_disable();
+    if (g_hold_count < 0xFF) {
+        g_hold_count++;
+    }
+    local_irq_enable();
+}
+
+void vm_power_release(void)
+{
+    local_irq_disable();
+    if (g_hold_count) {
+        g_hold_count--;
+    }
+    local_irq_enable();
+}
+
+/* ========== Low power target ========== */
+
+static u8 power_update(void)
+{
+    u32 now = jiffies_msec();
+    u16 duty = vm_motor_get_duty();
+    u8 busy = g_hold_count || custom_dual_bank_ota_get_state() != CUSTOM_OTA_STATE_IDLE;
+
+    /* Queried before every sleep, so this tracks the motor-off time closely enough */
+    if (duty > 0) {
+        g_motor_seen_ms = now;
+    }
+
+    g_selected = vm_power_select(busy, duty, now - g_motor_seen_ms);
+    return g_selected;
+}
+
+static u8 power_is_idle(void)
+{
+    return power_update() != VM_PWR_STATE_ACTIVE;
+}
+
+static enum LOW_POWER_LEVEL power_level(void)
+{
+    switch (power_update()) {
+    case VM_PWR_STATE_DEEP:
+        return LOW_POWER_MODE_DEEP_SLEEP;
+    case VM_PWR_STATE_SLEEP:
+        return LOW_POWER_MODE_SLEEP;
+    default:
+        return LOW_POWER_MODE_LIGHT_SLEEP;
+    }
+}
+
+REGISTER_LP_TARGET(vm_power_lp_target) = {
+    .name = "vm_power",
+    .level = power_level,
+    .is_idle = power_is_idle,
+};
+
+/* ========== Statistics ========== */
+
+void vm_power_init(void)
+{
+    local_irq_disable();
+    memset(g_sleep_ms, 0, sizeof(g_sleep_ms));
+    memset(g_sleep_us, 0, sizeof(g_sleep_us));
+    g_start_ms = jiffies_msec();
+    g_motor_seen_ms = g_start_ms;
+    local_irq_enable();
+
+    log_info("light sleep %s, deep sleep after %dms motor off\n",
+             VM_PWR_LIGHT_SLEEP_ENABLE ? "on" : "off", VM_PWR_DEEP_IDLE_MS);
+}
+
+void vm_power_sleep_enter(void)
+{
+    /* The core may sleep without asking this target again, fall back to SLEEP */
+    g_sleeping = (g_selected == VM_PWR_STATE_ACTIVE) ? VM_PWR_STATE_SLEEP : g_selected;
+}
+
+void vm_power_sleep_exit(u32 usec)
+{
+    u8 state = g_sleeping;
+
+    usec += g_sleep_us[state];
+    g_sleep_ms[state] += usec / 1000;
+    g_sleep_us[state] = usec % 1000;
+}
+
+u32 vm_power_keep_io(void)
+{
+    return VM_MOTOR_PWM_PIN;
+}
+
+void vm_power_get_stats(u32 *ms)
+{
+    u32 slept = 0;
+    u8 i;
+
+    local_irq_disable();
+    for (i = VM_PWR_STATE_LIGHT; i < VM_PWR_STATE_COUNT; i++) {
+        ms[i] = g_sleep_ms[i];
+        slept += g_sleep_ms[i];
+    }
+    /* jiffies are corrected for sleep time, so awake time is the rest */
+    ms[VM_PWR_STATE_ACTIVE] = jiffies_msec() - g_start_ms - slept;
+    local_irq_enable();
+}
+
+u8 vm_power_encode_stats(u8 *buf, u8 buf_size)
+{
+    u32 ms[VM_PWR_STATE_COUNT];
+    u8 *p;
+    u8 i;
+
+    if (!buf || buf_size < VM_PWR_STATS_SIZE) {
+        return 0;
+    }
+
+    vm_power_get_stats(ms);
+    buf[0] = g_selected;
+    p = buf + 1;
+    for (i = 0; i < VM_PWR_STATE_COUNT; i++) {
+        u32 s = ms[i] / 1000;
+
+        p[0] = s & 0xFF;
+        p[1] = (s >> 8) & 0xFF;
+        p[2] = (s >> 16) & 0xFF;
+        p[3] = (s >> 24) & 0xFF;
+        p += 4;
+    }
+
+    return VM_PWR_STATS_SIZE;
+}
+
+void vm_power_dump(void)
+{
+    u32 ms[VM_PWR_STATE_COUNT];
+
+    vm_power_get_stats(ms);
+    log_info("active=%dms light=%dms sleep=%dms deep=%dms\n",
+             ms[VM_PWR_STATE_ACTIVE], ms[VM_PWR_STATE_LIGHT],
+             ms[VM_PWR_STATE_SLEEP], ms[VM_PWR_STATE_DEEP]);
+}
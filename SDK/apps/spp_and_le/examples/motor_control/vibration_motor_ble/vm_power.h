@@ -0,0 +1,89 @@
+/**
+ * Duty-Aware Low Power Manager
+ *
+ * Registers a low power target that picks the sleep depth between BLE events:
+ *
+ *   busy (OTA running, vm_power_hold())   no sleep
+ *   motor running                         light sleep, clocks kept so the
+ *                                         TIMER3 PWM keeps driving the motor
+ *   motor off                             sleep (powerdown)
+ *   motor off for VM_PWR_DEEP_IDLE_MS     deep sleep
+ *
+ * The board sleep callbacks report every sleep period back through
+ * vm_power_sleep_enter() / vm_power_sleep_exit(), which accumulates the
+ * time spent in each state. The totals are readable with the device info
+ * power query (0xB0 0x02) and vm_power_dump().
+ */
+
+#ifndef VM_POWER_H
+#define VM_POWER_H
+
+#include "typedef.h"
+
+/* Power states (statistics index) */
+#define VM_PWR_STATE_ACTIVE     0
+#define VM_PWR_STATE_LIGHT      1   /* LOW_POWER_MODE_LIGHT_SLEEP */
+#define VM_PWR_STATE_SLEEP      2   /* LOW_POWER_MODE_SLEEP */
+#define VM_PWR_STATE_DEEP       3   /* LOW_POWER_MODE_DEEP_SLEEP */
+#define VM_PWR_STATE_COUNT      4
+
+/* Statistics layout: [state now] then per state u32 LE seconds */
+#define VM_PWR_STATS_SIZE       (1 + VM_PWR_STATE_COUNT * 4)
+
+/**
+ * Select the sleep state (pure policy, usable on host builds)
+ * @param busy Non-zero if OTA or another engine needs the CPU
+ * @param duty Motor duty (0-10000)
+ * @param motor_off_ms Time since the motor was last seen running
+ * @return VM_PWR_STATE_*, VM_PWR_STATE_ACTIVE if sleep is not allowed
+ */
+u8 vm_power_select(u8 busy, u16 duty, u32 motor_off_ms);
+
+/**
+ * Keep the CPU awake (nesting), e.g. while a pattern engine runs from timers
+ */
+void vm_power_hold(void);
+
+/**
+ * Release one vm_power_hold()
+ */
+void vm_power_release(void);
+
+/**
+ * Start statistics
+ */
+void vm_power_init(void);
+
+/**
+ * Board sleep hooks (called from sleep_enter_callback / sleep_exit_callback,
+ * no printing allowed)
+ * @param usec Time slept
+ */
+void vm_power_sleep_enter(void);
+void vm_power_sleep_exit(u32 usec);
+
+/**
+ * IO that must keep its output state during sleep (motor PWM pin)
+ */
+u32 vm_power_keep_io(void);
+
+/**
+ * Get time spent in each state since vm_power_init()
+ * @param ms Output, VM_PWR_STATE_COUNT entries in ms
+ */
+void vm_power_get_stats(u32 *ms);
+
+/**
+ * Encode state and statistics for the device info power query
+ * @param buf Output buffer
+ * @param buf_size Buffer size
+ * @return Bytes written (VM_PWR_STATS_SIZE), 0 if it does not fit
+ */
+u8 vm_power_encode_stats(u8 *buf, u8 buf_size);
+
+/**
+ * Log time spent in each state
+ */
+void vm_power_dump(void);
+
+#endif /* VM_POWER_H */
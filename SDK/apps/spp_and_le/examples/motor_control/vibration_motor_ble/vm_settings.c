@@ -0,0 +1,407 @@
+/**
+ * User Settings Store
+ */
+
+#include "app_config.h"  /* Must be first for SDK configuration */
+#include "vm_settings.h"
+#include "vm_config.h"
+#include "vm_motor_control.h"
+
+#include "system/includes.h"
+
+/* Logging */
+#define VM_LOG_TAG      "VM_SET"
+#define VM_LOG_LEVEL    VM_LOG_LEVEL_SET
+#include "vm_log.h"
+
+/* Settings applied together (cross-field checks, module hooks) */
+#define SET_GROUP_NONE      0
+#define SET_GROUP_MOTOR     1
+#define SET_GROUP_ADV       2
+
+/* Largest interval allowed by the Core spec for legacy advertising */
+#define ADV_INTERVAL_SPEC_MAX   0x4000
+
+typedef struct {
+    u8  key;
+    u8  type;       /* VM_SET_TYPE_* */
+    u8  group;      /* SET_GROUP_* */
+    u8  offset;     /* Field offset in vm_settings_t */
+    u16 min;        /* Value range, length range for strings */
+    u16 max;
+} vm_setting_def_t;
+
+#define SET_FIELD(f)    offsetof(vm_settings_t, f)
+
+static const vm_setting_def_t g_defs[] = {
+    { VM_SET_KEY_PWM_FREQ_HZ,         VM_SET_TYPE_U16, SET_GROUP_MOTOR, SET_FIELD(pwm_freq_hz),         100, 20000 },
+    { VM_SET_KEY_DUTY_MIN,            VM_SET_TYPE_U16, SET_GROUP_MOTOR, SET_FIELD(duty_min),            0, VM_MOTOR_DUTY_MAX },
+    { VM_SET_KEY_DUTY_MAX,            VM_SET_TYPE_U16, SET_GROUP_MOTOR, SET_FIELD(duty_max),            1, VM_MOTOR_DUTY_MAX },
+    { VM_SET_KEY_DEVICE_NAME,         VM_SET_TYPE_STR, SET_GROUP_NONE,  SET_FIELD(device_name),         1, VM_SETTINGS_NAME_MAX },
+    { VM_SET_KEY_ADV_FAST_INTERVAL,   VM_SET_TYPE_U16, SET_GROUP_ADV,   SET_FIELD(adv.fast_interval),   VM_ADV_INTERVAL_MIN, ADV_INTERVAL_SPEC_MAX },
+    { VM_SET_KEY_ADV_SLOW_INTERVAL,   VM_SET_TYPE_U16, SET_GROUP_ADV,   SET_FIELD(adv.slow_interval),   VM_ADV_INTERVAL_MIN, ADV_INTERVAL_SPEC_MAX },
+    { VM_SET_KEY_ADV_FAST_DURATION_S, VM_SET_TYPE_U16, SET_GROUP_ADV,   SET_FIELD(adv.fast_duration_s), 1, 0xFFFF },
+    { VM_SET_KEY_ADV_SLOW_DURATION_S, VM_SET_TYPE_U16, SET_GROUP_ADV,   SET_FIELD(adv.slow_duration_s), 0, 0xFFFF },
+    { VM_SET_KEY_ADV_SLEEP_PERIOD_S,  VM_SET_TYPE_U16, SET_GROUP_ADV,   SET_FIELD(adv.sleep_period_s),  0, 0xFFFF },
+    { VM_SET_KEY_ADV_WAKE_WINDOW_S,   VM_SET_TYPE_U16, SET_GROUP_ADV,   SET_FIELD(adv.wake_window_s),   0, 0xFFFF },
+    { VM_SET_KEY_ADV_SLEEP_ENABLE,    VM_SET_TYPE_U8,  SET_GROUP_ADV,   SET_FIELD(adv.sleep_enable),    0, 1 },
+};
+
+#define SET_DEF_COUNT   (sizeof(g_defs) / sizeof(g_defs[0]))
+
+static const vm_settings_t g_default = {
+    .version     = VM_SETTINGS_VERSION,
+    .pwm_freq_hz = VM_MOTOR_PWM_FREQ_HZ,
+    .duty_min    = 0,
+    .duty_max    = VM_MOTOR_DUTY_MAX,
+    .adv = {
+        .fast_interval   = VM_ADV_FAST_INTERVAL,
+        .slow_interval   = VM_ADV_SLOW_INTERVAL,
+        .fast_duration_s = VM_ADV_FAST_DURATION_S,
+        .slow_duration_s = VM_ADV_SLOW_DURATION_S,
+        .sleep_period_s  = VM_ADV_SLEEP_PERIOD_S,
+        .wake_window_s   = VM_ADV_WAKE_WINDOW_S,
+        .sleep_enable    = VM_ADV_SLEEP_ENABLE,
+    },
+    .device_name = VM_DEVICE_NAME,
+};
+
+static vm_settings_t g_settings;
+static u8 g_loaded = 0;
+static u8 g_dirty = 0;
+static u16 g_flush_timeout = 0;
+static u16 g_write_count = 0;
+
+/* ========== Registry ========== */
+
+static const vm_setting_def_t *settings_find(u8 key)
+{
+    u8 i;
+
+    for (i = 0; i < SET_DEF_COUNT; i++) {
+        if (g_defs[i].key == key) {
+            return &g_defs[i];
+        }
+    }
+    return NULL;
+}
+
+static u16 settings_get_int(const vm_settings_t *s, const vm_setting_def_t *def)
+{
+    const u8 *field = (const u8 *)s + def->offset;
+    u16 v;
+
+    if (def->type == VM_SET_TYPE_U8) {
+        return field[0];
+    }
+    memcpy(&v, field, sizeof(v));
+    return v;
+}
+
+static void settings_put_int(vm_settings_t *s, const vm_setting_def_t *def, u16 v)
+{
+    u8 *field = (u8 *)s + def->offset;
+
+    if (def->type == VM_SET_TYPE_U8) {
+        field[0] = (u8)v;
+    } else {
+        memcpy(field, &v, sizeof(v));
+    }
+}
+
+/**
+ * Replace out-of-range values (corrupt or older limits) with defaults
+ */
+static void settings_sanitize(vm_settings_t *s)
+{
+    u8 i;
+
+    for (i = 0; i < SET_DEF_COUNT; i++) {
+        const vm_setting_def_t *def = &g_defs[i];
+
+        if (def->type == VM_SET_TYPE_STR) {
+            char *str = (char *)s + def->offset;
+            u8 n;
+
+            str[VM_SETTINGS_NAME_MAX] = '\0';
+            n = strlen(str);
+            if (n < def->min || n > def->max) {
+                strcpy(str, (const char *)&g_default + def->offset);
+            }
+        } else {
+            u16 v = settings_get_int(s, def);
+
+            if (v < def->min || v > def->max) {
+                settings_put_int(s, def, settings_get_int(&g_default, def));
+            }
+        }
+    }
+
+    if (s->duty_min > s->duty_max) {
+        s->duty_min = g_default.duty_min;
+        s->duty_max = g_default.duty_max;
+    }
+    if (!vm_adv_sched_config_is_valid(&s->adv)) {
+        memcpy(&s->adv, &g_default.adv, sizeof(s->adv));
+    }
+    s->adv.reserved = 0;
+}
+
+/**
+ * Hand a changed group to its module before the cache takes it
+ */
+static u8 settings_apply(u8 group, const vm_settings_t *next)
+{
+    switch (group) {
+    case SET_GROUP_MOTOR:
+        if (next->duty_min > next->duty_max) {
+            return VM_SET_ERR_VALUE;
+        }
+        vm_motor_set_pwm_freq(next->pwm_freq_hz);
+        vm_motor_set_curve(next->duty_min, next->duty_max);
+        return VM_SET_OK;
+
+    case SET_GROUP_ADV:
+        return (vm_adv_sched_set_config(&next->adv) == 0) ? VM_SET_OK : VM_SET_ERR_VALUE;
+
+    default:
+        return VM_SET_OK;
+    }
+}
+
+/* ========== Write-back ========== */
+
+static void settings_flush_timeout(void *priv)
+{
+    (void)priv;
+
+    g_flush_timeout = 0;
+    vm_settings_flush();
+}
+
+static void settings_mark_dirty(void)
+{
+    g_dirty = 1;
+
+    /* Armed once per batch, later changes ride along */
+    if (!g_flush_timeout) {
+        g_flush_timeout = sys_timeout_add(NULL, settings_flush_timeout, VM_SETTINGS_FLUSH_MS);
+    }
+}
+
+u8 vm_settings_flush(void)
+{
+    int ret;
+
+    if (g_flush_timeout) {
+        sys_timeout_del(g_flush_timeout);
+        g_flush_timeout = 0;
+    }
+    if (!g_dirty) {
+        return VM_SET_OK;
+    }
+
+    g_settings.version = VM_SETTINGS_VERSION;
+    ret = syscfg_write(VM_CFG_ID_SETTINGS, &g_settings, sizeof(g_settings));
+    if (ret != sizeof(g_settings)) {
+        log_error("Write-back failed: %d\n", ret);
+        settings_mark_dirty();  /* Retry with the next batch */
+        return VM_SET_ERR_STORAGE;
+    }
+
+    g_dirty = 0;
+    g_write_count++;
+    log_info("Saved (write #%d)\n", g_write_count);
+    return VM_SET_OK;
+}
+
+u8 vm_settings_is_dirty(void)
+{
+    return g_dirty;
+}
+
+u16 vm_settings_get_write_count(void)
+{
+    return g_write_count;
+}
+
+/* ========== Load / migration ========== */
+
+/**
+ * Bring settings stored by older firmware up to VM_SETTINGS_VERSION
+ * Fields added after `from` already hold their defaults
+ */
+static void settings_migrate(u8 from)
+{
+    vm_adv_sched_cfg_t adv;
+
+    switch (from) {
+    case 0:
+        /* Before the registry the schedule was a syscfg item of its own */
+        if (syscfg_read(VM_CFG_ID_ADV_SCHED, &adv, sizeof(adv)) == sizeof(adv)) {
+            memcpy(&g_settings.adv, &adv, sizeof(adv));
+        }
+        /* fall through */
+    default:
+        break;
+    }
+
+    log_info("Migrated from version %d\n", from);
+}
+
+void vm_settings_init(void)
+{
+    vm_settings_t stored;
+    u8 from = 0;
+    int ret;
+
+    if (g_loaded) {
+        return;
+    }
+    g_loaded = 1;
+
+    memcpy(&g_settings, &g_default, sizeof(g_settings));
+
+    /* Only the known prefix is kept, newer fields of a larger blob are dropped */
+    ret = syscfg_read(VM_CFG_ID_SETTINGS, &stored, sizeof(stored));
+    if (ret >= 1 && stored.version != 0) {
+        memcpy(&g_settings, &stored, (ret < (int)sizeof(stored)) ? (u32)ret : sizeof(stored));
+        from = stored.version;
+    }
+
+    if (from < VM_SETTINGS_VERSION) {
+        settings_migrate(from);
+        settings_mark_dirty();
+    }
+    g_settings.version = VM_SETTINGS_VERSION;
+    settings_sanitize(&g_settings);
+
+    log_info("v%d name=%s pwm=%dHz duty=%d..%d\n", from, g_settings.device_name,
+             g_settings.pwm_freq_hz, g_settings.duty_min, g_settings.duty_max);
+}
+
+const vm_settings_t *vm_settings_get(void)
+{
+    return &g_settings;
+}
+
+/* ========== Get / set ========== */
+
+u8 vm_settings_set(u8 key, const u8 *value, u8 len)
+{
+    const vm_setting_def_t *def = settings_find(key);
+    vm_settings_t next;
+    u8 status;
+
+    if (!def) {
+        return VM_SET_ERR_KEY;
+    }
+
+    memcpy(&next, &g_settings, sizeof(next));
+
+    if (def->type == VM_SET_TYPE_STR) {
+        char *str = (char *)&next + def->offset;
+
+        if (len < def->min || len > def->max) {
+            return VM_SET_ERR_LENGTH;
+        }
+        if (memchr(value, 0, len)) {
+            return VM_SET_ERR_VALUE;
+        }
+        memset(str, 0, VM_SETTINGS_NAME_MAX + 1);
+        memcpy(str, value, len);
+    } else {
+        u16 v;
+
+        if (len != ((def->type == VM_SET_TYPE_U8) ? 1 : 2)) {
+            return VM_SET_ERR_LENGTH;
+        }
+        v = (len == 1) ? value[0] : (value[0] | (value[1] << 8));
+        if (v < def->min || v > def->max) {
+            return VM_SET_ERR_VALUE;
+        }
+        settings_put_int(&next, def, v);
+    }
+
+    /* Rewriting the same value costs nothing */
+    if (memcmp(&next, &g_settings, sizeof(next)) == 0) {
+        return VM_SET_OK;
+    }
+
+    status = settings_apply(def->group, &next);
+    if (status != VM_SET_OK) {
+        return status;
+    }
+
+    memcpy(&g_settings, &next, sizeof(g_settings));
+    settings_mark_dirty();
+    return VM_SET_OK;
+}
+
+u8 vm_settings_encode(u8 key, u8 *buf)
+{
+    const vm_setting_def_t *def = settings_find(key);
+    u16 v;
+
+    if (!def) {
+        return 0;
+    }
+
+    if (def->type == VM_SET_TYPE_STR) {
+        const char *str = (const char *)&g_settings + def->offset;
+        u8 n = strlen(str);
+
+        memcpy(buf, str, n);
+        return n;
+    }
+
+    v = settings_get_int(&g_settings, def);
+    buf[0] = v & 0xFF;
+    if (def->type == VM_SET_TYPE_U8) {
+        return 1;
+    }
+    buf[1] = v >> 8;
+    return 2;
+}
+
+u8 vm_settings_handle_cmd(const u8 *req, u16 len, u8 *rsp)
+{
+    u8 cmd = (len > 0) ? req[0] : 0;
+    u8 key = (len > 1) ? req[1] : 0;
+    u8 status;
+
+    switch (cmd) {
+    case VM_SET_CMD_GET:
+        if (len != 2) {
+            status = VM_SET_ERR_LENGTH;
+        } else {
+            status = settings_find(key) ? VM_SET_OK : VM_SET_ERR_KEY;
+        }
+        break;
+
+    case VM_SET_CMD_SET:
+        if (len < 2 || len - 2 > VM_SETTINGS_NAME_MAX) {
+            status = VM_SET_ERR_LENGTH;
+        } else {
+            status = vm_settings_set(key, req + 2, len - 2);
+        }
+        break;
+
+    case VM_SET_CMD_SAVE:
+        key = 0;
+        status = (len == 1) ? vm_settings_flush() : VM_SET_ERR_LENGTH;
+        break;
+
+    default:
+        status = VM_SET_ERR_KEY;
+        break;
+    }
+
+    rsp[0] = cmd;
+    rsp[1] = key;
+    rsp[2] = status;
+    if (cmd == VM_SET_CMD_SAVE || status != VM_SET_OK) {
+        return VM_SET_RSP_HEADER_SIZE;
+    }
+    return VM_SET_RSP_HEADER_SIZE + vm_settings_encode(key, rsp + VM_SET_RSP_HEADER_SIZE);
+}
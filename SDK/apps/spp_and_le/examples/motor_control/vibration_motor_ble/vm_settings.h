@@ -0,0 +1,137 @@
+/**
+ * User Settings Store
+ *
+ * Typed registry of the runtime-tunable settings. The vm_config.h values
+ * are the defaults; the current values live in a RAM cache (vm_settings_t)
+ * that is persisted as one syscfg item (VM_CFG_ID_SETTINGS).
+ *
+ * A set only updates the cache and marks it dirty. The first change arms a
+ * VM_SETTINGS_FLUSH_MS timeout, and every change made before it fires goes
+ * out with the same flash write. vm_settings_flush() writes at once (SAVE
+ * command, before an OTA reset).
+ *
+ * Settings characteristic (WRITE | NOTIFY), every command is answered by a
+ * notification:
+ *
+ *   GET   [0x01][key]          -> [0x01][key][status][value...]
+ *   SET   [0x02][key][value..] -> [0x02][key][status][value...]
+ *   SAVE  [0x03]               -> [0x03][0x00][status]
+ *
+ * Integers are little endian in their registered size, strings are raw
+ * bytes without terminator. The value in a SET response is the stored one.
+ *
+ * Schema: vm_settings_t fields are only ever appended. A stored blob with
+ * an older version keeps its prefix and goes through the migration steps
+ * in vm_settings.c; a newer (larger) blob keeps the fields this firmware
+ * knows.
+ */
+
+#ifndef VM_SETTINGS_H
+#define VM_SETTINGS_H
+
+#include "typedef.h"
+#include "vm_adv_scheduler.h"
+
+#define VM_SETTINGS_VERSION     1
+
+#define VM_SETTINGS_NAME_MAX    16
+
+/* Setting keys */
+#define VM_SET_KEY_PWM_FREQ_HZ          0x01    /* u16, motor PWM frequency */
+#define VM_SET_KEY_DUTY_MIN             0x02    /* u16, output duty at the lowest non-zero intensity */
+#define VM_SET_KEY_DUTY_MAX             0x03    /* u16, output duty at full intensity */
+#define VM_SET_KEY_DEVICE_NAME          0x04    /* string, used from the next BLE start */
+#define VM_SET_KEY_ADV_FAST_INTERVAL    0x10    /* u16, vm_adv_sched_cfg_t fields */
+#define VM_SET_KEY_ADV_SLOW_INTERVAL    0x11
+#define VM_SET_KEY_ADV_FAST_DURATION_S  0x12
+#define VM_SET_KEY_ADV_SLOW_DURATION_S  0x13
+#define VM_SET_KEY_ADV_SLEEP_PERIOD_S   0x14
+#define VM_SET_KEY_ADV_WAKE_WINDOW_S    0x15
+#define VM_SET_KEY_ADV_SLEEP_ENABLE     0x16    /* u8 */
+
+/* Commands */
+#define VM_SET_CMD_GET          0x01
+#define VM_SET_CMD_SET          0x02
+#define VM_SET_CMD_SAVE         0x03
+
+/* Response status */
+#define VM_SET_OK               0x00
+#define VM_SET_ERR_KEY          0x01    /* Unknown key or command */
+#define VM_SET_ERR_LENGTH       0x02    /* Value length does not match the key */
+#define VM_SET_ERR_VALUE        0x03    /* Out of range or rejected by its module */
+#define VM_SET_ERR_STORAGE      0x04    /* Flash write failed */
+
+/* Response header: [cmd][key][status] */
+#define VM_SET_RSP_HEADER_SIZE  3
+#define VM_SET_RSP_MAX_SIZE     (VM_SET_RSP_HEADER_SIZE + VM_SETTINGS_NAME_MAX)
+
+/* Setting types */
+#define VM_SET_TYPE_U8          0
+#define VM_SET_TYPE_U16         1
+#define VM_SET_TYPE_STR         2
+
+/* Persisted settings (append new fields at the end, bump VM_SETTINGS_VERSION) */
+typedef struct {
+    u8  version;            /* VM_SETTINGS_VERSION */
+    u8  reserved;
+    u16 pwm_freq_hz;        /* Motor PWM frequency */
+    u16 duty_min;           /* Intensity 1..10000 maps linearly onto duty_min..duty_max */
+    u16 duty_max;
+    vm_adv_sched_cfg_t adv; /* Advertising schedule */
+    char device_name[VM_SETTINGS_NAME_MAX + 1];
+} vm_settings_t;
+
+/**
+ * Load settings (defaults, stored values, migration)
+ * Later calls are no-ops
+ */
+void vm_settings_init(void);
+
+/**
+ * Get the cached settings
+ */
+const vm_settings_t *vm_settings_get(void);
+
+/**
+ * Validate, apply and cache one setting, persisted by the next write-back
+ * @param key VM_SET_KEY_*
+ * @param value Little endian integer or string bytes
+ * @param len Value length
+ * @return VM_SET_OK or VM_SET_ERR_*
+ */
+u8 vm_settings_set(u8 key, const u8 *value, u8 len);
+
+/**
+ * Encode the current value of a setting
+ * @param key VM_SET_KEY_*
+ * @param buf Output buffer (VM_SETTINGS_NAME_MAX bytes are always enough)
+ * @return Value length, 0 for an unknown key
+ */
+u8 vm_settings_encode(u8 key, u8 *buf);
+
+/**
+ * Write pending changes now
+ * @return VM_SET_OK or VM_SET_ERR_STORAGE
+ */
+u8 vm_settings_flush(void);
+
+/**
+ * Check for changes not yet written to flash
+ */
+u8 vm_settings_is_dirty(void);
+
+/**
+ * Number of flash writes since boot (write-back statistics)
+ */
+u16 vm_settings_get_write_count(void);
+
+/**
+ * Handle one settings characteristic write
+ * @param req Request bytes
+ * @param len Request length
+ * @param rsp Response buffer (VM_SET_RSP_MAX_SIZE)
+ * @return Response length
+ */
+u8 vm_settings_handle_cmd(const u8 *req, u16 len, u8 *rsp);
+
+#endif /* VM_SETTINGS_H */
@@ -0,0 +1,368 @@
+/**
+ * Synchronized Playback
+ */
+
+#include "app_config.h"  /* Must be first for SDK configuration */
+#include "vm_sync.h"
+#include "vm_config.h"
+#include "vm_motor_control.h"
+#include "vm_power.h"
+
+#include "system/includes.h"
+#include "asm/hwi.h"
+#include "timer.h"
+
+/* Logging */
+#define VM_LOG_TAG      "VM_SYNC"
+#define VM_LOG_LEVEL    VM_LOG_LEVEL_SYNC
+#include "vm_log.h"
+
+/* Timer rate (STD_24M / 8), the clock counts whole microseconds */
+#define SYNC_TICKS_PER_US   3
+
+/* A new period ends at least this far after the current count, so the
+ * counter never has to wrap past a period already behind it */
+#define SYNC_ARM_MARGIN_US  20
+
+#define TIMER_CON_PND       BIT(15)
+#define TIMER_CON_CPND      BIT(14)
+
+#if (VM_SYNC_TICK_US * SYNC_TICKS_PER_US) > 0x7FFFFFFF
+#error "VM_SYNC_TICK_US too long for the timer period"
+#endif
+
+#if VM_SYNC_QUEUE_SIZE > 255
+#error "VM_SYNC_QUEUE_SIZE must fit the STATUS response"
+#endif
+
+typedef struct {
+    u32 at;             /* Device time */
+    u16 duty;
+} sync_entry_t;
+
+/* Pending changes in time order, shared with the timer interrupt */
+static sync_entry_t g_queue[VM_SYNC_QUEUE_SIZE];
+static volatile u8 g_queued = 0;
+
+static volatile u32 g_epoch_us = 0;     /* Clock at the start of the current period */
+static volatile u32 g_period_us = 0;    /* Length of the current period */
+static u8 g_session = 0;                /* Current session, 0: none */
+static u8 g_session_seq = 0;
+static u32 g_last_cmd_ms = 0;           /* jiffies_msec of the last sync command */
+static u16 g_idle_timer = 0;
+
+/* Statistics of the current session */
+static u16 g_applied = 0;
+static u16 g_late = 0;
+static u16 g_dropped = 0;
+static u16 g_worst_late_us = 0;
+
+static inline s32 time_diff(u32 a, u32 b)
+{
+    return (s32)(a - b);
+}
+
+/* ========== Clock (interrupts masked) ========== */
+
+static u32 clock_now(void)
+{
+    u32 cnt = VM_SYNC_TIMER->CNT;
+    u32 now = g_epoch_us;
+
+    /* Period ended but its interrupt has not run yet: count it here */
+    if (VM_SYNC_TIMER->CON & TIMER_CON_PND) {
+        cnt = VM_SYNC_TIMER->CNT;
+        now += g_period_us;
+    }
+    return now + cnt / SYNC_TICKS_PER_US;
+}
+
+/*
+ * End the current period at the next queued change, or after
+ * VM_SYNC_TICK_US. Only while no period end is pending: the interrupt
+ * must add the period that actually ran.
+ */
+static void timer_arm(void)
+{
+    u32 elapsed = VM_SYNC_TIMER->CNT / SYNC_TICKS_PER_US;
+    u32 period = VM_SYNC_TICK_US;
+    s32 until;
+
+    if (g_queued) {
+        until = time_diff(g_queue[0].at, g_epoch_us);
+        if (until < (s32)period) {
+            period = (until > 0) ? (u32)until : 0;
+        }
+    }
+    if (period < elapsed + SYNC_ARM_MARGIN_US) {
+        period = elapsed + SYNC_ARM_MARGIN_US;
+    }
+
+    g_period_us = period;
+    VM_SYNC_TIMER->PRD = period * SYNC_TICKS_PER_US;
+}
+
+/* Apply every queued change that is due */
+static void apply_due(u32 now)
+{
+    u32 late;
+    u8 i;
+
+    while (g_queued && time_diff(now, g_queue[0].at) >= 0) {
+        late = now - g_queue[0].at;
+        vm_motor_set_duty(g_queue[0].duty);
+
+        g_applied++;
+        if (late > VM_SYNC_LATE_US) {
+            g_late++;
+        }
+        if (late > g_worst_late_us) {
+            g_worst_late_us = (late > 0xFFFF) ? 0xFFFF : (u16)late;
+        }
+
+        g_queued--;
+        for (i = 0; i < g_queued; i++) {
+            g_queue[i] = g_queue[i + 1];
+        }
+    }
+}
+
+___interrupt
+static void sync_timer_isr(void)
+{
+    VM_SYNC_TIMER->CON |= TIMER_CON_CPND;
+    g_epoch_us += g_period_us;
+
+    apply_due(clock_now());
+    timer_arm();
+}
+
+/* ========== Session ========== */
+
+static void sync_idle_poll(void *priv)
+{
+    (void)priv;
+
+    if (!g_queued && (u32)(jiffies_msec() - g_last_cmd_ms) >= VM_SYNC_IDLE_MS) {
+        log_info("session %d idle\n", g_session);
+        vm_sync_stop();
+    }
+}
+
+static int session_start(void)
+{
+    if (VM_SYNC_TIMER == VM_MOTOR_TIMER || VM_SYNC_TIMER == VM_TRACE_TIMER) {
+        log_error("VM_SYNC_TIMER is in use, no synchronized playback\n");
+        return -1;
+    }
+
+    g_queued = 0;
+    g_epoch_us = 0;
+    g_period_us = VM_SYNC_TICK_US;
+    g_applied = 0;
+    g_late = 0;
+    g_dropped = 0;
+    g_worst_late_us = 0;
+
+    /* Up-counter from STD_24M / 8, interrupt at the end of every period */
+    VM_SYNC_TIMER->CON = TIMER_CON_CPND;
+    VM_SYNC_TIMER->CNT = 0;
+    VM_SYNC_TIMER->PRD = g_period_us * SYNC_TICKS_PER_US;
+    request_irq(VM_SYNC_TIMER_IRQ, 1, sync_timer_isr, 0);
+    VM_SYNC_TIMER->CON |= (0b110 << 10);    /* Clock source: STD_24M */
+    VM_SYNC_TIMER->CON |= (0b0101 << 4);    /* Clock divider: /8 */
+    VM_SYNC_TIMER->CON |= TIMER_CON_CPND | (0b01 << 0);
+
+    /* Powerdown sleep would stop the timer and with it the clock */
+    vm_power_hold();
+
+    if (++g_session_seq == 0) {
+        g_session_seq = 1;
+    }
+    g_session = g_session_seq;
+
+    if (!g_idle_timer) {
+        g_idle_timer = sys_timer_add(NULL, sync_idle_poll, VM_SYNC_IDLE_POLL_MS);
+    }
+
+    log_info("session %d started\n", g_session);
+    return 0;
+}
+
+void vm_sync_stop(void)
+{
+    if (!g_session) {
+        return;
+    }
+
+    local_irq_disable();
+    VM_SYNC_TIMER->CON = TIMER_CON_CPND;
+    g_queued = 0;
+    local_irq_enable();
+    unrequest_irq(VM_SYNC_TIMER_IRQ);
+
+    if (g_idle_timer) {
+        sys_timer_del(g_idle_timer);
+        g_idle_timer = 0;
+    }
+    vm_power_release();
+
+    log_info("session %d ended: %d applied, %d late, %d dropped\n",
+             g_session, g_applied, g_late, g_dropped);
+    g_session = 0;
+}
+
+u32 vm_sync_now(void)
+{
+    u32 now;
+
+    if (!g_session) {
+        return 0;
+    }
+    local_irq_disable();
+    now = clock_now();
+    local_irq_enable();
+    return now;
+}
+
+/* ========== Commands ========== */
+
+static void put_u16(u8 *p, u16 v)
+{
+    p[0] = v & 0xFF;
+    p[1] = v >> 8;
+}
+
+static void put_u32(u8 *p, u32 v)
+{
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+    p[2] = (v >> 16) & 0xFF;
+    p[3] = v >> 24;
+}
+
+/*
+ * Queue the SCHEDULE entries (already checked)
+ * @return 0 or the error status to notify
+ */
+static u8 sync_schedule(const u8 *entries, u8 count)
+{
+    u8 status = 0;
+    u32 now;
+    u32 at;
+    u16 duty;
+    s32 ahead;
+    u8 i;
+    u8 pos;
+
+    local_irq_disable();
+    now = clock_now();
+
+    for (i = 0; i < count; i++, entries += VM_SYNC_ENTRY_SIZE) {
+        at = entries[0] | ((u32)entries[1] << 8) | ((u32)entries[2] << 16) | ((u32)entries[3] << 24);
+        duty = entries[4] | (entries[5] << 8);
+        ahead = time_diff(at, now);
+
+        if (ahead > VM_SYNC_HORIZON_US) {
+            g_dropped++;
+            status = VM_SYNC_ERR_HORIZON;
+            continue;
+        }
+        if (g_queued == VM_SYNC_QUEUE_SIZE) {
+            g_dropped++;
+            status = VM_SYNC_ERR_FULL;
+            continue;
+        }
+
+        /* Insert after every entry due no later (equal times keep write order) */
+        pos = g_queued;
+        while (pos && time_diff(g_queue[pos - 1].at, at) > 0) {
+            g_queue[pos] = g_queue[pos - 1];
+            pos--;
+        }
+        g_queue[pos].at = at;
+        g_queue[pos].duty = duty;
+        g_queued++;
+    }
+
+    /* Already due (arrived late): at once, from here */
+    apply_due(now);
+
+    if (!(VM_SYNC_TIMER->CON & TIMER_CON_PND)) {
+        timer_arm();
+    }
+    local_irq_enable();
+
+    return status;
+}
+
+u8 vm_sync_handle_cmd(const u8 *cmd, u16 len, u8 *rsp)
+{
+    u32 rx = vm_sync_now();
+    const u8 *e;
+    u8 count;
+    u8 status;
+
+    if (!cmd || !len) {
+        return 0;
+    }
+    g_last_cmd_ms = jiffies_msec();
+
+    switch (cmd[0]) {
+    case VM_SYNC_CMD_PING:
+        if (len != 2) {
+            return 0;
+        }
+        if (!g_session && session_start() == 0) {
+            rx = vm_sync_now();
+        }
+        rsp[0] = VM_SYNC_CMD_PING;
+        rsp[1] = cmd[1];
+        rsp[2] = g_session;
+        put_u32(&rsp[3], rx);
+        put_u32(&rsp[7], vm_sync_now());
+        return VM_SYNC_PING_RSP_SIZE;
+
+    case VM_SYNC_CMD_SCHEDULE:
+        rsp[0] = VM_SYNC_CMD_SCHEDULE;
+        if ((len - 1) % VM_SYNC_ENTRY_SIZE || len == 1 ||
+            (len - 1) / VM_SYNC_ENTRY_SIZE > VM_SYNC_ENTRIES_MAX) {
+            rsp[1] = VM_SYNC_ERR_LENGTH;
+            return 2;
+        }
+        count = (len - 1) / VM_SYNC_ENTRY_SIZE;
+        for (e = &cmd[1]; e < &cmd[len]; e += VM_SYNC_ENTRY_SIZE) {
+            if ((e[4] | (e[5] << 8)) > VM_MOTOR_DUTY_MAX) {
+                rsp[1] = VM_SYNC_ERR_DUTY;
+                return 2;
+            }
+        }
+        if (!g_session) {
+            rsp[1] = VM_SYNC_ERR_NO_CLOCK;
+            return 2;
+        }
+        status = sync_schedule(&cmd[1], count);
+        if (status) {
+            rsp[1] = status;
+            return 2;
+        }
+        return 0;
+
+    case VM_SYNC_CMD_STOP:
+        vm_sync_stop();
+        return 0;
+
+    case VM_SYNC_CMD_STATUS:
+        rsp[0] = VM_SYNC_CMD_STATUS;
+        rsp[1] = g_session;
+        rsp[2] = g_queued;
+        put_u16(&rsp[3], g_applied);
+        put_u16(&rsp[5], g_late);
+        put_u16(&rsp[7], g_dropped);
+        put_u16(&rsp[9], g_worst_late_us);
+        return VM_SYNC_STATUS_RSP_SIZE;
+
+    default:
+        return 0;
+    }
+}
@@ -0,0 +1,87 @@
+/**
+ * Synchronized Playback
+ *
+ * Lets the phone drive several toys (or a partner's toy through remote
+ * mode) in step. Plain motor writes take effect at the connection event
+ * they arrive in, so two devices on different connections are apart by
+ * their connection interval phase. Here the phone keeps an estimate of
+ * each device clock and sends every duty change with the device time at
+ * which it applies; the device plays it out from a hardware timer.
+ *
+ * Device clock: microseconds, u32, wraps every 71 minutes. It runs from
+ * VM_SYNC_TIMER (STD_24M / 8) and starts at 0 with each session. A session
+ * starts with the first sync command and holds the CPU awake
+ * (vm_power_hold()) so the timer never stops; it ends after VM_SYNC_IDLE_MS
+ * without sync commands and an empty queue, on STOP or on disconnect. The
+ * session number in the PING response changes with every new session, the
+ * phone then drops its estimate.
+ *
+ * The timer is tickless: its period is the time to the next queued change,
+ * at most VM_SYNC_TICK_US, and the clock advances by one period per
+ * interrupt, so rearming never loses time.
+ *
+ * Sync characteristic (WRITE_WITHOUT_RESPONSE | NOTIFY), little endian:
+ *
+ *   PING     [0x01][seq]                  -> [0x01][seq][session][rx u32][tx u32]
+ *            rx: device time at the write callback, tx: just before the notification
+ *   SCHEDULE [0x02]{[at u32][duty u16]}x1-3   no response; only an error is
+ *                                         notified: [0x02][status]
+ *   STOP     [0x03]                       -> drop the queue, end the session
+ *   STATUS   [0x04]                       -> [0x04][session][queued][applied u16]
+ *                                            [late u16][dropped u16][worst late us u16]
+ *
+ * A change whose time has already passed is applied at once and counted
+ * late. Times more than VM_SYNC_HORIZON_US ahead are refused.
+ *
+ * The phone side (clock estimate and multi-device player) is
+ * core/sync-playback.js in the client.
+ */
+
+#ifndef VM_SYNC_H
+#define VM_SYNC_H
+
+#include "typedef.h"
+
+/* Commands */
+#define VM_SYNC_CMD_PING            0x01
+#define VM_SYNC_CMD_SCHEDULE        0x02
+#define VM_SYNC_CMD_STOP            0x03
+#define VM_SYNC_CMD_STATUS          0x04
+
+/* SCHEDULE entry: [at u32][duty u16] */
+#define VM_SYNC_ENTRY_SIZE          6
+#define VM_SYNC_ENTRIES_MAX         3       /* One 20-byte write */
+
+/* SCHEDULE error status */
+#define VM_SYNC_ERR_LENGTH          0x01    /* Not a whole number of entries */
+#define VM_SYNC_ERR_DUTY            0x02    /* Duty above 10000 */
+#define VM_SYNC_ERR_NO_CLOCK        0x03    /* No session: times refer to an old clock */
+#define VM_SYNC_ERR_HORIZON         0x04    /* Too far ahead */
+#define VM_SYNC_ERR_FULL            0x05    /* Queue full, entries dropped */
+
+#define VM_SYNC_PING_RSP_SIZE       11
+#define VM_SYNC_STATUS_RSP_SIZE     11
+#define VM_SYNC_RSP_MAX_SIZE        11
+
+/**
+ * Handle a sync characteristic write
+ * @param cmd Written bytes
+ * @param len Length
+ * @param rsp Output, VM_SYNC_RSP_MAX_SIZE bytes
+ * @return Bytes to notify, 0 for none
+ */
+u8 vm_sync_handle_cmd(const u8 *cmd, u16 len, u8 *rsp);
+
+/**
+ * Device clock
+ * @return Microseconds since the session started, 0 without a session
+ */
+u32 vm_sync_now(void);
+
+/**
+ * End the session: drop the queue, stop the timer, release the CPU hold
+ * (disconnect, deinit)
+ */
+void vm_sync_stop(void);
+
+#endif /* VM_SYNC_H */
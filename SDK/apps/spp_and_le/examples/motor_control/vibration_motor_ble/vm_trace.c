@@ -0,0 +1,166 @@
+/**
+ * Latency Tracepoints
+ */
+
+#include "app_config.h"  /* Must be first for SDK configuration */
+#include "vm_trace.h"
+#include "vm_config.h"
+
+#include "system/includes.h"
+#include "timer.h"
+
+/* Logging */
+#define VM_LOG_TAG      "VM_TRACE"
+#define VM_LOG_LEVEL    VM_LOG_LEVEL_DEFAULT
+#include "vm_log.h"
+
+#if (VM_TRACE_RING_SIZE & (VM_TRACE_RING_SIZE - 1)) || (VM_TRACE_RING_SIZE > 256)
+#error "VM_TRACE_RING_SIZE must be a power of two up to 256"
+#endif
+
+/* Disabled: no tracepoints, keep the RAM and the timer */
+#if VM_TRACE_ENABLE
+#define RING_SIZE       VM_TRACE_RING_SIZE
+#else
+#define RING_SIZE       1
+#endif
+
+#define RING_MASK       (RING_SIZE - 1)
+
+typedef struct {
+    u32 ts;
+    u32 info;           /* event << 24 | arg */
+} trace_rec_t;
+
+static trace_rec_t g_ring[RING_SIZE];
+static u16 g_head = 0;          /* Next slot (free running) */
+static u16 g_count = 0;         /* Valid records, up to RING_SIZE */
+static u8 g_running = 0;        /* Timer started */
+static volatile u8 g_paused = 1;
+static u8 g_dumping = 0;
+static u16 g_dump_pos = 0;
+static u16 g_dump_end = 0;
+
+void vm_trace_point(u8 event, u32 arg)
+{
+    trace_rec_t *r;
+
+    local_irq_disable();
+    if (!g_paused) {
+        r = &g_ring[g_head & RING_MASK];
+        r->ts = VM_TRACE_TIMER->CNT;
+        r->info = ((u32)event << 24) | (arg & 0xFFFFFF);
+        g_head++;
+        if (g_count < RING_SIZE) {
+            g_count++;
+        }
+    }
+    local_irq_enable();
+}
+
+void vm_trace_init(void)
+{
+    if (!VM_TRACE_ENABLE || g_running) {
+        return;
+    }
+    if (VM_TRACE_TIMER == VM_MOTOR_TIMER) {
+        log_error("VM_TRACE_TIMER is the motor PWM timer, tracing off\n");
+        return;
+    }
+
+    /* Free-running counter, no interrupt */
+    VM_TRACE_TIMER->CON = 0;
+    VM_TRACE_TIMER->CON |= (0b110 << 10);   /* Clock source: STD_24M */
+    VM_TRACE_TIMER->CON |= (0b0101 << 4);   /* Clock divider: /8 */
+    VM_TRACE_TIMER->CNT = 0;
+    VM_TRACE_TIMER->PRD = 0xFFFFFFFF;
+    VM_TRACE_TIMER->CON |= (0b01 << 0);     /* Count mode */
+
+    g_running = 1;
+    g_paused = g_dumping;
+}
+
+void vm_trace_deinit(void)
+{
+    if (!g_running) {
+        return;
+    }
+
+    local_irq_disable();
+    g_paused = 1;
+    g_running = 0;
+    local_irq_enable();
+
+    VM_TRACE_TIMER->CON = 0;
+}
+
+/* ========== Dump ========== */
+
+u16 vm_trace_dump_start(void)
+{
+    local_irq_disable();
+    if (!g_dumping) {
+        g_dumping = 1;
+        g_paused = 1;
+        g_dump_end = g_head;
+        g_dump_pos = g_head - g_count;
+    }
+    local_irq_enable();
+
+    return g_dump_end - g_dump_pos;
+}
+
+u16 vm_trace_dump_next(u8 *buf, u16 max)
+{
+    const trace_rec_t *r;
+    u16 n = 0;
+
+    if (!g_dumping) {
+        return 0;
+    }
+    while (n < max && g_dump_pos != g_dump_end) {
+        r = &g_ring[g_dump_pos & RING_MASK];
+        buf[0] = r->ts & 0xFF;
+        buf[1] = (r->ts >> 8) & 0xFF;
+        buf[2] = (r->ts >> 16) & 0xFF;
+        buf[3] = r->ts >> 24;
+        buf[4] = r->info & 0xFF;
+        buf[5] = (r->info >> 8) & 0xFF;
+        buf[6] = (r->info >> 16) & 0xFF;
+        buf[7] = r->info >> 24;
+        buf += VM_TRACE_RECORD_SIZE;
+        g_dump_pos++;
+        n++;
+    }
+    if (g_dump_pos == g_dump_end) {
+        g_count = 0;    /* Handed out: the next dump starts after them */
+        vm_trace_dump_end();
+    }
+    return n;
+}
+
+u16 vm_trace_dump_left(void)
+{
+    return g_dumping ? (u16)(g_dump_end - g_dump_pos) : 0;
+}
+
+void vm_trace_dump_end(void)
+{
+    local_irq_disable();
+    g_dumping = 0;
+    g_paused = !g_running;
+    local_irq_enable();
+}
+
+void vm_trace_dump_uart(void)
+{
+    u8 rec[VM_TRACE_RECORD_SIZE];
+
+    /* Explicitly requested output: printed whatever the log level */
+    printf("[VM_TRACE] dump: %d records, %d ticks/us\n", vm_trace_dump_start(), VM_TRACE_TICKS_PER_US);
+    while (vm_trace_dump_next(rec, 1)) {
+        printf("[VM_TRACE] %08x %08x\n",
+               rec[0] | (rec[1] << 8) | (rec[2] << 16) | ((u32)rec[3] << 24),
+               rec[4] | (rec[5] << 8) | (rec[6] << 16) | ((u32)rec[7] << 24));
+    }
+}
@@ -0,0 +1,104 @@
+/**
+ * Latency Tracepoints
+ *
+ * VM_TRACE(event, arg) stores a two-word record in a RAM ring, oldest
+ * records overwritten:
+ *
+ *   word 0  timestamp, VM_TRACE_TICKS_PER_US ticks per microsecond
+ *   word 1  event << 24 | arg (24 bits)
+ *
+ * The timestamp is the counter of VM_TRACE_TIMER, run free from STD_24M / 8.
+ * It wraps every 23 minutes and stops while the CPU sleeps, so only the
+ * distance between records within one wake-up is exact (a GATT write and
+ * the PWM update it causes always are).
+ *
+ * A record costs two register reads and two stores with interrupts masked;
+ * with VM_TRACE_ENABLE set to 0 the tracepoints compile to nothing.
+ *
+ * Dump with the device info trace query: 0xB0 0x05 pages the records out
+ * two per notification, 0xB0 0x05 0x01 prints them on the debug UART.
+ * Recording pauses during a dump. tools/trace_report.py turns either dump
+ * into latency histograms and a Chrome trace (chrome://tracing, Perfetto).
+ */
+
+#ifndef VM_TRACE_H
+#define VM_TRACE_H
+
+#include "typedef.h"
+#include "vm_config.h"
+
+/* Events (record word 1 bits 31-24), names are read by tools/trace_report.py */
+#define VM_TRACE_EV_ATT_WRITE       0x01    /* GATT write callback entry, arg: ATT handle */
+#define VM_TRACE_EV_MOTOR_WRITE     0x02    /* Motor write parsed, arg: requested duty */
+#define VM_TRACE_EV_PWM_SET         0x03    /* PWM register written, arg: output duty */
+#define VM_TRACE_EV_OTA_WRITE       0x04    /* OTA DATA received, arg: sequence */
+#define VM_TRACE_EV_FLASH_BEGIN     0x05    /* OTA page program start, arg: bank offset / 256 */
+#define VM_TRACE_EV_FLASH_END       0x06    /* OTA page program done, arg: 0 ok, 1 failed */
+#define VM_TRACE_EV_OTA_ACK         0x07    /* OTA ACK queued, arg: sequence */
+#define VM_TRACE_EV_CONNECT         0x08    /* Connection complete, arg: handle */
+#define VM_TRACE_EV_DISCONNECT      0x09    /* Disconnection complete, arg: handle */
+#define VM_TRACE_EV_ENCRYPTION      0x0A    /* Encryption enabled, arg: handle */
+#define VM_TRACE_EV_CONN_UPDATE     0x0B    /* Connection parameters updated */
+
+/* Timestamp rate (STD_24M / 8) */
+#define VM_TRACE_TICKS_PER_US       3
+
+/* Record size in a dump */
+#define VM_TRACE_RECORD_SIZE        8
+
+#if VM_TRACE_ENABLE
+#define VM_TRACE(event, arg)        vm_trace_point(VM_TRACE_EV_##event, (arg))
+#else
+#define VM_TRACE(event, arg)        ((void)0)
+#endif
+
+/**
+ * Store a record (use VM_TRACE())
+ * @param event VM_TRACE_EV_*
+ * @param arg Event argument, low 24 bits kept
+ */
+void vm_trace_point(u8 event, u32 arg);
+
+/**
+ * Start the timestamp timer and recording
+ */
+void vm_trace_init(void);
+
+/**
+ * Stop recording and the timer
+ */
+void vm_trace_deinit(void);
+
+/**
+ * Pause recording and start a dump from the oldest record
+ * (continues a dump already in progress)
+ * @return Records left to dump
+ */
+u16 vm_trace_dump_start(void);
+
+/**
+ * Copy the next records of the dump, little-endian [timestamp][word 1];
+ * recording resumes after the last one
+ * @param buf Output buffer
+ * @param max Most records to copy (buf holds max * VM_TRACE_RECORD_SIZE bytes)
+ * @return Records copied
+ */
+u16 vm_trace_dump_next(u8 *buf, u16 max);
+
+/**
+ * Records left in the dump in progress
+ */
+u16 vm_trace_dump_left(void);
+
+/**
+ * Abandon the dump in progress and resume recording
+ */
+void vm_trace_dump_end(void);
+
+/**
+ * Print the whole ring on the debug UART: a header line, then
+ * "[VM_TRACE] <timestamp> <word 1>" per record (hex)
+ */
+void vm_trace_dump_uart(void);
+
+#endif /* VM_TRACE_H */
@@ -58,6 +58,16 @@
 #define DOUBLE_BT_SAME_MAC                 0 //同地址
 #define CONFIG_BLE_HIGH_SPEED              0 //BLE提速模式
 
+//长距离模式: 扩展广播(Coded PHY) + 连接后按RSSI自动切换PHY, 需要手机支持BLE5 Coded PHY
+//注意: 扩展广播模式不支持低功耗
+#define CONFIG_MOTOR_LONG_RANGE            0
+#if CONFIG_MOTOR_LONG_RANGE
+#undef  CONFIG_BT_EXT_ADV_MODE
+#define CONFIG_BT_EXT_ADV_MODE             1
+#undef  CONFIG_BLE_PHY_SET
+#define CONFIG_BLE_PHY_SET                 CONFIG_SET_CODED_S8_PHY //S2: CONFIG_SET_CODED_S2_PHY
+#endif
+
 //蓝牙BLE配置
 #define CONFIG_BT_GATT_COMMON_ENABLE       1 //配置使用gatt公共模块
 #define CONFIG_BT_SM_SUPPORT_ENABLE        1 //配置是否支持加密 (LESC)
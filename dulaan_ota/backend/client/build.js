@@ -14,10 +14,18 @@ const FILES_TO_BUNDLE = [
     'utils/constants.js',
     'utils/audio-utils.js',
     'utils/motor-patterns.js',
+    'utils/pattern-codec.js',
+    'utils/adv-status.js',
+    'utils/audio-upload.js',
     
     // 2. Core components
+    'core/motor-scheduler.js',
     'core/motor-controller.js',
+    'core/audio-frontend.js',
     'core/streaming-processor.js',
+    'core/speech-transcript.js',
+    'core/remote-stream.js',
+    'core/sync-playback.js',
     'core/ota-controller.js',
     
     // 3. Services
@@ -0,0 +1,527 @@
+/**
+ * Audio Front End - Voice activity detection on fixed buffers
+ *
+ * Capacitor delivers microphone audio as base64 Float32 chunks (1600
+ * samples, 100 ms) on the main thread. Decoding each one into fresh arrays
+ * and copying samples one by one into ring buffers there competes with BLE
+ * writes and the UI, and the garbage it leaves stutters vibration.
+ *
+ * AudioFrontEnd does the per-chunk work without allocating:
+ * - base64 is decoded into one scratch buffer sized for the largest chunk
+ * - RMS, zero-crossing rate and peak come from a single pass
+ * - the VAD decision, the voice start/end state machine and the pre-speech
+ *   (vadBuffer) and speech (speechBuffer) rings all live here
+ * The only allocation is the Int16 segment handed over when speech ends or
+ * reaches the maximum duration.
+ *
+ * AudioFrontEndRunner runs it in a Worker when one can be created and on
+ * the calling thread otherwise (Node, WebViews without Blob workers). Both
+ * deliver the same compact feature frames to onFrame.
+ */
+
+import { RingBuffer } from '../utils/audio-utils.js';
+
+export const AUDIO_FRONTEND_DEFAULTS = {
+    SAMPLE_RATE: 16000,
+    CHUNK_SAMPLES: 1600,            // Scratch size, grown for larger chunks
+    VAD_BUFFER_SAMPLES: 4800,       // 300 ms of context before speech
+    SPEECH_BUFFER_SAMPLES: 16000 * 30,
+    PRE_SPEECH_SAMPLES: 4800,       // 300 ms
+    POST_SPEECH_SAMPLES: 3200,      // 200 ms
+    OVERLAP_SAMPLES: 8000,          // 500 ms kept when a long utterance is split
+    ENERGY_THRESHOLD: 0.008,
+    ZCR_THRESHOLD: 0.08,
+    ZCR_NOISE: 0.5,                 // ZCR above this is noise
+    VOICE_FRAMES: 3,                // Consecutive frames to confirm voice
+    SILENCE_FRAMES: 20,             // Consecutive frames of silence to end speech
+    MIN_SPEECH_SAMPLES: 500,
+    MAX_SPEECH_SAMPLES: 320000,     // 20 seconds
+    ENERGY_HISTORY: 100             // Frames in the adaptive threshold average
+};
+
+// Frame events
+export const AUDIO_FRAME_EVENT = {
+    NONE: 0,
+    VOICE_START: 1,
+    VOICE_END: 2
+};
+
+class AudioFrontEnd {
+    constructor(config = {}) {
+        this.config = Object.assign({}, AUDIO_FRONTEND_DEFAULTS, config);
+        const c = this.config;
+
+        // Decode scratch: bytes and the Float32 view over them
+        this.bytes = null;
+        this.floats = null;
+        this.ensureCapacity(c.CHUNK_SAMPLES * 4);
+        this.littleEndian = new Uint8Array(new Uint16Array([1]).buffer)[0] === 1;
+
+        // base64 alphabet, 0x80 marks characters outside it
+        this.base64Table = new Uint8Array(256).fill(0x80);
+        const alphabet = 'ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/';
+        for (let i = 0; i < alphabet.length; i++) {
+            this.base64Table[alphabet.charCodeAt(i)] = i;
+        }
+        this.base64Table['-'.charCodeAt(0)] = 62;   // URL-safe alphabet
+        this.base64Table['_'.charCodeAt(0)] = 63;
+        this.encoder = typeof TextEncoder !== 'undefined' ? new TextEncoder() : null;
+        this.ascii = null;
+
+        this.vadBuffer = new RingBuffer(c.VAD_BUFFER_SAMPLES);
+        this.speechBuffer = new RingBuffer(c.SPEECH_BUFFER_SAMPLES);
+        this.energyHistory = new Float64Array(c.ENERGY_HISTORY);
+
+        // Reused results: read them before the next call
+        this.features = { samples: 0, rms: 0, zcr: 0, peak: 0 };
+        this.frame = {
+            seq: 0,
+            samples: 0,
+            rms: 0,
+            zcr: 0,
+            peak: 0,
+            voice: false,           // VAD decision for this chunk
+            active: false,          // Speech in progress
+            event: AUDIO_FRAME_EVENT.NONE,
+            speechSamples: 0,
+            segment: null           // { pcm: Int16Array, final } when speech is handed over
+        };
+
+        this.decodeErrors = 0;
+        this.reset();
+    }
+
+    ensureCapacity(byteLength) {
+        if (this.bytes && this.bytes.length >= byteLength) {
+            return;
+        }
+        const size = (byteLength + 3) & ~3;
+        this.bytes = new Uint8Array(size);
+        this.floats = new Float32Array(this.bytes.buffer);
+    }
+
+    /**
+     * Decode a base64 Float32 chunk into this.floats; returns the sample count
+     */
+    decode(base64) {
+        const start = base64.indexOf(',') + 1;      // Skip a data: URL header
+        let end = base64.length;
+        while (end > start && base64.charCodeAt(end - 1) === 61) {     // '='
+            end--;
+        }
+
+        const byteLength = ((end - start) * 3) >> 2;
+        this.ensureCapacity(byteLength);
+
+        // Reading the characters as bytes is about twice as fast as charCodeAt()
+        let out = this.encoder ? this.decodeAscii(base64, start, end) : this.decodeChars(base64, start, end);
+        if (out < 0) {
+            // Whitespace or other characters atob() tolerates: take the slow path
+            out = this.decodeWithAtob(base64.slice(start));
+            if (out < 0) {
+                this.decodeErrors++;
+                return 0;
+            }
+        }
+
+        const samples = out >> 2;
+        if (!this.littleEndian) {
+            const bytes = this.bytes;
+            for (let k = 0; k < samples * 4; k += 4) {
+                let t = bytes[k]; bytes[k] = bytes[k + 3]; bytes[k + 3] = t;
+                t = bytes[k + 1]; bytes[k + 1] = bytes[k + 2]; bytes[k + 2] = t;
+            }
+        }
+        return samples;
+    }
+
+    /**
+     * base64 to this.bytes through TextEncoder.encodeInto(); -1 on a
+     * character outside the alphabet
+     */
+    decodeAscii(base64, start, end) {
+        if (!this.ascii || this.ascii.length < base64.length) {
+            this.ascii = new Uint8Array(base64.length + 64);
+        }
+        this.encoder.encodeInto(base64, this.ascii);
+        return this.decodeQuads(this.ascii, start, end);
+    }
+
+    decodeQuads(ascii, start, end) {
+        const table = this.base64Table;
+        const bytes = this.bytes;
+        let out = 0;
+        let invalid = 0;
+        let i = start;
+        for (; i + 4 <= end; i += 4) {
+            const a = table[ascii[i]];
+            const b = table[ascii[i + 1]];
+            const c = table[ascii[i + 2]];
+            const d = table[ascii[i + 3]];
+            invalid |= a | b | c | d;
+            const n = (a << 18) | (b << 12) | (c << 6) | d;
+            bytes[out++] = n >> 16;
+            bytes[out++] = (n >> 8) & 0xFF;
+            bytes[out++] = n & 0xFF;
+        }
+        if (end - i >= 2) {
+            const a = table[ascii[i]];
+            const b = table[ascii[i + 1]];
+            const c = end - i === 3 ? table[ascii[i + 2]] : 0;
+            invalid |= a | b | c;
+            const n = (a << 18) | (b << 12) | (c << 6);
+            bytes[out++] = n >> 16;
+            if (end - i === 3) {
+                bytes[out++] = (n >> 8) & 0xFF;
+            }
+        }
+        return invalid & 0x80 ? -1 : out;
+    }
+
+    /**
+     * Same as decodeAscii() without TextEncoder
+     */
+    decodeChars(base64, start, end) {
+        const table = this.base64Table;
+        const bytes = this.bytes;
+        let out = 0;
+        let invalid = 0;
+        let i = start;
+        for (; i + 4 <= end; i += 4) {
+            const a = table[base64.charCodeAt(i) & 0xFF];
+            const b = table[base64.charCodeAt(i + 1) & 0xFF];
+            const c = table[base64.charCodeAt(i + 2) & 0xFF];
+            const d = table[base64.charCodeAt(i + 3) & 0xFF];
+            invalid |= a | b | c | d;
+            const n = (a << 18) | (b << 12) | (c << 6) | d;
+            bytes[out++] = n >> 16;
+            bytes[out++] = (n >> 8) & 0xFF;
+            bytes[out++] = n & 0xFF;
+        }
+        if (end - i >= 2) {
+            const a = table[base64.charCodeAt(i) & 0xFF];
+            const b = table[base64.charCodeAt(i + 1) & 0xFF];
+            const c = end - i === 3 ? table[base64.charCodeAt(i + 2) & 0xFF] : 0;
+            invalid |= a | b | c;
+            const n = (a << 18) | (b << 12) | (c << 6);
+            bytes[out++] = n >> 16;
+            if (end - i === 3) {
+                bytes[out++] = (n >> 8) & 0xFF;
+            }
+        }
+        return invalid & 0x80 ? -1 : out;
+    }
+
+    decodeWithAtob(base64) {
+        let binary;
+        try {
+            binary = atob(base64);
+        } catch (error) {
+            return -1;
+        }
+        this.ensureCapacity(binary.length);
+        for (let i = 0; i < binary.length; i++) {
+            this.bytes[i] = binary.charCodeAt(i);
+        }
+        return binary.length;
+    }
+
+    /**
+     * Decode a chunk and extract RMS, zero-crossing rate and peak in one pass
+     * Returns this.features; the samples are in this.floats
+     */
+    analyze(base64) {
+        const features = this.features;
+        const n = this.decode(base64);
+        features.samples = n;
+        if (n === 0) {
+            features.rms = features.zcr = features.peak = 0;
+            return features;
+        }
+
+        const x = this.floats;
+        let sum = 0;
+        let peak = 0;
+        let crossings = 0;
+        let positive = x[0] >= 0;
+        for (let i = 0; i < n; i++) {
+            const v = x[i];
+            sum += v * v;
+            const a = v < 0 ? -v : v;
+            if (a > peak) peak = a;
+            const p = v >= 0;
+            if (p !== positive) crossings++;
+            positive = p;
+        }
+
+        features.rms = Math.sqrt(sum / n);
+        features.zcr = crossings / n;
+        features.peak = peak;
+        return features;
+    }
+
+    /**
+     * VAD decision with a threshold that adapts to the recent energy average
+     */
+    detectVoice(rms, zcr) {
+        const c = this.config;
+        const history = this.energyHistory;
+
+        this.energySum += rms - history[this.energyIndex];
+        history[this.energyIndex] = rms;
+        if (++this.energyIndex === history.length) {
+            this.energyIndex = 0;
+            // Recompute once per lap so rounding cannot accumulate
+            let sum = 0;
+            for (let i = 0; i < history.length; i++) sum += history[i];
+            this.energySum = sum;
+        }
+        if (this.energyCount < history.length) this.energyCount++;
+
+        const avgEnergy = this.energySum / this.energyCount;
+        const adaptiveThreshold = Math.max(c.ENERGY_THRESHOLD, avgEnergy * 2);
+        const energyActive = rms > c.ENERGY_THRESHOLD;
+        const zcrActive = zcr > c.ZCR_THRESHOLD && zcr < c.ZCR_NOISE;
+
+        return energyActive && (zcrActive || rms > adaptiveThreshold * 1.5);
+    }
+
+    /**
+     * Process one chunk: features, VAD state machine and buffering
+     * Returns this.frame
+     */
+    process(base64) {
+        const c = this.config;
+        const frame = this.frame;
+        const features = this.analyze(base64);
+        const n = features.samples;
+
+        frame.seq++;
+        frame.samples = n;
+        frame.rms = features.rms;
+        frame.zcr = features.zcr;
+        frame.peak = features.peak;
+        frame.event = AUDIO_FRAME_EVENT.NONE;
+        frame.segment = null;
+        if (n === 0) {
+            frame.voice = false;
+            return frame;
+        }
+
+        // Always keep recent audio for pre/post-speech context
+        this.vadBuffer.pushFrom(this.floats, n);
+        const voice = this.detectVoice(features.rms, features.zcr);
+        frame.voice = voice;
+
+        if (voice) {
+            this.voiceFrames++;
+            this.silenceFrames = 0;
+
+            if (!this.active && this.voiceFrames >= c.VOICE_FRAMES) {
+                // The pre-speech context already ends with this chunk
+                this.active = true;
+                this.speechBuffer.reset();
+                this.speechBuffer.pushLastOf(this.vadBuffer, c.PRE_SPEECH_SAMPLES);
+                frame.event = AUDIO_FRAME_EVENT.VOICE_START;
+            } else if (this.active) {
+                this.speechBuffer.pushFrom(this.floats, n);
+                if (this.speechBuffer.count >= c.MAX_SPEECH_SAMPLES) {
+                    frame.segment = this.takeSegment(false);
+                }
+            }
+        } else {
+            this.silenceFrames++;
+            this.voiceFrames = 0;
+
+            if (this.active && this.silenceFrames >= c.SILENCE_FRAMES) {
+                this.active = false;
+                this.speechBuffer.pushLastOf(this.vadBuffer, c.POST_SPEECH_SAMPLES);
+                frame.event = AUDIO_FRAME_EVENT.VOICE_END;
+                if (this.speechBuffer.count >= c.MIN_SPEECH_SAMPLES) {
+                    frame.segment = this.takeSegment(true);
+                }
+                this.speechBuffer.reset();
+            }
+        }
+
+        frame.active = this.active;
+        frame.speechSamples = this.speechBuffer.count;
+        return frame;
+    }
+
+    /**
+     * Hand over the speech buffer as 16-bit PCM; a non-final segment keeps
+     * an overlap for continuity with the next one
+     */
+    takeSegment(final) {
+        const ring = this.speechBuffer;
+        const count = ring.count;
+        const pcm = new Int16Array(count);
+        let readIndex = (ring.writeIndex - count + ring.capacity) % ring.capacity;
+        for (let i = 0; i < count; i++) {
+            const v = ring.buffer[readIndex];
+            pcm[i] = v >= 1 ? 32767 : v <= -1 ? -32767 : v * 32767;
+            if (++readIndex === ring.capacity) readIndex = 0;
+        }
+
+        if (!final) {
+            ring.keepLast(Math.min(this.config.OVERLAP_SAMPLES, count * 0.15));
+        }
+        return { pcm, final };
+    }
+
+    /**
+     * Forget the voice state, e.g. once a response has been handled
+     */
+    resetVoice() {
+        this.active = false;
+        this.voiceFrames = 0;
+        this.silenceFrames = 0;
+        this.speechBuffer.reset();
+        this.frame.active = false;
+        this.frame.speechSamples = 0;
+    }
+
+    reset() {
+        this.vadBuffer.reset();
+        this.energyHistory.fill(0);
+        this.energyIndex = 0;
+        this.energyCount = 0;
+        this.energySum = 0;
+        this.resetVoice();
+    }
+}
+
+/**
+ * Worker side: one AudioFrontEnd fed by 'chunk' messages, one 'frame'
+ * message back per chunk; speech segments are transferred, not copied
+ */
+function audioFrontEndWorkerMain(port) {
+    let frontEnd = null;
+    port.addEventListener('message', (event) => {
+        const msg = event.data;
+        switch (msg.type) {
+            case 'init':
+                frontEnd = new AudioFrontEnd(msg.config);
+                break;
+            case 'chunk': {
+                const frame = frontEnd.process(msg.chunk);
+                port.postMessage({ type: 'frame', frame },
+                                 frame.segment ? [frame.segment.pcm.buffer] : []);
+                break;
+            }
+            case 'resetVoice':
+                frontEnd.resetVoice();
+                break;
+            case 'reset':
+                frontEnd.reset();
+                break;
+        }
+    });
+    if (port.start) {
+        port.start();
+    }
+}
+
+/**
+ * Source of a self-contained worker script; port is the expression for the
+ * worker's message port ('self' in browsers)
+ */
+function audioFrontEndWorkerSource(port = 'self') {
+    return [
+        `const AUDIO_FRONTEND_DEFAULTS = ${JSON.stringify(AUDIO_FRONTEND_DEFAULTS)};`,
+        `const AUDIO_FRAME_EVENT = ${JSON.stringify(AUDIO_FRAME_EVENT)};`,
+        RingBuffer.toString(),
+        AudioFrontEnd.toString(),
+        `(${audioFrontEndWorkerMain.toString()})(${port});`
+    ].join('\n');
+}
+
+class AudioFrontEndRunner {
+    /**
+     * @param {Function} onFrame - (frame) => void, once per processed chunk
+     * @param {Object} options - { config, useWorker (default true), worker (Worker-like, for tests) }
+     */
+    constructor(onFrame, options = {}) {
+        this.onFrame = onFrame;
+        this.config = options.config || {};
+        this.worker = null;
+        this.frontEnd = null;
+        this.mode = 'inline';
+        this.posted = 0;
+
+        if (options.worker || options.useWorker !== false) {
+            this.worker = options.worker || this.createWorker();
+        }
+        if (this.worker) {
+            this.mode = 'worker';
+            this.worker.addEventListener('message', (event) => {
+                if (event.data && event.data.type === 'frame') {
+                    this.onFrame(event.data.frame);
+                }
+            });
+            this.worker.postMessage({ type: 'init', config: this.config });
+        } else {
+            this.frontEnd = new AudioFrontEnd(this.config);
+        }
+    }
+
+    createWorker() {
+        if (typeof Worker === 'undefined' || typeof Blob === 'undefined' ||
+            typeof URL === 'undefined' || !URL.createObjectURL) {
+            return null;
+        }
+        try {
+            const url = URL.createObjectURL(new Blob([audioFrontEndWorkerSource()], { type: 'text/javascript' }));
+            const worker = new Worker(url);
+            URL.revokeObjectURL(url);
+            return worker;
+        } catch (error) {
+            // CSP without blob: workers, file:// pages
+            console.warn('[AUDIO FRONTEND] Worker unavailable, processing on the main thread:', error.message);
+            return null;
+        }
+    }
+
+    /**
+     * Process a base64 chunk; inline, onFrame runs before this returns and
+     * gets the front end's reused frame, valid until the next chunk
+     */
+    process(base64) {
+        this.posted++;
+        if (this.worker) {
+            this.worker.postMessage({ type: 'chunk', chunk: base64 });
+        } else if (this.frontEnd) {
+            this.onFrame(this.frontEnd.process(base64));
+        }
+    }
+
+    resetVoice() {
+        this.send('resetVoice');
+    }
+
+    reset() {
+        this.send('reset');
+    }
+
+    send(type) {
+        if (this.worker) {
+            this.worker.postMessage({ type });
+        } else if (this.frontEnd) {
+            this.frontEnd[type]();
+        }
+    }
+
+    /**
+     * Stop the worker; chunks processed afterwards are dropped
+     */
+    terminate() {
+        if (this.worker) {
+            this.worker.terminate();
+            this.worker = null;
+        }
+        this.frontEnd = null;
+    }
+}
+
+export { AudioFrontEnd, AudioFrontEndRunner, audioFrontEndWorkerSource };
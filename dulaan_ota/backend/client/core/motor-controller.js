@@ -3,22 +3,12 @@
  * Handles low-level hardware communication with the motor device
  */
 
-// BleClient and hexStringToDataView are expected to be available globally
-// via Capacitor plugins or browser environment
+import { parseScanResultStatus } from '../utils/adv-status.js';
+import { MotorWriteScheduler } from './motor-scheduler.js';
+import { MOTOR_DUTY, pwmToDuty } from '../utils/constants.js';
 
-// Helper function for hexStringToDataView if not available
-function hexStringToDataView(hexString) {
-    if (typeof window !== 'undefined' && window.hexStringToDataView) {
-        return window.hexStringToDataView(hexString);
-    }
-    
-    // Fallback implementation
-    const bytes = new Uint8Array(hexString.length / 2);
-    for (let i = 0; i < hexString.length; i += 2) {
-        bytes[i / 2] = parseInt(hexString.substr(i, 2), 16);
-    }
-    return new DataView(bytes.buffer);
-}
+// BleClient is expected to be available globally
+// via Capacitor plugins or browser environment
 
 // Helper function to get BleClient safely
 function getBleClient() {
@@ -33,7 +23,7 @@ class MotorController {
     constructor() {
         this.deviceAddress = null;
         this.isConnected = false;
-        this.currentPwm = 0; // Motor starts stopped
+        this.currentPwm = 0; // Last duty cycle written (0-10000), motor starts stopped
         this.isScanning = false;
         this.scanResults = [];
         this.onScanResult = null;
@@ -41,12 +31,13 @@ class MotorController {
         
         // Remote control integration
         this.remoteService = null;
-        this.remotePwm = 0; // PWM value when acting as remote
+        this.remotePwm = 0; // Duty cycle (0-10000) sent when acting as remote
         
         // BLE service and characteristic UUIDs (V3.0 Protocol)
         this.SERVICE_UUID = "9A501A2D-594F-4E2B-B123-5F739A2D594F";
         this.MOTOR_CONTROL_CHAR_UUID = "9A511A2D-594F-4E2B-B123-5F739A2D594F";
         this.DEVICE_INFO_CHAR_UUID = "9A521A2D-594F-4E2B-B123-5F739A2D594F";
+        this.SYNC_CHAR_UUID = "9A561A2D-594F-4E2B-B123-5F739A2D594F"; // Timed playback (core/sync-playback.js)
         
         // Keep backward compatibility
         this.CHARACTERISTIC_UUID = this.MOTOR_CONTROL_CHAR_UUID;
@@ -68,15 +59,29 @@ class MotorController {
         };
         this.onBatteryUpdate = null; // Callback for battery updates
         
+        // Connectionless status from the last scan (manufacturer data, see utils/adv-status.js)
+        this.advStatus = null;
+        
+        // Link info (0xB0 0x01): PHY and RSSI reported by the device
+        this.linkInfo = {
+            phy: null,            // '1M' | '2M' | 'Coded'
+            rssi: null,           // Last sample (dBm)
+            rssiAvg: null,        // Filtered value used for PHY selection (dBm)
+            longRange: false,     // Long range profile enabled in firmware
+            lastUpdated: null
+        };
+        this.onLinkUpdate = null; // Callback for link info updates
+        
         // Periodic battery query
         this.batteryQueryInterval = null;
         this.batteryQueryIntervalMs = 30000; // Default: 30 seconds
         
-        // Write queue management
-        this.writeQueue = [];
-        this.maxQueueLength = 10; // Handle 1 second of 100ms interval writes
-        this.isProcessingQueue = false;
-        this.lastWrittenPwm = null; // Track last written value to avoid duplicates
+        // All motor writes go through one scheduler: latest value wins,
+        // unchanged duty is skipped, at most one write per connection interval
+        this.writeScheduler = new MotorWriteScheduler((duty) => this.writeToLocalBLE(duty));
+        
+        // Motor packet buffer, reused by every write (one write in flight at a time)
+        this.motorPacket = new DataView(new ArrayBuffer(2));
     }
 
     /**
@@ -116,20 +121,16 @@ class MotorController {
     }
 
     /**
-     * Build 2-byte packet for Protocol V3.0
+     * Build 2-byte packet for Protocol V3.0 in the reused packet buffer
      * Format: duty_cycle (uint16 little-endian, 0-10000 = 0.00%-100.00%)
+     * Returns the shared DataView; it is only valid until the next call
      */
     buildPacket(dutyCycle) {
-        const packet = new Uint8Array(2);
-        
         // Ensure duty cycle is in valid range (0-10000)
-        const duty = Math.max(0, Math.min(10000, Math.round(dutyCycle)));
-        
-        // Bytes 0-1: duty_cycle (uint16 little-endian)
-        packet[0] = duty & 0xFF;           // Low byte
-        packet[1] = (duty >> 8) & 0xFF;    // High byte
+        const duty = Math.max(0, Math.min(MOTOR_DUTY.MAX, Math.round(dutyCycle)));
         
-        return packet;
+        this.motorPacket.setUint16(0, duty, true);
+        return this.motorPacket;
     }
 
     /**
@@ -216,6 +217,13 @@ class MotorController {
                 if (result.device.name === this.TARGET_DEVICE_NAME) {
                     console.log('✅ Found target device:', result.device.deviceId);
                     this.deviceAddress = result.device.deviceId;
+                    
+                    // Battery/firmware/state are available before connecting
+                    const advStatus = parseScanResultStatus(result);
+                    if (advStatus) {
+                        result.device.advStatus = advStatus;
+                        this.advStatus = advStatus;
+                    }
                     this.scanResults.push(result.device);
                     
                     // Stop scan immediately when target device is found
@@ -373,6 +381,7 @@ class MotorController {
             const disconnectCallback = (deviceId) => {
                 this.isConnected = false;
                 this.deviceAddress = null;
+                this.writeScheduler.reset();
                 console.log(`Motor device ${deviceId} disconnected`);
                 
                 if (this.onDisconnect) {
@@ -382,6 +391,7 @@ class MotorController {
             
             await BleClient.connect(this.deviceAddress, disconnectCallback);
             this.isConnected = true;
+            this.writeScheduler.reset(); // Motor state after connect is unknown, send the next value
             console.log('Connected to motor device:', this.deviceAddress);
             
             // Set up device info notifications (V3.0 protocol)
@@ -419,6 +429,7 @@ class MotorController {
             }
             this.isConnected = false;
             this.deviceAddress = null;
+            this.writeScheduler.reset();
             console.log('Disconnected from motor device');
         } catch (error) {
             console.error('Failed to disconnect:', error);
@@ -426,87 +437,46 @@ class MotorController {
     }
 
     /**
-     * Write PWM value to motor (0-255)
-     * Automatically routes to remote host if connected as remote user
-     * Uses queue to prevent BLE stack overload
+     * Write PWM value to motor (0-255, fractions kept)
      * Converts PWM (0-255) to duty cycle (0-10000) for V3.0 protocol
      */
     async write(pwmValue) {
-        // Validate PWM value (0-255) and convert to duty cycle (0-10000)
-        const pwm = Math.max(0, Math.min(255, Math.round(pwmValue)));
-        const dutyCycle = Math.round((pwm / 255) * 10000);
-        
-        // Check if we're connected as remote to another host
-        if (this.remoteService && this.remoteService.isRemote) {
-            return this.writeToRemoteHost(dutyCycle);
-        }
-        
-        // Skip if same as last written value (avoid duplicate writes)
-        if (dutyCycle === this.lastWrittenPwm) {
-            // console.log(`[MOTOR WRITE] ⏭️ Skipping - same as last value (${dutyCycle})`);
-            return true;
-        }
-        
-        // Add to queue
-        this.writeQueue.push(dutyCycle);
-        
-        // If queue full, remove oldest and keep latest
-        if (this.writeQueue.length > this.maxQueueLength) {
-            const removed = this.writeQueue.shift();
-            console.log(`[MOTOR WRITE] ⚠️ Queue full (${this.maxQueueLength}), dropped oldest value: ${removed}`);
-        }
-        
-        // Start processing queue if not already running
-        if (!this.isProcessingQueue) {
-            this.processWriteQueue();
-        }
-        
-        return true;
+        return this.writeDuty(pwmToDuty(pwmValue));
     }
 
     /**
-     * Process write queue sequentially
+     * Write duty cycle to motor (0-10000 = 0.00%-100.00%), full firmware resolution
+     * Automatically routes to remote host if connected as remote user
+     * Local writes go through the write scheduler and return immediately
      */
-    async processWriteQueue() {
-        if (this.isProcessingQueue) {
-            return; // Already processing
+    async writeDuty(dutyCycle) {
+        if (!Number.isFinite(dutyCycle)) {
+            console.warn('[MOTOR WRITE] ❌ Invalid duty cycle:', dutyCycle);
+            return false;
         }
+        const duty = Math.max(0, Math.min(MOTOR_DUTY.MAX, Math.round(dutyCycle)));
         
-        this.isProcessingQueue = true;
-        
-        while (this.writeQueue.length > 0) {
-            const pwm = this.writeQueue.shift();
-            
-            // Skip if same as last written (might have duplicates in queue)
-            if (pwm === this.lastWrittenPwm) {
-                continue;
-            }
-            
-            try {
-                const success = await this.writeToLocalBLE(pwm);
-                if (success) {
-                    this.lastWrittenPwm = pwm;
-                }
-            } catch (error) {
-                console.error('[MOTOR WRITE] Queue processing error:', error);
-            }
+        // Check if we're connected as remote to another host
+        if (this.remoteService && this.remoteService.isRemote) {
+            return this.writeToRemoteHost(duty);
         }
         
-        this.isProcessingQueue = false;
+        this.writeScheduler.submit(duty);
+        return true;
     }
 
     /**
-     * Write PWM value to remote host (when acting as remote)
+     * Write duty cycle to remote host (when acting as remote)
      */
-    async writeToRemoteHost(pwmValue) {
+    async writeToRemoteHost(dutyCycle) {
         try {
-            const success = this.remoteService.sendControlCommand('motor', pwmValue, {
+            const success = this.remoteService.sendControlCommand('duty', dutyCycle, {
                 timestamp: Date.now(),
                 source: 'motor_controller'
             });
             
             if (success) {
-                this.remotePwm = pwmValue;
+                this.remotePwm = dutyCycle;
                 return true;
             } else {
                 console.warn('[MOTOR WRITE] ❌ Failed to send remote PWM command');
@@ -519,9 +489,10 @@ class MotorController {
     }
 
     /**
-     * Write duty cycle to local BLE device
+     * Write duty cycle to local BLE device (called by the write scheduler)
      * Uses Protocol V3.0: 2-byte packet (duty cycle 0-10000)
-     * Uses writeWithoutResponse for fire-and-forget pattern
+     * Uses writeWithoutResponse; resolves once the BLE stack has taken the
+     * packet so the scheduler never has more than one write queued
      */
     async writeToLocalBLE(dutyCycle) {
         
@@ -539,21 +510,16 @@ class MotorController {
                 return true;
             }
             
-            // Build 2-byte packet (Protocol V3.0)
-            const packet = this.buildPacket(dutyCycle);
-            
-            // Convert to DataView for BLE write
-            const dataView = new DataView(packet.buffer);
+            // Build 2-byte packet (Protocol V3.0), encoded straight into the reused DataView
+            const dataView = this.buildPacket(dutyCycle);
             
-            // Use writeWithoutResponse for fire-and-forget (V3.0 protocol requirement)
-            BleClient.writeWithoutResponse(
+            // Use writeWithoutResponse (V3.0 protocol requirement)
+            await BleClient.writeWithoutResponse(
                 this.deviceAddress,
                 this.SERVICE_UUID,
                 this.CHARACTERISTIC_UUID,
                 dataView
-            ).catch(error => {
-                console.error('[MOTOR WRITE] ❌ Write failed:', error);
-            });
+            );
             
             this.currentPwm = dutyCycle;
             return true;
@@ -620,6 +586,68 @@ class MotorController {
         }
     }
 
+    /**
+     * Query link information (PHY, RSSI)
+     * Send 2-byte request [0xB0, 0x01], response arrives on the device info notification
+     */
+    async queryLinkInfo() {
+        if (!this.isConnected || !this.deviceAddress) {
+            console.warn('[LINK INFO] ❌ Motor not connected, cannot query link info');
+            return false;
+        }
+
+        try {
+            const BleClient = getBleClient();
+            if (!BleClient) {
+                console.warn('[LINK INFO] ⚠️ BleClient not available');
+                return false;
+            }
+
+            const packet = new Uint8Array([0xB0, 0x01]);
+            await BleClient.write(
+                this.deviceAddress,
+                this.SERVICE_UUID,
+                this.DEVICE_INFO_CHAR_UUID,
+                new DataView(packet.buffer)
+            );
+            return true;
+        } catch (error) {
+            console.error('[LINK INFO] ❌ Failed to query link info:', error);
+            return false;
+        }
+    }
+
+    /**
+     * Handle link info response
+     * 6 bytes: [0xB0, 0x01, phy, rssi (int8), rssi_avg (int8), flags]
+     */
+    handleLinkInfoNotification(bytes) {
+        const PHY_NAMES = { 1: '1M', 2: '2M', 3: 'Coded' };
+        const RSSI_INVALID = 127;
+        const toInt8 = (b) => (b > 127 ? b - 256 : b);
+
+        if (bytes.length !== 6) {
+            console.warn('[LINK INFO] ⚠️ Invalid response length:', bytes.length);
+            return;
+        }
+
+        const rssi = toInt8(bytes[3]);
+        const rssiAvg = toInt8(bytes[4]);
+        this.linkInfo = {
+            phy: PHY_NAMES[bytes[2]] || null,
+            rssi: rssi === RSSI_INVALID ? null : rssi,
+            rssiAvg: rssiAvg === RSSI_INVALID ? null : rssiAvg,
+            longRange: (bytes[5] & 0x01) !== 0,
+            lastUpdated: new Date().toISOString()
+        };
+
+        console.log('[LINK INFO] 📥 Received:', this.linkInfo);
+
+        if (this.onLinkUpdate) {
+            this.onLinkUpdate(this.linkInfo);
+        }
+    }
+
     /**
      * Fallback: Read device info directly if notifications don't work
      * Some devices may not support notifications properly
@@ -684,6 +712,12 @@ class MotorController {
             
             console.log('[DEVICE INFO] 📊 Parsed bytes:', Array.from(bytes));
             
+            // Link info response shares the characteristic
+            if (bytes.length >= 2 && bytes[0] === 0xB0 && bytes[1] === 0x01) {
+                this.handleLinkInfoNotification(bytes);
+                return;
+            }
+            
             // Expect 6 bytes
             if (bytes.length !== 6) {
                 console.warn('[DEVICE INFO] ⚠️ Invalid response length:', bytes.length);
@@ -805,6 +839,60 @@ class MotorController {
         }
     }
 
+    /**
+     * Write to the sync characteristic (core/sync-playback.js), bypassing the
+     * motor write scheduler: every PING and SCHEDULE must go out
+     * @param {Uint8Array} bytes
+     */
+    async writeSync(bytes) {
+        if (!this.isConnected || !this.deviceAddress) {
+            return false;
+        }
+
+        const BleClient = getBleClient();
+        if (!BleClient) {
+            return false;
+        }
+
+        await BleClient.writeWithoutResponse(
+            this.deviceAddress,
+            this.SERVICE_UUID,
+            this.SYNC_CHAR_UUID,
+            new DataView(bytes.buffer, bytes.byteOffset, bytes.byteLength)
+        );
+        return true;
+    }
+
+    /**
+     * Deliver sync characteristic notifications to handler (SyncPlayback.addController())
+     */
+    async startSyncNotifications(handler) {
+        if (!this.isConnected || !this.deviceAddress) {
+            console.warn('[SYNC] ❌ Motor not connected');
+            return false;
+        }
+
+        const BleClient = getBleClient();
+        if (!BleClient) {
+            console.warn('[SYNC] ⚠️ BleClient not available');
+            return false;
+        }
+
+        try {
+            await BleClient.startNotifications(
+                this.deviceAddress,
+                this.SERVICE_UUID,
+                this.SYNC_CHAR_UUID,
+                handler
+            );
+            return true;
+        } catch (error) {
+            // Firmware without the sync characteristic
+            console.warn('[SYNC] ⚠️ Sync notifications not available:', error.message);
+            return false;
+        }
+    }
+
     /**
      * Start periodic battery info queries
      * @param {number} intervalMs - Query interval in milliseconds (default: 30000 = 30 seconds)
@@ -856,7 +944,7 @@ class MotorController {
     }
 
     /**
-     * Get current PWM value (local or remote depending on mode)
+     * Get current duty cycle, 0-10000 (local or remote depending on mode)
      */
     getCurrentPwm() {
         if (this.remoteService && this.remoteService.isRemote) {
@@ -872,14 +960,6 @@ class MotorController {
         return this.isConnected;
     }
 
-    /**
-     * Convert decimal to hex string for BLE communication
-     */
-    decimalToHexString(decimal) {
-        const hex = decimal.toString(16).toUpperCase();
-        return hex.length === 1 ? '0' + hex : hex;
-    }
-
     /**
      * Get device address
      */
@@ -968,16 +1048,31 @@ class MotorController {
      * Get write queue status (for debugging)
      */
     getQueueStatus() {
+        const stats = this.writeScheduler.getStats();
         return {
-            queueLength: this.writeQueue.length,
-            maxQueueLength: this.maxQueueLength,
-            isProcessing: this.isProcessingQueue,
-            lastWrittenPwm: this.lastWrittenPwm,
+            queueLength: stats.pending === null ? 0 : 1,
+            isProcessing: stats.inFlight,
+            lastWrittenPwm: stats.lastSent,
             currentPwm: this.currentPwm,
             protocol: 'V3.0'
         };
     }
 
+    /**
+     * Get write scheduler stats: counters (submitted, sent, superseded,
+     * suppressed, failed), writesPerSecond, staleness and writeLatency (ms)
+     */
+    getWriteStats() {
+        return this.writeScheduler.getStats();
+    }
+
+    /**
+     * Pace motor writes to the connection interval in use (default 15 ms)
+     */
+    setWriteInterval(intervalMs) {
+        this.writeScheduler.setIntervalMs(intervalMs);
+    }
+
     /**
      * Get device information (battery, firmware, motor count)
      */
@@ -1013,6 +1108,21 @@ class MotorController {
         this.onBatteryUpdate = callback;
     }
 
+    /**
+     * Get link info (PHY, RSSI) from the last 0xB0 0x01 query
+     */
+    getLinkInfo() {
+        return { ...this.linkInfo };
+    }
+
+    /**
+     * Get connectionless status decoded from the last scan result
+     * { batteryLevel, firmwareVersion, activeBank, motorOn, otaActive, batteryLow, flags } or null
+     */
+    getAdvStatus() {
+        return this.advStatus ? { ...this.advStatus } : null;
+    }
+
     /**
      * Check if device info is ready (has been received at least once)
      */
@@ -0,0 +1,209 @@
+/**
+ * Motor Write Scheduler - Single owner of the motor control characteristic
+ *
+ * Control modes write from their own timers (ambient 100 ms, touch, pattern
+ * playback, AI voice) and can overlap. Sending every call would queue
+ * stale values in the OS BLE stack and delay the one the user just set.
+ * The scheduler instead:
+ * - keeps only the latest requested duty, superseded values are dropped
+ * - skips a duty equal to the one already on the device
+ * - sends at most one write per connection interval, and only after the
+ *   previous write has been accepted by the BLE stack
+ *
+ * Staleness is the time a duty waited in the scheduler before being sent.
+ * It is bounded by one connection interval plus one in-flight write.
+ */
+
+export const WRITE_SCHEDULER_DEFAULTS = {
+    INTERVAL_MS: 15,        // Firmware requests 7.5-15 ms (VM_CONN_INTERVAL_MIN/MAX)
+    MIN_INTERVAL_MS: 7.5,   // BLE minimum connection interval
+    RATE_WINDOW_MS: 5000,   // Window for writesPerSecond
+    SAMPLE_COUNT: 64        // Latency samples kept for the stats
+};
+
+function schedulerNow() {
+    if (typeof performance !== 'undefined' && performance.now) {
+        return performance.now();
+    }
+    return Date.now();
+}
+
+class MotorWriteScheduler {
+    /**
+     * @param {Function} send - async (dutyCycle) => boolean, true when the write was accepted
+     * @param {Object} options - { intervalMs }
+     */
+    constructor(send, options = {}) {
+        this.send = send;
+        this.intervalMs = Math.max(WRITE_SCHEDULER_DEFAULTS.MIN_INTERVAL_MS,
+                                   options.intervalMs || WRITE_SCHEDULER_DEFAULTS.INTERVAL_MS);
+
+        this.pending = null;        // { duty, at } latest value not sent yet
+        this.lastSent = null;       // Duty on the device, null = unknown
+        this.lastSendAt = -Infinity;
+        this.inFlight = false;
+        this.timer = null;
+
+        this.resetStats();
+    }
+
+    /**
+     * Request a duty cycle (0-10000); returns immediately
+     */
+    submit(dutyCycle) {
+        this.stats.submitted++;
+
+        if (this.pending) {
+            this.stats.superseded++;
+            this.pending = null;
+        }
+
+        if (dutyCycle === this.lastSent && !this.inFlight) {
+            this.stats.suppressed++;
+            return;
+        }
+
+        this.pending = { duty: dutyCycle, at: schedulerNow() };
+        this.schedule();
+    }
+
+    /**
+     * Arm the next send: now if an interval has passed since the last one,
+     * otherwise at the next interval boundary
+     */
+    schedule() {
+        if (this.timer || this.inFlight || !this.pending) {
+            return;
+        }
+
+        const wait = this.lastSendAt + this.intervalMs - schedulerNow();
+        if (wait <= 0) {
+            this.flush();
+            return;
+        }
+        this.timer = setTimeout(() => {
+            this.timer = null;
+            this.flush();
+        }, wait);
+    }
+
+    async flush() {
+        const item = this.pending;
+        if (!item || this.inFlight) {
+            return;
+        }
+        this.pending = null;
+
+        // Another producer may have asked for the value already on the device
+        // while the previous write was in flight
+        if (item.duty === this.lastSent) {
+            this.stats.suppressed++;
+            return;
+        }
+
+        const sentAt = schedulerNow();
+        this.inFlight = true;
+        this.lastSendAt = sentAt;
+        this.addSample(this.staleness, sentAt - item.at);
+
+        let ok = false;
+        try {
+            ok = await this.send(item.duty);
+        } catch (error) {
+            console.error('[MOTOR SCHEDULER] ❌ Send failed:', error);
+        }
+
+        const doneAt = schedulerNow();
+        this.inFlight = false;
+        if (ok) {
+            this.lastSent = item.duty;
+            this.stats.sent++;
+            this.sendTimes.push(sentAt);
+            this.trimSendTimes(doneAt);
+            this.addSample(this.writeLatency, doneAt - sentAt);
+        } else {
+            // Not retried: the next submit sends again since lastSent is unchanged
+            this.stats.failed++;
+        }
+
+        this.schedule();
+    }
+
+    /**
+     * Forget the device state (connect / disconnect) and drop the pending value
+     */
+    reset() {
+        if (this.timer) {
+            clearTimeout(this.timer);
+            this.timer = null;
+        }
+        this.pending = null;
+        this.lastSent = null;
+    }
+
+    /**
+     * Set the pacing interval, normally the connection interval in use
+     */
+    setIntervalMs(intervalMs) {
+        this.intervalMs = Math.max(WRITE_SCHEDULER_DEFAULTS.MIN_INTERVAL_MS, intervalMs);
+    }
+
+    resetStats() {
+        this.stats = { submitted: 0, sent: 0, superseded: 0, suppressed: 0, failed: 0 };
+        this.staleness = [];
+        this.writeLatency = [];
+        this.sendTimes = [];
+        this.statsSince = schedulerNow();
+    }
+
+    addSample(samples, value) {
+        samples.push(value);
+        if (samples.length > WRITE_SCHEDULER_DEFAULTS.SAMPLE_COUNT) {
+            samples.shift();
+        }
+    }
+
+    // Send times older than RATE_WINDOW_MS no longer count toward writesPerSecond
+    trimSendTimes(now) {
+        const windowStart = now - WRITE_SCHEDULER_DEFAULTS.RATE_WINDOW_MS;
+        while (this.sendTimes.length && this.sendTimes[0] < windowStart) {
+            this.sendTimes.shift();
+        }
+    }
+
+    summarize(samples) {
+        if (samples.length === 0) {
+            return { avg: 0, max: 0 };
+        }
+        let sum = 0;
+        let max = 0;
+        for (const v of samples) {
+            sum += v;
+            if (v > max) max = v;
+        }
+        return { avg: sum / samples.length, max };
+    }
+
+    /**
+     * Counters since resetStats(), write rate over the last RATE_WINDOW_MS,
+     * staleness and write latency (ms) over the last SAMPLE_COUNT writes
+     */
+    getStats() {
+        const now = schedulerNow();
+        this.trimSendTimes(now);
+        const windowMs = Math.min(WRITE_SCHEDULER_DEFAULTS.RATE_WINDOW_MS, now - this.statsSince);
+
+        return {
+            ...this.stats,
+            writesPerSecond: windowMs > 0 ? this.sendTimes.length * 1000 / windowMs : 0,
+            staleness: this.summarize(this.staleness),
+            writeLatency: this.summarize(this.writeLatency),
+            pending: this.pending ? this.pending.duty : null,
+            inFlight: this.inFlight,
+            lastSent: this.lastSent,
+            intervalMs: this.intervalMs
+        };
+    }
+}
+
+export { MotorWriteScheduler };
@@ -364,6 +364,11 @@ class OTAController {
                 // Device will disconnect and reboot
                 break;
 
+            case 0x05: // VERIFYING (commit after FINISH, CRC pass progress)
+                console.log(getTimestamp() + ` OTA: Verifying ${statusData}%`);
+                this.updateStatus(`Verifying... ${statusData}%`);
+                break;
+
             case 0x04: // ACK (flow control - not supported by SDK, kept for future)
                 // ACK format: [0x04][seq_low][seq_high]
                 if (data.length >= 3) {
@@ -372,6 +377,10 @@ class OTAController {
                 }
                 break;
 
+            case 0x06: // NONE (chunk out of order before any was written)
+                console.log(getTimestamp() + ' OTA: Device has not written a chunk yet');
+                break;
+
             case 0xFF: // ERROR
                 const errorCode = statusData;
                 const errorMsg = this.getErrorMessage(errorCode);
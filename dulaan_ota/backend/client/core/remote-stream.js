@@ -0,0 +1,353 @@
+/**
+ * Remote Stream - Batched motor samples and a host-side jitter buffer
+ *
+ * A remote user's control mode produces a duty sample every few tens of
+ * milliseconds. Sending each one as its own message and applying it on
+ * arrival turns network jitter directly into vibration jitter, and a
+ * reordered message rolls the motor back to an older value.
+ *
+ * The remote batches samples (RemoteSampleSender). Every sample keeps its
+ * sequence number and the sender time it was produced at:
+ *
+ *   { type: 'control_batch', mode, seq, sentAt, age: [ms], v: [values] }
+ *
+ * seq is the sequence number of the first sample, the others follow
+ * consecutively; age[i] is sentAt minus the time sample i was produced.
+ *
+ * The host plays samples out at a fixed offset from their production time
+ * (JitterBuffer). The offset is the fastest transit seen recently (it also
+ * absorbs the clock offset between the peers) plus a playout delay that
+ * tracks the measured jitter: it grows at once when packets get late and
+ * shrinks slowly once the link is calm again. Duplicates and samples older
+ * than the one already applied are dropped.
+ */
+
+export const REMOTE_STREAM_DEFAULTS = {
+    BATCH_MS: 30,           // Longest a sample waits on the remote before sending
+    MAX_BATCH: 8,           // Samples per packet
+    MIN_DELAY_MS: 10,       // Playout delay bounds on top of the fastest transit
+    MAX_DELAY_MS: 400,
+    JITTER_FACTOR: 3,       // Playout delay covers this many mean deviations
+    DELAY_DECAY: 1 / 32,    // Share of the gap closed per packet when shrinking
+    BASE_WINDOW: 128,       // Packets over which the fastest transit is taken
+    SAMPLE_COUNT: 128       // Latency samples kept for the stats
+};
+
+export function streamNow() {
+    if (typeof performance !== 'undefined' && performance.now) {
+        return performance.now();
+    }
+    return Date.now();
+}
+
+function percentile(sorted, p) {
+    if (sorted.length === 0) return 0;
+    return sorted[Math.min(sorted.length - 1, Math.floor(sorted.length * p))];
+}
+
+/**
+ * Remote side: collects samples and sends them in batches
+ */
+export class RemoteSampleSender {
+    /**
+     * @param {Function} send - (packet) => boolean, true when the channel took it
+     * @param {Object} options - { batchMs, maxBatch }
+     */
+    constructor(send, options = {}) {
+        this.send = send;
+        this.batchMs = options.batchMs ?? REMOTE_STREAM_DEFAULTS.BATCH_MS;
+        this.maxBatch = options.maxBatch || REMOTE_STREAM_DEFAULTS.MAX_BATCH;
+
+        this.nextSeq = 1;
+        this.mode = null;
+        this.times = [];
+        this.values = [];
+        this.timer = null;
+        this.stats = { samples: 0, packets: 0, failed: 0 };
+    }
+
+    /**
+     * Queue one sample; returns immediately
+     */
+    push(mode, value) {
+        if (this.mode !== null && mode !== this.mode) {
+            this.flush();
+        }
+        this.mode = mode;
+        this.times.push(streamNow());
+        this.values.push(value);
+        this.stats.samples++;
+
+        if (this.values.length >= this.maxBatch || this.batchMs <= 0) {
+            this.flush();
+        } else if (!this.timer) {
+            this.timer = setTimeout(() => {
+                this.timer = null;
+                this.flush();
+            }, this.batchMs);
+        }
+    }
+
+    /**
+     * Send the queued samples now
+     */
+    flush() {
+        if (this.timer) {
+            clearTimeout(this.timer);
+            this.timer = null;
+        }
+        const count = this.values.length;
+        if (count === 0) return;
+
+        const sentAt = streamNow();
+        const age = new Array(count);
+        for (let i = 0; i < count; i++) {
+            age[i] = Math.round((sentAt - this.times[i]) * 10) / 10;
+        }
+        const packet = {
+            type: 'control_batch',
+            mode: this.mode,
+            seq: this.nextSeq,
+            sentAt: sentAt,
+            age: age,
+            v: this.values
+        };
+
+        // Sequence numbers advance even when the send fails: the host counts
+        // the gap as lost instead of waiting for it
+        this.nextSeq += count;
+        this.times = [];
+        this.values = [];
+        this.mode = null;
+
+        let ok = false;
+        try {
+            ok = this.send(packet) !== false;
+        } catch (error) {
+            console.error('[REMOTE STREAM] ❌ Send failed:', error);
+        }
+        if (ok) {
+            this.stats.packets++;
+        } else {
+            this.stats.failed++;
+        }
+    }
+
+    /**
+     * Drop queued samples (disconnect)
+     */
+    stop() {
+        if (this.timer) {
+            clearTimeout(this.timer);
+            this.timer = null;
+        }
+        this.times = [];
+        this.values = [];
+        this.mode = null;
+    }
+
+    getStats() {
+        return { ...this.stats, queued: this.values.length, nextSeq: this.nextSeq };
+    }
+}
+
+/**
+ * Host side: reorders samples and plays them out at a steady delay
+ */
+export class JitterBuffer {
+    /**
+     * @param {Function} apply - (sample) => void, sample is
+     *        { seq, mode, value, producedAt (sender clock), playedAt, late }
+     * @param {Object} options - { minDelayMs, maxDelayMs, jitterFactor }
+     */
+    constructor(apply, options = {}) {
+        this.apply = apply;
+        this.minDelayMs = options.minDelayMs ?? REMOTE_STREAM_DEFAULTS.MIN_DELAY_MS;
+        this.maxDelayMs = options.maxDelayMs ?? REMOTE_STREAM_DEFAULTS.MAX_DELAY_MS;
+        this.jitterFactor = options.jitterFactor ?? REMOTE_STREAM_DEFAULTS.JITTER_FACTOR;
+        this.reset();
+    }
+
+    reset() {
+        if (this.timer) {
+            clearTimeout(this.timer);
+        }
+        this.timer = null;
+        this.timerAt = Infinity;
+
+        this.queue = [];            // Samples waiting for playout, ascending seq
+        this.lastSeq = 0;           // Highest sequence number played or skipped
+        this.transits = [];         // Recent packet transits (arrival - sentAt)
+        this.baseTransit = null;    // Fastest recent transit
+        this.lastTransit = null;
+        this.jitter = 0;            // Mean transit deviation (RFC 3550 style)
+        this.holdMs = 0;            // Longest wait of a sample on the remote
+        this.delayMs = this.minDelayMs;
+
+        this.stats = {
+            packets: 0, samples: 0, played: 0, superseded: 0,
+            late: 0, stale: 0, duplicates: 0, lost: 0, reordered: 0
+        };
+        this.latency = [];          // Production to playout, above the fastest transit
+        this.highestSeq = 0;
+    }
+
+    /**
+     * Take one control_batch packet
+     */
+    receive(packet, arrivedAt = streamNow()) {
+        const count = packet.v ? packet.v.length : 0;
+        if (count === 0) return;
+        this.stats.packets++;
+
+        this.measure(packet, arrivedAt);
+        if (packet.seq < this.highestSeq) {
+            this.stats.reordered++;
+        }
+
+        for (let i = 0; i < count; i++) {
+            const seq = packet.seq + i;
+            this.stats.samples++;
+            if (seq <= this.lastSeq) {
+                this.stats.stale++;
+                continue;
+            }
+            const producedAt = packet.sentAt - (packet.age[i] || 0);
+            const playAt = producedAt + this.baseTransit + this.delayMs;
+            if (!this.insert({ seq, mode: packet.mode, value: packet.v[i], producedAt, playAt })) {
+                this.stats.duplicates++;
+            } else if (playAt < arrivedAt) {
+                this.stats.late++;
+            }
+            if (seq > this.highestSeq) this.highestSeq = seq;
+        }
+
+        this.schedule(arrivedAt);
+    }
+
+    /**
+     * Update the fastest transit, the jitter estimate and the playout delay
+     */
+    measure(packet, arrivedAt) {
+        const transit = arrivedAt - packet.sentAt;
+
+        this.transits.push(transit);
+        if (this.transits.length > REMOTE_STREAM_DEFAULTS.BASE_WINDOW) {
+            this.transits.shift();
+        }
+        if (this.baseTransit === null || transit < this.baseTransit) {
+            this.baseTransit = transit;
+        } else if (this.stats.packets % REMOTE_STREAM_DEFAULTS.BASE_WINDOW === 0) {
+            // Let the base follow clock drift and route changes
+            this.baseTransit = Math.min(...this.transits);
+        }
+
+        if (this.lastTransit !== null) {
+            const d = Math.abs(transit - this.lastTransit);
+            this.jitter += (d - this.jitter) / 16;
+        }
+        this.lastTransit = transit;
+
+        const hold = packet.age[0] || 0;
+        this.holdMs = Math.max(hold, this.holdMs * (1 - REMOTE_STREAM_DEFAULTS.DELAY_DECAY));
+
+        // Cover batching on the remote, the transit deviation, and this
+        // packet if it came later than the current delay allows
+        const excess = transit - this.baseTransit;
+        let target = this.holdMs + Math.max(this.jitterFactor * this.jitter, excess);
+        target = Math.max(this.minDelayMs, Math.min(this.maxDelayMs, target));
+        if (target > this.delayMs) {
+            this.delayMs = target;
+        } else {
+            this.delayMs += (target - this.delayMs) * REMOTE_STREAM_DEFAULTS.DELAY_DECAY;
+        }
+    }
+
+    insert(sample) {
+        const queue = this.queue;
+        let i = queue.length;
+        while (i > 0 && queue[i - 1].seq > sample.seq) i--;
+        if (i > 0 && queue[i - 1].seq === sample.seq) {
+            return false;
+        }
+        queue.splice(i, 0, sample);
+        return true;
+    }
+
+    schedule(now = streamNow()) {
+        if (this.queue.length === 0) return;
+        const at = this.queue[0].playAt;
+        if (at <= now) {
+            this.playDue(now);
+            return;
+        }
+        if (this.timer && this.timerAt <= at) return;
+        if (this.timer) clearTimeout(this.timer);
+        this.timerAt = at;
+        this.timer = setTimeout(() => {
+            this.timer = null;
+            this.timerAt = Infinity;
+            this.playDue(streamNow());
+        }, at - now);
+    }
+
+    /**
+     * Apply the newest sample that is due; older due samples are superseded
+     */
+    playDue(now) {
+        let due = 0;
+        while (due < this.queue.length && this.queue[due].playAt <= now) due++;
+        if (due > 0) {
+            const played = this.queue.splice(0, due);
+            const sample = played[due - 1];
+            const first = played[0].seq;
+
+            this.stats.lost += first - this.lastSeq - 1;
+            for (let i = 1; i < due; i++) {
+                this.stats.lost += played[i].seq - played[i - 1].seq - 1;
+            }
+            this.stats.superseded += due - 1;
+            this.stats.played++;
+            this.lastSeq = sample.seq;
+
+            sample.playedAt = now;
+            sample.late = now - sample.playAt;
+            this.latency.push(now - sample.producedAt - this.baseTransit);
+            if (this.latency.length > REMOTE_STREAM_DEFAULTS.SAMPLE_COUNT) {
+                this.latency.shift();
+            }
+            try {
+                this.apply(sample);
+            } catch (error) {
+                console.error('[REMOTE STREAM] ❌ Apply failed:', error);
+            }
+        }
+        this.schedule(now);
+    }
+
+    stop() {
+        this.reset();
+    }
+
+    /**
+     * Counters, the current playout delay and jitter (ms), and the latency
+     * from production to playout over the last SAMPLE_COUNT samples, measured
+     * above the fastest transit (the one-way delay itself is not observable
+     * without synchronized clocks)
+     */
+    getStats() {
+        const sorted = [...this.latency].sort((a, b) => a - b);
+        return {
+            ...this.stats,
+            queued: this.queue.length,
+            delayMs: this.delayMs,
+            jitterMs: this.jitter,
+            baseTransitMs: this.baseTransit,
+            latency: {
+                p50: percentile(sorted, 0.5),
+                p95: percentile(sorted, 0.95),
+                max: sorted.length ? sorted[sorted.length - 1] : 0
+            }
+        };
+    }
+}
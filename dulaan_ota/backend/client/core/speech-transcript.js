@@ -0,0 +1,131 @@
+/**
+ * On-device Transcript - platform speech recognition next to the recorder
+ *
+ * Runs the Web Speech API recognizer while AI voice mode listens and hands
+ * the text it finalized during a speech segment to the request as
+ * `transcript`. directAudioToPWM keys its decision cache on that text, so
+ * a repeated command is answered without the model round-trip. Where no
+ * recognizer exists (most Android WebViews) requests carry no transcript
+ * and always reach the model.
+ */
+
+export const TRANSCRIPT_DEFAULTS = {
+    lang: 'en-US',
+    waitMs: 300         // Longest wait for the recognizer after a segment ends
+};
+
+export class OnDeviceTranscriber {
+    constructor(options = {}) {
+        const global = typeof window !== 'undefined' ? window : {};
+        this.Recognition = options.Recognition !== undefined ? options.Recognition
+            : (global.SpeechRecognition || global.webkitSpeechRecognition || null);
+        this.lang = options.lang || TRANSCRIPT_DEFAULTS.lang;
+        this.waitMs = options.waitMs !== undefined ? options.waitMs : TRANSCRIPT_DEFAULTS.waitMs;
+        this.now = options.now || Date.now;
+
+        this.recognizer = null;
+        this.active = false;
+        this.results = [];      // { text, at } finalized and not taken yet
+        this.waiters = [];
+    }
+
+    get available() {
+        return !!this.Recognition;
+    }
+
+    /**
+     * Start recognizing; false where the platform has no recognizer
+     */
+    start() {
+        if (!this.Recognition || this.active) {
+            return this.active;
+        }
+
+        const recognizer = new this.Recognition();
+        recognizer.continuous = true;
+        recognizer.interimResults = false;
+        recognizer.lang = this.lang;
+        recognizer.onresult = (event) => {
+            for (let i = event.resultIndex; i < event.results.length; i++) {
+                if (event.results[i].isFinal) {
+                    this.results.push({ text: event.results[i][0].transcript, at: this.now() });
+                }
+            }
+            this.wake();
+        };
+        // Recognizers end on their own after a silence; keep one running while active
+        recognizer.onend = () => {
+            if (this.active && this.recognizer === recognizer) {
+                try {
+                    recognizer.start();
+                } catch (error) {
+                    this.active = false;
+                }
+            }
+        };
+        recognizer.onerror = (event) => {
+            if (event.error === 'not-allowed' || event.error === 'service-not-allowed') {
+                console.warn('[Transcript] Speech recognition not allowed, requests go without a transcript');
+                this.active = false;
+            }
+        };
+
+        this.recognizer = recognizer;
+        this.active = true;
+        try {
+            recognizer.start();
+        } catch (error) {
+            console.warn('[Transcript] Speech recognition failed to start:', error.message);
+            this.active = false;
+            this.recognizer = null;
+        }
+        return this.active;
+    }
+
+    stop() {
+        const recognizer = this.recognizer;
+        this.active = false;
+        this.recognizer = null;
+        this.results = [];
+        this.wake();
+        if (recognizer) {
+            try {
+                recognizer.stop();
+            } catch (error) {
+                // Already stopped
+            }
+        }
+    }
+
+    /**
+     * Text finalized since the segment started (sinceMs, same clock as now),
+     * waiting up to waitMs for the recognizer to catch up with the end of
+     * the segment. Older results are dropped so they are never sent with
+     * later audio.
+     * @returns {Promise<string|null>}
+     */
+    async take(sinceMs) {
+        if (!this.active) {
+            return null;
+        }
+        this.results = this.results.filter((r) => r.at >= sinceMs);
+        if (!this.results.length && this.waitMs > 0) {
+            await new Promise((resolve) => {
+                const timer = setTimeout(resolve, this.waitMs);
+                this.waiters.push(() => {
+                    clearTimeout(timer);
+                    resolve();
+                });
+            });
+        }
+        const text = this.results.map((r) => r.text).join(' ').trim();
+        this.results = [];
+        return text || null;
+    }
+
+    wake() {
+        const waiters = this.waiters;
+        this.waiters = [];
+        waiters.forEach((resolve) => resolve());
+    }
+}
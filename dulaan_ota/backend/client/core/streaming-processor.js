@@ -1,126 +1,79 @@
 /**
  * Streaming Audio Processor
  * Voice Activity Detection and audio processing for Capacitor audio chunks
+ * Feature extraction and buffering run in the audio front end (audio-frontend.js);
+ * this class turns its frames into voice state and API calls
  * Based on working test-real-api.html implementation
  */
 
-import { RingBuffer } from '../utils/audio-utils.js';
+import { AudioFrontEndRunner, AUDIO_FRAME_EVENT, AUDIO_FRONTEND_DEFAULTS } from './audio-frontend.js';
 
 class StreamingProcessor {
-    constructor() {
-        // Get RingBuffer class - use global if available (for bundled version)
-        const RingBufferClass = (typeof RingBuffer !== 'undefined') ? RingBuffer :
-                                (typeof window !== 'undefined' && window.DULAAN_COMPONENTS && window.DULAAN_COMPONENTS.RingBuffer) ? window.DULAAN_COMPONENTS.RingBuffer :
-                                null;
-        
-        if (!RingBufferClass) {
-            throw new Error('RingBuffer class not available. Make sure audio-utils.js is loaded.');
-        }
-
+    /**
+     * @param {Object} options - AudioFrontEndRunner options, e.g. { useWorker: false }
+     */
+    constructor(options = {}) {
         // Audio state
         this.isActive = false;
         this.isListening = false;
         this.isProcessing = false;
         this.currentPwm = 0;
         
-        // Ring buffers for efficient memory usage
-        this.vadBuffer = new RingBufferClass(4800); // 300ms for VAD analysis
-        this.speechBuffer = new RingBufferClass(16000 * 30); // 30 seconds max speech
-        
-        // VAD state
-        this.consecutiveVoiceFrames = 0;
-        this.consecutiveSilenceFrames = 0;
+        // VAD state, as reported by the last feature frame
         this.isVoiceActive = false;
         this.voiceStartTime = 0;
+        this.speechBufferSize = 0;
         
         // Efficiency tracking
         this.totalChunks = 0;
         this.apiCalls = 0;
         this.lastRMS = 0;
         this.lastZeroCrossings = 0;
+        this.lastPeak = 0;
         this.lastApiCall = 0; // Initialize to 0 to allow first API call
         
-        // VAD thresholds (from working implementation)
-        this.VAD_ENERGY_THRESHOLD = 0.008; // Balanced threshold
-        this.VAD_ZCR_THRESHOLD = 0.08; // Balanced ZCR threshold
-        this.VAD_VOICE_FRAMES = 3; // 3 consecutive frames to confirm voice
-        this.VAD_SILENCE_FRAMES = 20; // 20 frames of silence to end speech
-        this.MIN_SPEECH_DURATION = 500; // 500ms minimum (in samples)
-        this.MAX_SPEECH_DURATION = 320000; // 20 seconds maximum
+        this.sampleRate = AUDIO_FRONTEND_DEFAULTS.SAMPLE_RATE;
+        this.postSpeechSamples = AUDIO_FRONTEND_DEFAULTS.POST_SPEECH_SAMPLES;
         
-        // Energy history for adaptive thresholds
-        this.energyHistory = [];
+        // Decoding, VAD and speech buffering run in the audio front end
+        // (a Worker when available); it reports one feature frame per chunk
+        this.frontEnd = new AudioFrontEndRunner((frame) => this.handleFrame(frame), options);
+        
+        // Result of processAudioChunk(), updated in place
+        this.chunkResult = {
+            isVoiceActive: false,
+            energy: 0,
+            zeroCrossings: 0,
+            peak: 0,
+            speechBufferSize: 0,
+            efficiency: { totalChunks: 0, apiCalls: 0, apiCallRatio: 0 }
+        };
         
         // Callbacks
         this.onSpeechReady = null;
         this.onVoiceStateChange = null;
         this.onConversationUpdate = null;
-
-        this.lastApiCall = 0; // Initialize to 0 to allow first API call
-
     }
 
     /**
      * Process audio chunk from Capacitor (base64 format)
+     * With the worker front end the result reflects the last frame received,
+     * which may be one chunk behind
      */
     processAudioChunk(base64Chunk) {
         try {
-            const pcmData = this.base64ToFloat32Array(base64Chunk);
-            
-            if (pcmData.length === 0) {
-                console.warn(`[PROCESSOR] Empty PCM data from base64 chunk`);
-                return null;
-            }
-
-            this.totalChunks++;
-
-            // Always buffer audio for pre/post-speech context
-            this.vadBuffer.push(pcmData);
-            
-            // Voice Activity Detection
-            const isVoiceActive = this.detectVoiceActivity(pcmData);
-            
-            // Voice activity state machine
-            if (isVoiceActive) {
-                this.consecutiveVoiceFrames++;
-                this.consecutiveSilenceFrames = 0;
-                
-                // Voice start detection
-                if (!this.isVoiceActive && this.consecutiveVoiceFrames >= this.VAD_VOICE_FRAMES) {
-                    console.log(`[VAD] 🎤 Voice START detected (${this.consecutiveVoiceFrames} consecutive frames)`);
-                    this.handleVoiceStart();
-                }
-                
-                // Buffer speech audio during active speech
-                if (this.isVoiceActive) {
-                    this.speechBuffer.push(pcmData);
-                    this.checkSpeechBufferLimits();
-                }
-                
-            } else {
-                this.consecutiveSilenceFrames++;
-                this.consecutiveVoiceFrames = 0;
-                
-                // Voice end detection
-                if (this.isVoiceActive && this.consecutiveSilenceFrames >= this.VAD_SILENCE_FRAMES) {
-                    this.isVoiceActive = false;
-                    this.isListening = false;
-                    console.log(`[VAD] 🔇 Voice END detected (${this.consecutiveSilenceFrames} consecutive silence frames)`);
-                    this.handleVoiceEnd();
-                }
-            }
-
-            return {
-                isVoiceActive: this.isVoiceActive,
-                energy: this.lastRMS,
-                zeroCrossings: this.lastZeroCrossings,
-                speechBufferSize: this.speechBuffer.count,
-                efficiency: {
-                    totalChunks: this.totalChunks,
-                    apiCalls: this.apiCalls,
-                    apiCallRatio: this.apiCalls / this.totalChunks
-                }
-            };
+            this.frontEnd.process(base64Chunk);
+
+            const result = this.chunkResult;
+            result.isVoiceActive = this.isVoiceActive;
+            result.energy = this.lastRMS;
+            result.zeroCrossings = this.lastZeroCrossings;
+            result.peak = this.lastPeak;
+            result.speechBufferSize = this.speechBufferSize;
+            result.efficiency.totalChunks = this.totalChunks;
+            result.efficiency.apiCalls = this.apiCalls;
+            result.efficiency.apiCallRatio = this.totalChunks > 0 ? this.apiCalls / this.totalChunks : 0;
+            return result;
 
         } catch (error) {
             console.error("Audio processing failed:", error);
@@ -129,84 +82,45 @@ class StreamingProcessor {
     }
 
     /**
-     * Voice Activity Detection (from working implementation)
+     * Feature frame from the audio front end
      */
-    detectVoiceActivity(audioData) {
-        // Calculate RMS energy
-        const rms = this.calculateRMS(audioData);
-        this.lastRMS = rms;
-        
-        // Calculate zero crossing rate
-        const zcr = this.calculateZeroCrossingRate(audioData);
-        this.lastZeroCrossings = zcr;
-        
-        // Advanced VAD decision with adaptive thresholds
-        const energyActive = rms > this.VAD_ENERGY_THRESHOLD;
-        const zcrActive = zcr > this.VAD_ZCR_THRESHOLD && zcr < 0.5; // ZCR too high = noise
-        
-        // Adaptive threshold based on recent energy history
-        this.energyHistory.push(rms);
-        if (this.energyHistory.length > 100) this.energyHistory.shift();
-        
-        const avgEnergy = this.energyHistory.reduce((a, b) => a + b, 0) / this.energyHistory.length;
-        const adaptiveThreshold = Math.max(this.VAD_ENERGY_THRESHOLD, avgEnergy * 2);
-        const adaptiveEnergyActive = rms > adaptiveThreshold;
-        
-        // Combined decision: energy must be active, ZCR should be reasonable
-        const voiceDetected = energyActive && (zcrActive || rms > adaptiveThreshold * 1.5);
-        
-        // Debug logging (every 50 chunks to avoid spam)
-        if (this.totalChunks % 50 === 0) {
-            console.log(`[VAD] RMS: ${rms.toFixed(4)} (>${this.VAD_ENERGY_THRESHOLD}=${energyActive}, adaptive>${adaptiveThreshold.toFixed(4)}=${adaptiveEnergyActive}) | ZCR: ${zcr.toFixed(4)} (${this.VAD_ZCR_THRESHOLD}-0.5=${zcrActive}) | Voice: ${voiceDetected}`);
+    handleFrame(frame) {
+        if (frame.samples === 0) {
+            console.warn(`[PROCESSOR] Empty PCM data from base64 chunk`);
+            return;
         }
-        
-        return voiceDetected;
-    }
 
-    /**
-     * Calculate RMS energy
-     */
-    calculateRMS(audioData) {
-        let sum = 0;
-        for (let i = 0; i < audioData.length; i++) {
-            sum += audioData[i] * audioData[i];
+        this.totalChunks++;
+        this.lastRMS = frame.rms;
+        this.lastZeroCrossings = frame.zcr;
+        this.lastPeak = frame.peak;
+        this.speechBufferSize = frame.speechSamples;
+
+        // Debug logging (every 50 chunks to avoid spam)
+        if (this.totalChunks % 50 === 0) {
+            console.log(`[VAD] RMS: ${frame.rms.toFixed(4)} | ZCR: ${frame.zcr.toFixed(4)} | Peak: ${frame.peak.toFixed(4)} | Voice: ${frame.voice}`);
         }
-        return Math.sqrt(sum / audioData.length);
-    }
 
-    /**
-     * Calculate zero crossing rate
-     */
-    calculateZeroCrossingRate(audioData) {
-        let crossings = 0;
-        for (let i = 1; i < audioData.length; i++) {
-            if ((audioData[i] >= 0) !== (audioData[i - 1] >= 0)) {
-                crossings++;
-            }
+        if (frame.event === AUDIO_FRAME_EVENT.VOICE_START) {
+            console.log(`[VAD] 🎤 Voice START detected`);
+            this.handleVoiceStart(frame.speechSamples);
+        } else if (frame.event === AUDIO_FRAME_EVENT.VOICE_END) {
+            console.log(`[VAD] 🔇 Voice END detected`);
+            this.handleVoiceEnd(frame.segment);
+        } else if (frame.segment) {
+            this.handleSpeechLimit(frame.segment);
         }
-        return crossings / audioData.length;
     }
 
     /**
      * Handle voice start
      */
-    handleVoiceStart() {
+    handleVoiceStart(preSpeechSamples) {
         this.isVoiceActive = true;
         this.isListening = true;
         this.voiceStartTime = Date.now();
         
-        // Smart buffering: Include pre-speech context for natural start
-        this.speechBuffer.reset();
-        
-        // Add recent VAD buffer content as pre-speech context (last 300ms)
-        const preSpeechSamples = Math.min(4800, this.vadBuffer.count); // 300ms at 16kHz
-        if (preSpeechSamples > 0) {
-            const preSpeechData = this.vadBuffer.readLast(preSpeechSamples);
-            this.speechBuffer.push(preSpeechData);
-            console.log(`[Voice Start] Added ${preSpeechSamples} pre-speech samples (${(preSpeechSamples/16000*1000).toFixed(0)}ms)`);
-        }
-        
-        console.log("[Voice Start] Beginning speech capture with smart buffering");
+        console.log(`[Voice Start] Beginning speech capture with ${preSpeechSamples} pre-speech samples (${(preSpeechSamples / this.sampleRate * 1000).toFixed(0)}ms)`);
         
         if (this.onVoiceStateChange) {
             this.onVoiceStateChange({
@@ -219,101 +133,74 @@ class StreamingProcessor {
     }
 
     /**
-     * Handle voice end
+     * Handle voice end; segment is null when the speech was too short
      */
-    async handleVoiceEnd() {
-        // Add small post-speech buffer for natural ending (100ms)
-        const postSpeechDelay = 100;
+    async handleVoiceEnd(segment) {
+        this.isVoiceActive = false;
+        this.isListening = false;
+        const speechDuration = Date.now() - this.voiceStartTime;
+        const audioLength = segment ? segment.pcm.length : 0;
         
-        setTimeout(async () => {
-            const speechDuration = Date.now() - this.voiceStartTime;
-            
-            // Add recent VAD buffer as post-speech context (200ms for natural ending)
-            const postSpeechSamples = Math.min(3200, this.vadBuffer.count); // 200ms
-            if (postSpeechSamples > 0) {
-                const postSpeechData = this.vadBuffer.readLast(postSpeechSamples);
-                this.speechBuffer.push(postSpeechData);
-                console.log(`[Voice End] Added ${postSpeechSamples} post-speech samples (${(postSpeechSamples/16000*1000).toFixed(0)}ms)`);
-            }
-            
-            console.log(`[Voice End] Speech duration: ${speechDuration}ms, Buffer: ${this.speechBuffer.count} samples`);
-            
-            // Send speech to API if we have enough audio
-            if (this.speechBuffer.count >= this.MIN_SPEECH_DURATION) {
-                const timeSinceLastSend = this.lastApiCall === 0 ? 1000 : Date.now() - this.lastApiCall;
-                if (timeSinceLastSend > 500) { // Prevent duplicate sends within 500ms
-                    await this.sendSpeechToAPI(true); // Mark as final
-                } else {
-                    console.log("[Voice End] Speech already sent recently, skipping");
-                    this.speechBuffer.reset();
+        console.log(`[Voice End] Speech duration: ${speechDuration}ms, Buffer: ${audioLength} samples`);
+        
+        if (segment) {
+            const timeSinceLastSend = this.lastApiCall === 0 ? 1000 : Date.now() - this.lastApiCall;
+            if (timeSinceLastSend > 500) { // Prevent duplicate sends within 500ms
+                try {
+                    await this.sendSpeechToAPI(segment);
+                } catch (error) {
+                    // Logged by sendSpeechToAPI
                 }
             } else {
-                console.log("[Voice End] Speech too short, discarding");
-                this.speechBuffer.reset();
+                console.log("[Voice End] Speech already sent recently, skipping");
             }
-            
-            if (this.onVoiceStateChange) {
-                this.onVoiceStateChange({
-                    isActive: false,
-                    timestamp: Date.now(),
-                    duration: speechDuration,
-                    audioLength: this.speechBuffer.count,
-                    postSpeechSamples: postSpeechSamples
-                });
-            }
-        }, postSpeechDelay);
+        } else {
+            console.log("[Voice End] Speech too short, discarding");
+        }
+        
+        if (this.onVoiceStateChange) {
+            this.onVoiceStateChange({
+                isActive: false,
+                timestamp: Date.now(),
+                duration: speechDuration,
+                audioLength: audioLength,
+                postSpeechSamples: this.postSpeechSamples
+            });
+        }
     }
 
     /**
-     * Check if speech buffer needs to be sent (max duration reached)
+     * Speech reached the maximum duration: the front end split it, keeping
+     * an overlap for continuity
      */
-    async checkSpeechBufferLimits() {
-        const speechDuration = Date.now() - this.voiceStartTime;
-        const bufferSize = this.speechBuffer.count;
-        const maxDurationMs = this.MAX_SPEECH_DURATION / 16000 * 1000;
-        
-        // Send if max duration reached or buffer is 85% full
-        if (speechDuration >= maxDurationMs || bufferSize >= this.speechBuffer.capacity * 0.85) {
-            
-            console.log(`[Buffer Limit] Sending speech chunk (${(speechDuration/1000).toFixed(1)}s / ${(maxDurationMs/1000).toFixed(1)}s max, ${bufferSize} samples)`);
-            await this.sendSpeechToAPI(false); // Not final
-            
-            // Keep overlap for continuity
-            const overlapSize = Math.min(8000, bufferSize * 0.15); // 500ms overlap
-            const overlapData = this.speechBuffer.readLast(overlapSize);
-            this.speechBuffer.reset();
-            if (overlapData.length > 0) {
-                this.speechBuffer.push(overlapData);
-                console.log(`[Buffer Limit] Kept ${overlapSize} samples (${(overlapSize/16000*1000).toFixed(0)}ms) for continuity`);
-            }
+    async handleSpeechLimit(segment) {
+        const seconds = segment.pcm.length / this.sampleRate;
+        console.log(`[Buffer Limit] Sending speech chunk (${seconds.toFixed(1)}s, ${segment.pcm.length} samples)`);
+        try {
+            await this.sendSpeechToAPI(segment);
+        } catch (error) {
+            // Logged by sendSpeechToAPI
         }
     }
 
     /**
-     * Send complete speech to API
+     * Send a speech segment ({ pcm: Int16Array, final }) to the API
      */
-    async sendSpeechToAPI(isFinal = true) {
+    async sendSpeechToAPI(segment) {
         try {
-            const speechData = this.speechBuffer.readAll();
+            const speechData = segment.pcm;
             if (speechData.length === 0) return null;
 
-            // Convert to Int16Array for API
-            const int16Data = new Int16Array(speechData.length);
-            for (let i = 0; i < speechData.length; i++) {
-                const scaled = Math.max(-1, Math.min(1, speechData[i])) * 32767;
-                int16Data[i] = Math.max(-32768, Math.min(32767, scaled));
-            }
-
             const speechPacket = {
-                audioData: Array.from(int16Data),
+                audioData: speechData,                  // Int16Array; ApiService frames it
                 timestamp: Date.now(),
                 duration: Date.now() - this.voiceStartTime,
-                isFinal: isFinal,
-                sampleRate: 16000,
+                isFinal: segment.final,
+                sampleRate: this.sampleRate,
                 channels: 1
             };
 
-            console.log(`[API Call] Sending speech: ${speechData.length} samples (${(speechData.length/16000).toFixed(2)}s)`);
+            console.log(`[API Call] Sending speech: ${speechData.length} samples (${(speechData.length / this.sampleRate).toFixed(2)}s)`);
             
             this.apiCalls++;
             this.lastApiCall = Date.now();
@@ -322,11 +209,6 @@ class StreamingProcessor {
                 await this.onSpeechReady(speechPacket);
             }
 
-            // Reset buffer after sending if final
-            if (isFinal) {
-                this.speechBuffer.reset();
-            }
-
             return speechPacket;
 
         } catch (error) {
@@ -335,34 +217,6 @@ class StreamingProcessor {
         }
     }
 
-    /**
-     * Convert base64 to Float32Array
-     */
-    base64ToFloat32Array(base64String) {
-        try {
-            // Remove MIME header if present
-            const pureBase64 = base64String.includes(',') ? base64String.split(',')[1] : base64String;
-
-            // Decode Base64
-            const binary = atob(pureBase64);
-            const bytes = new Uint8Array(binary.length);
-            for (let i = 0; i < binary.length; i++) {
-                bytes[i] = binary.charCodeAt(i);
-            }
-
-            // Convert to Float32Array with little-endian parsing
-            const view = new DataView(bytes.buffer);
-            const floats = new Float32Array(bytes.length / 4);
-            for (let i = 0; i < floats.length; i++) {
-                floats[i] = view.getFloat32(i * 4, true); // true = little-endian
-            }
-            return floats;
-        } catch (error) {
-            console.error("Base64 to Float32Array conversion failed:", error);
-            return new Float32Array(0);
-        }
-    }
-
     /**
      * Set callbacks
      */
@@ -386,17 +240,25 @@ class StreamingProcessor {
         }
     }
 
+    /**
+     * Drop the speech in progress and wait for the next voice start
+     */
+    resetVoiceState() {
+        this.isVoiceActive = false;
+        this.isListening = false;
+        this.speechBufferSize = 0;
+        this.frontEnd.resetVoice();
+    }
+
     /**
      * Reset processor
      */
     reset() {
-        this.speechBuffer.reset();
-        this.vadBuffer.reset();
+        this.frontEnd.reset();
         this.isVoiceActive = false;
         this.isListening = false;
         this.isProcessing = false;
-        this.consecutiveVoiceFrames = 0;
-        this.consecutiveSilenceFrames = 0;
+        this.speechBufferSize = 0;
         
         console.log("[Reset] Processor state cleared");
     }
@@ -409,8 +271,10 @@ class StreamingProcessor {
             isVoiceActive: this.isVoiceActive,
             isListening: this.isListening,
             isProcessing: this.isProcessing,
-            speechBufferSize: this.speechBuffer.count,
+            speechBufferSize: this.speechBufferSize,
             energy: this.lastRMS,
+            peak: this.lastPeak,
+            frontEnd: this.frontEnd.mode,
             efficiency: {
                 totalChunks: this.totalChunks,
                 apiCalls: this.apiCalls,
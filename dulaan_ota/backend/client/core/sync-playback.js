@@ -0,0 +1,584 @@
+/**
+ * Sync Playback - Time-synchronized duty changes across several devices
+ *
+ * A plain motor write takes effect at the connection event it arrives in,
+ * so two toys written at the same moment are apart by the phase of their
+ * connection intervals (tens of ms). Here every device keeps a clock
+ * (sync characteristic, see vibration_motor_ble/vm_sync.h) and duty changes
+ * carry the device time at which to apply them:
+ *
+ *   PING     [0x01][seq]                   -> [0x01][seq][session][rx u32][tx u32]
+ *   SCHEDULE [0x02]{[at u32][duty u16]}x1-3   error only: [0x02][status]
+ *   STOP     [0x03]
+ *   STATUS   [0x04]                        -> [0x04][session][queued][applied u16]
+ *                                             [late u16][dropped u16][worst late us u16]
+ *
+ * Device times are microseconds (u32, wrapping), little endian.
+ *
+ * Clock estimate (ClockEstimator): a PING sent at phone time t is stamped
+ * rx when the device handles it, so rx - t = offset + uplink delay. The
+ * uplink delay is the wait for the next connection event plus the stack
+ * latency; it is short whenever the write catches the start of an event.
+ * The notification back always waits for a later event, so the return trip
+ * is never short and round-trip halving would be off by about half an
+ * interval, differently for every device. The estimate therefore follows
+ * the lower envelope of rx - t over a window of pings (the lower convex
+ * hull edge under the mean ping time), which also gives the drift. The
+ * remaining bias is the shortest stack latency, the same for every device
+ * on the phone, so it cancels between devices.
+ */
+
+import { MOTOR_DUTY } from '../utils/constants.js';
+import { streamNow } from './remote-stream.js';
+
+export const SYNC_PROTOCOL = {
+    CHAR_UUID: '9A561A2D-594F-4E2B-B123-5F739A2D594F',
+    CMD_PING: 0x01,
+    CMD_SCHEDULE: 0x02,
+    CMD_STOP: 0x03,
+    CMD_STATUS: 0x04,
+    ENTRY_SIZE: 6,
+    ENTRIES_MAX: 3,
+    PING_RSP_SIZE: 11,
+    STATUS_RSP_SIZE: 11,
+    ERR_LENGTH: 0x01,
+    ERR_DUTY: 0x02,
+    ERR_NO_CLOCK: 0x03,
+    ERR_HORIZON: 0x04,
+    ERR_FULL: 0x05,
+    HORIZON_MS: 10000,
+    QUEUE_SIZE: 16
+};
+
+export const SYNC_DEFAULTS = {
+    LEAD_MS: 150,               // Schedule this far ahead: covers a retried write on a 50 ms interval
+    PING_COUNT: 32,             // Pings per full sync
+    RESYNC_PING_COUNT: 8,       // Pings per periodic resync
+    PING_SPACING_MS: 40,        // Mean gap between pings, randomized so they hit every interval phase
+    PING_TIMEOUT_MS: 500,
+    RESYNC_INTERVAL_MS: 5000,
+    WINDOW: 256,                // Pings kept for the estimate (about 2.5 min of resync)
+    MIN_SAMPLES: 8,             // Pings before a device counts as synced
+    MIN_DRIFT_SPAN_MS: 30000,   // Shortest window the drift is fitted over
+    MAX_DRIFT_PPM: 500,         // Crystal tolerance; steeper fits are noise
+    MAX_RTT_MS: 300,            // Longer round trips are dropped (retries, stalls)
+    LOOKAHEAD_MS: 400           // Frames sent ahead during play(), within the device queue
+};
+
+const U32 = 0x100000000;
+
+function signed32(v) {
+    v = ((v % U32) + U32) % U32;
+    return v >= U32 / 2 ? v - U32 : v;
+}
+
+export function encodeSyncPing(seq) {
+    return new Uint8Array([SYNC_PROTOCOL.CMD_PING, seq & 0xFF]);
+}
+
+/**
+ * @param {Array<{at: number, duty: number}>} entries - 1-3 changes, at in device us
+ */
+export function encodeSyncSchedule(entries) {
+    if (entries.length < 1 || entries.length > SYNC_PROTOCOL.ENTRIES_MAX) {
+        throw new Error(`Schedule takes 1-${SYNC_PROTOCOL.ENTRIES_MAX} entries`);
+    }
+    const bytes = new Uint8Array(1 + entries.length * SYNC_PROTOCOL.ENTRY_SIZE);
+    const view = new DataView(bytes.buffer);
+    bytes[0] = SYNC_PROTOCOL.CMD_SCHEDULE;
+    entries.forEach((e, i) => {
+        const duty = Math.max(0, Math.min(MOTOR_DUTY.MAX, Math.round(e.duty)));
+        view.setUint32(1 + i * SYNC_PROTOCOL.ENTRY_SIZE, ((Math.round(e.at) % U32) + U32) % U32, true);
+        view.setUint16(5 + i * SYNC_PROTOCOL.ENTRY_SIZE, duty, true);
+    });
+    return bytes;
+}
+
+/**
+ * Parse a sync notification
+ * @returns {Object|null} { cmd, ... } or null if malformed
+ */
+export function parseSyncNotification(data) {
+    const bytes = data instanceof Uint8Array ? data :
+        data instanceof DataView ? new Uint8Array(data.buffer, data.byteOffset, data.byteLength) :
+        new Uint8Array(data);
+    if (bytes.length < 2) return null;
+    const view = new DataView(bytes.buffer, bytes.byteOffset, bytes.byteLength);
+
+    switch (bytes[0]) {
+        case SYNC_PROTOCOL.CMD_PING:
+            if (bytes.length < SYNC_PROTOCOL.PING_RSP_SIZE) return null;
+            return {
+                cmd: 'ping',
+                seq: bytes[1],
+                session: bytes[2],
+                rx: view.getUint32(3, true),
+                tx: view.getUint32(7, true)
+            };
+        case SYNC_PROTOCOL.CMD_SCHEDULE:
+            return { cmd: 'error', status: bytes[1] };
+        case SYNC_PROTOCOL.CMD_STATUS:
+            if (bytes.length < SYNC_PROTOCOL.STATUS_RSP_SIZE) return null;
+            return {
+                cmd: 'status',
+                session: bytes[1],
+                queued: bytes[2],
+                applied: view.getUint16(3, true),
+                late: view.getUint16(5, true),
+                dropped: view.getUint16(7, true),
+                worstLateUs: view.getUint16(9, true)
+            };
+        default:
+            return null;
+    }
+}
+
+/**
+ * Maps phone time (ms) to one device's clock (us)
+ */
+export class ClockEstimator {
+    /**
+     * @param {Object} options - { window, minSamples, minDriftSpanMs, maxDriftPpm, maxRttMs, trackDrift }
+     */
+    constructor(options = {}) {
+        this.window = options.window || SYNC_DEFAULTS.WINDOW;
+        this.minSamples = options.minSamples || SYNC_DEFAULTS.MIN_SAMPLES;
+        this.minDriftSpanMs = options.minDriftSpanMs ?? SYNC_DEFAULTS.MIN_DRIFT_SPAN_MS;
+        this.maxDriftPpm = options.maxDriftPpm ?? SYNC_DEFAULTS.MAX_DRIFT_PPM;
+        this.maxRttMs = options.maxRttMs || SYNC_DEFAULTS.MAX_RTT_MS;
+        this.trackDrift = options.trackDrift !== false;
+        this.reset();
+    }
+
+    reset(session = null) {
+        this.session = session;
+        this.points = [];           // { x: phone ms - x0, y: device us - phone us }
+        this.x0 = null;
+        this.intercept = 0;         // y = intercept + slope * x
+        this.slope = 0;             // us per ms = drift in ppm / 1000
+        this.minRttMs = Infinity;
+        this.rejected = 0;
+    }
+
+    get synced() {
+        return this.points.length >= this.minSamples;
+    }
+
+    /**
+     * Add one PING round trip
+     * @param {Object} s - { sent, received } phone ms, { rx, tx, session } from the device
+     * @returns {boolean} false if dropped
+     */
+    addSample(s) {
+        if (s.session !== this.session) {
+            this.reset(s.session);
+        }
+        const rtt = (s.received - s.sent) - (((s.tx - s.rx) % U32 + U32) % U32) / 1000;
+        if (!(rtt >= 0) || rtt > this.maxRttMs) {
+            this.rejected++;
+            return false;
+        }
+        this.minRttMs = Math.min(this.minRttMs, rtt);
+
+        if (this.x0 === null) this.x0 = s.sent;
+        const x = s.sent - this.x0;
+        const y = this.unwrap(s.rx, s.sent) - s.sent * 1000;
+
+        this.points.push({ x, y });
+        if (this.points.length > this.window) this.points.shift();
+        this.fit();
+        return true;
+    }
+
+    /**
+     * Extended device time closest to the model's prediction for phoneMs
+     */
+    unwrap(raw, phoneMs) {
+        let predicted;
+        if (this.points.length) {
+            predicted = phoneMs * 1000 + this.offsetAt(phoneMs);
+        } else {
+            return raw;
+        }
+        return predicted + signed32(raw - predicted);
+    }
+
+    offsetAt(phoneMs) {
+        return this.intercept + this.slope * (phoneMs - this.x0);
+    }
+
+    /**
+     * Lower envelope of the points: the line under all of them that is
+     * highest at their mean time
+     */
+    fit() {
+        const pts = this.points.slice().sort((a, b) => a.x - b.x || a.y - b.y);
+        const maxSlope = this.maxDriftPpm / 1000;
+        const span = pts[pts.length - 1].x - pts[0].x;
+        let slope = null;
+
+        if (this.trackDrift && pts.length > 1 && span >= this.minDriftSpanMs) {
+            const hull = [];
+            for (const p of pts) {
+                while (hull.length >= 2) {
+                    const o = hull[hull.length - 2];
+                    const a = hull[hull.length - 1];
+                    if ((a.x - o.x) * (p.y - o.y) - (a.y - o.y) * (p.x - o.x) > 0) break;
+                    hull.pop();
+                }
+                hull.push(p);
+            }
+            const meanX = pts.reduce((sum, p) => sum + p.x, 0) / pts.length;
+            for (let i = 0; i + 1 < hull.length; i++) {
+                if (hull[i + 1].x >= meanX && hull[i + 1].x > hull[i].x) {
+                    slope = (hull[i + 1].y - hull[i].y) / (hull[i + 1].x - hull[i].x);
+                    break;
+                }
+            }
+            if (slope !== null && Math.abs(slope) > maxSlope) slope = null;
+        }
+        if (slope === null) {
+            // Too short or too noisy for a drift fit: keep the last one
+            slope = this.trackDrift ? Math.max(-maxSlope, Math.min(maxSlope, this.slope)) : 0;
+        }
+
+        // Highest line with this slope that stays under every point
+        let intercept = Infinity;
+        for (const p of pts) intercept = Math.min(intercept, p.y - slope * p.x);
+        this.slope = slope;
+        this.intercept = intercept;
+    }
+
+    /**
+     * Device time (u32 us) at phone time phoneMs
+     */
+    toDevice(phoneMs) {
+        const ext = Math.round(phoneMs * 1000 + this.offsetAt(phoneMs));
+        return ((ext % U32) + U32) % U32;
+    }
+
+    /**
+     * Phone time (ms) of a device time near phone time nearMs
+     */
+    toPhone(deviceUs, nearMs) {
+        const ext = this.unwrap(deviceUs, nearMs);
+        return (ext - this.intercept + this.slope * this.x0) / (1000 + this.slope);
+    }
+
+    getState() {
+        return {
+            synced: this.synced,
+            session: this.session,
+            samples: this.points.length,
+            offsetUs: this.points.length ? this.offsetAt(this.x0 + this.points[this.points.length - 1].x) : null,
+            driftPpm: this.slope * 1000,
+            minRttMs: Number.isFinite(this.minRttMs) ? this.minRttMs : null,
+            spanMs: this.points.length ? this.points[this.points.length - 1].x - this.points[0].x : 0,
+            rejected: this.rejected
+        };
+    }
+}
+
+/**
+ * Plays duty changes on several devices at the same instant
+ */
+export class SyncPlayback {
+    /**
+     * @param {Object} options - { leadMs, pingCount, resyncPingCount, pingSpacingMs, pingTimeoutMs,
+     *                             resyncIntervalMs, lookaheadMs, now, setTimeout, clearTimeout, random,
+     *                             and ClockEstimator options }
+     */
+    constructor(options = {}) {
+        this.options = options;
+        this.leadMs = options.leadMs ?? SYNC_DEFAULTS.LEAD_MS;
+        this.pingCount = options.pingCount || SYNC_DEFAULTS.PING_COUNT;
+        this.resyncPingCount = options.resyncPingCount || SYNC_DEFAULTS.RESYNC_PING_COUNT;
+        this.pingSpacingMs = options.pingSpacingMs ?? SYNC_DEFAULTS.PING_SPACING_MS;
+        this.pingTimeoutMs = options.pingTimeoutMs || SYNC_DEFAULTS.PING_TIMEOUT_MS;
+        this.resyncIntervalMs = options.resyncIntervalMs || SYNC_DEFAULTS.RESYNC_INTERVAL_MS;
+        this.lookaheadMs = options.lookaheadMs || SYNC_DEFAULTS.LOOKAHEAD_MS;
+
+        // Injectable for the simulator
+        this.now = options.now || streamNow;
+        this.setTimer = options.setTimeout || ((fn, ms) => setTimeout(fn, ms));
+        this.clearTimer = options.clearTimeout || ((id) => clearTimeout(id));
+        this.random = options.random || Math.random;
+
+        this.devices = new Map();
+        this.resyncTimer = null;
+        this.playTimer = null;
+        this.playback = null;
+    }
+
+    /**
+     * Add a device by its sync characteristic
+     * @param {string} id
+     * @param {Function} write - async (Uint8Array) => void, write without response
+     * @returns {Function} notification handler for the sync characteristic
+     */
+    addDevice(id, write) {
+        this.devices.set(id, {
+            id,
+            write,
+            clock: new ClockEstimator(this.options),
+            seq: 0,
+            pending: new Map(),
+            statusWaiter: null,
+            syncing: null,
+            stats: { pings: 0, lost: 0, scheduled: 0, writes: 0, errors: 0, lastError: null }
+        });
+        return (data) => this.handleNotification(id, data);
+    }
+
+    /**
+     * Add a connected MotorController (one per toy)
+     * @returns {Promise<string|null>} device id, null if the firmware has no sync characteristic
+     */
+    async addController(controller) {
+        const id = controller.getDeviceAddress();
+        const handler = this.addDevice(id, (bytes) => controller.writeSync(bytes));
+        if (!await controller.startSyncNotifications(handler)) {
+            this.removeDevice(id);
+            return null;
+        }
+        return id;
+    }
+
+    removeDevice(id) {
+        const device = this.devices.get(id);
+        if (!device) return;
+        for (const p of device.pending.values()) {
+            this.clearTimer(p.timer);
+            p.resolve(null);
+        }
+        this.devices.delete(id);
+    }
+
+    handleNotification(id, data) {
+        const device = this.devices.get(id);
+        const msg = parseSyncNotification(data);
+        if (!device || !msg) return;
+
+        if (msg.cmd === 'ping') {
+            const p = device.pending.get(msg.seq);
+            if (!p) return;
+            device.pending.delete(msg.seq);
+            this.clearTimer(p.timer);
+            const sample = { sent: p.sent, received: this.now(), rx: msg.rx, tx: msg.tx, session: msg.session };
+            device.clock.addSample(sample);
+            p.resolve(sample);
+        } else if (msg.cmd === 'error') {
+            device.stats.errors++;
+            device.stats.lastError = msg.status;
+            if (msg.status === SYNC_PROTOCOL.ERR_NO_CLOCK) {
+                // Session ended on the device: its clock restarted
+                device.clock.reset();
+            }
+        } else if (msg.cmd === 'status' && device.statusWaiter) {
+            const waiter = device.statusWaiter;
+            device.statusWaiter = null;
+            this.clearTimer(waiter.timer);
+            waiter.resolve(msg);
+        }
+    }
+
+    /**
+     * One clock exchange
+     * @returns {Promise<Object|null>} sample, null on timeout
+     */
+    ping(id) {
+        const device = this.devices.get(id);
+        if (!device) return Promise.resolve(null);
+        const seq = device.seq = (device.seq + 1) & 0xFF;
+        device.stats.pings++;
+
+        return new Promise((resolve) => {
+            const entry = { sent: this.now(), resolve, timer: null };
+            entry.timer = this.setTimer(() => {
+                device.pending.delete(seq);
+                device.stats.lost++;
+                resolve(null);
+            }, this.pingTimeoutMs);
+            device.pending.set(seq, entry);
+            Promise.resolve(device.write(encodeSyncPing(seq))).catch(() => {});
+        });
+    }
+
+    sleep(ms) {
+        return new Promise((resolve) => this.setTimer(resolve, ms));
+    }
+
+    /**
+     * Ping one device count times at random spacing
+     */
+    async syncDevice(id, count = this.pingCount) {
+        const device = this.devices.get(id);
+        if (!device) return null;
+        if (device.syncing) return device.syncing;
+
+        device.syncing = (async () => {
+            for (let i = 0; i < count && this.devices.has(id); i++) {
+                await this.ping(id);
+                await this.sleep(this.pingSpacingMs * (0.5 + this.random()));
+            }
+            device.syncing = null;
+            return device.clock.getState();
+        })();
+        return device.syncing;
+    }
+
+    /**
+     * Sync every device (in parallel)
+     */
+    async syncAll(count = this.pingCount) {
+        await Promise.all([...this.devices.keys()].map((id) => this.syncDevice(id, count)));
+        return this.isSynced();
+    }
+
+    isSynced() {
+        return this.devices.size > 0 && [...this.devices.values()].every((d) => d.clock.synced);
+    }
+
+    /**
+     * Keep tracking drift with a few pings every resyncIntervalMs
+     */
+    startResync() {
+        this.stopResync();
+        const tick = () => {
+            for (const id of this.devices.keys()) {
+                const device = this.devices.get(id);
+                this.syncDevice(id, device.clock.synced ? this.resyncPingCount : this.pingCount);
+            }
+            this.resyncTimer = this.setTimer(tick, this.resyncIntervalMs);
+        };
+        this.resyncTimer = this.setTimer(tick, this.resyncIntervalMs);
+    }
+
+    stopResync() {
+        if (this.resyncTimer !== null) {
+            this.clearTimer(this.resyncTimer);
+            this.resyncTimer = null;
+        }
+    }
+
+    /**
+     * Schedule duty changes on every synced device
+     * @param {Array<{at: number, duty: number}>} changes - at in phone ms
+     * @returns {number} devices written
+     */
+    scheduleChanges(changes) {
+        let written = 0;
+        for (const device of this.devices.values()) {
+            if (!device.clock.synced) continue;
+            const entries = changes.map((c) => ({ at: device.clock.toDevice(c.at), duty: c.duty }));
+            for (let i = 0; i < entries.length; i += SYNC_PROTOCOL.ENTRIES_MAX) {
+                const bytes = encodeSyncSchedule(entries.slice(i, i + SYNC_PROTOCOL.ENTRIES_MAX));
+                device.stats.writes++;
+                Promise.resolve(device.write(bytes)).catch(() => {});
+            }
+            device.stats.scheduled += entries.length;
+            written++;
+        }
+        return written;
+    }
+
+    /**
+     * Set one duty on every device at the same instant
+     * @param {number} duty - 0-10000
+     * @param {number} at - phone ms, default now + leadMs
+     * @returns {number} the phone time it applies at
+     */
+    setDuty(duty, at = this.now() + this.leadMs) {
+        this.scheduleChanges([{ at, duty }]);
+        return at;
+    }
+
+    /**
+     * Play timed frames on every device, sent lookaheadMs ahead
+     * @param {Array<{time: number, duty: number}>} frames - time in ms from the start
+     * @param {Object} options - { startAt: phone ms, duration, loop }
+     */
+    play(frames, options = {}) {
+        this.stopPlay();
+        const sorted = frames.slice().sort((a, b) => a.time - b.time);
+        if (!sorted.length) return null;
+        const duration = options.duration || sorted[sorted.length - 1].time + 1;
+        this.playback = {
+            frames: sorted,
+            duration,
+            loop: !!options.loop,
+            startAt: options.startAt ?? this.now() + this.leadMs,
+            index: 0,
+            cycle: 0
+        };
+
+        const pump = () => {
+            const pb = this.playback;
+            if (!pb) return;
+            const horizon = this.now() + this.lookaheadMs;
+            const batch = [];
+            while (true) {
+                if (pb.index >= pb.frames.length) {
+                    if (!pb.loop) break;
+                    pb.index = 0;
+                    pb.cycle++;
+                }
+                const at = pb.startAt + pb.cycle * pb.duration + pb.frames[pb.index].time;
+                if (at > horizon) break;
+                batch.push({ at, duty: pb.frames[pb.index].duty });
+                pb.index++;
+            }
+            if (batch.length) this.scheduleChanges(batch);
+            if (!pb.loop && pb.index >= pb.frames.length) {
+                this.playTimer = null;
+                return;
+            }
+            this.playTimer = this.setTimer(pump, this.lookaheadMs / 4);
+        };
+        pump();
+        return this.playback.startAt;
+    }
+
+    stopPlay() {
+        if (this.playTimer !== null) {
+            this.clearTimer(this.playTimer);
+            this.playTimer = null;
+        }
+        this.playback = null;
+    }
+
+    /**
+     * Read the device's playout counters
+     */
+    queryStatus(id) {
+        const device = this.devices.get(id);
+        if (!device) return Promise.resolve(null);
+        return new Promise((resolve) => {
+            const timer = this.setTimer(() => {
+                device.statusWaiter = null;
+                resolve(null);
+            }, this.pingTimeoutMs);
+            device.statusWaiter = { resolve, timer };
+            Promise.resolve(device.write(new Uint8Array([SYNC_PROTOCOL.CMD_STATUS]))).catch(() => {});
+        });
+    }
+
+    /**
+     * Stop playback and resync; the devices drop their queues and clocks
+     */
+    async stop() {
+        this.stopPlay();
+        this.stopResync();
+        await Promise.all([...this.devices.values()].map((d) =>
+            Promise.resolve(d.write(new Uint8Array([SYNC_PROTOCOL.CMD_STOP]))).catch(() => {})));
+        for (const d of this.devices.values()) d.clock.reset();
+    }
+
+    getStats() {
+        const stats = {};
+        for (const [id, d] of this.devices) {
+            stats[id] = { ...d.stats, clock: d.clock.getState() };
+        }
+        return stats;
+    }
+}
@@ -7,6 +7,7 @@
 import { motorController } from './core/motor-controller.js';
 import { consentService } from './services/consent-service.js';
 import { remoteService } from './services/remote-service.js';
+import { MOTOR_DUTY } from './utils/constants.js';
 
 
 // Import control modes
@@ -193,6 +194,13 @@ class DulaanSDK {
         return await this.motor.write(pwmValue);
     }
 
+    /**
+     * Set motor intensity as a duty cycle, 0-10000 (0.01% steps)
+     */
+    async setDuty(dutyCycle) {
+        return await this.motor.writeDuty(dutyCycle);
+    }
+
     getPower() {
         return this.motor.getCurrentPwm();
     }
@@ -375,6 +383,16 @@ class DulaanSDK {
                     }
                     break;
                     
+                case 'duty':
+                    // Full resolution motor command (0-10000)
+                    if (typeof data.value === 'number' && data.value >= 0 && data.value <= MOTOR_DUTY.MAX) {
+                        this.setDuty(data.value);
+                        console.log(`[SDK] ✅ Motor duty set to ${data.value} via remote command`);
+                    } else {
+                        console.warn(`[SDK] ❌ Invalid motor duty value: ${data.value}`);
+                    }
+                    break;
+                    
                 case 'heartbeat':
                     // Heartbeat to maintain connection
                     console.log(`[SDK] 💓 Heartbeat from ${userId}`);
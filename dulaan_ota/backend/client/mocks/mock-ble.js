@@ -10,7 +10,13 @@ class MockBleClient {
         this.connectedDevices = new Set();
         this.scanCallback = null;
         this.disconnectCallbacks = new Map();
-        
+
+        // writeWithoutResponse bookkeeping
+        this.writeLog = [];
+        this.writeDelayMs = 5;      // Time for the stack to take a packet
+        this.writesInFlight = 0;
+        this.maxWritesInFlight = 0;
+
         // Mock device data - using actual target device name
         this.mockDevices = [
             {
@@ -18,6 +24,10 @@ class MockBleClient {
                     deviceId: 'MOCK_DEVICE_001',
                     name: 'XKL-Q086-BT',
                     rssi: -45
+                },
+                // Scan response status: tag 0xB1, battery 85%, fw 1.0, flags 0
+                manufacturerData: {
+                    '65535': new DataView(new Uint8Array([0xB1, 85, 0x00, 0x01, 0x00]).buffer)
                 }
             },
             {
@@ -25,6 +35,10 @@ class MockBleClient {
                     deviceId: 'MOCK_DEVICE_002', 
                     name: 'XKL-Q086-BT',
                     rssi: -67
+                },
+                // Scan response status: battery 12%, fw 1.0, running from bank B, battery low
+                manufacturerData: {
+                    '65535': new DataView(new Uint8Array([0xB1, 12, 0x00, 0x01, 0x09]).buffer)
                 }
             },
             // Add some non-target devices for realistic scanning
@@ -178,6 +192,28 @@ class MockBleClient {
         }
     }
 
+    /**
+     * Write without response, as used for motor control
+     * Resolves when the (simulated) stack has taken the packet; every write is
+     * kept in writeLog so tests can check what reached the device
+     */
+    async writeWithoutResponse(deviceAddress, serviceUuid, characteristicUuid, data) {
+        if (!this.connectedDevices.has(deviceAddress)) {
+            throw new Error(`Device ${deviceAddress} not connected`);
+        }
+
+        const bytes = Array.from(new Uint8Array(data.buffer, data.byteOffset, data.byteLength));
+        this.writeLog.push({ deviceAddress, characteristicUuid, bytes, time: Date.now() });
+
+        this.writesInFlight++;
+        this.maxWritesInFlight = Math.max(this.maxWritesInFlight, this.writesInFlight);
+        try {
+            await this.delay(this.writeDelayMs);
+        } finally {
+            this.writesInFlight--;
+        }
+    }
+
     /**
      * Simulate a device disconnect
      */
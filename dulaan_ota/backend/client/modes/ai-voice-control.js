@@ -6,6 +6,7 @@
 
 import { StreamingProcessor } from '../core/streaming-processor.js';
 import { ApiService } from '../services/api-service.js';
+import { OnDeviceTranscriber } from '../core/speech-transcript.js';
 
 class AIVoiceControl {
     constructor(config = {}) {
@@ -33,6 +34,10 @@ class AIVoiceControl {
             throw new Error('ApiService not available');
         }
         
+        // Platform speech recognition; its text lets the server answer repeats from its cache
+        this.transcriber = config.transcriber ||
+                          (typeof OnDeviceTranscriber !== 'undefined' ? new OnDeviceTranscriber(config.transcript) : null);
+
         this.motorController = config.motorController || null;
         
         // State management
@@ -106,6 +111,9 @@ class AIVoiceControl {
             
             // Start audio processing
             await this.startAudioProcessing();
+            if (this.transcriber?.start()) {
+                console.log("[AI Voice] On-device transcript enabled");
+            }
             
             // Start PWM writing interval to keep BLE connection active
             this.startPwmWriting();
@@ -138,6 +146,7 @@ class AIVoiceControl {
         
         // Stop audio processing
         await this.stopAudioProcessing();
+        this.transcriber?.stop();
         await this.motorController.write(0);
         
         console.log("🔇 Voice control stopped");
@@ -285,6 +294,10 @@ class AIVoiceControl {
             
             console.log(`[Speech Processing] Processing command`);
             
+            if (this.transcriber) {
+                speechPacket.transcript = await this.transcriber.take(speechPacket.timestamp - (speechPacket.duration || 0));
+            }
+
             const t1 = Date.now();
             const response = await this.apiService.processSpeechSegment(speechPacket);
             const t2 = Date.now();
@@ -326,10 +339,7 @@ class AIVoiceControl {
             
             // CRITICAL FIX: Reset processor state to ensure it can detect next speech
             console.log(`[RESET] Resetting processor state for next interaction`);
-            this.processor.isVoiceActive = false;
-            this.processor.isListening = false;
-            this.processor.consecutiveVoiceFrames = 0;
-            this.processor.consecutiveSilenceFrames = 0;
+            this.processor.resetVoiceState();
             
             // Ensure conversation stays active for next command
             this.handleConversationUpdate(true);
@@ -379,8 +389,7 @@ class AIVoiceControl {
             
             // Ensure processor is in clean state for next interaction
             if (this.processor) {
-                this.processor.isVoiceActive = false;
-                this.processor.isListening = false;
+                this.processor.resetVoiceState();
                 console.log(`[CONVERSATION] Processor state reset for next interaction`);
             }
             
@@ -3,7 +3,9 @@
  * Handles ambient sound-based motor control
  */
 
-import { RingBuffer, base64ToFloat32Array, calculateRMS, energyToPWM } from '../utils/audio-utils.js';
+import { RingBuffer, calculateRMS, energyToPWM } from '../utils/audio-utils.js';
+import { AudioFrontEnd } from '../core/audio-frontend.js';
+import { MOTOR_DUTY, dutyToPwm } from '../utils/constants.js';
 
 export class AmbientControl {
     constructor(sdk) {
@@ -16,6 +18,10 @@ export class AmbientControl {
         this.audioBuffer = null;
         this.lastRMS = 0;
         this.lastPwmValue = 0;
+        this.lastDutyCycle = 0;
+        
+        // Decoding and features only: no VAD, so minimal speech buffers
+        this.frontEnd = new AudioFrontEnd({ VAD_BUFFER_SAMPLES: 1, SPEECH_BUFFER_SAMPLES: 1 });
         
         // Initialize audio buffer (1 second at 16kHz)
         this.initializeAudioBuffer();
@@ -93,16 +99,19 @@ export class AmbientControl {
         // Write PWM every 100ms based on accumulated audio data (matches stream.js)
         this.pwmInterval = setInterval(async () => {
             try {
-                const pwmValue = this.calculateAmbientPWM();
+                const dutyCycle = this.calculateAmbientDuty();
+                const pwmValue = dutyToPwm(dutyCycle);
                 
-                // Always write PWM value (even 0) to keep BLE connection active like touch mode
-                await this.sdk.motor.write(pwmValue);
+                // Always write (even 0); the motor write scheduler skips unchanged values
+                await this.sdk.motor.writeDuty(dutyCycle);
                 this.lastPwmValue = pwmValue;
+                this.lastDutyCycle = dutyCycle;
                 
                 // Trigger event for UI updates
                 this.onAmbientUpdate({
                     energy: this.lastRMS,
-                    pwmValue: pwmValue
+                    pwmValue: pwmValue,
+                    dutyCycle: dutyCycle
                 });
             } catch (error) {
                 console.error('PWM writing error:', error);
@@ -164,17 +173,16 @@ export class AmbientControl {
      */
     processAudioChunk(base64Chunk) {
         try {
-            // Convert base64 to audio data
-            const audioData = this.base64ToFloat32Array(base64Chunk);
+            // Decode into the front end's scratch buffer, features in one pass
+            const features = this.frontEnd.analyze(base64Chunk);
             
-            if (audioData && audioData.length > 0) {
+            if (features.samples > 0) {
                 // Add to buffer
                 if (this.audioBuffer) {
-                    this.audioBuffer.push(audioData);
+                    this.audioBuffer.pushFrom(this.frontEnd.floats, features.samples);
                 }
                 
-                // Calculate RMS energy
-                this.lastRMS = this.calculateRMS(audioData);
+                this.lastRMS = features.rms;
             }
         } catch (error) {
             console.error('Error processing audio chunk:', error);
@@ -182,21 +190,28 @@ export class AmbientControl {
     }
 
     /**
-     * Calculate ambient PWM value based on current audio energy
+     * Calculate ambient duty cycle (0-10000) based on current audio energy
      */
-    calculateAmbientPWM() {
+    calculateAmbientDuty() {
         try {
             if (this.lastRMS > 0) {
-                // Use energyToPWM function from audio-utils
-                return this.energyToPWM(this.lastRMS, this.maxEnergy, 255);
+                // Use energyToPWM function from audio-utils, scaled to the firmware duty range
+                return this.energyToPWM(this.lastRMS, this.maxEnergy, MOTOR_DUTY.MAX);
             }
             return 0;
         } catch (error) {
-            console.error('Error calculating ambient PWM:', error);
+            console.error('Error calculating ambient duty:', error);
             return 0;
         }
     }
 
+    /**
+     * Calculate ambient PWM value (0-255) based on current audio energy
+     */
+    calculateAmbientPWM() {
+        return dutyToPwm(this.calculateAmbientDuty());
+    }
+
     /**
      * Get current audio state
      */
@@ -206,45 +221,13 @@ export class AmbientControl {
             maxEnergy: this.maxEnergy,
             bufferSize: this.audioBuffer ? this.audioBuffer.count : 0,
             lastPwmValue: this.lastPwmValue,
+            lastDutyCycle: this.lastDutyCycle,
             isActive: this.isActive
         };
     }
 
     // ===== AUDIO UTILITY FUNCTIONS =====
 
-    /**
-     * Convert base64 to Float32Array (local implementation)
-     */
-    base64ToFloat32Array(base64) {
-        try {
-            // Use global function if available
-            if (typeof base64ToFloat32Array !== 'undefined') {
-                return base64ToFloat32Array(base64);
-            }
-            
-            // Fallback implementation
-            const pureBase64 = base64.includes(',') ? base64.split(',')[1] : base64;
-            const binary = atob(pureBase64);
-            const bytes = new Uint8Array(binary.length);
-            
-            for (let i = 0; i < binary.length; i++) {
-                bytes[i] = binary.charCodeAt(i);
-            }
-
-            const view = new DataView(bytes.buffer);
-            const floats = new Float32Array(bytes.length / 4);
-            
-            for (let i = 0; i < floats.length; i++) {
-                floats[i] = view.getFloat32(i * 4, true);
-            }
-            
-            return floats;
-        } catch (e) {
-            console.error("Base64 to Float32Array conversion failed:", e);
-            return new Float32Array(0);
-        }
-    }
-
     /**
      * Calculate RMS energy (local implementation)
      */
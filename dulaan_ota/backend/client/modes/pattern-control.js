@@ -4,6 +4,7 @@
  */
 
 import { motorPatternLibrary } from '../services/motor-pattern-library.js';
+import { pwmToDuty } from '../utils/constants.js';
 
 export class PatternControl {
     constructor(sdk) {
@@ -13,7 +14,8 @@ export class PatternControl {
         
         // PWM interval control (like ambient and touch modes)
         this.pwmInterval = null;
-        this.currentPwmValue = 0;
+        this.currentPwmValue = 0;   // 0-255, rounded for callbacks and status
+        this.currentDuty = 0;       // 0-10000 from the unrounded interpolation, written to the motor
         
         // Pattern state
         this.currentPattern = null;
@@ -47,7 +49,7 @@ export class PatternControl {
         }
 
         this.isActive = true;
-        this.currentPwmValue = 0;
+        this.setOutput(0);
         
         // Start PWM writing interval (like ambient and touch modes)
         this.startPwmWriting();
@@ -89,13 +91,21 @@ export class PatternControl {
         // Write PWM every 100ms based on current pattern state
         this.pwmInterval = setInterval(async () => {
             try {
-                await this.sdk.motor.write(this.currentPwmValue);
+                await this.sdk.motor.writeDuty(this.currentDuty);
             } catch (error) {
                 console.error('Pattern PWM writing error:', error);
             }
         }, 100); // 100ms interval matches ambient and touch modes
     }
 
+    /**
+     * Set the pattern output from a 0-255 value, fractions kept for the motor
+     */
+    setOutput(pwm) {
+        this.currentDuty = pwmToDuty(pwm);
+        this.currentPwmValue = Math.round(pwm);
+    }
+
     /**
      * Stop PWM writing interval
      */
@@ -104,7 +114,7 @@ export class PatternControl {
             clearInterval(this.pwmInterval);
             this.pwmInterval = null;
         }
-        this.currentPwmValue = 0;
+        this.setOutput(0);
     }
 
     /**
@@ -112,7 +122,7 @@ export class PatternControl {
      */
     updatePatternPwm() {
         if (!this.isPlaying || this.isPaused || !this.currentPattern) {
-            this.currentPwmValue = 0;
+            this.setOutput(0);
             return;
         }
 
@@ -127,7 +137,7 @@ export class PatternControl {
         }
 
         // Calculate current PWM value
-        this.currentPwmValue = this.calculateCurrentPWM(elapsed);
+        this.setOutput(this.calculateCurrentPWM(elapsed));
 
         // Trigger frame update callback
         if (this.onFrameUpdate) {
@@ -203,7 +213,7 @@ export class PatternControl {
 
         this.isPlaying = false;
         this.isPaused = false;
-        this.currentPwmValue = 0; // Stop motor immediately
+        this.setOutput(0); // Stop motor immediately
 
         // Stop pattern update interval
         if (this.patternUpdateInterval) {
@@ -239,7 +249,7 @@ export class PatternControl {
 
         this.isPaused = true;
         this.pausedTime = Date.now();
-        this.currentPwmValue = 0; // Stop motor when paused
+        this.setOutput(0); // Stop motor when paused
 
         console.log(`[Pattern Control] Paused pattern playback`);
 
@@ -325,7 +335,8 @@ export class PatternControl {
         const pwmDiff = nextFrame.pwm - currentFrame.pwm;
         const timeProgress = (elapsed - currentFrame.time) / timeDiff;
 
-        return Math.round(currentFrame.pwm + (pwmDiff * timeProgress));
+        // Not rounded: the motor takes 0.01% steps, 40x finer than 0-255
+        return currentFrame.pwm + (pwmDiff * timeProgress);
     }
 
     /**
@@ -3,6 +3,8 @@
  * Handles manual touch/slider-based motor control (matches stream.js pattern)
  */
 
+import { MOTOR_DUTY, pwmToDuty, dutyToPwm } from '../utils/constants.js';
+
 // Initialize global touchValue for external access (matches stream.js)
 if (typeof window !== 'undefined') {
     window.touchValue = 0;
@@ -12,7 +14,8 @@ export class TouchControl {
     constructor(sdk) {
         this.sdk = sdk;
         this.isActive = false;
-        this.currentValue = 0;
+        this.currentValue = 0;     // 0-255
+        this.currentDuty = 0;      // 0-10000, what is written to the motor
         this.updateCallback = null;
         this.pwmInterval = null;
     }
@@ -40,51 +43,60 @@ export class TouchControl {
         // Set motor to 0 when stopping
         await this.sdk.motor.write(0);
         this.currentValue = 0;
+        this.currentDuty = 0;
         
         console.log('Touch Control stopped');
     }
 
     setValue(value) {
         // Only store value - no instant PWM writing (matches stream.js)
-        this.currentValue = Math.max(0, Math.min(255, Math.round(value)));
+        this.currentDuty = pwmToDuty(value);
+        this.currentValue = dutyToPwm(this.currentDuty);
         
-        // Update global touchValue for external access (matches stream.js)
+        // Update global touchValue for external access (matches stream.js), 0.01% steps
         if (typeof window !== 'undefined') {
-            window.touchValue = Math.round((this.currentValue / 255) * 100);
+            window.touchValue = this.currentDuty / 100;
         }
         
-        console.log(`Touch Control: Value set to ${this.currentValue} (${window.touchValue}%)`);
+        console.log(`Touch Control: Value set to ${this.currentValue} (${this.currentDuty / 100}%)`);
         return true;
     }
 
     setPercentage(percentage) {
         // Store percentage value - no instant PWM writing (matches stream.js)
-        const clampedPercentage = Math.max(0, Math.min(100, Math.round(percentage)));
-        this.currentValue = Math.round((clampedPercentage / 100) * 255);
+        // Fractions are kept: the motor takes 0.01% steps
+        const clampedPercentage = Math.max(0, Math.min(100, percentage));
+        this.currentDuty = this.percentageToDuty(clampedPercentage);
+        this.currentValue = dutyToPwm(this.currentDuty);
         
         // Update global touchValue for external access (matches stream.js)
         if (typeof window !== 'undefined') {
             window.touchValue = clampedPercentage;
         }
         
-        console.log(`Touch Control: Percentage set to ${clampedPercentage}% (PWM: ${this.currentValue})`);
+        console.log(`Touch Control: Percentage set to ${clampedPercentage}% (duty: ${this.currentDuty})`);
         return true;
     }
 
+    percentageToDuty(percentage) {
+        return Math.round(Math.max(0, Math.min(100, percentage)) * MOTOR_DUTY.MAX / 100);
+    }
+
     startPwmWriting() {
         // Write PWM every 100ms based on current touch value (matches stream.js)
         this.pwmInterval = setInterval(async () => {
             try {
                 // Read from global touchValue like stream.js
                 const touchValue = (typeof window !== 'undefined' && window.touchValue) || 0;
-                const pwmValue = Math.round((touchValue / 100) * 255);
+                const dutyCycle = this.percentageToDuty(touchValue);
                 
-                await this.sdk.motor.write(pwmValue);
-                this.currentValue = pwmValue;
+                await this.sdk.motor.writeDuty(dutyCycle);
+                this.currentDuty = dutyCycle;
+                this.currentValue = dutyToPwm(dutyCycle);
                 
-                // Trigger update callback
+                // Trigger update callback (0-255 value, then the duty cycle)
                 if (this.updateCallback) {
-                    this.updateCallback(pwmValue);
+                    this.updateCallback(this.currentValue, dutyCycle);
                 }
             } catch (error) {
                 console.error('Touch PWM writing error:', error);
@@ -107,7 +119,11 @@ export class TouchControl {
     }
 
     getPercentage() {
-        return Math.round((this.currentValue / 255) * 100);
+        return this.currentDuty / 100;
+    }
+
+    getDuty() {
+        return this.currentDuty;
     }
 
     setUpdateCallback(callback) {
@@ -4,9 +4,15 @@
  * Based on working test-real-api.html implementation
  */
 
+import { AUDIO_UPLOAD, encodeAudioUpload, newAudioStreamId } from '../utils/audio-upload.js';
+
 class ApiService {
     constructor(config = {}) {
         this.baseUrl = 'https://directaudiotopwm-qveg3gkwxa-ew.a.run.app';
+
+        // 'binary' frames raw PCM (utils/audio-upload.js); 'json' sends a
+        // number array. Falls back to JSON once if the server rejects binary.
+        this.uploadFormat = config.uploadFormat || 'binary';
         
         // Conversation state
         this.conversationState = {
@@ -43,25 +49,17 @@ class ApiService {
 
             console.log(`[API Call ${this.conversationState.totalApiCalls}] Processing speech segment: ${speechPacket.audioData.length} samples`);
 
-            // Prepare request body (matches working implementation)
-            const requestBody = {
-                msgHis: this.conversationState.history,
-                audioData: speechPacket.audioData, // Int16Array format
-                currentPwm: this.conversationState.currentPwm
+            const headers = {
+                'X-Processing-Mode': 'standard',
+                'X-Speech-Duration': speechPacket.duration?.toString() || '0'
             };
+            let response = await this.postSpeech(speechPacket, headers);
 
-            console.log(`[API] Request payload size: ${JSON.stringify(requestBody).length} bytes`);
-            console.log(`[API] Request structure: msgHis=${requestBody.msgHis.length}, audioData=${requestBody.audioData.length}, currentPwm=${requestBody.currentPwm}`);
-
-            const response = await fetch(this.baseUrl, {
-                method: 'POST',
-                headers: {
-                    'Content-Type': 'application/json',
-                    'X-Processing-Mode': 'standard',
-                    'X-Speech-Duration': speechPacket.duration?.toString() || '0'
-                },
-                body: JSON.stringify(requestBody)
-            });
+            if (this.uploadFormat === 'binary' && (response.status === 400 || response.status === 415)) {
+                console.warn(`[API] Binary upload rejected (${response.status}), falling back to JSON`);
+                this.uploadFormat = 'json';
+                response = await this.postSpeech(speechPacket, headers);
+            }
 
             console.log(`[API] Response Status: ${response.status} ${response.statusText}`);
 
@@ -119,6 +117,49 @@ class ApiService {
         }
     }
 
+    /**
+     * POST one speech packet in the current upload format
+     */
+    postSpeech(speechPacket, headers) {
+        const meta = {
+            msgHis: this.conversationState.history,
+            currentPwm: this.conversationState.currentPwm
+        };
+        // On-device text of the same speech; the server's decision cache is keyed on it
+        if (speechPacket.transcript) {
+            meta.transcript = speechPacket.transcript;
+        }
+        let body;
+
+        if (this.uploadFormat === 'binary') {
+            const pcm = speechPacket.audioData instanceof Int16Array
+                ? speechPacket.audioData
+                : Int16Array.from(speechPacket.audioData);
+            body = encodeAudioUpload({
+                streamId: newAudioStreamId(),
+                pcm: pcm,
+                sampleRate: speechPacket.sampleRate,
+                isFinal: speechPacket.isFinal !== false,
+                meta: meta
+            });
+            headers = { ...headers, 'Content-Type': AUDIO_UPLOAD.CONTENT_TYPE };
+        } else {
+            body = JSON.stringify({
+                ...meta,
+                audioData: Array.from(speechPacket.audioData)
+            });
+            headers = { ...headers, 'Content-Type': 'application/json' };
+        }
+
+        console.log(`[API] Request payload size: ${body.length} bytes (${this.uploadFormat}), msgHis=${meta.msgHis.length}, currentPwm=${meta.currentPwm}, transcript=${meta.transcript ? 'yes' : 'no'}`);
+
+        return fetch(this.baseUrl, {
+            method: 'POST',
+            headers: headers,
+            body: body
+        });
+    }
+
     /**
      * Update conversation state with API response
      */
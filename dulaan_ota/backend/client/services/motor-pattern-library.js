@@ -4,6 +4,7 @@
  */
 
 import { MOTOR_PATTERN_LIBRARY, PATTERN_CATEGORIES, PatternUtils } from '../utils/motor-patterns.js';
+import { encodePattern, decodePattern } from '../utils/pattern-codec.js';
 
 class MotorPatternLibrary {
     constructor() {
@@ -59,6 +60,29 @@ class MotorPatternLibrary {
         return false;
     }
 
+    /**
+     * Export a pattern in the binary format (utils/pattern-codec.js)
+     * @param {string} id - Pattern ID
+     * @param {Object} options - { meta: false } for the device form without names
+     * @returns {Uint8Array|null}
+     */
+    exportPattern(id, options = {}) {
+        const pattern = this.getPattern(id);
+        return pattern ? encodePattern(pattern, options) : null;
+    }
+
+    /**
+     * Add a pattern received in the binary format; it must carry its names
+     * (encoded with meta) to pass validation
+     * @param {Uint8Array|ArrayBuffer} bytes
+     * @returns {Object} the added pattern
+     */
+    importPattern(bytes) {
+        const pattern = decodePattern(bytes);
+        this.addPattern(pattern);
+        return this.patterns[pattern.id];
+    }
+
     /**
      * Get pattern library statistics
      */
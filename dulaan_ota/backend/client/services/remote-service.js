@@ -3,6 +3,9 @@
  * Handles peer-to-peer communication for remote motor control
  */
 
+import { MOTOR_DUTY } from '../utils/constants.js';
+import { RemoteSampleSender, JitterBuffer } from '../core/remote-stream.js';
+
 class RemoteService {
     constructor() {
         this.peer = null;
@@ -15,6 +18,13 @@ class RemoteService {
         this.isControlledByRemote = false;
         this.hostId = null;
         this.lastRemoteCommand = null;
+
+        // Motor samples are batched on the remote and played out through a
+        // jitter buffer per remote user on the host (core/remote-stream.js)
+        this.streamConfig = { batching: true };
+        this.sampleSender = null;
+        this.jitterBuffers = new Map();
+        this.hostAcceptsBatches = false;    // Older hosts only take control_command
         
         // PeerJS configuration
         this.peerConfig = {
@@ -71,10 +81,16 @@ class RemoteService {
                 this.handleRemoteCommand(data, conn.peer);
             });
 
+            // Tell the remote this host takes batched motor samples
+            conn.on('open', () => {
+                conn.send({ type: 'stream_hello', batching: true });
+            });
+
             conn.on('close', () => {
                 console.log('Remote user disconnected:', conn.peer);
                 this.connections.delete(conn.peer);
                 this.remoteUsers.delete(conn.peer);
+                this.dropJitterBuffer(conn.peer);
                 
                 if (this.remoteUsers.size === 0) {
                     this.isControlledByRemote = false;
@@ -119,6 +135,12 @@ class RemoteService {
                 }
             });
 
+            conn.on('data', (data) => {
+                if (data && data.type === 'stream_hello') {
+                    this.hostAcceptsBatches = data.batching === true;
+                }
+            });
+
             conn.on('error', (error) => {
                 console.log(`Failed to connect to host: ${error.message}`);
                 if (this.onConnectionStatusChange) {
@@ -131,6 +153,8 @@ class RemoteService {
                 this.isRemote = false;
                 this.hostId = null;
                 this.connections.delete(hostId);
+                this.hostAcceptsBatches = false;
+                this.stopSampleSender();
                 this.onConnectionDrop()
                 if (this.onConnectionStatusChange) {
                     this.onConnectionStatusChange(false);
@@ -155,15 +179,20 @@ class RemoteService {
             return false;
         }
 
-        // Validate motor commands
-        if (mode === 'motor') {
-            const pwm = Math.max(0, Math.min(255, Math.round(value)));
-            if (pwm !== value) {
-                console.log(`[REMOTE] Motor PWM value adjusted: ${value} → ${pwm}`);
-                value = pwm;
+        // Validate motor commands: 'motor' is 0-255, 'duty' is 0-10000
+        if (mode === 'motor' || mode === 'duty') {
+            const max = mode === 'duty' ? MOTOR_DUTY.MAX : MOTOR_DUTY.PWM_MAX;
+            const clamped = Math.max(0, Math.min(max, Math.round(value)));
+            if (clamped !== value) {
+                console.log(`[REMOTE] Motor ${mode} value adjusted: ${value} → ${clamped}`);
+                value = clamped;
             }
         }
 
+        if ((mode === 'motor' || mode === 'duty') && this.streamConfig.batching && this.hostAcceptsBatches) {
+            return this.queueMotorSample(mode, value);
+        }
+
         const command = {
             type: 'control_command',
             mode: mode,
@@ -188,6 +217,69 @@ class RemoteService {
         }
     }
 
+    /**
+     * Queue a motor sample for the next batch to the host
+     */
+    queueMotorSample(mode, value) {
+        const conn = this.connections.get(this.hostId);
+        if (!conn || !conn.open) {
+            console.warn('[REMOTE] ❌ No active connection to host');
+            return false;
+        }
+        if (!this.sampleSender) {
+            this.sampleSender = new RemoteSampleSender((packet) => {
+                const current = this.connections.get(this.hostId);
+                if (!current || !current.open) {
+                    return false;
+                }
+                current.send(packet);
+                return true;
+            }, this.streamConfig);
+        }
+        this.sampleSender.push(mode, value);
+        return true;
+    }
+
+    stopSampleSender() {
+        if (this.sampleSender) {
+            this.sampleSender.stop();
+            this.sampleSender = null;
+        }
+    }
+
+    /**
+     * Jitter buffer for one remote user; played samples reach onRemoteCommand
+     * as ordinary control commands
+     */
+    getJitterBuffer(fromUserId) {
+        let buffer = this.jitterBuffers.get(fromUserId);
+        if (!buffer) {
+            buffer = new JitterBuffer((sample) => {
+                const command = {
+                    type: 'control_command',
+                    mode: sample.mode,
+                    value: sample.value,
+                    seq: sample.seq,
+                    timestamp: Date.now()
+                };
+                this.lastRemoteCommand = { ...command, fromUser: fromUserId, receivedAt: command.timestamp };
+                if (this.onRemoteCommand) {
+                    this.onRemoteCommand(command, fromUserId);
+                }
+            }, this.streamConfig);
+            this.jitterBuffers.set(fromUserId, buffer);
+        }
+        return buffer;
+    }
+
+    dropJitterBuffer(fromUserId) {
+        const buffer = this.jitterBuffers.get(fromUserId);
+        if (buffer) {
+            buffer.stop();
+            this.jitterBuffers.delete(fromUserId);
+        }
+    }
+
     /**
      * Handle incoming remote command (when acting as host)
      */
@@ -196,6 +288,11 @@ class RemoteService {
             return;
         }
 
+        if (data && data.type === 'control_batch') {
+            this.getJitterBuffer(fromUserId).receive(data);
+            return;
+        }
+
         console.log(`Received remote command from ${fromUserId}: ${data.mode} = ${data.value}`);
         this.lastRemoteCommand = {
             ...data,
@@ -212,6 +309,10 @@ class RemoteService {
      * Disconnect from remote control
      */
     disconnect() {
+        this.stopSampleSender();
+        for (const fromUserId of [...this.jitterBuffers.keys()]) {
+            this.dropJitterBuffer(fromUserId);
+        }
         if (this.peer) {
             this.peer.destroy();
             this.peer = null;
@@ -222,6 +323,7 @@ class RemoteService {
         this.hostId = null;
         this.connections.clear();
         this.remoteUsers.clear();
+        this.hostAcceptsBatches = false;
         this.isControlledByRemote = false;
         this.lastRemoteCommand = null;
 
@@ -242,10 +344,35 @@ class RemoteService {
             isControlledByRemote: this.isControlledByRemote,
             hostId: this.hostId,
             connectedUsers: Array.from(this.remoteUsers),
-            lastRemoteCommand: this.lastRemoteCommand
+            lastRemoteCommand: this.lastRemoteCommand,
+            stream: this.getStreamStats()
+        };
+    }
+
+    /**
+     * Remote: batches sent; host: jitter buffer stats per remote user
+     */
+    getStreamStats() {
+        const receivers = {};
+        for (const [fromUserId, buffer] of this.jitterBuffers) {
+            receivers[fromUserId] = buffer.getStats();
+        }
+        return {
+            sender: this.sampleSender ? this.sampleSender.getStats() : null,
+            receivers: receivers
         };
     }
 
+    /**
+     * Configure batching and the jitter buffer
+     * { batching, batchMs, maxBatch, minDelayMs, maxDelayMs, jitterFactor };
+     * applies to senders and buffers created afterwards
+     */
+    setStreamConfig(config) {
+        this.streamConfig = { ...this.streamConfig, ...config };
+        this.stopSampleSender();
+    }
+
     /**
      * Get list of connected remote users (when host)
      */
@@ -0,0 +1,132 @@
+/**
+ * Advertising Status Test - Manufacturer data encoder/decoder
+ * Run with: node test-adv-status.js
+ *
+ * Checks the client codec against the firmware layout (vm_adv_status.h)
+ * and that the scan response stays within the 31-byte legacy budget.
+ */
+
+import { ADV_STATUS, encodeAdvStatus, decodeAdvStatus, findAdvStatus, parseScanResultStatus } from './utils/adv-status.js';
+
+class AdvStatusTest {
+    constructor() {
+        this.results = [];
+    }
+
+    addResult(test, success, details = '') {
+        this.results.push({ test, success, details });
+        console.log(`${success ? '✅' : '❌'} ${test}${details ? ': ' + details : ''}`);
+    }
+
+    hex(bytes) {
+        return Array.from(bytes, (b) => b.toString(16).padStart(2, '0')).join('');
+    }
+
+    /**
+     * Test 1: Encoder output matches vm_adv_status_encode() byte for byte
+     */
+    testFirmwareVector() {
+        // vm_adv_status_encode() with battery=85, fw 1.0, flags=BANK_B|MOTOR_ON
+        const expected = '08ffffffb155000103';
+        const ad = encodeAdvStatus({
+            batteryLevel: 85,
+            firmwareVersion: '1.0',
+            flags: ADV_STATUS.FLAG_BANK_B | ADV_STATUS.FLAG_MOTOR_ON
+        });
+        this.addResult('Firmware vector', this.hex(ad) === expected, this.hex(ad));
+    }
+
+    /**
+     * Test 2: Round trip over all battery values and flag combinations
+     */
+    testRoundTrip() {
+        let failures = 0;
+        for (let battery = 0; battery <= 100; battery++) {
+            for (let flags = 0; flags < 32; flags++) {
+                const ad = encodeAdvStatus({ batteryLevel: battery, firmwareVersion: '2.7', flags });
+                const st = findAdvStatus(ad);
+                if (!st || st.batteryLevel !== battery || st.firmwareVersion !== '2.7' || st.flags !== flags ||
+                    st.activeBank !== ((flags & 1) ? 'B' : 'A') || st.motorOn !== !!(flags & 2) ||
+                    st.otaActive !== !!(flags & 4) || st.batteryLow !== !!(flags & 8) ||
+                    st.powerLimited !== !!(flags & 16)) {
+                    failures++;
+                }
+            }
+        }
+        this.addResult('Round trip', failures === 0, `${101 * 32} cases, ${failures} failures`);
+
+        const unknown = findAdvStatus(encodeAdvStatus({ batteryLevel: null, firmwareVersion: '1.0' }));
+        this.addResult('Unknown battery', unknown && unknown.batteryLevel === null);
+    }
+
+    /**
+     * Test 3: Payload fits the 31-byte budget next to what the firmware also advertises
+     */
+    testBudget() {
+        const ad = encodeAdvStatus({ batteryLevel: 50, firmwareVersion: '1.0' });
+        this.addResult('AD size', ad.length === ADV_STATUS.AD_SIZE && ad[0] + 1 === ad.length, `${ad.length} bytes`);
+
+        // Scan response: status + room for a complete 128-bit service UUID list (18 bytes)
+        const scanRsp = ad.length + 18;
+        this.addResult('Scan response budget', scanRsp <= ADV_STATUS.ADV_BUDGET, `${scanRsp}/${ADV_STATUS.ADV_BUDGET} bytes`);
+
+        // Adv data in long range mode: flags (3) + name "VibMotor(BLE)" (15) + status
+        const advData = 3 + 2 + 'VibMotor(BLE)'.length + ad.length;
+        this.addResult('Adv data budget', advData <= ADV_STATUS.ADV_BUDGET, `${advData}/${ADV_STATUS.ADV_BUDGET} bytes`);
+    }
+
+    /**
+     * Test 4: Scan result shapes from Capacitor BLE and Web Bluetooth
+     */
+    testScanResults() {
+        const ad = encodeAdvStatus({ batteryLevel: 12, firmwareVersion: '1.3', flags: ADV_STATUS.FLAG_BATTERY_LOW });
+        const payload = new DataView(ad.buffer, 4);
+
+        const capacitor = parseScanResultStatus({ device: { name: 'VibMotor(BLE)' }, manufacturerData: { '65535': payload } });
+        this.addResult('Capacitor manufacturerData', capacitor && capacitor.batteryLevel === 12 && capacitor.batteryLow);
+
+        const web = parseScanResultStatus({ manufacturerData: new Map([[0xFFFF, payload]]) });
+        this.addResult('Web Bluetooth manufacturerData', web && web.firmwareVersion === '1.3');
+
+        // Raw scan record: name AD before ours, zero padding after
+        const name = [0x05, 0x09, 0x56, 0x69, 0x62, 0x4D];
+        const raw = new Uint8Array([...name, ...ad, 0, 0, 0]);
+        const fromRaw = parseScanResultStatus({ rawAdvertisement: new DataView(raw.buffer) });
+        this.addResult('Raw advertisement', fromRaw && fromRaw.batteryLevel === 12);
+    }
+
+    /**
+     * Test 5: Foreign or malformed data is rejected
+     */
+    testRejects() {
+        const foreign = encodeAdvStatus({ batteryLevel: 50, firmwareVersion: '1.0' });
+        foreign[2] = 0x4C; foreign[3] = 0x00; // Apple company ID
+        this.addResult('Foreign company ID', findAdvStatus(foreign) === null);
+
+        const wrongTag = encodeAdvStatus({ batteryLevel: 50, firmwareVersion: '1.0' });
+        wrongTag[4] = 0xB0;
+        this.addResult('Wrong tag', findAdvStatus(wrongTag) === null);
+
+        const truncated = encodeAdvStatus({ batteryLevel: 50, firmwareVersion: '1.0' }).subarray(0, 6);
+        this.addResult('Truncated structure', findAdvStatus(truncated) === null);
+
+        this.addResult('Short payload', decodeAdvStatus(new Uint8Array([ADV_STATUS.TAG, 50])) === null);
+        this.addResult('No status', parseScanResultStatus({ device: { name: 'Other' } }) === null);
+    }
+
+    run() {
+        this.testFirmwareVector();
+        this.testRoundTrip();
+        this.testBudget();
+        this.testScanResults();
+        this.testRejects();
+
+        const failed = this.results.filter((r) => !r.success).length;
+        console.log(`\n${this.results.length - failed}/${this.results.length} passed`);
+        if (typeof process !== 'undefined') {
+            process.exitCode = failed ? 1 : 0;
+        }
+    }
+}
+
+new AdvStatusTest().run();
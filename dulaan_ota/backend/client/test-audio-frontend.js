@@ -0,0 +1,417 @@
+/**
+ * Audio Front End Test - decoding, features, VAD and per-chunk benchmark
+ * Run with: node test-audio-frontend.js
+ *
+ * Feeds MockVoiceRecorder test patterns (1600-sample base64 Float32 chunks)
+ * through the audio front end, inline and in a worker thread, and checks
+ * the decoded samples, features, voice start/end and speech segments. Then
+ * measures time and heap allocation per chunk against the main-thread
+ * processing it replaces.
+ */
+
+import v8 from 'v8';
+import vm from 'vm';
+import { Worker } from 'worker_threads';
+import mockVoice from './mocks/mock-voice-recorder.js';
+import { AudioFrontEnd, AudioFrontEndRunner, audioFrontEndWorkerSource, AUDIO_FRAME_EVENT, AUDIO_FRONTEND_DEFAULTS } from './core/audio-frontend.js';
+import { StreamingProcessor } from './core/streaming-processor.js';
+
+const { MockVoiceRecorder } = mockVoice;
+
+const PATTERNS = ['silence', 'tone', 'speech', 'noise'];
+const BENCH_CHUNKS = 2000;      // Chunks per timing run
+const HEAP_CHUNKS = 200;        // Chunks per heap run
+const BENCH_RUNS = 5;           // Best of, JIT and GC noise only ever adds
+
+v8.setFlagsFromString('--expose-gc');
+const gc = vm.runInNewContext('gc');
+
+function delay(ms) {
+    return new Promise(resolve => setTimeout(resolve, ms));
+}
+
+// Decoding before the front end: atob, new Uint8Array and Float32Array per chunk
+function decodeReference(base64) {
+    const pureBase64 = base64.includes(',') ? base64.split(',')[1] : base64;
+    const binary = atob(pureBase64);
+    const bytes = new Uint8Array(binary.length);
+    for (let i = 0; i < binary.length; i++) {
+        bytes[i] = binary.charCodeAt(i);
+    }
+    const view = new DataView(bytes.buffer);
+    const floats = new Float32Array(bytes.length / 4);
+    for (let i = 0; i < floats.length; i++) {
+        floats[i] = view.getFloat32(i * 4, true);
+    }
+    return floats;
+}
+
+// Ring buffer before bulk writes: one modulo per sample
+class LegacyRingBuffer {
+    constructor(capacity) {
+        this.capacity = capacity;
+        this.buffer = new Float32Array(capacity);
+        this.writeIndex = 0;
+        this.count = 0;
+    }
+
+    push(data) {
+        for (let i = 0; i < data.length; i++) {
+            this.buffer[this.writeIndex] = data[i];
+            this.writeIndex = (this.writeIndex + 1) % this.capacity;
+            this.count = Math.min(this.count + 1, this.capacity);
+        }
+    }
+}
+
+// Per-chunk work of StreamingProcessor before the front end
+class LegacyProcessor {
+    constructor() {
+        this.vadBuffer = new LegacyRingBuffer(4800);
+        this.energyHistory = [];
+    }
+
+    process(base64) {
+        const pcm = decodeReference(base64);
+        this.vadBuffer.push(pcm);
+
+        let sum = 0;
+        for (let i = 0; i < pcm.length; i++) sum += pcm[i] * pcm[i];
+        const rms = Math.sqrt(sum / pcm.length);
+
+        let crossings = 0;
+        for (let i = 1; i < pcm.length; i++) {
+            if ((pcm[i] >= 0) !== (pcm[i - 1] >= 0)) crossings++;
+        }
+        const zcr = crossings / pcm.length;
+
+        this.energyHistory.push(rms);
+        if (this.energyHistory.length > 100) this.energyHistory.shift();
+        const avgEnergy = this.energyHistory.reduce((a, b) => a + b, 0) / this.energyHistory.length;
+        const adaptiveThreshold = Math.max(0.008, avgEnergy * 2);
+        return rms > 0.008 && ((zcr > 0.08 && zcr < 0.5) || rms > adaptiveThreshold * 1.5);
+    }
+}
+
+// worker_threads Worker with the browser Worker interface used by the runner
+function createThreadWorker() {
+    const thread = new Worker(audioFrontEndWorkerSource("require('worker_threads').parentPort"), { eval: true });
+    return {
+        thread,
+        postMessage: (msg) => thread.postMessage(msg),
+        addEventListener: (type, listener) => thread.on(type, (data) => listener({ data })),
+        terminate: () => thread.terminate()
+    };
+}
+
+class AudioFrontEndTest {
+    constructor() {
+        this.results = [];
+        this.consoleLog = console.log;
+        this.consoleWarn = console.warn;
+        this.consoleError = console.error;
+
+        this.mute();
+        this.recorder = new MockVoiceRecorder();
+        this.unmute();
+        this.chunks = {};
+        for (const pattern of PATTERNS) {
+            this.chunks[pattern] = this.recorder.arrayBufferToBase64(this.recorder.generateTestAudioPattern(pattern));
+        }
+
+        // The test patterns are identical chunks of low ZCR, which the
+        // adaptive threshold stops taking for voice after a few frames;
+        // utterances use a 1.2 kHz tone with a 5 Hz envelope instead
+        const voiced = new Float32Array(1600);
+        for (let i = 0; i < voiced.length; i++) {
+            const t = i / 16000;
+            voiced[i] = 0.15 * Math.sin(2 * Math.PI * 1200 * t) * (0.6 + 0.4 * Math.sin(2 * Math.PI * 5 * t));
+        }
+        this.chunks.voiced = this.recorder.arrayBufferToBase64(voiced.buffer);
+    }
+
+    addResult(test, success, details = '') {
+        this.results.push({ test, success, details });
+        this.consoleLog(`${success ? '✅' : '❌'} ${test}${details ? ': ' + details : ''}`);
+    }
+
+    // The processor logs every step; keep the output to results
+    mute() {
+        console.log = console.warn = console.error = () => {};
+    }
+
+    unmute() {
+        console.log = this.consoleLog;
+        console.warn = this.consoleWarn;
+        console.error = this.consoleError;
+    }
+
+    // An utterance: silence, speech, then enough silence to end it
+    utterance(speechChunks = 15) {
+        return [
+            ...Array(10).fill(this.chunks.silence),
+            ...Array(speechChunks).fill(this.chunks.voiced),
+            ...Array(AUDIO_FRONTEND_DEFAULTS.SILENCE_FRAMES + 5).fill(this.chunks.silence)
+        ];
+    }
+
+    /**
+     * Test 1: Decoding matches atob + DataView, including the slow paths
+     */
+    testDecode() {
+        const frontEnd = new AudioFrontEnd();
+        let mismatches = 0;
+        for (const pattern of PATTERNS) {
+            const expected = decodeReference(this.chunks[pattern]);
+            const n = frontEnd.decode(this.chunks[pattern]);
+            if (n !== expected.length) mismatches++;
+            for (let i = 0; i < n; i++) {
+                if (!Object.is(frontEnd.floats[i], expected[i])) mismatches++;
+            }
+        }
+        this.addResult('Decode matches atob', mismatches === 0, `${PATTERNS.length} patterns, ${mismatches} mismatches`);
+
+        const speech = decodeReference(this.chunks.speech);
+        const wrapped = this.chunks.speech.replace(/(.{76})/g, '$1\n');
+        const variants = [
+            ['data URL', 'data:audio/raw;base64,' + this.chunks.speech],
+            ['line breaks', wrapped]
+        ];
+        for (const [name, input] of variants) {
+            const n = frontEnd.decode(input);
+            this.addResult(`Decode ${name}`, n === speech.length && frontEnd.floats[n - 1] === speech[n - 1]);
+        }
+
+        // A chunk larger than the scratch buffer grows it once
+        const big = new Float32Array(4000).map((_, i) => Math.sin(i / 7));
+        const n = frontEnd.decode(this.recorder.arrayBufferToBase64(big.buffer));
+        this.addResult('Decode large chunk', n === 4000 && frontEnd.floats[3999] === big[3999], `${n} samples`);
+        this.addResult('Decode invalid input', frontEnd.decode('@@@@') === 0 && frontEnd.decodeErrors === 1);
+    }
+
+    /**
+     * Test 2: Single-pass features equal the separate passes
+     */
+    testFeatures() {
+        const frontEnd = new AudioFrontEnd();
+        let worst = 0;
+        for (const pattern of PATTERNS) {
+            const pcm = decodeReference(this.chunks[pattern]);
+            let sum = 0;
+            let crossings = 0;
+            let peak = 0;
+            for (let i = 0; i < pcm.length; i++) {
+                sum += pcm[i] * pcm[i];
+                peak = Math.max(peak, Math.abs(pcm[i]));
+                if (i > 0 && (pcm[i] >= 0) !== (pcm[i - 1] >= 0)) crossings++;
+            }
+            const f = frontEnd.analyze(this.chunks[pattern]);
+            worst = Math.max(worst,
+                Math.abs(f.rms - Math.sqrt(sum / pcm.length)),
+                Math.abs(f.zcr - crossings / pcm.length),
+                Math.abs(f.peak - peak));
+        }
+        this.addResult('Features match', worst < 1e-12, `max difference ${worst}`);
+    }
+
+    /**
+     * Test 3: Voice start and end, and the speech segment handed over
+     */
+    testVad() {
+        const c = AUDIO_FRONTEND_DEFAULTS;
+        const frontEnd = new AudioFrontEnd();
+        const events = [];
+        const segments = [];
+        this.utterance().forEach((chunk, index) => {
+            const frame = frontEnd.process(chunk);
+            if (frame.event !== AUDIO_FRAME_EVENT.NONE) events.push([frame.event, index]);
+            if (frame.segment) segments.push(frame.segment);
+        });
+
+        // Start on the third speech chunk, end after SILENCE_FRAMES of silence
+        const startAt = 10 + c.VOICE_FRAMES - 1;
+        const endAt = 10 + 15 + c.SILENCE_FRAMES - 1;
+        this.addResult('Voice start/end', events.length === 2 &&
+            events[0][0] === AUDIO_FRAME_EVENT.VOICE_START && events[0][1] === startAt &&
+            events[1][0] === AUDIO_FRAME_EVENT.VOICE_END && events[1][1] === endAt,
+            JSON.stringify(events));
+
+        // Pre-speech context (ending with the start chunk), the rest of the speech, post-speech context
+        const expected = c.PRE_SPEECH_SAMPLES + (15 - c.VOICE_FRAMES) * 1600 + c.POST_SPEECH_SAMPLES;
+        const segment = segments[0];
+        this.addResult('Speech segment', segments.length === 1 && segment.final && segment.pcm.length === expected,
+            `${segment ? segment.pcm.length : 0} samples, expected ${expected}`);
+
+        const speech = decodeReference(this.chunks.voiced);
+        const sample = segment ? segment.pcm[c.PRE_SPEECH_SAMPLES + 37] : 0;
+        this.addResult('Segment is 16-bit PCM', sample === Math.trunc(speech[37] * 32767), `${sample}`);
+
+        // A short blip is discarded
+        const blip = new AudioFrontEnd({ MIN_SPEECH_SAMPLES: 100000 });
+        let discarded = true;
+        this.utterance().forEach((chunk) => {
+            if (blip.process(chunk).segment) discarded = false;
+        });
+        this.addResult('Short speech discarded', discarded);
+
+        // Long speech is split, keeping an overlap
+        const long = new AudioFrontEnd({ MAX_SPEECH_SAMPLES: 16000 });
+        const parts = [];
+        this.utterance(40).forEach((chunk) => {
+            const frame = long.process(chunk);
+            if (frame.segment) parts.push(frame.segment);
+        });
+        const split = parts.filter(p => !p.final);
+        this.addResult('Long speech split', split.length >= 2 && parts[parts.length - 1].final &&
+            split.every(p => p.pcm.length >= 16000),
+            `${parts.length} segments: ${parts.map(p => p.pcm.length + (p.final ? ' final' : '')).join(', ')}`);
+    }
+
+    /**
+     * Test 4: StreamingProcessor turns frames into callbacks
+     */
+    async testProcessor() {
+        const processor = new StreamingProcessor({ useWorker: false });
+        const states = [];
+        const packets = [];
+        processor.setCallbacks({
+            onSpeechReady: (packet) => packets.push(packet),
+            onVoiceStateChange: (state) => states.push(state.isActive)
+        });
+
+        let lastResult = null;
+        for (const chunk of this.utterance()) {
+            lastResult = processor.processAudioChunk(chunk);
+        }
+        await delay(10);
+
+        const c = AUDIO_FRONTEND_DEFAULTS;
+        const expected = c.PRE_SPEECH_SAMPLES + (15 - c.VOICE_FRAMES) * 1600 + c.POST_SPEECH_SAMPLES;
+        this.addResult('Processor callbacks', states.join() === 'true,false' && packets.length === 1 &&
+            packets[0].audioData.length === expected && packets[0].isFinal,
+            `states ${states.join()}, ${packets.length} packet(s)`);
+        this.addResult('Processor result', processor.frontEnd.mode === 'inline' && lastResult &&
+            lastResult.isVoiceActive === false && lastResult.efficiency.totalChunks === this.utterance().length);
+    }
+
+    /**
+     * Test 5: The worker produces the same frames as the inline front end
+     */
+    async testWorker() {
+        const chunks = [...this.utterance(), ...this.utterance(40)];
+        const inline = [];
+        const inlineRunner = new AudioFrontEndRunner((frame) => {
+            inline.push({ ...frame, segment: frame.segment ? frame.segment.pcm.length : 0 });
+        }, { useWorker: false });
+        chunks.forEach((chunk) => inlineRunner.process(chunk));
+
+        const frames = [];
+        const worker = createThreadWorker();
+        const runner = new AudioFrontEndRunner((frame) => {
+            frames.push({ ...frame, segment: frame.segment ? frame.segment.pcm.length : 0 });
+        }, { worker });
+        chunks.forEach((chunk) => runner.process(chunk));
+
+        const deadline = Date.now() + 5000;
+        while (frames.length < chunks.length && Date.now() < deadline) {
+            await delay(10);
+        }
+        runner.terminate();
+
+        const same = frames.length === inline.length &&
+            frames.every((f, i) => JSON.stringify(f) === JSON.stringify(inline[i]));
+        const segments = frames.filter(f => f.segment).length;
+        this.addResult('Worker frames match inline', runner.mode === 'worker' && same,
+            `${frames.length}/${chunks.length} frames, ${segments} segments`);
+    }
+
+    /**
+     * Best time (ns) and heap bytes allocated per chunk; loop(n) processes n chunks
+     */
+    measure(loop) {
+        loop(BENCH_CHUNKS);     // Warm up the JIT
+
+        let ns = Infinity;
+        let bytes = Infinity;
+        for (let run = 0; run < BENCH_RUNS; run++) {
+            const start = process.hrtime.bigint();
+            loop(BENCH_CHUNKS);
+            ns = Math.min(ns, Number(process.hrtime.bigint() - start) / BENCH_CHUNKS);
+
+            gc();
+            const heapBefore = process.memoryUsage().heapUsed;
+            loop(HEAP_CHUNKS);
+            bytes = Math.min(bytes, Math.max(0, process.memoryUsage().heapUsed - heapBefore) / HEAP_CHUNKS);
+        }
+        return { ns, bytes };
+    }
+
+    report(name, m) {
+        // Capacitor delivers 10 chunks per second
+        this.consoleLog(`  ${name.padEnd(26)} ${(m.ns / 1000).toFixed(1).padStart(7)} us/chunk ${m.bytes.toFixed(0).padStart(7)} B/chunk ${(m.bytes * 10 / 1024).toFixed(1).padStart(6)} KB/s`);
+    }
+
+    /**
+     * Benchmark: main-thread cost per chunk
+     */
+    async benchmark() {
+        const stream = PATTERNS.map(p => this.chunks[p]);
+        const run = (process) => (n) => {
+            let voice = 0;
+            for (let i = 0; i < n; i++) {
+                if (process(stream[i & 3])) voice++;
+            }
+            return voice;
+        };
+
+        const legacy = new LegacyProcessor();
+        const frontEnd = new AudioFrontEnd();
+        let workerFrames = 0;
+        const worker = createThreadWorker();
+        const runner = new AudioFrontEndRunner(() => { workerFrames++; }, { worker });
+
+        this.consoleLog(`\nPer ${stream[0].length}-character chunk (1600 samples), best of ${BENCH_RUNS}:`);
+        const before = this.measure(run((chunk) => legacy.process(chunk)));
+        this.report('main thread, before', before);
+        const inline = this.measure(run((chunk) => frontEnd.process(chunk).voice));
+        this.report('front end, inline', inline);
+        const handOff = this.measure(run((chunk) => { runner.process(chunk); return false; }));
+        this.report('front end, worker hand-off', handOff);
+
+        // Let the worker drain what it was sent before stopping it
+        const posted = runner.posted;
+        const deadline = Date.now() + 10000;
+        while (workerFrames < posted && Date.now() < deadline) {
+            await delay(10);
+        }
+        runner.terminate();
+        this.consoleLog('');
+
+        this.addResult('Front end allocation per chunk', inline.bytes < 64, `${inline.bytes.toFixed(1)} B/chunk`);
+        this.addResult('Front end faster', inline.ns < before.ns, `${(before.ns / inline.ns).toFixed(1)}x`);
+        this.addResult('Worker processed every chunk', workerFrames === posted, `${workerFrames}/${posted}`);
+    }
+
+    async run() {
+        this.testDecode();
+        this.testFeatures();
+        this.testVad();
+
+        this.mute();
+        try {
+            await this.testProcessor();
+            await this.testWorker();
+            await this.benchmark();
+        } finally {
+            this.unmute();
+        }
+
+        const failed = this.results.filter((r) => !r.success).length;
+        console.log(`\n${this.results.length - failed}/${this.results.length} passed`);
+        if (typeof process !== 'undefined') {
+            process.exitCode = failed ? 1 : 0;
+        }
+    }
+}
+
+new AudioFrontEndTest().run();
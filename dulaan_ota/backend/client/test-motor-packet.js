@@ -0,0 +1,252 @@
+/**
+ * Motor Packet Test - 16-bit intensity path and write benchmark
+ * Run with: node test-motor-packet.js
+ *
+ * Checks that intensities reach the motor characteristic at the firmware
+ * resolution (uint16 duty cycle, 0.01% steps), then measures time and heap
+ * allocation per write for the reused DataView against the per-write
+ * Uint8Array and hex string encodings it replaces.
+ */
+
+import v8 from 'v8';
+import vm from 'vm';
+import mockBle from './mocks/mock-ble.js';
+import { MotorController } from './core/motor-controller.js';
+import { MOTOR_DUTY, pwmToDuty, dutyToPwm } from './utils/constants.js';
+
+const { MockBleClient } = mockBle;
+
+const DEVICE = 'MOCK_DEVICE_001';
+const BENCH_WRITES = 20000;     // Writes per timing run
+const HEAP_WRITES = 1000;       // Writes per heap run: no scavenge can run in between
+const BENCH_RUNS = 5;           // Best of, JIT and GC noise only ever adds
+
+v8.setFlagsFromString('--expose-gc');
+const gc = vm.runInNewContext('gc');
+
+function delay(ms) {
+    return new Promise(resolve => setTimeout(resolve, ms));
+}
+
+// Encoding before the 16-bit path: new Uint8Array and DataView per write
+function encodeAllocating(dutyCycle) {
+    const packet = new Uint8Array(2);
+    const duty = Math.max(0, Math.min(10000, Math.round(dutyCycle)));
+    packet[0] = duty & 0xFF;
+    packet[1] = (duty >> 8) & 0xFF;
+    return new DataView(packet.buffer);
+}
+
+// Hex string round trip (decimalToHexString + hexStringToDataView)
+function encodeHexString(dutyCycle) {
+    const duty = Math.max(0, Math.min(10000, Math.round(dutyCycle)));
+    const byteHex = (b) => {
+        const hex = b.toString(16).toUpperCase();
+        return hex.length === 1 ? '0' + hex : hex;
+    };
+    const hexString = byteHex(duty & 0xFF) + byteHex(duty >> 8);
+    const bytes = new Uint8Array(hexString.length / 2);
+    for (let i = 0; i < hexString.length; i += 2) {
+        bytes[i / 2] = parseInt(hexString.substr(i, 2), 16);
+    }
+    return new DataView(bytes.buffer);
+}
+
+class MotorPacketTest {
+    constructor() {
+        this.results = [];
+        this.consoleLog = console.log;
+        this.consoleWarn = console.warn;
+        this.consoleError = console.error;
+    }
+
+    addResult(test, success, details = '') {
+        this.results.push({ test, success, details });
+        this.consoleLog(`${success ? '✅' : '❌'} ${test}${details ? ': ' + details : ''}`);
+    }
+
+    // The controller and the mock log every step; keep the output to results
+    mute() {
+        console.log = console.warn = console.error = () => {};
+    }
+
+    unmute() {
+        console.log = this.consoleLog;
+        console.warn = this.consoleWarn;
+        console.error = this.consoleError;
+    }
+
+    /**
+     * Test 1: Packet layout matches the firmware (uint16 little-endian)
+     */
+    testPacket() {
+        const motor = new MotorController();
+        let failures = 0;
+        for (let duty = 0; duty <= MOTOR_DUTY.MAX; duty++) {
+            const view = motor.buildPacket(duty);
+            if (view.byteLength !== 2 || view.getUint16(0, true) !== duty ||
+                view.getUint8(0) !== (duty & 0xFF) || view.getUint8(1) !== (duty >> 8)) {
+                failures++;
+            }
+        }
+        this.addResult('Packet layout', failures === 0, `${MOTOR_DUTY.MAX + 1} duty values, ${failures} failures`);
+
+        const clamped = [motor.buildPacket(-5).getUint16(0, true), motor.buildPacket(12345).getUint16(0, true)];
+        this.addResult('Packet clamps', clamped[0] === 0 && clamped[1] === MOTOR_DUTY.MAX, clamped.join(', '));
+
+        this.addResult('Packet buffer reused', motor.buildPacket(1) === motor.buildPacket(2));
+    }
+
+    /**
+     * Test 2: Scale conversions keep the fractions of the 0-255 scale
+     */
+    testConversions() {
+        this.addResult('pwmToDuty ends', pwmToDuty(0) === 0 && pwmToDuty(255) === MOTOR_DUTY.MAX);
+        this.addResult('pwmToDuty fractions', pwmToDuty(127.5) === 5000 && pwmToDuty(127) !== pwmToDuty(127.3),
+            `127 -> ${pwmToDuty(127)}, 127.3 -> ${pwmToDuty(127.3)}, 127.5 -> ${pwmToDuty(127.5)}`);
+
+        let worst = 0;
+        for (let pwm = 0; pwm <= 255; pwm++) {
+            worst = Math.max(worst, Math.abs(dutyToPwm(pwmToDuty(pwm)) - pwm));
+        }
+        this.addResult('0-255 round trip', worst === 0, `max error ${worst}`);
+    }
+
+    /**
+     * Test 3: Every duty step reaches the mock device, not just 256 of them
+     */
+    async testResolution() {
+        const ble = new MockBleClient();
+        globalThis.window = { BleClient: ble };
+        const motor = new MotorController();
+        await ble.initialize();
+        await motor.connect(DEVICE);
+        ble.writeDelayMs = 0;
+        motor.setWriteInterval(7.5);
+
+        // A slow ramp over 0.5% of the range, one step per write
+        const sent = [];
+        for (let duty = 4000; duty < 4050; duty++) {
+            await motor.writeDuty(duty);
+            sent.push(duty);
+            await delay(10);
+        }
+        await delay(20);
+
+        const written = ble.writeLog
+            .filter(w => w.characteristicUuid === motor.MOTOR_CONTROL_CHAR_UUID)
+            .map(w => w.bytes[0] | (w.bytes[1] << 8));
+        const distinct = new Set(written).size;
+        // The same ramp on the 0-255 scale collapses to a couple of values
+        const legacy = new Set(sent.map(d => pwmToDuty(Math.round(dutyToPwm(d))))).size;
+        this.addResult('Duty steps delivered', distinct === sent.length && written[written.length - 1] === 4049,
+            `${distinct}/${sent.length} distinct duty values written (0-255 scale: ${legacy})`);
+
+        await motor.writeDuty(NaN);
+        await delay(20);
+        this.addResult('Invalid duty ignored', motor.getWriteStats().lastSent === 4049);
+
+        await motor.disconnect();
+    }
+
+    /**
+     * Best time (ns) and heap bytes allocated per write; loop(n) does n writes
+     */
+    async measure(loop) {
+        await loop(BENCH_WRITES);       // Warm up the JIT
+
+        let ns = Infinity;
+        let bytes = Infinity;
+        for (let run = 0; run < BENCH_RUNS; run++) {
+            const start = process.hrtime.bigint();
+            await loop(BENCH_WRITES);
+            ns = Math.min(ns, Number(process.hrtime.bigint() - start) / BENCH_WRITES);
+
+            gc();
+            const heapBefore = process.memoryUsage().heapUsed;
+            await loop(HEAP_WRITES);
+            bytes = Math.min(bytes, Math.max(0, process.memoryUsage().heapUsed - heapBefore) / HEAP_WRITES);
+        }
+        return { ns, bytes };
+    }
+
+    report(name, m, note = '') {
+        this.consoleLog(`  ${name.padEnd(22)} ${m.ns.toFixed(1).padStart(7)} ns/write ${m.bytes.toFixed(1).padStart(7)} B/write${note}`);
+    }
+
+    /**
+     * Benchmark: encoding and the full local write
+     */
+    async benchmark() {
+        const motor = new MotorController();
+        const encoders = [
+            ['hex string', encodeHexString],
+            ['Uint8Array per write', encodeAllocating],
+            ['reused DataView', (duty) => motor.buildPacket(duty)]
+        ];
+
+        this.consoleLog(`\nPer write, best of ${BENCH_RUNS}:`);
+        const measured = {};
+        for (const [name, encode] of encoders) {
+            measured[name] = await this.measure((n) => {
+                let sink = 0;
+                for (let i = 0; i < n; i++) {
+                    sink += encode(i % 10001).byteLength;
+                }
+                return sink;
+            });
+            this.report(name, measured[name]);
+        }
+        const reused = measured['reused DataView'];
+        this.addResult('Reused DataView allocates nothing', reused.bytes < 4, `${reused.bytes.toFixed(2)} B/write`);
+        this.addResult('Reused DataView faster', reused.ns < measured['Uint8Array per write'].ns && reused.ns < measured['hex string'].ns);
+
+        // Full writeToLocalBLE() with a stack that takes the packet at once
+        let last = null;
+        globalThis.window = {
+            BleClient: {
+                writeWithoutResponse: async (address, service, characteristic, view) => {
+                    last = view.getUint16(0, true);
+                }
+            }
+        };
+        motor.isConnected = true;
+        motor.deviceAddress = DEVICE;
+
+        const local = await this.measure(async (n) => {
+            for (let i = 0; i < n; i++) {
+                await motor.writeToLocalBLE(i % 10001);
+            }
+        });
+        this.report('writeToLocalBLE()', local, ' (async call overhead)');
+        this.consoleLog('');
+        this.addResult('Local write delivers the duty', last === (HEAP_WRITES - 1) % 10001);
+    }
+
+    async run() {
+        this.testPacket();
+        this.testConversions();
+
+        this.mute();
+        try {
+            await this.testResolution();
+        } finally {
+            this.unmute();
+        }
+
+        this.mute();
+        try {
+            await this.benchmark();
+        } finally {
+            this.unmute();
+        }
+
+        const failed = this.results.filter((r) => !r.success).length;
+        console.log(`\n${this.results.length - failed}/${this.results.length} passed`);
+        if (typeof process !== 'undefined') {
+            process.exitCode = failed ? 1 : 0;
+        }
+    }
+}
+
+new MotorPacketTest().run();
@@ -0,0 +1,258 @@
+/**
+ * Motor Write Scheduler Test - MotorController writes through MockBleClient
+ * Run with: node test-motor-scheduler.js
+ *
+ * Drives MotorController.write() the way the control modes do (several
+ * timers at once) and checks what reaches the mock BLE stack: write count,
+ * no duplicates, latest value wins, one write in flight, staleness bound,
+ * and that the write-rate history stays within its window.
+ */
+
+import mockBle from './mocks/mock-ble.js';
+import { MotorController } from './core/motor-controller.js';
+import { WRITE_SCHEDULER_DEFAULTS } from './core/motor-scheduler.js';
+
+const { MockBleClient } = mockBle;
+
+const DEVICE = 'MOCK_DEVICE_001';
+const TIMER_SLACK_MS = 25;  // setTimeout lateness tolerated on a loaded machine
+
+function delay(ms) {
+    return new Promise(resolve => setTimeout(resolve, ms));
+}
+
+function pwmToDuty(pwm) {
+    return Math.round((pwm / 255) * 10000);
+}
+
+class MotorSchedulerTest {
+    constructor() {
+        this.results = [];
+        this.ble = null;
+        this.motor = null;
+        this.consoleLog = console.log;
+        this.consoleWarn = console.warn;
+        this.consoleError = console.error;
+    }
+
+    addResult(test, success, details = '') {
+        this.results.push({ test, success, details });
+        this.consoleLog(`${success ? '✅' : '❌'} ${test}${details ? ': ' + details : ''}`);
+    }
+
+    // The controller and the mock log every step; keep the output to results
+    mute() {
+        console.log = console.warn = console.error = () => {};
+    }
+
+    unmute() {
+        console.log = this.consoleLog;
+        console.warn = this.consoleWarn;
+        console.error = this.consoleError;
+    }
+
+    motorWrites() {
+        return this.ble.writeLog
+            .filter(w => w.characteristicUuid === this.motor.MOTOR_CONTROL_CHAR_UUID)
+            .map(w => w.bytes[0] | (w.bytes[1] << 8));
+    }
+
+    clearWrites() {
+        this.ble.writeLog = [];
+        this.ble.maxWritesInFlight = 0;
+        this.motor.writeScheduler.resetStats();
+    }
+
+    checkCounters(name) {
+        const s = this.motor.getWriteStats();
+        const accounted = s.sent + s.superseded + s.suppressed + s.failed + (s.pending === null ? 0 : 1);
+        this.addResult(`${name}: counters add up`, accounted === s.submitted,
+            `submitted=${s.submitted} sent=${s.sent} superseded=${s.superseded} suppressed=${s.suppressed} failed=${s.failed}`);
+    }
+
+    async setup() {
+        this.ble = new MockBleClient();
+        globalThis.window = { BleClient: this.ble };
+        this.motor = new MotorController();
+        await this.ble.initialize();
+        return this.motor.connect(DEVICE);
+    }
+
+    /**
+     * Test 1: Repeating the same value sends it once
+     */
+    async testDuplicates() {
+        this.clearWrites();
+        for (let i = 0; i < 50; i++) {
+            await this.motor.write(128);
+        }
+        await delay(50);
+
+        const writes = this.motorWrites();
+        this.addResult('Duplicates suppressed', writes.length === 1 && writes[0] === pwmToDuty(128),
+            `50 calls -> ${writes.length} write(s)`);
+        this.checkCounters('Duplicates');
+    }
+
+    /**
+     * Test 2: A synchronous burst collapses to the first and the last value
+     */
+    async testBurst() {
+        this.clearWrites();
+        for (let pwm = 0; pwm <= 255; pwm++) {
+            this.motor.write(pwm);
+        }
+        await delay(100);
+
+        const writes = this.motorWrites();
+        this.addResult('Burst coalesced', writes.length <= 2 && writes[writes.length - 1] === pwmToDuty(255),
+            `256 calls -> ${writes.length} write(s), last=${writes[writes.length - 1]}`);
+        this.checkCounters('Burst');
+    }
+
+    /**
+     * Test 3: Overlapping mode timers (ambient 100 ms, pattern 50 ms, touch 16 ms)
+     */
+    async testConcurrentModes() {
+        const durationMs = 2000;
+        const intervalMs = this.motor.getWriteStats().intervalMs;
+        let lastPwm = 0;
+        let n = 0;
+        const produce = (step) => () => {
+            n++;
+            lastPwm = (n * step) % 256;
+            this.motor.write(lastPwm);
+        };
+
+        this.clearWrites();
+        const start = Date.now();
+        const timers = [
+            setInterval(produce(37), 100),
+            setInterval(produce(11), 50),
+            setInterval(produce(3), 16)
+        ];
+        await delay(durationMs);
+        timers.forEach(clearInterval);
+        const elapsed = Date.now() - start;
+        const stats = this.motor.getWriteStats();
+        await delay(50);
+
+        const writes = this.motorWrites();
+        const maxWrites = Math.ceil(elapsed / intervalMs) + 2;    // First write is immediate, one more may follow the last call
+        this.addResult('Write count bounded', writes.length <= maxWrites && writes.length < stats.submitted,
+            `${stats.submitted} calls -> ${writes.length} writes (limit ${maxWrites})`);
+
+        const repeats = writes.filter((d, i) => i > 0 && d === writes[i - 1]).length;
+        this.addResult('No repeated duty', repeats === 0, `${repeats} repeats`);
+
+        this.addResult('Latest value wins', writes[writes.length - 1] === pwmToDuty(lastPwm),
+            `last write=${writes[writes.length - 1]}, last requested=${pwmToDuty(lastPwm)}`);
+
+        this.addResult('One write in flight', this.ble.maxWritesInFlight === 1,
+            `max in flight=${this.ble.maxWritesInFlight}`);
+
+        const bound = Math.max(intervalMs, this.ble.writeDelayMs) + TIMER_SLACK_MS;
+        this.addResult('Staleness bounded', stats.staleness.max <= bound,
+            `avg ${stats.staleness.avg.toFixed(1)} ms, max ${stats.staleness.max.toFixed(1)} ms (limit ${bound} ms)`);
+
+        const expectedRate = stats.sent * 1000 / elapsed;
+        this.addResult('Write rate reported', Math.abs(stats.writesPerSecond - expectedRate) <= expectedRate * 0.2,
+            `${stats.writesPerSecond.toFixed(1)}/s reported, ${expectedRate.toFixed(1)}/s measured`);
+        this.checkCounters('Concurrent modes');
+    }
+
+    /**
+     * Test 4: A stack slower than the interval paces the writes instead of queuing
+     */
+    async testSlowStack() {
+        const durationMs = 1000;
+        this.ble.writeDelayMs = 40;
+        this.clearWrites();
+
+        let pwm = 0;
+        const timer = setInterval(() => {
+            pwm = (pwm + 7) % 256;
+            this.motor.write(pwm);
+        }, 5);
+        await delay(durationMs);
+        clearInterval(timer);
+        const stats = this.motor.getWriteStats();
+        await delay(100);
+
+        const writes = this.motorWrites();
+        const maxWrites = Math.ceil(durationMs / this.ble.writeDelayMs) + 2;
+        this.addResult('Slow stack paced', writes.length <= maxWrites && this.ble.maxWritesInFlight === 1,
+            `${writes.length} writes (limit ${maxWrites}), max in flight=${this.ble.maxWritesInFlight}`);
+
+        const bound = this.ble.writeDelayMs + TIMER_SLACK_MS;
+        this.addResult('Slow stack staleness', stats.staleness.max <= bound,
+            `max ${stats.staleness.max.toFixed(1)} ms (limit ${bound} ms), write latency avg ${stats.writeLatency.avg.toFixed(1)} ms`);
+        this.addResult('Slow stack latest value', writes[writes.length - 1] === pwmToDuty(pwm));
+        this.ble.writeDelayMs = 5;
+    }
+
+    /**
+     * Test 5: After a reconnect the last value is sent again
+     */
+    async testReconnect() {
+        this.clearWrites();
+        this.motor.write(200);
+        await delay(50);
+
+        this.ble.simulateDisconnect(DEVICE);
+        await this.motor.connect(DEVICE);
+        this.motor.write(200);
+        await delay(50);
+
+        const writes = this.motorWrites();
+        this.addResult('Resent after reconnect', writes.length === 2 && writes[1] === pwmToDuty(200),
+            `${writes.length} write(s)`);
+    }
+
+    /**
+     * Test 6: Send times are trimmed to the rate window as writes go out, not only by getStats()
+     */
+    async testSendTimesBounded() {
+        const scheduler = this.motor.writeScheduler;
+        this.clearWrites();
+        const old = performance.now() - 2 * WRITE_SCHEDULER_DEFAULTS.RATE_WINDOW_MS;
+        for (let i = 0; i < 10000; i++) {
+            scheduler.sendTimes.push(old + i * 0.1);
+        }
+        for (let pwm = 1; pwm <= 5; pwm++) {
+            this.motor.write(pwm * 40);
+            await delay(30);
+        }
+
+        const kept = scheduler.sendTimes.length;
+        this.addResult('Send times bounded without getStats', kept === this.motorWrites().length,
+            `${kept} kept of 10000 old + ${this.motorWrites().length} sent`);
+    }
+
+    async run() {
+        this.mute();
+        try {
+            if (!await this.setup()) {
+                this.addResult('Connect to mock', false);
+            } else {
+                await this.testDuplicates();
+                await this.testBurst();
+                await this.testConcurrentModes();
+                await this.testSlowStack();
+                await this.testReconnect();
+                await this.testSendTimesBounded();
+            }
+            await this.motor.disconnect();
+        } finally {
+            this.unmute();
+        }
+
+        const failed = this.results.filter((r) => !r.success).length;
+        console.log(`\n${this.results.length - failed}/${this.results.length} passed`);
+        if (typeof process !== 'undefined') {
+            process.exitCode = failed ? 1 : 0;
+        }
+    }
+}
+
+new MotorSchedulerTest().run();
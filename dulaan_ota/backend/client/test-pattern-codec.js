@@ -0,0 +1,203 @@
+/**
+ * Pattern Codec Test - Binary pattern format encoder/decoder
+ * Run with: node test-pattern-codec.js
+ *
+ * Round-trips every built-in pattern, checks the encoder against the
+ * firmware codec (vm_pattern.h), the CRC and malformed input, and reports
+ * the encoded size against the JSON form.
+ */
+
+import { MOTOR_PATTERN_LIBRARY } from './utils/motor-patterns.js';
+import { PATTERN_CODEC, encodePattern, decodePattern, patternCrc16 } from './utils/pattern-codec.js';
+import { MotorPatternLibrary } from './services/motor-pattern-library.js';
+
+class PatternCodecTest {
+    constructor() {
+        this.results = [];
+        this.consoleLog = console.log;
+    }
+
+    addResult(test, success, details = '') {
+        this.results.push({ test, success, details });
+        this.consoleLog(`${success ? '✅' : '❌'} ${test}${details ? ': ' + details : ''}`);
+    }
+
+    hex(bytes) {
+        return Array.from(bytes, (b) => b.toString(16).padStart(2, '0')).join('');
+    }
+
+    sameFrames(a, b) {
+        return a.length === b.length && a.every((f, i) => f.time === b[i].time && f.pwm === b[i].pwm);
+    }
+
+    expectThrow(name, fn, pattern) {
+        try {
+            fn();
+            this.addResult(name, false, 'accepted');
+        } catch (error) {
+            this.addResult(name, pattern.test(error.message), error.message);
+        }
+    }
+
+    /**
+     * Test 1: Every built-in pattern survives a round trip, with and without meta
+     */
+    testBuiltInRoundTrip() {
+        const failures = [];
+        for (const pattern of Object.values(MOTOR_PATTERN_LIBRARY)) {
+            const full = decodePattern(encodePattern(pattern));
+            const bare = decodePattern(encodePattern(pattern, { meta: false }));
+            const metaOk = PATTERN_CODEC.META_FIELDS.every((f) => full[f] === pattern[f]);
+            if (!this.sameFrames(full.frames, pattern.frames) || !this.sameFrames(bare.frames, pattern.frames) ||
+                full.duration !== pattern.duration || full.loop !== pattern.loop || bare.loop !== pattern.loop ||
+                !metaOk || bare.name !== undefined) {
+                failures.push(pattern.id);
+            }
+        }
+        this.addResult('Built-in patterns round trip', failures.length === 0,
+            failures.length ? failures.join(', ') : `${Object.keys(MOTOR_PATTERN_LIBRARY).length} patterns`);
+    }
+
+    /**
+     * Test 2: Encoder output matches vm_pattern_encode() byte for byte
+     */
+    testFirmwareVector() {
+        // vm_pattern_encode() with the gentle_waves frames, 10000 ms, VM_PATTERN_FLAG_LOOP
+        const expected = '44500101904e0b0066d10f6601d10f6501d10f6600d00f65d00f0059f7';
+        const bytes = encodePattern(MOTOR_PATTERN_LIBRARY.gentle_waves, { meta: false });
+        this.addResult('Firmware vector', this.hex(bytes) === expected, this.hex(bytes));
+        this.addResult('CRC matches SDK CRC16()', patternCrc16(new TextEncoder().encode('123456789')) === 0x31C3);
+    }
+
+    /**
+     * Test 3: Holds and ramps collapse into runs
+     */
+    testRuns() {
+        const hold = encodePattern(MOTOR_PATTERN_LIBRARY.meditation_flow, { meta: false });
+        const frames = [];
+        for (let i = 0; i <= 100; i++) frames.push({ time: i * 50, pwm: Math.min(255, i * 2) });
+        const ramp = encodePattern({ duration: 5000, loop: false, frames }, { meta: false });
+        this.addResult('Hold encodes as one run', hold.length <= 16, `11 frames in ${hold.length} bytes`);
+        this.addResult('Ramp encodes as one run', ramp.length <= 16 && this.sameFrames(decodePattern(ramp).frames, frames),
+            `101 frames in ${ramp.length} bytes`);
+    }
+
+    /**
+     * Test 4: Random patterns, including long gaps and repeated times
+     */
+    testRandomRoundTrip() {
+        let seed = 42;
+        const random = () => (seed = (seed * 1103515245 + 12345) >>> 0) / 4294967296;
+        const steps = [0, 20, 1000, 70000, 3000000];
+        let failures = 0;
+        for (let k = 0; k < 500; k++) {
+            const frames = [];
+            let time = 0;
+            let pwm = Math.floor(random() * 256);
+            const count = 1 + Math.floor(random() * 80);
+            for (let i = 0; i < count; i++) {
+                if (random() < 0.5) pwm = Math.floor(random() * 256);
+                time += steps[Math.floor(random() * steps.length)];
+                frames.push({ time, pwm });
+            }
+            const decoded = decodePattern(encodePattern({ duration: time, loop: random() < 0.5, frames }));
+            if (!this.sameFrames(decoded.frames, frames) || decoded.duration !== time) failures++;
+        }
+        this.addResult('Random patterns round trip', failures === 0, `${failures}/500 failed`);
+    }
+
+    /**
+     * Test 5: Corrupt, truncated and invalid input is rejected
+     */
+    testRejects() {
+        const bytes = encodePattern(MOTOR_PATTERN_LIBRARY.power_pulse);
+        let flipped = 0;
+        for (let i = 0; i < bytes.length; i++) {
+            for (let bit = 0; bit < 8; bit++) {
+                const copy = bytes.slice();
+                copy[i] ^= 1 << bit;
+                try {
+                    decodePattern(copy);
+                } catch (error) {
+                    flipped++;
+                }
+            }
+        }
+        this.addResult('Every single-bit error detected', flipped === bytes.length * 8, `${flipped}/${bytes.length * 8}`);
+        this.expectThrow('Truncated pattern rejected', () => decodePattern(bytes.subarray(0, bytes.length - 3)), /CRC|truncated/);
+        this.expectThrow('Unknown version rejected', () => {
+            const copy = bytes.slice();
+            copy[2] = 2;
+            decodePattern(copy);
+        }, /version/);
+        this.expectThrow('Reserved 16-bit flag rejected', () => {
+            const copy = encodePattern(MOTOR_PATTERN_LIBRARY.power_pulse, { meta: false });
+            copy[3] |= PATTERN_CODEC.FLAG_PWM16;
+            const crc = patternCrc16(copy, copy.length - 2);
+            copy[copy.length - 2] = crc & 0xFF;
+            copy[copy.length - 1] = crc >> 8;
+            decodePattern(copy);
+        }, /16-bit/);
+        this.expectThrow('Out-of-range pwm rejected', () => encodePattern({ duration: 10, frames: [{ time: 0, pwm: 300 }] }), /pwm/);
+        this.expectThrow('Backwards time rejected', () => encodePattern({ duration: 10, frames: [{ time: 5, pwm: 1 }, { time: 2, pwm: 1 }] }), /backwards/);
+    }
+
+    /**
+     * Test 6: Library export and import
+     */
+    testLibrary() {
+        const source = new MotorPatternLibrary();
+        const target = new MotorPatternLibrary();
+        const bytes = source.exportPattern('gentle_waves');
+        delete target.patterns.gentle_waves;
+        console.log = () => {};
+        const imported = target.importPattern(bytes);
+        console.log = this.consoleLog;
+        this.addResult('Library export/import', imported.name === 'Gentle Waves' &&
+            this.sameFrames(imported.frames, MOTOR_PATTERN_LIBRARY.gentle_waves.frames) &&
+            source.exportPattern('missing') === null);
+    }
+
+    /**
+     * Size report: binary against the JSON a library sync would send
+     */
+    reportSizes() {
+        this.consoleLog('\nEncoded size per pattern (bytes):');
+        this.consoleLog('  pattern                 frames    JSON  JSON frames  binary  binary, no meta');
+        let json = 0;
+        let jsonFrames = 0;
+        let binary = 0;
+        let bare = 0;
+        for (const pattern of Object.values(MOTOR_PATTERN_LIBRARY)) {
+            const j = new TextEncoder().encode(JSON.stringify(pattern)).length;
+            const jf = JSON.stringify(pattern.frames).length;
+            const b = encodePattern(pattern).length;
+            const n = encodePattern(pattern, { meta: false }).length;
+            json += j;
+            jsonFrames += jf;
+            binary += b;
+            bare += n;
+            this.consoleLog(`  ${pattern.id.padEnd(22)} ${String(pattern.frames.length).padStart(7)} ${String(j).padStart(7)} ${String(jf).padStart(12)} ${String(b).padStart(7)} ${String(n).padStart(16)}`);
+        }
+        this.consoleLog(`  ${'library'.padEnd(22)} ${''.padStart(7)} ${String(json).padStart(7)} ${String(jsonFrames).padStart(12)} ${String(binary).padStart(7)} ${String(bare).padStart(16)}\n`);
+
+        this.addResult('Binary smaller than JSON', binary * 2 < json && bare * 5 < jsonFrames,
+            `library ${binary} vs ${json} bytes with names, frames ${bare} vs ${jsonFrames} bytes`);
+    }
+
+    run() {
+        this.testBuiltInRoundTrip();
+        this.testFirmwareVector();
+        this.testRuns();
+        this.testRandomRoundTrip();
+        this.testRejects();
+        this.testLibrary();
+        this.reportSizes();
+
+        const failed = this.results.filter(r => !r.success).length;
+        console.log(`\n${this.results.length - failed}/${this.results.length} passed`);
+        process.exitCode = failed ? 1 : 0;
+    }
+}
+
+new PatternCodecTest().run();
@@ -0,0 +1,294 @@
+/**
+ * Remote Stream Test - Two RemoteService peers over a simulated link
+ * Run with: node test-remote-stream.js
+ *
+ * A remote and a host RemoteService run in-process; the data channel is
+ * replaced by a link with configurable delay, jitter and loss. The remote
+ * sends a duty ramp every 20 ms the way MotorController does, and the
+ * host records what reaches onRemoteCommand. Per-sample sending (applied
+ * on arrival) is compared against batches through the jitter buffer.
+ */
+
+import { RemoteService } from './services/remote-service.js';
+import { JitterBuffer, streamNow } from './core/remote-stream.js';
+
+const HOST_ID = 'HOST01';
+const REMOTE_ID = 'REMOTE';
+const SAMPLE_MS = 20;
+
+function delay(ms) {
+    return new Promise(resolve => setTimeout(resolve, ms));
+}
+
+// Deterministic link behaviour between runs
+function makeRandom(seed) {
+    let state = seed >>> 0;
+    return () => {
+        state = (state * 1664525 + 1013904223) >>> 0;
+        return state / 4294967296;
+    };
+}
+
+/**
+ * One direction of a data channel: each message is serialized and
+ * delivered after delayMs + U(0, jitterMs), or dropped with probability loss
+ */
+class SimLink {
+    constructor(deliver, options = {}) {
+        this.deliver = deliver;
+        this.random = makeRandom(options.seed || 1);
+        this.configure(options);
+        this.sent = 0;
+        this.dropped = 0;
+    }
+
+    configure(options) {
+        this.delayMs = options.delayMs ?? 10;
+        this.jitterMs = options.jitterMs ?? 0;
+        this.loss = options.loss ?? 0;
+    }
+
+    send(data) {
+        this.sent++;
+        const wire = JSON.stringify(data);
+        if (this.random() < this.loss) {
+            this.dropped++;
+            return;
+        }
+        setTimeout(() => this.deliver(JSON.parse(wire)), this.delayMs + this.random() * this.jitterMs);
+    }
+}
+
+function summarize(values) {
+    if (values.length === 0) return { p5: 0, p50: 0, p95: 0, mean: 0 };
+    const sorted = [...values].sort((a, b) => a - b);
+    const at = (p) => sorted[Math.min(sorted.length - 1, Math.floor(sorted.length * p))];
+    return {
+        p5: at(0.05),
+        p50: at(0.5),
+        p95: at(0.95),
+        mean: values.reduce((a, b) => a + b, 0) / values.length
+    };
+}
+
+class RemoteStreamTest {
+    constructor() {
+        this.results = [];
+        this.consoleLog = console.log;
+        this.consoleWarn = console.warn;
+        this.consoleError = console.error;
+    }
+
+    addResult(test, success, details = '') {
+        this.results.push({ test, success, details });
+        this.consoleLog(`${success ? '✅' : '❌'} ${test}${details ? ': ' + details : ''}`);
+    }
+
+    // RemoteService logs every command; keep the output to results
+    mute() {
+        console.log = console.warn = console.error = () => {};
+    }
+
+    unmute() {
+        console.log = this.consoleLog;
+        console.warn = this.consoleWarn;
+        console.error = this.consoleError;
+    }
+
+    /**
+     * Host and remote wired through a SimLink, as after PeerJS connected
+     */
+    createPeers(linkOptions, streamConfig = {}) {
+        const host = new RemoteService();
+        host.isHost = true;
+        host.setStreamConfig(streamConfig);
+        const applied = [];
+        host.setEventCallbacks({
+            onRemoteCommand: (data) => applied.push({ value: data.value, seq: data.seq, at: streamNow() })
+        });
+
+        const remote = new RemoteService();
+        remote.setStreamConfig(streamConfig);
+        const link = new SimLink((data) => host.handleRemoteCommand(data, REMOTE_ID), linkOptions);
+        remote.isRemote = true;
+        remote.hostId = HOST_ID;
+        remote.connections.set(HOST_ID, { open: true, send: (data) => link.send(data) });
+
+        // The host's greeting, as sent when the channel opens
+        remote.hostAcceptsBatches = streamConfig.batching !== false;
+
+        return { host, remote, link, applied };
+    }
+
+    /**
+     * Drive the remote with a rising duty ramp; returns production times by value
+     */
+    async drive(peers, durationMs, onTick = null) {
+        const produced = new Map();
+        const count = Math.floor(durationMs / SAMPLE_MS);
+        const start = streamNow();
+        for (let i = 1; i <= count; i++) {
+            const value = i;
+            produced.set(value, streamNow());
+            peers.remote.sendControlCommand('duty', value, { timestamp: Date.now(), source: 'motor_controller' });
+            if (onTick) onTick(i, count);
+            const next = start + i * SAMPLE_MS;
+            await delay(Math.max(0, next - streamNow()));
+        }
+        if (peers.remote.sampleSender) peers.remote.sampleSender.flush();
+        return { produced, count };
+    }
+
+    analyze(applied, produced) {
+        let inversions = 0;
+        const latency = [];
+        for (let i = 0; i < applied.length; i++) {
+            if (i > 0 && applied[i].value < applied[i - 1].value) inversions++;
+            latency.push(applied[i].at - produced.get(applied[i].value));
+        }
+        const l = summarize(latency);
+        return { inversions, latency: l, spread: l.p95 - l.p5 };
+    }
+
+    stop(peers) {
+        peers.remote.disconnect();
+        peers.host.disconnect();
+    }
+
+    /**
+     * Test 1: Jitter buffer ordering, duplicates and stale packets
+     */
+    async testBufferRules() {
+        const played = [];
+        const buffer = new JitterBuffer((s) => played.push(s.seq), { minDelayMs: 60 });
+        const t = streamNow();
+        const packet = (seq, n, sentAt) => ({
+            type: 'control_batch', mode: 'duty', seq, sentAt,
+            age: new Array(n).fill(0), v: Array.from({ length: n }, (_, i) => seq + i)
+        });
+
+        // All inside the playout delay
+        buffer.receive(packet(1, 2, t));
+        buffer.receive(packet(5, 2, t + 2));
+        buffer.receive(packet(3, 2, t + 1));      // reordered
+        buffer.receive(packet(3, 2, t + 1));      // duplicate
+        await delay(150);
+        buffer.receive(packet(1, 2, t));          // after playout: stale
+
+        const s = buffer.getStats();
+        const inOrder = played.every((seq, i) => i === 0 || seq > played[i - 1]);
+        this.addResult('Buffer plays in sequence order', inOrder && played[played.length - 1] === 6,
+            `played ${played.join(',')}`);
+        this.addResult('Buffer counts reorder, duplicates, stale',
+            s.reordered >= 1 && s.duplicates === 2 && s.stale === 2,
+            `reordered=${s.reordered} duplicates=${s.duplicates} stale=${s.stale}`);
+        buffer.stop();
+    }
+
+    /**
+     * Test 2: Jittery link, per-sample sending vs the jitter buffer
+     */
+    async testJitter() {
+        const link = { delayMs: 20, jitterMs: 60, loss: 0, seed: 7 };
+
+        const legacyPeers = this.createPeers(link, { batching: false });
+        const legacyRun = await this.drive(legacyPeers, 2000);
+        await delay(150);
+        const legacy = this.analyze(legacyPeers.applied, legacyRun.produced);
+        const legacyMessages = legacyPeers.link.sent;
+        this.stop(legacyPeers);
+
+        const peers = this.createPeers(link);
+        const run = await this.drive(peers, 2000);
+        await delay(400);
+        const buffered = this.analyze(peers.applied, run.produced);
+        const stats = peers.host.getStatus().stream.receivers[REMOTE_ID];
+        const messages = peers.link.sent;
+        this.stop(peers);
+
+        this.consoleLog(`\n  Link 20 ms + U(0, 60) ms, ${run.count} samples every ${SAMPLE_MS} ms:`);
+        this.consoleLog(`  per sample:    ${legacyMessages} messages, ${legacy.inversions} rollbacks, latency p50 ${legacy.latency.p50.toFixed(0)} ms, p5-p95 spread ${legacy.spread.toFixed(0)} ms`);
+        this.consoleLog(`  jitter buffer: ${messages} messages, ${buffered.inversions} rollbacks, latency p50 ${buffered.latency.p50.toFixed(0)} ms, p5-p95 spread ${buffered.spread.toFixed(0)} ms, delay ${stats.delayMs.toFixed(0)} ms\n`);
+
+        this.addResult('Per-sample path rolls back on reorder', legacy.inversions > 0, `${legacy.inversions} rollbacks`);
+        this.addResult('Jitter buffer never rolls back', buffered.inversions === 0,
+            `late ${stats.late}, stale ${stats.stale}`);
+        this.addResult('Jitter buffer evens out latency', buffered.spread < legacy.spread / 2,
+            `spread ${buffered.spread.toFixed(0)} ms vs ${legacy.spread.toFixed(0)} ms`);
+        this.addResult('Batching cuts messages', messages < legacyMessages / 1.3,
+            `${messages} vs ${legacyMessages}`);
+        this.addResult('Host reports latency stats', stats.packets > 0 && stats.latency.p95 >= stats.latency.p50 &&
+            stats.jitterMs > 0, `p50 ${stats.latency.p50.toFixed(0)} ms, p95 ${stats.latency.p95.toFixed(0)} ms above fastest transit, jitter ${stats.jitterMs.toFixed(1)} ms`);
+    }
+
+    /**
+     * Test 3: Loss is counted and playout keeps going
+     */
+    async testLoss() {
+        const peers = this.createPeers({ delayMs: 15, jitterMs: 30, loss: 0.1, seed: 11 });
+        const run = await this.drive(peers, 1500);
+        await delay(300);
+        const result = this.analyze(peers.applied, run.produced);
+        const stats = peers.host.getStatus().stream.receivers[REMOTE_ID];
+        const last = peers.applied[peers.applied.length - 1];
+        this.stop(peers);
+
+        this.addResult('Loss counted, order kept', stats.lost > 0 && result.inversions === 0,
+            `${peers.link.dropped}/${peers.link.sent} packets dropped, ${stats.lost} samples lost`);
+        this.addResult('Playout continues through loss', last && run.count - last.value < 10,
+            `last applied ${last ? last.value : 'none'} of ${run.count}`);
+    }
+
+    /**
+     * Test 4: Playout delay follows the link jitter up and back down
+     */
+    async testAdaptive() {
+        const peers = this.createPeers({ delayMs: 15, jitterMs: 4, seed: 3 });
+        const readDelay = () => peers.host.jitterBuffers.get(REMOTE_ID)?.delayMs || 0;
+        const marks = {};
+        await this.drive(peers, 4500, (i) => {
+            const ms = i * SAMPLE_MS;
+            if (ms === 1000) { marks.calm = readDelay(); peers.link.configure({ delayMs: 15, jitterMs: 100 }); }
+            if (ms === 2000) { marks.jittery = readDelay(); peers.link.configure({ delayMs: 15, jitterMs: 4 }); }
+        });
+        marks.recovered = readDelay();
+        this.stop(peers);
+
+        this.addResult('Playout delay adapts to jitter',
+            marks.jittery > marks.calm * 2 && marks.recovered < marks.jittery * 0.6,
+            `calm ${marks.calm.toFixed(0)} ms, jittery ${marks.jittery.toFixed(0)} ms, recovered ${marks.recovered.toFixed(0)} ms`);
+    }
+
+    /**
+     * Test 5: Hosts that have not announced batching get control_command
+     */
+    async testLegacyHost() {
+        const peers = this.createPeers({ delayMs: 5 });
+        peers.remote.hostAcceptsBatches = false;
+        peers.remote.sendControlCommand('duty', 1234);
+        await delay(30);
+        const ok = peers.applied.length === 1 && peers.applied[0].value === 1234 &&
+                   peers.remote.sampleSender === null;
+        this.stop(peers);
+        this.addResult('Older hosts get per-sample commands', ok);
+    }
+
+    async run() {
+        this.mute();
+        try {
+            await this.testBufferRules();
+            await this.testJitter();
+            await this.testLoss();
+            await this.testAdaptive();
+            await this.testLegacyHost();
+        } finally {
+            this.unmute();
+        }
+
+        const failed = this.results.filter(r => !r.success).length;
+        console.log(`\n${this.results.length - failed}/${this.results.length} passed`);
+        process.exitCode = failed ? 1 : 0;
+    }
+}
+
+new RemoteStreamTest().run();
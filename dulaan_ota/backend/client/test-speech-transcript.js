@@ -0,0 +1,161 @@
+/**
+ * On-device Transcript Test - recognizer text to the decision cache
+ * Run with: node test-speech-transcript.js
+ *
+ * Drives OnDeviceTranscriber with a fake Web Speech recognizer (results,
+ * restarts after silence, late and stale results), then sends two speech
+ * segments of the same command through ApiService into the server's
+ * directAudioToPWM handler (functions/inference.js) with a counting model:
+ * the second one must be answered from the cache.
+ */
+
+import { createRequire } from 'module';
+import { OnDeviceTranscriber } from './core/speech-transcript.js';
+import { ApiService } from './services/api-service.js';
+
+const require = createRequire(import.meta.url);
+const { createDirectAudioHandler } = require('../functions/inference.js');
+
+function delay(ms) {
+    return new Promise(resolve => setTimeout(resolve, ms));
+}
+
+// Web Speech API stand-in; say() delivers one final result
+class FakeRecognition {
+    constructor() {
+        FakeRecognition.last = this;
+        this.starts = 0;
+        this.results = [];
+    }
+
+    start() {
+        this.starts++;
+    }
+
+    stop() {
+        this.stopped = true;
+    }
+
+    say(text) {
+        this.results.push(Object.assign([{ transcript: text }], { isFinal: true }));
+        this.onresult({ resultIndex: this.results.length - 1, results: this.results });
+    }
+}
+
+class SpeechTranscriptTest {
+    constructor() {
+        this.results = [];
+        this.consoleLog = console.log;
+    }
+
+    addResult(test, success, details = '') {
+        this.results.push({ test, success, details });
+        this.consoleLog(`${success ? '✅' : '❌'} ${test}${details ? ': ' + details : ''}`);
+    }
+
+    /**
+     * Test 1: Results during the segment are taken once, late ones are waited for
+     */
+    async testTake() {
+        const t = new OnDeviceTranscriber({ Recognition: FakeRecognition, waitMs: 200 });
+        t.start();
+        const rec = FakeRecognition.last;
+
+        const start = Date.now();
+        rec.say('make it');
+        rec.say('stronger');
+        const text = await t.take(start);
+        const again = await t.take(start);
+        this.addResult('Segment text taken once', text === 'make it stronger' && again === null, `"${text}"`);
+
+        const segment = Date.now();
+        setTimeout(() => rec.say('stop'), 30);
+        const late = await t.take(segment);
+        const waited = Date.now() - segment;
+        this.addResult('Late result waited for', late === 'stop' && waited < 150, `${waited} ms`);
+
+        rec.say('old command');
+        await delay(5);
+        const stale = await t.take(Date.now());
+        this.addResult('Result from before the segment dropped', stale === null);
+
+        rec.onend();
+        this.addResult('Recognizer restarted after silence', rec.starts === 2, `${rec.starts} starts`);
+        t.stop();
+        rec.onend();
+        this.addResult('Stopped recognizer stays stopped', rec.stopped && rec.starts === 2 && await t.take(0) === null);
+    }
+
+    /**
+     * Test 2: No recognizer, or permission refused: requests go without a transcript
+     */
+    async testUnavailable() {
+        const none = new OnDeviceTranscriber({ Recognition: null });
+        const denied = new OnDeviceTranscriber({ Recognition: FakeRecognition });
+        denied.start();
+        console.warn = () => {};
+        FakeRecognition.last.onerror({ error: 'not-allowed' });
+        console.warn = this.consoleWarn;
+        this.addResult('No recognizer, no transcript', !none.available && !none.start() &&
+            await none.take(0) === null && !denied.active && await denied.take(0) === null);
+    }
+
+    /**
+     * Test 3: A repeated spoken command skips the model
+     */
+    async testRepeatSkipsModel() {
+        let modelCalls = 0;
+        const backend = {
+            name: 'counting',
+            async infer(request) {
+                modelCalls++;
+                return { intentDetected: true, transcription: 'Make it stronger', pwm: request.currentPwm + 50, response: 'ok' };
+            }
+        };
+        const handle = createDirectAudioHandler({ backend, logger: { log() {}, warn() {}, error() {} } });
+        const sent = [];
+        const savedFetch = globalThis.fetch;
+        globalThis.fetch = async (url, init) => {
+            const body = JSON.parse(init.body);
+            sent.push(body);
+            const result = await handle(body);
+            return { ok: true, status: result.status, statusText: 'OK', json: async () => result.body };
+        };
+
+        const api = new ApiService({ uploadFormat: 'json' });
+        const transcriber = new OnDeviceTranscriber({ Recognition: FakeRecognition, waitMs: 50 });
+        transcriber.start();
+        const replies = [];
+        for (let i = 0; i < 2; i++) {
+            const packet = { audioData: new Int16Array(1600), sampleRate: 16000, timestamp: Date.now(), duration: 0 };
+            FakeRecognition.last.say('make it stronger');
+            packet.transcript = await transcriber.take(packet.timestamp);
+            api.setCurrentPwm(100);
+            replies.push(await api.processSpeechSegment(packet));
+        }
+        transcriber.stop();
+        globalThis.fetch = savedFetch;
+
+        this.addResult('Transcript sent with the audio', sent.length === 2 && sent.every((b) => b.transcript === 'make it stronger'));
+        this.addResult('Repeated command answered from the cache', modelCalls === 1 && replies[1].cached &&
+            replies[1].newPwmValue === 150, `${modelCalls} model call(s) for 2 requests`);
+    }
+
+    async run() {
+        this.consoleWarn = console.warn;
+        console.log = () => {};
+        try {
+            await this.testTake();
+            await this.testUnavailable();
+            await this.testRepeatSkipsModel();
+        } finally {
+            console.log = this.consoleLog;
+        }
+
+        const failed = this.results.filter((r) => !r.success).length;
+        console.log(`\n${this.results.length - failed}/${this.results.length} passed`);
+        process.exitCode = failed ? 1 : 0;
+    }
+}
+
+new SpeechTranscriptTest().run();
@@ -0,0 +1,530 @@
+/**
+ * Sync Playback Test - Two simulated toys with drifting clocks
+ * Run with: node test-sync-playback.js
+ *
+ * Runs SyncPlayback against two virtual devices in simulated time. Each
+ * device has its own connection interval and anchor, a crystal off by
+ * tens of ppm, and the sync characteristic of vm_sync.h: writes land at
+ * the next connection event after the phone stack latency (sometimes one
+ * event later, a retry), notifications go out at the following event, and
+ * scheduled changes play out on the device clock. The skew between the
+ * two devices is measured for plain writes, for synchronized changes right
+ * after a sync, and over ten minutes with periodic resync, with and
+ * without drift tracking.
+ */
+
+import {
+    SyncPlayback, ClockEstimator, SYNC_PROTOCOL,
+    encodeSyncSchedule, parseSyncNotification
+} from './core/sync-playback.js';
+
+const U32 = 0x100000000;
+
+// Deterministic link behaviour between runs
+function makeRandom(seed) {
+    let state = seed >>> 0;
+    return () => {
+        state = (state * 1664525 + 1013904223) >>> 0;
+        return state / 4294967296;
+    };
+}
+
+function flush() {
+    return new Promise(resolve => setImmediate(resolve));
+}
+
+/**
+ * Simulated time: timers run in order, promises settle between them
+ */
+class VirtualTime {
+    constructor() {
+        this.t = 0;
+        this.timers = [];
+        this.nextId = 1;
+        this.now = () => this.t;
+        this.setTimeout = (fn, ms) => {
+            const id = this.nextId++;
+            this.timers.push({ id, at: this.t + Math.max(0, ms || 0), fn });
+            return id;
+        };
+        this.clearTimeout = (id) => {
+            const i = this.timers.findIndex(t => t.id === id);
+            if (i >= 0) this.timers.splice(i, 1);
+        };
+    }
+
+    next(limit) {
+        let best = -1;
+        for (let i = 0; i < this.timers.length; i++) {
+            const t = this.timers[i];
+            if (t.at <= limit && (best < 0 || t.at < this.timers[best].at ||
+                (t.at === this.timers[best].at && t.id < this.timers[best].id))) {
+                best = i;
+            }
+        }
+        return best < 0 ? null : this.timers.splice(best, 1)[0];
+    }
+
+    async runUntil(end) {
+        await flush();
+        for (let timer = this.next(end); timer; timer = this.next(end)) {
+            this.t = timer.at;
+            timer.fn();
+            await flush();
+        }
+        this.t = Math.max(this.t, end);
+    }
+
+    async runFor(ms) {
+        await this.runUntil(this.t + ms);
+    }
+
+    async settle(promise) {
+        let done = false;
+        let value;
+        promise.then(v => { done = true; value = v; });
+        await flush();
+        while (!done) {
+            const timer = this.next(Infinity);
+            if (!timer) break;
+            this.t = timer.at;
+            timer.fn();
+            await flush();
+        }
+        return value;
+    }
+}
+
+/**
+ * One toy: BLE connection timing plus the vm_sync.c command handling
+ */
+class VirtualDevice {
+    constructor(vt, options) {
+        this.vt = vt;
+        this.name = options.name;
+        this.intervalMs = options.intervalMs;
+        this.anchorMs = options.anchorMs;
+        this.driftPpm = options.driftPpm;
+        this.clockStartUs = options.clockStartUs || 0;
+        this.random = makeRandom(options.seed);
+        this.retry = options.retry ?? 0.03;
+        this.notify = () => {};
+
+        this.session = 0;
+        this.sessionSeq = 0;
+        this.lastArrival = 0;
+        this.applied = [];              // { duty, t (true ms), late }
+        this.pendingTimes = [];         // true times of queued changes
+        this.stats = { applied: 0, late: 0, dropped: 0, worstLateUs: 0 };
+    }
+
+    // Device clock (us, u32) at true time t
+    clock(t) {
+        const us = this.clockStartUs + (t - this.sessionStart) * 1000 * (1 + this.driftPpm / 1e6);
+        return ((Math.floor(us) % U32) + U32) % U32;
+    }
+
+    // True time at which the device clock reads `at` (us), given it reads `ref` at true time t
+    clockToTrue(at, ref, t) {
+        let ahead = (at - ref) % U32;
+        if (ahead < 0) ahead += U32;
+        if (ahead >= U32 / 2) ahead -= U32;
+        return { t: t + ahead / 1000 / (1 + this.driftPpm / 1e6), ahead };
+    }
+
+    // First connection event at or after t
+    nextEvent(t) {
+        return this.anchorMs + Math.ceil((t - this.anchorMs) / this.intervalMs) * this.intervalMs;
+    }
+
+    // Phone write without response: queued in the phone stack, sent at the next event
+    write(bytes) {
+        const copy = Uint8Array.from(bytes);
+        const now = this.vt.now();
+        let air = this.nextEvent(now + 0.6 + this.random() * 0.8);
+        if (this.random() < this.retry) air += this.intervalMs;
+        // Writes keep their order
+        const arrival = Math.max(air + 0.15, this.lastArrival);
+        this.lastArrival = arrival;
+        this.vt.setTimeout(() => this.receive(copy), arrival - now);
+        return Promise.resolve();
+    }
+
+    // Notification: sent at the next event after this one, then the phone stack
+    sendNotification(bytes) {
+        const now = this.vt.now();
+        const air = this.nextEvent(now + 0.01);
+        this.vt.setTimeout(() => this.notify(bytes), air + 1 + this.random() * 3 - now);
+    }
+
+    // Plain motor characteristic write: applied on arrival
+    writeDuty(duty) {
+        const now = this.vt.now();
+        let air = this.nextEvent(now + 0.6 + this.random() * 0.8);
+        if (this.random() < this.retry) air += this.intervalMs;
+        const arrival = Math.max(air + 0.15, this.lastArrival);
+        this.lastArrival = arrival;
+        this.vt.setTimeout(() => this.applied.push({ duty, t: this.vt.now(), late: false }), arrival - now);
+    }
+
+    receive(bytes) {
+        const now = this.vt.now();
+        const view = new DataView(bytes.buffer);
+        this.pendingTimes = this.pendingTimes.filter(t => t > now);
+
+        switch (bytes[0]) {
+            case SYNC_PROTOCOL.CMD_PING: {
+                if (!this.session) {
+                    this.sessionSeq = (this.sessionSeq + 1) & 0xFF || 1;
+                    this.session = this.sessionSeq;
+                    this.sessionStart = now;
+                    this.stats = { applied: 0, late: 0, dropped: 0, worstLateUs: 0 };
+                }
+                const rsp = new Uint8Array(SYNC_PROTOCOL.PING_RSP_SIZE);
+                const out = new DataView(rsp.buffer);
+                rsp[0] = SYNC_PROTOCOL.CMD_PING;
+                rsp[1] = bytes[1];
+                rsp[2] = this.session;
+                out.setUint32(3, this.clock(now), true);
+                out.setUint32(7, this.clock(now + 0.02), true);
+                this.sendNotification(rsp);
+                break;
+            }
+            case SYNC_PROTOCOL.CMD_SCHEDULE: {
+                if (!this.session) {
+                    this.sendNotification(new Uint8Array([SYNC_PROTOCOL.CMD_SCHEDULE, SYNC_PROTOCOL.ERR_NO_CLOCK]));
+                    break;
+                }
+                const ref = this.clock(now);
+                let status = 0;
+                for (let off = 1; off < bytes.length; off += SYNC_PROTOCOL.ENTRY_SIZE) {
+                    const at = view.getUint32(off, true);
+                    const duty = view.getUint16(off + 4, true);
+                    const { t, ahead } = this.clockToTrue(at, ref, now);
+                    if (this.pendingTimes.length >= SYNC_PROTOCOL.QUEUE_SIZE) {
+                        this.stats.dropped++;
+                        status = SYNC_PROTOCOL.ERR_FULL;
+                        continue;
+                    }
+                    if (ahead <= 0) {
+                        // Already due: applied at once, counted late past 1 ms
+                        const lateUs = Math.min(0xFFFF, -ahead);
+                        this.stats.applied++;
+                        if (lateUs > 1000) this.stats.late++;
+                        this.stats.worstLateUs = Math.max(this.stats.worstLateUs, lateUs);
+                        this.applied.push({ duty, t: now, late: lateUs > 1000 });
+                    } else {
+                        this.pendingTimes.push(t);
+                        this.vt.setTimeout(() => {
+                            this.stats.applied++;
+                            this.applied.push({ duty, t, late: false });
+                        }, t - now);
+                    }
+                }
+                if (status) this.sendNotification(new Uint8Array([SYNC_PROTOCOL.CMD_SCHEDULE, status]));
+                break;
+            }
+            case SYNC_PROTOCOL.CMD_STOP:
+                this.session = 0;
+                break;
+            case SYNC_PROTOCOL.CMD_STATUS: {
+                const rsp = new Uint8Array(SYNC_PROTOCOL.STATUS_RSP_SIZE);
+                const out = new DataView(rsp.buffer);
+                rsp[0] = SYNC_PROTOCOL.CMD_STATUS;
+                rsp[1] = this.session;
+                rsp[2] = this.pendingTimes.length;
+                out.setUint16(3, this.stats.applied, true);
+                out.setUint16(5, this.stats.late, true);
+                out.setUint16(7, this.stats.dropped, true);
+                out.setUint16(9, this.stats.worstLateUs, true);
+                this.sendNotification(rsp);
+                break;
+            }
+        }
+    }
+}
+
+function summarize(values) {
+    if (values.length === 0) return { p50: 0, p95: 0, max: 0 };
+    const sorted = [...values].sort((a, b) => a - b);
+    const at = (p) => sorted[Math.min(sorted.length - 1, Math.floor(sorted.length * p))];
+    return { p50: at(0.5), p95: at(0.95), max: sorted[sorted.length - 1] };
+}
+
+function fmt(s) {
+    return `p50 ${s.p50.toFixed(2)} ms, p95 ${s.p95.toFixed(2)} ms, max ${s.max.toFixed(2)} ms`;
+}
+
+// Skew per change, matched by duty value (every change uses a unique duty)
+function skews(a, b, from = -Infinity) {
+    const times = new Map(a.applied.filter(x => x.t >= from).map(x => [x.duty, x.t]));
+    const out = [];
+    for (const x of b.applied) {
+        if (x.t >= from && times.has(x.duty)) out.push(Math.abs(x.t - times.get(x.duty)));
+    }
+    return out;
+}
+
+class SyncPlaybackTest {
+    constructor() {
+        this.results = [];
+        this.consoleLog = console.log;
+    }
+
+    addResult(test, success, details = '') {
+        this.results.push({ test, success, details });
+        this.consoleLog(`${success ? '✅' : '❌'} ${test}${details ? ': ' + details : ''}`);
+    }
+
+    /**
+     * Two devices on different intervals; B's clock starts 100 s before its u32 wrap
+     */
+    makeWorld(seed, playbackOptions = {}) {
+        const vt = new VirtualTime();
+        const a = new VirtualDevice(vt, { name: 'A', intervalMs: 30, anchorMs: 7.3, driftPpm: 40, seed: seed });
+        const b = new VirtualDevice(vt, {
+            name: 'B', intervalMs: 45, anchorMs: 21.1, driftPpm: -35, seed: seed + 1,
+            clockStartUs: U32 - 100e6
+        });
+        const playback = new SyncPlayback({
+            now: vt.now, setTimeout: vt.setTimeout, clearTimeout: vt.clearTimeout,
+            random: makeRandom(seed + 2), ...playbackOptions
+        });
+        a.notify = playback.addDevice('A', (bytes) => a.write(bytes));
+        b.notify = playback.addDevice('B', (bytes) => b.write(bytes));
+        return { vt, a, b, playback };
+    }
+
+    // Estimate error against the true device clock, us
+    clockError(world, id, device) {
+        const t = world.vt.now();
+        const clock = world.playback.devices.get(id).clock;
+        let err = (clock.toDevice(t) - device.clock(t)) % U32;
+        if (err > U32 / 2) err -= U32;
+        if (err < -U32 / 2) err += U32;
+        return err;
+    }
+
+    /**
+     * Test 1: Packet layout matches vm_sync.h
+     */
+    testPackets() {
+        const bytes = encodeSyncSchedule([{ at: 300000, duty: 2500 }, { at: U32 + 5, duty: 10000 }]);
+        const hex = Array.from(bytes, b => b.toString(16).padStart(2, '0')).join('');
+        this.addResult('SCHEDULE layout', hex === '02e0930400c409050000001027', hex);
+
+        const ping = parseSyncNotification(new Uint8Array([1, 9, 3, 0x10, 0, 0, 0x80, 0x20, 0, 0, 0x80]));
+        const status = parseSyncNotification(new Uint8Array([4, 3, 2, 10, 0, 1, 0, 0, 0, 0xE8, 0x03]));
+        this.addResult('PING / STATUS responses parsed',
+            ping.seq === 9 && ping.session === 3 && ping.rx === 0x80000010 && ping.tx === 0x80000020 &&
+            status.queued === 2 && status.applied === 10 && status.late === 1 && status.worstLateUs === 1000 &&
+            parseSyncNotification(new Uint8Array([1, 2])) === null);
+    }
+
+    /**
+     * Test 2: Lower envelope against round-trip halving on an asymmetric link
+     */
+    testEstimator() {
+        const random = makeRandom(7);
+        const envelope = new ClockEstimator();
+        const intervalMs = 45;
+        const offsetUs = 123456789;
+        let halvingSum = 0;
+        let n = 0;
+        for (let i = 0; i < 96; i++) {
+            const sent = 1000 + i * 61.7;
+            const up = 0.5 + random() * intervalMs;         // Stack, then the wait for the event
+            const down = intervalMs + 1 + random() * 3;     // Always the following event
+            const rx = sent * 1000 + offsetUs + up * 1000;
+            envelope.addSample({ sent, received: sent + up + down, rx, tx: rx, session: 1 });
+            halvingSum += rx - (sent + (sent + up + down)) / 2 * 1000;
+            n++;
+        }
+        // Both are compared against the offset plus the shortest uplink (0.5 ms)
+        const t = 8000;
+        const envErr = envelope.toDevice(t) - (t * 1000 + offsetUs + 500);
+        const halvingErr = halvingSum / n - (offsetUs + 500);
+        this.addResult('Envelope beats round-trip halving', Math.abs(envErr) < 1000 && Math.abs(halvingErr) > 5000,
+            `envelope ${(envErr / 1000).toFixed(2)} ms, halving ${(halvingErr / 1000).toFixed(2)} ms off`);
+    }
+
+    /**
+     * Test 3: Plain writes against scheduled changes right after a sync
+     */
+    async testSkew() {
+        const world = this.makeWorld(11);
+        const { vt, a, b, playback } = world;
+
+        // Plain writes to both at the same moment
+        for (let k = 0; k < 200; k++) {
+            await vt.runFor(97 + k % 13);
+            a.writeDuty(1000 + k);
+            b.writeDuty(1000 + k);
+        }
+        await vt.runFor(200);
+        const plain = summarize(skews(a, b));
+
+        const synced = await vt.settle(playback.syncAll());
+        const errA = this.clockError(world, 'A', a);
+        const errB = this.clockError(world, 'B', b);
+        this.addResult('Initial sync', synced, `${playback.pingCount} pings, ${(vt.now() / 1000).toFixed(1)} s, ` +
+            `estimate A ${(errA / 1000).toFixed(2)} ms, B ${(errB / 1000).toFixed(2)} ms (bias is the uplink stack latency)`);
+
+        playback.startResync();
+        const start = vt.now();
+        for (let k = 0; k < 200; k++) {
+            playback.setDuty(3000 + k);
+            await vt.runFor(97 + k % 13);
+        }
+        await vt.runFor(500);
+        playback.stopResync();
+        const sync = summarize(skews(a, b, start));
+        const late = a.applied.concat(b.applied).filter(x => x.late).length;
+
+        this.addResult('Plain writes are apart by the interval phase', plain.p50 > 5, fmt(plain));
+        this.addResult('Scheduled changes in step', sync.p95 < 3.5 && sync.max < 5 && late === 0,
+            `${fmt(sync)}, ${late} late`);
+        this.summary = { plain, sync };
+    }
+
+    /**
+     * Test 4: Ten minutes with resync; drift tracking against a fixed offset
+     */
+    async testLongRun() {
+        const tracked = this.makeWorld(21);
+        const fixed = this.makeWorld(21, { trackDrift: false });
+
+        await Promise.all([
+            tracked.vt.settle(tracked.playback.syncAll()),
+            fixed.vt.settle(fixed.playback.syncAll())
+        ]);
+        tracked.playback.startResync();
+
+        const runs = [];
+        for (const world of [tracked, fixed]) {
+            const { vt, a, b, playback } = world;
+            const start = vt.now();
+            let k = 0;
+            while (vt.now() < start + 600000) {
+                playback.setDuty(k % 9000 + 1);
+                k++;
+                await vt.runFor(2000);
+            }
+            playback.stopResync();
+            await vt.runFor(500);
+            runs.push({
+                world,
+                last: summarize(skews(a, b, start + 480000)),
+                settled: summarize(skews(a, b, start + 300000)),
+                all: summarize(skews(a, b, start)),
+                late: a.applied.concat(b.applied).filter(x => x.late).length
+            });
+        }
+
+        const [t, f] = runs;
+        const stateA = tracked.playback.getStats().A.clock;
+        const stateB = tracked.playback.getStats().B.clock;
+        this.addResult('Drift estimated', Math.abs(stateA.driftPpm - 40) < 10 && Math.abs(stateB.driftPpm + 35) < 10,
+            `A ${stateA.driftPpm.toFixed(1)} ppm (40), B ${stateB.driftPpm.toFixed(1)} ppm (-35)`);
+        this.addResult('Skew stays low over 10 min with resync', t.all.p95 < 3 && t.all.max < 8 && t.late === 0,
+            `${fmt(t.all)}, ${t.late} late`);
+        this.addResult('Skew settles once the drift is known', t.settled.p95 < 2.5 && t.settled.p50 < 1,
+            `minutes 5-10: ${fmt(t.settled)}`);
+        this.addResult('Fixed offset drifts apart', f.last.p50 > 20,
+            `last 2 min: ${fmt(f.last)} (75 ppm apart)`);
+        this.addResult('Device B clock wrapped', tracked.b.clock(tracked.vt.now()) < 1e9 &&
+            tracked.playback.getStats().B.errors === 0);
+        this.summary.tracked = t.all;
+        this.summary.settled = t.settled;
+        this.summary.fixed = f.last;
+    }
+
+    /**
+     * Test 5: Too short a lead shows up as late changes in STATUS
+     */
+    async testLate() {
+        const { vt, b, playback } = this.makeWorld(31, { leadMs: 10 });
+        await vt.settle(playback.syncAll());
+        for (let k = 0; k < 20; k++) {
+            playback.setDuty(500 + k);
+            await vt.runFor(100);
+        }
+        const status = await vt.settle(playback.queryStatus('B'));
+        this.addResult('Late changes counted', status && status.late > 0 && status.late === b.stats.late,
+            status ? `${status.late}/${status.applied} late with 10 ms lead on a 45 ms interval, worst ${status.worstLateUs} us` : 'no status');
+    }
+
+    /**
+     * Test 6: Device session restart is detected and resynced
+     */
+    async testSessionRestart() {
+        const world = this.makeWorld(41);
+        const { vt, a, b, playback } = world;
+        await vt.settle(playback.syncAll());
+
+        b.session = 0;      // Device ended its session (idle timeout)
+        playback.setDuty(7000);
+        await vt.runFor(300);
+        const lost = playback.getStats().B;
+
+        await vt.settle(playback.syncAll());
+        const start = vt.now();
+        for (let k = 0; k < 20; k++) {
+            playback.setDuty(7100 + k);
+            await vt.runFor(150);
+        }
+        await vt.runFor(300);
+        const after = summarize(skews(a, b, start));
+        this.addResult('Session restart resynced', lost.lastError === SYNC_PROTOCOL.ERR_NO_CLOCK &&
+            playback.getStats().B.clock.session === b.session && after.p95 < 2, fmt(after));
+    }
+
+    /**
+     * Test 7: play() keeps the device queue fed without overflowing it
+     */
+    async testPlay() {
+        const { vt, a, b, playback } = this.makeWorld(51);
+        await vt.settle(playback.syncAll());
+        playback.startResync();
+        const frames = [];
+        for (let i = 0; i < 100; i++) frames.push({ time: i * 50, duty: 100 + i });
+        const startAt = playback.play(frames);
+        await vt.runFor(6000);
+        playback.stopResync();
+
+        const inOrder = (d) => d.applied.filter(x => x.duty >= 100 && x.duty < 200).map(x => x.duty)
+            .every((duty, i) => duty === 100 + i);
+        const onTime = b.applied.filter(x => x.duty >= 100 && x.duty < 200).length === 100 &&
+            a.applied.filter(x => x.duty >= 100 && x.duty < 200).length === 100;
+        const s = summarize(skews(a, b, startAt - 1));
+        this.addResult('Pattern played in step', onTime && inOrder(a) && inOrder(b) &&
+            b.stats.dropped === 0 && a.stats.dropped === 0 && s.max < 5, `100 frames, ${fmt(s)}`);
+    }
+
+    report() {
+        const s = this.summary;
+        this.consoleLog('\nInter-device skew (A: 30 ms interval, +40 ppm; B: 45 ms interval, -35 ppm):');
+        this.consoleLog(`  plain writes                      ${fmt(s.plain)}`);
+        this.consoleLog(`  scheduled, after sync             ${fmt(s.sync)}`);
+        this.consoleLog(`  scheduled, 10 min with resync     ${fmt(s.tracked)}`);
+        this.consoleLog(`  scheduled, minutes 5-10           ${fmt(s.settled)}`);
+        this.consoleLog(`  fixed offset, minutes 8-10        ${fmt(s.fixed)}\n`);
+    }
+
+    async run() {
+        this.testPackets();
+        this.testEstimator();
+        await this.testSkew();
+        await this.testLongRun();
+        await this.testLate();
+        await this.testSessionRestart();
+        await this.testPlay();
+        this.report();
+
+        const failed = this.results.filter(r => !r.success).length;
+        console.log(`\n${this.results.length - failed}/${this.results.length} passed`);
+        process.exitCode = failed ? 1 : 0;
+    }
+}
+
+new SyncPlaybackTest().run();
@@ -0,0 +1,133 @@
+/**
+ * Advertising Status - Connectionless device status from scan results
+ *
+ * The firmware puts one manufacturer specific AD structure in its scan response
+ * (see vibration_motor_ble/vm_adv_status.h):
+ *
+ *   [len=0x08][type=0xFF][company_lo][company_hi][tag=0xB1][battery][fw_low][fw_high][flags]
+ *
+ * Lets the device list show battery/firmware/state without connecting.
+ */
+
+export const ADV_STATUS = {
+    AD_TYPE: 0xFF,
+    COMPANY_ID: 0xFFFF,
+    TAG: 0xB1,
+    AD_SIZE: 9,              // Length byte + type + 7-byte payload
+    PAYLOAD_SIZE: 7,         // Company ID + tag + battery + fw + flags
+    BATTERY_UNKNOWN: 0xFF,
+    ADV_BUDGET: 31,          // Legacy advertising / scan response limit
+
+    FLAG_BANK_B: 0x01,
+    FLAG_MOTOR_ON: 0x02,
+    FLAG_OTA_ACTIVE: 0x04,
+    FLAG_BATTERY_LOW: 0x08,
+    FLAG_LIMITED: 0x10       // Thermal / current governor limits the motor
+};
+
+function toBytes(data) {
+    if (!data) return null;
+    if (data instanceof Uint8Array) return data;
+    if (data instanceof DataView) return new Uint8Array(data.buffer, data.byteOffset, data.byteLength);
+    if (data instanceof ArrayBuffer) return new Uint8Array(data);
+    if (Array.isArray(data)) return Uint8Array.from(data);
+    return null;
+}
+
+/**
+ * Encode a status as a complete AD structure (mirrors vm_adv_status_encode())
+ * @param {Object} status - { batteryLevel, firmwareVersion: 'high.low', flags }
+ * @returns {Uint8Array} 9-byte AD structure
+ */
+export function encodeAdvStatus(status) {
+    const [fwHigh, fwLow] = String(status.firmwareVersion || '0.0').split('.').map((v) => parseInt(v, 10) || 0);
+    const battery = status.batteryLevel === null || status.batteryLevel === undefined
+        ? ADV_STATUS.BATTERY_UNKNOWN
+        : Math.max(0, Math.min(100, Math.round(status.batteryLevel)));
+
+    const ad = new Uint8Array(ADV_STATUS.AD_SIZE);
+    ad[0] = ADV_STATUS.PAYLOAD_SIZE + 1;
+    ad[1] = ADV_STATUS.AD_TYPE;
+    ad[2] = ADV_STATUS.COMPANY_ID & 0xFF;
+    ad[3] = (ADV_STATUS.COMPANY_ID >> 8) & 0xFF;
+    ad[4] = ADV_STATUS.TAG;
+    ad[5] = battery;
+    ad[6] = fwLow & 0xFF;
+    ad[7] = fwHigh & 0xFF;
+    ad[8] = (status.flags || 0) & 0xFF;
+    return ad;
+}
+
+/**
+ * Decode the manufacturer data payload that follows the company ID
+ * (this is what Capacitor BLE and Web Bluetooth hand out per company ID)
+ * @param {DataView|ArrayBuffer|Uint8Array|number[]} data - [tag, battery, fw_low, fw_high, flags]
+ * @returns {Object|null} Decoded status, null if not ours
+ */
+export function decodeAdvStatus(data) {
+    const bytes = toBytes(data);
+    if (!bytes || bytes.length < ADV_STATUS.PAYLOAD_SIZE - 2 || bytes[0] !== ADV_STATUS.TAG) {
+        return null;
+    }
+
+    const battery = bytes[1];
+    const flags = bytes[4];
+    return {
+        batteryLevel: battery === ADV_STATUS.BATTERY_UNKNOWN ? null : Math.min(battery, 100),
+        firmwareVersion: `${bytes[3]}.${bytes[2]}`,
+        activeBank: (flags & ADV_STATUS.FLAG_BANK_B) ? 'B' : 'A',
+        motorOn: !!(flags & ADV_STATUS.FLAG_MOTOR_ON),
+        otaActive: !!(flags & ADV_STATUS.FLAG_OTA_ACTIVE),
+        batteryLow: !!(flags & ADV_STATUS.FLAG_BATTERY_LOW),
+        powerLimited: !!(flags & ADV_STATUS.FLAG_LIMITED),
+        flags
+    };
+}
+
+/**
+ * Find and decode the status in raw advertising / scan response bytes
+ * @param {DataView|ArrayBuffer|Uint8Array|number[]} data - Concatenated AD structures
+ * @returns {Object|null} Decoded status, null if absent or malformed
+ */
+export function findAdvStatus(data) {
+    const bytes = toBytes(data);
+    if (!bytes) return null;
+
+    let i = 0;
+    while (i < bytes.length) {
+        const len = bytes[i];
+        if (len === 0) break;                       // Zero padding ends the data
+        if (i + 1 + len > bytes.length) return null; // Truncated structure
+        if (bytes[i + 1] === ADV_STATUS.AD_TYPE && len >= 3) {
+            const company = bytes[i + 2] | (bytes[i + 3] << 8);
+            if (company === ADV_STATUS.COMPANY_ID) {
+                const status = decodeAdvStatus(bytes.subarray(i + 4, i + 1 + len));
+                if (status) return status;
+            }
+        }
+        i += 1 + len;
+    }
+    return null;
+}
+
+/**
+ * Extract the status from a scan result
+ * Supports Capacitor BLE ({ manufacturerData: { '65535': DataView }, rawAdvertisement })
+ * and Web Bluetooth (manufacturerData: Map<number, DataView>)
+ * @param {Object} result - Scan result / advertisement event
+ * @returns {Object|null} Decoded status
+ */
+export function parseScanResultStatus(result) {
+    if (!result) return null;
+
+    const mfr = result.manufacturerData;
+    if (mfr) {
+        const payload = typeof mfr.get === 'function'
+            ? mfr.get(ADV_STATUS.COMPANY_ID)
+            : mfr[String(ADV_STATUS.COMPANY_ID)];
+        const status = decodeAdvStatus(payload);
+        if (status) return status;
+    }
+
+    return result.rawAdvertisement ? findAdvStatus(result.rawAdvertisement) : null;
+}
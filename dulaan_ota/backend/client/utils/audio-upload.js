@@ -0,0 +1,105 @@
+/**
+ * Audio Upload - Binary framing for speech uploads to directAudioToPWM
+ *
+ * A JSON number array is 3-6 bytes per 16-bit sample and has to be
+ * stringified here and parsed on the server. The binary upload is raw
+ * PCM in frames (mirrors functions/audio-upload.js):
+ *
+ *   offset  size  field
+ *   0       2     magic 'D' 'A'
+ *   2       1     version (1)
+ *   3       1     flags (bit 0: final frame of the utterance)
+ *   4       1     codec (0: PCM s16le mono, 1: Opus, reserved)
+ *   5       1     kind (0: audio, 1: metadata JSON)
+ *   6       2     sample rate (Hz)
+ *   8       4     streamId
+ *   12      4     chunkIndex (audio frames of a stream count from 0)
+ *   16      4     payload length in bytes
+ *   20      ...   payload
+ *
+ * All fields are little-endian. A body is one metadata frame (msgHis,
+ * currentPwm, ...) followed by the audio frames of one stream. The server
+ * decodes the frames as they arrive.
+ */
+
+export const AUDIO_UPLOAD = {
+    CONTENT_TYPE: 'application/x-dulaan-audio',
+    MAGIC_0: 0x44,              // 'D'
+    MAGIC_1: 0x41,              // 'A'
+    VERSION: 1,
+    HEADER_SIZE: 20,
+    FLAG_FINAL: 0x01,
+    CODEC_PCM16: 0,
+    CODEC_OPUS: 1,
+    KIND_AUDIO: 0,
+    KIND_META: 1,
+    FRAME_SAMPLES: 3200,        // 200 ms at 16 kHz per audio frame
+    MAX_PAYLOAD: 1 << 20
+};
+
+let nextStreamId = 1;
+
+/**
+ * Stream id for a new utterance; unique for this page
+ */
+export function newAudioStreamId() {
+    const id = nextStreamId;
+    nextStreamId = (nextStreamId + 1) >>> 0 || 1;
+    return id;
+}
+
+function writeHeader(view, offset, fields, payloadLength) {
+    view.setUint8(offset, AUDIO_UPLOAD.MAGIC_0);
+    view.setUint8(offset + 1, AUDIO_UPLOAD.MAGIC_1);
+    view.setUint8(offset + 2, AUDIO_UPLOAD.VERSION);
+    view.setUint8(offset + 3, fields.isFinal ? AUDIO_UPLOAD.FLAG_FINAL : 0);
+    view.setUint8(offset + 4, fields.codec || AUDIO_UPLOAD.CODEC_PCM16);
+    view.setUint8(offset + 5, fields.kind);
+    view.setUint16(offset + 6, fields.sampleRate || 0, true);
+    view.setUint32(offset + 8, fields.streamId >>> 0, true);
+    view.setUint32(offset + 12, fields.chunkIndex >>> 0, true);
+    view.setUint32(offset + 16, payloadLength, true);
+}
+
+/**
+ * Encode an upload body
+ * @param {Object} upload - { streamId, pcm: Int16Array, sampleRate, isFinal,
+ *                            firstChunkIndex, meta: Object }
+ * @returns {Uint8Array} metadata frame followed by the audio frames
+ */
+export function encodeAudioUpload(upload) {
+    const pcm = upload.pcm;
+    const sampleRate = upload.sampleRate || 16000;
+    const streamId = upload.streamId >>> 0;
+    const firstChunk = upload.firstChunkIndex || 0;
+    const metaBytes = new TextEncoder().encode(JSON.stringify(upload.meta || {}));
+
+    const frameCount = Math.max(1, Math.ceil(pcm.length / AUDIO_UPLOAD.FRAME_SAMPLES));
+    const size = AUDIO_UPLOAD.HEADER_SIZE + metaBytes.length +
+                 frameCount * AUDIO_UPLOAD.HEADER_SIZE + pcm.length * 2;
+    const out = new Uint8Array(size);
+    const view = new DataView(out.buffer);
+
+    let offset = 0;
+    writeHeader(view, offset, { kind: AUDIO_UPLOAD.KIND_META, streamId, chunkIndex: 0, sampleRate }, metaBytes.length);
+    out.set(metaBytes, offset + AUDIO_UPLOAD.HEADER_SIZE);
+    offset += AUDIO_UPLOAD.HEADER_SIZE + metaBytes.length;
+
+    for (let frame = 0; frame < frameCount; frame++) {
+        const start = frame * AUDIO_UPLOAD.FRAME_SAMPLES;
+        const end = Math.min(pcm.length, start + AUDIO_UPLOAD.FRAME_SAMPLES);
+        const last = frame === frameCount - 1;
+        writeHeader(view, offset, {
+            kind: AUDIO_UPLOAD.KIND_AUDIO,
+            streamId,
+            chunkIndex: firstChunk + frame,
+            sampleRate,
+            isFinal: last && upload.isFinal !== false
+        }, (end - start) * 2);
+        offset += AUDIO_UPLOAD.HEADER_SIZE;
+        for (let i = start; i < end; i++, offset += 2) {
+            view.setInt16(offset, pcm[i], true);
+        }
+    }
+    return out;
+}
@@ -19,9 +19,7 @@ export class RingBuffer {
      */
     push(data) {
         if (Array.isArray(data) || data instanceof Float32Array || data instanceof Int16Array) {
-            for (let i = 0; i < data.length; i++) {
-                this.pushSingle(data[i]);
-            }
+            this.pushFrom(data, data.length);
         } else {
             this.pushSingle(data);
         }
@@ -36,6 +34,47 @@ export class RingBuffer {
         this.count = Math.min(this.count + 1, this.capacity);
     }
 
+    /**
+     * Add the first `length` samples of an array, without allocating
+     * Only the last `capacity` samples are kept when length exceeds it
+     */
+    pushFrom(source, length) {
+        let from = 0;
+        if (length > this.capacity) {
+            from = length - this.capacity;
+        }
+        let index = this.writeIndex;
+        for (let i = from; i < length; i++) {
+            this.buffer[index] = source[i];
+            if (++index === this.capacity) index = 0;
+        }
+        this.writeIndex = index;
+        this.count = Math.min(this.count + length - from, this.capacity);
+    }
+
+    /**
+     * Add the last N samples of another ring buffer, without allocating
+     */
+    pushLastOf(other, samples) {
+        const numSamples = Math.min(samples, other.count, this.capacity);
+        let readIndex = (other.writeIndex - numSamples + other.capacity) % other.capacity;
+        let index = this.writeIndex;
+        for (let i = 0; i < numSamples; i++) {
+            this.buffer[index] = other.buffer[readIndex];
+            if (++readIndex === other.capacity) readIndex = 0;
+            if (++index === this.capacity) index = 0;
+        }
+        this.writeIndex = index;
+        this.count = Math.min(this.count + numSamples, this.capacity);
+    }
+
+    /**
+     * Drop all but the last N samples
+     */
+    keepLast(samples) {
+        this.count = Math.max(0, Math.min(Math.floor(samples), this.count));
+    }
+
     /**
      * Read last N samples from buffer
      */
@@ -9,6 +9,29 @@ const REMOTE_CONFIG = {
     ID_CHARS: 'ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789'
 };
 
+// Motor intensity: the firmware takes a uint16 duty cycle in 0.01% steps.
+// The 0-255 scale remains for patterns, AI replies and legacy remote commands.
+export const MOTOR_DUTY = {
+    MAX: 10000,
+    PWM_MAX: 255
+};
+
+/**
+ * Convert a 0-255 value (fractions kept) to a 0-10000 duty cycle
+ */
+export function pwmToDuty(pwm) {
+    const clamped = Math.max(0, Math.min(MOTOR_DUTY.PWM_MAX, pwm));
+    return Math.round(clamped * MOTOR_DUTY.MAX / MOTOR_DUTY.PWM_MAX);
+}
+
+/**
+ * Convert a 0-10000 duty cycle to the nearest 0-255 value (for display and legacy callbacks)
+ */
+export function dutyToPwm(duty) {
+    const clamped = Math.max(0, Math.min(MOTOR_DUTY.MAX, duty));
+    return Math.round(clamped * MOTOR_DUTY.PWM_MAX / MOTOR_DUTY.MAX);
+}
+
 // Utility Functions
 export const UTILS = {
     /**
@@ -0,0 +1,229 @@
+/**
+ * Pattern Codec - Binary motor pattern format with delta encoding
+ *
+ * Compact form of a library pattern for uploading to the device and for
+ * syncing libraries between users (see vibration_motor_ble/vm_pattern.h):
+ *
+ *   [magic 'D' 'P'][version][flags]
+ *   varint  duration (ms)
+ *   varint  frame count
+ *   [varint meta length][meta]      flags bit 1: UTF-8 JSON with id, names, category
+ *   records until all frames are produced:
+ *     varint  (dt << 1) | run       dt: ms since the previous frame
+ *     varint  zigzag(dp)            dp: pwm change from the previous frame
+ *     [varint count - 2]            run: the same step repeats count times
+ *   u16     CRC16 (CCITT, init 0, as the SDK's CRC16()), little-endian
+ *
+ * The first frame is a delta from (0 ms, pwm 0). A run covers holds
+ * (dp = 0) and linear ramps. flags bit 0 is the loop flag. flags bit 2 is
+ * reserved for frames on the 0-10000 duty scale; pwm stays 0-255 for now
+ * (see vm_pattern.h) and decoders reject the bit.
+ */
+
+export const PATTERN_CODEC = {
+    MAGIC_0: 0x44,          // 'D'
+    MAGIC_1: 0x50,          // 'P'
+    VERSION: 1,
+    HEADER_SIZE: 4,
+    CRC_SIZE: 2,
+    FLAG_LOOP: 0x01,
+    FLAG_META: 0x02,
+    FLAG_PWM16: 0x04,       // Reserved, rejected
+    PWM_MAX: 255,
+    META_FIELDS: ['id', 'name', 'name_sp', 'description', 'description_sp', 'category']
+};
+
+/**
+ * CRC16-CCITT with init 0 (matches the SDK's CRC16() and OTA verification)
+ */
+export function patternCrc16(bytes, length = bytes.length) {
+    let crc = 0;
+    for (let i = 0; i < length; i++) {
+        crc ^= bytes[i] << 8;
+        for (let bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? ((crc << 1) ^ 0x1021) & 0xFFFF : (crc << 1) & 0xFFFF;
+        }
+    }
+    return crc;
+}
+
+class ByteWriter {
+    constructor() {
+        this.bytes = new Uint8Array(64);
+        this.length = 0;
+    }
+
+    reserve(n) {
+        if (this.length + n <= this.bytes.length) return;
+        const grown = new Uint8Array(Math.max(this.bytes.length * 2, this.length + n));
+        grown.set(this.bytes.subarray(0, this.length));
+        this.bytes = grown;
+    }
+
+    byte(b) {
+        this.reserve(1);
+        this.bytes[this.length++] = b;
+    }
+
+    varint(value) {
+        if (!Number.isInteger(value) || value < 0 || value > 0xFFFFFFFF) {
+            throw new Error(`Pattern value out of range: ${value}`);
+        }
+        do {
+            const b = value % 128;
+            value = Math.floor(value / 128);
+            this.byte(value ? b | 0x80 : b);
+        } while (value);
+    }
+
+    raw(bytes) {
+        this.reserve(bytes.length);
+        this.bytes.set(bytes, this.length);
+        this.length += bytes.length;
+    }
+}
+
+function readVarint(bytes, state, end) {
+    let value = 0;
+    for (let i = 0; i < 5; i++) {
+        if (state.pos >= end) throw new Error('Pattern truncated');
+        const b = bytes[state.pos++];
+        if (i === 4 && (b & 0xF0)) throw new Error('Pattern varint too long');
+        value += (b & 0x7F) * 2 ** (7 * i);
+        if (!(b & 0x80)) return value;
+    }
+    throw new Error('Pattern varint too long');
+}
+
+const zigzag = (v) => (v < 0 ? -2 * v - 1 : 2 * v);
+const unzigzag = (v) => (v % 2 ? -(v + 1) / 2 : v / 2);
+
+/**
+ * Encode a library pattern
+ * @param {Object} pattern - { duration, loop, frames: [{ time, pwm }], id, name, ... }
+ * @param {Object} options - { meta: false } leaves out names and category
+ *                           (the form the device stores, vm_pattern_encode())
+ * @returns {Uint8Array}
+ */
+export function encodePattern(pattern, options = {}) {
+    const frames = pattern.frames || [];
+    const withMeta = options.meta !== false;
+    const out = new ByteWriter();
+
+    out.byte(PATTERN_CODEC.MAGIC_0);
+    out.byte(PATTERN_CODEC.MAGIC_1);
+    out.byte(PATTERN_CODEC.VERSION);
+    out.byte((pattern.loop ? PATTERN_CODEC.FLAG_LOOP : 0) | (withMeta ? PATTERN_CODEC.FLAG_META : 0));
+    out.varint(Math.round(pattern.duration || 0));
+    out.varint(frames.length);
+
+    if (withMeta) {
+        const meta = {};
+        for (const field of PATTERN_CODEC.META_FIELDS) {
+            if (pattern[field] !== undefined) meta[field] = pattern[field];
+        }
+        const metaBytes = new TextEncoder().encode(JSON.stringify(meta));
+        out.varint(metaBytes.length);
+        out.raw(metaBytes);
+    }
+
+    const times = frames.map((f) => Math.round(f.time));
+    const pwms = frames.map((f) => Math.round(f.pwm));
+    for (let i = 0; i < frames.length; i++) {
+        if (!(pwms[i] >= 0 && pwms[i] <= PATTERN_CODEC.PWM_MAX)) {
+            throw new Error(`Frame ${i}: pwm must be between 0 and 255`);
+        }
+        if (i > 0 && times[i] < times[i - 1]) {
+            throw new Error(`Frame ${i}: time goes backwards`);
+        }
+    }
+
+    let prevTime = 0;
+    let prevPwm = 0;
+    for (let i = 0; i < frames.length;) {
+        const dt = times[i] - prevTime;
+        const dp = pwms[i] - prevPwm;
+
+        // Following frames with the same step join the run
+        let run = 1;
+        while (i + run < frames.length &&
+               times[i + run] - times[i + run - 1] === dt &&
+               pwms[i + run] - pwms[i + run - 1] === dp) {
+            run++;
+        }
+
+        out.varint(dt * 2 + (run > 1 ? 1 : 0));
+        out.varint(zigzag(dp));
+        if (run > 1) out.varint(run - 2);
+
+        i += run;
+        prevTime = times[i - 1];
+        prevPwm = pwms[i - 1];
+    }
+
+    const crc = patternCrc16(out.bytes, out.length);
+    out.byte(crc & 0xFF);
+    out.byte(crc >> 8);
+    return out.bytes.slice(0, out.length);
+}
+
+/**
+ * Decode an encoded pattern; throws on a bad magic, version, CRC or record
+ * @param {Uint8Array|ArrayBuffer|number[]} data
+ * @returns {Object} pattern in the library shape (names only when encoded with meta)
+ */
+export function decodePattern(data) {
+    const bytes = data instanceof Uint8Array ? data : new Uint8Array(data);
+    if (bytes.length < PATTERN_CODEC.HEADER_SIZE + PATTERN_CODEC.CRC_SIZE ||
+        bytes[0] !== PATTERN_CODEC.MAGIC_0 || bytes[1] !== PATTERN_CODEC.MAGIC_1) {
+        throw new Error('Not a binary pattern');
+    }
+    if (bytes[2] !== PATTERN_CODEC.VERSION) {
+        throw new Error(`Unsupported pattern version ${bytes[2]}`);
+    }
+
+    const end = bytes.length - PATTERN_CODEC.CRC_SIZE;
+    const crc = bytes[end] | (bytes[end + 1] << 8);
+    if (patternCrc16(bytes, end) !== crc) {
+        throw new Error('Pattern CRC mismatch');
+    }
+
+    const flags = bytes[3];
+    if (flags & PATTERN_CODEC.FLAG_PWM16) {
+        throw new Error('Unsupported pattern: 16-bit frames');
+    }
+    const state = { pos: PATTERN_CODEC.HEADER_SIZE };
+    const duration = readVarint(bytes, state, end);
+    const count = readVarint(bytes, state, end);
+
+    let pattern = {};
+    if (flags & PATTERN_CODEC.FLAG_META) {
+        const metaLength = readVarint(bytes, state, end);
+        if (state.pos + metaLength > end) throw new Error('Pattern truncated');
+        pattern = JSON.parse(new TextDecoder().decode(bytes.subarray(state.pos, state.pos + metaLength)));
+        state.pos += metaLength;
+    }
+
+    const frames = new Array(count);
+    let time = 0;
+    let pwm = 0;
+    for (let n = 0; n < count;) {
+        const head = readVarint(bytes, state, end);
+        const dp = unzigzag(readVarint(bytes, state, end));
+        const repeat = head % 2 ? readVarint(bytes, state, end) + 2 : 1;
+        const dt = Math.floor(head / 2);
+        for (let r = 0; r < repeat && n < count; r++) {
+            time += dt;
+            pwm += dp;
+            if (pwm < 0 || pwm > PATTERN_CODEC.PWM_MAX) {
+                throw new Error(`Frame ${n}: pwm out of range`);
+            }
+            frames[n++] = { time, pwm };
+        }
+    }
+
+    pattern.duration = duration;
+    pattern.loop = (flags & PATTERN_CODEC.FLAG_LOOP) !== 0;
+    pattern.frames = frames;
+    return pattern;
+}
@@ -0,0 +1,273 @@
+// Binary audio uploads for directAudioToPWM.
+//
+// The client sends Content-Type application/x-dulaan-audio: a metadata
+// frame (JSON: msgHis, currentPwm, transcript, ...) followed by the PCM
+// frames of one stream. Every frame has a 20-byte little-endian header
+// (mirrors client/utils/audio-upload.js):
+//
+//   offset  size  field
+//   0       2     magic 'D' 'A'
+//   2       1     version (1)
+//   3       1     flags (bit 0: final frame of the utterance)
+//   4       1     codec (0: PCM s16le mono, 1: Opus, reserved)
+//   5       1     kind (0: audio, 1: metadata JSON)
+//   6       2     sample rate (Hz)
+//   8       4     streamId
+//   12      4     chunkIndex
+//   16      4     payload length in bytes
+//
+// AudioUploadDecoder is incremental: push() takes the body in whatever
+// pieces the transport delivers and decodes each frame as soon as it is
+// complete, appending the samples to one growing Int16Array. Nothing is
+// ever parsed as JSON except the small metadata frame.
+
+const os = require("os");
+
+const AUDIO_UPLOAD = {
+    CONTENT_TYPE: "application/x-dulaan-audio",
+    MAGIC_0: 0x44,
+    MAGIC_1: 0x41,
+    VERSION: 1,
+    HEADER_SIZE: 20,
+    FLAG_FINAL: 0x01,
+    CODEC_PCM16: 0,
+    CODEC_OPUS: 1,
+    KIND_AUDIO: 0,
+    KIND_META: 1,
+    MAX_PAYLOAD: 1 << 20,
+    MAX_SAMPLES: 16000 * 60
+};
+
+const LITTLE_ENDIAN = os.endianness() === "LE";
+
+class AudioUploadError extends Error {
+    constructor(message, status = 400) {
+        super(message);
+        this.name = "AudioUploadError";
+        this.status = status;
+    }
+}
+
+/**
+ * Incremental frame decoder
+ *
+ * options: { maxSamples, onFrame(header, payload) } - onFrame sees every
+ * frame as it is decoded, e.g. to start work before the body has arrived
+ */
+class AudioUploadDecoder {
+    constructor(options = {}) {
+        this.maxSamples = options.maxSamples || AUDIO_UPLOAD.MAX_SAMPLES;
+        this.onFrame = options.onFrame || null;
+
+        this.pending = null;        // bytes of an incomplete frame
+        this.header = null;         // parsed header awaiting its payload
+
+        this.meta = {};
+        this.streamId = null;
+        this.sampleRate = 0;
+        this.firstChunk = -1;
+        this.nextChunk = -1;
+        this.frames = 0;
+        this.isFinal = false;
+        this.bytes = 0;
+
+        this.pcm = new Int16Array(16000);
+        this.samples = 0;
+    }
+
+    /**
+     * Decode every complete frame in chunk (Buffer or Uint8Array)
+     */
+    push(chunk) {
+        let buf = Buffer.isBuffer(chunk) ? chunk : Buffer.from(chunk.buffer, chunk.byteOffset, chunk.byteLength);
+        this.bytes += buf.length;
+        if (this.pending) {
+            buf = Buffer.concat([this.pending, buf]);
+            this.pending = null;
+        }
+
+        let offset = 0;
+        for (;;) {
+            if (!this.header) {
+                if (buf.length - offset < AUDIO_UPLOAD.HEADER_SIZE) break;
+                this.header = this.readHeader(buf, offset);
+                offset += AUDIO_UPLOAD.HEADER_SIZE;
+            }
+            const length = this.header.payloadLength;
+            if (buf.length - offset < length) break;
+            this.frame(this.header, buf.subarray(offset, offset + length));
+            this.header = null;
+            offset += length;
+        }
+
+        if (offset < buf.length) {
+            // Copy so the transport's buffer is not retained
+            this.pending = Buffer.from(buf.subarray(offset));
+        }
+    }
+
+    /**
+     * Finish the body; resolves the upload into the handler's request shape
+     */
+    end() {
+        if (this.header || this.pending) {
+            throw new AudioUploadError("Truncated audio frame");
+        }
+        if (this.frames === 0 || this.streamId === null) {
+            throw new AudioUploadError("No audio frames in upload");
+        }
+        return {
+            ...this.meta,
+            audioData: this.pcm.subarray(0, this.samples),
+            sampleRate: this.sampleRate,
+            streamId: this.streamId,
+            chunkIndex: this.nextChunk - 1,
+            isFinal: this.isFinal
+        };
+    }
+
+    readHeader(buf, offset) {
+        if (buf[offset] !== AUDIO_UPLOAD.MAGIC_0 || buf[offset + 1] !== AUDIO_UPLOAD.MAGIC_1) {
+            throw new AudioUploadError("Bad audio frame magic");
+        }
+        if (buf[offset + 2] !== AUDIO_UPLOAD.VERSION) {
+            throw new AudioUploadError(`Unsupported audio frame version ${buf[offset + 2]}`);
+        }
+        const header = {
+            flags: buf[offset + 3],
+            codec: buf[offset + 4],
+            kind: buf[offset + 5],
+            sampleRate: buf.readUInt16LE(offset + 6),
+            streamId: buf.readUInt32LE(offset + 8),
+            chunkIndex: buf.readUInt32LE(offset + 12),
+            payloadLength: buf.readUInt32LE(offset + 16)
+        };
+        if (header.payloadLength > AUDIO_UPLOAD.MAX_PAYLOAD) {
+            throw new AudioUploadError(`Audio frame too large (${header.payloadLength} bytes)`, 413);
+        }
+        return header;
+    }
+
+    frame(header, payload) {
+        if (this.isFinal) {
+            throw new AudioUploadError("Data after the final audio frame");
+        }
+        if (header.kind === AUDIO_UPLOAD.KIND_META) {
+            try {
+                this.meta = JSON.parse(payload.toString("utf8"));
+            } catch (error) {
+                throw new AudioUploadError("Invalid metadata frame");
+            }
+        } else if (header.kind === AUDIO_UPLOAD.KIND_AUDIO) {
+            this.audio(header, payload);
+        } else {
+            throw new AudioUploadError(`Unknown audio frame kind ${header.kind}`);
+        }
+        if (this.onFrame) {
+            this.onFrame(header, payload);
+        }
+    }
+
+    audio(header, payload) {
+        if (header.codec !== AUDIO_UPLOAD.CODEC_PCM16) {
+            throw new AudioUploadError(`Unsupported audio codec ${header.codec}`, 415);
+        }
+        if (payload.length & 1) {
+            throw new AudioUploadError("Odd PCM payload length");
+        }
+        if (this.streamId === null) {
+            this.streamId = header.streamId;
+            this.sampleRate = header.sampleRate;
+            this.firstChunk = header.chunkIndex;
+            this.nextChunk = header.chunkIndex;
+        } else if (header.streamId !== this.streamId) {
+            throw new AudioUploadError("Audio frames from more than one stream");
+        }
+        if (header.chunkIndex !== this.nextChunk) {
+            throw new AudioUploadError(`Audio chunk ${header.chunkIndex} out of order, expected ${this.nextChunk}`);
+        }
+
+        const count = payload.length >> 1;
+        if (this.samples + count > this.maxSamples) {
+            throw new AudioUploadError("Audio upload too long", 413);
+        }
+        this.reserve(this.samples + count);
+        if (LITTLE_ENDIAN) {
+            new Uint8Array(this.pcm.buffer, this.samples * 2, payload.length).set(payload);
+        } else {
+            for (let i = 0; i < count; i++) {
+                this.pcm[this.samples + i] = payload.readInt16LE(i * 2);
+            }
+        }
+        this.samples += count;
+        this.nextChunk++;
+        this.frames++;
+        this.isFinal = (header.flags & AUDIO_UPLOAD.FLAG_FINAL) !== 0;
+    }
+
+    reserve(samples) {
+        if (samples <= this.pcm.length) return;
+        let capacity = this.pcm.length * 2;
+        while (capacity < samples) capacity *= 2;
+        const grown = new Int16Array(Math.min(capacity, this.maxSamples));
+        grown.set(this.pcm.subarray(0, this.samples));
+        this.pcm = grown;
+    }
+}
+
+/**
+ * True when the request carries a binary audio upload
+ */
+function isAudioUpload(req) {
+    const type = (req.get ? req.get("content-type") : req.headers?.["content-type"]) || "";
+    return type.split(";")[0].trim().toLowerCase() === AUDIO_UPLOAD.CONTENT_TYPE;
+}
+
+/**
+ * Decode an upload from a request
+ *
+ * Frames are decoded from req.rawBody when the framework has already
+ * buffered the body (Cloud Functions), otherwise from the request stream as
+ * the pieces arrive.
+ */
+function readAudioUpload(req, options = {}) {
+    const decoder = new AudioUploadDecoder(options);
+    if (Buffer.isBuffer(req.rawBody)) {
+        decoder.push(req.rawBody);
+        return Promise.resolve(decoder.end());
+    }
+    return new Promise((resolve, reject) => {
+        let failed = false;
+        req.on("data", (chunk) => {
+            if (failed) return;
+            try {
+                decoder.push(chunk);
+            } catch (error) {
+                failed = true;
+                reject(error);
+            }
+        });
+        req.on("end", () => {
+            if (failed) return;
+            try {
+                resolve(decoder.end());
+            } catch (error) {
+                reject(error);
+            }
+        });
+        req.on("error", (error) => {
+            if (!failed) {
+                failed = true;
+                reject(error);
+            }
+        });
+    });
+}
+
+module.exports = {
+    AUDIO_UPLOAD,
+    AudioUploadError,
+    AudioUploadDecoder,
+    isAudioUpload,
+    readAudioUpload
+};
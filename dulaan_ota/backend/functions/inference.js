@@ -0,0 +1,511 @@
+// Inference backends and decision cache for directAudioToPWM.
+//
+// A backend turns one request (16-bit audio, current PWM, history, and an
+// optional transcript from on-device speech recognition) into a decision:
+//   { intentDetected, transcription, pwm, response, confidence }
+// Backends are created once per function instance and reused across
+// invocations, so clients and connections survive warm starts.
+//
+// - gemini:  audio to Gemini (the production path)
+// - keyword: deterministic rules on the transcript, no network; a local
+//            stand-in for tests and offline development
+//
+// Decisions are cached for a short time keyed on the normalized transcript
+// and the current PWM. The client sends the text of its on-device
+// recognizer with the audio, so a repeated command is answered from the
+// cache without a model round-trip. A model decision is stored under the
+// client's text only when the model heard the same words.
+
+const os = require("os");
+
+const DEFAULT_SAMPLE_RATE = 16000;
+const PWM_MAX = 255;
+
+const INFERENCE_DEFAULTS = {
+    backend: "gemini",
+    model: "gemini-2.5-flash",
+    cacheTtlMs: 30000,
+    cacheSize: 256,
+    historyLength: 10
+};
+
+// 16-bit mono WAV; the samples are copied once into the output buffer
+function createWavBuffer(int16Data, sampleRate) {
+    const length = int16Data.length;
+    const buffer = Buffer.alloc(44 + length * 2);
+
+    buffer.write("RIFF", 0, "ascii");
+    buffer.writeUInt32LE(36 + length * 2, 4);
+    buffer.write("WAVE", 8, "ascii");
+    buffer.write("fmt ", 12, "ascii");
+    buffer.writeUInt32LE(16, 16);
+    buffer.writeUInt16LE(1, 20);
+    buffer.writeUInt16LE(1, 22);
+    buffer.writeUInt32LE(sampleRate, 24);
+    buffer.writeUInt32LE(sampleRate * 2, 28);
+    buffer.writeUInt16LE(2, 32);
+    buffer.writeUInt16LE(16, 34);
+    buffer.write("data", 36, "ascii");
+    buffer.writeUInt32LE(length * 2, 40);
+
+    if (os.endianness() === "LE") {
+        Buffer.from(int16Data.buffer, int16Data.byteOffset, length * 2).copy(buffer, 44);
+    } else {
+        for (let i = 0; i < length; i++) {
+            buffer.writeInt16LE(int16Data[i], 44 + i * 2);
+        }
+    }
+    return buffer;
+}
+
+function clampPwm(value, fallback) {
+    const parsed = parseInt(value);
+    return Math.max(0, Math.min(PWM_MAX, isNaN(parsed) ? fallback : parsed));
+}
+
+function normalizeTranscript(text) {
+    return String(text || "")
+        .toLowerCase()
+        .replace(/[^\p{L}\p{N}%\s]/gu, " ")
+        .replace(/\s+/g, " ")
+        .trim();
+}
+
+// ============================================================================
+// Keyword backend
+// ============================================================================
+
+const NUMBER_WORDS = {
+    zero: 0, one: 1, two: 2, three: 3, four: 4, five: 5,
+    six: 6, seven: 7, eight: 8, nine: 9, ten: 10
+};
+
+// Checked in order; the first rule that matches decides
+const KEYWORD_RULES = [
+    { match: /\b(stop|off|pause|enough)\b/, pwm: () => 0, response: "Stopping the motor" },
+    { match: /\b(max|maximum|full|strongest|highest)\b/, pwm: () => PWM_MAX, response: "Motor at maximum" },
+    { match: /\b(min|minimum|lowest|gentlest)\b/, pwm: () => 25, response: "Motor at minimum" },
+    { match: /\bhalf\b/, pwm: () => 128, response: "Motor at half power" },
+    { match: /\b(stronger|harder|faster|more|increase|up|higher)\b/, pwm: (current) => current + 50, response: "Increasing motor intensity" },
+    { match: /\b(weaker|softer|slower|less|decrease|down|lower|gentler)\b/, pwm: (current) => current - 50, response: "Decreasing motor intensity" },
+    { match: /\b(on|start|begin|go)\b/, pwm: (current) => (current > 0 ? current : 150), response: "Turning the motor on" }
+];
+
+class KeywordBackend {
+    constructor() {
+        this.name = "keyword";
+    }
+
+    // "50 percent", "level 7" (of 10), "set to 200"
+    parseLevel(text) {
+        let m = text.match(/\b(\d{1,3})\s*(%|percent)/);
+        if (m) {
+            return Math.round(Math.min(100, parseInt(m[1])) * PWM_MAX / 100);
+        }
+        m = text.match(/\blevel (\d{1,2}|\w+)\b/);
+        if (m) {
+            const level = /^\d+$/.test(m[1]) ? parseInt(m[1]) : NUMBER_WORDS[m[1]];
+            if (level !== undefined) {
+                return Math.round(Math.min(10, level) * PWM_MAX / 10);
+            }
+        }
+        m = text.match(/\b(?:to|at) (\d{1,3})\b/);
+        if (m) {
+            return Math.min(PWM_MAX, parseInt(m[1]));
+        }
+        return null;
+    }
+
+    async infer(request) {
+        const text = normalizeTranscript(request.transcript);
+        const current = request.currentPwm;
+
+        if (!text) {
+            return {
+                intentDetected: false,
+                transcription: "",
+                pwm: current,
+                response: "I didn't catch that",
+                confidence: 0
+            };
+        }
+
+        const level = this.parseLevel(text);
+        if (level !== null) {
+            return {
+                intentDetected: true,
+                transcription: request.transcript,
+                pwm: level,
+                response: `Setting the motor to ${Math.round(level * 100 / PWM_MAX)}%`,
+                confidence: 0.9
+            };
+        }
+
+        for (const rule of KEYWORD_RULES) {
+            if (rule.match.test(text)) {
+                return {
+                    intentDetected: true,
+                    transcription: request.transcript,
+                    pwm: clampPwm(rule.pwm(current), current),
+                    response: rule.response,
+                    confidence: 0.8
+                };
+            }
+        }
+
+        return {
+            intentDetected: false,
+            transcription: request.transcript,
+            pwm: current,
+            response: "I'm a motor control assistant. I can help you control the motor device.",
+            confidence: 0.6
+        };
+    }
+}
+
+// ============================================================================
+// Gemini backend
+// ============================================================================
+
+function buildPrompt(request) {
+    const { currentPwm, history, streaming, isFinal, immediate, chunkIndex } = request;
+    const conversationHistory = history.map(msg => {
+        const user = msg.user || msg.transcript || "Unknown";
+        const assistant = msg.assistant || msg.response || "Unknown";
+        return `User: ${user}\nAssistant: ${assistant}`;
+    }).join("\n\n");
+
+    if (streaming && !isFinal) {
+        // Streaming mode - partial audio chunk
+        return `You are a motor control assistant processing streaming audio. This is a partial audio chunk in an ongoing conversation.
+
+Current motor PWM value: ${currentPwm} (0-255 scale, where 0=off, 255=maximum)
+Streaming mode: Chunk ${chunkIndex || 0}
+
+Previous conversation:
+${conversationHistory || "No previous conversation"}
+
+IMPORTANT: Only react to human voice. If you don't hear a human speaking, keep the current PWM value unchanged.
+
+Instructions for streaming:
+1. Listen to this audio chunk and provide partial understanding
+2. If you detect clear motor control intent, respond immediately with PWM changes
+3. For partial/unclear audio, provide partial transcription and keep current PWM
+4. Be responsive - users expect real-time feedback
+
+Respond in this exact JSON format:
+{
+  "intentDetected": true/false,
+  "partialTranscription": "what you understood so far",
+  "transcription": "leave empty for partial chunks",
+  "pwm": number (0-255),
+  "response": "brief response for partial chunks",
+  "confidence": number (0-1),
+  "isPartial": true
+}`;
+    }
+
+    // Regular mode or final streaming chunk
+    return `You are a motor control assistant. Listen to the audio and determine if the user wants to control a motor device.
+
+Current motor PWM value: ${currentPwm} (0-255 scale, where 0=off, 255=maximum)
+${immediate ? "IMMEDIATE MODE: Respond quickly for urgent control." : ""}
+${streaming ? "STREAMING MODE: This is the final chunk of a streaming conversation." : ""}
+
+Previous conversation:
+${conversationHistory || "No previous conversation"}
+
+IMPORTANT: Only react to human voice. If you don't hear a human speaking, keep the current PWM value unchanged.
+
+Instructions:
+1. Listen to the audio and understand what the user is saying
+2. Determine if they want to control the motor (turn on/off, increase/decrease intensity, set specific level)
+3. If motor control is intended, calculate the appropriate PWM value (0-255)
+4. If no motor control is intended, keep the current PWM value
+5. ${immediate ? "Prioritize speed and immediate motor control." : "Provide natural conversational responses."}
+
+Respond in this exact JSON format:
+{
+  "intentDetected": true/false,
+  "transcription": "what you heard",
+  "pwm": number (0-255),
+  "response": "your response to the user",
+  "confidence": number (0-1)
+}
+
+Examples:
+- "turn it on" → {"intentDetected": true, "transcription": "turn it on", "pwm": 150, "response": "Turning the motor on", "confidence": 0.9}
+- "make it stronger" → {"intentDetected": true, "transcription": "make it stronger", "pwm": ${Math.min(255, currentPwm + 50)}, "response": "Increasing motor intensity", "confidence": 0.9}
+- "what's the weather" → {"intentDetected": false, "transcription": "what's the weather", "pwm": ${currentPwm}, "response": "I'm a motor control assistant. I can help you control the motor device.", "confidence": 0.9}`;
+}
+
+class GeminiBackend {
+    constructor(options = {}) {
+        this.name = "gemini";
+        this.apiKey = options.apiKey || null;
+        this.modelName = options.model || INFERENCE_DEFAULTS.model;
+        this.logger = options.logger || console;
+        this.model = null;
+    }
+
+    // Created on first use and kept for the life of the instance. The key
+    // comes from the GEMINI_API_KEY secret, which is only in the environment
+    // of a running instance, not when the function is loaded for deploy.
+    getModel() {
+        if (!this.model) {
+            const apiKey = this.apiKey || process.env.GEMINI_API_KEY;
+            if (!apiKey) {
+                throw new Error("GEMINI_API_KEY is not set");
+            }
+            const { GoogleGenerativeAI } = require("@google/generative-ai");
+            const genAI = new GoogleGenerativeAI(apiKey);
+            this.model = genAI.getGenerativeModel({ model: this.modelName });
+        }
+        return this.model;
+    }
+
+    async infer(request) {
+        const wav = createWavBuffer(request.audio, request.sampleRate);
+        const result = await this.getModel().generateContent([
+            buildPrompt(request),
+            {
+                inlineData: {
+                    mimeType: "audio/wav",
+                    data: wav.toString("base64")
+                }
+            }
+        ]);
+
+        const responseText = result.response.text();
+        this.logger.log("Gemini direct audio response received", {
+            responseLength: responseText.length,
+            region: "europe-west1"
+        });
+
+        let llmResponse;
+        try {
+            // Extract JSON from response (handle potential markdown formatting)
+            const jsonMatch = responseText.match(/\{[\s\S]*\}/);
+            llmResponse = JSON.parse(jsonMatch ? jsonMatch[0] : responseText);
+        } catch (parseError) {
+            this.logger.error("Failed to parse Gemini response as JSON", {
+                response: responseText,
+                error: parseError.message,
+                region: "europe-west1"
+            });
+            throw new Error(`Failed to parse AI response: ${parseError.message}`);
+        }
+
+        return {
+            intentDetected: llmResponse.intentDetected === true || llmResponse.intentDetected === "true",
+            transcription: llmResponse.transcription || "Audio processed",
+            pwm: llmResponse.pwm,
+            response: llmResponse.response,
+            confidence: llmResponse.confidence
+        };
+    }
+}
+
+// ============================================================================
+// Decision cache
+// ============================================================================
+
+class DecisionCache {
+    constructor(options = {}) {
+        this.ttlMs = options.ttlMs !== undefined ? options.ttlMs : INFERENCE_DEFAULTS.cacheTtlMs;
+        this.maxEntries = options.maxEntries || INFERENCE_DEFAULTS.cacheSize;
+        this.now = options.now || Date.now;
+        this.entries = new Map();
+        this.hits = 0;
+        this.misses = 0;
+    }
+
+    // Relative commands ("stronger") depend on the current value
+    key(transcript, currentPwm) {
+        const text = normalizeTranscript(transcript);
+        return text ? `${text}|${currentPwm}` : null;
+    }
+
+    get(transcript, currentPwm) {
+        const key = this.key(transcript, currentPwm);
+        const entry = key && this.entries.get(key);
+        if (!entry || entry.expires <= this.now()) {
+            if (entry) this.entries.delete(key);
+            this.misses++;
+            return null;
+        }
+        this.hits++;
+        return entry.decision;
+    }
+
+    set(transcript, currentPwm, decision) {
+        const key = this.key(transcript, currentPwm);
+        if (!key || this.ttlMs <= 0) {
+            return;
+        }
+        // Map keeps insertion order: the first key is the oldest
+        this.entries.delete(key);
+        if (this.entries.size >= this.maxEntries) {
+            this.entries.delete(this.entries.keys().next().value);
+        }
+        this.entries.set(key, { decision, expires: this.now() + this.ttlMs });
+    }
+
+    clear() {
+        this.entries.clear();
+    }
+}
+
+function createBackend(name, options = {}) {
+    switch (name) {
+        case "keyword":
+            return new KeywordBackend(options);
+        case "gemini":
+            return new GeminiBackend(options);
+        default:
+            throw new Error(`Unknown inference backend: ${name}`);
+    }
+}
+
+// ============================================================================
+// Request handling
+// ============================================================================
+
+/**
+ * Request handler without the HTTP layer:
+ * handle(body, getHeader) resolves to { status, body }
+ *
+ * options: { backend (name or instance), cache (DecisionCache, false to
+ * disable), logger }; the backend defaults to INFERENCE_BACKEND
+ */
+function createDirectAudioHandler(options = {}) {
+    const logger = options.logger || console;
+    const backendOption = options.backend || process.env.INFERENCE_BACKEND || INFERENCE_DEFAULTS.backend;
+    const backend = typeof backendOption === "string" ? createBackend(backendOption, { logger }) : backendOption;
+    const cache = options.cache === false ? null : (options.cache || new DecisionCache());
+
+    async function handle(body, getHeader = () => undefined) {
+        if (!body || !body.audioData) {
+            return {
+                status: 400,
+                body: {
+                    success: false,
+                    error: "Missing audio data in request body",
+                    newPwmValue: body?.currentPwm || 100,
+                    msgHis: body?.msgHis || []
+                }
+            };
+        }
+
+        const {
+            audioData,
+            sampleRate = DEFAULT_SAMPLE_RATE,
+            currentPwm = 0,
+            msgHis = [],
+            transcript = null,
+            streamingMode = false,
+            isFinal = true,
+            chunkIndex = 0,
+            streamId = null,
+            immediateMode = false
+        } = body;
+
+        const request = {
+            audio: null,
+            sampleRate: sampleRate,
+            currentPwm: clampPwm(currentPwm, 0),
+            history: msgHis,
+            transcript,
+            streaming: !!(streamingMode || getHeader("X-Stream-Id")),
+            isFinal: isFinal || getHeader("X-Is-Final") === "true",
+            immediate: immediateMode || getHeader("X-Immediate") === "true",
+            chunkIndex: chunkIndex || getHeader("X-Chunk-Index"),
+            streamId: streamId || getHeader("X-Stream-Id")
+        };
+
+        logger.log("Processing audio input", {
+            audioDataLength: audioData.length,
+            currentPwm: request.currentPwm,
+            messageHistoryLength: msgHis.length,
+            streamingMode: request.streaming,
+            isFinal: request.isFinal,
+            chunkIndex: request.chunkIndex,
+            streamId: request.streamId,
+            immediateMode: request.immediate,
+            hasTranscript: !!transcript,
+            backend: backend.name,
+            region: "europe-west1"
+        });
+
+        // A repeated command is answered from the cache, without the audio
+        let decision = cache && transcript ? cache.get(transcript, request.currentPwm) : null;
+        const cached = !!decision;
+        if (!decision) {
+            // Binary uploads arrive as an Int16Array already; JSON as numbers
+            request.audio = audioData instanceof Int16Array ? audioData : new Int16Array(audioData);
+            decision = await backend.infer(request);
+            // A client transcript the model disagrees with is not trusted as a key
+            const heard = normalizeTranscript(decision.transcription);
+            if (cache && heard && (!transcript || normalizeTranscript(transcript) === heard)) {
+                cache.set(heard, request.currentPwm, decision);
+            }
+        }
+
+        const intentDetected = decision.intentDetected === true;
+        const transcription = decision.transcription || "Audio processed";
+        const newPwmValue = intentDetected ? clampPwm(decision.pwm, request.currentPwm) : request.currentPwm;
+        const response = decision.response || "Motor control processed";
+
+        // Update message history, keeping the last turns only
+        const updatedMsgHis = [...msgHis, {
+            user: transcription,
+            assistant: response,
+            timestamp: new Date().toISOString(),
+            pwm: newPwmValue,
+            intentDetected: intentDetected
+        }];
+        if (updatedMsgHis.length > INFERENCE_DEFAULTS.historyLength) {
+            updatedMsgHis.splice(0, updatedMsgHis.length - INFERENCE_DEFAULTS.historyLength);
+        }
+
+        logger.log("Direct audio processing completed successfully", {
+            transcription: transcription,
+            intentDetected: intentDetected,
+            oldPwm: request.currentPwm,
+            newPwm: newPwmValue,
+            backend: backend.name,
+            cached: cached,
+            region: "europe-west1"
+        });
+
+        return {
+            status: 200,
+            body: {
+                success: true,
+                transcription: transcription,
+                newPwmValue: newPwmValue,
+                response: response,
+                intentDetected: intentDetected,
+                msgHis: updatedMsgHis,
+                processingMethod: "direct-audio-to-pwm",
+                backend: backend.name,
+                cached: cached
+            }
+        };
+    }
+
+    handle.backend = backend;
+    handle.cache = cache;
+    return handle;
+}
+
+module.exports = {
+    INFERENCE_DEFAULTS,
+    KeywordBackend,
+    GeminiBackend,
+    DecisionCache,
+    createBackend,
+    createDirectAudioHandler,
+    createWavBuffer,
+    normalizeTranscript
+};
@@ -0,0 +1,304 @@
+/**
+ * Audio Upload Test - binary PCM frames against the JSON number array
+ * Run with: node test-audio-upload.js
+ *
+ * Encodes with the client's utils/audio-upload.js and decodes with
+ * audio-upload.js, checks the error cases, then runs a local HTTP emulator
+ * of directAudioToPWM (keyword stand-in backend) and measures payload size,
+ * client encode time and server parse time for both formats.
+ */
+
+const http = require("http");
+const path = require("path");
+const { pathToFileURL } = require("url");
+
+const {
+    AUDIO_UPLOAD,
+    AudioUploadError,
+    AudioUploadDecoder,
+    isAudioUpload,
+    readAudioUpload
+} = require("./audio-upload");
+const { createDirectAudioHandler } = require("./inference");
+
+const SAMPLE_RATE = 16000;
+const quietLogger = { log() {}, warn() {}, error() {} };
+
+function speech(samples) {
+    const out = new Int16Array(samples);
+    for (let i = 0; i < samples; i++) {
+        out[i] = Math.round(6000 * Math.sin(2 * Math.PI * 220 * i / SAMPLE_RATE) +
+                            3000 * Math.sin(2 * Math.PI * 1170 * i / SAMPLE_RATE));
+    }
+    return out;
+}
+
+function sameSamples(a, b) {
+    if (a.length !== b.length) return false;
+    for (let i = 0; i < a.length; i++) {
+        if (a[i] !== b[i]) return false;
+    }
+    return true;
+}
+
+function timeUs(fn, runs) {
+    let best = Infinity;
+    for (let round = 0; round < 5; round++) {
+        const start = process.hrtime.bigint();
+        for (let i = 0; i < runs; i++) fn();
+        best = Math.min(best, Number(process.hrtime.bigint() - start) / 1e3 / runs);
+    }
+    return best;
+}
+
+const sleep = (ms) => new Promise((resolve) => setTimeout(resolve, ms));
+
+class AudioUploadTest {
+    constructor(client) {
+        this.client = client;
+        this.results = [];
+    }
+
+    addResult(test, success, details = "") {
+        this.results.push({ test, success, details });
+        console.log(`${success ? "✅" : "❌"} ${test}${details ? ": " + details : ""}`);
+    }
+
+    encode(pcm, options = {}) {
+        return Buffer.from(this.client.encodeAudioUpload({
+            streamId: options.streamId || 7,
+            pcm,
+            sampleRate: SAMPLE_RATE,
+            isFinal: options.isFinal,
+            firstChunkIndex: options.firstChunkIndex,
+            meta: options.meta || { msgHis: [], currentPwm: 90, transcript: "make it stronger" }
+        }));
+    }
+
+    expectError(name, body, status) {
+        const decoder = new AudioUploadDecoder({ maxSamples: SAMPLE_RATE * 2 });
+        try {
+            decoder.push(body);
+            decoder.end();
+            this.addResult(name, false, "accepted");
+        } catch (error) {
+            this.addResult(name, error instanceof AudioUploadError && error.status === status,
+                `${error.status} ${error.message}`);
+        }
+    }
+
+    /**
+     * Test 1: Round trip through the client encoder and the server decoder
+     */
+    testRoundTrip() {
+        const pcm = speech(SAMPLE_RATE + 123);
+        const body = this.encode(pcm);
+        const decoder = new AudioUploadDecoder();
+        decoder.push(body);
+        const upload = decoder.end();
+
+        const frames = Math.ceil(pcm.length / this.client.AUDIO_UPLOAD.FRAME_SAMPLES);
+        this.addResult("Round trip", sameSamples(upload.audioData, pcm) &&
+            upload.audioData instanceof Int16Array && upload.sampleRate === SAMPLE_RATE &&
+            upload.streamId === 7 && upload.isFinal && upload.chunkIndex === frames - 1 &&
+            upload.currentPwm === 90 && upload.transcript === "make it stronger",
+            `${body.length} bytes, ${frames} audio frames`);
+
+        this.addResult("Header layout shared", this.client.AUDIO_UPLOAD.HEADER_SIZE === AUDIO_UPLOAD.HEADER_SIZE &&
+            this.client.AUDIO_UPLOAD.CONTENT_TYPE === AUDIO_UPLOAD.CONTENT_TYPE &&
+            body.length === AUDIO_UPLOAD.HEADER_SIZE * (frames + 1) + pcm.length * 2 +
+                Buffer.byteLength(JSON.stringify({ msgHis: [], currentPwm: 90, transcript: "make it stronger" })));
+    }
+
+    /**
+     * Test 2: Frames decode the same however the body is split
+     */
+    testSplitPushes() {
+        const pcm = speech(9000);
+        const body = this.encode(pcm);
+        let seed = 1;
+        const failures = [];
+        for (const maxPiece of [1, 3, 19, 20, 21, 97, 4096]) {
+            const decoder = new AudioUploadDecoder();
+            for (let offset = 0; offset < body.length;) {
+                seed = (seed * 1103515245 + 12345) >>> 0;
+                const piece = 1 + (seed % maxPiece);
+                decoder.push(body.subarray(offset, offset + piece));
+                offset += piece;
+            }
+            if (!sameSamples(decoder.end().audioData, pcm)) failures.push(maxPiece);
+        }
+        this.addResult("Split pushes decode identically", failures.length === 0,
+            failures.length ? `failed for pieces up to ${failures.join(", ")}` : "pieces of 1..4096 bytes");
+    }
+
+    /**
+     * Test 3: Malformed uploads are rejected with a status
+     */
+    testErrors() {
+        const pcm = speech(8000);
+        const good = this.encode(pcm);
+
+        const badMagic = Buffer.from(good);
+        badMagic[0] = 0x58;
+        this.expectError("Bad magic rejected", badMagic, 400);
+
+        const opus = Buffer.from(good);
+        const firstAudio = AUDIO_UPLOAD.HEADER_SIZE + good.readUInt32LE(16);
+        opus[firstAudio + 4] = AUDIO_UPLOAD.CODEC_OPUS;
+        this.expectError("Opus reported as unsupported", opus, 415);
+
+        const reordered = Buffer.from(good);
+        reordered.writeUInt32LE(5, firstAudio + 12);
+        this.expectError("Out-of-order chunk rejected", reordered, 400);
+
+        this.expectError("Truncated body rejected", good.subarray(0, good.length - 1), 400);
+        this.expectError("Data after final frame rejected", Buffer.concat([good, this.encode(pcm, { firstChunkIndex: 3 })]), 400);
+        this.expectError("Over-long upload rejected", this.encode(speech(SAMPLE_RATE * 3)), 413);
+    }
+
+    /**
+     * Local emulator of directAudioToPWM: JSON bodies are buffered and parsed
+     * the way the framework does; binary bodies go through readAudioUpload
+     * from the request stream
+     */
+    startEmulator() {
+        const handle = createDirectAudioHandler({ backend: "keyword", cache: false, logger: quietLogger });
+        this.server = http.createServer(async (req, res) => {
+            try {
+                let body;
+                let firstFrameAt = 0;
+                if (isAudioUpload(req)) {
+                    body = await readAudioUpload(req, {
+                        onFrame: () => { if (!firstFrameAt) firstFrameAt = Date.now(); }
+                    });
+                } else {
+                    const pieces = [];
+                    for await (const piece of req) pieces.push(piece);
+                    body = JSON.parse(Buffer.concat(pieces).toString("utf8"));
+                }
+                const result = await handle(body, (name) => req.headers[name.toLowerCase()]);
+                res.writeHead(result.status, { "Content-Type": "application/json", "X-First-Frame-At": String(firstFrameAt) });
+                res.end(JSON.stringify(result.body));
+            } catch (error) {
+                res.writeHead(error.status || 500, { "Content-Type": "application/json" });
+                res.end(JSON.stringify({ success: false, error: error.message }));
+            }
+        });
+        return new Promise((resolve) => this.server.listen(0, "127.0.0.1", resolve));
+    }
+
+    post(contentType, pieces, delayMs = 0) {
+        return new Promise((resolve, reject) => {
+            const req = http.request({
+                host: "127.0.0.1",
+                port: this.server.address().port,
+                method: "POST",
+                headers: { "Content-Type": contentType }
+            }, (res) => {
+                const chunks = [];
+                res.on("data", (c) => chunks.push(c));
+                res.on("end", () => resolve({
+                    status: res.statusCode,
+                    firstFrameAt: Number(res.headers["x-first-frame-at"]),
+                    body: JSON.parse(Buffer.concat(chunks).toString("utf8"))
+                }));
+            });
+            req.on("error", reject);
+            (async () => {
+                for (const piece of pieces) {
+                    req.write(piece);
+                    if (delayMs) await sleep(delayMs);
+                }
+                req.end();
+            })();
+        });
+    }
+
+    /**
+     * Test 4: Both formats through the emulator; binary arrives in pieces
+     */
+    async testEmulator() {
+        await this.startEmulator();
+        const pcm = speech(SAMPLE_RATE);
+        const meta = { msgHis: [], currentPwm: 90, transcript: "make it stronger" };
+
+        const json = await this.post("application/json", [JSON.stringify({ ...meta, audioData: Array.from(pcm) })]);
+        this.addResult("Emulator JSON upload", json.status === 200 && json.body.newPwmValue === 140,
+            `newPwmValue ${json.body.newPwmValue}`);
+
+        const body = this.encode(pcm, { meta });
+        const pieces = [];
+        for (let offset = 0; offset < body.length; offset += 4096) pieces.push(body.subarray(offset, offset + 4096));
+        const sentAt = Date.now();
+        const binary = await this.post(AUDIO_UPLOAD.CONTENT_TYPE, pieces, 5);
+        const doneAt = Date.now();
+        this.addResult("Emulator binary upload", binary.status === 200 && binary.body.newPwmValue === 140 &&
+            binary.body.transcription === json.body.transcription);
+        this.addResult("Frames decoded while the body streams in",
+            binary.firstFrameAt > 0 && binary.firstFrameAt < doneAt - 20,
+            `first frame ${binary.firstFrameAt - sentAt} ms after send, upload took ${doneAt - sentAt} ms`);
+
+        const rejected = await this.post(AUDIO_UPLOAD.CONTENT_TYPE, [body.subarray(0, 100)]);
+        this.addResult("Emulator rejects a truncated upload", rejected.status === 400, rejected.body.error);
+
+        await new Promise((resolve) => this.server.close(resolve));
+    }
+
+    /**
+     * Benchmark: payload size, client encode and server parse time
+     */
+    benchmark() {
+        console.log("\nPayload and parse cost, JSON number array vs binary frames:");
+        console.log("  seconds   JSON bytes  binary bytes   encode JSON / binary    parse JSON / binary");
+        const meta = { msgHis: [], currentPwm: 90 };
+        let ratio = 0;
+        let parseRatio = 0;
+        for (const seconds of [1, 3, 10]) {
+            const pcm = speech(SAMPLE_RATE * seconds);
+            const runs = Math.max(5, 60 / seconds);
+
+            // Client: what ApiService sent before, and what it sends now
+            const jsonBody = JSON.stringify({ ...meta, audioData: Array.from(pcm) });
+            const binaryBody = Buffer.from(this.client.encodeAudioUpload({ streamId: 1, pcm, sampleRate: SAMPLE_RATE, meta }));
+            const encodeJson = timeUs(() => JSON.stringify({ ...meta, audioData: Array.from(pcm) }), runs);
+            const encodeBinary = timeUs(() => this.client.encodeAudioUpload({ streamId: 1, pcm, sampleRate: SAMPLE_RATE, meta }), runs);
+
+            // Server: body-parser JSON plus the Int16Array copy, vs the decoder
+            const jsonBytes = Buffer.from(jsonBody);
+            const parseJson = timeUs(() => new Int16Array(JSON.parse(jsonBytes.toString("utf8")).audioData), runs);
+            const parseBinary = timeUs(() => {
+                const decoder = new AudioUploadDecoder({ maxSamples: SAMPLE_RATE * 30 });
+                decoder.push(binaryBody);
+                decoder.end();
+            }, runs);
+
+            console.log(`  ${String(seconds).padStart(7)} ${String(jsonBytes.length).padStart(12)} ${String(binaryBody.length).padStart(13)}` +
+                `   ${(encodeJson / 1000).toFixed(2).padStart(7)} / ${(encodeBinary / 1000).toFixed(2).padStart(5)} ms` +
+                `   ${(parseJson / 1000).toFixed(2).padStart(7)} / ${(parseBinary / 1000).toFixed(2).padStart(5)} ms`);
+            if (seconds === 3) {
+                ratio = jsonBytes.length / binaryBody.length;
+                parseRatio = parseJson / parseBinary;
+            }
+        }
+        console.log("");
+
+        this.addResult("Binary payload at least 2x smaller", ratio >= 2, `${ratio.toFixed(1)}x for 3 s`);
+        this.addResult("Binary parse faster than JSON", parseRatio > 1, `${parseRatio.toFixed(0)}x for 3 s`);
+    }
+
+    async run() {
+        this.testRoundTrip();
+        this.testSplitPushes();
+        this.testErrors();
+        await this.testEmulator();
+        this.benchmark();
+
+        const failed = this.results.filter((r) => !r.success).length;
+        console.log(`\n${this.results.length - failed}/${this.results.length} passed`);
+        process.exitCode = failed ? 1 : 0;
+    }
+}
+
+import(pathToFileURL(path.join(__dirname, "../client/utils/audio-upload.js")).href)
+    .then((client) => new AudioUploadTest(client).run());
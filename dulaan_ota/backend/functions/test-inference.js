@@ -0,0 +1,275 @@
+/**
+ * Inference Test - backends, decision cache and request latency
+ * Run with: node test-inference.js
+ *
+ * Runs the directAudioToPWM request handler with the keyword stand-in (no
+ * network, no Firebase) and with the Gemini backend on a fake model, then
+ * measures request latency with the stand-in for cache misses and hits.
+ */
+
+const {
+    KeywordBackend,
+    GeminiBackend,
+    DecisionCache,
+    createDirectAudioHandler,
+    createWavBuffer
+} = require("./inference");
+
+const SAMPLE_RATE = 16000;
+const BENCH_REQUESTS = 2000;
+
+const quietLogger = { log() {}, warn() {}, error() {} };
+
+// One second of speech-band audio as the client sends it (JSON array)
+function audioArray(samples = SAMPLE_RATE) {
+    const out = new Array(samples);
+    for (let i = 0; i < samples; i++) {
+        out[i] = Math.round(8000 * Math.sin(2 * Math.PI * 300 * i / SAMPLE_RATE));
+    }
+    return out;
+}
+
+// WAV encoding before the backend module: DataView per sample, then a Buffer copy
+function legacyWavBase64(audioData) {
+    const int16Data = new Int16Array(audioData);
+    const length = int16Data.length;
+    const buffer = new ArrayBuffer(44 + length * 2);
+    const view = new DataView(buffer);
+    const writeString = (offset, string) => {
+        for (let i = 0; i < string.length; i++) {
+            view.setUint8(offset + i, string.charCodeAt(i));
+        }
+    };
+    writeString(0, "RIFF");
+    view.setUint32(4, 36 + length * 2, true);
+    writeString(8, "WAVE");
+    writeString(12, "fmt ");
+    view.setUint32(16, 16, true);
+    view.setUint16(20, 1, true);
+    view.setUint16(22, 1, true);
+    view.setUint32(24, SAMPLE_RATE, true);
+    view.setUint32(28, SAMPLE_RATE * 2, true);
+    view.setUint16(32, 2, true);
+    view.setUint16(34, 16, true);
+    writeString(36, "data");
+    view.setUint32(40, length * 2, true);
+    for (let i = 0; i < length; i++) {
+        view.setInt16(44 + i * 2, int16Data[i], true);
+    }
+    return Buffer.from(buffer).toString("base64");
+}
+
+class InferenceTest {
+    constructor() {
+        this.results = [];
+    }
+
+    addResult(test, success, details = "") {
+        this.results.push({ test, success, details });
+        console.log(`${success ? "✅" : "❌"} ${test}${details ? ": " + details : ""}`);
+    }
+
+    /**
+     * Test 1: Keyword rules
+     */
+    async testKeywords() {
+        const backend = new KeywordBackend();
+        const cases = [
+            ["Turn it on", 0, true, 150],
+            ["turn it on", 90, true, 90],
+            ["Stop!", 200, true, 0],
+            ["turn it off", 200, true, 0],
+            ["make it stronger", 100, true, 150],
+            ["a bit softer please", 30, true, 0],
+            ["Stronger", 240, true, 255],
+            ["full power", 10, true, 255],
+            ["half", 10, true, 128],
+            ["set it to 50 percent", 0, true, 128],
+            ["level seven", 0, true, 179],
+            ["set to 200", 0, true, 200],
+            ["what's the weather", 77, false, 77],
+            ["", 77, false, 77]
+        ];
+        const failures = [];
+        for (const [transcript, currentPwm, intent, pwm] of cases) {
+            const d = await backend.infer({ transcript, currentPwm });
+            if (d.intentDetected !== intent || d.pwm !== pwm) {
+                failures.push(`"${transcript}" -> ${d.intentDetected}/${d.pwm}`);
+            }
+        }
+        this.addResult("Keyword rules", failures.length === 0,
+            failures.length ? failures.join(", ") : `${cases.length} phrases`);
+    }
+
+    /**
+     * Test 2: Cache entries expire and are keyed on transcript and PWM
+     */
+    testCache() {
+        let now = 1000;
+        const cache = new DecisionCache({ ttlMs: 100, maxEntries: 2, now: () => now });
+        const decision = { intentDetected: true, pwm: 150 };
+
+        cache.set("Turn it ON!", 0, decision);
+        const hit = cache.get("turn it on", 0) === decision;
+        const otherPwm = cache.get("turn it on", 90) === null;
+        now += 100;
+        const expired = cache.get("turn it on", 0) === null;
+        this.addResult("Cache hit, key and TTL", hit && otherPwm && expired);
+
+        cache.set("a", 0, decision);
+        cache.set("b", 0, decision);
+        cache.set("c", 0, decision);
+        this.addResult("Cache size bounded", cache.entries.size === 2 && cache.get("a", 0) === null);
+    }
+
+    /**
+     * Test 3: The handler answers a repeated command from the cache
+     */
+    async testHandler() {
+        const handle = createDirectAudioHandler({ backend: "keyword", logger: quietLogger });
+        const audioData = audioArray(1600);
+
+        const first = await handle({ audioData, currentPwm: 100, transcript: "make it stronger", msgHis: [] });
+        const second = await handle({ audioData, currentPwm: 100, transcript: "Make it stronger.", msgHis: first.body.msgHis });
+        this.addResult("Handler decision", first.status === 200 && first.body.newPwmValue === 150 &&
+            first.body.backend === "keyword" && !first.body.cached,
+            `newPwmValue ${first.body.newPwmValue}`);
+        this.addResult("Handler cache hit", second.body.cached && second.body.newPwmValue === 150 &&
+            second.body.msgHis.length === 2, `hits ${handle.cache.hits}, misses ${handle.cache.misses}`);
+
+        const missing = await handle({ currentPwm: 40 });
+        this.addResult("Handler rejects missing audio", missing.status === 400 && missing.body.newPwmValue === 40);
+
+        const history = Array.from({ length: 12 }, (_, i) => ({ user: `u${i}`, assistant: `a${i}` }));
+        const trimmed = await handle({ audioData, currentPwm: 0, transcript: "hello", msgHis: history });
+        this.addResult("History trimmed", trimmed.body.msgHis.length === 10 && !trimmed.body.intentDetected);
+    }
+
+    /**
+     * Test 4: Gemini backend reuses its model and parses the reply
+     */
+    async testGemini() {
+        const backend = new GeminiBackend({ logger: quietLogger });
+        const calls = [];
+        let created = 0;
+        backend.getModel = function () {
+            if (!this.model) {
+                created++;
+                this.model = {
+                    generateContent: async (parts) => {
+                        calls.push(parts);
+                        return { response: { text: () => "```json\n{\"intentDetected\": true, \"transcription\": \"stronger\", \"pwm\": 300, \"response\": \"ok\"}\n```" } };
+                    }
+                };
+            }
+            return this.model;
+        };
+
+        const handle = createDirectAudioHandler({ backend, logger: quietLogger });
+        const audioData = audioArray(1600);
+        const a = await handle({ audioData, currentPwm: 100, msgHis: [] });
+        const b = await handle({ audioData, currentPwm: 100, msgHis: [], transcript: "stronger" });
+        const wav = Buffer.from(calls[0][1].inlineData.data, "base64");
+
+        this.addResult("Gemini model reused", created === 1 && calls.length === 1, `${created} model(s), ${calls.length} call(s)`);
+        this.addResult("Gemini reply clamped", a.body.newPwmValue === 255 && a.body.transcription === "stronger");
+        this.addResult("Gemini answer cached by transcript", b.body.cached && b.body.newPwmValue === 255);
+
+        // The on-device text says "stop", the model heard "stronger": neither request is a hit
+        const c = await handle({ audioData, currentPwm: 50, msgHis: [], transcript: "stop" });
+        const d = await handle({ audioData, currentPwm: 50, msgHis: [], transcript: "stop" });
+        this.addResult("Client transcript the model disagrees with not cached", !c.body.cached && !d.body.cached &&
+            calls.length === 3, `${calls.length} model calls`);
+
+        const savedKey = process.env.GEMINI_API_KEY;
+        delete process.env.GEMINI_API_KEY;
+        let keyError = "";
+        try {
+            new GeminiBackend({ logger: quietLogger }).getModel();
+        } catch (error) {
+            keyError = error.message;
+        }
+        if (savedKey !== undefined) process.env.GEMINI_API_KEY = savedKey;
+        this.addResult("Gemini requires GEMINI_API_KEY", /GEMINI_API_KEY/.test(keyError), keyError || "created without a key");
+        this.addResult("Gemini gets WAV audio", wav.toString("ascii", 0, 4) === "RIFF" &&
+            wav.length === 44 + 1600 * 2 && wav.readInt16LE(44 + 2 * 10) === audioData[10]);
+    }
+
+    /**
+     * Test 5: WAV bytes match the previous encoder
+     */
+    testWav() {
+        const audioData = audioArray(4000);
+        const same = createWavBuffer(new Int16Array(audioData), SAMPLE_RATE).toString("base64") === legacyWavBase64(audioData);
+        this.addResult("WAV encoding unchanged", same);
+    }
+
+    async timeRequests(handle, bodyFor, n) {
+        const times = [];
+        for (let i = 0; i < n; i++) {
+            const body = bodyFor(i);
+            const start = process.hrtime.bigint();
+            await handle(body);
+            times.push(Number(process.hrtime.bigint() - start) / 1e3);
+        }
+        times.sort((a, b) => a - b);
+        return {
+            p50: times[Math.floor(n * 0.5)],
+            p99: times[Math.floor(n * 0.99)],
+            mean: times.reduce((a, b) => a + b, 0) / n
+        };
+    }
+
+    report(name, t) {
+        console.log(`  ${name.padEnd(34)} p50 ${t.p50.toFixed(0).padStart(6)} us  p99 ${t.p99.toFixed(0).padStart(6)} us  mean ${t.mean.toFixed(0).padStart(6)} us`);
+    }
+
+    /**
+     * Benchmark: request latency with the stand-in, one second of audio
+     */
+    async benchmark() {
+        const audioData = audioArray();
+        const phrases = ["turn it on", "make it stronger", "softer", "stop", "set it to 40 percent", "level three"];
+        const n = BENCH_REQUESTS;
+
+        console.log(`\nRequest latency, keyword stand-in, ${audioData.length} samples, ${n} requests:`);
+        const uncached = createDirectAudioHandler({ backend: "keyword", cache: false, logger: quietLogger });
+        const miss = await this.timeRequests(uncached,
+            (i) => ({ audioData, currentPwm: i % 256, transcript: phrases[i % phrases.length], msgHis: [] }), n);
+        this.report("no cache", miss);
+
+        const cached = createDirectAudioHandler({ backend: "keyword", logger: quietLogger });
+        await this.timeRequests(cached, (i) => ({ audioData, currentPwm: 100, transcript: phrases[i % phrases.length], msgHis: [] }), phrases.length);
+        const hit = await this.timeRequests(cached,
+            (i) => ({ audioData, currentPwm: 100, transcript: phrases[i % phrases.length], msgHis: [] }), n);
+        this.report("cache hit", hit);
+
+        const wavRuns = 200;
+        let start = process.hrtime.bigint();
+        for (let i = 0; i < wavRuns; i++) legacyWavBase64(audioData);
+        const legacyUs = Number(process.hrtime.bigint() - start) / 1e3 / wavRuns;
+        start = process.hrtime.bigint();
+        for (let i = 0; i < wavRuns; i++) createWavBuffer(new Int16Array(audioData), SAMPLE_RATE).toString("base64");
+        const wavUs = Number(process.hrtime.bigint() - start) / 1e3 / wavRuns;
+        console.log(`  WAV + base64 for Gemini: ${legacyUs.toFixed(0)} us before, ${wavUs.toFixed(0)} us now\n`);
+
+        this.addResult("Stand-in answers in under 5 ms", miss.p99 < 5000, `p99 ${miss.p99.toFixed(0)} us`);
+        this.addResult("Cache hit faster than a miss", hit.p50 < miss.p50,
+            `p50 ${hit.p50.toFixed(0)} us vs ${miss.p50.toFixed(0)} us`);
+    }
+
+    async run() {
+        await this.testKeywords();
+        this.testCache();
+        await this.testHandler();
+        await this.testGemini();
+        this.testWav();
+        await this.benchmark();
+
+        const failed = this.results.filter((r) => !r.success).length;
+        console.log(`\n${this.results.length - failed}/${this.results.length} passed`);
+        process.exitCode = failed ? 1 : 0;
+    }
+}
+
+new InferenceTest().run();
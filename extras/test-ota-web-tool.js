@@ -0,0 +1,597 @@
+/**
+ * OTA Web Tool Test - the page's transfer code against a simulated device
+ * Run with: node test-ota-web-tool.js
+ *
+ * Loads the DOM-free block of ota-web-tool.html (between the "OTA transfer
+ * begin/end" markers) and runs OtaSender in simulated time against a
+ * device that follows vm_ble_handle_ota_write(): the bank erase runs in
+ * the START write callback before READY, DATA is written in order only
+ * and every chunk is ACKed, FINISH starts a commit that reports VERIFYING
+ * and then SUCCESS, and a repeated FINISH reports where the commit is.
+ *
+ * The link moves a few PDUs per connection event each way, writes wait in
+ * a small phone queue, the device takes writes off a bounded RX queue at
+ * flash speed, and notifications that do not fit the device TX queue are
+ * dropped, as ota_send_notification() drops them. Writes and notifications
+ * can also be lost at random.
+ */
+
+const fs = require('fs');
+const path = require('path');
+
+function loadTransferCode() {
+    const html = fs.readFileSync(path.join(__dirname, 'ota-web-tool.html'), 'utf8');
+    const begin = html.indexOf('// ---- OTA transfer begin');
+    const end = html.indexOf('// ---- OTA transfer end');
+    if (begin < 0 || end < begin) {
+        throw new Error('OTA transfer markers not found in ota-web-tool.html');
+    }
+    const code = html.slice(begin, end);
+    return new Function(`${code}\nreturn { OTA, OTA_DEFAULTS, otaCrc16, otaChunkSize, otaErrorMessage, OtaSender };`)();
+}
+
+const { OTA, OTA_DEFAULTS, otaCrc16, otaChunkSize, otaErrorMessage, OtaSender } = loadTransferCode();
+
+// Deterministic link behaviour between runs
+function makeRandom(seed) {
+    let state = seed >>> 0;
+    return () => {
+        state = (state * 1664525 + 1013904223) >>> 0;
+        return state / 4294967296;
+    };
+}
+
+function makeFirmware(size, seed) {
+    const random = makeRandom(seed);
+    const data = new Uint8Array(size);
+    for (let i = 0; i < size; i++) data[i] = Math.floor(random() * 256);
+    return data;
+}
+
+function flush() {
+    return new Promise(resolve => setImmediate(resolve));
+}
+
+/**
+ * Simulated time: timers run in order, promises settle between them
+ */
+class VirtualTime {
+    constructor() {
+        this.t = 0;
+        this.timers = [];
+        this.nextId = 1;
+        this.now = () => this.t;
+        this.setTimeout = (fn, ms) => {
+            const id = this.nextId++;
+            this.timers.push({ id, at: this.t + Math.max(0, ms || 0), fn });
+            return id;
+        };
+        this.clearTimeout = (id) => {
+            const i = this.timers.findIndex(t => t.id === id);
+            if (i >= 0) this.timers.splice(i, 1);
+        };
+    }
+
+    next() {
+        let best = -1;
+        for (let i = 0; i < this.timers.length; i++) {
+            const t = this.timers[i];
+            if (best < 0 || t.at < this.timers[best].at ||
+                (t.at === this.timers[best].at && t.id < this.timers[best].id)) {
+                best = i;
+            }
+        }
+        return best < 0 ? null : this.timers.splice(best, 1)[0];
+    }
+
+    async settle(promise) {
+        let done = false;
+        let value;
+        promise.then(v => { done = true; value = v; });
+        await flush();
+        while (!done) {
+            const timer = this.next();
+            if (!timer) break;
+            this.t = timer.at;
+            timer.fn();
+            await flush();
+        }
+        return value;
+    }
+
+    sleep(ms) {
+        return new Promise(resolve => this.setTimeout(resolve, ms));
+    }
+}
+
+/**
+ * One toy: connection events, queues and the vm_ble_service.c OTA handler
+ */
+class MockOtaDevice {
+    constructor(vt, options = {}) {
+        this.vt = vt;
+        this.mtu = options.mtu ?? 247;
+        this.reportMtu = options.reportMtu ?? true;     // READY with the MTU (older firmware: 2 bytes)
+        this.intervalMs = options.intervalMs ?? 30;
+        this.eventPdus = options.eventPdus ?? 6;        // Each way per connection event
+        this.llPayload = this.mtu > 23 ? 251 : 27;      // Data length extension with the larger MTU
+        this.phoneQueueSize = options.phoneQueueSize ?? 8;
+        this.rxQueueSize = options.rxQueueSize ?? 8;
+        this.notifyQueueSize = options.notifyQueueSize ?? 8;
+        this.eraseMsPerSector = options.eraseMsPerSector ?? 25;
+        this.programMsPerPage = options.programMsPerPage ?? 0.8;
+        this.commitSteps = options.commitSteps ?? 10;
+        this.commitStepMs = options.commitStepMs ?? 20;
+        this.hostLatencyMs = options.hostLatencyMs ?? 1;
+        this.dropWrite = options.dropWrite ?? 0;
+        this.dropNotify = options.dropNotify ?? 0;
+        this.failWrite = options.failWrite ?? 0;
+        this.dropNotifyWhile = options.dropNotifyWhile || (() => false);
+        this.dropWriteWhile = options.dropWriteWhile || (() => false);
+        this.startError = options.startError ?? 0;
+        this.ignoreStart = options.ignoreStart ?? false;
+        this.random = makeRandom(options.seed ?? 1);
+        this.onNotify = () => {};
+
+        this.phoneQueue = [];
+        this.writers = [];
+        this.rxQueue = [];
+        this.notifyQueue = [];
+        this.busy = false;
+
+        this.state = 'idle';
+        this.commitPhase = 'idle';
+        this.commitReported = 0;
+        this.nextSeq = 0;
+        this.size = 0;
+        this.crc = 0;
+        this.received = 0;
+        this.image = null;
+        this.stats = { writes: 0, droppedWrites: 0, failedWrites: 0, droppedNotifies: 0, skipped: 0, starts: 0, finishes: 0 };
+
+        vt.setTimeout(() => this.connectionEvent(), this.intervalMs);
+    }
+
+    // writeValueWithoutResponse(): waits while the phone queue is full
+    write(bytes) {
+        if (this.failWrite && this.random() < this.failWrite) {
+            this.stats.failedWrites++;
+            return Promise.reject(new Error('GATT operation failed'));
+        }
+        return new Promise((resolve) => {
+            this.writers.push({ bytes: Uint8Array.from(bytes), resolve });
+            this.admit();
+        });
+    }
+
+    admit() {
+        while (this.writers.length && this.phoneQueue.length < this.phoneQueueSize) {
+            const writer = this.writers.shift();
+            this.phoneQueue.push(writer.bytes);
+            writer.resolve();
+        }
+    }
+
+    pdus(length) {
+        return Math.ceil((length + OTA.ATT_HEADER + 4) / this.llPayload);
+    }
+
+    connectionEvent() {
+        let budget = this.eventPdus;
+        while (this.phoneQueue.length && this.rxQueue.length < this.rxQueueSize) {
+            const pdus = this.pdus(this.phoneQueue[0].length);
+            if (pdus > budget) break;
+            budget -= pdus;
+            const packet = this.phoneQueue.shift();
+            this.stats.writes++;
+            if ((this.dropWrite && this.random() < this.dropWrite) || this.dropWriteWhile(this.vt.now(), packet)) {
+                this.stats.droppedWrites++;
+                continue;
+            }
+            this.rxQueue.push(packet);
+        }
+        this.admit();
+        this.processNext();
+
+        budget = this.eventPdus;
+        while (this.notifyQueue.length && budget > 0) {
+            const packet = this.notifyQueue.shift();
+            budget -= this.pdus(packet.length);
+            if ((this.dropNotify && this.random() < this.dropNotify) || this.dropNotifyWhile(this.vt.now(), packet)) {
+                this.stats.droppedNotifies++;
+                continue;
+            }
+            this.vt.setTimeout(() => this.onNotify(packet), this.hostLatencyMs);
+        }
+
+        this.vt.setTimeout(() => this.connectionEvent(), this.intervalMs);
+    }
+
+    // ota_send_notification(): nothing is queued when the stack buffer is full
+    notify(bytes) {
+        if (this.notifyQueue.length >= this.notifyQueueSize) {
+            this.stats.droppedNotifies++;
+            return false;
+        }
+        this.notifyQueue.push(Uint8Array.from(bytes));
+        return true;
+    }
+
+    // Write callbacks run one at a time; the erase and page programs block them
+    processNext() {
+        if (this.busy || !this.rxQueue.length) return;
+        const packet = this.rxQueue.shift();
+        this.busy = true;
+        this.vt.setTimeout(() => {
+            this.handleWrite(packet);
+            this.busy = false;
+            this.processNext();
+        }, this.costMs(packet));
+    }
+
+    costMs(packet) {
+        if (packet[0] === OTA.CMD_START && packet.length === 8 && this.state === 'idle') {
+            const size = packet[1] | (packet[2] << 8) | (packet[3] << 16) | (packet[4] << 24);
+            if (size > 0 && size <= OTA.MAX_SIZE) {
+                return Math.ceil(size / OTA.SECTOR_SIZE) * this.eraseMsPerSector;
+            }
+        }
+        if (packet[0] === OTA.CMD_DATA) {
+            return 0.2 + this.programMsPerPage * (packet.length - OTA.DATA_HEADER) / 256;
+        }
+        return 0.2;
+    }
+
+    handleWrite(data) {
+        switch (data[0]) {
+        case OTA.CMD_START: {
+            this.stats.starts++;
+            if (this.ignoreStart) return;
+            if (data.length !== 8) {
+                this.notify([OTA.ERROR, 0x01]);
+                return;
+            }
+            const size = (data[1] | (data[2] << 8) | (data[3] << 16) | (data[4] << 24)) >>> 0;
+            if (this.state !== 'idle') {
+                this.notify([OTA.ERROR, 0x07]);
+                return;
+            }
+            if (size === 0 || size > OTA.MAX_SIZE) {
+                this.notify([OTA.ERROR, 0x01]);
+                return;
+            }
+            if (this.startError) {
+                this.notify([OTA.ERROR, this.startError]);
+                return;
+            }
+            this.size = size;
+            this.crc = data[5] | (data[6] << 8);
+            this.image = new Uint8Array(size);
+            this.received = 0;
+            this.nextSeq = 0;
+            this.state = 'receiving';
+            this.notify(this.reportMtu ? [OTA.READY, 0x00, this.mtu & 0xFF, this.mtu >> 8] : [OTA.READY, 0x00]);
+            return;
+        }
+
+        case OTA.CMD_DATA: {
+            if (this.state !== 'receiving') {
+                this.notify([OTA.ERROR, 0x03]);
+                return;
+            }
+            if (data.length < 4) {
+                this.notify([OTA.ERROR, 0x04]);
+                return;
+            }
+            const seq = data[1] | (data[2] << 8);
+            if (seq !== this.nextSeq) {
+                this.stats.skipped++;
+                this.notify(this.nextSeq === 0 ? [OTA.NONE, 0x00] : [OTA.ACK, (this.nextSeq - 1) & 0xFF]);
+                return;
+            }
+            const chunk = data.subarray(OTA.DATA_HEADER);
+            if (this.received + chunk.length > this.size) {
+                this.state = 'idle';
+                this.notify([OTA.ERROR, 0x01]);
+                return;
+            }
+            this.image.set(chunk, this.received);
+            this.received += chunk.length;
+            this.nextSeq = (this.nextSeq + 1) & 0xFFFF;
+            this.notify([OTA.ACK, seq & 0xFF]);
+            if (seq % 10 === 0) {
+                this.notify([OTA.PROGRESS, Math.floor(this.received * 100 / this.size)]);
+            }
+            return;
+        }
+
+        case OTA.CMD_FINISH: {
+            this.stats.finishes++;
+            if (this.commitPhase !== 'idle') {
+                this.notify(this.commitPhase === 'running' ? [OTA.VERIFYING, this.commitReported] : [OTA.SUCCESS, 0x00]);
+                return;
+            }
+            if (this.state !== 'receiving') {
+                this.notify([OTA.ERROR, 0x06]);
+                return;
+            }
+            if (this.received !== this.size || otaCrc16(this.image) !== this.crc) {
+                this.state = 'idle';
+                this.notify([OTA.ERROR, 0x04]);
+                return;
+            }
+            this.commitPhase = 'running';
+            this.commitReported = 0;
+            this.notify([OTA.VERIFYING, 0]);
+            this.commitStep(0);
+            return;
+        }
+
+        default:
+            this.notify([OTA.ERROR, 0xFF]);
+        }
+    }
+
+    // ota_commit_poll(): VERIFYING every 10 %, SUCCESS retried until queued
+    commitStep(step) {
+        this.vt.setTimeout(() => {
+            if (step + 1 < this.commitSteps) {
+                const progress = Math.floor((step + 1) * 100 / this.commitSteps);
+                if (progress >= this.commitReported + 10) {
+                    this.commitReported = progress;
+                    this.notify([OTA.VERIFYING, progress]);
+                }
+                this.commitStep(step + 1);
+                return;
+            }
+            this.commitPhase = 'success-pending';
+            const sendSuccess = () => {
+                if (this.notify([OTA.SUCCESS, 0x00])) {
+                    this.commitPhase = 'success-queued';
+                    this.state = 'done';
+                } else {
+                    this.vt.setTimeout(sendSuccess, this.intervalMs);
+                }
+            };
+            sendSuccess();
+        }, this.commitStepMs);
+    }
+}
+
+/**
+ * Run one transfer
+ * @returns {Object} { stats, error, device, seconds, log }
+ */
+async function transfer(firmware, deviceOptions = {}, senderOptions = {}) {
+    const vt = new VirtualTime();
+    const device = new MockOtaDevice(vt, deviceOptions);
+    const log = [];
+    const sender = new OtaSender((bytes) => device.write(bytes), {
+        ...senderOptions,
+        now: vt.now,
+        setTimeout: vt.setTimeout,
+        clearTimeout: vt.clearTimeout,
+        onLog: (message) => log.push(message)
+    });
+    device.onNotify = (bytes) => sender.handleNotification(bytes);
+
+    const result = await vt.settle(sender.run(firmware).then(
+        (stats) => ({ stats }),
+        (error) => ({ error })
+    ));
+    return { ...result, device, log, seconds: vt.now() / 1000, sender };
+}
+
+/**
+ * The fixed-sleep loop the page used before (with the 8-byte START the
+ * firmware expects): 240-byte chunks 20 ms apart, no ACK handling
+ */
+async function legacyTransfer(firmware, deviceOptions = {}) {
+    const vt = new VirtualTime();
+    const device = new MockOtaDevice(vt, deviceOptions);
+    let success = false;
+    let error = null;
+    device.onNotify = (bytes) => {
+        if (bytes[0] === OTA.SUCCESS) success = true;
+        if (bytes[0] === OTA.ERROR) error = bytes[1];
+    };
+
+    const run = async () => {
+        const size = firmware.length;
+        const crc = otaCrc16(firmware);
+        await device.write(new Uint8Array([OTA.CMD_START, size & 0xFF, (size >> 8) & 0xFF,
+            (size >> 16) & 0xFF, (size >> 24) & 0xFF, crc & 0xFF, crc >> 8, 1]));
+        await vt.sleep(500);
+        for (let offset = 0, seq = 0; offset < size; offset += 240, seq++) {
+            const chunk = firmware.subarray(offset, Math.min(offset + 240, size));
+            const packet = new Uint8Array(3 + chunk.length);
+            packet.set([OTA.CMD_DATA, seq & 0xFF, (seq >> 8) & 0xFF]);
+            packet.set(chunk, 3);
+            await device.write(packet);
+            await vt.sleep(20);
+        }
+        await vt.sleep(1000);
+        await device.write(new Uint8Array([OTA.CMD_FINISH]));
+        while (!success && error === null && vt.now() < 600000) await vt.sleep(10);
+    };
+    await vt.settle(run());
+    return { success, error, device, seconds: vt.now() / 1000 };
+}
+
+function imageMatches(device, firmware) {
+    return device.image && device.image.length === firmware.length &&
+        device.image.every((b, i) => b === firmware[i]);
+}
+
+function kbs(stats) {
+    return `${(stats.average / 1024).toFixed(1)} KB/s`;
+}
+
+class OtaWebToolTest {
+    constructor() {
+        this.results = [];
+        this.consoleLog = console.log;
+        this.firmware = makeFirmware(220 * 1024, 7);
+        this.table = [];
+    }
+
+    addResult(test, success, details = '') {
+        this.results.push({ test, success, details });
+        this.consoleLog(`${success ? '✅' : '❌'} ${test}${details ? ': ' + details : ''}`);
+    }
+
+    /**
+     * Test 1: CRC, chunk size and error text match the firmware
+     */
+    testHelpers() {
+        const check = otaCrc16(new TextEncoder().encode('123456789'));
+        this.addResult('CRC16 matches the SDK CRC16()', check === 0x31C3, `0x${check.toString(16)}`);
+        this.addResult('Chunk size from MTU', otaChunkSize(23) === 17 && otaChunkSize(247) === 241 &&
+            otaChunkSize(185) === 179 && otaChunkSize(512) === 241, '23 -> 17, 185 -> 179, 247 and 512 -> 241');
+        this.addResult('Errors read per phase', otaErrorMessage(0x02, 'start') === 'Flash erase failed' &&
+            otaErrorMessage(0x04, 'finish') === 'Size or CRC mismatch' &&
+            otaErrorMessage(0x03, 'data').startsWith('Not receiving'));
+    }
+
+    /**
+     * Test 2: A clean transfer leaves the exact image on the device
+     */
+    async testClean() {
+        const r = await transfer(this.firmware);
+        const ok = !r.error && imageMatches(r.device, this.firmware) && r.device.state === 'done';
+        this.addResult('Clean 220 KB transfer', ok && r.stats.retransmits === 0 && r.stats.timeouts === 0,
+            r.error ? r.error.message : `${r.seconds.toFixed(1)} s, ${kbs(r.stats)}, chunk ${r.stats.chunkSize}`);
+
+        const old = await transfer(this.firmware, { reportMtu: false });
+        this.addResult('READY without MTU falls back to 241-byte chunks',
+            !old.error && old.stats.chunkSize === 241 && imageMatches(old.device, this.firmware));
+    }
+
+    /**
+     * Test 3: Throughput against chunks in flight and MTU
+     */
+    async testSweeps() {
+        const byWindow = {};
+        for (const window of [1, 2, 4, 8, 16, 32, 64]) {
+            const r = await transfer(this.firmware, {}, { window });
+            byWindow[window] = r;
+            this.table.push({ label: `MTU 247, window ${window}`, r });
+        }
+        const allOk = Object.values(byWindow).every(r => !r.error && imageMatches(r.device, this.firmware));
+        const w1 = byWindow[1].stats.average;
+        const wd = byWindow[OTA_DEFAULTS.window].stats.average;
+        this.addResult('More chunks in flight, more throughput', allOk && wd > 3 * w1,
+            `window 1 ${kbs(byWindow[1].stats)}, window ${OTA_DEFAULTS.window} ${kbs(byWindow[OTA_DEFAULTS.window].stats)}`);
+
+        const byMtu = {};
+        for (const mtu of [23, 185, 247, 512]) {
+            const r = await transfer(this.firmware, { mtu });
+            byMtu[mtu] = r;
+            if (mtu !== 247) this.table.push({ label: `MTU ${mtu}, window ${OTA_DEFAULTS.window}`, r });
+        }
+        const mtuOk = Object.values(byMtu).every(r => !r.error && imageMatches(r.device, this.firmware));
+        this.addResult('Chunks follow the MTU', mtuOk && byMtu[23].stats.chunkSize === 17 &&
+            byMtu[247].stats.average > 5 * byMtu[23].stats.average &&
+            byMtu[512].stats.average >= byMtu[247].stats.average,
+            `MTU 23 ${kbs(byMtu[23].stats)}, MTU 247 ${kbs(byMtu[247].stats)}`);
+
+        const legacy = await legacyTransfer(this.firmware);
+        this.legacy = legacy;
+        const speedup = (this.firmware.length / legacy.seconds) / (this.firmware.length / byWindow[OTA_DEFAULTS.window].seconds);
+        this.addResult('Faster than the fixed-sleep loop', legacy.success && speedup < 0.5,
+            `${legacy.seconds.toFixed(1)} s before, ${byWindow[OTA_DEFAULTS.window].seconds.toFixed(1)} s now`);
+
+        const legacyLoss = await legacyTransfer(this.firmware, { dropWrite: 0.03, seed: 4 });
+        this.addResult('Fixed-sleep loop fails on a lost write', !legacyLoss.success && legacyLoss.error === 0x04,
+            `error 0x0${legacyLoss.error}`);
+    }
+
+    /**
+     * Test 4: Lost notifications and writes are recovered without corrupting the image
+     */
+    async testLoss() {
+        const acks = await transfer(this.firmware, { dropNotify: 0.2, seed: 3 });
+        this.addResult('20% of notifications lost', !acks.error && imageMatches(acks.device, this.firmware),
+            acks.error ? acks.error.message :
+                `${kbs(acks.stats)}, ${acks.stats.timeouts} timeouts, ${acks.device.stats.skipped} repeats skipped`);
+
+        const writes = await transfer(this.firmware, { dropWrite: 0.03, seed: 4 });
+        this.addResult('3% of writes lost', !writes.error && imageMatches(writes.device, this.firmware) &&
+            writes.stats.retransmits > 0,
+            writes.error ? writes.error.message :
+                `${kbs(writes.stats)}, ${writes.stats.retransmits} resent, ${writes.stats.timeouts} timeouts`);
+
+        const failing = await transfer(this.firmware, { failWrite: 0.02, seed: 5 });
+        this.addResult('Refused writes retried', !failing.error && imageMatches(failing.device, this.firmware) &&
+            failing.stats.writeErrors > 0, failing.error ? failing.error.message : `${failing.stats.writeErrors} refused`);
+        // First chunk lost: nothing to ACK yet, so the device answers NONE instead of ACK 0xFF
+        let firstLost = false;
+        const first = await transfer(this.firmware, {
+            dropWriteWhile: (t, packet) => {
+                if (firstLost || packet[0] !== OTA.CMD_DATA || packet[1] !== 0 || packet[2] !== 0) return false;
+                return (firstLost = true);
+            }
+        });
+        this.addResult('Lost first chunk resent on NONE', !first.error && imageMatches(first.device, this.firmware) &&
+            first.stats.timeouts === 0 && first.stats.retransmits > 0,
+            first.error ? first.error.message : `${first.stats.retransmits} resent, ${first.stats.timeouts} timeouts`);
+        this.table.push({ label: 'MTU 247, 3% writes lost', r: writes });
+        this.table.push({ label: 'MTU 247, 20% notifications lost', r: acks });
+    }
+
+    /**
+     * Test 5: Device errors and silence end the transfer
+     */
+    async testFailures() {
+        const small = makeFirmware(20 * 1024, 9);
+
+        const erase = await transfer(small, { startError: 0x02 });
+        this.addResult('Device error rejects', erase.error && erase.error.message === 'Flash erase failed' &&
+            erase.error.code === 0x02, erase.error && erase.error.message);
+
+        const silent = await transfer(small, { ignoreStart: true });
+        this.addResult('No READY times out', silent.error && silent.error.message.startsWith('No READY') &&
+            silent.seconds < 10, silent.error && `${silent.error.message} at ${silent.seconds.toFixed(1)} s`);
+
+        const tooBig = await transfer(new Uint8Array(OTA.MAX_SIZE + 1));
+        this.addResult('Oversized image refused before START', tooBig.error && tooBig.device.stats.starts === 0);
+
+        // Commit slower than the FINISH timeout and its first notifications lost
+        let commitFrom = null;
+        const lost = await transfer(small, {
+            commitStepMs: 600,
+            dropNotifyWhile: (t, packet) => {
+                if (packet[0] !== OTA.VERIFYING && packet[0] !== OTA.SUCCESS) return false;
+                if (commitFrom === null) commitFrom = t;
+                return t - commitFrom < 4000;
+            }
+        });
+        this.addResult('Lost VERIFYING answered by a repeated FINISH', !lost.error && lost.device.stats.finishes > 1 &&
+            lost.device.state === 'done', lost.error ? lost.error.message : `${lost.device.stats.finishes} FINISH writes`);
+    }
+
+    report() {
+        this.consoleLog('\nThroughput, 220 KB image (30 ms interval, 6 PDUs per event each way):');
+        for (const { label, r } of this.table) {
+            this.consoleLog(`  ${label.padEnd(34)} ${(r.stats.average / 1024).toFixed(1).padStart(5)} KB/s ` +
+                `${r.seconds.toFixed(1).padStart(6)} s total`);
+        }
+        this.consoleLog(`  ${'fixed-sleep loop (before)'.padEnd(34)} ${((this.firmware.length / this.legacy.seconds) / 1024)
+            .toFixed(1).padStart(5)} KB/s ${this.legacy.seconds.toFixed(1).padStart(6)} s total\n`);
+    }
+
+    async run() {
+        this.testHelpers();
+        await this.testClean();
+        await this.testSweeps();
+        await this.testLoss();
+        await this.testFailures();
+        this.report();
+
+        const failed = this.results.filter(r => !r.success).length;
+        console.log(`\n${this.results.length - failed}/${this.results.length} passed`);
+        process.exitCode = failed ? 1 : 0;
+    }
+}
+
+new OtaWebToolTest().run();